@@ -1,10 +1,14 @@
 import { beforeEach, describe, expect, test, vi } from "vitest";
 
 const registerLogTransportMock = vi.hoisted(() => vi.fn());
+const getUltraStatsSnapshotMock = vi.hoisted(() => vi.fn());
+const setUltraStatsEnabledMock = vi.hoisted(() => vi.fn());
 
 const telemetryState = vi.hoisted(() => {
   const counters = new Map<string, { add: ReturnType<typeof vi.fn> }>();
   const histograms = new Map<string, { record: ReturnType<typeof vi.fn> }>();
+  const observables = new Map<string, { name: string }>();
+  const batchCallbacks: Array<(result: { observe: ReturnType<typeof vi.fn> }) => void> = [];
   const tracer = {
     startSpan: vi.fn((_name: string, _opts?: unknown) => ({
       end: vi.fn(),
@@ -22,8 +26,23 @@ const telemetryState = vi.hoisted(() => {
       histograms.set(name, histogram);
       return histogram;
     }),
+    createObservableCounter: vi.fn((name: string) => {
+      const observable = { name };
+      observables.set(name, observable);
+      return observable;
+    }),
+    createObservableGauge: vi.fn((name: string) => {
+      const observable = { name };
+      observables.set(name, observable);
+      return observable;
+    }),
+    addBatchObservableCallback: vi.fn(
+      (callback: (result: { observe: ReturnType<typeof vi.fn> }) => void) => {
+        batchCallbacks.push(callback);
+      },
+    ),
   };
-  return { counters, histograms, tracer, meter };
+  return { counters, histograms, observables, batchCallbacks, tracer, meter };
 });
 
 const sdkStart = vi.hoisted(() => vi.fn().mockResolvedValue(undefined));
@@ -100,16 +119,27 @@ vi.mock("openclaw/plugin-sdk", async () => {
   return {
     ...actual,
     registerLogTransport: registerLogTransportMock,
+    getUltraStatsSnapshot: getUltraStatsSnapshotMock,
+    setUltraStatsEnabled: setUltraStatsEnabledMock,
   };
 });
 
 import { emitDiagnosticEvent } from "openclaw/plugin-sdk";
-import { createDiagnosticsOtelService } from "./service.js";
+import { createDiagnosticsOtelService, histogramQuantile } from "./service.js";
+
+const testLogger = {
+  info: vi.fn(),
+  warn: vi.fn(),
+  error: vi.fn(),
+  debug: vi.fn(),
+};
 
 describe("diagnostics-otel service", () => {
   beforeEach(() => {
     telemetryState.counters.clear();
     telemetryState.histograms.clear();
+    telemetryState.observables.clear();
+    telemetryState.batchCallbacks.length = 0;
     telemetryState.tracer.startSpan.mockClear();
     telemetryState.meter.createCounter.mockClear();
     telemetryState.meter.createHistogram.mockClear();
@@ -118,6 +148,8 @@ describe("diagnostics-otel service", () => {
     logEmit.mockClear();
     logShutdown.mockClear();
     registerLogTransportMock.mockReset();
+    getUltraStatsSnapshotMock.mockReset();
+    setUltraStatsEnabledMock.mockReset();
   });
 
   test("records message-flow metrics and spans", async () => {
@@ -223,4 +255,95 @@ describe("diagnostics-otel service", () => {
 
     await service.stop?.();
   });
+
+  test("exports native op stats with interval latency quantiles", async () => {
+    const bounds = new Float64Array([10, 20, 40, 80]);
+    getUltraStatsSnapshotMock
+      .mockReturnValueOnce({
+        ops: [
+          {
+            op: "base64.decode",
+            calls: 4,
+            bytes: 4096,
+            totalNs: 100,
+            buckets: new Float64Array([4, 0, 0, 0]),
+          },
+        ],
+        latencyBounds: bounds,
+        fallbacks: { topK: 2 },
+      })
+      .mockReturnValueOnce({
+        ops: [
+          {
+            op: "base64.decode",
+            calls: 8,
+            bytes: 8192,
+            totalNs: 300,
+            buckets: new Float64Array([4, 0, 0, 4]),
+          },
+        ],
+        latencyBounds: bounds,
+        fallbacks: { topK: 2 },
+      });
+
+    const service = createDiagnosticsOtelService();
+    await service.start({
+      config: {
+        diagnostics: {
+          enabled: true,
+          otel: { enabled: true, protocol: "http/protobuf", traces: false, metrics: true },
+        },
+      },
+      logger: testLogger,
+    });
+    expect(setUltraStatsEnabledMock).toHaveBeenCalledWith(true);
+    expect(telemetryState.batchCallbacks).toHaveLength(1);
+
+    const collect = () => {
+      const observe = vi.fn();
+      telemetryState.batchCallbacks[0]?.({ observe });
+      return observe;
+    };
+    const observed = (
+      observe: ReturnType<typeof vi.fn>,
+      name: string,
+      attrs: Record<string, unknown>,
+    ) =>
+      observe.mock.calls.find(
+        ([observable, , callAttrs]) =>
+          observable === telemetryState.observables.get(name) &&
+          Object.entries(attrs).every(([key, value]) => callAttrs?.[key] === value),
+      )?.[1];
+
+    const first = collect();
+    expect(observed(first, "openclaw.native.calls", { "openclaw.op": "base64.decode" })).toBe(4);
+    expect(observed(first, "openclaw.native.bytes", { "openclaw.op": "base64.decode" })).toBe(4096);
+    expect(observed(first, "openclaw.native.fallback", { "openclaw.op": "topK" })).toBe(2);
+    expect(
+      observed(first, "openclaw.native.latency_ns", {
+        "openclaw.op": "base64.decode",
+        "openclaw.quantile": 0.99,
+      }),
+    ).toBe(10);
+
+    // Only the four slow calls since the last collection count
+    const second = collect();
+    expect(
+      observed(second, "openclaw.native.latency_ns", {
+        "openclaw.op": "base64.decode",
+        "openclaw.quantile": 0.5,
+      }),
+    ).toBe(80);
+
+    await service.stop?.();
+    expect(setUltraStatsEnabledMock).toHaveBeenLastCalledWith(false);
+  });
+
+  test("histogramQuantile picks the bucket holding the rank", () => {
+    const bounds = [1, 2, 4, 8];
+    expect(histogramQuantile([0, 0, 0, 0], bounds, 0.5)).toBeNull();
+    expect(histogramQuantile([1, 1, 1, 1], bounds, 0.5)).toBe(2);
+    expect(histogramQuantile([1, 1, 1, 1], bounds, 0.99)).toBe(8);
+    expect(histogramQuantile([0, 5, 0, 0], bounds, 0.01)).toBe(2);
+  });
 });
@@ -1,4 +1,5 @@
 import type { SeverityNumber } from "@opentelemetry/api-logs";
+import type { BatchObservableResult } from "@opentelemetry/api";
 import type { DiagnosticEventPayload, OpenClawPluginService } from "openclaw/plugin-sdk";
 import { metrics, trace, SpanStatusCode } from "@opentelemetry/api";
 import { OTLPLogExporter } from "@opentelemetry/exporter-logs-otlp-http";
@@ -10,7 +11,12 @@ import { PeriodicExportingMetricReader } from "@opentelemetry/sdk-metrics";
 import { NodeSDK } from "@opentelemetry/sdk-node";
 import { ParentBasedSampler, TraceIdRatioBasedSampler } from "@opentelemetry/sdk-trace-base";
 import { SemanticResourceAttributes } from "@opentelemetry/semantic-conventions";
-import { onDiagnosticEvent, registerLogTransport } from "openclaw/plugin-sdk";
+import {
+  getUltraStatsSnapshot,
+  onDiagnosticEvent,
+  registerLogTransport,
+  setUltraStatsEnabled,
+} from "openclaw/plugin-sdk";
 
 const DEFAULT_SERVICE_NAME = "openclaw";
 
@@ -39,11 +45,38 @@ function resolveSampleRate(value: number | undefined): number | undefined {
   return value;
 }
 
+const NATIVE_LATENCY_QUANTILES = [0.5, 0.9, 0.99] as const;
+
+/** Upper bound of the bucket holding the q-th call; null for an empty histogram. */
+export function histogramQuantile(
+  buckets: ArrayLike<number>,
+  bounds: ArrayLike<number>,
+  q: number,
+): number | null {
+  let total = 0;
+  for (let i = 0; i < buckets.length; i++) {
+    total += buckets[i];
+  }
+  if (total <= 0) {
+    return null;
+  }
+  const rank = Math.max(1, Math.ceil(total * q));
+  let seen = 0;
+  for (let i = 0; i < buckets.length; i++) {
+    seen += buckets[i];
+    if (seen >= rank) {
+      return bounds[i];
+    }
+  }
+  return bounds[bounds.length - 1];
+}
+
 export function createDiagnosticsOtelService(): OpenClawPluginService {
   let sdk: NodeSDK | null = null;
   let logProvider: LoggerProvider | null = null;
   let stopLogTransport: (() => void) | null = null;
   let unsubscribe: (() => void) | null = null;
+  let nativeStatsEnabled = false;
 
   return {
     id: "diagnostics-otel",
@@ -205,6 +238,71 @@ export function createDiagnosticsOtelService(): OpenClawPluginService {
         description: "Run attempts",
       });
 
+      if (metricsEnabled) {
+        const nativeCallsCounter = meter.createObservableCounter("openclaw.native.calls", {
+          unit: "1",
+          description: "Native op calls",
+        });
+        const nativeBytesCounter = meter.createObservableCounter("openclaw.native.bytes", {
+          unit: "By",
+          description: "Input bytes processed by native ops",
+        });
+        const nativeDurationCounter = meter.createObservableCounter(
+          "openclaw.native.duration_ns",
+          {
+            unit: "ns",
+            description: "Total time spent in native ops",
+          },
+        );
+        const nativeLatencyGauge = meter.createObservableGauge("openclaw.native.latency_ns", {
+          unit: "ns",
+          description: "Native op latency quantiles since the previous collection",
+        });
+        const fallbackCounter = meter.createObservableCounter("openclaw.native.fallback", {
+          unit: "1",
+          description: "Accelerated ops that took the JS path",
+        });
+
+        // The API has no way to report pre-aggregated buckets, so latency is
+        // exported as quantiles of the histogram delta between collections
+        let previous = new Map<string, Float64Array>();
+        const observeNative = (result: BatchObservableResult) => {
+          const snapshot = getUltraStatsSnapshot();
+          const next = new Map<string, Float64Array>();
+          for (const entry of snapshot.ops) {
+            const attrs = { "openclaw.op": entry.op };
+            result.observe(nativeCallsCounter, entry.calls, attrs);
+            result.observe(nativeBytesCounter, entry.bytes, attrs);
+            result.observe(nativeDurationCounter, entry.totalNs, attrs);
+            next.set(entry.op, entry.buckets);
+            const before = previous.get(entry.op);
+            const delta = before ? entry.buckets.map((count, i) => count - before[i]) : entry.buckets;
+            for (const q of NATIVE_LATENCY_QUANTILES) {
+              const value = histogramQuantile(delta, snapshot.latencyBounds, q);
+              if (value !== null) {
+                result.observe(nativeLatencyGauge, value, {
+                  ...attrs,
+                  "openclaw.quantile": q,
+                });
+              }
+            }
+          }
+          previous = next;
+          for (const [op, hits] of Object.entries(snapshot.fallbacks)) {
+            result.observe(fallbackCounter, hits, { "openclaw.op": op });
+          }
+        };
+        meter.addBatchObservableCallback(observeNative, [
+          nativeCallsCounter,
+          nativeBytesCounter,
+          nativeDurationCounter,
+          nativeLatencyGauge,
+          fallbackCounter,
+        ]);
+        setUltraStatsEnabled(true);
+        nativeStatsEnabled = true;
+      }
+
       if (logsEnabled) {
         const logExporter = new OTLPLogExporter({
           ...(logUrl ? { url: logUrl } : {}),
@@ -620,6 +718,10 @@ export function createDiagnosticsOtelService(): OpenClawPluginService {
     async stop() {
       unsubscribe?.();
       unsubscribe = null;
+      if (nativeStatsEnabled) {
+        setUltraStatsEnabled(false);
+        nativeStatsEnabled = false;
+      }
       stopLogTransport?.();
       stopLogTransport = null;
       if (logProvider) {
@@ -0,0 +1,34 @@
+import { describe, expect, it, vi } from "vitest";
+import { convertPcmToMulaw8k, pcmToMulaw, type TelephonyAudioKernels } from "./telephony-audio.js";
+
+function pcm(samples: number[]): Buffer {
+  const buffer = Buffer.alloc(samples.length * 2);
+  samples.forEach((sample, i) => buffer.writeInt16LE(sample, i * 2));
+  return buffer;
+}
+
+describe("convertPcmToMulaw8k", () => {
+  it("encodes silence and full scale like G.711", () => {
+    expect([...pcmToMulaw(pcm([0, 32767, -32768]))]).toEqual([0xff, 0x80, 0x00]);
+  });
+
+  it("uses the native kernels when given", () => {
+    const kernels: TelephonyAudioKernels = {
+      resample: vi.fn(() => pcm([1, 2])),
+      encodeG711: vi.fn(() => Buffer.from([7, 8])),
+    };
+    const out = convertPcmToMulaw8k(pcm([0, 0, 0, 0, 0, 0]), 24000, kernels);
+    expect(kernels.resample).toHaveBeenCalledWith(expect.any(Buffer), 24000, 8000);
+    expect(kernels.encodeG711).toHaveBeenCalledWith(pcm([1, 2]), "mulaw");
+    expect([...out]).toEqual([7, 8]);
+  });
+
+  it("falls back to interpolation when the native resampler declines the rate", () => {
+    const kernels: TelephonyAudioKernels = {
+      resample: vi.fn(() => null),
+      encodeG711: (input) => pcmToMulaw(input),
+    };
+    const out = convertPcmToMulaw8k(pcm([0, 0, 0, 0, 0, 0]), 24000, kernels);
+    expect([...out]).toEqual([0xff, 0xff]);
+  });
+});
@@ -1,16 +1,34 @@
 const TELEPHONY_SAMPLE_RATE = 8000;
 
+/**
+ * Native resampler and G.711 encoder (api.runtime.tts.getNativeTelephonyAudio()).
+ * The resampler is windowed-sinc, so it band-limits instead of aliasing.
+ */
+export type TelephonyAudioKernels = {
+  resample(pcm: Buffer, inputRate: number, outputRate: number): Buffer | null;
+  encodeG711(pcm: Buffer, law: "mulaw"): Buffer;
+};
+
 function clamp16(value: number): number {
   return Math.max(-32768, Math.min(32767, value));
 }
 
 /**
- * Resample 16-bit PCM (little-endian mono) to 8kHz using linear interpolation.
+ * Resample 16-bit PCM (little-endian mono) to 8kHz, with the native kernels
+ * when given, else using linear interpolation.
  */
-export function resamplePcmTo8k(input: Buffer, inputSampleRate: number): Buffer {
+export function resamplePcmTo8k(
+  input: Buffer,
+  inputSampleRate: number,
+  kernels?: TelephonyAudioKernels | null,
+): Buffer {
   if (inputSampleRate === TELEPHONY_SAMPLE_RATE) {
     return input;
   }
+  const resampled = kernels?.resample(input, inputSampleRate, TELEPHONY_SAMPLE_RATE);
+  if (resampled) {
+    return resampled;
+  }
   const inputSamples = Math.floor(input.length / 2);
   if (inputSamples === 0) {
     return Buffer.alloc(0);
@@ -39,7 +57,10 @@ export function resamplePcmTo8k(input: Buffer, inputSampleRate: number): Buffer
 /**
  * Convert 16-bit PCM to 8-bit mu-law (G.711).
  */
-export function pcmToMulaw(pcm: Buffer): Buffer {
+export function pcmToMulaw(pcm: Buffer, kernels?: TelephonyAudioKernels | null): Buffer {
+  if (kernels) {
+    return kernels.encodeG711(pcm, "mulaw");
+  }
   const samples = Math.floor(pcm.length / 2);
   const mulaw = Buffer.alloc(samples);
 
@@ -51,9 +72,13 @@ export function pcmToMulaw(pcm: Buffer): Buffer {
   return mulaw;
 }
 
-export function convertPcmToMulaw8k(pcm: Buffer, inputSampleRate: number): Buffer {
-  const pcm8k = resamplePcmTo8k(pcm, inputSampleRate);
-  return pcmToMulaw(pcm8k);
+export function convertPcmToMulaw8k(
+  pcm: Buffer,
+  inputSampleRate: number,
+  kernels?: TelephonyAudioKernels | null,
+): Buffer {
+  const pcm8k = resamplePcmTo8k(pcm, inputSampleRate, kernels);
+  return pcmToMulaw(pcm8k, kernels);
 }
 
 /**
@@ -1,6 +1,6 @@
 import type { VoiceCallTtsConfig } from "./config.js";
 import type { CoreConfig } from "./core-bridge.js";
-import { convertPcmToMulaw8k } from "./telephony-audio.js";
+import { convertPcmToMulaw8k, type TelephonyAudioKernels } from "./telephony-audio.js";
 
 export type TelephonyTtsRuntime = {
   textToSpeechTelephony: (params: {
@@ -14,6 +14,7 @@ export type TelephonyTtsRuntime = {
     provider?: string;
     error?: string;
   }>;
+  getNativeTelephonyAudio?: () => TelephonyAudioKernels | null;
 };
 
 export type TelephonyTtsProvider = {
@@ -39,7 +40,11 @@ export function createTelephonyTtsProvider(params: {
         throw new Error(result.error ?? "TTS conversion failed");
       }
 
-      return convertPcmToMulaw8k(result.audioBuffer, result.sampleRate);
+      return convertPcmToMulaw8k(
+        result.audioBuffer,
+        result.sampleRate,
+        runtime.getNativeTelephonyAudio?.(),
+      );
     },
   };
 }
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <napi.h>
+#include <memory>
+
+struct PooledBufferState;
+
+// Per-environment addon state. Each JS environment (main thread or worker)
+// gets its own instance, created in InitAll and freed with the env.
+struct AddonData {
+    // Backs BufferOps.allocate / BufferOps.recycle; created on first use
+    std::shared_ptr<PooledBufferState> default_pool;
+    // HnswIndex class, for wrapping graphs built off the JS thread
+    Napi::FunctionReference hnsw_index;
+    // ZstdDictionary class, for checking dictionary arguments
+    Napi::FunctionReference zstd_dictionary;
+};
+
+AddonData* GetAddonData(Napi::Env env);
@@ -0,0 +1,199 @@
+#include <napi.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include "op-stats.h"
+#include "telephony-dsp.h"
+
+// Telephony audio kernels, exported as module-level functions. Outputs go
+// into caller-supplied Buffers so the voice-call path can reuse frames.
+
+static bool ReadBytes(Napi::Value value, const uint8_t** data, size_t* len) {
+    if (!value.IsTypedArray() || value.As<Napi::TypedArray>().TypedArrayType() != napi_uint8_array) {
+        return false;
+    }
+    Napi::Uint8Array bytes = value.As<Napi::Uint8Array>();
+    *data = bytes.Data();
+    *len = bytes.ByteLength();
+    return true;
+}
+
+static bool ReadOutput(Napi::Value value, uint8_t** data, size_t* len) {
+    const uint8_t* bytes;
+    if (!ReadBytes(value, &bytes, len)) {
+        return false;
+    }
+    *data = const_cast<uint8_t*>(bytes);
+    return true;
+}
+
+static bool ReadLaw(Napi::Value value, G711Law* law) {
+    if (!value.IsString()) {
+        return false;
+    }
+    std::string name = value.As<Napi::String>().Utf8Value();
+    if (name == "mulaw") {
+        *law = G711Law::kMulaw;
+        return true;
+    }
+    if (name == "alaw") {
+        *law = G711Law::kAlaw;
+        return true;
+    }
+    return false;
+}
+
+// g711Encode(pcm, law, output): samples encoded, one byte each into output
+Napi::Value AudioG711Encode(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    const uint8_t* pcm;
+    size_t pcm_len;
+    G711Law law;
+    uint8_t* out;
+    size_t out_len;
+    if (info.Length() < 3 || !ReadBytes(info[0], &pcm, &pcm_len) || !ReadLaw(info[1], &law) ||
+        !ReadOutput(info[2], &out, &out_len)) {
+        Napi::TypeError::New(env, "Expected (pcm, \"mulaw\" | \"alaw\", output)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    size_t samples = pcm_len / 2;
+    if (out_len < samples) {
+        Napi::RangeError::New(env, "output too small").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    OpScope scope(NativeOp::kAudioG711, pcm_len);
+    G711Encode(law, pcm, samples, out);
+    return Napi::Number::New(env, static_cast<double>(samples));
+}
+
+// g711Decode(bytes, law, output): PCM bytes written (2 per input byte)
+Napi::Value AudioG711Decode(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    const uint8_t* in;
+    size_t in_len;
+    G711Law law;
+    uint8_t* out;
+    size_t out_len;
+    if (info.Length() < 3 || !ReadBytes(info[0], &in, &in_len) || !ReadLaw(info[1], &law) ||
+        !ReadOutput(info[2], &out, &out_len)) {
+        Napi::TypeError::New(env, "Expected (bytes, \"mulaw\" | \"alaw\", output)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    if (out_len / 2 < in_len) {
+        Napi::RangeError::New(env, "output too small").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    OpScope scope(NativeOp::kAudioG711, in_len);
+    G711Decode(law, in, in_len, out);
+    return Napi::Number::New(env, static_cast<double>(in_len * 2));
+}
+
+// resamplePcm16(pcm, inputRate, outputRate, output): PCM bytes written, or
+// null when the rate pair needs more than 1024 filter phases. output must
+// hold floor(samples * outputRate / inputRate) samples.
+Napi::Value AudioResamplePcm16(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    const uint8_t* pcm;
+    size_t pcm_len;
+    uint8_t* out;
+    size_t out_len;
+    if (info.Length() < 4 || !ReadBytes(info[0], &pcm, &pcm_len) || !info[1].IsNumber() || !info[2].IsNumber() ||
+        !ReadOutput(info[3], &out, &out_len)) {
+        Napi::TypeError::New(env, "Expected (pcm, inputRate, outputRate, output)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    double in_rate = info[1].As<Napi::Number>().DoubleValue();
+    double out_rate = info[2].As<Napi::Number>().DoubleValue();
+    if (!(in_rate >= 1 && in_rate <= UINT32_MAX) || !(out_rate >= 1 && out_rate <= UINT32_MAX) ||
+        in_rate != std::floor(in_rate) || out_rate != std::floor(out_rate)) {
+        Napi::RangeError::New(env, "rates must be positive integers").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    const ResamplerBank* bank = GetResamplerBank(static_cast<uint32_t>(in_rate), static_cast<uint32_t>(out_rate));
+    if (!bank) {
+        return env.Null();
+    }
+    size_t samples = pcm_len / 2;
+    size_t count = ResampledLength(bank, samples);
+    if (out_len / 2 < count) {
+        Napi::RangeError::New(env, "output too small").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    OpScope scope(NativeOp::kAudioResample, pcm_len);
+    Resample(bank, pcm, samples, out);
+    return Napi::Number::New(env, static_cast<double>(count * 2));
+}
+
+// detectVoice(frame, { encoding?, threshold?, maxZeroCrossingRate? }):
+// { rms, dbfs, zeroCrossingRate, speech }. encoding is "pcm16" (default),
+// "mulaw" or "alaw". speech is dbfs >= threshold (default -45) with at most
+// maxZeroCrossingRate (default 0.5) sign changes per sample, which rules
+// out hiss and line noise that is loud but has no voiced structure.
+Napi::Value AudioDetectVoice(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    const uint8_t* frame;
+    size_t len;
+    if (info.Length() < 1 || !ReadBytes(info[0], &frame, &len)) {
+        Napi::TypeError::New(env, "Expected (frame, options?)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    std::string encoding = "pcm16";
+    double threshold = -45;
+    double max_zcr = 0.5;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Object options = info[1].As<Napi::Object>();
+        Napi::Value value = options.Get("encoding");
+        if (value.IsString()) {
+            encoding = value.As<Napi::String>().Utf8Value();
+        }
+        value = options.Get("threshold");
+        if (value.IsNumber()) {
+            threshold = value.As<Napi::Number>().DoubleValue();
+        }
+        value = options.Get("maxZeroCrossingRate");
+        if (value.IsNumber()) {
+            max_zcr = value.As<Napi::Number>().DoubleValue();
+        }
+    }
+
+    OpScope scope(NativeOp::kAudioVad, len);
+    VoiceActivity activity;
+    if (encoding == "pcm16") {
+        activity = MeasurePcm(frame, len / 2);
+    } else if (encoding == "mulaw") {
+        activity = MeasureG711(G711Law::kMulaw, frame, len);
+    } else if (encoding == "alaw") {
+        activity = MeasureG711(G711Law::kAlaw, frame, len);
+    } else {
+        Napi::TypeError::New(env, "encoding must be \"pcm16\", \"mulaw\" or \"alaw\"").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    // Digital silence reads as -120 dBFS rather than -Infinity
+    double dbfs = activity.rms > 0 ? std::max(20.0 * std::log10(activity.rms / 32768.0), -120.0) : -120.0;
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("rms", Napi::Number::New(env, activity.rms));
+    result.Set("dbfs", Napi::Number::New(env, dbfs));
+    result.Set("zeroCrossingRate", Napi::Number::New(env, activity.zero_crossing_rate));
+    result.Set("speech", Napi::Boolean::New(env, dbfs >= threshold && activity.zero_crossing_rate <= max_zcr));
+    return result;
+}
+
+Napi::Object InitAudioOps(Napi::Env env, Napi::Object exports) {
+    InitTelephonyDsp();
+    exports.Set("g711Encode", Napi::Function::New<AudioG711Encode>(env, "g711Encode"));
+    exports.Set("g711Decode", Napi::Function::New<AudioG711Decode>(env, "g711Decode"));
+    exports.Set("resamplePcm16", Napi::Function::New<AudioResamplePcm16>(env, "resamplePcm16"));
+    exports.Set("detectVoice", Napi::Function::New<AudioDetectVoice>(env, "detectVoice"));
+    return exports;
+}
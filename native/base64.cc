@@ -0,0 +1,362 @@
+#include "base64.h"
+#include "cpu-features.h"
+
+#include <cstring>
+#include <mutex>
+
+#if defined(HAS_X86_SIMD)
+  #include <immintrin.h>
+#elif defined(HAS_ARM_SIMD)
+  #include <arm_neon.h>
+#endif
+
+static const char kAlphabet[65] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// 6-bit value per character; 0x80 marks anything outside the alphabet
+struct DecodeTable {
+    uint8_t value[256];
+
+    constexpr DecodeTable() : value() {
+        for (int i = 0; i < 256; i++) {
+            value[i] = 0x80;
+        }
+        for (int i = 0; i < 64; i++) {
+            value[static_cast<uint8_t>(kAlphabet[i])] = static_cast<uint8_t>(i);
+        }
+    }
+};
+
+static constexpr DecodeTable kDecode;
+
+// Decodes whole quads (no padding); returns the number done, which stops
+// short at a block holding an invalid character so the scalar loop can
+// confirm it. out == nullptr validates only.
+using DecodeFn = size_t (*)(const char* in, size_t quads, uint8_t* out);
+// Encodes whole triples; returns the number done
+using EncodeFn = size_t (*)(const uint8_t* in, size_t triples, char* out);
+
+static size_t DecodeNone(const char*, size_t, uint8_t*) {
+    return 0;
+}
+
+static size_t EncodeNone(const uint8_t*, size_t, char*) {
+    return 0;
+}
+
+// False at the first invalid character
+static bool DecodeQuadsScalar(const char* in, size_t quads, uint8_t* out) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(in);
+    for (size_t q = 0; q < quads; q++, p += 4) {
+        uint32_t a = kDecode.value[p[0]];
+        uint32_t b = kDecode.value[p[1]];
+        uint32_t c = kDecode.value[p[2]];
+        uint32_t d = kDecode.value[p[3]];
+        if ((a | b | c | d) & 0x80) {
+            return false;
+        }
+        if (out != nullptr) {
+            uint32_t v = (a << 18) | (b << 12) | (c << 6) | d;
+            out[3 * q] = static_cast<uint8_t>(v >> 16);
+            out[3 * q + 1] = static_cast<uint8_t>(v >> 8);
+            out[3 * q + 2] = static_cast<uint8_t>(v);
+        }
+    }
+    return true;
+}
+
+static void EncodeTriplesScalar(const uint8_t* in, size_t triples, char* out) {
+    for (size_t t = 0; t < triples; t++, in += 3, out += 4) {
+        uint32_t v = (static_cast<uint32_t>(in[0]) << 16) | (static_cast<uint32_t>(in[1]) << 8) | in[2];
+        out[0] = kAlphabet[v >> 18];
+        out[1] = kAlphabet[(v >> 12) & 63];
+        out[2] = kAlphabet[(v >> 6) & 63];
+        out[3] = kAlphabet[v & 63];
+    }
+}
+
+#if defined(HAS_X86_DISPATCH)
+
+// Per 32 characters: classify each byte by its low and high nibble (a byte
+// is valid when the two class masks share no bit), then add a per-class
+// offset that maps the alphabet to 0-63 ('/' shares its high nibble with
+// '+' and is patched through the eq_2f adjustment). maddubs / madd merge
+// four 6-bit fields into 24 bits per dword; a shuffle and a permute pack the
+// 24 output bytes. Each store writes 32 bytes, so the loop keeps 8 bytes of
+// output headroom.
+OPENCLAW_TARGET("avx2")
+static size_t DecodeAvx2(const char* in, size_t quads, uint8_t* out) {
+    const __m256i lut_lo = _mm256_setr_epi8(
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m256i lut_hi = _mm256_setr_epi8(
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m256i lut_roll = _mm256_setr_epi8(
+        0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i mask_2f = _mm256_set1_epi8(0x2f);
+    const __m256i pack_shuffle = _mm256_setr_epi8(
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    const __m256i pack_permute = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, -1, -1);
+
+    size_t q = 0;
+    for (; q + 11 <= quads; q += 8) {
+        __m256i str = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 4 * q));
+        __m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(str, 4), mask_2f);
+        __m256i lo_nibbles = _mm256_and_si256(str, mask_2f);
+        __m256i lo = _mm256_shuffle_epi8(lut_lo, lo_nibbles);
+        __m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+        if (!_mm256_testz_si256(lo, hi)) {
+            break;
+        }
+        if (out == nullptr) {
+            continue;
+        }
+        __m256i eq_2f = _mm256_cmpeq_epi8(str, mask_2f);
+        __m256i roll = _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(eq_2f, hi_nibbles));
+        str = _mm256_add_epi8(str, roll);
+
+        __m256i merged = _mm256_maddubs_epi16(str, _mm256_set1_epi32(0x01400140));
+        merged = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+        merged = _mm256_shuffle_epi8(merged, pack_shuffle);
+        merged = _mm256_permutevar8x32_epi32(merged, pack_permute);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 3 * q), merged);
+    }
+    return q;
+}
+
+// Per 24 bytes, loaded from 4 bytes before them so that each 128-bit lane
+// holds its 12 input bytes: shuffle every 3 bytes into a dword, split the
+// four 6-bit fields with two multiplies, and map 0-63 to the alphabet with
+// a 16-entry offset table indexed by range
+OPENCLAW_TARGET("avx2")
+static size_t EncodeAvx2(const uint8_t* in, size_t triples, char* out) {
+    const __m256i spread = _mm256_set_epi8(
+        10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+        14, 15, 13, 14, 11, 12, 10, 11, 8, 9, 7, 8, 5, 6, 4, 5);
+    const __m256i offsets = _mm256_setr_epi8(
+        65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0,
+        65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0);
+
+    // Each step reads 28 bytes from the current position (plus the 4 before it)
+    size_t bytes = triples * 3;
+    size_t i = 0;
+    for (; i + 28 <= bytes; i += 24) {
+        __m256i block;
+        if (i == 0) {
+            uint8_t first[32] = {};
+            std::memcpy(first + 4, in, 28);
+            block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+        } else {
+            block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i - 4));
+        }
+        block = _mm256_shuffle_epi8(block, spread);
+        __m256i t0 = _mm256_mulhi_epu16(_mm256_and_si256(block, _mm256_set1_epi32(0x0fc0fc00)),
+                                        _mm256_set1_epi32(0x04000040));
+        __m256i t1 = _mm256_mullo_epi16(_mm256_and_si256(block, _mm256_set1_epi32(0x003f03f0)),
+                                        _mm256_set1_epi32(0x01000010));
+        __m256i indices = _mm256_or_si256(t0, t1);
+
+        __m256i range = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+        range = _mm256_sub_epi8(range, _mm256_cmpgt_epi8(indices, _mm256_set1_epi8(25)));
+        __m256i chars = _mm256_add_epi8(indices, _mm256_shuffle_epi8(offsets, range));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i / 3 * 4), chars);
+    }
+    return i / 3;
+}
+
+#endif  // HAS_X86_DISPATCH
+
+#if defined(HAS_ARM_SIMD)
+
+// Maps 16 characters to 6-bit values in place; the returned mask is
+// non-zero in lanes holding a character outside the alphabet
+static inline uint8x16_t TranslateNeon(uint8x16_t str, uint8x16_t* values) {
+    static const uint8_t kLo[16] = {0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                    0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A};
+    static const uint8_t kHi[16] = {0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10};
+    static const int8_t kRoll[16] = {0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0};
+
+    uint8x16_t hi_nibbles = vshrq_n_u8(str, 4);
+    uint8x16_t lo_nibbles = vandq_u8(str, vdupq_n_u8(0x0f));
+    uint8x16_t lo = vqtbl1q_u8(vld1q_u8(kLo), lo_nibbles);
+    uint8x16_t hi = vqtbl1q_u8(vld1q_u8(kHi), hi_nibbles);
+    uint8x16_t eq_2f = vceqq_u8(str, vdupq_n_u8(0x2f));
+    uint8x16_t roll = vqtbl1q_u8(vreinterpretq_u8_s8(vld1q_s8(kRoll)), vaddq_u8(eq_2f, hi_nibbles));
+    *values = vaddq_u8(str, roll);
+    return vandq_u8(lo, hi);
+}
+
+static size_t DecodeNeon(const char* in, size_t quads, uint8_t* out) {
+    size_t q = 0;
+    for (; q + 16 <= quads; q += 16) {
+        uint8x16x4_t str = vld4q_u8(reinterpret_cast<const uint8_t*>(in + 4 * q));
+        uint8x16_t a, b, c, d;
+        uint8x16_t bad = vorrq_u8(vorrq_u8(TranslateNeon(str.val[0], &a), TranslateNeon(str.val[1], &b)),
+                                  vorrq_u8(TranslateNeon(str.val[2], &c), TranslateNeon(str.val[3], &d)));
+        if (vmaxvq_u8(bad) != 0) {
+            break;
+        }
+        if (out == nullptr) {
+            continue;
+        }
+        uint8x16x3_t bytes;
+        bytes.val[0] = vorrq_u8(vshlq_n_u8(a, 2), vshrq_n_u8(b, 4));
+        bytes.val[1] = vorrq_u8(vshlq_n_u8(b, 4), vshrq_n_u8(c, 2));
+        bytes.val[2] = vorrq_u8(vshlq_n_u8(c, 6), d);
+        vst3q_u8(out + 3 * q, bytes);
+    }
+    return q;
+}
+
+static size_t EncodeNeon(const uint8_t* in, size_t triples, char* out) {
+    uint8x16x4_t alphabet = vld1q_u8_x4(reinterpret_cast<const uint8_t*>(kAlphabet));
+    const uint8x16_t mask = vdupq_n_u8(0x3f);
+    size_t t = 0;
+    for (; t + 16 <= triples; t += 16) {
+        uint8x16x3_t bytes = vld3q_u8(in + 3 * t);
+        uint8x16x4_t chars;
+        chars.val[0] = vshrq_n_u8(bytes.val[0], 2);
+        chars.val[1] = vandq_u8(vorrq_u8(vshlq_n_u8(bytes.val[0], 4), vshrq_n_u8(bytes.val[1], 4)), mask);
+        chars.val[2] = vandq_u8(vorrq_u8(vshlq_n_u8(bytes.val[1], 2), vshrq_n_u8(bytes.val[2], 6)), mask);
+        chars.val[3] = vandq_u8(bytes.val[2], mask);
+        for (int k = 0; k < 4; k++) {
+            chars.val[k] = vqtbl4q_u8(alphabet, chars.val[k]);
+        }
+        vst4q_u8(reinterpret_cast<uint8_t*>(out + 4 * t), chars);
+    }
+    return t;
+}
+
+#endif  // HAS_ARM_SIMD
+
+static DecodeFn decode_impl = DecodeNone;
+static EncodeFn encode_impl = EncodeNone;
+
+static void SelectKernels() {
+#if defined(HAS_X86_DISPATCH)
+    if (GetCpuFeatures().avx2) {
+        decode_impl = DecodeAvx2;
+        encode_impl = EncodeAvx2;
+    }
+#elif defined(HAS_ARM_SIMD)
+    decode_impl = DecodeNeon;
+    encode_impl = EncodeNeon;
+#endif
+}
+
+void InitBase64() {
+    static std::once_flag once;
+    std::call_once(once, SelectKernels);
+}
+
+size_t Base64DecodedSize(const char* in, size_t len) {
+    if (len < 4) {
+        return 0;
+    }
+    size_t pad = (in[len - 1] == '=') + (in[len - 1] == '=' && in[len - 2] == '=');
+    return len / 4 * 3 - pad;
+}
+
+// Whole quads through the SIMD kernel, then the scalar loop from wherever
+// it stopped. With out == nullptr the kernels only validate.
+static bool DecodeQuads(const char* in, size_t quads, uint8_t* out) {
+    size_t done = decode_impl(in, quads, out);
+    return DecodeQuadsScalar(in + 4 * done, quads - done, out == nullptr ? nullptr : out + 3 * done);
+}
+
+bool Base64Decode(const char* in, size_t len, uint8_t* out) {
+    if (len % 4 != 0) {
+        return false;
+    }
+    if (len == 0) {
+        return true;
+    }
+
+    size_t body = len / 4 - 1;
+    if (!DecodeQuads(in, body, out)) {
+        return false;
+    }
+
+    // Last quad: "xxxx", "xxx=" or "xx=="
+    const uint8_t* last = reinterpret_cast<const uint8_t*>(in + 4 * body);
+    size_t pad = (last[3] == '=') + (last[3] == '=' && last[2] == '=');
+    uint32_t v = 0;
+    for (size_t k = 0; k < 4 - pad; k++) {
+        uint32_t value = kDecode.value[last[k]];
+        if (value & 0x80) {
+            return false;
+        }
+        v |= value << (18 - 6 * k);
+    }
+    if (out != nullptr) {
+        uint8_t* tail = out + 3 * body;
+        tail[0] = static_cast<uint8_t>(v >> 16);
+        if (pad < 2) {
+            tail[1] = static_cast<uint8_t>(v >> 8);
+        }
+        if (pad < 1) {
+            tail[2] = static_cast<uint8_t>(v);
+        }
+    }
+    return true;
+}
+
+size_t Base64Encode(const uint8_t* in, size_t len, char* out) {
+    size_t triples = len / 3;
+    size_t done = encode_impl(in, triples, out);
+    EncodeTriplesScalar(in + 3 * done, triples - done, out + 4 * done);
+
+    size_t rest = len - 3 * triples;
+    char* tail = out + 4 * triples;
+    if (rest > 0) {
+        uint32_t v = static_cast<uint32_t>(in[3 * triples]) << 16;
+        if (rest == 2) {
+            v |= static_cast<uint32_t>(in[3 * triples + 1]) << 8;
+        }
+        tail[0] = kAlphabet[v >> 18];
+        tail[1] = kAlphabet[(v >> 12) & 63];
+        tail[2] = rest == 2 ? kAlphabet[(v >> 6) & 63] : '=';
+        tail[3] = '=';
+    }
+    return Base64EncodedSize(len);
+}
+
+static bool IsAsciiSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+Base64Payload FindBase64Payload(const char* in, size_t len, bool data_url) {
+    size_t begin = 0;
+    size_t end = len;
+    while (begin < end && IsAsciiSpace(in[begin])) {
+        begin++;
+    }
+    while (end > begin && IsAsciiSpace(in[end - 1])) {
+        end--;
+    }
+
+    Base64Payload payload;
+    static const char kScheme[] = "data:";
+    static const char kMarker[] = ";base64,";
+    const size_t scheme_len = sizeof(kScheme) - 1;
+    const size_t marker_len = sizeof(kMarker) - 1;
+    if (data_url && end - begin > scheme_len && std::memcmp(in + begin, kScheme, scheme_len) == 0) {
+        const char* type = in + begin + scheme_len;
+        const void* semicolon = std::memchr(type, ';', end - begin - scheme_len);
+        if (semicolon != nullptr) {
+            size_t type_len = static_cast<size_t>(static_cast<const char*>(semicolon) - type);
+            size_t after = begin + scheme_len + type_len;
+            if (type_len > 0 && end - after >= marker_len && std::memcmp(in + after, kMarker, marker_len) == 0) {
+                payload.type_offset = begin + scheme_len;
+                payload.type_length = type_len;
+                begin = after + marker_len;
+            }
+        }
+    }
+    payload.offset = begin;
+    payload.length = end - begin;
+    return payload;
+}
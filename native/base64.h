@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Standard-alphabet base64 (RFC 4648 section 4) with '=' padding. N-API free.
+//
+// Decoding validates as it goes: the input length must be a multiple of 4,
+// every character must be in the alphabet, and '=' may only pad the last
+// quad. Bits past the last whole byte are ignored, as Buffer.from() does.
+// Whitespace inside the payload is not accepted.
+//
+// AVX2 kernels translate and validate 32 characters per step with nibble
+// lookup tables (Muła / Lemire); NEON kernels handle 64 characters per step
+// through de-interleaving loads. Other hosts, and the last few quads, use a
+// table-driven scalar loop.
+
+// Pick kernels for this host. Idempotent; called from module init.
+void InitBase64();
+
+// Bytes that a well-formed payload of `len` characters decodes to
+size_t Base64DecodedSize(const char* in, size_t len);
+
+// Characters Base64Encode writes for `len` bytes
+constexpr size_t Base64EncodedSize(size_t len) {
+    return (len + 2) / 3 * 4;
+}
+
+// Decodes in[0, len) into out, which must hold Base64DecodedSize() bytes.
+// With out == nullptr the input is only validated. False on invalid input;
+// out may then hold a partial result.
+bool Base64Decode(const char* in, size_t len, uint8_t* out);
+
+// Encodes in[0, len) into out[0, Base64EncodedSize(len)); returns that size.
+size_t Base64Encode(const uint8_t* in, size_t len, char* out);
+
+// Where the base64 text sits inside an attachment string: surrounding ASCII
+// whitespace is skipped and, with `data_url`, a "data:<type>;base64," prefix
+// (the type may not contain ';', as in the gateway's original pattern).
+struct Base64Payload {
+    size_t offset = 0;
+    size_t length = 0;
+    // The data URL's declared type; length 0 when there was no prefix
+    size_t type_offset = 0;
+    size_t type_length = 0;
+};
+
+Base64Payload FindBase64Payload(const char* in, size_t len, bool data_url);
@@ -1,11 +1,64 @@
 {
+  "variables": {
+    # In-memory JPEG resizing needs libjpeg-turbo; without it image-ops
+    # keeps using sharp / sips. Override with --openclaw_jpeg=0|1.
+    "openclaw_jpeg%": "<!(pkg-config --exists libjpeg && echo 1 || echo 0)",
+    # Streaming zstd contexts and dictionaries need libzstd; without it
+    # ultraCompress keeps using the Rust core. Override with --openclaw_zstd=0|1.
+    "openclaw_zstd%": "<!(pkg-config --exists libzstd && echo 1 || echo 0)",
+    # Google Benchmark binary for the N-API free kernels (native-bench.cc).
+    # Opt-in: node-gyp rebuild --openclaw_benchmark=1
+    "openclaw_benchmark%": "0"
+  },
   "targets": [
     {
       "target_name": "openclaw_native",
       "sources": [
         "main.cc",
+        "cpu-features.cc",
+        "simd-kernels.cc",
+        "pattern-search.cc",
+        "sha256.cc",
+        "markdown-chunker.cc",
+        "file-hash.cc",
+        "transcript-scanner.cc",
+        "media-probe.cc",
+        "base64.cc",
+        "utf8.cc",
+        "telephony-dsp.cc",
+        "op-stats.cc",
+        "vector-ops.cc",
+        "vector-store.cc",
+        "hnsw-graph.cc",
+        "rate-table.cc",
+        "ttl-store.cc",
+        "history-store.cc",
+        "bm25-index.cc",
+        "embedding-store.cc",
+        "event-ring.cc",
+        "bpe-tokenizer.cc",
+        "multi-pattern.cc",
+        "slab-pool.cc",
+        "thread-pool.cc",
+        "parallel-ops.cc",
         "buffer-ops.cc",
-        "simd-ops.cc"
+        "buffer-pool.cc",
+        "simd-ops.cc",
+        "multi-matcher.cc",
+        "vector-index.cc",
+        "hnsw-index.cc",
+        "rate-limit-table.cc",
+        "ttl-cache.cc",
+        "group-history.cc",
+        "keyword-index.cc",
+        "embedding-cache.cc",
+        "event-bus.cc",
+        "tokenizer.cc",
+        "text-ops.cc",
+        "file-ops.cc",
+        "media-ops.cc",
+        "audio-ops.cc",
+        "stats-ops.cc"
       ],
       "include_dirs": [
         "<!@(node -p \"require('node-addon-api').include\")"
@@ -15,24 +68,40 @@
       ],
       "cflags!": ["-fno-exceptions"],
       "cflags_cc!": ["-fno-exceptions"],
+      # No -ffast-math: argument checks such as !(x >= 1) rely on NaN
+      # comparing false, and the SIMD kernels are written with intrinsics.
       "conditions": [
+        ["openclaw_jpeg==1", {
+          "sources": ["image-pipeline.cc"],
+          "defines": ["OPENCLAW_HAVE_JPEG"],
+          "cflags": ["<!@(pkg-config --cflags libjpeg)"],
+          "xcode_settings": {
+            "OTHER_CPLUSPLUSFLAGS": ["<!@(pkg-config --cflags libjpeg)"]
+          },
+          "libraries": ["<!@(pkg-config --libs libjpeg)"]
+        }],
+        ["openclaw_zstd==1", {
+          "sources": ["zstd-stream.cc", "transcript-archive.cc", "zstd-ops.cc"],
+          "defines": ["OPENCLAW_HAVE_ZSTD"],
+          "cflags": ["<!@(pkg-config --cflags libzstd)"],
+          "xcode_settings": {
+            "OTHER_CPLUSPLUSFLAGS": ["<!@(pkg-config --cflags libzstd)"]
+          },
+          "libraries": ["<!@(pkg-config --libs libzstd)"]
+        }],
         ["OS=='mac'", {
           "xcode_settings": {
             "GCC_ENABLE_CPP_EXCEPTIONS": "YES",
             "CLANG_CXX_LIBRARY": "libc++",
             "MACOSX_DEPLOYMENT_TARGET": "10.15",
             "OTHER_CFLAGS": [
-              "-O3",
-              "-march=native",
-              "-ffast-math"
+              "-O3"
             ]
           }
         }],
         ["OS=='linux'", {
           "cflags": [
-            "-O3",
-            "-march=native",
-            "-ffast-math"
+            "-O3"
           ],
           "ldflags": [
             "-Wl,--no-as-needed"
@@ -40,5 +109,37 @@
         }]
       ]
     }
+  ],
+  "conditions": [
+    ["openclaw_benchmark==1", {
+      "targets": [
+        {
+          "target_name": "native_bench",
+          "type": "executable",
+          "sources": [
+            "native-bench.cc",
+            "cpu-features.cc",
+            "simd-kernels.cc",
+            "pattern-search.cc",
+            "multi-pattern.cc",
+            "sha256.cc",
+            "markdown-chunker.cc",
+            "vector-ops.cc",
+            "thread-pool.cc",
+            "parallel-ops.cc"
+          ],
+          "cflags!": ["-fno-exceptions"],
+          "cflags_cc!": ["-fno-exceptions"],
+          "cflags": ["<!@(pkg-config --cflags benchmark)", "-O3"],
+          "xcode_settings": {
+            "GCC_ENABLE_CPP_EXCEPTIONS": "YES",
+            "CLANG_CXX_LIBRARY": "libc++",
+            "MACOSX_DEPLOYMENT_TARGET": "10.15",
+            "OTHER_CPLUSPLUSFLAGS": ["<!@(pkg-config --cflags benchmark)", "-O3"]
+          },
+          "libraries": ["<!@(pkg-config --libs benchmark)", "-lpthread"]
+        }
+      ]
+    }]
   ]
-}
\ No newline at end of file
+}
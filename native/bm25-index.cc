@@ -0,0 +1,857 @@
+#include "bm25-index.h"
+#include "cpu-features.h"
+#include "unicode-classes.h"
+#include "utf8.h"
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <queue>
+
+#if defined(HAS_X86_SIMD)
+  #include <immintrin.h>
+#elif defined(HAS_ARM_SIMD)
+  #include <arm_neon.h>
+#endif
+
+namespace {
+
+constexpr uint32_t kEnd = UINT32_MAX;
+// Doc numbers stay below this so SIMD lanes can compare them as signed
+constexpr uint32_t kMaxDocs = 0x7fffffff;
+// Tombstones tolerated before Remove() considers a rebuild
+constexpr size_t kCompactMinDead = 1024;
+
+// Index of the first docs[i] >= target; docs is sorted ascending.
+using LowerBoundFn = size_t (*)(const uint32_t* docs, size_t n, uint32_t target);
+
+size_t LowerBoundScalar(const uint32_t* docs, size_t n, uint32_t target) {
+    size_t i = 0;
+    while (i < n && docs[i] < target) {
+        i++;
+    }
+    return i;
+}
+
+#if defined(HAS_X86_DISPATCH)
+
+OPENCLAW_TARGET("sse2")
+size_t LowerBoundSse2(const uint32_t* docs, size_t n, uint32_t target) {
+    const __m128i t = _mm_set1_epi32(static_cast<int>(target));
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(docs + i));
+        // Sorted input: the lanes below target form a prefix
+        unsigned mask = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(v, t))));
+        if (mask != 0xf) {
+            return i + static_cast<size_t>(__builtin_popcount(mask));
+        }
+    }
+    return i + LowerBoundScalar(docs + i, n - i, target);
+}
+
+OPENCLAW_TARGET("avx2")
+size_t LowerBoundAvx2(const uint32_t* docs, size_t n, uint32_t target) {
+    const __m256i t = _mm256_set1_epi32(static_cast<int>(target));
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(docs + i));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(t, v))));
+        if (mask != 0xff) {
+            return i + static_cast<size_t>(__builtin_popcount(mask));
+        }
+    }
+    return i + LowerBoundSse2(docs + i, n - i, target);
+}
+
+#endif  // HAS_X86_DISPATCH
+
+#if defined(HAS_ARM_SIMD)
+
+size_t LowerBoundNeon(const uint32_t* docs, size_t n, uint32_t target) {
+    const uint32x4_t t = vdupq_n_u32(target);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        uint32x4_t lt = vcltq_u32(vld1q_u32(docs + i), t);
+        if (vminvq_u32(lt) == 0) {
+            // Each set lane is all ones; negate the sum to count them
+            return i + static_cast<size_t>(-static_cast<int32_t>(vaddvq_u32(lt)));
+        }
+    }
+    return i + LowerBoundScalar(docs + i, n - i, target);
+}
+
+#endif  // HAS_ARM_SIMD
+
+LowerBoundFn lower_bound_impl = LowerBoundScalar;
+
+void SelectLowerBound() {
+#if defined(HAS_X86_DISPATCH)
+    const CpuFeatures& cpu = GetCpuFeatures();
+    if (cpu.avx2) {
+        lower_bound_impl = LowerBoundAvx2;
+    } else if (cpu.sse2) {
+        lower_bound_impl = LowerBoundSse2;
+    }
+#elif defined(HAS_ARM_SIMD)
+    lower_bound_impl = LowerBoundNeon;
+#endif
+}
+
+void PutVarint(std::vector<uint8_t>& out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+const uint8_t* GetVarint(const uint8_t* p, uint32_t* value) {
+    uint32_t result = *p & 0x7f;
+    int shift = 7;
+    while (*p++ & 0x80) {
+        result |= static_cast<uint32_t>(*p & 0x7f) << shift;
+        shift += 7;
+    }
+    *value = result;
+    return p;
+}
+
+// ASCII: 0 = separator, otherwise the byte as it appears in the token
+struct TokenTable {
+    uint8_t map[128];
+    TokenTable() {
+        for (int c = 0; c < 128; c++) {
+            map[c] = 0;
+            if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')) {
+                map[c] = static_cast<uint8_t>(c);
+            } else if (c >= 'A' && c <= 'Z') {
+                map[c] = static_cast<uint8_t>(c - 'A' + 'a');
+            }
+        }
+    }
+};
+
+const TokenTable kTokens;
+
+// Lowercase, diacritic-free form of U+00C0..U+017F (Latin-1 Supplement and
+// Latin Extended-A), as FTS5 unicode61 folds them; 0 for the two symbols
+const uint16_t kLatinFold[192] = {
+    0x0061, 0x0061, 0x0061, 0x0061, 0x0061, 0x0061, 0x00e6, 0x0063,
+    0x0065, 0x0065, 0x0065, 0x0065, 0x0069, 0x0069, 0x0069, 0x0069,
+    0x00f0, 0x006e, 0x006f, 0x006f, 0x006f, 0x006f, 0x006f, 0x0000,
+    0x006f, 0x0075, 0x0075, 0x0075, 0x0075, 0x0079, 0x00fe, 0x00df,
+    0x0061, 0x0061, 0x0061, 0x0061, 0x0061, 0x0061, 0x00e6, 0x0063,
+    0x0065, 0x0065, 0x0065, 0x0065, 0x0069, 0x0069, 0x0069, 0x0069,
+    0x00f0, 0x006e, 0x006f, 0x006f, 0x006f, 0x006f, 0x006f, 0x0000,
+    0x006f, 0x0075, 0x0075, 0x0075, 0x0075, 0x0079, 0x00fe, 0x0079,
+    0x0061, 0x0061, 0x0061, 0x0061, 0x0061, 0x0061, 0x0063, 0x0063,
+    0x0063, 0x0063, 0x0063, 0x0063, 0x0063, 0x0063, 0x0064, 0x0064,
+    0x0064, 0x0064, 0x0065, 0x0065, 0x0065, 0x0065, 0x0065, 0x0065,
+    0x0065, 0x0065, 0x0065, 0x0065, 0x0067, 0x0067, 0x0067, 0x0067,
+    0x0067, 0x0067, 0x0067, 0x0067, 0x0068, 0x0068, 0x0068, 0x0068,
+    0x0069, 0x0069, 0x0069, 0x0069, 0x0069, 0x0069, 0x0069, 0x0069,
+    0x0069, 0x0069, 0x0133, 0x0133, 0x006a, 0x006a, 0x006b, 0x006b,
+    0x0138, 0x006c, 0x006c, 0x006c, 0x006c, 0x006c, 0x006c, 0x006c,
+    0x006c, 0x006c, 0x006c, 0x006e, 0x006e, 0x006e, 0x006e, 0x006e,
+    0x006e, 0x0149, 0x014b, 0x014b, 0x006f, 0x006f, 0x006f, 0x006f,
+    0x006f, 0x006f, 0x0153, 0x0153, 0x0072, 0x0072, 0x0072, 0x0072,
+    0x0072, 0x0072, 0x0073, 0x0073, 0x0073, 0x0073, 0x0073, 0x0073,
+    0x0073, 0x0073, 0x0074, 0x0074, 0x0074, 0x0074, 0x0074, 0x0074,
+    0x0075, 0x0075, 0x0075, 0x0075, 0x0075, 0x0075, 0x0075, 0x0075,
+    0x0075, 0x0075, 0x0075, 0x0075, 0x0077, 0x0077, 0x0079, 0x0079,
+    0x0079, 0x007a, 0x007a, 0x007a, 0x007a, 0x007a, 0x007a, 0x0073,
+};
+
+// Combining diacritical marks: part of the word they follow, then dropped
+bool IsCombiningMark(uint32_t cp) {
+    return cp >= 0x300 && cp <= 0x36f;
+}
+
+bool IsTokenChar(uint32_t cp) {
+    return cp != kUtf8Replacement && (InRanges(kLetterRanges, cp) || InRanges(kNumberRanges, cp));
+}
+
+// Case and diacritic folding of a non-ASCII letter or number: Latin through
+// the table, Greek and Cyrillic capitals to lowercase, the rest unchanged
+uint32_t FoldCodePoint(uint32_t cp) {
+    if (cp >= 0xc0 && cp < 0x180) {
+        return kLatinFold[cp - 0xc0];
+    }
+    if ((cp >= 0x391 && cp <= 0x3a9) || (cp >= 0x410 && cp <= 0x42f)) {
+        return cp + 0x20;
+    }
+    if (cp >= 0x400 && cp <= 0x40f) {
+        return cp + 0x50;
+    }
+    return cp;
+}
+
+void AppendUtf8(std::string* out, uint32_t cp) {
+    if (cp < 0x80) {
+        out->push_back(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+        out->push_back(static_cast<char>(0xc0 | (cp >> 6)));
+        out->push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+    } else if (cp < 0x10000) {
+        out->push_back(static_cast<char>(0xe0 | (cp >> 12)));
+        out->push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3f)));
+        out->push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+    } else {
+        out->push_back(static_cast<char>(0xf0 | (cp >> 18)));
+        out->push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3f)));
+        out->push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3f)));
+        out->push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+    }
+}
+
+struct HitWorse {
+    bool operator()(const Bm25Index::Hit& a, const Bm25Index::Hit& b) const {
+        return a.score > b.score || (a.score == b.score && a.doc < b.doc);
+    }
+};
+
+// Bounded min-heap of the best k hits
+class TopK {
+public:
+    explicit TopK(size_t k) : k_(k) {}
+
+    bool Full() const { return heap_.size() >= k_; }
+    float Threshold() const { return Full() ? heap_.top().score : 0.0f; }
+
+    void Push(uint32_t doc, float score) {
+        if (!Full()) {
+            heap_.push({doc, score});
+        } else if (score > heap_.top().score) {
+            heap_.pop();
+            heap_.push({doc, score});
+        }
+    }
+
+    std::vector<Bm25Index::Hit> Take() {
+        std::vector<Bm25Index::Hit> out(heap_.size());
+        for (size_t i = out.size(); i > 0; i--) {
+            out[i - 1] = heap_.top();
+            heap_.pop();
+        }
+        return out;
+    }
+
+private:
+    size_t k_;
+    std::priority_queue<Bm25Index::Hit, std::vector<Bm25Index::Hit>, HitWorse> heap_;
+};
+
+}  // namespace
+
+// Forward iterator over one term's postings, decoding a block at a time
+class Bm25Index::Cursor {
+public:
+    Cursor(const Posting* posting, float idf) : p_(posting), idf_(idf) {
+        blocks_ = p_->blocks.size() + (p_->tail_docs.empty() ? 0 : 1);
+        Load(0);
+    }
+
+    uint32_t Doc() const { return doc_; }
+    uint32_t Tf() const { return tfs_[pos_]; }
+    float Idf() const { return idf_; }
+    size_t Length() const { return p_->blocks.size() * kBlock + p_->tail_docs.size(); }
+    const Posting& GetPosting() const { return *p_; }
+    BlockMeta Current() const { return Meta(block_); }
+
+    uint32_t Next() {
+        if (++pos_ < n_) {
+            doc_ = docs_[pos_];
+        } else {
+            Load(block_ + 1);
+        }
+        return doc_;
+    }
+
+    uint32_t NextGEQ(uint32_t target) {
+        if (doc_ >= target) {
+            return doc_;
+        }
+        if (Meta(block_).last_doc < target) {
+            Load(FindBlock(target));
+            if (doc_ >= target) {
+                return doc_;
+            }
+        }
+        // Gallop to a window holding target, then scan it with SIMD
+        size_t lo = pos_;
+        size_t step = 8;
+        while (lo + step < n_ && docs_[lo + step] < target) {
+            lo += step;
+            step <<= 1;
+        }
+        size_t hi = std::min(n_, lo + step + 1);
+        pos_ = lo + lower_bound_impl(docs_ + lo, hi - lo, target);
+        doc_ = docs_[pos_];
+        return doc_;
+    }
+
+    // Directory entry of the block holding the first doc >= target, without
+    // decoding it. False when there is none.
+    bool Shallow(uint32_t target, BlockMeta* meta) const {
+        if (doc_ == kEnd) {
+            return false;
+        }
+        size_t b = Meta(block_).last_doc >= target ? block_ : FindBlock(target);
+        if (b >= blocks_) {
+            return false;
+        }
+        *meta = Meta(b);
+        return true;
+    }
+
+private:
+    BlockMeta Meta(size_t b) const {
+        if (b < p_->blocks.size()) {
+            return p_->blocks[b];
+        }
+        return BlockMeta{p_->tail_docs.back(), 0, p_->tail_max_tf, p_->tail_min_len,
+                         static_cast<uint32_t>(p_->tail_docs.size())};
+    }
+
+    // First block after the current one whose last doc >= target (blocks_
+    // when none): exponential probe, then binary search
+    size_t FindBlock(uint32_t target) const {
+        size_t lo = block_;
+        size_t step = 1;
+        size_t hi = lo + 1;
+        while (hi < blocks_ && Meta(hi).last_doc < target) {
+            lo = hi;
+            step <<= 1;
+            hi = lo + step;
+        }
+        hi = std::min(hi, blocks_);
+        size_t l = lo + 1;
+        while (l < hi) {
+            size_t mid = l + (hi - l) / 2;
+            if (Meta(mid).last_doc < target) {
+                l = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return l;
+    }
+
+    void Load(size_t b) {
+        block_ = b;
+        pos_ = 0;
+        if (b >= blocks_) {
+            n_ = 0;
+            doc_ = kEnd;
+            return;
+        }
+        if (b < p_->blocks.size()) {
+            const BlockMeta& meta = p_->blocks[b];
+            const uint8_t* in = p_->bytes.data() + meta.offset;
+            uint32_t doc = b > 0 ? p_->blocks[b - 1].last_doc : 0;
+            n_ = meta.count;
+            for (size_t i = 0; i < n_; i++) {
+                uint32_t delta;
+                in = GetVarint(in, &delta);
+                doc += delta;
+                docs_[i] = doc;
+            }
+            for (size_t i = 0; i < n_; i++) {
+                in = GetVarint(in, &tfs_[i]);
+            }
+        } else {
+            n_ = p_->tail_docs.size();
+            std::copy(p_->tail_docs.begin(), p_->tail_docs.end(), docs_);
+            std::copy(p_->tail_tfs.begin(), p_->tail_tfs.end(), tfs_);
+        }
+        doc_ = docs_[0];
+    }
+
+    const Posting* p_;
+    float idf_;
+    size_t blocks_ = 0;
+    size_t block_ = 0;
+    size_t pos_ = 0;
+    size_t n_ = 0;
+    uint32_t doc_ = kEnd;
+    uint32_t docs_[kBlock];
+    uint32_t tfs_[kBlock];
+};
+
+Bm25Index::Bm25Index(const Bm25Params& params) : params_(params) {
+    static std::once_flag once;
+    std::call_once(once, SelectLowerBound);
+}
+
+void Bm25Index::Tokenize(const char* text, size_t len, std::vector<std::string>* out) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(text);
+    std::string token;
+    size_t i = 0;
+    while (i < len) {
+        if (p[i] < 0x80) {
+            uint8_t c = kTokens.map[p[i]];
+            i++;
+            if (c != 0) {
+                token.push_back(static_cast<char>(c));
+                continue;
+            }
+        } else {
+            uint32_t cp;
+            i += Utf8Decode(p + i, len - i, &cp);
+            if (IsTokenChar(cp)) {
+                AppendUtf8(&token, FoldCodePoint(cp));
+                continue;
+            }
+            if (IsCombiningMark(cp) && !token.empty()) {
+                continue;
+            }
+        }
+        if (!token.empty()) {
+            out->push_back(std::move(token));
+            token.clear();
+        }
+    }
+    if (!token.empty()) {
+        out->push_back(std::move(token));
+    }
+}
+
+bool Bm25Index::Add(const std::string& id, const char* text, size_t len, const std::string& tag) {
+    auto tag_it = std::find(tags_.begin(), tags_.end(), tag);
+    if (tag_it == tags_.end() && tags_.size() >= kMaxTags) {
+        return false;
+    }
+    uint8_t tag_index = static_cast<uint8_t>(tag_it - tags_.begin());
+    if (tag_it == tags_.end()) {
+        tags_.push_back(tag);
+    }
+
+    Remove(id);
+    if (docs_.size() >= kMaxDocs) {
+        Compact();
+    }
+
+    std::vector<std::string> tokens;
+    Tokenize(text, len, &tokens);
+
+    Doc doc;
+    doc.id = id;
+    doc.len = static_cast<uint32_t>(tokens.size());
+    doc.tag = tag_index;
+    doc.alive = true;
+    doc.terms.reserve(tokens.size());
+    for (std::string& token : tokens) {
+        auto inserted = term_ids_.emplace(std::move(token), static_cast<uint32_t>(postings_.size()));
+        if (inserted.second) {
+            postings_.emplace_back();
+        }
+        doc.terms.emplace_back(inserted.first->second, 1);
+    }
+    std::sort(doc.terms.begin(), doc.terms.end());
+    size_t unique = 0;
+    for (size_t i = 0; i < doc.terms.size(); i++) {
+        if (unique > 0 && doc.terms[unique - 1].first == doc.terms[i].first) {
+            doc.terms[unique - 1].second++;
+        } else {
+            doc.terms[unique++] = doc.terms[i];
+        }
+    }
+    doc.terms.resize(unique);
+    doc.terms.shrink_to_fit();
+
+    uint32_t number = static_cast<uint32_t>(docs_.size());
+    for (const auto& term : doc.terms) {
+        Append(term.first, number, term.second, doc.len);
+        postings_[term.first].live_df++;
+    }
+    total_len_ += doc.len;
+    by_id_.emplace(id, number);
+    docs_.push_back(std::move(doc));
+    return true;
+}
+
+void Bm25Index::Append(uint32_t term, uint32_t doc, uint32_t tf, uint32_t len) {
+    Posting& p = postings_[term];
+    p.tail_docs.push_back(doc);
+    p.tail_tfs.push_back(tf);
+    p.tail_max_tf = std::max(p.tail_max_tf, tf);
+    p.tail_min_len = std::min(p.tail_min_len, len);
+    p.max_tf = std::max(p.max_tf, tf);
+    p.min_len = std::min(p.min_len, len);
+    if (p.tail_docs.size() == kBlock) {
+        SealTail(p);
+    }
+}
+
+void Bm25Index::SealTail(Posting& p) {
+    BlockMeta meta;
+    meta.last_doc = p.tail_docs.back();
+    meta.offset = static_cast<uint32_t>(p.bytes.size());
+    meta.max_tf = p.tail_max_tf;
+    meta.min_len = p.tail_min_len;
+    meta.count = static_cast<uint32_t>(p.tail_docs.size());
+
+    uint32_t prev = p.blocks.empty() ? 0 : p.blocks.back().last_doc;
+    for (uint32_t doc : p.tail_docs) {
+        PutVarint(p.bytes, doc - prev);
+        prev = doc;
+    }
+    for (uint32_t tf : p.tail_tfs) {
+        PutVarint(p.bytes, tf);
+    }
+    p.blocks.push_back(meta);
+
+    p.tail_docs.clear();
+    p.tail_tfs.clear();
+    p.tail_max_tf = 0;
+    p.tail_min_len = UINT32_MAX;
+}
+
+bool Bm25Index::Remove(const std::string& id) {
+    auto found = by_id_.find(id);
+    if (found == by_id_.end()) {
+        return false;
+    }
+    Doc& doc = docs_[found->second];
+    for (const auto& term : doc.terms) {
+        postings_[term.first].live_df--;
+    }
+    total_len_ -= doc.len;
+    doc.alive = false;
+    doc.terms.clear();
+    doc.terms.shrink_to_fit();
+    doc.id.clear();
+    doc.id.shrink_to_fit();
+    by_id_.erase(found);
+    dead_++;
+
+    if (dead_ > kCompactMinDead && dead_ > by_id_.size()) {
+        Compact();
+    }
+    return true;
+}
+
+// Renumbers live documents and terms densely and rebuilds the postings
+void Bm25Index::Compact() {
+    std::vector<uint32_t> term_map(postings_.size(), kEnd);
+    uint32_t terms = 0;
+    for (size_t t = 0; t < postings_.size(); t++) {
+        if (postings_[t].live_df > 0) {
+            term_map[t] = terms++;
+        }
+    }
+    for (auto it = term_ids_.begin(); it != term_ids_.end();) {
+        if (term_map[it->second] == kEnd) {
+            it = term_ids_.erase(it);
+        } else {
+            it->second = term_map[it->second];
+            ++it;
+        }
+    }
+
+    std::vector<Doc> old_docs = std::move(docs_);
+    docs_.clear();
+    docs_.reserve(by_id_.size());
+    postings_.assign(terms, Posting());
+    for (Doc& doc : old_docs) {
+        if (!doc.alive) {
+            continue;
+        }
+        uint32_t number = static_cast<uint32_t>(docs_.size());
+        // Old term order is kept, so the pairs stay sorted
+        for (auto& term : doc.terms) {
+            term.first = term_map[term.first];
+            Append(term.first, number, term.second, doc.len);
+            postings_[term.first].live_df++;
+        }
+        by_id_[doc.id] = number;
+        docs_.push_back(std::move(doc));
+    }
+    dead_ = 0;
+}
+
+void Bm25Index::Clear() {
+    docs_.clear();
+    by_id_.clear();
+    postings_.clear();
+    term_ids_.clear();
+    tags_.clear();
+    total_len_ = 0;
+    dead_ = 0;
+}
+
+float Bm25Index::Idf(uint32_t df) const {
+    double n = static_cast<double>(by_id_.size());
+    double idf = std::log((n - df + 0.5) / (df + 0.5));
+    return static_cast<float>(idf <= 0 ? 1e-6 : idf);
+}
+
+float Bm25Index::TermScore(float idf, uint32_t tf, uint32_t len) const {
+    float avg = by_id_.empty() ? 1.0f : static_cast<float>(total_len_) / by_id_.size();
+    if (avg <= 0) {
+        avg = 1.0f;
+    }
+    float f = static_cast<float>(tf);
+    float norm = params_.k1 * (1.0f - params_.b + params_.b * static_cast<float>(len) / avg);
+    return idf * f * (params_.k1 + 1.0f) / (f + norm);
+}
+
+bool Bm25Index::ParseQuery(const char* query, size_t len, const QueryOptions& options,
+                           std::vector<QueryTerm>* terms, uint32_t* tag_mask) const {
+    terms->clear();
+    *tag_mask = 0;
+    if (options.tags.empty()) {
+        *tag_mask = UINT32_MAX;
+    }
+    for (const std::string& tag : options.tags) {
+        auto it = std::find(tags_.begin(), tags_.end(), tag);
+        if (it != tags_.end()) {
+            *tag_mask |= 1u << (it - tags_.begin());
+        }
+    }
+
+    std::vector<std::string> tokens;
+    Tokenize(query, len, &tokens);
+    for (const std::string& token : tokens) {
+        auto found = term_ids_.find(token);
+        if (found == term_ids_.end() || postings_[found->second].live_df == 0) {
+            if (options.match_all) {
+                // A missing term matches nothing
+                terms->clear();
+                return false;
+            }
+            continue;
+        }
+        uint32_t term = found->second;
+        bool seen = std::any_of(terms->begin(), terms->end(), [&](const QueryTerm& t) { return t.term == term; });
+        if (!seen) {
+            terms->push_back({term, Idf(postings_[term].live_df)});
+        }
+    }
+    return !terms->empty() && *tag_mask != 0;
+}
+
+std::vector<Bm25Index::Hit> Bm25Index::Search(const char* query, size_t len, const QueryOptions& options) const {
+    std::vector<QueryTerm> terms;
+    uint32_t tag_mask;
+    if (options.k == 0 || !ParseQuery(query, len, options, &terms, &tag_mask)) {
+        return {};
+    }
+    return options.match_all ? TopAll(terms, options.k, tag_mask) : TopAny(terms, options.k, tag_mask);
+}
+
+// Conjunctive top-k: the rarest term leads and the others gallop to its
+// docs. When the heap is full, a lead block whose best score plus the other
+// terms' bounds cannot beat the threshold is skipped undecoded.
+std::vector<Bm25Index::Hit> Bm25Index::TopAll(const std::vector<QueryTerm>& terms, size_t k,
+                                              uint32_t tag_mask) const {
+    std::vector<Cursor> cursors;
+    cursors.reserve(terms.size());
+    for (const QueryTerm& t : terms) {
+        cursors.emplace_back(&postings_[t.term], t.idf);
+    }
+    std::sort(cursors.begin(), cursors.end(),
+              [](const Cursor& a, const Cursor& b) { return a.Length() < b.Length(); });
+
+    float rest_bound = 0;
+    for (size_t i = 1; i < cursors.size(); i++) {
+        const Posting& p = cursors[i].GetPosting();
+        rest_bound += TermScore(cursors[i].Idf(), p.max_tf, p.min_len);
+    }
+
+    TopK top(k);
+    Cursor& lead = cursors[0];
+    uint32_t doc = lead.Doc();
+    while (doc != kEnd) {
+        if (top.Full()) {
+            BlockMeta block = lead.Current();
+            if (TermScore(lead.Idf(), block.max_tf, block.min_len) + rest_bound <= top.Threshold()) {
+                doc = lead.NextGEQ(block.last_doc + 1);
+                continue;
+            }
+        }
+
+        bool match = true;
+        for (size_t i = 1; i < cursors.size(); i++) {
+            uint32_t d = cursors[i].NextGEQ(doc);
+            if (d != doc) {
+                doc = lead.NextGEQ(d);
+                match = false;
+                break;
+            }
+        }
+        if (!match) {
+            continue;
+        }
+
+        const Doc& d = docs_[doc];
+        if (d.alive && (tag_mask >> d.tag & 1)) {
+            float score = 0;
+            for (const Cursor& c : cursors) {
+                score += TermScore(c.Idf(), c.Tf(), d.len);
+            }
+            top.Push(doc, score);
+        }
+        doc = lead.Next();
+    }
+    return top.Take();
+}
+
+// Disjunctive top-k with block-max WAND (Ding & Suel, 2011)
+std::vector<Bm25Index::Hit> Bm25Index::TopAny(const std::vector<QueryTerm>& terms, size_t k,
+                                              uint32_t tag_mask) const {
+    std::vector<Cursor> cursors;
+    std::vector<float> bounds;
+    cursors.reserve(terms.size());
+    for (const QueryTerm& t : terms) {
+        cursors.emplace_back(&postings_[t.term], t.idf);
+        const Posting& p = postings_[t.term];
+        bounds.push_back(TermScore(t.idf, p.max_tf, p.min_len));
+    }
+    std::vector<size_t> order(cursors.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+
+    TopK top(k);
+    size_t n = cursors.size();
+    for (;;) {
+        std::sort(order.begin(), order.end(),
+                  [&](size_t a, size_t b) { return cursors[a].Doc() < cursors[b].Doc(); });
+
+        // Pivot: first doc at which the summed bounds can beat the threshold
+        float threshold = top.Threshold();
+        float acc = 0;
+        size_t pivot = n;
+        for (size_t i = 0; i < n && cursors[order[i]].Doc() != kEnd; i++) {
+            acc += bounds[order[i]];
+            if (acc > threshold) {
+                pivot = i;
+                break;
+            }
+        }
+        if (pivot == n) {
+            break;
+        }
+        uint32_t pivot_doc = cursors[order[pivot]].Doc();
+        // Include later cursors sitting on the pivot doc too
+        size_t last = pivot;
+        while (last + 1 < n && cursors[order[last + 1]].Doc() == pivot_doc) {
+            last++;
+        }
+
+        if (top.Full()) {
+            float block_bound = 0;
+            uint32_t next = last + 1 < n ? cursors[order[last + 1]].Doc() : kEnd;
+            for (size_t i = 0; i <= last; i++) {
+                const Cursor& c = cursors[order[i]];
+                BlockMeta block;
+                if (c.Shallow(pivot_doc, &block)) {
+                    block_bound += TermScore(c.Idf(), block.max_tf, block.min_len);
+                    next = std::min(next, block.last_doc + 1);
+                }
+            }
+            if (block_bound <= threshold) {
+                // Nothing in [pivot_doc, next) can enter the heap
+                next = std::max(next, pivot_doc + 1);
+                for (size_t i = 0; i <= last; i++) {
+                    cursors[order[i]].NextGEQ(next);
+                }
+                continue;
+            }
+        }
+
+        if (cursors[order[0]].Doc() == pivot_doc) {
+            const Doc& d = docs_[pivot_doc];
+            bool eligible = d.alive && (tag_mask >> d.tag & 1);
+            float score = 0;
+            for (size_t i = 0; i <= last; i++) {
+                Cursor& c = cursors[order[i]];
+                if (eligible) {
+                    score += TermScore(c.Idf(), c.Tf(), d.len);
+                }
+                c.Next();
+            }
+            if (eligible) {
+                top.Push(pivot_doc, score);
+            }
+        } else {
+            for (size_t i = 0; i < pivot; i++) {
+                cursors[order[i]].NextGEQ(pivot_doc);
+            }
+        }
+    }
+    return top.Take();
+}
+
+float Bm25Index::ScoreDoc(uint32_t doc, const std::vector<QueryTerm>& terms, bool match_all) const {
+    const Doc& d = docs_[doc];
+    float score = 0;
+    for (const QueryTerm& t : terms) {
+        auto it = std::lower_bound(d.terms.begin(), d.terms.end(), std::make_pair(t.term, uint32_t(0)));
+        if (it == d.terms.end() || it->first != t.term) {
+            if (match_all) {
+                return 0;
+            }
+            continue;
+        }
+        score += TermScore(t.idf, it->second, d.len);
+    }
+    return score;
+}
+
+std::vector<Bm25Index::FusedHit> Bm25Index::Hybrid(const char* query, size_t len, const QueryOptions& options,
+                                                   const std::vector<std::string>& vector_ids,
+                                                   const float* vector_scores, float vector_weight,
+                                                   float text_weight, size_t limit) const {
+    std::vector<QueryTerm> terms;
+    uint32_t tag_mask = 0;
+    bool searchable = options.k > 0 && ParseQuery(query, len, options, &terms, &tag_mask);
+
+    std::vector<FusedHit> fused;
+    std::unordered_map<std::string, size_t> by_id;
+    if (searchable) {
+        std::vector<Hit> hits = options.match_all ? TopAll(terms, options.k, tag_mask)
+                                                  : TopAny(terms, options.k, tag_mask);
+        fused.reserve(hits.size() + vector_ids.size());
+        for (const Hit& hit : hits) {
+            by_id.emplace(docs_[hit.doc].id, fused.size());
+            fused.push_back({docs_[hit.doc].id, 0.0f, hit.score / (1.0f + hit.score), 0.0f});
+        }
+    }
+
+    for (size_t i = 0; i < vector_ids.size(); i++) {
+        auto seen = by_id.find(vector_ids[i]);
+        if (seen != by_id.end()) {
+            fused[seen->second].vector_score = vector_scores[i];
+            continue;
+        }
+        float text_score = 0;
+        auto doc = by_id_.find(vector_ids[i]);
+        if (searchable && doc != by_id_.end() && (tag_mask >> docs_[doc->second].tag & 1)) {
+            float s = ScoreDoc(doc->second, terms, options.match_all);
+            text_score = s / (1.0f + s);
+        }
+        by_id.emplace(vector_ids[i], fused.size());
+        fused.push_back({vector_ids[i], 0.0f, text_score, vector_scores[i]});
+    }
+
+    for (FusedHit& hit : fused) {
+        hit.score = text_weight * hit.text_score + vector_weight * hit.vector_score;
+    }
+    size_t keep = std::min(limit, fused.size());
+    std::partial_sort(fused.begin(), fused.begin() + keep, fused.end(),
+                      [](const FusedHit& a, const FusedHit& b) { return a.score > b.score; });
+    fused.resize(keep);
+    return fused;
+}
+
+size_t Bm25Index::PostingBytes() const {
+    size_t bytes = 0;
+    for (const Posting& p : postings_) {
+        bytes += p.bytes.capacity() + p.blocks.capacity() * sizeof(BlockMeta) +
+                 (p.tail_docs.capacity() + p.tail_tfs.capacity()) * sizeof(uint32_t);
+    }
+    return bytes;
+}
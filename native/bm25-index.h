@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// In-memory BM25 keyword index over short documents (memory chunks), keyed
+// by string id. N-API free; not thread-safe (one owner).
+//
+// Tokens are runs of Unicode letters and numbers, folded like FTS5 unicode61:
+// lowercased, with the diacritics of Latin letters removed (CAFÉ and café
+// are one term). Punctuation such as curly quotes and dashes separates.
+// Scoring follows SQLite FTS5's bm25(): idf = ln((N - df + 0.5) / (df + 0.5)),
+// floored at 1e-6, with k1 = 1.2 and b = 0.75 by default.
+//
+// Each term's postings are blocks of up to 128 doc numbers, delta + varint
+// encoded, with tf varints after them. A block directory keeps each block's
+// last doc (searched by galloping) and its max tf / min doc length, which
+// bound the block's best score. The newest, partial block stays unencoded.
+// Inside a decoded block, the next doc >= target is found with a SIMD scan.
+//
+// Top-k uses the bounds to skip blocks: block-max pruning over the rarest
+// term for all-terms queries, block-max WAND for any-term queries.
+//
+// Removed and replaced ids are tombstoned and skipped; once tombstones
+// outnumber live documents the postings are rebuilt without them.
+
+struct Bm25Params {
+    float k1 = 1.2f;
+    float b = 0.75f;
+};
+
+class Bm25Index {
+public:
+    struct Hit {
+        uint32_t doc;
+        float score;
+    };
+
+    struct FusedHit {
+        std::string id;
+        float score;
+        // bm25 / (1 + bm25), 0 when the document does not match
+        float text_score;
+        float vector_score;
+    };
+
+    struct QueryOptions {
+        size_t k = 10;
+        // True: documents must contain every query term (FTS5 "a AND b")
+        bool match_all = true;
+        // Tags to search; empty = all
+        std::vector<std::string> tags;
+    };
+
+    static constexpr size_t kMaxTags = 32;
+
+    explicit Bm25Index(const Bm25Params& params);
+
+    // Indexes (or replaces) a document. `tag` is a small category such as
+    // the chunk source, usable as a search filter. False when it would be
+    // the (kMaxTags + 1)th distinct tag.
+    bool Add(const std::string& id, const char* text, size_t len, const std::string& tag);
+    bool Remove(const std::string& id);
+    bool Has(const std::string& id) const { return by_id_.count(id) != 0; }
+    void Clear();
+
+    // Best k documents by BM25, best first
+    std::vector<Hit> Search(const char* query, size_t len, const QueryOptions& options) const;
+
+    // Fuses keyword and vector results in one pass:
+    //   score = text_weight * text_score + vector_weight * vector_score
+    // over the keyword top options.k and every vector hit; vector hits get
+    // their exact text score. Returns the best `limit`, best first.
+    std::vector<FusedHit> Hybrid(const char* query, size_t len, const QueryOptions& options,
+                                 const std::vector<std::string>& vector_ids, const float* vector_scores,
+                                 float vector_weight, float text_weight, size_t limit) const;
+
+    const std::string& Id(uint32_t doc) const { return docs_[doc].id; }
+
+    size_t Size() const { return by_id_.size(); }
+    size_t Terms() const { return term_ids_.size(); }
+    // Encoded postings, tails and block directories
+    size_t PostingBytes() const;
+
+    // Folded tokens of `text`, in order (exposed for tests/benchmarks)
+    static void Tokenize(const char* text, size_t len, std::vector<std::string>* out);
+
+private:
+    static constexpr size_t kBlock = 128;
+
+    struct BlockMeta {
+        uint32_t last_doc;
+        uint32_t offset;
+        uint32_t max_tf;
+        uint32_t min_len;
+        uint32_t count;
+    };
+
+    struct Posting {
+        std::vector<uint8_t> bytes;
+        std::vector<BlockMeta> blocks;
+        std::vector<uint32_t> tail_docs;
+        std::vector<uint32_t> tail_tfs;
+        uint32_t tail_max_tf = 0;
+        uint32_t tail_min_len = UINT32_MAX;
+        // Over every block, for the term's score bound
+        uint32_t max_tf = 0;
+        uint32_t min_len = UINT32_MAX;
+        // Live documents containing the term
+        uint32_t live_df = 0;
+    };
+
+    struct Doc {
+        std::string id;
+        uint32_t len;
+        uint8_t tag;
+        bool alive;
+        // (term, tf), sorted by term
+        std::vector<std::pair<uint32_t, uint32_t>> terms;
+    };
+
+    struct QueryTerm {
+        uint32_t term;
+        float idf;
+    };
+
+    class Cursor;
+
+    bool ParseQuery(const char* query, size_t len, const QueryOptions& options, std::vector<QueryTerm>* terms,
+                    uint32_t* tag_mask) const;
+    float Idf(uint32_t df) const;
+    float TermScore(float idf, uint32_t tf, uint32_t len) const;
+    std::vector<Hit> TopAll(const std::vector<QueryTerm>& terms, size_t k, uint32_t tag_mask) const;
+    std::vector<Hit> TopAny(const std::vector<QueryTerm>& terms, size_t k, uint32_t tag_mask) const;
+    float ScoreDoc(uint32_t doc, const std::vector<QueryTerm>& terms, bool match_all) const;
+
+    void Append(uint32_t term, uint32_t doc, uint32_t tf, uint32_t len);
+    static void SealTail(Posting& p);
+    void Compact();
+
+    Bm25Params params_;
+    std::vector<Doc> docs_;
+    std::unordered_map<std::string, uint32_t> by_id_;
+    std::vector<Posting> postings_;
+    std::unordered_map<std::string, uint32_t> term_ids_;
+    std::vector<std::string> tags_;
+    uint64_t total_len_ = 0;
+    size_t dead_ = 0;
+};
@@ -0,0 +1,552 @@
+#include "bpe-tokenizer.h"
+#include "base64.h"
+#include "unicode-classes.h"
+#include "utf8.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+
+// ---------------------------------------------------------------------------
+// Character classes of the cl100k pattern
+// ---------------------------------------------------------------------------
+
+// Stands in for a byte that does not start a valid sequence: not a letter,
+// number or space, so it falls into the punctuation alternative
+static constexpr uint32_t kInvalidCodePoint = 0x110000;
+
+// Decodes the code point at data[i]; returns its byte length (1 for an
+// invalid byte)
+static size_t DecodeAt(const uint8_t* data, size_t len, size_t i, uint32_t* cp) {
+    uint8_t b0 = data[i];
+    if (b0 < 0x80) {
+        *cp = b0;
+        return 1;
+    }
+    size_t n;
+    uint32_t value;
+    uint8_t lo = 0x80, hi = 0xbf;
+    if (b0 >= 0xc2 && b0 <= 0xdf) {
+        n = 2;
+        value = b0 & 0x1f;
+    } else if (b0 >= 0xe0 && b0 <= 0xef) {
+        n = 3;
+        value = b0 & 0x0f;
+        if (b0 == 0xe0) lo = 0xa0;
+        if (b0 == 0xed) hi = 0x9f;
+    } else if (b0 >= 0xf0 && b0 <= 0xf4) {
+        n = 4;
+        value = b0 & 0x07;
+        if (b0 == 0xf0) lo = 0x90;
+        if (b0 == 0xf4) hi = 0x8f;
+    } else {
+        *cp = kInvalidCodePoint;
+        return 1;
+    }
+    if (len - i < n || data[i + 1] < lo || data[i + 1] > hi) {
+        *cp = kInvalidCodePoint;
+        return 1;
+    }
+    for (size_t k = 1; k < n; k++) {
+        if ((data[i + k] & 0xc0) != 0x80) {
+            *cp = kInvalidCodePoint;
+            return 1;
+        }
+        value = (value << 6) | (data[i + k] & 0x3f);
+    }
+    *cp = value;
+    return n;
+}
+
+static bool IsLetter(uint32_t cp) {
+    if (cp < 0x80) {
+        return (cp | 0x20) - 'a' < 26;
+    }
+    return cp != kInvalidCodePoint && InRanges(kLetterRanges, cp);
+}
+
+static bool IsNumber(uint32_t cp) {
+    if (cp < 0x80) {
+        return cp - '0' < 10;
+    }
+    return cp != kInvalidCodePoint && InRanges(kNumberRanges, cp);
+}
+
+// \s in the Rust regex engine: the Unicode White_Space property
+static bool IsSpace(uint32_t cp) {
+    if (cp < 0x80) {
+        return cp == ' ' || (cp >= 0x09 && cp <= 0x0d);
+    }
+    return cp == 0x85 || cp == 0xa0 || cp == 0x1680 || (cp >= 0x2000 && cp <= 0x200a) ||
+           cp == 0x2028 || cp == 0x2029 || cp == 0x202f || cp == 0x205f || cp == 0x3000;
+}
+
+static bool IsNewline(uint32_t cp) {
+    return cp == '\r' || cp == '\n';
+}
+
+static bool IsPunctuation(uint32_t cp) {
+    return !IsSpace(cp) && !IsLetter(cp) && !IsNumber(cp);
+}
+
+// End of the piece starting at data[i], following the alternatives of
+//
+//   (?i:'s|'t|'re|'ve|'m|'ll|'d)|[^\r\n\p{L}\p{N}]?\p{L}+|\p{N}{1,3}|
+//    ?[^\s\p{L}\p{N}]+[\r\n]*|\s*[\r\n]+|\s+(?!\S)|\s+
+//
+// in order, with the backtracking outcomes worked out by hand.
+static size_t NextPiece(const uint8_t* data, size_t len, size_t i) {
+    uint32_t c0;
+    size_t n0 = DecodeAt(data, len, i, &c0);
+
+    if (c0 == '\'' && i + 1 < len) {
+        uint8_t a = data[i + 1] | 0x20;
+        if (a == 's' || a == 't' || a == 'm' || a == 'd') {
+            return i + 2;
+        }
+        if (i + 2 < len) {
+            uint8_t b = data[i + 2] | 0x20;
+            if ((a == 'r' && b == 'e') || (a == 'v' && b == 'e') || (a == 'l' && b == 'l')) {
+                return i + 3;
+            }
+        }
+    }
+
+    uint32_t cp;
+    size_t letters = SIZE_MAX;
+    if (IsLetter(c0)) {
+        letters = i;
+    } else if (!IsNewline(c0) && !IsNumber(c0) && i + n0 < len) {
+        DecodeAt(data, len, i + n0, &cp);
+        if (IsLetter(cp)) {
+            letters = i + n0;
+        }
+    }
+    if (letters != SIZE_MAX) {
+        size_t j = letters;
+        while (j < len) {
+            size_t n = DecodeAt(data, len, j, &cp);
+            if (!IsLetter(cp)) {
+                break;
+            }
+            j += n;
+        }
+        return j;
+    }
+
+    if (IsNumber(c0)) {
+        size_t j = i + n0;
+        for (int k = 0; k < 2 && j < len; k++) {
+            size_t n = DecodeAt(data, len, j, &cp);
+            if (!IsNumber(cp)) {
+                break;
+            }
+            j += n;
+        }
+        return j;
+    }
+
+    size_t p = i;
+    cp = c0;
+    if (c0 == ' ' && i + 1 < len) {
+        p = i + 1;
+        DecodeAt(data, len, p, &cp);
+    }
+    if (IsPunctuation(cp)) {
+        size_t j = p;
+        while (j < len) {
+            size_t n = DecodeAt(data, len, j, &cp);
+            if (!IsPunctuation(cp)) {
+                break;
+            }
+            j += n;
+        }
+        while (j < len && (data[j] == '\r' || data[j] == '\n')) {
+            j++;
+        }
+        return j;
+    }
+
+    // Whitespace. \s*[\r\n]+ ends after the run's last line break;
+    // \s+(?!\S) leaves the run's last character for the next piece unless
+    // the run ends the text; a lone character is \s+.
+    size_t j = i;
+    size_t last_start = i;
+    size_t last_newline = SIZE_MAX;
+    size_t chars = 0;
+    while (j < len) {
+        size_t n = DecodeAt(data, len, j, &cp);
+        if (!IsSpace(cp)) {
+            break;
+        }
+        if (IsNewline(cp)) {
+            last_newline = j;
+        }
+        last_start = j;
+        chars++;
+        j += n;
+    }
+    if (last_newline != SIZE_MAX) {
+        return last_newline + 1;
+    }
+    if (j == len || chars < 2) {
+        return j;
+    }
+    return last_start;
+}
+
+// ---------------------------------------------------------------------------
+// Vocabulary
+// ---------------------------------------------------------------------------
+
+static uint64_t HashBytes(const uint8_t* bytes, size_t len) {
+    uint64_t h = UINT64_C(0xcbf29ce484222325);
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ bytes[i]) * UINT64_C(0x100000001b3);
+    }
+    return h ^ (h >> 29);
+}
+
+uint32_t BpeTokenizer::Rank(const uint8_t* bytes, size_t len) const {
+    for (size_t i = HashBytes(bytes, len) & mask_;; i = (i + 1) & mask_) {
+        const Slot& slot = slots_[i];
+        if (slot.length == 0) {
+            return kNoRank;
+        }
+        if (slot.length == len && std::memcmp(arena_.data() + slot.offset, bytes, len) == 0) {
+            return slot.rank;
+        }
+    }
+}
+
+void BpeTokenizer::Insert(const uint8_t* bytes, size_t len, uint32_t rank) {
+    for (size_t i = HashBytes(bytes, len) & mask_;; i = (i + 1) & mask_) {
+        Slot& slot = slots_[i];
+        if (slot.length == 0) {
+            slot.offset = static_cast<uint32_t>(arena_.size());
+            slot.length = static_cast<uint32_t>(len);
+            slot.rank = rank;
+            arena_.insert(arena_.end(), bytes, bytes + len);
+            entries_++;
+            return;
+        }
+        if (slot.length == len && std::memcmp(arena_.data() + slot.offset, bytes, len) == 0) {
+            return;  // tiktoken keeps the first rank of a duplicate
+        }
+    }
+}
+
+namespace {
+
+// Read-only mapping of the rank file for the duration of the parse
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        fd_ = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd_ < 0) {
+            throw std::runtime_error("cannot open tokenizer vocabulary: " + path);
+        }
+        struct stat st;
+        if (fstat(fd_, &st) != 0 || st.st_size <= 0) {
+            close(fd_);
+            throw std::runtime_error("empty tokenizer vocabulary: " + path);
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+        if (data == MAP_FAILED) {
+            close(fd_);
+            throw std::runtime_error("cannot map tokenizer vocabulary: " + path);
+        }
+        madvise(data, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const char*>(data);
+    }
+
+    ~MappedFile() {
+        munmap(const_cast<char*>(data_), size_);
+        close(fd_);
+    }
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    int fd_ = -1;
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+}  // namespace
+
+BpeTokenizer::BpeTokenizer(const std::string& path) {
+    InitBase64();
+    MappedFile file(path);
+    const char* p = file.data();
+    const char* end = p + file.size();
+
+    size_t lines = std::count(p, end, '\n') + 1;
+    size_t capacity = 1024;
+    while (capacity < lines * 2) {
+        capacity <<= 1;
+    }
+    slots_.assign(capacity, Slot{0, 0, 0});
+    mask_ = capacity - 1;
+    arena_.reserve(file.size() * 3 / 4);
+
+    std::vector<uint8_t> token;
+    size_t line_no = 0;
+    while (p < end) {
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+        if (eol == nullptr) {
+            eol = end;
+        }
+        line_no++;
+        const char* line_end = eol > p && eol[-1] == '\r' ? eol - 1 : eol;
+        if (line_end > p) {
+            const char* space = static_cast<const char*>(std::memchr(p, ' ', static_cast<size_t>(line_end - p)));
+            uint64_t rank = 0;
+            bool ok = space != nullptr && space > p && space + 1 < line_end;
+            for (const char* d = ok ? space + 1 : line_end; ok && d < line_end; d++) {
+                ok = *d >= '0' && *d <= '9' && rank < kNoRank / 10;
+                rank = rank * 10 + static_cast<uint64_t>(*d - '0');
+            }
+            size_t b64_len = ok ? static_cast<size_t>(space - p) : 0;
+            if (ok) {
+                token.resize(Base64DecodedSize(p, b64_len));
+                ok = !token.empty() && rank < kNoRank && Base64Decode(p, b64_len, token.data());
+            }
+            if (!ok) {
+                throw std::runtime_error("malformed tokenizer vocabulary line " + std::to_string(line_no) +
+                                         ": " + path);
+            }
+            Insert(token.data(), token.size(), static_cast<uint32_t>(rank));
+        }
+        p = eol + 1;
+    }
+
+    // Merging bottoms out at single bytes, so every byte needs a rank
+    for (int b = 0; b < 256; b++) {
+        uint8_t byte = static_cast<uint8_t>(b);
+        if (Rank(&byte, 1) == kNoRank) {
+            throw std::runtime_error("tokenizer vocabulary lacks single-byte tokens: " + path);
+        }
+    }
+}
+
+std::shared_ptr<const BpeTokenizer> BpeTokenizer::Load(const std::string& path) {
+    static std::mutex mutex;
+    static std::map<std::string, std::weak_ptr<const BpeTokenizer>> loaded;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::shared_ptr<const BpeTokenizer> tokenizer = loaded[path].lock();
+    if (!tokenizer) {
+        tokenizer = std::make_shared<const BpeTokenizer>(path);
+        loaded[path] = tokenizer;
+    }
+    return tokenizer;
+}
+
+// ---------------------------------------------------------------------------
+// Merging
+// ---------------------------------------------------------------------------
+
+// Pieces up to this length use tiktoken's own quadratic scan; longer ones
+// (runs of letters or symbols in minified or encoded text) a heap
+static constexpr size_t kLongPiece = 128;
+
+template <typename Emit>
+bool BpeTokenizer::MergePiece(const uint8_t* piece, size_t len, Emit&& emit) const {
+    if (len > kLongPiece) {
+        return MergeLongPiece(piece, len, emit);
+    }
+
+    struct Part {
+        uint32_t start;
+        uint32_t rank;  // of the pair starting here
+    };
+    Part parts[kLongPiece + 1];
+    size_t count = len + 1;
+    for (size_t i = 0; i < len; i++) {
+        parts[i] = {static_cast<uint32_t>(i), i + 2 <= len ? Rank(piece + i, 2) : kNoRank};
+    }
+    parts[len] = {static_cast<uint32_t>(len), kNoRank};
+
+    // Rank of parts[i] merged with the part after it, once parts[i + 1]
+    // has been absorbed
+    auto pair_rank = [&](size_t i) {
+        return i + 3 < count ? Rank(piece + parts[i].start, parts[i + 3].start - parts[i].start) : kNoRank;
+    };
+
+    while (count > 1) {
+        uint32_t best = kNoRank;
+        size_t at = 0;
+        for (size_t i = 0; i + 1 < count; i++) {
+            if (parts[i].rank < best) {
+                best = parts[i].rank;
+                at = i;
+            }
+        }
+        if (best == kNoRank) {
+            break;
+        }
+        parts[at].rank = pair_rank(at);
+        if (at > 0) {
+            parts[at - 1].rank = pair_rank(at - 1);
+        }
+        std::memmove(parts + at + 1, parts + at + 2, (count - at - 2) * sizeof(Part));
+        count--;
+    }
+
+    for (size_t i = 0; i + 1 < count; i++) {
+        uint32_t start = parts[i].start;
+        uint32_t stop = parts[i + 1].start;
+        if (!emit(Rank(piece + start, stop - start), static_cast<size_t>(stop))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Same merge order as the scan: a min-heap of (rank, start) over a linked
+// list of parts, where a stale entry no longer matches its part's rank.
+template <typename Emit>
+bool BpeTokenizer::MergeLongPiece(const uint8_t* piece, size_t len, Emit&& emit) const {
+    // Parts are keyed by their start byte; next[len] is the end sentinel
+    std::vector<uint32_t> next(len + 1), prev(len + 1), rank(len + 1, kNoRank);
+    for (size_t i = 0; i <= len; i++) {
+        next[i] = static_cast<uint32_t>(i + 1);
+        prev[i] = static_cast<uint32_t>(i == 0 ? 0 : i - 1);
+    }
+
+    using Entry = std::pair<uint32_t, uint32_t>;  // (rank, start)
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+    auto update = [&](uint32_t i) {
+        uint32_t j = next[i];
+        rank[i] = j < len ? Rank(piece + i, next[j] - i) : kNoRank;
+        if (rank[i] != kNoRank) {
+            heap.emplace(rank[i], i);
+        }
+    };
+    for (uint32_t i = 0; i < len; i++) {
+        update(i);
+    }
+
+    while (!heap.empty()) {
+        Entry top = heap.top();
+        heap.pop();
+        uint32_t i = top.second;
+        if (rank[i] != top.first) {
+            continue;
+        }
+        uint32_t j = next[i];
+        next[i] = next[j];
+        prev[next[j]] = i;
+        rank[j] = kNoRank;
+        update(i);
+        if (i > 0) {
+            update(prev[i]);
+        }
+    }
+
+    for (uint32_t i = 0; i < len; i = next[i]) {
+        if (!emit(Rank(piece + i, next[i] - i), static_cast<size_t>(next[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Public API
+// ---------------------------------------------------------------------------
+
+size_t BpeTokenizer::Count(const uint8_t* data, size_t len) const {
+    size_t tokens = 0;
+    for (size_t i = 0; i < len;) {
+        size_t end = NextPiece(data, len, i);
+        if (Rank(data + i, end - i) != kNoRank) {
+            tokens++;
+        } else {
+            MergePiece(data + i, end - i, [&](uint32_t, size_t) {
+                tokens++;
+                return true;
+            });
+        }
+        i = end;
+    }
+    return tokens;
+}
+
+void BpeTokenizer::Encode(const uint8_t* data, size_t len, std::vector<uint32_t>* ranks,
+                          std::vector<uint32_t>* ends) const {
+    for (size_t i = 0; i < len;) {
+        size_t end = NextPiece(data, len, i);
+        uint32_t whole = Rank(data + i, end - i);
+        if (whole != kNoRank) {
+            ranks->push_back(whole);
+            ends->push_back(static_cast<uint32_t>(end));
+        } else {
+            MergePiece(data + i, end - i, [&](uint32_t rank, size_t stop) {
+                ranks->push_back(rank);
+                ends->push_back(static_cast<uint32_t>(i + stop));
+                return true;
+            });
+        }
+        i = end;
+    }
+}
+
+size_t BpeTokenizer::Prefix(const uint8_t* data, size_t len, size_t max_tokens, size_t* tokens) const {
+    size_t count = 0;
+    size_t covered = 0;
+    // Token ends inside the piece being emitted when the budget ran out
+    std::vector<size_t> piece_ends;
+    for (size_t i = 0; i < len;) {
+        size_t end = NextPiece(data, len, i);
+        size_t before = count;
+        piece_ends.clear();
+        bool fits;
+        if (Rank(data + i, end - i) != kNoRank) {
+            fits = count < max_tokens;
+            if (fits) {
+                count++;
+                piece_ends.push_back(end);
+            }
+        } else {
+            fits = MergePiece(data + i, end - i, [&](uint32_t, size_t stop) {
+                if (count == max_tokens) {
+                    return false;
+                }
+                count++;
+                piece_ends.push_back(i + stop);
+                return true;
+            });
+        }
+        if (!fits) {
+            // Tokens split code points; keep only those ending on a boundary
+            size_t last = piece_ends.empty() ? i : piece_ends.back();
+            size_t cut = Utf8PrefixForBytes(data, len, last);
+            cut = std::max(cut, i);
+            count = before;
+            for (size_t stop : piece_ends) {
+                if (stop <= cut) {
+                    count++;
+                }
+            }
+            *tokens = count;
+            return cut;
+        }
+        covered = end;
+        i = end;
+    }
+    *tokens = count;
+    return covered;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Byte-level BPE tokenizer compatible with tiktoken's cl100k_base encoding
+// (the tokenizer of OpenAI's text-embedding-3 and GPT-4 models).
+//
+// The vocabulary is a tiktoken rank file: one "<base64 token> <rank>" line
+// per token, as published for cl100k_base. It is memory-mapped and parsed
+// once into a flat byte arena plus an open-addressing hash table; Load()
+// keeps one instance per path for the whole process, shared by every
+// caller and thread.
+//
+// Text is split into pieces with a hand-written matcher for the cl100k
+// pre-tokenization pattern (contractions, letter runs, up to three digits,
+// punctuation runs, whitespace), then each piece is merged by rank exactly
+// as tiktoken does, lowest rank first and leftmost on ties. Special tokens
+// such as <|endoftext|> are treated as ordinary text. Input is UTF-8; bytes
+// that are not valid UTF-8 are pieces of their own.
+//
+// Counting and encoding are const and thread-safe. Load errors throw
+// std::runtime_error.
+
+class BpeTokenizer {
+public:
+    static std::shared_ptr<const BpeTokenizer> Load(const std::string& path);
+
+    explicit BpeTokenizer(const std::string& path);
+
+    BpeTokenizer(const BpeTokenizer&) = delete;
+    BpeTokenizer& operator=(const BpeTokenizer&) = delete;
+
+    size_t Count(const uint8_t* data, size_t len) const;
+
+    // Appends each token's rank and the byte offset where it ends
+    void Encode(const uint8_t* data, size_t len, std::vector<uint32_t>* ranks,
+                std::vector<uint32_t>* ends) const;
+
+    // Byte length of the longest prefix that holds at most `max_tokens`
+    // tokens and ends on a code point boundary; `tokens` gets its count.
+    // Stops tokenizing once the budget is reached.
+    size_t Prefix(const uint8_t* data, size_t len, size_t max_tokens, size_t* tokens) const;
+
+    size_t VocabSize() const { return entries_; }
+
+private:
+    struct Slot {
+        uint32_t offset;
+        uint32_t length;  // 0 marks an empty slot
+        uint32_t rank;
+    };
+
+    static constexpr uint32_t kNoRank = UINT32_MAX;
+
+    uint32_t Rank(const uint8_t* bytes, size_t len) const;
+    void Insert(const uint8_t* bytes, size_t len, uint32_t rank);
+
+    // Calls emit(rank, end_offset_within_piece) for each token of one piece;
+    // emit returns false to stop
+    template <typename Emit>
+    bool MergePiece(const uint8_t* piece, size_t len, Emit&& emit) const;
+    template <typename Emit>
+    bool MergeLongPiece(const uint8_t* piece, size_t len, Emit&& emit) const;
+
+    std::vector<uint8_t> arena_;
+    std::vector<Slot> slots_;
+    size_t mask_ = 0;
+    size_t entries_ = 0;
+};
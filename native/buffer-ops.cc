@@ -1,6 +1,15 @@
 #include <napi.h>
 #include <string>
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "buffer-pool.h"
+#include "op-stats.h"
+#include "parallel-ops.h"
+#include "promise-worker.h"
+#include "simd-kernels.h"
 
 class BufferOps : public Napi::ObjectWrap<BufferOps> {
 public:
@@ -13,14 +22,24 @@ private:
     // Zero-copy slice
     Napi::Value Slice(const Napi::CallbackInfo& info);
     
+    // Zero-copy slices for a flat list of [start, end) pairs
+    Napi::Value SliceMany(const Napi::CallbackInfo& info);
+    
     // Fast compare using memcmp
     Napi::Value Compare(const Napi::CallbackInfo& info);
     
     // Bulk copy with prefetch
     Napi::Value BulkCopy(const Napi::CallbackInfo& info);
     
+    // Promise-returning compare / bulkCopy, run off the JS thread
+    Napi::Value CompareAsync(const Napi::CallbackInfo& info);
+    Napi::Value BulkCopyAsync(const Napi::CallbackInfo& info);
+    
     // Memory pool allocation
     Napi::Value Allocate(const Napi::CallbackInfo& info);
+    
+    // Return an allocate() buffer to the pool early
+    Napi::Value Recycle(const Napi::CallbackInfo& info);
 };
 
 Napi::FunctionReference BufferOps::constructor;
@@ -28,9 +47,13 @@ Napi::FunctionReference BufferOps::constructor;
 Napi::Object BufferOps::Init(Napi::Env env, Napi::Object exports) {
     Napi::Function func = DefineClass(env, "BufferOps", {
         InstanceMethod("slice", &BufferOps::Slice),
+        InstanceMethod("sliceMany", &BufferOps::SliceMany),
         InstanceMethod("compare", &BufferOps::Compare),
         InstanceMethod("bulkCopy", &BufferOps::BulkCopy),
+        InstanceMethod("compareAsync", &BufferOps::CompareAsync),
+        InstanceMethod("bulkCopyAsync", &BufferOps::BulkCopyAsync),
         InstanceMethod("allocate", &BufferOps::Allocate),
+        InstanceMethod("recycle", &BufferOps::Recycle),
     });
 
     constructor = Napi::Persistent(func);
@@ -43,31 +66,135 @@ Napi::Object BufferOps::Init(Napi::Env env, Napi::Object exports) {
 BufferOps::BufferOps(const Napi::CallbackInfo& info) 
     : Napi::ObjectWrap<BufferOps>(info) {}
 
+// Keeps the parent buffer reachable while any view into it is alive. Views
+// are external buffers over the parent's memory; each view's finalizer drops
+// one use and the last one releases the reference. Finalizers run on the JS
+// thread, so a plain counter is enough.
+//
+// The parent's ArrayBuffer must not be transferred or detached while views
+// exist: that frees the memory regardless of the reference.
+struct SliceParent {
+    Napi::ObjectReference ref;
+    size_t views;
+};
+
+static void ReleaseSliceView(Napi::Env /*env*/, char* /*data*/, SliceParent* parent) {
+    if (--parent->views == 0) {
+        delete parent;
+    }
+}
+
+// Offsets accept Numbers (integral, up to 2^53) or BigInts so ranges above
+// 4 GiB are not truncated.
+static bool ReadOffset(const Napi::Value& value, uint64_t* out) {
+    if (value.IsNumber()) {
+        double d = value.As<Napi::Number>().DoubleValue();
+        if (!(d >= 0) || d > 9007199254740992.0 || std::floor(d) != d) {
+            return false;
+        }
+        *out = static_cast<uint64_t>(value.As<Napi::Number>().Int64Value());
+        return true;
+    }
+    if (value.IsBigInt()) {
+        bool lossless = false;
+        int64_t v = value.As<Napi::BigInt>().Int64Value(&lossless);
+        if (!lossless || v < 0) {
+            return false;
+        }
+        *out = static_cast<uint64_t>(v);
+        return true;
+    }
+    return false;
+}
+
+static Napi::Buffer<char> MakeSliceView(Napi::Env env, Napi::Buffer<char>& buffer,
+                                        SliceParent* parent, uint64_t start, uint64_t end) {
+    Napi::Buffer<char> view = Napi::Buffer<char>::New(
+        env, buffer.Data() + start, static_cast<size_t>(end - start), ReleaseSliceView, parent);
+    parent->views++;
+    return view;
+}
+
 Napi::Value BufferOps::Slice(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     
-    if (info.Length() < 3 || !info[0].IsBuffer() || !info[1].IsNumber() || !info[2].IsNumber()) {
+    if (info.Length() < 3 || !info[0].IsBuffer()) {
         Napi::TypeError::New(env, "Expected (buffer, start, end)").ThrowAsJavaScriptException();
         return env.Null();
     }
     
     Napi::Buffer<char> buffer = info[0].As<Napi::Buffer<char>>();
-    size_t start = info[1].As<Napi::Number>().Uint32Value();
-    size_t end = info[2].As<Napi::Number>().Uint32Value();
+    uint64_t start = 0;
+    uint64_t end = 0;
+    
+    if (!ReadOffset(info[1], &start) || !ReadOffset(info[2], &end)) {
+        Napi::TypeError::New(env, "Expected (buffer, start, end)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
     
     if (start > buffer.Length() || end > buffer.Length() || start > end) {
         Napi::RangeError::New(env, "Invalid slice range").ThrowAsJavaScriptException();
         return env.Null();
     }
     
-    // Create new buffer with copied data
-    size_t len = end - start;
-    Napi::Buffer<char> result = Napi::Buffer<char>::Copy(env, buffer.Data() + start, len);
+    SliceParent* parent = new SliceParent{Napi::Persistent(info[0].As<Napi::Object>()), 0};
+    return MakeSliceView(env, buffer, parent, start, end);
+}
+
+Napi::Value BufferOps::SliceMany(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 2 || !info[0].IsBuffer() || !(info[1].IsArray() || info[1].IsTypedArray())) {
+        Napi::TypeError::New(env, "Expected (buffer, offsets)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    Napi::Buffer<char> buffer = info[0].As<Napi::Buffer<char>>();
+    Napi::Object list = info[1].As<Napi::Object>();
+    size_t count = info[1].IsArray()
+        ? info[1].As<Napi::Array>().Length()
+        : info[1].As<Napi::TypedArray>().ElementLength();
+    
+    if (count % 2 != 0) {
+        Napi::RangeError::New(env, "Offsets must be [start, end] pairs").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    // Validate everything before creating any view
+    std::vector<uint64_t> ranges(count);
+    for (size_t i = 0; i < count; i++) {
+        if (!ReadOffset(list.Get(static_cast<uint32_t>(i)), &ranges[i])) {
+            Napi::TypeError::New(env, "Offsets must be non-negative integers").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+    }
+    for (size_t i = 0; i < count; i += 2) {
+        if (ranges[i] > ranges[i + 1] || ranges[i + 1] > buffer.Length()) {
+            Napi::RangeError::New(env, "Invalid slice range").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+    }
+    
+    Napi::Array result = Napi::Array::New(env, count / 2);
+    if (count == 0) {
+        return result;
+    }
+    
+    // One parent reference shared by every view in the batch
+    SliceParent* parent = new SliceParent{Napi::Persistent(info[0].As<Napi::Object>()), 0};
+    for (size_t i = 0; i < count; i += 2) {
+        result.Set(static_cast<uint32_t>(i / 2), MakeSliceView(env, buffer, parent, ranges[i], ranges[i + 1]));
+    }
     
     return result;
 }
 
-Napi::Value BufferOps::Compare(const Napi::CallbackInfo& info) {
+// compare and bulkCopy are stateless; like the SimdOps kernels they are also
+// exported as module-level functions.
+
+// Same ordering as Buffer.compare: bytewise over the common prefix, then
+// the shorter buffer first. Always -1, 0 or 1.
+Napi::Value BufferCompare(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     
     if (info.Length() < 2 || !info[0].IsBuffer() || !info[1].IsBuffer()) {
@@ -77,16 +204,21 @@ Napi::Value BufferOps::Compare(const Napi::CallbackInfo& info) {
     
     Napi::Buffer<char> buf1 = info[0].As<Napi::Buffer<char>>();
     Napi::Buffer<char> buf2 = info[1].As<Napi::Buffer<char>>();
+    size_t len1 = buf1.Length();
+    size_t len2 = buf2.Length();
     
-    if (buf1.Length() != buf2.Length()) {
-        return Napi::Number::New(env, buf1.Length() < buf2.Length() ? -1 : 1);
+    int result = std::memcmp(buf1.Data(), buf2.Data(), std::min(len1, len2));
+    if (result == 0 && len1 != len2) {
+        result = len1 < len2 ? -1 : 1;
     }
-    
-    int result = std::memcmp(buf1.Data(), buf2.Data(), buf1.Length());
-    return Napi::Number::New(env, result);
+    return Napi::Number::New(env, (result > 0) - (result < 0));
 }
 
-Napi::Value BufferOps::BulkCopy(const Napi::CallbackInfo& info) {
+Napi::Value BufferOps::Compare(const Napi::CallbackInfo& info) {
+    return BufferCompare(info);
+}
+
+Napi::Value BufferBulkCopy(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     
     if (info.Length() < 2 || !info[0].IsBuffer() || !info[1].IsBuffer()) {
@@ -105,6 +237,159 @@ Napi::Value BufferOps::BulkCopy(const Napi::CallbackInfo& info) {
     return Napi::Number::New(env, len);
 }
 
+Napi::Value BufferOps::BulkCopy(const Napi::CallbackInfo& info) {
+    return BufferBulkCopy(info);
+}
+
+// WebSocket payload masking with the signatures of the bufferutil package,
+// which ws uses when it is installed. Module-level only.
+
+// wsMask(source, mask, output, offset, length): output[offset + i] =
+// source[i] ^ mask[i % 4] for i < length
+Napi::Value BufferWsMask(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 5 || !info[0].IsBuffer() || !info[1].IsBuffer() || !info[2].IsBuffer() ||
+        !info[3].IsNumber() || !info[4].IsNumber()) {
+        Napi::TypeError::New(env, "Expected (source, mask, output, offset, length)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Napi::Buffer<uint8_t> source = info[0].As<Napi::Buffer<uint8_t>>();
+    Napi::Buffer<uint8_t> mask = info[1].As<Napi::Buffer<uint8_t>>();
+    Napi::Buffer<uint8_t> output = info[2].As<Napi::Buffer<uint8_t>>();
+    double offset_arg = info[3].As<Napi::Number>().DoubleValue();
+    double length_arg = info[4].As<Napi::Number>().DoubleValue();
+    if (!std::isfinite(offset_arg) || std::floor(offset_arg) != offset_arg || !std::isfinite(length_arg) ||
+        std::floor(length_arg) != length_arg) {
+        Napi::RangeError::New(env, "offset and length must be integers").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    int64_t offset = info[3].As<Napi::Number>().Int64Value();
+    int64_t length = info[4].As<Napi::Number>().Int64Value();
+    if (mask.Length() < 4 || offset < 0 || length < 0 || static_cast<uint64_t>(length) > source.Length() ||
+        static_cast<uint64_t>(offset) > output.Length() ||
+        static_cast<uint64_t>(length) > output.Length() - static_cast<uint64_t>(offset)) {
+        Napi::RangeError::New(env, "mask, offset or length out of range").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    OpScope scope(NativeOp::kWsMask, static_cast<size_t>(length));
+    MaskBytes(source.Data(), mask.Data(), output.Data() + offset, static_cast<size_t>(length));
+    return env.Undefined();
+}
+
+// wsUnmask(buffer, mask): unmasks in place
+Napi::Value BufferWsUnmask(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsBuffer() || !info[1].IsBuffer()) {
+        Napi::TypeError::New(env, "Expected (buffer, mask)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Napi::Buffer<uint8_t> buffer = info[0].As<Napi::Buffer<uint8_t>>();
+    Napi::Buffer<uint8_t> mask = info[1].As<Napi::Buffer<uint8_t>>();
+    if (mask.Length() < 4) {
+        Napi::RangeError::New(env, "mask must be 4 bytes").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    OpScope scope(NativeOp::kWsMask, buffer.Length());
+    MaskBytes(buffer.Data(), mask.Data(), buffer.Data(), buffer.Length());
+    return env.Undefined();
+}
+
+// Async compare / bulkCopy: the worker pins both Buffers; inputs of
+// kParallelMinBytes and up are split across the native ThreadPool.
+
+class CompareWorker : public PromiseWorker {
+public:
+    CompareWorker(Napi::Env env, const Napi::Buffer<uint8_t>& a, const Napi::Buffer<uint8_t>& b)
+        : PromiseWorker(env, "openclaw:compare"),
+          a_(a.Data()), a_len_(a.Length()), b_(b.Data()), b_len_(b.Length()) {
+        Keep(a);
+        Keep(b);
+    }
+
+    void Execute() override {
+        result_ = ParallelCompare(a_, b_, std::min(a_len_, b_len_));
+        if (result_ == 0 && a_len_ != b_len_) {
+            result_ = a_len_ < b_len_ ? -1 : 1;
+        }
+    }
+
+    Napi::Value Result(Napi::Env env) override {
+        return Napi::Number::New(env, result_);
+    }
+
+private:
+    const uint8_t* a_;
+    size_t a_len_;
+    const uint8_t* b_;
+    size_t b_len_;
+    int result_ = 0;
+};
+
+class CopyWorker : public PromiseWorker {
+public:
+    CopyWorker(Napi::Env env, const Napi::Buffer<uint8_t>& source, const Napi::Buffer<uint8_t>& target)
+        : PromiseWorker(env, "openclaw:bulkCopy"),
+          source_(source.Data()), target_(target.Data()),
+          len_(std::min(source.Length(), target.Length())) {
+        Keep(source);
+        Keep(target);
+    }
+
+    void Execute() override {
+        // Views of one ArrayBuffer may overlap; chunked memcpy would corrupt them
+        if (source_ < target_ + len_ && target_ < source_ + len_) {
+            std::memmove(target_, source_, len_);
+        } else {
+            ParallelCopy(target_, source_, len_);
+        }
+    }
+
+    Napi::Value Result(Napi::Env env) override {
+        return Napi::Number::New(env, static_cast<double>(len_));
+    }
+
+private:
+    const uint8_t* source_;
+    uint8_t* target_;
+    size_t len_;
+};
+
+Napi::Value BufferCompareAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 2 || !info[0].IsBuffer() || !info[1].IsBuffer()) {
+        Napi::TypeError::New(env, "Expected (buffer1, buffer2)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    return (new CompareWorker(env, info[0].As<Napi::Buffer<uint8_t>>(), info[1].As<Napi::Buffer<uint8_t>>()))->Start();
+}
+
+Napi::Value BufferBulkCopyAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 2 || !info[0].IsBuffer() || !info[1].IsBuffer()) {
+        Napi::TypeError::New(env, "Expected (source, target)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    return (new CopyWorker(env, info[0].As<Napi::Buffer<uint8_t>>(), info[1].As<Napi::Buffer<uint8_t>>()))->Start();
+}
+
+Napi::Value BufferOps::CompareAsync(const Napi::CallbackInfo& info) {
+    return BufferCompareAsync(info);
+}
+
+Napi::Value BufferOps::BulkCopyAsync(const Napi::CallbackInfo& info) {
+    return BufferBulkCopyAsync(info);
+}
+
 Napi::Value BufferOps::Allocate(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     
@@ -113,16 +398,32 @@ Napi::Value BufferOps::Allocate(const Napi::CallbackInfo& info) {
         return env.Null();
     }
     
-    size_t size = info[0].As<Napi::Number>().Uint32Value();
+    size_t size;
+    if (!ReadPoolSize(info[0], 0, &size)) {
+        Napi::RangeError::New(env, "Invalid size").ThrowAsJavaScriptException();
+        return env.Null();
+    }
     
-    // Allocate uninitialized buffer (faster than zeroed)
-    Napi::Buffer<char> buffer = Napi::Buffer<char>::New(env, size);
+    // Uninitialized block from the per-env size-class pool (faster than
+    // zeroed, and recycled instead of freed)
+    return AcquirePooledBuffer(env, DefaultBufferPool(env), size);
+}
+
+Napi::Value BufferOps::Recycle(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsBuffer()) {
+        Napi::TypeError::New(env, "Expected buffer").ThrowAsJavaScriptException();
+        return env.Null();
+    }
     
-    return buffer;
+    return Napi::Boolean::New(env, ReleasePooledBuffer(env, DefaultBufferPool(env), info[0]));
 }
 
 // Module initialization
 Napi::Object InitBufferOps(Napi::Env env, Napi::Object exports) {
     BufferOps::Init(env, exports);
+    exports.Set("wsMask", Napi::Function::New<BufferWsMask>(env, "wsMask"));
+    exports.Set("wsUnmask", Napi::Function::New<BufferWsUnmask>(env, "wsUnmask"));
     return exports;
 }
\ No newline at end of file
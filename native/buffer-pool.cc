@@ -0,0 +1,280 @@
+#include <napi.h>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "addon-data.h"
+#include "buffer-pool.h"
+#include "slab-pool.h"
+
+// Resident cap for the per-env pool behind BufferOps.allocate
+static constexpr size_t kDefaultPoolBytes = 64u << 20;
+
+struct PoolLease;
+
+bool ReadPoolSize(const Napi::Value& value, double min, size_t* out) {
+    if (!value.IsNumber()) {
+        return false;
+    }
+    double d = value.As<Napi::Number>().DoubleValue();
+    if (!(d >= min) || d > 9007199254740992.0 || std::floor(d) != d) {
+        return false;
+    }
+    *out = static_cast<size_t>(d);
+    return true;
+}
+
+struct PooledBufferState {
+    PooledBufferState(const std::vector<size_t>& classes, size_t maxBytes)
+        : slab(classes, maxBytes) {}
+
+    SlabPool slab;
+    // Outstanding blocks, so release(buf) can find its lease
+    std::unordered_map<uint8_t*, PoolLease*> leases;
+    uint64_t releases = 0;   // returned through release()
+    uint64_t reclaimed = 0;  // returned by the GC finalizer
+    uint64_t unpooled = 0;   // larger than the largest class
+};
+
+// One per handed-out Buffer; owned by that Buffer's finalizer
+struct PoolLease {
+    std::shared_ptr<PooledBufferState> state;
+    uint8_t* block;
+    int cls;
+    bool returned;
+    // Weak: ties release(buf) to this exact Buffer, not a later reuse of the block
+    Napi::ObjectReference owner;
+};
+
+static void ReturnBlock(Napi::Env env, PoolLease* lease) {
+    PooledBufferState& state = *lease->state;
+    state.leases.erase(lease->block);
+    lease->returned = true;
+
+    size_t freed = state.slab.Release(lease->cls, lease->block);
+    if (freed > 0) {
+        Napi::MemoryManagement::AdjustExternalMemory(env, -static_cast<int64_t>(freed));
+    }
+}
+
+static void FinalizeLease(Napi::Env env, uint8_t* /*data*/, PoolLease* lease) {
+    if (!lease->returned) {
+        lease->state->reclaimed++;
+        ReturnBlock(env, lease);
+    }
+    delete lease;
+}
+
+std::shared_ptr<PooledBufferState> DefaultBufferPool(Napi::Env env) {
+    AddonData* data = GetAddonData(env);
+    if (!data->default_pool) {
+        data->default_pool = std::make_shared<PooledBufferState>(SlabPool::DefaultClasses(), kDefaultPoolBytes);
+    }
+    return data->default_pool;
+}
+
+Napi::Buffer<uint8_t> AcquirePooledBuffer(Napi::Env env, const std::shared_ptr<PooledBufferState>& state, size_t size) {
+    int cls = state->slab.ClassFor(size);
+    if (cls < 0) {
+        state->unpooled++;
+        return Napi::Buffer<uint8_t>::New(env, size);
+    }
+
+    bool fresh = false;
+    uint8_t* block = state->slab.Acquire(cls, &fresh);
+    if (fresh) {
+        // Let V8 account for native memory when scheduling GC
+        Napi::MemoryManagement::AdjustExternalMemory(env, static_cast<int64_t>(state->slab.ClassSize(cls)));
+    }
+
+    PoolLease* lease = new PoolLease{state, block, cls, false, Napi::ObjectReference()};
+    Napi::Buffer<uint8_t> buffer;
+    try {
+        buffer = Napi::Buffer<uint8_t>::New(env, block, size, FinalizeLease, lease);
+    } catch (...) {
+        ReturnBlock(env, lease);
+        delete lease;
+        throw;
+    }
+
+    lease->owner = Napi::Weak(buffer.As<Napi::Object>());
+    state->leases[block] = lease;
+    return buffer;
+}
+
+bool ReleasePooledBuffer(Napi::Env env, const std::shared_ptr<PooledBufferState>& state, const Napi::Value& value) {
+    if (!value.IsBuffer()) {
+        return false;
+    }
+
+    Napi::Buffer<uint8_t> buffer = value.As<Napi::Buffer<uint8_t>>();
+    auto it = state->leases.find(buffer.Data());
+    if (it == state->leases.end()) {
+        return false;
+    }
+
+    PoolLease* lease = it->second;
+    Napi::Object owner = lease->owner.Value();
+    if (owner.IsEmpty() || !owner.StrictEquals(value)) {
+        return false;
+    }
+
+    state->releases++;
+    ReturnBlock(env, lease);
+    return true;
+}
+
+// Size-class pool of external buffers with explicit recycling
+class BufferPool : public Napi::ObjectWrap<BufferPool> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    BufferPool(const Napi::CallbackInfo& info);
+    ~BufferPool();
+
+private:
+    static Napi::FunctionReference constructor;
+
+    // Buffer of `size` bytes from the smallest fitting class
+    Napi::Value Acquire(const Napi::CallbackInfo& info);
+
+    // Return a buffer early (it must not be used afterwards)
+    Napi::Value Release(const Napi::CallbackInfo& info);
+
+    // Free blocks left idle since the previous trim
+    Napi::Value Trim(const Napi::CallbackInfo& info);
+
+    // Hit rate and byte counters
+    Napi::Value Stats(const Napi::CallbackInfo& info);
+
+    std::shared_ptr<PooledBufferState> state_;
+};
+
+Napi::FunctionReference BufferPool::constructor;
+
+Napi::Object BufferPool::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "BufferPool", {
+        InstanceMethod("acquire", &BufferPool::Acquire),
+        InstanceMethod("release", &BufferPool::Release),
+        InstanceMethod("trim", &BufferPool::Trim),
+        InstanceMethod("stats", &BufferPool::Stats),
+    });
+
+    constructor = Napi::Persistent(func);
+    constructor.SuppressDestruct();
+
+    exports.Set("BufferPool", func);
+    return exports;
+}
+
+// new BufferPool({ classes?: number[], maxBytes?: number })
+BufferPool::BufferPool(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<BufferPool>(info) {
+    Napi::Env env = info.Env();
+
+    std::vector<size_t> classes = SlabPool::DefaultClasses();
+    size_t max_bytes = kDefaultPoolBytes;
+
+    if (info.Length() > 0 && info[0].IsObject()) {
+        Napi::Object options = info[0].As<Napi::Object>();
+
+        if (options.Has("classes") && !options.Get("classes").IsUndefined()) {
+            Napi::Value value = options.Get("classes");
+            if (!value.IsArray() || value.As<Napi::Array>().Length() == 0) {
+                Napi::TypeError::New(env, "classes must be a non-empty array of sizes").ThrowAsJavaScriptException();
+                return;
+            }
+            Napi::Array list = value.As<Napi::Array>();
+            classes.clear();
+            for (uint32_t i = 0; i < list.Length(); i++) {
+                size_t size;
+                if (!ReadPoolSize(list.Get(i), 1, &size)) {
+                    Napi::TypeError::New(env, "classes must be a non-empty array of sizes").ThrowAsJavaScriptException();
+                    return;
+                }
+                classes.push_back(size);
+            }
+        }
+
+        if (options.Has("maxBytes") && !options.Get("maxBytes").IsUndefined()) {
+            if (!ReadPoolSize(options.Get("maxBytes"), 0, &max_bytes)) {
+                Napi::TypeError::New(env, "maxBytes must be a non-negative integer").ThrowAsJavaScriptException();
+                return;
+            }
+        }
+    }
+
+    state_ = std::make_shared<PooledBufferState>(classes, max_bytes);
+}
+
+BufferPool::~BufferPool() {
+    if (!state_) {
+        return;
+    }
+    // Outstanding buffers keep the state alive; stop caching so their
+    // blocks are freed as they come back.
+    state_->slab.SetMaxBytes(0);
+    size_t freed = state_->slab.Purge();
+    if (freed > 0) {
+        Napi::MemoryManagement::AdjustExternalMemory(Env(), -static_cast<int64_t>(freed));
+    }
+}
+
+Napi::Value BufferPool::Acquire(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    size_t size;
+    if (info.Length() < 1 || !ReadPoolSize(info[0], 0, &size)) {
+        Napi::TypeError::New(env, "Expected size").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    return AcquirePooledBuffer(env, state_, size);
+}
+
+Napi::Value BufferPool::Release(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsBuffer()) {
+        Napi::TypeError::New(env, "Expected buffer").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    return Napi::Boolean::New(env, ReleasePooledBuffer(env, state_, info[0]));
+}
+
+Napi::Value BufferPool::Trim(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    size_t freed = state_->slab.Trim();
+    if (freed > 0) {
+        Napi::MemoryManagement::AdjustExternalMemory(env, -static_cast<int64_t>(freed));
+    }
+    return Napi::Number::New(env, static_cast<double>(freed));
+}
+
+Napi::Value BufferPool::Stats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    const SlabPool::Stats& s = state_->slab.GetStats();
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("acquires", Napi::Number::New(env, static_cast<double>(s.acquires)));
+    result.Set("hits", Napi::Number::New(env, static_cast<double>(s.hits)));
+    result.Set("misses", Napi::Number::New(env, static_cast<double>(s.misses)));
+    result.Set("hitRate", Napi::Number::New(env, s.acquires ? static_cast<double>(s.hits) / s.acquires : 0.0));
+    result.Set("unpooled", Napi::Number::New(env, static_cast<double>(state_->unpooled)));
+    result.Set("releases", Napi::Number::New(env, static_cast<double>(state_->releases)));
+    result.Set("reclaimed", Napi::Number::New(env, static_cast<double>(state_->reclaimed)));
+    result.Set("outstanding", Napi::Number::New(env, static_cast<double>(state_->leases.size())));
+    result.Set("bytesResident", Napi::Number::New(env, static_cast<double>(s.bytes_outstanding + s.bytes_free)));
+    result.Set("bytesOutstanding", Napi::Number::New(env, static_cast<double>(s.bytes_outstanding)));
+    result.Set("bytesFree", Napi::Number::New(env, static_cast<double>(s.bytes_free)));
+    result.Set("highWater", Napi::Number::New(env, static_cast<double>(s.high_water)));
+    result.Set("maxBytes", Napi::Number::New(env, static_cast<double>(state_->slab.MaxBytes())));
+    return result;
+}
+
+// Module initialization
+Napi::Object InitBufferPool(Napi::Env env, Napi::Object exports) {
+    return BufferPool::Init(env, exports);
+}
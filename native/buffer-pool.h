@@ -0,0 +1,26 @@
+#pragma once
+
+#include <napi.h>
+#include <memory>
+
+// Pooled external Buffers on top of SlabPool. Shared by the BufferPool class
+// and the per-env default pool behind BufferOps.allocate.
+
+struct PooledBufferState;
+
+// Reads a size argument: an integral Number from `min` up to 2^53. False
+// for anything else, NaN and Infinity included.
+bool ReadPoolSize(const Napi::Value& value, double min, size_t* out);
+
+// The environment's default pool, created on first use.
+std::shared_ptr<PooledBufferState> DefaultBufferPool(Napi::Env env);
+
+// External Buffer of exactly `size` bytes backed by a pooled block. Sizes
+// above the largest class fall back to a plain Buffer. The block returns to
+// the pool on ReleasePooledBuffer or when the Buffer is garbage collected.
+Napi::Buffer<uint8_t> AcquirePooledBuffer(Napi::Env env, const std::shared_ptr<PooledBufferState>& state, size_t size);
+
+// Returns the block behind `value` to the pool right away. The caller must
+// not touch the Buffer afterwards. False when `value` did not come from this
+// pool or was already released.
+bool ReleasePooledBuffer(Napi::Env env, const std::shared_ptr<PooledBufferState>& state, const Napi::Value& value);
@@ -0,0 +1,66 @@
+#include "cpu-features.h"
+
+#if defined(HAS_X86_DISPATCH)
+  #include <cpuid.h>
+#endif
+
+#if defined(HAS_X86_DISPATCH)
+// XCR0 tells us which register state the OS saves on context switch; a CPU
+// advertising AVX is useless if the kernel does not preserve YMM/ZMM.
+static unsigned long long ReadXcr0() {
+    unsigned int eax = 0, edx = 0;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<unsigned long long>(edx) << 32) | eax;
+}
+#endif
+
+static CpuFeatures DetectCpuFeatures() {
+    CpuFeatures f;
+
+#if defined(HAS_X86_DISPATCH)
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return f;
+    }
+
+    f.sse2 = (edx & bit_SSE2) != 0;
+    f.ssse3 = (ecx & bit_SSSE3) != 0;
+    f.sse41 = (ecx & bit_SSE4_1) != 0;
+
+    bool osxsave = (ecx & bit_OSXSAVE) != 0;
+    bool avx = (ecx & bit_AVX) != 0;
+    bool fma = (ecx & bit_FMA) != 0;
+    bool f16c = (ecx & bit_F16C) != 0;
+    unsigned long long xcr0 = osxsave ? ReadXcr0() : 0;
+    bool ymm_state = (xcr0 & 0x6) == 0x6;     // XMM | YMM
+    bool zmm_state = (xcr0 & 0xe6) == 0xe6;   // XMM | YMM | opmask | ZMM
+
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        f.avx2 = avx && ymm_state && (ebx & bit_AVX2) != 0;
+        f.avx512f = zmm_state && (ebx & bit_AVX512F) != 0;
+        f.avx512bw = f.avx512f && (ebx & bit_AVX512BW) != 0;
+        f.sha = f.sse41 && f.ssse3 && (ebx & bit_SHA) != 0;
+    }
+    f.fma = f.avx2 && fma;
+    f.f16c = f.avx2 && f16c;
+#elif defined(HAS_ARM_SIMD)
+    // Advanced SIMD is mandatory on AArch64
+    f.neon = true;
+#endif
+
+    return f;
+}
+
+const CpuFeatures& GetCpuFeatures() {
+    static const CpuFeatures features = DetectCpuFeatures();
+    return features;
+}
+
+const char* SimdLevelName() {
+    const CpuFeatures& f = GetCpuFeatures();
+    if (f.avx512bw) return "avx512bw";
+    if (f.avx2) return "avx2";
+    if (f.sse2) return "sse2";
+    if (f.neon) return "neon";
+    return "scalar";
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+// Runtime CPU feature detection.
+//
+// The addon is built for the baseline ISA of the target (x86-64 / armv8) so a
+// single prebuilt binary loads everywhere. Wider kernels are compiled with
+// per-function target attributes and picked at module init from these flags.
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+  #define HAS_X86_SIMD 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+  #define HAS_ARM_SIMD 1
+#endif
+
+#if defined(HAS_X86_SIMD) && (defined(__GNUC__) || defined(__clang__))
+  #define OPENCLAW_TARGET(isa) __attribute__((target(isa)))
+  #define HAS_X86_DISPATCH 1
+#else
+  #define OPENCLAW_TARGET(isa)
+#endif
+
+struct CpuFeatures {
+    bool sse2 = false;
+    bool ssse3 = false;
+    bool sse41 = false;
+    bool avx2 = false;
+    bool fma = false;
+    bool f16c = false;
+    bool avx512f = false;
+    bool avx512bw = false;
+    bool sha = false;       // SHA-256 extensions (SHA-NI)
+    bool neon = false;
+};
+
+// Detected once (cpuid + xgetbv on x86) and cached for the process lifetime.
+const CpuFeatures& GetCpuFeatures();
+
+// Name of the widest kernel family usable on this host, for diagnostics.
+const char* SimdLevelName();
@@ -0,0 +1,349 @@
+#include <napi.h>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "embedding-store.h"
+#include "op-stats.h"
+
+// Content-addressed embedding cache over EmbeddingStore: a memory-mapped
+// file shared by every agent, worker and process that embeds with the same
+// model. Lookups are lock-free; writes take a file lock.
+class EmbeddingCache : public Napi::ObjectWrap<EmbeddingCache> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    EmbeddingCache(const Napi::CallbackInfo& info);
+
+private:
+    static Napi::FunctionReference constructor;
+
+    Napi::Value Get(const Napi::CallbackInfo& info);
+    Napi::Value Set(const Napi::CallbackInfo& info);
+
+    // Batch lookup with the dedupe step for embedding requests: which
+    // hashes hit, and the first index of each distinct hash that missed
+    Napi::Value Lookup(const Napi::CallbackInfo& info);
+    Napi::Value SetMany(const Napi::CallbackInfo& info);
+
+    // Hits, misses, inserts and evictions through this handle
+    Napi::Value Stats(const Napi::CallbackInfo& info);
+    Napi::Value Close(const Napi::CallbackInfo& info);
+
+    Napi::Value Size(const Napi::CallbackInfo& info);
+    Napi::Value Capacity(const Napi::CallbackInfo& info);
+    Napi::Value Dims(const Napi::CallbackInfo& info);
+
+    // Throws unless the store is open
+    bool CheckOpen(Napi::Env env);
+
+    // Keys for a string array; false (with a TypeError) on a non-string
+    bool ReadKeys(Napi::Env env, const Napi::Value& value, std::vector<std::string>* hashes,
+                  std::vector<uint8_t>* keys);
+
+    std::unique_ptr<EmbeddingStore> store_;
+    std::string namespace_;
+};
+
+Napi::FunctionReference EmbeddingCache::constructor;
+
+Napi::Object EmbeddingCache::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "EmbeddingCache", {
+        InstanceMethod("get", &EmbeddingCache::Get),
+        InstanceMethod("set", &EmbeddingCache::Set),
+        InstanceMethod("lookup", &EmbeddingCache::Lookup),
+        InstanceMethod("setMany", &EmbeddingCache::SetMany),
+        InstanceMethod("stats", &EmbeddingCache::Stats),
+        InstanceMethod("close", &EmbeddingCache::Close),
+        InstanceAccessor("size", &EmbeddingCache::Size, nullptr),
+        InstanceAccessor("capacity", &EmbeddingCache::Capacity, nullptr),
+        InstanceAccessor("dims", &EmbeddingCache::Dims, nullptr),
+    });
+
+    constructor = Napi::Persistent(func);
+    constructor.SuppressDestruct();
+
+    exports.Set("EmbeddingCache", func);
+    return exports;
+}
+
+// new EmbeddingCache(path, { dims?, capacity?, type?: 'f32' | 'f16', namespace? })
+// Without dims the file must already exist.
+EmbeddingCache::EmbeddingCache(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<EmbeddingCache>(info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString() || (info.Length() > 1 && !info[1].IsUndefined() && !info[1].IsObject())) {
+        Napi::TypeError::New(env, "Expected (path, { dims?, capacity?, type?, namespace? })")
+            .ThrowAsJavaScriptException();
+        return;
+    }
+
+    std::string path = info[0].As<Napi::String>().Utf8Value();
+    Napi::Object options = info.Length() > 1 && info[1].IsObject() ? info[1].As<Napi::Object>()
+                                                                    : Napi::Object::New(env);
+
+    size_t dims = 0;
+    Napi::Value dims_value = options.Get("dims");
+    if (!dims_value.IsUndefined()) {
+        if (!dims_value.IsNumber() || dims_value.As<Napi::Number>().DoubleValue() < 1) {
+            Napi::TypeError::New(env, "dims must be a positive number").ThrowAsJavaScriptException();
+            return;
+        }
+        dims = static_cast<size_t>(dims_value.As<Napi::Number>().Int64Value());
+    }
+
+    size_t capacity = 0;
+    Napi::Value capacity_value = options.Get("capacity");
+    if (!capacity_value.IsUndefined()) {
+        if (!capacity_value.IsNumber() || !(capacity_value.As<Napi::Number>().DoubleValue() >= 1)) {
+            Napi::TypeError::New(env, "capacity must be a positive number").ThrowAsJavaScriptException();
+            return;
+        }
+        capacity = static_cast<size_t>(capacity_value.As<Napi::Number>().Int64Value());
+    }
+
+    VectorElement type = VectorElement::kF32;
+    Napi::Value type_value = options.Get("type");
+    if (!type_value.IsUndefined()) {
+        std::string name = type_value.IsString() ? type_value.As<Napi::String>().Utf8Value() : "";
+        if (name == "f16") {
+            type = VectorElement::kF16;
+        } else if (name != "f32") {
+            Napi::TypeError::New(env, "type must be 'f32' or 'f16'").ThrowAsJavaScriptException();
+            return;
+        }
+    }
+
+    Napi::Value ns_value = options.Get("namespace");
+    if (!ns_value.IsUndefined()) {
+        if (!ns_value.IsString()) {
+            Napi::TypeError::New(env, "namespace must be a string").ThrowAsJavaScriptException();
+            return;
+        }
+        namespace_ = ns_value.As<Napi::String>().Utf8Value();
+    }
+
+    try {
+        store_ = std::make_unique<EmbeddingStore>(path, dims, capacity, type);
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    }
+}
+
+bool EmbeddingCache::CheckOpen(Napi::Env env) {
+    if (!store_ || !store_->IsOpen()) {
+        Napi::Error::New(env, "EmbeddingCache is closed").ThrowAsJavaScriptException();
+        return false;
+    }
+    return true;
+}
+
+bool EmbeddingCache::ReadKeys(Napi::Env env, const Napi::Value& value, std::vector<std::string>* hashes,
+                              std::vector<uint8_t>* keys) {
+    Napi::Array list = value.As<Napi::Array>();
+    uint32_t count = list.Length();
+    hashes->reserve(count);
+    keys->resize(static_cast<size_t>(count) * EmbeddingStore::kKeyBytes);
+    for (uint32_t i = 0; i < count; i++) {
+        Napi::Value item = list.Get(i);
+        if (!item.IsString()) {
+            Napi::TypeError::New(env, "hashes must be strings").ThrowAsJavaScriptException();
+            return false;
+        }
+        hashes->push_back(item.As<Napi::String>().Utf8Value());
+        EmbeddingStore::MakeKey(namespace_, hashes->back(), keys->data() + i * EmbeddingStore::kKeyBytes);
+    }
+    return true;
+}
+
+// get(hash) -> Float32Array | null
+Napi::Value EmbeddingCache::Get(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected hash").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    if (!CheckOpen(env)) {
+        return env.Null();
+    }
+
+    uint8_t key[EmbeddingStore::kKeyBytes];
+    EmbeddingStore::MakeKey(namespace_, info[0].As<Napi::String>().Utf8Value(), key);
+    Napi::Float32Array vector = Napi::Float32Array::New(env, store_->Dims());
+    if (!store_->Get(key, vector.Data())) {
+        return env.Null();
+    }
+    return vector;
+}
+
+// set(hash, vector: Float32Array)
+Napi::Value EmbeddingCache::Set(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected (hash, vector)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    if (!CheckOpen(env)) {
+        return env.Null();
+    }
+    if (!info[1].IsTypedArray() || info[1].As<Napi::TypedArray>().TypedArrayType() != napi_float32_array) {
+        Napi::TypeError::New(env, "Expected Float32Array").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    Napi::Float32Array vector = info[1].As<Napi::Float32Array>();
+    if (vector.ElementLength() != store_->Dims()) {
+        Napi::RangeError::New(env, "Vector length does not match dims").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    uint8_t key[EmbeddingStore::kKeyBytes];
+    EmbeddingStore::MakeKey(namespace_, info[0].As<Napi::String>().Utf8Value(), key);
+    try {
+        store_->PutMany(key, vector.Data(), 1);
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    }
+    return env.Undefined();
+}
+
+// lookup(hashes) -> { vectors: Float32Array, found: Uint8Array, missing: Uint32Array }
+// vectors holds hashes.length x dims floats (zero rows for misses);
+// missing lists, in order, the first index of every distinct hash that
+// missed, so each uncached text is embedded once.
+Napi::Value EmbeddingCache::Lookup(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsArray()) {
+        Napi::TypeError::New(env, "Expected hashes").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    if (!CheckOpen(env)) {
+        return env.Null();
+    }
+
+    std::vector<std::string> hashes;
+    std::vector<uint8_t> keys;
+    if (!ReadKeys(env, info[0], &hashes, &keys)) {
+        return env.Null();
+    }
+
+    OpScope scope(NativeOp::kEmbeddingCacheLookup);
+    size_t count = hashes.size();
+    size_t dims = store_->Dims();
+    Napi::Float32Array vectors = Napi::Float32Array::New(env, count * dims);
+    Napi::Uint8Array found = Napi::Uint8Array::New(env, count);
+    float* out = vectors.Data();
+    uint8_t* flags = found.Data();
+
+    // First index per distinct hash; repeats copy that row instead of
+    // probing the table again
+    std::unordered_map<std::string, size_t> first;
+    first.reserve(count);
+    std::vector<uint32_t> missing;
+    for (size_t i = 0; i < count; i++) {
+        auto inserted = first.emplace(hashes[i], i);
+        if (!inserted.second) {
+            size_t j = inserted.first->second;
+            flags[i] = flags[j];
+            if (flags[j]) {
+                std::memcpy(out + i * dims, out + j * dims, dims * sizeof(float));
+            }
+            continue;
+        }
+        flags[i] = store_->Get(keys.data() + i * EmbeddingStore::kKeyBytes, out + i * dims) ? 1 : 0;
+        if (!flags[i]) {
+            std::memset(out + i * dims, 0, dims * sizeof(float));
+            missing.push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    Napi::Uint32Array missing_out = Napi::Uint32Array::New(env, missing.size());
+    if (!missing.empty()) {
+        std::memcpy(missing_out.Data(), missing.data(), missing.size() * sizeof(uint32_t));
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("vectors", vectors);
+    result.Set("found", found);
+    result.Set("missing", missing_out);
+    return result;
+}
+
+// setMany(hashes, vectors: Float32Array of hashes.length x dims)
+Napi::Value EmbeddingCache::SetMany(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsArray()) {
+        Napi::TypeError::New(env, "Expected (hashes, vectors)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    if (!CheckOpen(env)) {
+        return env.Null();
+    }
+
+    std::vector<std::string> hashes;
+    std::vector<uint8_t> keys;
+    if (!ReadKeys(env, info[0], &hashes, &keys)) {
+        return env.Null();
+    }
+    if (!info[1].IsTypedArray() || info[1].As<Napi::TypedArray>().TypedArrayType() != napi_float32_array) {
+        Napi::TypeError::New(env, "Expected Float32Array").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    Napi::Float32Array vectors = info[1].As<Napi::Float32Array>();
+    if (vectors.ElementLength() != hashes.size() * store_->Dims()) {
+        Napi::RangeError::New(env, "Vector length does not match dims").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    try {
+        store_->PutMany(keys.data(), vectors.Data(), hashes.size());
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    }
+    return env.Undefined();
+}
+
+Napi::Value EmbeddingCache::Stats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (!CheckOpen(env)) {
+        return env.Null();
+    }
+
+    const EmbeddingStore::Stats& stats = store_->GetStats();
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("size", Napi::Number::New(env, static_cast<double>(store_->Size())));
+    result.Set("capacity", Napi::Number::New(env, static_cast<double>(store_->Capacity())));
+    result.Set("hits", Napi::Number::New(env, static_cast<double>(stats.hits)));
+    result.Set("misses", Napi::Number::New(env, static_cast<double>(stats.misses)));
+    result.Set("inserts", Napi::Number::New(env, static_cast<double>(stats.inserts)));
+    result.Set("evictions", Napi::Number::New(env, static_cast<double>(stats.evictions)));
+    return result;
+}
+
+Napi::Value EmbeddingCache::Close(const Napi::CallbackInfo& info) {
+    store_.reset();
+    return info.Env().Undefined();
+}
+
+Napi::Value EmbeddingCache::Size(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), store_ ? static_cast<double>(store_->Size()) : 0);
+}
+
+Napi::Value EmbeddingCache::Capacity(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), store_ ? static_cast<double>(store_->Capacity()) : 0);
+}
+
+Napi::Value EmbeddingCache::Dims(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), store_ ? static_cast<double>(store_->Dims()) : 0);
+}
+
+// Module initialization
+Napi::Object InitEmbeddingCache(Napi::Env env, Napi::Object exports) {
+    return EmbeddingCache::Init(env, exports);
+}
@@ -0,0 +1,388 @@
+#include "embedding-store.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "sha256.h"
+
+// Files are written in host byte order; every supported target is
+// little-endian. The atomics below live in the shared mapping, which is
+// only sound because they are lock-free (checked at compile time).
+
+static constexpr size_t kHeaderBytes = 4096;
+static constexpr size_t kRowAlign = 64;
+static constexpr size_t kPageAlign = 4096;
+static constexpr size_t kSlotBytes = 32;
+static constexpr size_t kMinCapacity = 1024;
+static constexpr size_t kMaxCapacity = size_t{1} << 26;
+static constexpr uint32_t kFormatVersion = 1;
+static constexpr char kMagic[8] = {'O', 'C', 'E', 'M', 'B', 'C', 'H', '\0'};
+// A reader seeing a slot mid-write this many times in a row treats it as a miss
+static constexpr int kReadRetries = 64;
+// How long an open without dims waits for another process to create the file
+static constexpr int kOpenRetries = 50;
+static constexpr useconds_t kOpenRetryMicros = 2000;
+
+struct CacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t dims;
+    uint32_t type;
+    uint32_t stride;
+    uint64_t capacity;
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> clock;
+};
+
+struct EmbeddingStore::Slot {
+    // 0 = never written, odd = being written
+    std::atomic<uint32_t> seq;
+    uint32_t reserved;
+    std::atomic<uint64_t> stamp;
+    uint8_t key[kKeyBytes];
+};
+
+static_assert(sizeof(CacheHeader) <= kHeaderBytes, "header must fit its page");
+static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free,
+              "shared-memory atomics must be lock-free");
+
+[[noreturn]] static void ThrowIoError(const char* what, const std::string& path) {
+    throw std::runtime_error(std::string(what) + " " + path + ": " + std::strerror(errno));
+}
+
+namespace {
+
+// flock() held for the lifetime of the guard
+class FileLock {
+public:
+    FileLock(int fd, const std::string& path) : fd_(fd) {
+        while (::flock(fd_, LOCK_EX) != 0) {
+            if (errno != EINTR) {
+                ThrowIoError("lock", path);
+            }
+        }
+    }
+    ~FileLock() { ::flock(fd_, LOCK_UN); }
+
+    FileLock(const FileLock&) = delete;
+    FileLock& operator=(const FileLock&) = delete;
+
+private:
+    int fd_;
+};
+
+}  // namespace
+
+static size_t RoundUp(size_t value, size_t align) {
+    return (value + align - 1) / align * align;
+}
+
+static size_t RowsOffset(size_t capacity) {
+    return RoundUp(kHeaderBytes + capacity * kSlotBytes, kPageAlign);
+}
+
+EmbeddingStore::EmbeddingStore(const std::string& path, size_t dims, size_t capacity, VectorElement type)
+    : path_(path), dims_(dims), type_(type) {
+    static_assert(sizeof(Slot) == kSlotBytes, "slot layout is part of the file format");
+    if (dims > UINT32_MAX / 4) {
+        throw std::runtime_error("invalid vector dimension");
+    }
+    if (type == VectorElement::kInt8) {
+        throw std::runtime_error("embedding store rows must be f32 or f16");
+    }
+
+    try {
+        fd_ = ::open(path.c_str(), dims == 0 ? O_RDWR | O_CLOEXEC : O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd_ < 0) {
+            ThrowIoError("open", path);
+        }
+
+        for (int attempt = 0;; attempt++) {
+            if (OpenLocked(dims, capacity)) {
+                return;
+            }
+            // dims = 0 and the file has no header yet: its creator opened it
+            // but has not taken the lock. Give it a moment before giving up.
+            if (attempt == kOpenRetries) {
+                throw std::runtime_error("embedding store is empty: " + path);
+            }
+            ::usleep(kOpenRetryMicros);
+        }
+    } catch (...) {
+        Close();
+        throw;
+    }
+}
+
+// Sizes and initializes the file, or validates and maps it, under the
+// file lock so two processes creating the same file cannot both write a
+// header. False when dims = 0 and there is no header to read yet.
+bool EmbeddingStore::OpenLocked(size_t dims, size_t capacity) {
+    FileLock lock(fd_, path_);
+    struct stat st;
+    if (::fstat(fd_, &st) != 0) {
+        ThrowIoError("stat", path_);
+    }
+
+    CacheHeader header;
+    bool has_header = ::pread(fd_, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header));
+    // The magic is written last, under this lock, so a file without one was
+    // left behind by a creator that died part way; start it over
+    static constexpr char kNoMagic[sizeof(kMagic)] = {};
+    if (!has_header || std::memcmp(header.magic, kNoMagic, sizeof(kNoMagic)) == 0) {
+        if (dims == 0) {
+            return false;
+        }
+        if (st.st_size != 0 && ::ftruncate(fd_, 0) != 0) {
+            ThrowIoError("reset", path_);
+        }
+        capacity_ = kMinCapacity;
+        while (capacity_ < std::min(capacity, kMaxCapacity)) {
+            capacity_ <<= 1;
+        }
+        stride_ = RoundUp(dims_ * VectorElementSize(type_), kRowAlign);
+        rows_offset_ = RowsOffset(capacity_);
+        size_t bytes = rows_offset_ + capacity_ * stride_;
+        // Sparse: pages are only allocated once a slot is written
+        if (::ftruncate(fd_, static_cast<off_t>(bytes)) != 0) {
+            ThrowIoError("resize", path_);
+        }
+        Map(bytes);
+        CacheHeader* created = reinterpret_cast<CacheHeader*>(map_);
+        created->version = kFormatVersion;
+        created->dims = static_cast<uint32_t>(dims_);
+        created->type = static_cast<uint32_t>(type_);
+        created->stride = static_cast<uint32_t>(stride_);
+        created->capacity = capacity_;
+        std::memcpy(created->magic, kMagic, sizeof(kMagic));
+        return true;
+    }
+
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kFormatVersion ||
+        header.capacity < kMinCapacity || header.capacity > kMaxCapacity ||
+        (header.capacity & (header.capacity - 1)) != 0 || header.dims == 0 ||
+        header.type > static_cast<uint32_t>(VectorElement::kF16)) {
+        throw std::runtime_error("not an embedding store: " + path_);
+    }
+    if (dims != 0 && (header.dims != dims_ || header.type != static_cast<uint32_t>(type_))) {
+        throw std::runtime_error("embedding store " + path_ + " has dims " + std::to_string(header.dims) +
+                                 " / type " + std::to_string(header.type) + ", expected " +
+                                 std::to_string(dims_) + " / " + std::to_string(static_cast<int>(type_)));
+    }
+    dims_ = header.dims;
+    type_ = static_cast<VectorElement>(header.type);
+    stride_ = header.stride;
+    capacity_ = static_cast<size_t>(header.capacity);
+    if (stride_ < dims_ * VectorElementSize(type_)) {
+        throw std::runtime_error("not an embedding store: " + path_);
+    }
+    rows_offset_ = RowsOffset(capacity_);
+    size_t bytes = rows_offset_ + capacity_ * stride_;
+    if (static_cast<uint64_t>(st.st_size) < bytes) {
+        throw std::runtime_error("embedding store is truncated: " + path_);
+    }
+    Map(bytes);
+    return true;
+}
+
+EmbeddingStore::~EmbeddingStore() {
+    Close();
+}
+
+void EmbeddingStore::Close() {
+    if (map_ != nullptr) {
+        ::munmap(map_, map_bytes_);
+        map_ = nullptr;
+        map_bytes_ = 0;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+void EmbeddingStore::Map(size_t bytes) {
+    void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (p == MAP_FAILED) {
+        ThrowIoError("mmap", path_);
+    }
+    map_ = static_cast<uint8_t*>(p);
+    map_bytes_ = bytes;
+}
+
+void EmbeddingStore::MakeKey(const std::string& ns, const std::string& hash, uint8_t out[kKeyBytes]) {
+    Sha256 sha;
+    sha.Update(ns.data(), ns.size());
+    sha.Update("", 1);
+    sha.Update(hash.data(), hash.size());
+    uint8_t digest[kSha256DigestSize];
+    sha.Final(digest);
+    std::memcpy(out, digest, kKeyBytes);
+}
+
+EmbeddingStore::Slot* EmbeddingStore::SlotAt(size_t index) const {
+    return reinterpret_cast<Slot*>(map_ + kHeaderBytes) + index;
+}
+
+uint8_t* EmbeddingStore::RowAt(size_t index) const {
+    return map_ + rows_offset_ + index * stride_;
+}
+
+size_t EmbeddingStore::Home(const uint8_t* key) const {
+    uint64_t h;
+    std::memcpy(&h, key, sizeof(h));
+    return static_cast<size_t>(h) & (capacity_ - 1);
+}
+
+size_t EmbeddingStore::Size() const {
+    return static_cast<size_t>(reinterpret_cast<const CacheHeader*>(map_)->count.load(std::memory_order_relaxed));
+}
+
+EmbeddingStore::ReadResult EmbeddingStore::ReadSlot(size_t index, const uint8_t* key, float* out) {
+    Slot* slot = SlotAt(index);
+    for (int attempt = 0; attempt < kReadRetries; attempt++) {
+        uint32_t before = slot->seq.load(std::memory_order_acquire);
+        if (before == 0) {
+            return ReadResult::kEmpty;
+        }
+        if (before & 1) {
+            continue;
+        }
+        uint8_t stored[kKeyBytes];
+        std::memcpy(stored, slot->key, kKeyBytes);
+        bool match = std::memcmp(stored, key, kKeyBytes) == 0;
+        if (match) {
+            const uint8_t* row = RowAt(index);
+            if (type_ == VectorElement::kF16) {
+                const uint16_t* half = reinterpret_cast<const uint16_t*>(row);
+                for (size_t j = 0; j < dims_; j++) {
+                    out[j] = HalfToFloat(half[j]);
+                }
+            } else {
+                std::memcpy(out, row, dims_ * sizeof(float));
+            }
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot->seq.load(std::memory_order_relaxed) != before) {
+            continue;
+        }
+        return match ? ReadResult::kMatch : ReadResult::kOther;
+    }
+    return ReadResult::kOther;
+}
+
+void EmbeddingStore::WriteSlot(size_t index, const uint8_t* key, const float* vector, uint64_t stamp) {
+    Slot* slot = SlotAt(index);
+    // Already odd when a writer died mid-slot; stays odd until the end
+    uint32_t seq = slot->seq.load(std::memory_order_relaxed) | 1;
+    slot->seq.store(seq, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    std::memcpy(slot->key, key, kKeyBytes);
+    uint8_t* row = RowAt(index);
+    if (type_ == VectorElement::kF16) {
+        uint16_t* half = reinterpret_cast<uint16_t*>(row);
+        for (size_t j = 0; j < dims_; j++) {
+            half[j] = FloatToHalf(vector[j]);
+        }
+    } else {
+        std::memcpy(row, vector, dims_ * sizeof(float));
+    }
+    slot->stamp.store(stamp, std::memory_order_relaxed);
+    slot->seq.store(seq + 1, std::memory_order_release);
+}
+
+bool EmbeddingStore::Get(const uint8_t* key, float* out) {
+    CacheHeader* header = reinterpret_cast<CacheHeader*>(map_);
+    size_t home = Home(key);
+    for (size_t way = 0; way < kWays; way++) {
+        size_t index = (home + way) & (capacity_ - 1);
+        ReadResult result = ReadSlot(index, key, out);
+        if (result == ReadResult::kEmpty) {
+            break;
+        }
+        if (result == ReadResult::kMatch) {
+            // Refresh the stamp only once it has aged a little, so hot
+            // entries do not write their cache line on every read
+            Slot* slot = SlotAt(index);
+            uint64_t now = header->clock.load(std::memory_order_relaxed);
+            if (now - slot->stamp.load(std::memory_order_relaxed) > capacity_ / 8) {
+                slot->stamp.store(now, std::memory_order_relaxed);
+            }
+            stats_.hits++;
+            return true;
+        }
+    }
+    stats_.misses++;
+    return false;
+}
+
+void EmbeddingStore::PutMany(const uint8_t* keys, const float* vectors, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    CacheHeader* header = reinterpret_cast<CacheHeader*>(map_);
+    FileLock lock(fd_, path_);
+
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t* key = keys + i * kKeyBytes;
+        uint64_t stamp = header->clock.fetch_add(1, std::memory_order_relaxed) + 1;
+        size_t home = Home(key);
+        size_t target = SIZE_MAX;
+        size_t oldest = SIZE_MAX;
+        uint64_t oldest_stamp = UINT64_MAX;
+        size_t dead = SIZE_MAX;
+        bool present = false;
+
+        // Under the lock no slot is mid-write, so plain reads are stable
+        for (size_t way = 0; way < kWays; way++) {
+            size_t index = (home + way) & (capacity_ - 1);
+            Slot* slot = SlotAt(index);
+            uint32_t seq = slot->seq.load(std::memory_order_relaxed);
+            if (seq == 0) {
+                target = index;
+                break;
+            }
+            // Odd under the lock: a writer died filling it. Reused first,
+            // and its key is not trusted.
+            if (seq & 1) {
+                if (dead == SIZE_MAX) {
+                    dead = index;
+                }
+                continue;
+            }
+            if (std::memcmp(slot->key, key, kKeyBytes) == 0) {
+                slot->stamp.store(stamp, std::memory_order_relaxed);
+                present = true;
+                break;
+            }
+            uint64_t slot_stamp = slot->stamp.load(std::memory_order_relaxed);
+            if (slot_stamp < oldest_stamp) {
+                oldest_stamp = slot_stamp;
+                oldest = index;
+            }
+        }
+        if (present) {
+            continue;
+        }
+        if (dead != SIZE_MAX) {
+            target = dead;
+        } else if (target == SIZE_MAX) {
+            target = oldest;
+            stats_.evictions++;
+        } else {
+            header->count.fetch_add(1, std::memory_order_relaxed);
+        }
+        WriteSlot(target, key, vectors + i * dims_, stamp);
+        stats_.inserts++;
+    }
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "vector-ops.h"
+
+// Content-addressed embedding cache in one memory-mapped file, shared by
+// every process and worker that opens the same path.
+//
+// Entries are keyed by a 16-byte digest of (namespace, content hash); the
+// namespace names the provider model, so one file can serve every agent
+// that embeds with it. Layout:
+//
+//   4 KiB header      dims, element type, capacity, live count, clock
+//   slot table        capacity x 32 bytes: sequence, stamp, key
+//   rows              capacity x 64-byte aligned vector slots (f32 or f16)
+//
+// The table is open addressing with a fixed probe window: a key lives in
+// one of the kWays slots after its home slot. When the window is full the
+// slot with the oldest stamp is overwritten, so the file never grows and
+// eviction is approximately LRU. Capacity is fixed when the file is created.
+//
+// Readers take no locks. Each slot has a sequence counter that is odd while
+// a writer fills it; a reader copies the key and vector between two reads
+// of the counter and retries on a mismatch (a seqlock). Writers serialize
+// through flock() on the file, so any number of processes may write.
+//
+// I/O and format errors throw std::runtime_error.
+
+class EmbeddingStore {
+public:
+    static constexpr size_t kKeyBytes = 16;
+    static constexpr size_t kWays = 16;
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t inserts = 0;
+        uint64_t evictions = 0;
+    };
+
+    // Opens `path`, creating it with `capacity` slots (rounded up to a power
+    // of two) when it does not exist. dims = 0 opens an existing file only,
+    // taking dims and type from it; otherwise an existing file must match.
+    // A file without a header (its creator died part way) is created over
+    // when dims is given; without dims the open waits briefly for another
+    // process to finish creating it, then throws "embedding store is empty".
+    EmbeddingStore(const std::string& path, size_t dims, size_t capacity, VectorElement type);
+    ~EmbeddingStore();
+
+    EmbeddingStore(const EmbeddingStore&) = delete;
+    EmbeddingStore& operator=(const EmbeddingStore&) = delete;
+
+    // Key for `hash` under `ns`: the first 16 bytes of SHA-256(ns \0 hash)
+    static void MakeKey(const std::string& ns, const std::string& hash, uint8_t out[kKeyBytes]);
+
+    // Copies the vector for `key` into out[0, dims); false on a miss
+    bool Get(const uint8_t* key, float* out);
+
+    // Inserts `count` vectors (count * dims floats) under one file lock.
+    // Keys already present keep their vector and only refresh their stamp.
+    void PutMany(const uint8_t* keys, const float* vectors, size_t count);
+
+    size_t Size() const;
+    size_t Capacity() const { return capacity_; }
+    size_t Dims() const { return dims_; }
+    VectorElement Type() const { return type_; }
+    const Stats& GetStats() const { return stats_; }
+
+    void Close();
+    bool IsOpen() const { return fd_ >= 0; }
+
+private:
+    struct Slot;
+
+    enum class ReadResult { kEmpty, kOther, kMatch };
+
+    bool OpenLocked(size_t dims, size_t capacity);
+    Slot* SlotAt(size_t index) const;
+    uint8_t* RowAt(size_t index) const;
+    size_t Home(const uint8_t* key) const;
+    ReadResult ReadSlot(size_t index, const uint8_t* key, float* out);
+    void WriteSlot(size_t index, const uint8_t* key, const float* vector, uint64_t stamp);
+    void Map(size_t bytes);
+
+    std::string path_;
+    size_t dims_ = 0;
+    VectorElement type_ = VectorElement::kF32;
+    size_t stride_ = 0;
+    size_t capacity_ = 0;
+    size_t rows_offset_ = 0;
+
+    int fd_ = -1;
+    uint8_t* map_ = nullptr;
+    size_t map_bytes_ = 0;
+
+    Stats stats_;
+};
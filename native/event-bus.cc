@@ -0,0 +1,261 @@
+#include <napi.h>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+#include "event-ring.h"
+#include "op-stats.h"
+
+// Shared-memory event bus over EventRing: producers in any thread or
+// process publish pre-serialized frames under one sequence, and every
+// reader consumes the same ordered stream with its own cursor.
+class EventBus : public Napi::ObjectWrap<EventBus> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    EventBus(const Napi::CallbackInfo& info);
+
+private:
+    static Napi::FunctionReference constructor;
+
+    // Two-phase publish for frames that embed their own seq
+    Napi::Value Claim(const Napi::CallbackInfo& info);
+    Napi::Value Commit(const Napi::CallbackInfo& info);
+    Napi::Value Publish(const Napi::CallbackInfo& info);
+
+    Napi::Value Read(const Napi::CallbackInfo& info);
+    Napi::Value Close(const Napi::CallbackInfo& info);
+
+    Napi::Value Head(const Napi::CallbackInfo& info);
+    Napi::Value Slots(const Napi::CallbackInfo& info);
+    Napi::Value DataBytes(const Napi::CallbackInfo& info);
+    Napi::Value MaxFrame(const Napi::CallbackInfo& info);
+
+    // Throws unless the ring is open
+    bool CheckOpen(Napi::Env env);
+
+    std::unique_ptr<EventRing> ring_;
+};
+
+Napi::FunctionReference EventBus::constructor;
+
+static constexpr size_t kDefaultSlots = 16384;
+static constexpr size_t kDefaultDataBytes = size_t{32} << 20;
+static constexpr size_t kDefaultReadEvents = 256;
+static constexpr size_t kDefaultReadBytes = size_t{4} << 20;
+
+Napi::Object EventBus::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "EventBus", {
+        InstanceMethod("claim", &EventBus::Claim),
+        InstanceMethod("commit", &EventBus::Commit),
+        InstanceMethod("publish", &EventBus::Publish),
+        InstanceMethod("read", &EventBus::Read),
+        InstanceMethod("close", &EventBus::Close),
+        InstanceAccessor("head", &EventBus::Head, nullptr),
+        InstanceAccessor("slots", &EventBus::Slots, nullptr),
+        InstanceAccessor("dataBytes", &EventBus::DataBytes, nullptr),
+        InstanceAccessor("maxFrame", &EventBus::MaxFrame, nullptr),
+    });
+
+    constructor = Napi::Persistent(func);
+    constructor.SuppressDestruct();
+
+    exports.Set("EventBus", func);
+    return exports;
+}
+
+// Positive integer option, or `fallback` when absent; false (with a
+// TypeError) otherwise
+static bool ReadSizeOption(Napi::Env env, Napi::Object options, const char* name, size_t fallback, size_t* out) {
+    Napi::Value value = options.Get(name);
+    if (value.IsUndefined()) {
+        *out = fallback;
+        return true;
+    }
+    if (!value.IsNumber() || !(value.As<Napi::Number>().DoubleValue() >= 1)) {
+        Napi::TypeError::New(env, std::string(name) + " must be a positive number").ThrowAsJavaScriptException();
+        return false;
+    }
+    *out = static_cast<size_t>(value.As<Napi::Number>().Int64Value());
+    return true;
+}
+
+// new EventBus(path, { slots?, dataBytes?, reset? })
+// An existing file keeps its sizes unless reset replaces it.
+EventBus::EventBus(const Napi::CallbackInfo& info) : Napi::ObjectWrap<EventBus>(info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString() || (info.Length() > 1 && !info[1].IsUndefined() && !info[1].IsObject())) {
+        Napi::TypeError::New(env, "Expected (path, { slots?, dataBytes?, reset? })").ThrowAsJavaScriptException();
+        return;
+    }
+
+    std::string path = info[0].As<Napi::String>().Utf8Value();
+    Napi::Object options = info.Length() > 1 && info[1].IsObject() ? info[1].As<Napi::Object>()
+                                                                    : Napi::Object::New(env);
+
+    size_t slots = 0;
+    size_t data_bytes = 0;
+    if (!ReadSizeOption(env, options, "slots", kDefaultSlots, &slots) ||
+        !ReadSizeOption(env, options, "dataBytes", kDefaultDataBytes, &data_bytes)) {
+        return;
+    }
+    bool reset = options.Get("reset").ToBoolean().Value();
+
+    try {
+        ring_ = std::make_unique<EventRing>(path, slots, data_bytes, reset);
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    }
+}
+
+bool EventBus::CheckOpen(Napi::Env env) {
+    if (!ring_ || !ring_->IsOpen()) {
+        Napi::Error::New(env, "EventBus is closed").ThrowAsJavaScriptException();
+        return false;
+    }
+    return true;
+}
+
+// claim() -> seq
+Napi::Value EventBus::Claim(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (!CheckOpen(env)) {
+        return env.Null();
+    }
+    return Napi::Number::New(env, static_cast<double>(ring_->Claim()));
+}
+
+// commit(seq, frame: Buffer, tag = 0) -> boolean
+// Every claimed seq must be committed, or readers stop at it.
+Napi::Value EventBus::Commit(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsBuffer() ||
+        (info.Length() > 2 && !info[2].IsUndefined() && !info[2].IsNumber())) {
+        Napi::TypeError::New(env, "Expected (seq, frame, tag?)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    if (!CheckOpen(env)) {
+        return env.Null();
+    }
+
+    double seq = info[0].As<Napi::Number>().DoubleValue();
+    if (!(seq >= 1)) {
+        Napi::RangeError::New(env, "seq must be a claimed sequence number").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    Napi::Buffer<uint8_t> frame = info[1].As<Napi::Buffer<uint8_t>>();
+    uint32_t tag = info.Length() > 2 && info[2].IsNumber() ? info[2].As<Napi::Number>().Uint32Value() : 0;
+
+    OpScope scope(NativeOp::kEventBusPublish, frame.Length());
+    bool stored = ring_->Commit(static_cast<uint64_t>(seq), frame.Data(), frame.Length(), tag);
+    return Napi::Boolean::New(env, stored);
+}
+
+// publish(frame: Buffer, tag = 0) -> seq | null
+// Null when the frame was numbered but could not be stored (too large).
+Napi::Value EventBus::Publish(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsBuffer() || (info.Length() > 1 && !info[1].IsUndefined() && !info[1].IsNumber())) {
+        Napi::TypeError::New(env, "Expected (frame, tag?)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    if (!CheckOpen(env)) {
+        return env.Null();
+    }
+
+    Napi::Buffer<uint8_t> frame = info[0].As<Napi::Buffer<uint8_t>>();
+    uint32_t tag = info.Length() > 1 && info[1].IsNumber() ? info[1].As<Napi::Number>().Uint32Value() : 0;
+
+    OpScope scope(NativeOp::kEventBusPublish, frame.Length());
+    uint64_t seq = ring_->Claim();
+    if (!ring_->Commit(seq, frame.Data(), frame.Length(), tag)) {
+        return env.Null();
+    }
+    return Napi::Number::New(env, static_cast<double>(seq));
+}
+
+// read(cursor, { maxEvents = 256, maxBytes = 4 MiB }) ->
+//   { data: Buffer, ends: Uint32Array, seqs: Float64Array, tags: Uint32Array, next, lost }
+// Frame i is data[ends[i - 1] ?? 0, ends[i]); pass `next` as the following
+// cursor. `lost` counts events skipped because this reader fell a ring
+// behind or they were too large to store.
+Napi::Value EventBus::Read(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsNumber() || (info.Length() > 1 && !info[1].IsUndefined() && !info[1].IsObject())) {
+        Napi::TypeError::New(env, "Expected (cursor, { maxEvents?, maxBytes? })").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    if (!CheckOpen(env)) {
+        return env.Null();
+    }
+
+    double cursor = info[0].As<Napi::Number>().DoubleValue();
+    if (!(cursor >= 0)) {
+        Napi::RangeError::New(env, "cursor must be a sequence number").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    Napi::Object options = info.Length() > 1 && info[1].IsObject() ? info[1].As<Napi::Object>()
+                                                                    : Napi::Object::New(env);
+    size_t max_events = 0;
+    size_t max_bytes = 0;
+    if (!ReadSizeOption(env, options, "maxEvents", kDefaultReadEvents, &max_events) ||
+        !ReadSizeOption(env, options, "maxBytes", kDefaultReadBytes, &max_bytes)) {
+        return env.Null();
+    }
+
+    OpScope scope(NativeOp::kEventBusRead);
+    thread_local std::vector<uint8_t> data;
+    data.clear();
+    EventRing::ReadResult result = ring_->Read(static_cast<uint64_t>(cursor), max_events, max_bytes, &data);
+    scope.AddBytes(data.size());
+
+    size_t count = result.events.size();
+    Napi::Uint32Array ends = Napi::Uint32Array::New(env, count);
+    Napi::Float64Array seqs = Napi::Float64Array::New(env, count);
+    Napi::Uint32Array tags = Napi::Uint32Array::New(env, count);
+    for (size_t i = 0; i < count; i++) {
+        const EventRing::Event& event = result.events[i];
+        ends[i] = static_cast<uint32_t>(event.offset + event.length);
+        seqs[i] = static_cast<double>(event.seq);
+        tags[i] = event.tag;
+    }
+
+    Napi::Object out = Napi::Object::New(env);
+    out.Set("data", Napi::Buffer<uint8_t>::Copy(env, data.data(), data.size()));
+    out.Set("ends", ends);
+    out.Set("seqs", seqs);
+    out.Set("tags", tags);
+    out.Set("next", Napi::Number::New(env, static_cast<double>(result.next)));
+    out.Set("lost", Napi::Number::New(env, static_cast<double>(result.lost)));
+    return out;
+}
+
+Napi::Value EventBus::Close(const Napi::CallbackInfo& info) {
+    ring_.reset();
+    return info.Env().Undefined();
+}
+
+Napi::Value EventBus::Head(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), ring_ ? static_cast<double>(ring_->Head()) : 0);
+}
+
+Napi::Value EventBus::Slots(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), ring_ ? static_cast<double>(ring_->Slots()) : 0);
+}
+
+Napi::Value EventBus::DataBytes(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), ring_ ? static_cast<double>(ring_->DataBytes()) : 0);
+}
+
+Napi::Value EventBus::MaxFrame(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), ring_ ? static_cast<double>(ring_->MaxFrame()) : 0);
+}
+
+// Module initialization
+Napi::Object InitEventBus(Napi::Env env, Napi::Object exports) {
+    return EventBus::Init(env, exports);
+}
@@ -0,0 +1,332 @@
+#include "event-ring.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Same conventions as the embedding store: host byte order, lock-free
+// atomics living in the shared mapping.
+
+static constexpr size_t kHeaderBytes = 4096;
+static constexpr size_t kPageAlign = 4096;
+static constexpr size_t kSlotBytes = 32;
+static constexpr size_t kFrameAlign = 8;
+static constexpr size_t kMinSlots = 64;
+static constexpr size_t kMaxSlots = size_t{1} << 24;
+static constexpr size_t kMinDataBytes = size_t{1} << 16;
+static constexpr size_t kMaxDataBytes = size_t{1} << 32;
+static constexpr uint32_t kFormatVersion = 1;
+static constexpr char kMagic[8] = {'O', 'C', 'E', 'V', 'R', 'N', 'G', '\0'};
+// Slot length for an event committed without a frame
+static constexpr uint32_t kDropped = UINT32_MAX;
+// Yields a producer waits for an earlier lap's writer to leave its slot
+static constexpr size_t kSlotWaitYields = size_t{1} << 16;
+
+struct RingHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t slots;
+    uint64_t data_bytes;
+    // Producers hit both counters; keep them off each other's cache line
+    alignas(64) std::atomic<uint64_t> claimed;
+    alignas(64) std::atomic<uint64_t> data_head;
+};
+
+struct EventRing::Slot {
+    // 0 = never written, 2 * seq = committed, 2 * seq + 1 = being written
+    std::atomic<uint64_t> stamp;
+    // Position in the data ring, as an ever-increasing byte count
+    std::atomic<uint64_t> pos;
+    std::atomic<uint32_t> length;
+    std::atomic<uint32_t> tag;
+    uint64_t reserved;
+};
+
+static_assert(sizeof(RingHeader) <= kHeaderBytes, "header must fit its page");
+static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free,
+              "shared-memory atomics must be lock-free");
+
+[[noreturn]] static void ThrowIoError(const char* what, const std::string& path) {
+    throw std::runtime_error(std::string(what) + " " + path + ": " + std::strerror(errno));
+}
+
+namespace {
+
+// flock() held for the lifetime of the guard
+class FileLock {
+public:
+    FileLock(int fd, const std::string& path) : fd_(fd) {
+        while (::flock(fd_, LOCK_EX) != 0) {
+            if (errno != EINTR) {
+                ThrowIoError("lock", path);
+            }
+        }
+    }
+    ~FileLock() { ::flock(fd_, LOCK_UN); }
+
+    FileLock(const FileLock&) = delete;
+    FileLock& operator=(const FileLock&) = delete;
+
+private:
+    int fd_;
+};
+
+}  // namespace
+
+static size_t RoundUp(size_t value, size_t align) {
+    return (value + align - 1) / align * align;
+}
+
+static size_t PowerOfTwo(size_t value, size_t min, size_t max) {
+    size_t result = min;
+    while (result < std::min(value, max)) {
+        result <<= 1;
+    }
+    return result;
+}
+
+static size_t DataOffset(size_t slots) {
+    return RoundUp(kHeaderBytes + slots * kSlotBytes, kPageAlign);
+}
+
+EventRing::EventRing(const std::string& path, size_t slots, size_t data_bytes, bool reset) : path_(path) {
+    static_assert(sizeof(Slot) == kSlotBytes, "slot layout is part of the file format");
+
+    try {
+        // Unlink rather than truncate: a process still mapping the old file
+        // would fault on the truncated pages, while an unlinked file stays
+        // valid (and silent) until it is closed
+        if (reset && ::unlink(path.c_str()) != 0 && errno != ENOENT) {
+            ThrowIoError("unlink", path);
+        }
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+        if (fd_ < 0) {
+            ThrowIoError("open", path);
+        }
+
+        // Held while sizing and initializing so two processes creating the
+        // same file cannot both write a header
+        FileLock lock(fd_, path_);
+        struct stat st;
+        if (::fstat(fd_, &st) != 0) {
+            ThrowIoError("stat", path);
+        }
+
+        if (st.st_size == 0) {
+            slots_ = PowerOfTwo(slots, kMinSlots, kMaxSlots);
+            data_bytes_ = PowerOfTwo(data_bytes, kMinDataBytes, kMaxDataBytes);
+            data_offset_ = DataOffset(slots_);
+            size_t bytes = data_offset_ + data_bytes_;
+            // Sparse: pages are only allocated once written
+            if (::ftruncate(fd_, static_cast<off_t>(bytes)) != 0) {
+                ThrowIoError("resize", path);
+            }
+            Map(bytes);
+            RingHeader* header = reinterpret_cast<RingHeader*>(map_);
+            header->version = kFormatVersion;
+            header->slots = slots_;
+            header->data_bytes = data_bytes_;
+            // Magic last: a file without it was never fully created
+            std::memcpy(header->magic, kMagic, sizeof(kMagic));
+            return;
+        }
+
+        RingHeader header;
+        if (::pread(fd_, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+            std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kFormatVersion ||
+            header.slots < kMinSlots || header.slots > kMaxSlots || (header.slots & (header.slots - 1)) != 0 ||
+            header.data_bytes < kMinDataBytes || header.data_bytes > kMaxDataBytes ||
+            (header.data_bytes & (header.data_bytes - 1)) != 0) {
+            throw std::runtime_error("not an event ring: " + path);
+        }
+        slots_ = static_cast<size_t>(header.slots);
+        data_bytes_ = static_cast<size_t>(header.data_bytes);
+        data_offset_ = DataOffset(slots_);
+        size_t bytes = data_offset_ + data_bytes_;
+        if (static_cast<uint64_t>(st.st_size) < bytes) {
+            throw std::runtime_error("event ring is truncated: " + path);
+        }
+        Map(bytes);
+    } catch (...) {
+        Close();
+        throw;
+    }
+}
+
+EventRing::~EventRing() {
+    Close();
+}
+
+void EventRing::Close() {
+    if (map_ != nullptr) {
+        ::munmap(map_, map_bytes_);
+        map_ = nullptr;
+        map_bytes_ = 0;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+void EventRing::Map(size_t bytes) {
+    void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (p == MAP_FAILED) {
+        ThrowIoError("mmap", path_);
+    }
+    map_ = static_cast<uint8_t*>(p);
+    map_bytes_ = bytes;
+}
+
+EventRing::Slot* EventRing::SlotAt(uint64_t seq) const {
+    return reinterpret_cast<Slot*>(map_ + kHeaderBytes) + (seq & (slots_ - 1));
+}
+
+void EventRing::CopyOut(uint64_t pos, uint8_t* dst, size_t len) const {
+    const uint8_t* data = map_ + data_offset_;
+    size_t offset = static_cast<size_t>(pos & (data_bytes_ - 1));
+    size_t first = std::min(len, data_bytes_ - offset);
+    std::memcpy(dst, data + offset, first);
+    std::memcpy(dst + first, data, len - first);
+}
+
+void EventRing::CopyIn(uint64_t pos, const uint8_t* src, size_t len) {
+    uint8_t* data = map_ + data_offset_;
+    size_t offset = static_cast<size_t>(pos & (data_bytes_ - 1));
+    size_t first = std::min(len, data_bytes_ - offset);
+    std::memcpy(data + offset, src, first);
+    std::memcpy(data, src + first, len - first);
+}
+
+uint64_t EventRing::Head() const {
+    return reinterpret_cast<const RingHeader*>(map_)->claimed.load(std::memory_order_acquire);
+}
+
+uint64_t EventRing::Claim() {
+    return reinterpret_cast<RingHeader*>(map_)->claimed.fetch_add(1, std::memory_order_acq_rel) + 1;
+}
+
+bool EventRing::Commit(uint64_t seq, const uint8_t* data, size_t len, uint32_t tag) {
+    RingHeader* header = reinterpret_cast<RingHeader*>(map_);
+    // A full ring of later claims may already own this slot; readers have
+    // skipped the event by now
+    if (seq == 0 || Head() - seq >= slots_) {
+        return false;
+    }
+
+    // Take the slot from an earlier lap's committed stamp with a CAS: a
+    // producer that stalled after the check above must not overwrite the
+    // stamp of a later lap that claimed and committed meanwhile
+    Slot* slot = SlotAt(seq);
+    uint64_t stamp = slot->stamp.load(std::memory_order_relaxed);
+    for (size_t yields = 0;;) {
+        if (stamp >= 2 * seq) {
+            return false;
+        }
+        if ((stamp & 1) != 0) {
+            // An earlier lap is still writing; its fields would interleave
+            // with ours, so wait for it (one copy, unless it died)
+            if (yields++ == kSlotWaitYields) {
+                return false;
+            }
+            sched_yield();
+            stamp = slot->stamp.load(std::memory_order_relaxed);
+            continue;
+        }
+        if (slot->stamp.compare_exchange_weak(stamp, 2 * seq + 1, std::memory_order_relaxed)) {
+            break;
+        }
+    }
+
+    bool fits = len <= MaxFrame();
+    uint64_t pos = 0;
+    if (fits) {
+        pos = header->data_head.fetch_add(RoundUp(len, kFrameAlign), std::memory_order_relaxed);
+    }
+    // The odd stamp and the data reservation must be visible before any
+    // byte a reader could be copying is overwritten
+    std::atomic_thread_fence(std::memory_order_release);
+
+    if (fits) {
+        CopyIn(pos, data, len);
+    }
+    slot->pos.store(pos, std::memory_order_relaxed);
+    slot->length.store(fits ? static_cast<uint32_t>(len) : kDropped, std::memory_order_relaxed);
+    slot->tag.store(tag, std::memory_order_relaxed);
+    slot->stamp.store(2 * seq, std::memory_order_release);
+    return fits;
+}
+
+EventRing::ReadResult EventRing::Read(uint64_t cursor, size_t max_events, size_t max_bytes,
+                                      std::vector<uint8_t>* out) const {
+    const RingHeader* header = reinterpret_cast<const RingHeader*>(map_);
+    ReadResult result;
+    uint64_t seq = std::max<uint64_t>(cursor, 1);
+    size_t bytes = 0;
+
+    // Skips past events this reader can no longer get
+    auto lapped = [&]() {
+        uint64_t head = Head();
+        uint64_t oldest = head >= slots_ ? head - slots_ + 1 : 1;
+        if (seq < oldest) {
+            result.lost += oldest - seq;
+            seq = oldest;
+        } else {
+            result.lost++;
+            seq++;
+        }
+    };
+
+    while (result.events.size() < max_events && seq <= Head()) {
+        const Slot* slot = SlotAt(seq);
+        uint64_t stamp = slot->stamp.load(std::memory_order_acquire);
+        if (stamp > 2 * seq + 1) {
+            lapped();
+            continue;
+        }
+        if (stamp != 2 * seq) {
+            // Claimed but not committed yet
+            break;
+        }
+
+        uint64_t pos = slot->pos.load(std::memory_order_relaxed);
+        uint32_t length = slot->length.load(std::memory_order_relaxed);
+        uint32_t tag = slot->tag.load(std::memory_order_relaxed);
+        if (length == kDropped || length > MaxFrame()) {
+            result.lost++;
+            seq++;
+            continue;
+        }
+        if (!result.events.empty() && bytes + length > max_bytes) {
+            break;
+        }
+
+        size_t offset = out->size();
+        out->resize(offset + length);
+        CopyOut(pos, out->data() + offset, length);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot->stamp.load(std::memory_order_relaxed) != stamp ||
+            header->data_head.load(std::memory_order_relaxed) - pos > data_bytes_) {
+            out->resize(offset);
+            lapped();
+            continue;
+        }
+
+        result.events.push_back({seq, tag, offset, length});
+        bytes += length;
+        seq++;
+    }
+
+    result.next = seq;
+    return result;
+}
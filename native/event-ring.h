@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Ordered multi-producer, multi-consumer event ring in one memory-mapped
+// file, shared by every thread and process that opens the same path.
+// Every reader sees every event (broadcast, not a work queue) and keeps its
+// own cursor, so each worker can fan the stream out to the connections it
+// owns.
+//
+// Events are numbered from 1 by a shared counter; a producer claims the
+// next number, builds its frame (which may embed the number) and commits
+// it. Readers deliver in number order, so an event claimed but not yet
+// committed holds back the ones after it. Layout:
+//
+//   4 KiB header      magic, sizes, claim counter, data head
+//   slot table        slots x 32 bytes: stamp, data position, length, tag
+//   data              dataBytes ring of 8-byte aligned frames
+//
+// Nothing takes a lock. Claims and data reservations are fetch_adds; a
+// slot's stamp is 2 * seq once committed and odd while a producer fills
+// it, and a reader copies a frame between two reads of the stamp and
+// re-checks that the data head has not lapped the frame (a seqlock).
+// Readers that fall more than a ring behind skip ahead and count the
+// events they lost. Producers take a slot by CAS from an earlier lap's
+// committed stamp, so a late commit never clobbers a newer lap. A producer
+// that dies between claim and commit stalls readers at its event (and,
+// dying mid-commit, makes the next lap's commit for that slot give up);
+// producers are expected to be gateway code that always commits.
+//
+// I/O and format errors throw std::runtime_error.
+
+class EventRing {
+public:
+    struct Event {
+        uint64_t seq;
+        uint32_t tag;
+        // Bytes of this frame in the caller's buffer
+        size_t offset;
+        size_t length;
+    };
+
+    struct ReadResult {
+        std::vector<Event> events;
+        // Cursor to pass to the next Read
+        uint64_t next = 0;
+        // Events overwritten before this reader got to them, or committed
+        // too large for the ring
+        uint64_t lost = 0;
+    };
+
+    // Opens `path`, creating it when it does not exist (or when `reset`)
+    // with `slots` slots and `data_bytes` of frame space, both rounded up
+    // to a power of two. An existing file keeps its own sizes.
+    EventRing(const std::string& path, size_t slots, size_t data_bytes, bool reset);
+    ~EventRing();
+
+    EventRing(const EventRing&) = delete;
+    EventRing& operator=(const EventRing&) = delete;
+
+    uint64_t Claim();
+
+    // Publishes the frame for a claimed seq. False when it cannot be stored
+    // (longer than MaxFrame(), or claimed a full ring ago); readers then
+    // count it as lost instead of waiting for it.
+    bool Commit(uint64_t seq, const uint8_t* data, size_t len, uint32_t tag);
+
+    // Appends committed frames from `cursor` on to `out`, stopping at the
+    // first uncommitted event or after max_events / max_bytes (at least one
+    // event is returned when one is ready)
+    ReadResult Read(uint64_t cursor, size_t max_events, size_t max_bytes, std::vector<uint8_t>* out) const;
+
+    // Last claimed seq; 0 when nothing has been claimed
+    uint64_t Head() const;
+
+    size_t Slots() const { return slots_; }
+    size_t DataBytes() const { return data_bytes_; }
+    size_t MaxFrame() const { return data_bytes_ / 4; }
+
+    void Close();
+    bool IsOpen() const { return fd_ >= 0; }
+
+private:
+    struct Slot;
+
+    Slot* SlotAt(uint64_t seq) const;
+    void CopyOut(uint64_t pos, uint8_t* dst, size_t len) const;
+    void CopyIn(uint64_t pos, const uint8_t* src, size_t len);
+    void Map(size_t bytes);
+
+    std::string path_;
+    size_t slots_ = 0;
+    size_t data_bytes_ = 0;
+    size_t data_offset_ = 0;
+
+    int fd_ = -1;
+    uint8_t* map_ = nullptr;
+    size_t map_bytes_ = 0;
+};
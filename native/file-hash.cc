@@ -0,0 +1,320 @@
+#include "file-hash.h"
+#include "sha256.h"
+#include "thread-pool.h"
+#include "utf8.h"
+
+#include <cerrno>
+#include <cstring>
+#include <memory>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Files are read, not mapped: a note truncated by an editor mid-hash would
+// turn a mapping into SIGBUS, while read() just sees the shorter file.
+static constexpr size_t kReadChunkBytes = 256 * 1024;
+
+bool ParseFileHashAlgorithm(const std::string& name, FileHashAlgorithm* out) {
+    if (name == "sha256") {
+        *out = FileHashAlgorithm::kSha256;
+    } else if (name == "xxh64") {
+        *out = FileHashAlgorithm::kXxh64;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// XXH64
+// ---------------------------------------------------------------------------
+
+static constexpr uint64_t kPrime1 = 11400714785074694791ULL;
+static constexpr uint64_t kPrime2 = 14029467366897019727ULL;
+static constexpr uint64_t kPrime3 = 1609587929392839161ULL;
+static constexpr uint64_t kPrime4 = 9650029242287828579ULL;
+static constexpr uint64_t kPrime5 = 2870177450012600261ULL;
+
+static inline uint64_t Rotl64(uint64_t x, unsigned r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t Read64(const uint8_t* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;  // little-endian hosts only, like the rest of the addon
+}
+
+static inline uint32_t Read32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t XxhRound(uint64_t acc, uint64_t input) {
+    acc += input * kPrime2;
+    acc = Rotl64(acc, 31);
+    return acc * kPrime1;
+}
+
+static inline uint64_t XxhMerge(uint64_t acc, uint64_t val) {
+    acc ^= XxhRound(0, val);
+    return acc * kPrime1 + kPrime4;
+}
+
+Xxh64Hasher::Xxh64Hasher(uint64_t seed) : seed_(seed) {
+    lanes_[0] = seed + kPrime1 + kPrime2;
+    lanes_[1] = seed + kPrime2;
+    lanes_[2] = seed;
+    lanes_[3] = seed - kPrime1;
+}
+
+// Four independent lanes keep the multipliers busy
+static inline const uint8_t* XxhStripes(uint64_t lanes[4], const uint8_t* p, const uint8_t* end) {
+    uint64_t v1 = lanes[0], v2 = lanes[1], v3 = lanes[2], v4 = lanes[3];
+    for (; p + 32 <= end; p += 32) {
+        v1 = XxhRound(v1, Read64(p));
+        v2 = XxhRound(v2, Read64(p + 8));
+        v3 = XxhRound(v3, Read64(p + 16));
+        v4 = XxhRound(v4, Read64(p + 24));
+    }
+    lanes[0] = v1;
+    lanes[1] = v2;
+    lanes[2] = v3;
+    lanes[3] = v4;
+    return p;
+}
+
+void Xxh64Hasher::Update(const void* data, size_t len) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    const uint8_t* end = p + len;
+    total_ += len;
+
+    if (buffered_ + len < sizeof(stripe_)) {
+        if (len > 0) {
+            std::memcpy(stripe_ + buffered_, p, len);
+        }
+        buffered_ += len;
+        return;
+    }
+    if (buffered_ > 0) {
+        size_t take = sizeof(stripe_) - buffered_;
+        std::memcpy(stripe_ + buffered_, p, take);
+        XxhStripes(lanes_, stripe_, stripe_ + sizeof(stripe_));
+        p += take;
+        buffered_ = 0;
+    }
+    p = XxhStripes(lanes_, p, end);
+    buffered_ = static_cast<size_t>(end - p);
+    if (buffered_ > 0) {
+        std::memcpy(stripe_, p, buffered_);
+    }
+}
+
+uint64_t Xxh64Hasher::Digest() const {
+    uint64_t h;
+    if (total_ >= 32) {
+        h = Rotl64(lanes_[0], 1) + Rotl64(lanes_[1], 7) + Rotl64(lanes_[2], 12) + Rotl64(lanes_[3], 18);
+        for (uint64_t lane : lanes_) {
+            h = XxhMerge(h, lane);
+        }
+    } else {
+        h = seed_ + kPrime5;
+    }
+    h += total_;
+
+    const uint8_t* p = stripe_;
+    const uint8_t* end = stripe_ + buffered_;
+    for (; p + 8 <= end; p += 8) {
+        h ^= XxhRound(0, Read64(p));
+        h = Rotl64(h, 27) * kPrime1 + kPrime4;
+    }
+    if (p + 4 <= end) {
+        h ^= static_cast<uint64_t>(Read32(p)) * kPrime1;
+        h = Rotl64(h, 23) * kPrime2 + kPrime3;
+        p += 4;
+    }
+    for (; p < end; p++) {
+        h ^= (*p) * kPrime5;
+        h = Rotl64(h, 11) * kPrime1;
+    }
+
+    h ^= h >> 33;
+    h *= kPrime2;
+    h ^= h >> 29;
+    h *= kPrime3;
+    h ^= h >> 32;
+    return h;
+}
+
+uint64_t Xxh64(const void* data, size_t len, uint64_t seed) {
+    Xxh64Hasher hasher(seed);
+    hasher.Update(data, len);
+    return hasher.Digest();
+}
+
+// ---------------------------------------------------------------------------
+// Batch hashing
+// ---------------------------------------------------------------------------
+
+static std::string HexDigest(const uint8_t* bytes, size_t len) {
+    static const char kDigits[] = "0123456789abcdef";
+    std::string out(len * 2, '0');
+    for (size_t i = 0; i < len; i++) {
+        out[2 * i] = kDigits[bytes[i] >> 4];
+        out[2 * i + 1] = kDigits[bytes[i] & 0xf];
+    }
+    return out;
+}
+
+static std::string XxhHex(uint64_t h) {
+    uint8_t be[8];
+    for (int i = 0; i < 8; i++) {
+        be[i] = static_cast<uint8_t>(h >> (56 - 8 * i));
+    }
+    return HexDigest(be, sizeof(be));
+}
+
+// Same arithmetic as Node's fs.Stats#mtimeMs, so values round-trip exactly
+static double MtimeMs(const struct stat& st) {
+#if defined(__APPLE__)
+    const struct timespec& ts = st.st_mtimespec;
+#else
+    const struct timespec& ts = st.st_mtim;
+#endif
+    return static_cast<double>(ts.tv_sec) * 1e3 + static_cast<double>(ts.tv_nsec) / 1e6;
+}
+
+static void Fail(FileHashResult* result, const char* what, const std::string& path) {
+    result->changed = true;
+    result->error_code = errno;
+    result->error = std::string(what) + " " + path + ": " + std::strerror(errno);
+}
+
+// Bytes at the end of data[0, len) that start a sequence the next read may
+// complete. Everything before them decodes the same whatever follows.
+static size_t Utf8PendingTail(const uint8_t* data, size_t len) {
+    for (size_t k = 1; k <= 3 && k <= len; k++) {
+        uint8_t b = data[len - k];
+        if ((b & 0xc0) != 0x80) {
+            size_t need = b >= 0xf0 ? 4 : b >= 0xe0 ? 3 : b >= 0xc0 ? 2 : 1;
+            return need > k ? k : 0;
+        }
+    }
+    return 0;
+}
+
+// Hashes data[0, len) as Buffer.toString("utf8") decodes it, each ill-formed
+// sequence as the bytes of U+FFFD, so the digest equals hashText() of the
+// text. Unless `at_end`, a trailing incomplete sequence is left for the next
+// call; returns the bytes consumed.
+static size_t HashUtf8Text(Sha256* sha, const uint8_t* data, size_t len, bool at_end) {
+    static const uint8_t kReplacement[3] = {0xef, 0xbf, 0xbd};
+    size_t end = at_end ? len : len - Utf8PendingTail(data, len);
+    if (Utf8Validate(data, end)) {
+        sha->Update(data, end);
+        return end;
+    }
+    size_t run = 0;
+    size_t i = 0;
+    while (i < end) {
+        if (data[i] < 0x80) {
+            i++;
+            continue;
+        }
+        uint32_t cp;
+        size_t n = Utf8Decode(data + i, end - i, &cp);
+        // A well-formed U+FFFD is EF BF BD; any other decode to it is a replacement
+        if (cp == kUtf8Replacement && !(n == 3 && data[i] == 0xef)) {
+            sha->Update(data + run, i - run);
+            sha->Update(kReplacement, sizeof(kReplacement));
+            run = i + n;
+        }
+        i += n;
+    }
+    sha->Update(data + run, end - run);
+    return end;
+}
+
+// Streams the file through the hasher; false with errno set on failure
+static bool HashStream(int fd, FileHashAlgorithm algorithm, std::string* hex) {
+    // Room in front of each read for the bytes of a sequence split by the last
+    std::unique_ptr<uint8_t[]> buffer(new uint8_t[kReadChunkBytes + 3]);
+    size_t carried = 0;
+    Sha256 sha;
+    Xxh64Hasher xxh;
+    for (;;) {
+        ssize_t n = ::read(fd, buffer.get() + carried, kReadChunkBytes);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            return false;
+        }
+        if (n == 0) {
+            break;
+        }
+        if (algorithm == FileHashAlgorithm::kXxh64) {
+            xxh.Update(buffer.get(), static_cast<size_t>(n));
+        } else {
+            size_t len = carried + static_cast<size_t>(n);
+            size_t used = HashUtf8Text(&sha, buffer.get(), len, false);
+            carried = len - used;
+            std::memmove(buffer.get(), buffer.get() + used, carried);
+        }
+    }
+    if (algorithm == FileHashAlgorithm::kSha256) {
+        HashUtf8Text(&sha, buffer.get(), carried, true);
+    }
+
+    if (algorithm == FileHashAlgorithm::kXxh64) {
+        *hex = XxhHex(xxh.Digest());
+    } else {
+        uint8_t digest[kSha256DigestSize];
+        sha.Final(digest);
+        *hex = HexDigest(digest, sizeof(digest));
+    }
+    return true;
+}
+
+static void HashOne(const FileHashRequest& req, FileHashAlgorithm algorithm, FileHashResult* result) {
+    // stat before open so unchanged files cost one syscall
+    struct stat st;
+    if (::stat(req.path.c_str(), &st) != 0) {
+        Fail(result, "stat", req.path);
+        return;
+    }
+    result->size = static_cast<double>(st.st_size);
+    result->mtime_ms = MtimeMs(st);
+    if (req.has_known && req.known_size == result->size && req.known_mtime_ms == result->mtime_ms) {
+        result->hash = req.known_hash;
+        return;
+    }
+
+    int fd = ::open(req.path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        Fail(result, "open", req.path);
+        return;
+    }
+#if defined(POSIX_FADV_SEQUENTIAL)
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    if (!HashStream(fd, algorithm, &result->hash)) {
+        Fail(result, "read", req.path);
+        ::close(fd);
+        return;
+    }
+    ::close(fd);
+
+    result->changed = !req.has_known || result->hash != req.known_hash;
+}
+
+std::vector<FileHashResult> HashFiles(const std::vector<FileHashRequest>& requests,
+                                      FileHashAlgorithm algorithm) {
+    std::vector<FileHashResult> results(requests.size());
+    ThreadPool::Shared().ParallelFor(requests.size(), [&](size_t i) {
+        HashOne(requests[i], algorithm, &results[i]);
+    });
+    return results;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Batch file hashing for change detection (memory / session sync). N-API free.
+//
+// Files are stat'ed and hashed across the shared ThreadPool. A file whose
+// size and mtime match the caller's manifest entry is not read at all; one
+// that is read but hashes to the manifest's hash is reported as unchanged.
+
+enum class FileHashAlgorithm {
+    kSha256,  // hex digest; equals hashText() of the file decoded as UTF-8,
+              // with ill-formed sequences hashed as U+FFFD
+    kXxh64,   // hex digest (canonical big-endian), non-cryptographic
+};
+
+bool ParseFileHashAlgorithm(const std::string& name, FileHashAlgorithm* out);
+
+// Streaming XXH64; same digest as the one-shot Xxh64().
+class Xxh64Hasher {
+public:
+    explicit Xxh64Hasher(uint64_t seed = 0);
+
+    void Update(const void* data, size_t len);
+    uint64_t Digest() const;
+
+private:
+    uint64_t seed_;
+    uint64_t lanes_[4];
+    uint8_t stripe_[32];
+    size_t buffered_ = 0;
+    uint64_t total_ = 0;
+};
+
+// XXH64 of data[0, len).
+uint64_t Xxh64(const void* data, size_t len, uint64_t seed = 0);
+
+struct FileHashRequest {
+    std::string path;
+    // Manifest entry from the last sync; has_known = false hashes regardless
+    bool has_known = false;
+    double known_size = 0;
+    double known_mtime_ms = 0;
+    std::string known_hash;
+};
+
+struct FileHashResult {
+    bool changed = false;
+    // errno of the failed open/stat/read, with error naming the call
+    int error_code = 0;
+    std::string error;
+    double size = 0;
+    double mtime_ms = 0;
+    std::string hash;
+};
+
+// results[i] belongs to requests[i]. Never throws for per-file failures.
+std::vector<FileHashResult> HashFiles(const std::vector<FileHashRequest>& requests,
+                                      FileHashAlgorithm algorithm);
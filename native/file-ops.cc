@@ -0,0 +1,567 @@
+#include <napi.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "file-hash.h"
+#include "op-stats.h"
+#include "promise-worker.h"
+#include "sha256.h"
+#include "transcript-scanner.h"
+#include "utf8.h"
+#ifdef OPENCLAW_HAVE_ZSTD
+#include "transcript-archive.h"
+#endif
+
+// File system batch ops, exported as module-level functions.
+
+struct HashFilesRequest {
+    std::vector<FileHashRequest> files;
+    FileHashAlgorithm algorithm = FileHashAlgorithm::kSha256;
+};
+
+// Parses (paths, { algorithm?, manifest? }); throws and returns false on bad
+// input. manifest[i], when an object, is the { size, mtimeMs, hash } that
+// paths[i] had at the last sync.
+static bool ReadHashFilesRequest(const Napi::CallbackInfo& info, HashFilesRequest* req) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsArray()) {
+        Napi::TypeError::New(env, "Expected (paths, options?)").ThrowAsJavaScriptException();
+        return false;
+    }
+
+    Napi::Array paths = info[0].As<Napi::Array>();
+    Napi::Array manifest;
+    bool has_manifest = false;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Object options = info[1].As<Napi::Object>();
+
+        Napi::Value name = options.Get("algorithm");
+        if (!name.IsUndefined()) {
+            if (!name.IsString() || !ParseFileHashAlgorithm(name.As<Napi::String>().Utf8Value(), &req->algorithm)) {
+                Napi::TypeError::New(env, "algorithm must be 'sha256' or 'xxh64'").ThrowAsJavaScriptException();
+                return false;
+            }
+        }
+
+        Napi::Value known = options.Get("manifest");
+        if (!known.IsUndefined()) {
+            if (!known.IsArray() || known.As<Napi::Array>().Length() != paths.Length()) {
+                Napi::TypeError::New(env, "manifest must be an array parallel to paths").ThrowAsJavaScriptException();
+                return false;
+            }
+            manifest = known.As<Napi::Array>();
+            has_manifest = true;
+        }
+    }
+
+    req->files.resize(paths.Length());
+    for (uint32_t i = 0; i < paths.Length(); i++) {
+        Napi::Value path = paths.Get(i);
+        if (!path.IsString()) {
+            Napi::TypeError::New(env, "paths must be strings").ThrowAsJavaScriptException();
+            return false;
+        }
+        FileHashRequest& file = req->files[i];
+        file.path = path.As<Napi::String>().Utf8Value();
+
+        Napi::Value entry = has_manifest ? manifest.Get(i) : env.Undefined();
+        if (!entry.IsObject()) {
+            continue;
+        }
+        Napi::Object known = entry.As<Napi::Object>();
+        Napi::Value size = known.Get("size");
+        Napi::Value mtime = known.Get("mtimeMs");
+        Napi::Value hash = known.Get("hash");
+        if (size.IsNumber() && mtime.IsNumber() && hash.IsString()) {
+            file.has_known = true;
+            file.known_size = size.As<Napi::Number>().DoubleValue();
+            file.known_mtime_ms = mtime.As<Napi::Number>().DoubleValue();
+            file.known_hash = hash.As<Napi::String>().Utf8Value();
+        }
+    }
+    return true;
+}
+
+// Changed (or unreadable) files only, in input order:
+// [{ index, size, mtimeMs, hash }] or [{ index, error, errno }]
+static Napi::Array HashFilesResult(Napi::Env env, const std::vector<FileHashResult>& results) {
+    Napi::Array changed = Napi::Array::New(env);
+    uint32_t count = 0;
+    for (size_t i = 0; i < results.size(); i++) {
+        const FileHashResult& result = results[i];
+        if (!result.changed) {
+            continue;
+        }
+        Napi::Object entry = Napi::Object::New(env);
+        entry.Set("index", Napi::Number::New(env, static_cast<double>(i)));
+        if (result.error_code != 0) {
+            entry.Set("error", Napi::String::New(env, result.error));
+            entry.Set("errno", Napi::Number::New(env, result.error_code));
+        } else {
+            entry.Set("size", Napi::Number::New(env, result.size));
+            entry.Set("mtimeMs", Napi::Number::New(env, result.mtime_ms));
+            entry.Set("hash", Napi::String::New(env, result.hash));
+        }
+        changed.Set(count++, entry);
+    }
+    return changed;
+}
+
+Napi::Value FileHashFiles(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    HashFilesRequest req;
+    if (!ReadHashFilesRequest(info, &req)) {
+        return env.Null();
+    }
+
+    return HashFilesResult(env, HashFiles(req.files, req.algorithm));
+}
+
+class HashFilesWorker : public PromiseWorker {
+public:
+    HashFilesWorker(Napi::Env env, HashFilesRequest&& req)
+        : PromiseWorker(env, "openclaw:hashFiles"), req_(std::move(req)) {}
+
+    void Execute() override {
+        OpScope scope(NativeOp::kHashFiles);
+        results_ = HashFiles(req_.files, req_.algorithm);
+    }
+
+    Napi::Value Result(Napi::Env env) override {
+        return HashFilesResult(env, results_);
+    }
+
+private:
+    HashFilesRequest req_;
+    std::vector<FileHashResult> results_;
+};
+
+Napi::Value FileHashFilesAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    HashFilesRequest req;
+    if (!ReadHashFilesRequest(info, &req)) {
+        return env.Null();
+    }
+
+    return (new HashFilesWorker(env, std::move(req)))->Start();
+}
+
+struct ScanTranscriptRequest {
+    std::string path;
+    uint64_t from = 0;
+    std::string anchor;
+    TranscriptScanOptions options;
+};
+
+// Parses (path, { from?, anchor?, roles? }); throws and returns false on bad input
+static bool ReadScanTranscriptRequest(const Napi::CallbackInfo& info, ScanTranscriptRequest* req) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected (path, options?)").ThrowAsJavaScriptException();
+        return false;
+    }
+    req->path = info[0].As<Napi::String>().Utf8Value();
+    if (info.Length() < 2 || !info[1].IsObject()) {
+        return true;
+    }
+    Napi::Object options = info[1].As<Napi::Object>();
+
+    Napi::Value from = options.Get("from");
+    if (!from.IsUndefined()) {
+        double offset = from.IsNumber() ? from.As<Napi::Number>().DoubleValue() : -1;
+        bool integer = offset >= 0 && offset <= 9007199254740991.0 &&
+                       offset == static_cast<double>(static_cast<uint64_t>(offset));
+        if (!integer) {
+            Napi::TypeError::New(env, "from must be a non-negative integer").ThrowAsJavaScriptException();
+            return false;
+        }
+        req->from = static_cast<uint64_t>(offset);
+    }
+
+    Napi::Value anchor = options.Get("anchor");
+    if (!anchor.IsUndefined()) {
+        if (!anchor.IsString()) {
+            Napi::TypeError::New(env, "anchor must be a string").ThrowAsJavaScriptException();
+            return false;
+        }
+        req->anchor = anchor.As<Napi::String>().Utf8Value();
+    }
+
+    Napi::Value roles = options.Get("roles");
+    if (!roles.IsUndefined()) {
+        if (!roles.IsArray()) {
+            Napi::TypeError::New(env, "roles must be an array of strings").ThrowAsJavaScriptException();
+            return false;
+        }
+        Napi::Array list = roles.As<Napi::Array>();
+        for (uint32_t i = 0; i < list.Length(); i++) {
+            Napi::Value role = list.Get(i);
+            if (!role.IsString()) {
+                Napi::TypeError::New(env, "roles must be an array of strings").ThrowAsJavaScriptException();
+                return false;
+            }
+            req->options.roles.push_back(role.As<Napi::String>().Utf8Value());
+        }
+    }
+    return true;
+}
+
+// Columns, one row per message, so a long transcript costs a few strings per
+// row rather than an object each:
+// { starts, ends: Float64Array, roles, texts, timestamps, raw, offset, size, resumed, anchor }
+// texts[i] joins the text parts with "\n"; whitespace-collapsing consumers
+// get the same result as normalizing each part and joining with " ".
+// raw[i] is set only for rows the caller must JSON.parse itself.
+static Napi::Object ScanTranscriptResult(Napi::Env env, const TranscriptScanResult& result) {
+    size_t count = result.entries.size();
+    Napi::Float64Array starts = Napi::Float64Array::New(env, count);
+    Napi::Float64Array ends = Napi::Float64Array::New(env, count);
+    Napi::Array roles = Napi::Array::New(env, count);
+    Napi::Array texts = Napi::Array::New(env, count);
+    Napi::Array timestamps = Napi::Array::New(env, count);
+    Napi::Array raw = Napi::Array::New(env, count);
+
+    // Transcripts use a handful of roles; create each JS string once
+    std::vector<std::pair<const std::string*, Napi::String>> role_names;
+    std::string text;
+    for (size_t i = 0; i < count; i++) {
+        const TranscriptEntry& entry = result.entries[i];
+        uint32_t row = static_cast<uint32_t>(i);
+        starts[i] = static_cast<double>(entry.start);
+        ends[i] = static_cast<double>(entry.end);
+
+        auto role = std::find_if(role_names.begin(), role_names.end(),
+                                 [&](const auto& known) { return *known.first == entry.role; });
+        if (role == role_names.end()) {
+            role_names.emplace_back(&entry.role, Napi::String::New(env, entry.role));
+            role = role_names.end() - 1;
+        }
+        roles.Set(row, role->second);
+
+        text.clear();
+        for (size_t j = 0; j < entry.texts.size(); j++) {
+            if (j > 0) {
+                text.push_back('\n');
+            }
+            text += entry.texts[j];
+        }
+        texts.Set(row, Napi::String::New(env, text));
+
+        if (entry.timestamp_kind == TranscriptEntry::Timestamp::kString) {
+            timestamps.Set(row, Napi::String::New(env, entry.timestamp));
+        } else if (entry.timestamp_kind == TranscriptEntry::Timestamp::kNumber) {
+            timestamps.Set(row, Napi::Number::New(env, std::strtod(entry.timestamp.c_str(), nullptr)));
+        }
+        if (entry.needs_reparse) {
+            raw.Set(row, Napi::String::New(env, entry.raw));
+        }
+    }
+
+    Napi::Object out = Napi::Object::New(env);
+    out.Set("starts", starts);
+    out.Set("ends", ends);
+    out.Set("roles", roles);
+    out.Set("texts", texts);
+    out.Set("timestamps", timestamps);
+    out.Set("raw", raw);
+    out.Set("offset", Napi::Number::New(env, static_cast<double>(result.offset)));
+    out.Set("size", Napi::Number::New(env, static_cast<double>(result.size)));
+    out.Set("resumed", Napi::Boolean::New(env, result.resumed));
+    out.Set("anchor", Napi::String::New(env, result.anchor));
+    return out;
+}
+
+Napi::Value FileScanTranscript(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    ScanTranscriptRequest req;
+    if (!ReadScanTranscriptRequest(info, &req)) {
+        return env.Null();
+    }
+
+    TranscriptScanResult result = ScanTranscriptFile(req.path, req.from, req.anchor, req.options);
+    if (!result.error.empty()) {
+        Napi::Error::New(env, result.error).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    return ScanTranscriptResult(env, result);
+}
+
+class ScanTranscriptWorker : public PromiseWorker {
+public:
+    ScanTranscriptWorker(Napi::Env env, ScanTranscriptRequest&& req)
+        : PromiseWorker(env, "openclaw:scanTranscript"), req_(std::move(req)) {}
+
+    void Execute() override {
+        OpScope scope(NativeOp::kScanTranscript);
+        result_ = ScanTranscriptFile(req_.path, req_.from, req_.anchor, req_.options);
+        if (!result_.error.empty()) {
+            SetError(result_.error);
+        }
+    }
+
+    Napi::Value Result(Napi::Env env) override {
+        return ScanTranscriptResult(env, result_);
+    }
+
+private:
+    ScanTranscriptRequest req_;
+    TranscriptScanResult result_;
+};
+
+Napi::Value FileScanTranscriptAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    ScanTranscriptRequest req;
+    if (!ReadScanTranscriptRequest(info, &req)) {
+        return env.Null();
+    }
+
+    return (new ScanTranscriptWorker(env, std::move(req)))->Start();
+}
+
+#ifdef OPENCLAW_HAVE_ZSTD
+
+// Whole-number option in [min, max]; throws and returns false otherwise.
+// Leaves *out alone when the option is undefined.
+static bool ReadIntegerOption(Napi::Env env, Napi::Object options, const char* name, double min, double max,
+                              double* out) {
+    Napi::Value value = options.Get(name);
+    if (value.IsUndefined()) {
+        return true;
+    }
+    double number = value.IsNumber() ? value.As<Napi::Number>().DoubleValue() : NAN;
+    if (!(number >= min && number <= max) || number != static_cast<double>(static_cast<int64_t>(number))) {
+        Napi::TypeError::New(env, std::string(name) + " must be an integer from " +
+                                      std::to_string(static_cast<int64_t>(min)) + " to " +
+                                      std::to_string(static_cast<int64_t>(max)))
+            .ThrowAsJavaScriptException();
+        return false;
+    }
+    *out = number;
+    return true;
+}
+
+struct PackTranscriptRequest {
+    std::string source;
+    std::string dest;
+    TranscriptArchiveOptions options;
+};
+
+// Parses (source, dest, { blockSize?, level?, append? }); throws and returns
+// false on bad input
+static bool ReadPackTranscriptRequest(const Napi::CallbackInfo& info, PackTranscriptRequest* req) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsString() || !info[1].IsString() ||
+        (info.Length() >= 3 && !info[2].IsObject())) {
+        Napi::TypeError::New(env, "Expected (source, dest, { blockSize?, level?, append? })")
+            .ThrowAsJavaScriptException();
+        return false;
+    }
+    req->source = info[0].As<Napi::String>().Utf8Value();
+    req->dest = info[1].As<Napi::String>().Utf8Value();
+    if (info.Length() < 3) {
+        return true;
+    }
+
+    Napi::Object options = info[2].As<Napi::Object>();
+    double block_size = static_cast<double>(req->options.block_size);
+    double level = req->options.level;
+    if (!ReadIntegerOption(env, options, "blockSize", 4096, 16 * 1024 * 1024, &block_size) ||
+        !ReadIntegerOption(env, options, "level", 1, ZSTD_maxCLevel(), &level)) {
+        return false;
+    }
+    req->options.block_size = static_cast<size_t>(block_size);
+    req->options.level = static_cast<int>(level);
+    req->options.append = options.Get("append").ToBoolean().As<Napi::Boolean>().Value();
+    return true;
+}
+
+static Napi::Object PackTranscriptResult(Napi::Env env, const TranscriptPackResult& result) {
+    Napi::Object out = Napi::Object::New(env);
+    out.Set("lines", Napi::Number::New(env, static_cast<double>(result.lines)));
+    out.Set("messages", Napi::Number::New(env, static_cast<double>(result.messages)));
+    out.Set("blocks", Napi::Number::New(env, static_cast<double>(result.blocks)));
+    out.Set("bytes", Napi::Number::New(env, static_cast<double>(result.bytes)));
+    return out;
+}
+
+// packTranscript(source, dest, options?): { lines, messages, blocks, bytes }
+// for the whole archive at dest
+Napi::Value FilePackTranscript(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    PackTranscriptRequest req;
+    if (!ReadPackTranscriptRequest(info, &req)) {
+        return env.Null();
+    }
+
+    TranscriptPackResult result = PackTranscript(req.source, req.dest, req.options);
+    if (!result.error.empty()) {
+        Napi::Error::New(env, result.error).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    return PackTranscriptResult(env, result);
+}
+
+class PackTranscriptWorker : public PromiseWorker {
+public:
+    PackTranscriptWorker(Napi::Env env, PackTranscriptRequest&& req)
+        : PromiseWorker(env, "openclaw:packTranscript"), req_(std::move(req)) {}
+
+    void Execute() override {
+        result_ = PackTranscript(req_.source, req_.dest, req_.options);
+        if (!result_.error.empty()) {
+            SetError(result_.error);
+        }
+    }
+
+    Napi::Value Result(Napi::Env env) override {
+        return PackTranscriptResult(env, result_);
+    }
+
+private:
+    PackTranscriptRequest req_;
+    TranscriptPackResult result_;
+};
+
+Napi::Value FilePackTranscriptAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    PackTranscriptRequest req;
+    if (!ReadPackTranscriptRequest(info, &req)) {
+        return env.Null();
+    }
+
+    return (new PackTranscriptWorker(env, std::move(req)))->Start();
+}
+
+struct ReadArchiveRequest {
+    std::string path;
+    TranscriptQuery query;
+};
+
+// Parses (path, { lastMessages?, afterLine?, afterMs?, limit? }); throws and
+// returns false on bad input
+static bool ReadArchiveQuery(const Napi::CallbackInfo& info, ReadArchiveRequest* req) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString() || (info.Length() >= 2 && !info[1].IsObject())) {
+        Napi::TypeError::New(env, "Expected (path, { lastMessages?, afterLine?, afterMs?, limit? })")
+            .ThrowAsJavaScriptException();
+        return false;
+    }
+    req->path = info[0].As<Napi::String>().Utf8Value();
+    if (info.Length() < 2) {
+        return true;
+    }
+
+    Napi::Object options = info[1].As<Napi::Object>();
+    double last_messages = 0;
+    double after_line = -1;
+    double after_ms = static_cast<double>(kNoTimestamp);
+    double limit = 0;
+    if (!ReadIntegerOption(env, options, "lastMessages", 1, 4294967295.0, &last_messages) ||
+        !ReadIntegerOption(env, options, "afterLine", -1, 9007199254740991.0, &after_line) ||
+        !ReadIntegerOption(env, options, "afterMs", -9007199254740991.0, 9007199254740991.0, &after_ms) ||
+        !ReadIntegerOption(env, options, "limit", 1, 9007199254740991.0, &limit)) {
+        return false;
+    }
+    req->query.last_messages = static_cast<uint32_t>(last_messages);
+    req->query.after_line = static_cast<int64_t>(after_line);
+    req->query.after_ms = static_cast<int64_t>(after_ms);
+    req->query.limit = static_cast<uint64_t>(limit);
+    return true;
+}
+
+// { lines: string[], firstLine, totalLines, totalMessages, blocksRead }
+static Napi::Object ReadArchiveResult(Napi::Env env, const TranscriptSlice& slice) {
+    Napi::Array lines = Napi::Array::New(env, slice.lines.size());
+    for (size_t i = 0; i < slice.lines.size(); i++) {
+        lines.Set(static_cast<uint32_t>(i), Napi::String::New(env, slice.lines[i]));
+    }
+    Napi::Object out = Napi::Object::New(env);
+    out.Set("lines", lines);
+    out.Set("firstLine", Napi::Number::New(env, static_cast<double>(slice.first_line)));
+    out.Set("totalLines", Napi::Number::New(env, static_cast<double>(slice.total_lines)));
+    out.Set("totalMessages", Napi::Number::New(env, static_cast<double>(slice.total_messages)));
+    out.Set("blocksRead", Napi::Number::New(env, static_cast<double>(slice.blocks_read)));
+    return out;
+}
+
+// readTranscriptArchive(path, query?): lines of the blocks the query needs
+Napi::Value FileReadTranscriptArchive(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    ReadArchiveRequest req;
+    if (!ReadArchiveQuery(info, &req)) {
+        return env.Null();
+    }
+
+    TranscriptSlice slice = QueryTranscriptArchive(req.path, req.query);
+    if (!slice.error.empty()) {
+        Napi::Error::New(env, slice.error).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    return ReadArchiveResult(env, slice);
+}
+
+class ReadArchiveWorker : public PromiseWorker {
+public:
+    ReadArchiveWorker(Napi::Env env, ReadArchiveRequest&& req)
+        : PromiseWorker(env, "openclaw:readTranscriptArchive"), req_(std::move(req)) {}
+
+    void Execute() override {
+        slice_ = QueryTranscriptArchive(req_.path, req_.query);
+        if (!slice_.error.empty()) {
+            SetError(slice_.error);
+        }
+    }
+
+    Napi::Value Result(Napi::Env env) override {
+        return ReadArchiveResult(env, slice_);
+    }
+
+private:
+    ReadArchiveRequest req_;
+    TranscriptSlice slice_;
+};
+
+Napi::Value FileReadTranscriptArchiveAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    ReadArchiveRequest req;
+    if (!ReadArchiveQuery(info, &req)) {
+        return env.Null();
+    }
+
+    return (new ReadArchiveWorker(env, std::move(req)))->Start();
+}
+
+#endif  // OPENCLAW_HAVE_ZSTD
+
+Napi::Object InitFileOps(Napi::Env env, Napi::Object exports) {
+    InitSha256();
+    InitUtf8();
+    InitTranscriptScanner();
+
+    exports.Set("hashFiles", Napi::Function::New<FileHashFiles>(env, "hashFiles"));
+    exports.Set("hashFilesAsync", Napi::Function::New<FileHashFilesAsync>(env, "hashFilesAsync"));
+    exports.Set("scanTranscript", Napi::Function::New<FileScanTranscript>(env, "scanTranscript"));
+    exports.Set("scanTranscriptAsync", Napi::Function::New<FileScanTranscriptAsync>(env, "scanTranscriptAsync"));
+#ifdef OPENCLAW_HAVE_ZSTD
+    exports.Set("packTranscript", Napi::Function::New<FilePackTranscript>(env, "packTranscript"));
+    exports.Set("packTranscriptAsync", Napi::Function::New<FilePackTranscriptAsync>(env, "packTranscriptAsync"));
+    exports.Set("readTranscriptArchive", Napi::Function::New<FileReadTranscriptArchive>(env, "readTranscriptArchive"));
+    exports.Set("readTranscriptArchiveAsync",
+                Napi::Function::New<FileReadTranscriptArchiveAsync>(env, "readTranscriptArchiveAsync"));
+#endif
+    return exports;
+}
@@ -0,0 +1,243 @@
+#include <napi.h>
+#include <cmath>
+#include <memory>
+#include <string>
+#include "history-store.h"
+
+// Per-group chat histories in native memory (see history-store.h).
+class GroupHistory : public Napi::ObjectWrap<GroupHistory> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    GroupHistory(const Napi::CallbackInfo& info);
+
+private:
+    static Napi::FunctionReference constructor;
+
+    Napi::Value Add(const Napi::CallbackInfo& info);
+
+    // Entries as { timestamp, content } objects, like the JS fallback
+    Napi::Value Get(const Napi::CallbackInfo& info);
+
+    // Entries as one Buffer holding a copy of the group's bytes, no
+    // per-entry strings
+    Napi::Value GetRange(const Napi::CallbackInfo& info);
+
+    Napi::Value ClearGroup(const Napi::CallbackInfo& info);
+    Napi::Value Clear(const Napi::CallbackInfo& info);
+    Napi::Value Len(const Napi::CallbackInfo& info);
+    Napi::Value Stats(const Napi::CallbackInfo& info);
+
+    Napi::Value MaxEntriesPerGroup(const Napi::CallbackInfo& info);
+    Napi::Value MaxBytes(const Napi::CallbackInfo& info);
+
+    std::unique_ptr<HistoryStore> store_;
+    HistoryRange range_;
+};
+
+Napi::FunctionReference GroupHistory::constructor;
+
+Napi::Object GroupHistory::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "GroupHistory", {
+        InstanceMethod("add", &GroupHistory::Add),
+        InstanceMethod("get", &GroupHistory::Get),
+        InstanceMethod("getRange", &GroupHistory::GetRange),
+        InstanceMethod("clearGroup", &GroupHistory::ClearGroup),
+        InstanceMethod("clear", &GroupHistory::Clear),
+        InstanceMethod("len", &GroupHistory::Len),
+        InstanceMethod("stats", &GroupHistory::Stats),
+        InstanceAccessor("maxEntriesPerGroup", &GroupHistory::MaxEntriesPerGroup, nullptr),
+        InstanceAccessor("maxBytes", &GroupHistory::MaxBytes, nullptr),
+    });
+
+    constructor = Napi::Persistent(func);
+    constructor.SuppressDestruct();
+
+    exports.Set("GroupHistory", func);
+    return exports;
+}
+
+namespace {
+
+bool IsIntegerIn(const Napi::Value& value, double min, double max) {
+    if (!value.IsNumber()) {
+        return false;
+    }
+    double d = value.As<Napi::Number>().DoubleValue();
+    return d >= min && d <= max && std::floor(d) == d;
+}
+
+}  // namespace
+
+// new GroupHistory({ maxEntriesPerGroup, maxBytes? })
+GroupHistory::GroupHistory(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<GroupHistory>(info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Expected ({ maxEntriesPerGroup, maxBytes? })").ThrowAsJavaScriptException();
+        return;
+    }
+    Napi::Object options = info[0].As<Napi::Object>();
+
+    HistoryStoreParams params;
+    Napi::Value max_entries = options.Get("maxEntriesPerGroup");
+    if (!IsIntegerIn(max_entries, 1, 1 << 24)) {
+        Napi::TypeError::New(env, "maxEntriesPerGroup must be an integer between 1 and 2^24")
+            .ThrowAsJavaScriptException();
+        return;
+    }
+    params.max_entries_per_group = max_entries.As<Napi::Number>().Uint32Value();
+
+    Napi::Value max_bytes = options.Get("maxBytes");
+    if (!max_bytes.IsUndefined()) {
+        if (!IsIntegerIn(max_bytes, 1, 9007199254740992.0)) {
+            Napi::TypeError::New(env, "maxBytes must be a positive integer").ThrowAsJavaScriptException();
+            return;
+        }
+        params.max_bytes = static_cast<size_t>(max_bytes.As<Napi::Number>().DoubleValue());
+    }
+
+    store_ = std::make_unique<HistoryStore>(params);
+}
+
+// add(groupId, { timestamp, content }): false when the content alone is
+// larger than maxBytes
+Napi::Value GroupHistory::Add(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsString() || !info[1].IsObject()) {
+        Napi::TypeError::New(env, "Expected (groupId, { timestamp, content })").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    Napi::Object entry = info[1].As<Napi::Object>();
+    Napi::Value timestamp = entry.Get("timestamp");
+    Napi::Value content = entry.Get("content");
+    if (!timestamp.IsNumber() || std::isnan(timestamp.As<Napi::Number>().DoubleValue()) || !content.IsString()) {
+        Napi::TypeError::New(env, "entry must be { timestamp: number, content: string }")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    std::string group = info[0].As<Napi::String>().Utf8Value();
+    std::string text = content.As<Napi::String>().Utf8Value();
+    bool added = store_->Add(group, timestamp.As<Napi::Number>().DoubleValue(), text.data(), text.size());
+    return Napi::Boolean::New(env, added);
+}
+
+Napi::Value GroupHistory::Get(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected (groupId)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    std::string group = info[0].As<Napi::String>().Utf8Value();
+    if (!store_->Range(group, -INFINITY, &range_)) {
+        return Napi::Array::New(env, 0);
+    }
+
+    const char* base = reinterpret_cast<const char*>(range_.arena->data.get() + range_.begin);
+    size_t count = range_.timestamps.size();
+    Napi::Array result = Napi::Array::New(env, count);
+    for (size_t i = 0; i < count; i++) {
+        Napi::Object entry = Napi::Object::New(env);
+        entry.Set("timestamp", Napi::Number::New(env, range_.timestamps[i]));
+        entry.Set("content", Napi::String::New(env, base + range_.offsets[i], range_.lengths[i]));
+        result.Set(static_cast<uint32_t>(i), entry);
+    }
+    range_.arena.reset();
+    return result;
+}
+
+// getRange(groupId, fromTs?): entries with timestamp >= fromTs, oldest first,
+// as { timestamps: Float64Array, offsets: Uint32Array, lengths: Uint32Array,
+// data: Buffer }; entry i is data[offsets[i], offsets[i] + lengths[i]).
+// data is the caller's own copy of the entries' bytes. null for an unknown
+// group.
+Napi::Value GroupHistory::GetRange(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString() || (info.Length() > 1 && !info[1].IsUndefined() && !info[1].IsNumber())) {
+        Napi::TypeError::New(env, "Expected (groupId, fromTs?)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    std::string group = info[0].As<Napi::String>().Utf8Value();
+    double from_ts = info.Length() > 1 && info[1].IsNumber() ? info[1].As<Napi::Number>().DoubleValue() : -INFINITY;
+    if (std::isnan(from_ts)) {
+        Napi::TypeError::New(env, "fromTs must not be NaN").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    if (!store_->Range(group, from_ts, &range_)) {
+        return env.Null();
+    }
+
+    size_t count = range_.timestamps.size();
+    Napi::Float64Array timestamps = Napi::Float64Array::New(env, count);
+    Napi::Uint32Array offsets = Napi::Uint32Array::New(env, count);
+    Napi::Uint32Array lengths = Napi::Uint32Array::New(env, count);
+    for (size_t i = 0; i < count; i++) {
+        timestamps[i] = range_.timestamps[i];
+        offsets[i] = range_.offsets[i];
+        lengths[i] = range_.lengths[i];
+    }
+
+    // Copied: a Buffer over the arena would be writable from JS
+    size_t span = range_.end - range_.begin;
+    Napi::Buffer<uint8_t> data = span == 0 ? Napi::Buffer<uint8_t>::New(env, 0)
+                                           : Napi::Buffer<uint8_t>::Copy(env, range_.arena->data.get() + range_.begin, span);
+    range_.arena.reset();
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("timestamps", timestamps);
+    result.Set("offsets", offsets);
+    result.Set("lengths", lengths);
+    result.Set("data", data);
+    return result;
+}
+
+Napi::Value GroupHistory::ClearGroup(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected (groupId)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    return Napi::Boolean::New(env, store_->ClearGroup(info[0].As<Napi::String>().Utf8Value()));
+}
+
+Napi::Value GroupHistory::Clear(const Napi::CallbackInfo& info) {
+    store_->Clear();
+    return info.Env().Undefined();
+}
+
+// Number of groups, like the JS fallback's Map size
+Napi::Value GroupHistory::Len(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), static_cast<double>(store_->Groups()));
+}
+
+Napi::Value GroupHistory::Stats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    HistoryStoreStats s = store_->Stats();
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("groups", Napi::Number::New(env, static_cast<double>(s.groups)));
+    result.Set("entries", Napi::Number::New(env, static_cast<double>(s.entries)));
+    result.Set("bytes", Napi::Number::New(env, static_cast<double>(s.content_bytes)));
+    result.Set("bytesResident", Napi::Number::New(env, static_cast<double>(s.resident_bytes)));
+    result.Set("evictedGroups", Napi::Number::New(env, static_cast<double>(s.evicted_groups)));
+    result.Set("compactions", Napi::Number::New(env, static_cast<double>(s.compactions)));
+    return result;
+}
+
+Napi::Value GroupHistory::MaxEntriesPerGroup(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), store_->Params().max_entries_per_group);
+}
+
+Napi::Value GroupHistory::MaxBytes(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), static_cast<double>(store_->Params().max_bytes));
+}
+
+// Module initialization
+Napi::Object InitGroupHistory(Napi::Env env, Napi::Object exports) {
+    return GroupHistory::Init(env, exports);
+}
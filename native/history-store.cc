@@ -0,0 +1,186 @@
+#include "history-store.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// Smallest arena a group gets; most chat messages fit several times over
+constexpr size_t kMinArenaBytes = 256;
+// Map node, list node, key and bookkeeping, roughly
+constexpr size_t kGroupOverheadBytes = 128;
+
+}  // namespace
+
+HistoryStore::HistoryStore(const HistoryStoreParams& params) : params_(params) {
+    params_.max_entries_per_group = std::max<uint32_t>(params_.max_entries_per_group, 1);
+    params_.max_bytes = std::max<size_t>(params_.max_bytes, 1);
+}
+
+bool HistoryStore::Add(const std::string& group, double timestamp, const char* content, size_t len) {
+    if (len > params_.max_bytes || len > UINT32_MAX / 2) {
+        return false;
+    }
+
+    auto found = groups_.find(group);
+    if (found == groups_.end()) {
+        lru_.emplace_front();
+        lru_.front().key = group;
+        found = groups_.emplace(group, lru_.begin()).first;
+    } else if (found->second != lru_.begin()) {
+        lru_.splice(lru_.begin(), lru_, found->second);
+    }
+    Group& g = *found->second;
+
+    // Drop the oldest entry first so compaction below does not copy it
+    if (g.count == params_.max_entries_per_group) {
+        const Slot& oldest = g.slots[g.head];
+        g.content_bytes -= oldest.length;
+        content_bytes_ -= oldest.length;
+        g.head = (g.head + 1) % static_cast<uint32_t>(g.slots.size());
+        g.count--;
+        entries_--;
+    }
+
+    if (!g.arena || g.arena->used + len > g.arena->capacity) {
+        Compact(g, len);
+    }
+
+    HistoryArena& arena = *g.arena;
+    if (len > 0) {
+        std::memcpy(arena.data.get() + arena.used, content, len);
+    }
+    Slot slot{timestamp, static_cast<uint32_t>(arena.used), static_cast<uint32_t>(len)};
+    arena.used += len;
+
+    if (g.count < g.slots.size()) {
+        g.slots[(g.head + g.count) % g.slots.size()] = slot;
+    } else {
+        g.slots.push_back(slot);
+    }
+    g.count++;
+    g.content_bytes += len;
+    content_bytes_ += len;
+    entries_++;
+    UpdateResident(g);
+
+    while (resident_bytes_ > params_.max_bytes && lru_.size() > 1) {
+        Evict(std::prev(lru_.end()));
+    }
+    return true;
+}
+
+// Copies the live entries, oldest first, into an arena with room for
+// `extra` more bytes, and lays the ring out flat (head 0).
+void HistoryStore::Compact(Group& g, size_t extra) {
+    size_t need = g.content_bytes + extra;
+    auto arena = std::make_shared<HistoryArena>();
+    arena->capacity = std::max(kMinArenaBytes, need * 2);
+    arena->data.reset(new uint8_t[arena->capacity]);
+
+    std::vector<Slot> slots;
+    slots.reserve(std::min<size_t>(size_t(g.count) + 1, params_.max_entries_per_group));
+    for (uint32_t i = 0; i < g.count; i++) {
+        Slot slot = SlotAt(g, i);
+        std::memcpy(arena->data.get() + arena->used, g.arena->data.get() + slot.offset, slot.length);
+        slot.offset = static_cast<uint32_t>(arena->used);
+        arena->used += slot.length;
+        slots.push_back(slot);
+    }
+    if (g.arena) {
+        compactions_++;
+    }
+
+    g.slots = std::move(slots);
+    g.head = 0;
+    g.arena = std::move(arena);
+}
+
+void HistoryStore::UpdateResident(Group& g) {
+    size_t resident = kGroupOverheadBytes + g.key.size() * 2 + g.slots.capacity() * sizeof(Slot) +
+                      (g.arena ? g.arena->capacity : 0);
+    resident_bytes_ = resident_bytes_ - g.resident + resident;
+    g.resident = resident;
+}
+
+void HistoryStore::Evict(GroupList::iterator it) {
+    entries_ -= it->count;
+    content_bytes_ -= it->content_bytes;
+    resident_bytes_ -= it->resident;
+    evicted_groups_++;
+    groups_.erase(it->key);
+    lru_.erase(it);
+}
+
+bool HistoryStore::Range(const std::string& group, double from_ts, HistoryRange* out) {
+    auto found = groups_.find(group);
+    if (found == groups_.end()) {
+        return false;
+    }
+    if (found->second != lru_.begin()) {
+        lru_.splice(lru_.begin(), lru_, found->second);
+    }
+    const Group& g = *found->second;
+
+    out->timestamps.clear();
+    out->offsets.clear();
+    out->lengths.clear();
+    out->arena = g.arena;
+    out->begin = 0;
+    out->end = 0;
+
+    uint32_t first = 0;
+    while (first < g.count && SlotAt(g, first).timestamp < from_ts) {
+        first++;
+    }
+    if (first == g.count) {
+        return true;
+    }
+
+    // Live entries sit in the arena oldest first, so the range is one span
+    out->begin = SlotAt(g, first).offset;
+    out->end = g.arena->used;
+    for (uint32_t i = first; i < g.count; i++) {
+        const Slot& slot = SlotAt(g, i);
+        if (slot.timestamp < from_ts) {
+            continue;
+        }
+        out->timestamps.push_back(slot.timestamp);
+        out->offsets.push_back(static_cast<uint32_t>(slot.offset - out->begin));
+        out->lengths.push_back(slot.length);
+    }
+    return true;
+}
+
+bool HistoryStore::ClearGroup(const std::string& group) {
+    auto found = groups_.find(group);
+    if (found == groups_.end()) {
+        return false;
+    }
+    GroupList::iterator it = found->second;
+    entries_ -= it->count;
+    content_bytes_ -= it->content_bytes;
+    resident_bytes_ -= it->resident;
+    groups_.erase(found);
+    lru_.erase(it);
+    return true;
+}
+
+void HistoryStore::Clear() {
+    groups_.clear();
+    lru_.clear();
+    entries_ = 0;
+    content_bytes_ = 0;
+    resident_bytes_ = 0;
+}
+
+HistoryStoreStats HistoryStore::Stats() const {
+    HistoryStoreStats stats;
+    stats.groups = groups_.size();
+    stats.entries = entries_;
+    stats.content_bytes = content_bytes_;
+    stats.resident_bytes = resident_bytes_;
+    stats.evicted_groups = evicted_groups_;
+    stats.compactions = compactions_;
+    return stats;
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Bounded per-group message histories, kept off the JS heap. N-API free.
+//
+// Each group keeps its last max_entries_per_group entries in a fixed ring
+// of (timestamp, offset, length) slots, with the UTF-8 content appended to
+// one arena per group. Adding to a full group overwrites the oldest slot
+// in O(1); the arena is compacted (live entries copied, oldest first, into
+// a fresh arena) only once its tail is full, so compaction is amortized
+// over at least as many bytes as it copies.
+//
+// Arena bytes below `used` are never rewritten: compaction allocates a new
+// arena, and readers holding the old one (Range()) keep it alive, so a
+// range can be read without holding the store.
+//
+// All groups share one byte budget. Groups are kept in LRU order (add and
+// read both count as use); going over the budget evicts the least recently
+// used groups, never the one just added to. Not thread-safe: one owner.
+
+struct HistoryStoreParams {
+    uint32_t max_entries_per_group = 50;
+    // Arenas, slot rings and per-group overhead of all groups
+    size_t max_bytes = size_t(64) << 20;
+};
+
+struct HistoryStoreStats {
+    size_t groups = 0;
+    size_t entries = 0;
+    // Content bytes of live entries
+    size_t content_bytes = 0;
+    // Memory the store holds, as counted against max_bytes
+    size_t resident_bytes = 0;
+    uint64_t evicted_groups = 0;
+    uint64_t compactions = 0;
+};
+
+struct HistoryArena {
+    std::unique_ptr<uint8_t[]> data;
+    size_t capacity = 0;
+    size_t used = 0;
+};
+
+// Entries of one group, oldest first. offsets are relative to begin.
+struct HistoryRange {
+    std::shared_ptr<const HistoryArena> arena;
+    size_t begin = 0;
+    size_t end = 0;
+    std::vector<double> timestamps;
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> lengths;
+};
+
+class HistoryStore {
+public:
+    explicit HistoryStore(const HistoryStoreParams& params);
+
+    // False when the content alone is larger than the byte budget
+    bool Add(const std::string& group, double timestamp, const char* content, size_t len);
+
+    // Entries with timestamp >= from_ts. False for an unknown group.
+    bool Range(const std::string& group, double from_ts, HistoryRange* out);
+
+    bool ClearGroup(const std::string& group);
+    void Clear();
+
+    size_t Groups() const { return groups_.size(); }
+    HistoryStoreStats Stats() const;
+    const HistoryStoreParams& Params() const { return params_; }
+
+private:
+    struct Slot {
+        double timestamp;
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    struct Group {
+        std::string key;
+        // Ring of `count` live slots starting at `head`. It grows by
+        // push_back only while head == 0 and every slot is live.
+        std::vector<Slot> slots;
+        uint32_t head = 0;
+        uint32_t count = 0;
+        size_t content_bytes = 0;
+        size_t resident = 0;
+        std::shared_ptr<HistoryArena> arena;
+    };
+
+    using GroupList = std::list<Group>;
+
+    const Slot& SlotAt(const Group& g, size_t i) const { return g.slots[(g.head + i) % g.slots.size()]; }
+
+    void Compact(Group& g, size_t extra);
+    void UpdateResident(Group& g);
+    void Evict(GroupList::iterator it);
+
+    HistoryStoreParams params_;
+    // Most recently used first
+    GroupList lru_;
+    std::unordered_map<std::string, GroupList::iterator> groups_;
+    size_t entries_ = 0;
+    size_t content_bytes_ = 0;
+    size_t resident_bytes_ = 0;
+    uint64_t evicted_groups_ = 0;
+    uint64_t compactions_ = 0;
+};
@@ -0,0 +1,685 @@
+#include "hnsw-graph.h"
+#include "thread-pool.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <queue>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Save format, host byte order (every supported target is little-endian):
+//
+//   GraphHeader
+//   per node: u8 level, u8 deleted, u32 id length, id bytes,
+//             dims floats, layer 0 links (1 + 2m u32),
+//             level x upper layer links (1 + m u32 each)
+
+static constexpr uint32_t kFormatVersion = 1;
+static constexpr char kMagic[8] = {'O', 'C', 'H', 'N', 'S', 'W', '\0', '\0'};
+static constexpr int kMaxLevel = 31;
+static constexpr size_t kInitialNodes = 1024;
+static constexpr size_t kWriteBuffer = 1 << 20;
+
+struct GraphHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t dims;
+    uint32_t metric;
+    uint32_t m;
+    uint32_t ef_construction;
+    uint32_t ef_search;
+    uint64_t nodes;
+    uint32_t entry;
+    int32_t max_level;
+};
+
+[[noreturn]] static void ThrowIoError(const char* what, const std::string& path) {
+    throw std::runtime_error(std::string(what) + " " + path + ": " + std::strerror(errno));
+}
+
+static void WriteAll(int fd, const char* data, size_t len, const std::string& path) {
+    while (len > 0) {
+        ssize_t n = ::write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ThrowIoError("write", path);
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+}
+
+static bool IsFiniteScore(float v) {
+    uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    return (bits & 0x7f800000u) != 0x7f800000u;
+}
+
+static void Normalize(float* v, size_t dims) {
+    float norm = std::sqrt(VectorDot(v, v, dims));
+    if (norm > 0.0f) {
+        for (size_t j = 0; j < dims; j++) {
+            v[j] /= norm;
+        }
+    }
+}
+
+// Per-thread visited set, reset in O(1) by bumping the epoch
+struct VisitedMarks {
+    std::vector<uint32_t> marks;
+    uint32_t epoch = 0;
+
+    void Begin(size_t nodes) {
+        if (marks.size() < nodes) {
+            marks.resize(nodes, 0);
+        }
+        if (++epoch == 0) {
+            std::fill(marks.begin(), marks.end(), 0);
+            epoch = 1;
+        }
+    }
+
+    // True the first time `node` is seen in this epoch
+    bool Visit(uint32_t node) {
+        if (marks[node] == epoch) {
+            return false;
+        }
+        marks[node] = epoch;
+        return true;
+    }
+};
+
+static thread_local VisitedMarks visited_marks;
+
+HnswGraph::HnswGraph(const HnswParams& params)
+    : params_(params), ef_search_(params.ef_search), rng_(0x5eed5eedULL) {
+    if (params.dims == 0 || params.dims > UINT32_MAX / 4) {
+        throw std::runtime_error("invalid vector dimension");
+    }
+    if (params.m < 2 || params.m > 256) {
+        throw std::runtime_error("m must be between 2 and 256");
+    }
+    if (params.ef_construction == 0) {
+        params_.ef_construction = 1;
+    }
+    level_scale_ = 1.0 / std::log(static_cast<double>(params.m));
+}
+
+uint32_t* HnswGraph::Links(uint32_t node, int level) {
+    if (level == 0) {
+        return links0_.data() + static_cast<size_t>(node) * (1 + 2 * params_.m);
+    }
+    return upper_[node].data() + static_cast<size_t>(level - 1) * (1 + params_.m);
+}
+
+const uint32_t* HnswGraph::Links(uint32_t node, int level) const {
+    return const_cast<HnswGraph*>(this)->Links(node, level);
+}
+
+float HnswGraph::Distance(const float* a, const float* b) const {
+    switch (params_.metric) {
+        case VectorMetric::kCosine:
+            return 1.0f - VectorDot(a, b, params_.dims);
+        case VectorMetric::kDot:
+            return -VectorDot(a, b, params_.dims);
+        case VectorMetric::kL2:
+            return VectorL2Squared(a, b, params_.dims);
+    }
+    return 0.0f;
+}
+
+float HnswGraph::ToScore(float distance) const {
+    switch (params_.metric) {
+        case VectorMetric::kCosine:
+            return 1.0f - distance;
+        case VectorMetric::kDot:
+            return -distance;
+        case VectorMetric::kL2:
+            return std::sqrt(std::max(distance, 0.0f));
+    }
+    return 0.0f;
+}
+
+void HnswGraph::CopyLinks(uint32_t node, int level, std::vector<uint32_t>* out) const {
+    std::lock_guard<std::mutex> lock(LinkLock(node));
+    const uint32_t* links = Links(node, level);
+    out->assign(links + 1, links + 1 + links[0]);
+}
+
+// Walks down layers (to, from] moving to the closest neighbour until none
+// is closer
+uint32_t HnswGraph::GreedyClosest(const float* target, uint32_t entry, float* dist, int from, int to) const {
+    std::vector<uint32_t> neighbours;
+    uint32_t current = entry;
+    for (int level = from; level > to; level--) {
+        bool moved = true;
+        while (moved) {
+            moved = false;
+            CopyLinks(current, level, &neighbours);
+            for (uint32_t n : neighbours) {
+                float d = Distance(target, Vector(n));
+                if (d < *dist) {
+                    *dist = d;
+                    current = n;
+                    moved = true;
+                }
+            }
+        }
+    }
+    return current;
+}
+
+// Best-first search of one layer keeping the ef closest. With liveOnly,
+// tombstoned nodes are still expanded but never kept.
+std::vector<HnswGraph::Candidate> HnswGraph::SearchLayer(const float* target, uint32_t entry, float entryDist,
+                                                         size_t ef, int level, bool liveOnly) const {
+    VisitedMarks& visited = visited_marks;
+    visited.Begin(nodes_);
+
+    std::priority_queue<Candidate> best;  // worst on top
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> frontier;
+
+    visited.Visit(entry);
+    frontier.push({entryDist, entry});
+    if (!liveOnly || !deleted_[entry].load(std::memory_order_relaxed)) {
+        best.push({entryDist, entry});
+    }
+
+    std::vector<uint32_t> neighbours;
+    while (!frontier.empty()) {
+        Candidate current = frontier.top();
+        if (best.size() >= ef && current.first > best.top().first) {
+            break;
+        }
+        frontier.pop();
+
+        CopyLinks(current.second, level, &neighbours);
+        for (uint32_t n : neighbours) {
+            if (!visited.Visit(n)) {
+                continue;
+            }
+            float d = Distance(target, Vector(n));
+            if (best.size() < ef || d < best.top().first) {
+                frontier.push({d, n});
+                if (!liveOnly || !deleted_[n].load(std::memory_order_relaxed)) {
+                    best.push({d, n});
+                    if (best.size() > ef) {
+                        best.pop();
+                    }
+                }
+            }
+        }
+    }
+
+    std::vector<Candidate> out;
+    out.reserve(best.size());
+    while (!best.empty()) {
+        out.push_back(best.top());
+        best.pop();
+    }
+    std::reverse(out.begin(), out.end());
+    return out;
+}
+
+// Keeps a candidate only if it is closer to the base than to every one
+// already kept, which preserves links across clusters
+std::vector<HnswGraph::Candidate> HnswGraph::SelectNeighbours(std::vector<Candidate> candidates,
+                                                              size_t max) const {
+    std::sort(candidates.begin(), candidates.end());
+    if (candidates.size() <= max) {
+        return candidates;
+    }
+
+    std::vector<Candidate> kept;
+    kept.reserve(max);
+    for (const Candidate& c : candidates) {
+        bool diverse = true;
+        for (const Candidate& k : kept) {
+            if (Distance(Vector(c.second), Vector(k.second)) < c.first) {
+                diverse = false;
+                break;
+            }
+        }
+        if (diverse) {
+            kept.push_back(c);
+            if (kept.size() >= max) {
+                break;
+            }
+        }
+    }
+    return kept;
+}
+
+void HnswGraph::Connect(uint32_t from, uint32_t to, int level) {
+    std::lock_guard<std::mutex> lock(LinkLock(from));
+    uint32_t* links = Links(from, level);
+    size_t count = links[0];
+    size_t max = MaxLinks(level);
+
+    for (size_t i = 0; i < count; i++) {
+        if (links[1 + i] == to) {
+            return;
+        }
+    }
+    if (count < max) {
+        links[1 + count] = to;
+        links[0] = static_cast<uint32_t>(count + 1);
+        return;
+    }
+
+    // Full: re-select among the current links plus the new one
+    const float* base = Vector(from);
+    std::vector<Candidate> candidates;
+    candidates.reserve(count + 1);
+    candidates.push_back({Distance(base, Vector(to)), to});
+    for (size_t i = 0; i < count; i++) {
+        candidates.push_back({Distance(base, Vector(links[1 + i])), links[1 + i]});
+    }
+    std::vector<Candidate> kept = SelectNeighbours(std::move(candidates), max);
+    for (size_t i = 0; i < kept.size(); i++) {
+        links[1 + i] = kept[i].second;
+    }
+    links[0] = static_cast<uint32_t>(kept.size());
+}
+
+void HnswGraph::Grow(size_t nodes) {
+    if (nodes <= capacity_) {
+        return;
+    }
+    if (nodes >= kNone) {
+        throw std::runtime_error("HNSW graph is full");
+    }
+    size_t capacity = std::max({nodes, capacity_ * 2, kInitialNodes});
+    capacity = std::min(capacity, static_cast<size_t>(kNone) - 1);
+
+    vectors_.resize(capacity * params_.dims);
+    links0_.resize(capacity * (1 + 2 * params_.m), 0);
+    upper_.resize(capacity);
+    levels_.resize(capacity, 0);
+    ids_.resize(capacity);
+
+    std::unique_ptr<std::atomic<uint8_t>[]> deleted(new std::atomic<uint8_t>[capacity]);
+    for (size_t i = 0; i < capacity; i++) {
+        deleted[i].store(i < nodes_ ? deleted_[i].load(std::memory_order_relaxed) : 0,
+                         std::memory_order_relaxed);
+    }
+    deleted_ = std::move(deleted);
+    capacity_ = capacity;
+}
+
+int HnswGraph::RandomLevel() {
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    double u = 1.0 - uniform(rng_);  // (0, 1]
+    return std::min(static_cast<int>(-std::log(u) * level_scale_), kMaxLevel);
+}
+
+// Assigns nodes and copies vectors in; tombstones replaced ids
+std::vector<uint32_t> HnswGraph::Reserve(const std::vector<std::string>& ids, const float* vectors) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    Grow(nodes_ + ids.size());
+
+    std::vector<uint32_t> nodes;
+    nodes.reserve(ids.size());
+    for (size_t i = 0; i < ids.size(); i++) {
+        uint32_t node = static_cast<uint32_t>(nodes_++);
+        float* v = vectors_.data() + static_cast<size_t>(node) * params_.dims;
+        std::memcpy(v, vectors + i * params_.dims, params_.dims * sizeof(float));
+        if (params_.metric == VectorMetric::kCosine) {
+            Normalize(v, params_.dims);
+        }
+
+        int level = RandomLevel();
+        levels_[node] = static_cast<uint8_t>(level);
+        upper_[node].assign(static_cast<size_t>(level) * (1 + params_.m), 0);
+        ids_[node] = ids[i];
+        deleted_[node].store(0, std::memory_order_relaxed);
+
+        auto it = by_id_.find(ids[i]);
+        if (it != by_id_.end()) {
+            deleted_[it->second].store(1, std::memory_order_relaxed);
+            it->second = node;
+        } else {
+            by_id_.emplace(ids[i], node);
+        }
+        nodes.push_back(node);
+    }
+    return nodes;
+}
+
+void HnswGraph::Insert(uint32_t node) {
+    const float* v = Vector(node);
+    int level = levels_[node];
+
+    uint32_t entry;
+    int max_level;
+    {
+        std::lock_guard<std::mutex> lock(entry_mutex_);
+        if (entry_ == kNone) {
+            entry_ = node;
+            max_level_ = level;
+            return;
+        }
+        entry = entry_;
+        max_level = max_level_;
+    }
+
+    float dist = Distance(v, Vector(entry));
+    uint32_t current = GreedyClosest(v, entry, &dist, max_level, level);
+
+    for (int l = std::min(level, max_level); l >= 0; l--) {
+        std::vector<Candidate> candidates =
+            SearchLayer(v, current, dist, params_.ef_construction, l, false);
+        current = candidates.front().second;
+        dist = candidates.front().first;
+
+        std::vector<Candidate> chosen = SelectNeighbours(std::move(candidates), params_.m);
+        {
+            std::lock_guard<std::mutex> lock(LinkLock(node));
+            uint32_t* links = Links(node, l);
+            for (size_t i = 0; i < chosen.size(); i++) {
+                links[1 + i] = chosen[i].second;
+            }
+            links[0] = static_cast<uint32_t>(chosen.size());
+        }
+        for (const Candidate& c : chosen) {
+            Connect(c.second, node, l);
+        }
+    }
+
+    if (level > max_level) {
+        std::lock_guard<std::mutex> lock(entry_mutex_);
+        if (level > max_level_) {
+            entry_ = node;
+            max_level_ = level;
+        }
+    }
+}
+
+void HnswGraph::AddMany(const std::vector<std::string>& ids, const float* vectors) {
+    if (ids.empty()) {
+        return;
+    }
+    std::vector<uint32_t> nodes = Reserve(ids, vectors);
+
+    // Inserts hold the lock shared one at a time, so Reserve / Remove from
+    // other threads can interleave
+    ThreadPool::Shared().ParallelFor(nodes.size(), [&](size_t i) {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        Insert(nodes[i]);
+    });
+}
+
+bool HnswGraph::Remove(const std::string& id) {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::lock_guard<std::mutex> ids_lock(ids_mutex_);
+    auto it = by_id_.find(id);
+    if (it == by_id_.end()) {
+        return false;
+    }
+    deleted_[it->second].store(1, std::memory_order_relaxed);
+    by_id_.erase(it);
+    return true;
+}
+
+bool HnswGraph::Has(const std::string& id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::lock_guard<std::mutex> ids_lock(ids_mutex_);
+    return by_id_.count(id) != 0;
+}
+
+size_t HnswGraph::Size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::lock_guard<std::mutex> ids_lock(ids_mutex_);
+    return by_id_.size();
+}
+
+size_t HnswGraph::Nodes() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return nodes_;
+}
+
+std::vector<HnswGraph::Hit> HnswGraph::Search(const float* query, size_t k, size_t ef) const {
+    std::vector<Hit> hits;
+    if (k == 0) {
+        return hits;
+    }
+
+    std::vector<float> q(query, query + params_.dims);
+    if (params_.metric == VectorMetric::kCosine) {
+        Normalize(q.data(), params_.dims);
+    }
+
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    uint32_t entry;
+    int max_level;
+    {
+        std::lock_guard<std::mutex> entry_lock(entry_mutex_);
+        entry = entry_;
+        max_level = max_level_;
+    }
+    if (entry == kNone) {
+        return hits;
+    }
+
+    float dist = Distance(q.data(), Vector(entry));
+    uint32_t current = GreedyClosest(q.data(), entry, &dist, max_level, 0);
+    std::vector<Candidate> best =
+        SearchLayer(q.data(), current, dist, std::max(ef ? ef : EfSearch(), k), 0, true);
+
+    hits.reserve(std::min(k, best.size()));
+    for (const Candidate& c : best) {
+        if (hits.size() == k) {
+            break;
+        }
+        float score = ToScore(c.first);
+        if (IsFiniteScore(score)) {
+            hits.push_back({ids_[c.second], score});
+        }
+    }
+    return hits;
+}
+
+void HnswGraph::Save(const std::string& path) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+
+    GraphHeader header = {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kFormatVersion;
+    header.dims = static_cast<uint32_t>(params_.dims);
+    header.metric = static_cast<uint32_t>(params_.metric);
+    header.m = static_cast<uint32_t>(params_.m);
+    header.ef_construction = static_cast<uint32_t>(params_.ef_construction);
+    header.ef_search = static_cast<uint32_t>(EfSearch());
+    header.nodes = nodes_;
+    {
+        std::lock_guard<std::mutex> entry_lock(entry_mutex_);
+        header.entry = entry_;
+        header.max_level = max_level_;
+    }
+
+    std::string tmp = path + ".tmp";
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        ThrowIoError("open", tmp);
+    }
+
+    try {
+        std::string buf;
+        buf.reserve(kWriteBuffer + 4096);
+        buf.append(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        size_t links0 = 1 + 2 * params_.m;
+        for (size_t node = 0; node < nodes_; node++) {
+            uint8_t level = levels_[node];
+            uint8_t deleted = deleted_[node].load(std::memory_order_relaxed);
+            uint32_t id_len = static_cast<uint32_t>(ids_[node].size());
+            buf.push_back(static_cast<char>(level));
+            buf.push_back(static_cast<char>(deleted));
+            buf.append(reinterpret_cast<const char*>(&id_len), sizeof(id_len));
+            buf.append(ids_[node]);
+            buf.append(reinterpret_cast<const char*>(Vector(static_cast<uint32_t>(node))),
+                       params_.dims * sizeof(float));
+            {
+                // Inserts may still be linking this node
+                std::lock_guard<std::mutex> link_lock(LinkLock(static_cast<uint32_t>(node)));
+                buf.append(reinterpret_cast<const char*>(Links(static_cast<uint32_t>(node), 0)),
+                           links0 * sizeof(uint32_t));
+                buf.append(reinterpret_cast<const char*>(upper_[node].data()),
+                           upper_[node].size() * sizeof(uint32_t));
+            }
+            if (buf.size() >= kWriteBuffer) {
+                WriteAll(fd, buf.data(), buf.size(), tmp);
+                buf.clear();
+            }
+        }
+        WriteAll(fd, buf.data(), buf.size(), tmp);
+        if (::fsync(fd) != 0) {
+            ThrowIoError("fsync", tmp);
+        }
+    } catch (...) {
+        ::close(fd);
+        ::unlink(tmp.c_str());
+        throw;
+    }
+    ::close(fd);
+
+    if (::rename(tmp.c_str(), path.c_str()) != 0) {
+        ::unlink(tmp.c_str());
+        ThrowIoError("rename", path);
+    }
+}
+
+// Bounds-checked reader over a mapped Save() file
+struct GraphReader {
+    const uint8_t* p;
+    const uint8_t* end;
+    const std::string& path;
+
+    void Read(void* out, size_t len) {
+        if (len == 0) {
+            return;
+        }
+        if (static_cast<size_t>(end - p) < len) {
+            throw std::runtime_error("HNSW graph " + path + " is truncated");
+        }
+        std::memcpy(out, p, len);
+        p += len;
+    }
+};
+
+std::unique_ptr<HnswGraph> HnswGraph::Load(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        ThrowIoError("open", path);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        ThrowIoError("stat", path);
+    }
+    size_t bytes = static_cast<size_t>(st.st_size);
+    if (bytes < sizeof(GraphHeader)) {
+        ::close(fd);
+        throw std::runtime_error("HNSW graph " + path + " is truncated");
+    }
+    void* map = ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        ThrowIoError("mmap", path);
+    }
+
+    std::unique_ptr<HnswGraph> graph;
+    try {
+        GraphReader in{static_cast<const uint8_t*>(map), static_cast<const uint8_t*>(map) + bytes, path};
+        GraphHeader header;
+        in.Read(&header, sizeof(header));
+        if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kFormatVersion ||
+            header.metric > static_cast<uint32_t>(VectorMetric::kL2)) {
+            throw std::runtime_error(path + " is not an HNSW graph file");
+        }
+
+        HnswParams params;
+        params.dims = header.dims;
+        params.metric = static_cast<VectorMetric>(header.metric);
+        params.m = header.m;
+        params.ef_construction = header.ef_construction;
+        params.ef_search = header.ef_search;
+        graph = std::make_unique<HnswGraph>(params);
+
+        if (header.nodes >= kNone || (header.nodes > 0) != (header.entry != kNone) ||
+            (header.nodes > 0 && (header.entry >= header.nodes || header.max_level < 0)) ||
+            header.max_level > kMaxLevel) {
+            throw std::runtime_error("HNSW graph " + path + " is corrupt");
+        }
+        // Bound the allocation by what the file can actually hold
+        size_t min_node_bytes = 6 + (params.dims + 1 + 2 * params.m) * sizeof(uint32_t);
+        if (header.nodes > (bytes - sizeof(GraphHeader)) / min_node_bytes) {
+            throw std::runtime_error("HNSW graph " + path + " is truncated");
+        }
+        size_t nodes = static_cast<size_t>(header.nodes);
+        graph->Grow(nodes);
+
+        size_t links0 = 1 + 2 * params.m;
+        for (size_t node = 0; node < nodes; node++) {
+            uint8_t level, deleted;
+            uint32_t id_len;
+            in.Read(&level, 1);
+            in.Read(&deleted, 1);
+            in.Read(&id_len, sizeof(id_len));
+            if (level > kMaxLevel || static_cast<size_t>(in.end - in.p) < id_len) {
+                throw std::runtime_error("HNSW graph " + path + " is corrupt");
+            }
+            std::string id(reinterpret_cast<const char*>(in.p), id_len);
+            in.p += id_len;
+
+            in.Read(graph->vectors_.data() + node * params.dims, params.dims * sizeof(float));
+            uint32_t* links = graph->links0_.data() + node * links0;
+            in.Read(links, links0 * sizeof(uint32_t));
+            std::vector<uint32_t>& upper = graph->upper_[node];
+            upper.resize(static_cast<size_t>(level) * (1 + params.m));
+            in.Read(upper.data(), upper.size() * sizeof(uint32_t));
+
+            graph->levels_[node] = level;
+            graph->deleted_[node].store(deleted ? 1 : 0, std::memory_order_relaxed);
+            if (!deleted) {
+                graph->by_id_[id] = static_cast<uint32_t>(node);
+            }
+            graph->ids_[node] = std::move(id);
+        }
+
+        // Every list must fit its layer and point at nodes present on it
+        for (size_t node = 0; node < nodes; node++) {
+            for (int l = 0; l <= graph->levels_[node]; l++) {
+                const uint32_t* list = graph->Links(static_cast<uint32_t>(node), l);
+                if (list[0] > graph->MaxLinks(l)) {
+                    throw std::runtime_error("HNSW graph " + path + " is corrupt");
+                }
+                for (uint32_t i = 0; i < list[0]; i++) {
+                    if (list[1 + i] >= nodes || graph->levels_[list[1 + i]] < l) {
+                        throw std::runtime_error("HNSW graph " + path + " is corrupt");
+                    }
+                }
+            }
+        }
+
+        graph->nodes_ = nodes;
+        graph->entry_ = header.entry;
+        graph->max_level_ = header.max_level;
+        if (nodes > 0 && graph->levels_[header.entry] != header.max_level) {
+            throw std::runtime_error("HNSW graph " + path + " is corrupt");
+        }
+    } catch (...) {
+        ::munmap(map, bytes);
+        throw;
+    }
+    ::munmap(map, bytes);
+    return graph;
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "vector-ops.h"
+
+// Hierarchical navigable small world graph (Malkov & Yashunin, 2016) for
+// approximate nearest-neighbour search over float32 vectors keyed by
+// string id.
+//
+// Searches may run on any number of threads while AddMany inserts on
+// others. The index lock is only taken exclusively to grow storage and
+// assign node numbers; edges are guarded by striped per-node locks, so a
+// reader sees each neighbour list either before or after an update.
+//
+// Removed and replaced ids are tombstoned: the node keeps routing
+// searches but is never returned. Build a fresh graph to drop them.
+//
+// Load / Save errors throw std::runtime_error.
+
+struct HnswParams {
+    size_t dims = 0;
+    VectorMetric metric = VectorMetric::kCosine;
+    size_t m = 16;                 // links per node; 2m on layer 0
+    size_t ef_construction = 200;  // candidate list size while inserting
+    size_t ef_search = 64;         // default candidate list size for Search
+};
+
+class HnswGraph {
+public:
+    struct Hit {
+        std::string id;
+        float score;
+    };
+
+    explicit HnswGraph(const HnswParams& params);
+
+    HnswGraph(const HnswGraph&) = delete;
+    HnswGraph& operator=(const HnswGraph&) = delete;
+
+    // Reads a file written by Save().
+    static std::unique_ptr<HnswGraph> Load(const std::string& path);
+
+    // Writes path.tmp, fsyncs it and renames it over `path`.
+    void Save(const std::string& path) const;
+
+    // Inserts or replaces ids.size() vectors of dims floats, in parallel on
+    // the shared ThreadPool. A replaced id is not found until its new node
+    // is linked.
+    void AddMany(const std::vector<std::string>& ids, const float* vectors);
+    bool Remove(const std::string& id);
+    bool Has(const std::string& id) const;
+
+    // Best k live ids, best first, scored like TopKRows. ef = 0 uses
+    // ef_search; it is raised to k when smaller.
+    std::vector<Hit> Search(const float* query, size_t k, size_t ef) const;
+
+    size_t Size() const;
+    size_t Nodes() const;  // including tombstones
+    const HnswParams& Params() const { return params_; }
+    size_t EfSearch() const { return ef_search_.load(std::memory_order_relaxed); }
+    void SetEfSearch(size_t ef) { ef_search_.store(ef, std::memory_order_relaxed); }
+
+private:
+    using Candidate = std::pair<float, uint32_t>;  // (distance, node)
+
+    static constexpr uint32_t kNone = UINT32_MAX;
+    static constexpr size_t kLinkStripes = 1024;
+
+    std::mutex& LinkLock(uint32_t node) const { return link_locks_[node & (kLinkStripes - 1)]; }
+    uint32_t* Links(uint32_t node, int level);
+    const uint32_t* Links(uint32_t node, int level) const;
+    size_t MaxLinks(int level) const { return level == 0 ? 2 * params_.m : params_.m; }
+    const float* Vector(uint32_t node) const { return vectors_.data() + node * params_.dims; }
+    float Distance(const float* a, const float* b) const;
+    float ToScore(float distance) const;
+
+    void CopyLinks(uint32_t node, int level, std::vector<uint32_t>* out) const;
+    uint32_t GreedyClosest(const float* target, uint32_t entry, float* dist, int from, int to) const;
+    std::vector<Candidate> SearchLayer(const float* target, uint32_t entry, float entryDist, size_t ef,
+                                       int level, bool liveOnly) const;
+    std::vector<Candidate> SelectNeighbours(std::vector<Candidate> candidates, size_t max) const;
+    void Connect(uint32_t from, uint32_t to, int level);
+
+    void Grow(size_t nodes);
+    int RandomLevel();
+    std::vector<uint32_t> Reserve(const std::vector<std::string>& ids, const float* vectors);
+    void Insert(uint32_t node);
+
+    HnswParams params_;
+    std::atomic<size_t> ef_search_;
+    double level_scale_;
+
+    // Guards storage size and node assignment; shared for everything else
+    mutable std::shared_mutex mutex_;
+    mutable std::mutex link_locks_[kLinkStripes];
+
+    size_t nodes_ = 0;
+    size_t capacity_ = 0;
+    std::vector<float> vectors_;                 // unit length for kCosine
+    std::vector<uint32_t> links0_;               // per node: count, 2m ids
+    std::vector<std::vector<uint32_t>> upper_;   // levels 1..: count, m ids each
+    std::vector<uint8_t> levels_;
+    std::vector<std::string> ids_;
+    std::unique_ptr<std::atomic<uint8_t>[]> deleted_;
+
+    // by_id_ also changes under a shared index lock (Remove)
+    mutable std::mutex ids_mutex_;
+    std::unordered_map<std::string, uint32_t> by_id_;
+
+    mutable std::mutex entry_mutex_;
+    uint32_t entry_ = kNone;
+    int max_level_ = -1;
+
+    std::mt19937_64 rng_;
+};
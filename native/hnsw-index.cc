@@ -0,0 +1,509 @@
+#include <napi.h>
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+#include "addon-data.h"
+#include "hnsw-graph.h"
+#include "op-stats.h"
+#include "promise-worker.h"
+
+// Approximate nearest-neighbour index over HnswGraph. Async methods run on
+// libuv threads (inserts fan out further to the native pool) and may
+// overlap with each other and with sync searches.
+class HnswIndex : public Napi::ObjectWrap<HnswIndex> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    static Napi::Value Wrap(Napi::Env env, std::unique_ptr<HnswGraph> graph);
+    HnswIndex(const Napi::CallbackInfo& info);
+
+private:
+    // HnswIndex.load(path) / loadAsync(path): reopen a saved graph
+    static Napi::Value Load(const Napi::CallbackInfo& info);
+    static Napi::Value LoadAsync(const Napi::CallbackInfo& info);
+
+    // Insert or replace one vector / a batch of N x dims vectors
+    Napi::Value Add(const Napi::CallbackInfo& info);
+    Napi::Value AddMany(const Napi::CallbackInfo& info);
+    Napi::Value AddManyAsync(const Napi::CallbackInfo& info);
+
+    Napi::Value Remove(const Napi::CallbackInfo& info);
+    Napi::Value Has(const Napi::CallbackInfo& info);
+
+    // search(query, k, ef?) -> { ids, scores }
+    Napi::Value Search(const Napi::CallbackInfo& info);
+    Napi::Value SearchAsync(const Napi::CallbackInfo& info);
+
+    Napi::Value Save(const Napi::CallbackInfo& info);
+    Napi::Value SaveAsync(const Napi::CallbackInfo& info);
+
+    Napi::Value Size(const Napi::CallbackInfo& info);
+    Napi::Value Nodes(const Napi::CallbackInfo& info);
+    Napi::Value Dims(const Napi::CallbackInfo& info);
+    Napi::Value Metric(const Napi::CallbackInfo& info);
+    Napi::Value GetEfSearch(const Napi::CallbackInfo& info);
+    void SetEfSearch(const Napi::CallbackInfo& info, const Napi::Value& value);
+
+    // Throws unless info[0] / info[1] are (string[], Float32Array of N x dims)
+    bool ReadBatch(const Napi::CallbackInfo& info, std::vector<std::string>* ids, const float** vectors);
+
+    // Throws unless info is (Float32Array of dims, k, ef?)
+    bool ReadQuery(const Napi::CallbackInfo& info, const float** query, size_t* k, size_t* ef);
+
+    std::shared_ptr<HnswGraph> graph_;
+};
+
+static const char* MetricName(VectorMetric metric) {
+    switch (metric) {
+        case VectorMetric::kDot:
+            return "dot";
+        case VectorMetric::kCosine:
+            return "cosine";
+        case VectorMetric::kL2:
+            return "l2";
+    }
+    return "cosine";
+}
+
+static bool IsFloat32Array(const Napi::Value& value) {
+    return value.IsTypedArray() && value.As<Napi::TypedArray>().TypedArrayType() == napi_float32_array;
+}
+
+static Napi::Value HitsResult(Napi::Env env, const std::vector<HnswGraph::Hit>& hits) {
+    Napi::Array ids = Napi::Array::New(env, hits.size());
+    Napi::Float32Array scores = Napi::Float32Array::New(env, hits.size());
+    float* out = scores.Data();
+    for (size_t i = 0; i < hits.size(); i++) {
+        ids.Set(static_cast<uint32_t>(i), Napi::String::New(env, hits[i].id));
+        out[i] = hits[i].score;
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("ids", ids);
+    result.Set("scores", scores);
+    return result;
+}
+
+// Reads an optional positive integer option; false (after throwing) if invalid
+static bool ReadCountOption(Napi::Env env, const Napi::Object& options, const char* name, size_t* out) {
+    Napi::Value value = options.Get(name);
+    if (value.IsUndefined()) {
+        return true;
+    }
+    if (!value.IsNumber() || !(value.As<Napi::Number>().DoubleValue() >= 1)) {
+        Napi::TypeError::New(env, std::string(name) + " must be a positive number").ThrowAsJavaScriptException();
+        return false;
+    }
+    *out = static_cast<size_t>(value.As<Napi::Number>().Int64Value());
+    return true;
+}
+
+class AddManyWorker : public PromiseWorker {
+public:
+    AddManyWorker(Napi::Env env, std::shared_ptr<HnswGraph> graph, std::vector<std::string> ids,
+                  const float* vectors, const Napi::Value& pin)
+        : PromiseWorker(env, "openclaw:hnswAddMany"), graph_(std::move(graph)), ids_(std::move(ids)),
+          vectors_(vectors) {
+        Keep(pin);
+    }
+
+    void Execute() override {
+        try {
+            graph_->AddMany(ids_, vectors_);
+        } catch (const std::exception& e) {
+            SetError(e.what());
+        }
+    }
+
+    Napi::Value Result(Napi::Env env) override {
+        return env.Undefined();
+    }
+
+private:
+    std::shared_ptr<HnswGraph> graph_;
+    std::vector<std::string> ids_;
+    const float* vectors_;
+};
+
+class HnswSearchWorker : public PromiseWorker {
+public:
+    HnswSearchWorker(Napi::Env env, std::shared_ptr<HnswGraph> graph, const float* query, size_t k, size_t ef)
+        : PromiseWorker(env, "openclaw:hnswSearch"), graph_(std::move(graph)),
+          query_(query, query + graph_->Params().dims), k_(k), ef_(ef) {}
+
+    void Execute() override {
+        OpScope scope(NativeOp::kHnswSearch);
+        hits_ = graph_->Search(query_.data(), k_, ef_);
+    }
+
+    Napi::Value Result(Napi::Env env) override {
+        return HitsResult(env, hits_);
+    }
+
+private:
+    std::shared_ptr<HnswGraph> graph_;
+    std::vector<float> query_;
+    size_t k_;
+    size_t ef_;
+    std::vector<HnswGraph::Hit> hits_;
+};
+
+class SaveWorker : public PromiseWorker {
+public:
+    SaveWorker(Napi::Env env, std::shared_ptr<HnswGraph> graph, std::string path)
+        : PromiseWorker(env, "openclaw:hnswSave"), graph_(std::move(graph)), path_(std::move(path)) {}
+
+    void Execute() override {
+        try {
+            graph_->Save(path_);
+        } catch (const std::exception& e) {
+            SetError(e.what());
+        }
+    }
+
+    Napi::Value Result(Napi::Env env) override {
+        return env.Undefined();
+    }
+
+private:
+    std::shared_ptr<HnswGraph> graph_;
+    std::string path_;
+};
+
+class LoadWorker : public PromiseWorker {
+public:
+    LoadWorker(Napi::Env env, std::string path)
+        : PromiseWorker(env, "openclaw:hnswLoad"), path_(std::move(path)) {}
+
+    void Execute() override {
+        try {
+            graph_ = HnswGraph::Load(path_);
+        } catch (const std::exception& e) {
+            SetError(e.what());
+        }
+    }
+
+    Napi::Value Result(Napi::Env env) override {
+        return HnswIndex::Wrap(env, std::move(graph_));
+    }
+
+private:
+    std::string path_;
+    std::unique_ptr<HnswGraph> graph_;
+};
+
+Napi::Object HnswIndex::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "HnswIndex", {
+        StaticMethod("load", &HnswIndex::Load),
+        StaticMethod("loadAsync", &HnswIndex::LoadAsync),
+        InstanceMethod("add", &HnswIndex::Add),
+        InstanceMethod("addMany", &HnswIndex::AddMany),
+        InstanceMethod("addManyAsync", &HnswIndex::AddManyAsync),
+        InstanceMethod("remove", &HnswIndex::Remove),
+        InstanceMethod("has", &HnswIndex::Has),
+        InstanceMethod("search", &HnswIndex::Search),
+        InstanceMethod("searchAsync", &HnswIndex::SearchAsync),
+        InstanceMethod("save", &HnswIndex::Save),
+        InstanceMethod("saveAsync", &HnswIndex::SaveAsync),
+        InstanceAccessor("size", &HnswIndex::Size, nullptr),
+        InstanceAccessor("nodes", &HnswIndex::Nodes, nullptr),
+        InstanceAccessor("dims", &HnswIndex::Dims, nullptr),
+        InstanceAccessor("metric", &HnswIndex::Metric, nullptr),
+        InstanceAccessor("efSearch", &HnswIndex::GetEfSearch, &HnswIndex::SetEfSearch),
+    });
+
+    GetAddonData(env)->hnsw_index = Napi::Persistent(func);
+
+    exports.Set("HnswIndex", func);
+    return exports;
+}
+
+// Hands a loaded graph to a new wrapper through an External argument
+Napi::Value HnswIndex::Wrap(Napi::Env env, std::unique_ptr<HnswGraph> graph) {
+    return GetAddonData(env)->hnsw_index.New({Napi::External<HnswGraph>::New(env, graph.release())});
+}
+
+// new HnswIndex({ dims, metric?, m?, efConstruction?, efSearch? })
+HnswIndex::HnswIndex(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<HnswIndex>(info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() > 0 && info[0].IsExternal()) {
+        graph_.reset(info[0].As<Napi::External<HnswGraph>>().Data());
+        return;
+    }
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Expected ({ dims, metric?, m?, efConstruction?, efSearch? })")
+            .ThrowAsJavaScriptException();
+        return;
+    }
+
+    Napi::Object options = info[0].As<Napi::Object>();
+    HnswParams params;
+    if (!options.Get("dims").IsNumber()) {
+        Napi::TypeError::New(env, "dims must be a positive number").ThrowAsJavaScriptException();
+        return;
+    }
+    if (!ReadCountOption(env, options, "dims", &params.dims) ||
+        !ReadCountOption(env, options, "m", &params.m) ||
+        !ReadCountOption(env, options, "efConstruction", &params.ef_construction) ||
+        !ReadCountOption(env, options, "efSearch", &params.ef_search)) {
+        return;
+    }
+
+    Napi::Value metric = options.Get("metric");
+    if (!metric.IsUndefined() &&
+        (!metric.IsString() || !ParseVectorMetric(metric.As<Napi::String>().Utf8Value(), &params.metric))) {
+        Napi::TypeError::New(env, "metric must be 'cosine', 'dot' or 'l2'").ThrowAsJavaScriptException();
+        return;
+    }
+
+    try {
+        graph_ = std::make_shared<HnswGraph>(params);
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    }
+}
+
+Napi::Value HnswIndex::Load(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected path").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    try {
+        return Wrap(env, HnswGraph::Load(info[0].As<Napi::String>().Utf8Value()));
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+}
+
+Napi::Value HnswIndex::LoadAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected path").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    return (new LoadWorker(env, info[0].As<Napi::String>().Utf8Value()))->Start();
+}
+
+bool HnswIndex::ReadBatch(const Napi::CallbackInfo& info, std::vector<std::string>* ids, const float** vectors) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsArray() || !IsFloat32Array(info[1])) {
+        Napi::TypeError::New(env, "Expected (ids, vectors: Float32Array)").ThrowAsJavaScriptException();
+        return false;
+    }
+
+    Napi::Array list = info[0].As<Napi::Array>();
+    ids->reserve(list.Length());
+    for (uint32_t i = 0; i < list.Length(); i++) {
+        Napi::Value item = list.Get(i);
+        if (!item.IsString()) {
+            Napi::TypeError::New(env, "ids must be strings").ThrowAsJavaScriptException();
+            return false;
+        }
+        ids->push_back(item.As<Napi::String>().Utf8Value());
+    }
+
+    Napi::Float32Array array = info[1].As<Napi::Float32Array>();
+    if (array.ElementLength() != ids->size() * graph_->Params().dims) {
+        Napi::RangeError::New(env, "Vector length does not match dims").ThrowAsJavaScriptException();
+        return false;
+    }
+    *vectors = array.Data();
+    return true;
+}
+
+Napi::Value HnswIndex::Add(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsString() || !IsFloat32Array(info[1])) {
+        Napi::TypeError::New(env, "Expected (id, vector: Float32Array)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    Napi::Float32Array vector = info[1].As<Napi::Float32Array>();
+    if (vector.ElementLength() != graph_->Params().dims) {
+        Napi::RangeError::New(env, "Vector length does not match dims").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    try {
+        graph_->AddMany({info[0].As<Napi::String>().Utf8Value()}, vector.Data());
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    }
+    return env.Undefined();
+}
+
+Napi::Value HnswIndex::AddMany(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    std::vector<std::string> ids;
+    const float* vectors;
+    if (!ReadBatch(info, &ids, &vectors)) {
+        return env.Null();
+    }
+
+    try {
+        graph_->AddMany(ids, vectors);
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    }
+    return env.Undefined();
+}
+
+Napi::Value HnswIndex::AddManyAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    std::vector<std::string> ids;
+    const float* vectors;
+    if (!ReadBatch(info, &ids, &vectors)) {
+        return env.Null();
+    }
+
+    return (new AddManyWorker(env, graph_, std::move(ids), vectors, info[1]))->Start();
+}
+
+Napi::Value HnswIndex::Remove(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected id").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    return Napi::Boolean::New(env, graph_->Remove(info[0].As<Napi::String>().Utf8Value()));
+}
+
+Napi::Value HnswIndex::Has(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected id").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    return Napi::Boolean::New(env, graph_->Has(info[0].As<Napi::String>().Utf8Value()));
+}
+
+bool HnswIndex::ReadQuery(const Napi::CallbackInfo& info, const float** query, size_t* k, size_t* ef) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !IsFloat32Array(info[0]) || !info[1].IsNumber()) {
+        Napi::TypeError::New(env, "Expected (query: Float32Array, k, ef?)").ThrowAsJavaScriptException();
+        return false;
+    }
+    Napi::Float32Array array = info[0].As<Napi::Float32Array>();
+    if (array.ElementLength() != graph_->Params().dims) {
+        Napi::RangeError::New(env, "Vector length does not match dims").ThrowAsJavaScriptException();
+        return false;
+    }
+
+    double k_value = info[1].As<Napi::Number>().DoubleValue();
+    double ef_value = 0;
+    if (info.Length() > 2 && !info[2].IsUndefined()) {
+        ef_value = info[2].IsNumber() ? info[2].As<Napi::Number>().DoubleValue() : -1;
+    }
+    if (!(k_value >= 0) || !(ef_value >= 0)) {
+        Napi::RangeError::New(env, "Invalid k or ef").ThrowAsJavaScriptException();
+        return false;
+    }
+
+    *query = array.Data();
+    *k = static_cast<size_t>(std::min(k_value, 4294967295.0));
+    *ef = static_cast<size_t>(std::min(ef_value, 4294967295.0));
+    return true;
+}
+
+Napi::Value HnswIndex::Search(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    const float* query;
+    size_t k, ef;
+    if (!ReadQuery(info, &query, &k, &ef)) {
+        return env.Null();
+    }
+
+    OpScope scope(NativeOp::kHnswSearch);
+    return HitsResult(env, graph_->Search(query, k, ef));
+}
+
+Napi::Value HnswIndex::SearchAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    const float* query;
+    size_t k, ef;
+    if (!ReadQuery(info, &query, &k, &ef)) {
+        return env.Null();
+    }
+
+    return (new HnswSearchWorker(env, graph_, query, k, ef))->Start();
+}
+
+Napi::Value HnswIndex::Save(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected path").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    try {
+        graph_->Save(info[0].As<Napi::String>().Utf8Value());
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    }
+    return env.Undefined();
+}
+
+Napi::Value HnswIndex::SaveAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected path").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    return (new SaveWorker(env, graph_, info[0].As<Napi::String>().Utf8Value()))->Start();
+}
+
+Napi::Value HnswIndex::Size(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), static_cast<double>(graph_->Size()));
+}
+
+Napi::Value HnswIndex::Nodes(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), static_cast<double>(graph_->Nodes()));
+}
+
+Napi::Value HnswIndex::Dims(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), static_cast<double>(graph_->Params().dims));
+}
+
+Napi::Value HnswIndex::Metric(const Napi::CallbackInfo& info) {
+    return Napi::String::New(info.Env(), MetricName(graph_->Params().metric));
+}
+
+Napi::Value HnswIndex::GetEfSearch(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), static_cast<double>(graph_->EfSearch()));
+}
+
+void HnswIndex::SetEfSearch(const Napi::CallbackInfo& info, const Napi::Value& value) {
+    if (!value.IsNumber() || !(value.As<Napi::Number>().DoubleValue() >= 1)) {
+        Napi::TypeError::New(info.Env(), "efSearch must be a positive number").ThrowAsJavaScriptException();
+        return;
+    }
+    graph_->SetEfSearch(static_cast<size_t>(value.As<Napi::Number>().Int64Value()));
+}
+
+// Module initialization
+Napi::Object InitHnswIndex(Napi::Env env, Napi::Object exports) {
+    return HnswIndex::Init(env, exports);
+}
@@ -0,0 +1,496 @@
+#include "image-pipeline.h"
+
+#include <algorithm>
+#include <cmath>
+#include <csetjmp>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <new>
+
+#include <jpeglib.h>
+#include <jerror.h>
+
+#include "media-probe.h"
+
+namespace {
+
+// ---- libjpeg plumbing ----
+
+// libjpeg reports fatal errors by calling error_exit, which must not return
+struct JpegError {
+    jpeg_error_mgr mgr;
+    jmp_buf jump;
+};
+
+void JpegErrorExit(j_common_ptr cinfo) {
+    longjmp(reinterpret_cast<JpegError*>(cinfo->err)->jump, 1);
+}
+
+// Corrupt-data warnings: decode what is there, as sharp does with failOnError off
+void JpegOutputMessage(j_common_ptr) {}
+
+void InitJpegError(JpegError* error) {
+    jpeg_std_error(&error->mgr);
+    error->mgr.error_exit = JpegErrorExit;
+    error->mgr.output_message = JpegOutputMessage;
+}
+
+// Compressed output straight into a std::vector
+struct VectorDestination {
+    jpeg_destination_mgr mgr;
+    std::vector<uint8_t>* out;
+};
+
+void GrowDestination(j_compress_ptr cinfo, size_t used) {
+    VectorDestination* dest = reinterpret_cast<VectorDestination*>(cinfo->dest);
+    bool grown = true;
+    try {
+        dest->out->resize(std::max<size_t>(dest->out->size() * 2, 64 * 1024));
+    } catch (const std::bad_alloc&) {
+        grown = false;
+    }
+    if (!grown) {
+        ERREXIT(cinfo, JERR_OUT_OF_MEMORY);
+    }
+    dest->mgr.next_output_byte = dest->out->data() + used;
+    dest->mgr.free_in_buffer = dest->out->size() - used;
+}
+
+void InitDestination(j_compress_ptr cinfo) {
+    GrowDestination(cinfo, 0);
+}
+
+boolean EmptyOutputBuffer(j_compress_ptr cinfo) {
+    // libjpeg only calls this with the whole buffer full
+    GrowDestination(cinfo, reinterpret_cast<VectorDestination*>(cinfo->dest)->out->size());
+    return TRUE;
+}
+
+void TermDestination(j_compress_ptr cinfo) {
+    VectorDestination* dest = reinterpret_cast<VectorDestination*>(cinfo->dest);
+    dest->out->resize(dest->out->size() - dest->mgr.free_in_buffer);
+}
+
+// ---- Resampling ----
+
+float Lanczos3(double t) {
+    if (t == 0) {
+        return 1;
+    }
+    if (t <= -3 || t >= 3) {
+        return 0;
+    }
+    double x = M_PI * t;
+    return static_cast<float>(3 * std::sin(x) * std::sin(x / 3) / (x * x));
+}
+
+// Per-output-sample taps over the input axis: weights for input
+// start[i] .. start[i] + count[i] - 1, stored at weights[i * taps]
+struct Filter {
+    uint32_t taps = 1;
+    std::vector<uint32_t> start;
+    std::vector<uint32_t> count;
+    std::vector<float> weights;
+};
+
+Filter BuildFilter(uint32_t in, uint32_t out) {
+    Filter filter;
+    filter.start.resize(out);
+    filter.count.resize(out);
+    if (in == out) {
+        filter.weights.assign(out, 1.0f);
+        for (uint32_t i = 0; i < out; i++) {
+            filter.start[i] = i;
+            filter.count[i] = 1;
+        }
+        return filter;
+    }
+
+    // Downscaling stretches the kernel over scale input samples per lobe
+    double scale = static_cast<double>(in) / out;
+    double stretch = std::max(scale, 1.0);
+    double support = 3 * stretch;
+    filter.taps = static_cast<uint32_t>(std::ceil(support)) * 2 + 1;
+    filter.weights.assign(static_cast<size_t>(out) * filter.taps, 0.0f);
+
+    for (uint32_t i = 0; i < out; i++) {
+        double center = (i + 0.5) * scale - 0.5;
+        int64_t left = std::max<int64_t>(0, static_cast<int64_t>(std::ceil(center - support)));
+        int64_t right = std::min<int64_t>(in - 1, static_cast<int64_t>(std::floor(center + support)));
+        right = std::max(right, left);
+        right = std::min<int64_t>(right, left + filter.taps - 1);
+
+        float* w = &filter.weights[static_cast<size_t>(i) * filter.taps];
+        double sum = 0;
+        for (int64_t k = left; k <= right; k++) {
+            w[k - left] = Lanczos3((k - center) / stretch);
+            sum += w[k - left];
+        }
+        if (sum == 0) {
+            w[0] = 1;
+            right = left;
+            sum = 1;
+        }
+        for (int64_t k = left; k <= right; k++) {
+            w[k - left] = static_cast<float>(w[k - left] / sum);
+        }
+        filter.start[i] = static_cast<uint32_t>(left);
+        filter.count[i] = static_cast<uint32_t>(right - left + 1);
+    }
+    return filter;
+}
+
+// Pixels are L float lanes: RGB padded to four so each tap is one vector op.
+// Even and odd taps go to separate accumulators so consecutive multiply-adds
+// do not wait on each other.
+template <int L>
+void ResampleRow(const Filter& filter, const float* src, float* dst, uint32_t out_width) {
+    for (uint32_t x = 0; x < out_width; x++) {
+        const float* w = &filter.weights[static_cast<size_t>(x) * filter.taps];
+        const float* p = src + static_cast<size_t>(filter.start[x]) * L;
+        uint32_t count = filter.count[x];
+        float even[L] = {};
+        float odd[L] = {};
+        uint32_t k = 0;
+        for (; k + 2 <= count; k += 2) {
+            for (int c = 0; c < L; c++) {
+                even[c] += w[k] * p[k * L + c];
+                odd[c] += w[k + 1] * p[(k + 1) * L + c];
+            }
+        }
+        if (k < count) {
+            for (int c = 0; c < L; c++) {
+                even[c] += w[k] * p[k * L + c];
+            }
+        }
+        for (int c = 0; c < L; c++) {
+            dst[x * L + c] = even[c] + odd[c];
+        }
+    }
+}
+
+// dst = sum of weights[k] * rows[k] over n floats, two rows per sweep so dst
+// is read and written half as often
+void ResampleColumn(const float* const* rows, const float* weights, uint32_t taps, float* dst, size_t n) {
+    const float* first = rows[0];
+    float w0 = weights[0];
+    uint32_t k = 1;
+    if (taps >= 2) {
+        const float* second = rows[1];
+        float w1 = weights[1];
+        for (size_t i = 0; i < n; i++) {
+            dst[i] = w0 * first[i] + w1 * second[i];
+        }
+        k = 2;
+    } else {
+        for (size_t i = 0; i < n; i++) {
+            dst[i] = w0 * first[i];
+        }
+    }
+    for (; k + 2 <= taps; k += 2) {
+        const float* a = rows[k];
+        const float* b = rows[k + 1];
+        float wa = weights[k], wb = weights[k + 1];
+        for (size_t i = 0; i < n; i++) {
+            dst[i] += wa * a[i] + wb * b[i];
+        }
+    }
+    if (k < taps) {
+        const float* a = rows[k];
+        float wa = weights[k];
+        for (size_t i = 0; i < n; i++) {
+            dst[i] += wa * a[i];
+        }
+    }
+}
+
+uint8_t ToByte(float v) {
+    v = std::min(std::max(v, 0.0f), 255.0f);
+    return static_cast<uint8_t>(v + 0.5f);
+}
+
+// Keeps the last few source rows (as floats) in a ring and emits each output
+// row once the rows under its vertical taps have arrived. The vertical pass
+// runs first, over whole contiguous rows, so the strided horizontal pass only
+// sees output rows.
+class Resampler {
+public:
+    Resampler(uint32_t in_width, uint32_t in_height, uint32_t out_width, uint32_t out_height,
+              int channels, uint32_t orientation, uint8_t* out)
+        : horizontal_(BuildFilter(in_width, out_width)),
+          vertical_(BuildFilter(in_height, out_height)),
+          in_width_(in_width), out_width_(out_width), out_height_(out_height),
+          channels_(channels), lanes_(channels == 3 ? 4 : 1), orientation_(orientation), out_(out),
+          in_stride_(static_cast<size_t>(in_width) * lanes_),
+          out_stride_(static_cast<size_t>(out_width) * channels),
+          scanline_(static_cast<size_t>(in_width) * channels),
+          ring_(static_cast<size_t>(vertical_.taps) * in_stride_),
+          taps_(vertical_.taps), column_(in_stride_), row_(static_cast<size_t>(out_width) * lanes_),
+          bytes_(out_stride_) {}
+
+    // Where the decoder writes the next source row
+    uint8_t* NextRow() {
+        return scanline_.data();
+    }
+
+    void RowReady() {
+        float* slot = &ring_[(received_ % vertical_.taps) * in_stride_];
+        const uint8_t* src = scanline_.data();
+        if (lanes_ == 4) {
+            for (uint32_t x = 0; x < in_width_; x++) {
+                slot[x * 4] = src[x * 3];
+                slot[x * 4 + 1] = src[x * 3 + 1];
+                slot[x * 4 + 2] = src[x * 3 + 2];
+                slot[x * 4 + 3] = 0;
+            }
+        } else {
+            for (uint32_t x = 0; x < in_width_; x++) {
+                slot[x] = src[x];
+            }
+        }
+        while (next_ < out_height_ && vertical_.start[next_] + vertical_.count[next_] - 1 <= received_) {
+            EmitRow(next_++);
+        }
+        received_++;
+    }
+
+private:
+    void EmitRow(uint32_t y) {
+        uint32_t taps = vertical_.count[y];
+        for (uint32_t k = 0; k < taps; k++) {
+            taps_[k] = &ring_[((vertical_.start[y] + k) % vertical_.taps) * in_stride_];
+        }
+        ResampleColumn(taps_.data(), &vertical_.weights[static_cast<size_t>(y) * vertical_.taps], taps,
+                       column_.data(), in_stride_);
+        if (lanes_ == 4) {
+            ResampleRow<4>(horizontal_, column_.data(), row_.data(), out_width_);
+            for (uint32_t x = 0; x < out_width_; x++) {
+                bytes_[x * 3] = ToByte(row_[x * 4]);
+                bytes_[x * 3 + 1] = ToByte(row_[x * 4 + 1]);
+                bytes_[x * 3 + 2] = ToByte(row_[x * 4 + 2]);
+            }
+        } else {
+            ResampleRow<1>(horizontal_, column_.data(), row_.data(), out_width_);
+            for (uint32_t x = 0; x < out_width_; x++) {
+                bytes_[x] = ToByte(row_[x]);
+            }
+        }
+        Store(y);
+    }
+
+    // Row y of the stored image, placed where the EXIF orientation puts it
+    void Store(uint32_t y) {
+        uint32_t w = out_width_, h = out_height_;
+        size_t c = static_cast<size_t>(channels_);
+        if (orientation_ <= 4) {
+            bool flip_x = orientation_ == 2 || orientation_ == 3;
+            bool flip_y = orientation_ == 3 || orientation_ == 4;
+            uint8_t* dst = out_ + static_cast<size_t>(flip_y ? h - 1 - y : y) * out_stride_;
+            if (!flip_x) {
+                std::memcpy(dst, bytes_.data(), out_stride_);
+                return;
+            }
+            for (uint32_t x = 0; x < w; x++) {
+                std::memcpy(dst + (w - 1 - x) * c, &bytes_[x * c], c);
+            }
+            return;
+        }
+        // Transposed: the row becomes a column of the h-wide output
+        uint32_t column = orientation_ == 5 || orientation_ == 8 ? y : h - 1 - y;
+        bool reverse = orientation_ == 7 || orientation_ == 8;
+        for (uint32_t x = 0; x < w; x++) {
+            uint32_t line = reverse ? w - 1 - x : x;
+            std::memcpy(out_ + (static_cast<size_t>(line) * h + column) * c, &bytes_[x * c], c);
+        }
+    }
+
+    Filter horizontal_;
+    Filter vertical_;
+    uint32_t in_width_;
+    uint32_t out_width_;
+    uint32_t out_height_;
+    int channels_;
+    int lanes_;
+    uint32_t orientation_;
+    uint8_t* out_;
+    size_t in_stride_;
+    size_t out_stride_;
+    std::vector<uint8_t> scanline_;
+    std::vector<float> ring_;
+    std::vector<const float*> taps_;
+    std::vector<float> column_;
+    std::vector<float> row_;
+    std::vector<uint8_t> bytes_;
+    uint32_t received_ = 0;
+    uint32_t next_ = 0;
+};
+
+// ---- Pipeline stages ----
+
+struct Pixels {
+    std::vector<uint8_t> data;
+    uint32_t width = 0;   // as oriented
+    uint32_t height = 0;
+    int channels = 0;
+};
+
+// Everything with a destructor lives out here: error_exit longjmps across
+// the frame that calls setjmp, and locals changed after it are unreliable
+struct DecodeBuffers {
+    std::unique_ptr<Resampler> resampler;
+};
+
+// Output size for fitting width x height inside the options' box
+void TargetSize(uint32_t width, uint32_t height, const ImageResizeOptions& options,
+                uint32_t* out_width, uint32_t* out_height) {
+    double scale = 1;
+    if (options.max_side != 0) {
+        scale = std::min(static_cast<double>(options.max_side) / width,
+                         static_cast<double>(options.max_side) / height);
+        if (options.without_enlargement) {
+            scale = std::min(scale, 1.0);
+        }
+    }
+    *out_width = std::max<uint32_t>(1, static_cast<uint32_t>(std::lround(width * scale)));
+    *out_height = std::max<uint32_t>(1, static_cast<uint32_t>(std::lround(height * scale)));
+}
+
+bool DecodeResized(const uint8_t* data, size_t len, const ImageResizeOptions& options,
+                   uint32_t orientation, DecodeBuffers* buffers, Pixels* out) {
+    jpeg_decompress_struct cinfo;
+    JpegError error;
+    cinfo.err = &error.mgr;
+    InitJpegError(&error);
+    if (setjmp(error.jump)) {
+        jpeg_destroy_decompress(&cinfo);
+        return false;
+    }
+
+    jpeg_create_decompress(&cinfo);
+    jpeg_mem_src(&cinfo, data, static_cast<unsigned long>(len));
+    if (jpeg_read_header(&cinfo, TRUE) != JPEG_HEADER_OK ||
+        static_cast<uint64_t>(cinfo.image_width) * cinfo.image_height > kImageMaxPixels) {
+        jpeg_destroy_decompress(&cinfo);
+        return false;
+    }
+    if (cinfo.jpeg_color_space == JCS_GRAYSCALE) {
+        cinfo.out_color_space = JCS_GRAYSCALE;
+    } else if (cinfo.jpeg_color_space == JCS_YCbCr || cinfo.jpeg_color_space == JCS_RGB) {
+        cinfo.out_color_space = JCS_RGB;
+    } else {
+        jpeg_destroy_decompress(&cinfo);  // CMYK / YCCK
+        return false;
+    }
+
+    uint32_t width, height;
+    TargetSize(cinfo.image_width, cinfo.image_height, options, &width, &height);
+    if (static_cast<uint64_t>(width) * height > kImageMaxPixels) {
+        jpeg_destroy_decompress(&cinfo);
+        return false;
+    }
+
+    // The largest DCT-domain reduction that still leaves at least the target
+    cinfo.scale_num = 1;
+    cinfo.scale_denom = 1;
+    for (unsigned denom : {8u, 4u, 2u}) {
+        if ((cinfo.image_width + denom - 1) / denom >= width && (cinfo.image_height + denom - 1) / denom >= height) {
+            cinfo.scale_denom = denom;
+            break;
+        }
+    }
+    cinfo.dct_method = JDCT_ISLOW;
+
+    jpeg_start_decompress(&cinfo);
+    int channels = cinfo.output_components;
+    bool transposed = orientation >= 5;
+    out->width = transposed ? height : width;
+    out->height = transposed ? width : height;
+    out->channels = channels;
+    out->data.resize(static_cast<size_t>(width) * height * channels);
+    buffers->resampler = std::make_unique<Resampler>(cinfo.output_width, cinfo.output_height, width, height,
+                                                     channels, orientation, out->data.data());
+
+    while (cinfo.output_scanline < cinfo.output_height) {
+        JSAMPROW row = buffers->resampler->NextRow();
+        if (jpeg_read_scanlines(&cinfo, &row, 1) != 1) {
+            break;
+        }
+        buffers->resampler->RowReady();
+    }
+
+    // Trailing data is not needed; skip jpeg_finish_decompress
+    jpeg_destroy_decompress(&cinfo);
+    return true;
+}
+
+bool Encode(const Pixels& pixels, int quality, std::vector<uint8_t>* out) {
+    jpeg_compress_struct cinfo;
+    JpegError error;
+    VectorDestination dest;  // trivially destructible
+    cinfo.err = &error.mgr;
+    InitJpegError(&error);
+    if (setjmp(error.jump)) {
+        jpeg_destroy_compress(&cinfo);
+        return false;
+    }
+
+    jpeg_create_compress(&cinfo);
+    dest.mgr.init_destination = InitDestination;
+    dest.mgr.empty_output_buffer = EmptyOutputBuffer;
+    dest.mgr.term_destination = TermDestination;
+    dest.out = out;
+    cinfo.dest = &dest.mgr;
+
+    cinfo.image_width = pixels.width;
+    cinfo.image_height = pixels.height;
+    cinfo.input_components = pixels.channels;
+    cinfo.in_color_space = pixels.channels == 1 ? JCS_GRAYSCALE : JCS_RGB;
+    jpeg_set_defaults(&cinfo);
+    jpeg_set_quality(&cinfo, quality, TRUE);
+    cinfo.optimize_coding = TRUE;  // Huffman tables fitted to this image
+    cinfo.dct_method = JDCT_ISLOW;
+
+    jpeg_start_compress(&cinfo, TRUE);
+    size_t stride = static_cast<size_t>(pixels.width) * pixels.channels;
+    while (cinfo.next_scanline < cinfo.image_height) {
+        JSAMPROW row = const_cast<uint8_t*>(&pixels.data[cinfo.next_scanline * stride]);
+        jpeg_write_scanlines(&cinfo, &row, 1);
+    }
+    jpeg_finish_compress(&cinfo);
+    jpeg_destroy_compress(&cinfo);
+    return true;
+}
+
+}  // namespace
+
+bool ResizeJpeg(const uint8_t* data, size_t len, const ImageResizeOptions& options, EncodedImage* out) {
+    if (len < 3 || data[0] != 0xff || data[1] != 0xd8 || data[2] != 0xff) {
+        return false;
+    }
+
+    uint32_t orientation = 1;
+    if (options.auto_orient) {
+        MediaProbeInput input;
+        input.head = data;
+        input.head_len = len;
+        input.size = len;
+        MediaProbeResult probe;
+        if (ProbeMedia(input, &probe) && probe.orientation != 0) {
+            orientation = probe.orientation;
+        }
+    }
+
+    Pixels pixels;
+    DecodeBuffers buffers;
+    if (!DecodeResized(data, len, options, orientation, &buffers, &pixels)) {
+        return false;
+    }
+    out->data.clear();
+    if (!Encode(pixels, std::min(std::max(options.quality, 1), 100), &out->data)) {
+        return false;
+    }
+    out->width = pixels.width;
+    out->height = pixels.height;
+    return true;
+}
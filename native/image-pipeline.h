@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// In-memory JPEG resize: decode -> resize -> orient -> encode. N-API free.
+//
+// Built only against libjpeg-turbo (OPENCLAW_HAVE_JPEG). The decoder scales
+// by 1/2, 1/4 or 1/8 in the DCT domain while the result is still at least the
+// target size; the remaining step is a separable Lanczos-3 resample run on
+// scanlines as they are decoded, so only a few rows of the source are ever
+// held. EXIF orientation is applied as resized rows are stored.
+
+struct ImageResizeOptions {
+    uint32_t max_side = 0;  // fit inside max_side x max_side; 0 = keep the size
+    int quality = 80;
+    bool without_enlargement = true;
+    bool auto_orient = true;  // apply and drop the EXIF orientation
+};
+
+struct EncodedImage {
+    std::vector<uint8_t> data;
+    uint32_t width = 0;
+    uint32_t height = 0;
+};
+
+// Larger inputs are left to the caller (sharp's default limitInputPixels)
+static constexpr uint64_t kImageMaxPixels = 0x3FFFULL * 0x3FFFULL;
+
+// False when the input is not a JPEG this pipeline handles (CMYK, over
+// kImageMaxPixels) or libjpeg gives up on it; the caller should fall back.
+bool ResizeJpeg(const uint8_t* data, size_t len, const ImageResizeOptions& options, EncodedImage* out);
@@ -0,0 +1,333 @@
+#include <napi.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+#include "bm25-index.h"
+#include "op-stats.h"
+
+// BM25 keyword index over Bm25Index, with keyword + vector fusion in one
+// call (hybrid). Synchronous: queries are sub-millisecond.
+class KeywordIndex : public Napi::ObjectWrap<KeywordIndex> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    KeywordIndex(const Napi::CallbackInfo& info);
+
+private:
+    static Napi::FunctionReference constructor;
+
+    Napi::Value Add(const Napi::CallbackInfo& info);
+    Napi::Value AddMany(const Napi::CallbackInfo& info);
+    Napi::Value Remove(const Napi::CallbackInfo& info);
+    Napi::Value Has(const Napi::CallbackInfo& info);
+    Napi::Value Clear(const Napi::CallbackInfo& info);
+
+    Napi::Value Search(const Napi::CallbackInfo& info);
+    Napi::Value Hybrid(const Napi::CallbackInfo& info);
+
+    Napi::Value GetSize(const Napi::CallbackInfo& info);
+    Napi::Value GetTerms(const Napi::CallbackInfo& info);
+    Napi::Value GetPostingBytes(const Napi::CallbackInfo& info);
+
+    bool ReadQuery(const Napi::CallbackInfo& info, std::string* query, Bm25Index::QueryOptions* options);
+
+    std::unique_ptr<Bm25Index> index_;
+};
+
+Napi::FunctionReference KeywordIndex::constructor;
+
+Napi::Object KeywordIndex::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "KeywordIndex", {
+        InstanceMethod("add", &KeywordIndex::Add),
+        InstanceMethod("addMany", &KeywordIndex::AddMany),
+        InstanceMethod("remove", &KeywordIndex::Remove),
+        InstanceMethod("has", &KeywordIndex::Has),
+        InstanceMethod("clear", &KeywordIndex::Clear),
+        InstanceMethod("search", &KeywordIndex::Search),
+        InstanceMethod("hybrid", &KeywordIndex::Hybrid),
+        InstanceAccessor("size", &KeywordIndex::GetSize, nullptr),
+        InstanceAccessor("terms", &KeywordIndex::GetTerms, nullptr),
+        InstanceAccessor("postingBytes", &KeywordIndex::GetPostingBytes, nullptr),
+    });
+
+    constructor = Napi::Persistent(func);
+    constructor.SuppressDestruct();
+
+    exports.Set("KeywordIndex", func);
+    return exports;
+}
+
+static bool IsFloat32Array(const Napi::Value& value) {
+    return value.IsTypedArray() && value.As<Napi::TypedArray>().TypedArrayType() == napi_float32_array;
+}
+
+// Reads an optional non-negative number option; false (after throwing) if invalid
+static bool ReadNumberOption(Napi::Env env, const Napi::Object& options, const char* name, double* out) {
+    Napi::Value value = options.Get(name);
+    if (value.IsUndefined()) {
+        return true;
+    }
+    if (!value.IsNumber() || !(value.As<Napi::Number>().DoubleValue() >= 0)) {
+        Napi::TypeError::New(env, std::string(name) + " must be a non-negative number").ThrowAsJavaScriptException();
+        return false;
+    }
+    *out = value.As<Napi::Number>().DoubleValue();
+    return true;
+}
+
+// Reads an array of strings; false (after throwing) if it is not one
+static bool ReadStrings(Napi::Env env, const Napi::Value& value, const char* name, std::vector<std::string>* out) {
+    if (!value.IsArray()) {
+        Napi::TypeError::New(env, std::string(name) + " must be an array of strings").ThrowAsJavaScriptException();
+        return false;
+    }
+    Napi::Array list = value.As<Napi::Array>();
+    out->reserve(list.Length());
+    for (uint32_t i = 0; i < list.Length(); i++) {
+        Napi::Value item = list.Get(i);
+        if (!item.IsString()) {
+            Napi::TypeError::New(env, std::string(name) + " must be an array of strings").ThrowAsJavaScriptException();
+            return false;
+        }
+        out->push_back(item.As<Napi::String>().Utf8Value());
+    }
+    return true;
+}
+
+// new KeywordIndex({ k1?, b? })
+KeywordIndex::KeywordIndex(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<KeywordIndex>(info) {
+    Napi::Env env = info.Env();
+
+    Bm25Params params;
+    if (info.Length() > 0 && !info[0].IsUndefined()) {
+        if (!info[0].IsObject()) {
+            Napi::TypeError::New(env, "Expected ({ k1?, b? })").ThrowAsJavaScriptException();
+            return;
+        }
+        Napi::Object options = info[0].As<Napi::Object>();
+        double k1 = params.k1;
+        double b = params.b;
+        if (!ReadNumberOption(env, options, "k1", &k1) || !ReadNumberOption(env, options, "b", &b)) {
+            return;
+        }
+        if (b > 1) {
+            Napi::RangeError::New(env, "b must be between 0 and 1").ThrowAsJavaScriptException();
+            return;
+        }
+        params.k1 = static_cast<float>(k1);
+        params.b = static_cast<float>(b);
+    }
+    index_ = std::make_unique<Bm25Index>(params);
+}
+
+// add(id, text, tag?): indexes or replaces a document
+Napi::Value KeywordIndex::Add(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsString() || !info[1].IsString() ||
+        (info.Length() > 2 && !info[2].IsUndefined() && !info[2].IsString())) {
+        Napi::TypeError::New(env, "Expected (id, text, tag?)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    std::string text = info[1].As<Napi::String>().Utf8Value();
+    std::string tag = info.Length() > 2 && info[2].IsString() ? info[2].As<Napi::String>().Utf8Value() : "";
+    if (!index_->Add(info[0].As<Napi::String>().Utf8Value(), text.data(), text.size(), tag)) {
+        Napi::RangeError::New(env, "Too many distinct tags").ThrowAsJavaScriptException();
+    }
+    return env.Undefined();
+}
+
+// addMany(ids, texts, tags?)
+Napi::Value KeywordIndex::AddMany(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2) {
+        Napi::TypeError::New(env, "Expected (ids, texts, tags?)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    std::vector<std::string> ids, texts, tags;
+    if (!ReadStrings(env, info[0], "ids", &ids) || !ReadStrings(env, info[1], "texts", &texts)) {
+        return env.Null();
+    }
+    if (info.Length() > 2 && !info[2].IsUndefined() && !ReadStrings(env, info[2], "tags", &tags)) {
+        return env.Null();
+    }
+    if (texts.size() != ids.size() || (!tags.empty() && tags.size() != ids.size())) {
+        Napi::RangeError::New(env, "ids, texts and tags must have the same length").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    static const std::string kNoTag;
+    for (size_t i = 0; i < ids.size(); i++) {
+        if (!index_->Add(ids[i], texts[i].data(), texts[i].size(), tags.empty() ? kNoTag : tags[i])) {
+            Napi::RangeError::New(env, "Too many distinct tags").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+    }
+    return env.Undefined();
+}
+
+Napi::Value KeywordIndex::Remove(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected id").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    return Napi::Boolean::New(env, index_->Remove(info[0].As<Napi::String>().Utf8Value()));
+}
+
+Napi::Value KeywordIndex::Has(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected id").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    return Napi::Boolean::New(env, index_->Has(info[0].As<Napi::String>().Utf8Value()));
+}
+
+Napi::Value KeywordIndex::Clear(const Napi::CallbackInfo& info) {
+    index_->Clear();
+    return info.Env().Undefined();
+}
+
+// Reads (query, { k, mode?: "all" | "any", tags? }); shared by search/hybrid
+bool KeywordIndex::ReadQuery(const Napi::CallbackInfo& info, std::string* query, Bm25Index::QueryOptions* options) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsString() || !info[1].IsObject()) {
+        Napi::TypeError::New(env, "Expected (query, { k, mode?, tags? })").ThrowAsJavaScriptException();
+        return false;
+    }
+    *query = info[0].As<Napi::String>().Utf8Value();
+    Napi::Object opts = info[1].As<Napi::Object>();
+
+    Napi::Value k = opts.Get("k");
+    if (!k.IsNumber() || !(k.As<Napi::Number>().DoubleValue() >= 0)) {
+        Napi::TypeError::New(env, "k must be a non-negative number").ThrowAsJavaScriptException();
+        return false;
+    }
+    options->k = static_cast<size_t>(std::min(k.As<Napi::Number>().DoubleValue(), 4294967295.0));
+
+    Napi::Value mode = opts.Get("mode");
+    if (!mode.IsUndefined()) {
+        std::string name = mode.IsString() ? mode.As<Napi::String>().Utf8Value() : "";
+        if (name != "all" && name != "any") {
+            Napi::TypeError::New(env, "mode must be \"all\" or \"any\"").ThrowAsJavaScriptException();
+            return false;
+        }
+        options->match_all = name == "all";
+    }
+
+    Napi::Value tags = opts.Get("tags");
+    return tags.IsUndefined() || ReadStrings(env, tags, "tags", &options->tags);
+}
+
+// search(query, { k, mode?, tags? }): { ids, scores: Float32Array } with raw
+// BM25 scores, best first
+Napi::Value KeywordIndex::Search(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    std::string query;
+    Bm25Index::QueryOptions options;
+    if (!ReadQuery(info, &query, &options)) {
+        return env.Null();
+    }
+
+    OpScope scope(NativeOp::kKeywordSearch, query.size());
+    std::vector<Bm25Index::Hit> hits = index_->Search(query.data(), query.size(), options);
+    Napi::Array ids = Napi::Array::New(env, hits.size());
+    Napi::Float32Array scores = Napi::Float32Array::New(env, hits.size());
+    float* out = scores.Data();
+    for (size_t i = 0; i < hits.size(); i++) {
+        ids.Set(static_cast<uint32_t>(i), Napi::String::New(env, index_->Id(hits[i].doc)));
+        out[i] = hits[i].score;
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("ids", ids);
+    result.Set("scores", scores);
+    return result;
+}
+
+// hybrid(query, { k, mode?, tags?, vectorIds, vectorScores: Float32Array,
+//                 vectorWeight, textWeight, limit? })
+//   -> { ids, scores, textScores, vectorScores } (Float32Arrays), best first
+//
+// Fuses the keyword top-k with the given vector hits; textScores are
+// bm25 / (1 + bm25), and vector hits outside the keyword top-k still get
+// their exact text score. limit defaults to k.
+Napi::Value KeywordIndex::Hybrid(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    std::string query;
+    Bm25Index::QueryOptions options;
+    if (!ReadQuery(info, &query, &options)) {
+        return env.Null();
+    }
+    Napi::Object opts = info[1].As<Napi::Object>();
+
+    std::vector<std::string> vector_ids;
+    Napi::Value vector_scores = opts.Get("vectorScores");
+    if (!ReadStrings(env, opts.Get("vectorIds"), "vectorIds", &vector_ids)) {
+        return env.Null();
+    }
+    if (!IsFloat32Array(vector_scores) ||
+        vector_scores.As<Napi::Float32Array>().ElementLength() != vector_ids.size()) {
+        Napi::TypeError::New(env, "vectorScores must be a Float32Array as long as vectorIds")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    double vector_weight = -1, text_weight = -1, limit = static_cast<double>(options.k);
+    if (!ReadNumberOption(env, opts, "vectorWeight", &vector_weight) ||
+        !ReadNumberOption(env, opts, "textWeight", &text_weight) || !ReadNumberOption(env, opts, "limit", &limit)) {
+        return env.Null();
+    }
+    if (vector_weight < 0 || text_weight < 0) {
+        Napi::TypeError::New(env, "vectorWeight and textWeight are required").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    std::vector<Bm25Index::FusedHit> hits = index_->Hybrid(
+        query.data(), query.size(), options, vector_ids, vector_scores.As<Napi::Float32Array>().Data(),
+        static_cast<float>(vector_weight), static_cast<float>(text_weight),
+        static_cast<size_t>(std::min(limit, 4294967295.0)));
+
+    Napi::Array ids = Napi::Array::New(env, hits.size());
+    Napi::Float32Array scores = Napi::Float32Array::New(env, hits.size());
+    Napi::Float32Array text_scores = Napi::Float32Array::New(env, hits.size());
+    Napi::Float32Array vec_scores = Napi::Float32Array::New(env, hits.size());
+    for (size_t i = 0; i < hits.size(); i++) {
+        ids.Set(static_cast<uint32_t>(i), Napi::String::New(env, hits[i].id));
+        scores.Data()[i] = hits[i].score;
+        text_scores.Data()[i] = hits[i].text_score;
+        vec_scores.Data()[i] = hits[i].vector_score;
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("ids", ids);
+    result.Set("scores", scores);
+    result.Set("textScores", text_scores);
+    result.Set("vectorScores", vec_scores);
+    return result;
+}
+
+Napi::Value KeywordIndex::GetSize(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), static_cast<double>(index_->Size()));
+}
+
+Napi::Value KeywordIndex::GetTerms(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), static_cast<double>(index_->Terms()));
+}
+
+Napi::Value KeywordIndex::GetPostingBytes(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), static_cast<double>(index_->PostingBytes()));
+}
+
+// Module initialization
+Napi::Object InitKeywordIndex(Napi::Env env, Napi::Object exports) {
+    return KeywordIndex::Init(env, exports);
+}
@@ -1,13 +1,101 @@
 #include <napi.h>
+#include "addon-data.h"
 
 // Forward declarations from other modules
 Napi::Object InitBufferOps(Napi::Env env, Napi::Object exports);
+Napi::Object InitBufferPool(Napi::Env env, Napi::Object exports);
 Napi::Object InitSimdOps(Napi::Env env, Napi::Object exports);
+Napi::Object InitMultiMatcher(Napi::Env env, Napi::Object exports);
+Napi::Object InitVectorIndex(Napi::Env env, Napi::Object exports);
+Napi::Object InitHnswIndex(Napi::Env env, Napi::Object exports);
+Napi::Object InitTextOps(Napi::Env env, Napi::Object exports);
+Napi::Object InitFileOps(Napi::Env env, Napi::Object exports);
+Napi::Object InitMediaOps(Napi::Env env, Napi::Object exports);
+Napi::Object InitAudioOps(Napi::Env env, Napi::Object exports);
+Napi::Object InitStatsOps(Napi::Env env, Napi::Object exports);
+Napi::Object InitRateLimitTable(Napi::Env env, Napi::Object exports);
+Napi::Object InitTtlCache(Napi::Env env, Napi::Object exports);
+Napi::Object InitGroupHistory(Napi::Env env, Napi::Object exports);
+Napi::Object InitKeywordIndex(Napi::Env env, Napi::Object exports);
+Napi::Object InitEmbeddingCache(Napi::Env env, Napi::Object exports);
+Napi::Object InitEventBus(Napi::Env env, Napi::Object exports);
+Napi::Object InitTokenizer(Napi::Env env, Napi::Object exports);
+#ifdef OPENCLAW_HAVE_ZSTD
+Napi::Object InitZstdOps(Napi::Env env, Napi::Object exports);
+#endif
+
+// Stateless ops, also reachable as BufferOps / SimdOps methods
+Napi::Value BufferCompare(const Napi::CallbackInfo& info);
+Napi::Value BufferBulkCopy(const Napi::CallbackInfo& info);
+Napi::Value SimdSumUint8(const Napi::CallbackInfo& info);
+Napi::Value SimdFindPattern(const Napi::CallbackInfo& info);
+Napi::Value SimdFindAll(const Napi::CallbackInfo& info);
+Napi::Value SimdCount(const Napi::CallbackInfo& info);
+Napi::Value SimdAndBuffers(const Napi::CallbackInfo& info);
+
+// Promise-returning variants (AsyncWorker + native thread pool)
+Napi::Value BufferCompareAsync(const Napi::CallbackInfo& info);
+Napi::Value BufferBulkCopyAsync(const Napi::CallbackInfo& info);
+Napi::Value SimdSumUint8Async(const Napi::CallbackInfo& info);
+Napi::Value SimdFindPatternAsync(const Napi::CallbackInfo& info);
+Napi::Value SimdCountAsync(const Napi::CallbackInfo& info);
+Napi::Value SimdAndBuffersAsync(const Napi::CallbackInfo& info);
+
+// Vector search (SimdOps)
+Napi::Value SimdTopK(const Napi::CallbackInfo& info);
+Napi::Value SimdTopKAsync(const Napi::CallbackInfo& info);
+Napi::Value SimdToFloat16(const Napi::CallbackInfo& info);
+Napi::Value SimdQuantizeInt8(const Napi::CallbackInfo& info);
+
+AddonData* GetAddonData(Napi::Env env) {
+    return env.GetInstanceData<AddonData>();
+}
 
 // Main module initialization
 Napi::Object InitAll(Napi::Env env, Napi::Object exports) {
+    env.SetInstanceData(new AddonData());
+
     InitBufferOps(env, exports);
+    InitBufferPool(env, exports);
     InitSimdOps(env, exports);
+    InitMultiMatcher(env, exports);
+    InitVectorIndex(env, exports);
+    InitHnswIndex(env, exports);
+    InitTextOps(env, exports);
+    InitFileOps(env, exports);
+    InitMediaOps(env, exports);
+    InitAudioOps(env, exports);
+    InitStatsOps(env, exports);
+    InitRateLimitTable(env, exports);
+    InitTtlCache(env, exports);
+    InitGroupHistory(env, exports);
+    InitKeywordIndex(env, exports);
+    InitEmbeddingCache(env, exports);
+    InitEventBus(env, exports);
+    InitTokenizer(env, exports);
+#ifdef OPENCLAW_HAVE_ZSTD
+    InitZstdOps(env, exports);
+#endif
+
+    // Module-level fast paths: no wrapper object to construct per call.
+    // (V8 fast API calls cannot be registered through N-API.)
+    exports.Set("compare", Napi::Function::New<BufferCompare>(env, "compare"));
+    exports.Set("bulkCopy", Napi::Function::New<BufferBulkCopy>(env, "bulkCopy"));
+    exports.Set("sumUint8", Napi::Function::New<SimdSumUint8>(env, "sumUint8"));
+    exports.Set("findPattern", Napi::Function::New<SimdFindPattern>(env, "findPattern"));
+    exports.Set("findAll", Napi::Function::New<SimdFindAll>(env, "findAll"));
+    exports.Set("count", Napi::Function::New<SimdCount>(env, "count"));
+    exports.Set("andBuffers", Napi::Function::New<SimdAndBuffers>(env, "andBuffers"));
+    exports.Set("compareAsync", Napi::Function::New<BufferCompareAsync>(env, "compareAsync"));
+    exports.Set("bulkCopyAsync", Napi::Function::New<BufferBulkCopyAsync>(env, "bulkCopyAsync"));
+    exports.Set("sumUint8Async", Napi::Function::New<SimdSumUint8Async>(env, "sumUint8Async"));
+    exports.Set("findPatternAsync", Napi::Function::New<SimdFindPatternAsync>(env, "findPatternAsync"));
+    exports.Set("countAsync", Napi::Function::New<SimdCountAsync>(env, "countAsync"));
+    exports.Set("andBuffersAsync", Napi::Function::New<SimdAndBuffersAsync>(env, "andBuffersAsync"));
+    exports.Set("topK", Napi::Function::New<SimdTopK>(env, "topK"));
+    exports.Set("topKAsync", Napi::Function::New<SimdTopKAsync>(env, "topKAsync"));
+    exports.Set("toFloat16", Napi::Function::New<SimdToFloat16>(env, "toFloat16"));
+    exports.Set("quantizeInt8", Napi::Function::New<SimdQuantizeInt8>(env, "quantizeInt8"));
     return exports;
 }
 
@@ -0,0 +1,346 @@
+#include "markdown-chunker.h"
+#include "cpu-features.h"
+
+#include <algorithm>
+#include <mutex>
+
+#if defined(HAS_X86_SIMD)
+  #include <immintrin.h>
+#elif defined(HAS_ARM_SIMD)
+  #include <arm_neon.h>
+#endif
+
+// First position at or after `from` holding '\n' or a non-ASCII byte, or len.
+// Everything the scan skips is ASCII text, one UTF-16 unit per byte.
+using LineStopFn = size_t (*)(const uint8_t* data, size_t len, size_t from);
+
+static size_t FindLineStopScalar(const uint8_t* data, size_t len, size_t from) {
+    for (size_t i = from; i < len; i++) {
+        if (data[i] == '\n' || data[i] >= 0x80) {
+            return i;
+        }
+    }
+    return len;
+}
+
+#if defined(HAS_X86_DISPATCH)
+
+OPENCLAW_TARGET("sse2")
+static size_t FindLineStopSse2(const uint8_t* data, size_t len, size_t from) {
+    const __m128i newline = _mm_set1_epi8('\n');
+    size_t i = from;
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        unsigned mask = static_cast<unsigned>(
+            _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, newline), v)));
+        if (mask != 0) {
+            return i + static_cast<size_t>(__builtin_ctz(mask));
+        }
+    }
+    return FindLineStopScalar(data, len, i);
+}
+
+OPENCLAW_TARGET("avx2")
+static size_t FindLineStopAvx2(const uint8_t* data, size_t len, size_t from) {
+    const __m256i newline = _mm256_set1_epi8('\n');
+    size_t i = from;
+    for (; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        unsigned mask = static_cast<unsigned>(
+            _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v, newline), v)));
+        if (mask != 0) {
+            return i + static_cast<size_t>(__builtin_ctz(mask));
+        }
+    }
+    return FindLineStopSse2(data, len, i);
+}
+
+OPENCLAW_TARGET("avx512f,avx512bw")
+static size_t FindLineStopAvx512(const uint8_t* data, size_t len, size_t from) {
+    const __m512i newline = _mm512_set1_epi8('\n');
+    size_t i = from;
+    for (; i + 64 <= len; i += 64) {
+        __m512i v = _mm512_loadu_si512(data + i);
+        uint64_t mask = _mm512_cmpeq_epi8_mask(v, newline) | _mm512_movepi8_mask(v);
+        if (mask != 0) {
+            return i + static_cast<size_t>(__builtin_ctzll(mask));
+        }
+    }
+    return FindLineStopAvx2(data, len, i);
+}
+
+#endif  // HAS_X86_DISPATCH
+
+#if defined(HAS_ARM_SIMD)
+
+static size_t FindLineStopNeon(const uint8_t* data, size_t len, size_t from) {
+    const uint8x16_t newline = vdupq_n_u8('\n');
+    const uint8x16_t high = vdupq_n_u8(0x80);
+    size_t i = from;
+    for (; i + 16 <= len; i += 16) {
+        uint8x16_t v = vld1q_u8(data + i);
+        uint8x16_t hit = vorrq_u8(vceqq_u8(v, newline), vcgeq_u8(v, high));
+        // Narrow to a 64-bit mask with one nibble per byte lane
+        uint64_t mask = vget_lane_u64(
+            vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(hit), 4)), 0);
+        if (mask != 0) {
+            return i + (static_cast<size_t>(__builtin_ctzll(mask)) >> 2);
+        }
+    }
+    return FindLineStopScalar(data, len, i);
+}
+
+#endif  // HAS_ARM_SIMD
+
+static LineStopFn line_stop_impl = FindLineStopScalar;
+
+static void SelectLineStop() {
+#if defined(HAS_X86_DISPATCH)
+    const CpuFeatures& cpu = GetCpuFeatures();
+    if (cpu.avx512bw) {
+        line_stop_impl = FindLineStopAvx512;
+    } else if (cpu.avx2) {
+        line_stop_impl = FindLineStopAvx2;
+    } else if (cpu.sse2) {
+        line_stop_impl = FindLineStopSse2;
+    }
+#elif defined(HAS_ARM_SIMD)
+    line_stop_impl = FindLineStopNeon;
+#endif
+}
+
+void InitMarkdownChunker() {
+    InitSha256();
+    static std::once_flag once;
+    std::call_once(once, SelectLineStop);
+}
+
+// Length of the well-formed UTF-8 sequence starting at p (lead byte >= 0x80),
+// or 0 when it is malformed: overlong, surrogate, above U+10FFFF, truncated.
+static size_t DecodeUtf8(const uint8_t* p, size_t avail, uint32_t* cp) {
+    uint8_t b0 = p[0];
+    size_t n;
+    uint8_t lo = 0x80, hi = 0xbf;
+    if (b0 >= 0xc2 && b0 <= 0xdf) {
+        n = 2;
+        *cp = b0 & 0x1f;
+    } else if (b0 >= 0xe0 && b0 <= 0xef) {
+        n = 3;
+        *cp = b0 & 0x0f;
+        if (b0 == 0xe0) lo = 0xa0;
+        if (b0 == 0xed) hi = 0x9f;
+    } else if (b0 >= 0xf0 && b0 <= 0xf4) {
+        n = 4;
+        *cp = b0 & 0x07;
+        if (b0 == 0xf0) lo = 0x90;
+        if (b0 == 0xf4) hi = 0x8f;
+    } else {
+        return 0;
+    }
+    if (avail < n || p[1] < lo || p[1] > hi) {
+        return 0;
+    }
+    for (size_t i = 1; i < n; i++) {
+        if ((p[i] & 0xc0) != 0x80) {
+            return 0;
+        }
+        *cp = (*cp << 6) | (p[i] & 0x3f);
+    }
+    return n;
+}
+
+// String.prototype.trim() set: WhiteSpace and LineTerminator code points
+static bool IsJsWhitespace(uint32_t cp) {
+    if (cp < 0x80) {
+        return cp == ' ' || (cp >= 0x09 && cp <= 0x0d);
+    }
+    return cp == 0x00a0 || cp == 0x1680 || (cp >= 0x2000 && cp <= 0x200a) || cp == 0x2028 ||
+           cp == 0x2029 || cp == 0x202f || cp == 0x205f || cp == 0x3000 || cp == 0xfeff;
+}
+
+// Input is already validated, so the sequence length follows from the lead
+static inline size_t SequenceLength(uint8_t lead) {
+    return lead < 0x80 ? 1 : lead >= 0xf0 ? 4 : lead >= 0xe0 ? 3 : 2;
+}
+
+namespace {
+
+struct Segment {
+    uint32_t start;
+    uint32_t end;
+    uint32_t line;
+    size_t units;
+};
+
+class Chunker {
+public:
+    Chunker(const uint8_t* data, const MarkdownChunkOptions& options, MarkdownChunks* out)
+        : data_(data), out_(out) {
+        // Clamped well below overflow; no input can fill a larger budget
+        int64_t tokens = std::min<int64_t>(std::max<int64_t>(options.tokens, 0), INT64_C(1) << 40);
+        int64_t overlap = std::min<int64_t>(std::max<int64_t>(options.overlap, 0), INT64_C(1) << 40);
+        max_chars_ = static_cast<size_t>(std::max<int64_t>(32, tokens * 4));
+        overlap_chars_ = static_cast<size_t>(overlap * 4);
+    }
+
+    // One source line, without its '\n'; units is its UTF-16 length
+    bool AddLine(uint32_t start, uint32_t end, size_t units, uint32_t line) {
+        if (units <= max_chars_) {
+            AddSegment({start, end, line, units});
+            return true;
+        }
+
+        // Cut into max_chars_ units, like line.slice(k * maxChars, ...)
+        uint32_t seg_start = start;
+        size_t seg_units = 0;
+        for (uint32_t p = start; p < end;) {
+            size_t n = SequenceLength(data_[p]);
+            size_t width = n == 4 ? 2 : 1;
+            if (seg_units + width > max_chars_) {
+                if (seg_units < max_chars_) {
+                    // JS would leave half a surrogate pair on each side
+                    return false;
+                }
+                AddSegment({seg_start, p, line, seg_units});
+                out_->breaks.push_back(p);
+                seg_start = p;
+                seg_units = 0;
+            }
+            seg_units += width;
+            p += static_cast<uint32_t>(n);
+        }
+        AddSegment({seg_start, end, line, seg_units});
+        return true;
+    }
+
+    void Finish() {
+        Flush();
+    }
+
+private:
+    void AddSegment(const Segment& segment) {
+        size_t size = segment.units + 1;
+        if (current_chars_ + size > max_chars_ && !current_.empty()) {
+            Flush();
+            CarryOverlap();
+        }
+        current_.push_back(segment);
+        current_chars_ += size;
+    }
+
+    void Flush() {
+        if (current_.empty()) {
+            return;
+        }
+        const Segment& first = current_.front();
+        const Segment& last = current_.back();
+        out_->starts.push_back(first.start);
+        out_->ends.push_back(last.end);
+        out_->start_lines.push_back(first.line);
+        out_->end_lines.push_back(last.line);
+        out_->blank.push_back(IsBlank(first.start, last.end) ? 1 : 0);
+
+        // Segments of different lines are separated by the source '\n';
+        // segments of one cut line abut and get a synthetic one
+        hasher_.Reset();
+        uint32_t run_start = first.start;
+        for (size_t i = 1; i < current_.size(); i++) {
+            if (current_[i].start == current_[i - 1].end) {
+                hasher_.Update(data_ + run_start, current_[i].start - run_start);
+                hasher_.Update("\n", 1);
+                run_start = current_[i].start;
+            }
+        }
+        hasher_.Update(data_ + run_start, last.end - run_start);
+
+        size_t offset = out_->hashes.size();
+        out_->hashes.resize(offset + kSha256DigestSize);
+        hasher_.Final(out_->hashes.data() + offset);
+    }
+
+    void CarryOverlap() {
+        if (overlap_chars_ == 0 || current_.empty()) {
+            current_.clear();
+            current_chars_ = 0;
+            return;
+        }
+        size_t acc = 0;
+        size_t keep_from = current_.size();
+        while (keep_from > 0) {
+            keep_from--;
+            acc += current_[keep_from].units + 1;
+            if (acc >= overlap_chars_) {
+                break;
+            }
+        }
+        current_.erase(current_.begin(), current_.begin() + static_cast<ptrdiff_t>(keep_from));
+        current_chars_ = acc;
+    }
+
+    bool IsBlank(uint32_t start, uint32_t end) const {
+        for (uint32_t p = start; p < end;) {
+            uint32_t cp = data_[p];
+            size_t n = 1;
+            if (cp >= 0x80) {
+                n = DecodeUtf8(data_ + p, end - p, &cp);
+            }
+            if (!IsJsWhitespace(cp)) {
+                return false;
+            }
+            p += static_cast<uint32_t>(n);
+        }
+        return true;
+    }
+
+    const uint8_t* data_;
+    MarkdownChunks* out_;
+    size_t max_chars_;
+    size_t overlap_chars_;
+    std::vector<Segment> current_;
+    size_t current_chars_ = 0;
+    Sha256 hasher_;
+};
+
+}  // namespace
+
+bool ChunkMarkdown(const uint8_t* data, size_t len, const MarkdownChunkOptions& options,
+                   MarkdownChunks* out) {
+    *out = MarkdownChunks();
+    if (len >= UINT32_MAX) {
+        return false;
+    }
+
+    Chunker chunker(data, options, out);
+    size_t pos = 0;
+    uint32_t line = 0;
+    // content.split("\n"): n newlines make n + 1 lines, the last maybe empty
+    for (;;) {
+        line++;
+        size_t start = pos;
+        // Bytes beyond one UTF-16 unit in the multibyte sequences seen
+        size_t extra = 0;
+        for (;;) {
+            pos = line_stop_impl(data, len, pos);
+            if (pos >= len || data[pos] == '\n') {
+                break;
+            }
+            uint32_t cp;
+            size_t n = DecodeUtf8(data + pos, len - pos, &cp);
+            if (n == 0) {
+                return false;
+            }
+            extra += n == 4 ? 2 : n - 1;
+            pos += n;
+        }
+        if (!chunker.AddLine(static_cast<uint32_t>(start), static_cast<uint32_t>(pos),
+                             pos - start - extra, line)) {
+            return false;
+        }
+        if (pos >= len) {
+            break;
+        }
+        pos++;
+    }
+    chunker.Finish();
+    return true;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "sha256.h"
+
+// Line-based chunking of UTF-8 markdown for memory indexing.
+//
+// Reproduces chunkMarkdown() in src/memory/internal.ts exactly: budgets are
+// counted in UTF-16 code units (what String.length measures), lines longer
+// than the budget are cut into budget-sized segments, and consecutive chunks
+// share trailing segments up to the overlap budget. A chunk's text is the
+// input range [start, end) with a "\n" inserted at every segment break inside
+// it; hashes are SHA-256 over that text, matching hashText().
+
+struct MarkdownChunkOptions {
+    int64_t tokens = 0;
+    int64_t overlap = 0;
+};
+
+struct MarkdownChunks {
+    // Per chunk: byte range, 1-based line numbers, whitespace-only flag
+    std::vector<uint32_t> starts;
+    std::vector<uint32_t> ends;
+    std::vector<uint32_t> start_lines;
+    std::vector<uint32_t> end_lines;
+    std::vector<uint8_t> blank;
+    // kSha256DigestSize bytes per chunk
+    std::vector<uint8_t> hashes;
+    // Ascending byte offsets where an over-long line was cut into segments
+    std::vector<uint32_t> breaks;
+
+    size_t Count() const { return starts.size(); }
+};
+
+// Pick the line scan kernel for this host. Idempotent; called from module init.
+void InitMarkdownChunker();
+
+// Fills `out` and returns true, or returns false when the JS implementation
+// would see different text: invalid UTF-8 (decoded with U+FFFD there), a
+// segment cut through a surrogate pair, or input of 4 GiB and up.
+bool ChunkMarkdown(const uint8_t* data, size_t len, const MarkdownChunkOptions& options,
+                   MarkdownChunks* out);
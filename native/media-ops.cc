@@ -0,0 +1,402 @@
+#include <napi.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "base64.h"
+#include "buffer-pool.h"
+#include "media-probe.h"
+#include "op-stats.h"
+#ifdef OPENCLAW_HAVE_JPEG
+#include "image-pipeline.h"
+#include "promise-worker.h"
+#endif
+
+// Media inspection and base64 handling for inbound attachments, exported as
+// module-level functions.
+
+static bool ReadBytes(Napi::Value value, const uint8_t** data, size_t* len) {
+    if (!value.IsTypedArray() || value.As<Napi::TypedArray>().TypedArrayType() != napi_uint8_array) {
+        return false;
+    }
+    Napi::Uint8Array bytes = value.As<Napi::Uint8Array>();
+    *data = bytes.Data();
+    *len = bytes.ByteLength();
+    return true;
+}
+
+// probeMedia(head, { tail?, size? }): { mime, width?, height?, orientation?,
+// duration?, codec?, sampleRate?, channels?, bitrate? } or null when the
+// format is not one the probe knows.
+//
+// head is the start of the file, or all of it. When it is only the start,
+// size is the file's length and tail (optional) its last bytes, for Ogg
+// durations and MP4s whose moov box follows the media data.
+Napi::Value MediaProbe(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    MediaProbeInput input;
+    if (info.Length() < 1 || !ReadBytes(info[0], &input.head, &input.head_len)) {
+        Napi::TypeError::New(env, "Expected (buffer, { tail?, size? })").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    input.size = input.head_len;
+
+    if (info.Length() >= 2 && info[1].IsObject()) {
+        Napi::Object options = info[1].As<Napi::Object>();
+        Napi::Value tail = options.Get("tail");
+        Napi::Value size = options.Get("size");
+        if (!tail.IsUndefined() && !ReadBytes(tail, &input.tail, &input.tail_len)) {
+            Napi::TypeError::New(env, "tail must be a Uint8Array").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        if (!size.IsUndefined()) {
+            double bytes = size.IsNumber() ? size.As<Napi::Number>().DoubleValue() : -1;
+            if (!(bytes >= 0 && bytes <= 9007199254740991.0)) {
+                Napi::TypeError::New(env, "size must be a non-negative number").ThrowAsJavaScriptException();
+                return env.Null();
+            }
+            input.size = static_cast<uint64_t>(bytes);
+        }
+        if (input.tail_len > 0 && input.size == input.head_len) {
+            // A tail only means something at a known file length
+            input.tail = nullptr;
+            input.tail_len = 0;
+        }
+    }
+
+    MediaProbeResult probe;
+    if (!ProbeMedia(input, &probe)) {
+        return env.Null();
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("mime", probe.mime);
+    if (probe.width != 0 && probe.height != 0) {
+        result.Set("width", probe.width);
+        result.Set("height", probe.height);
+    }
+    if (probe.orientation != 0) {
+        result.Set("orientation", probe.orientation);
+    }
+    if (probe.duration > 0) {
+        result.Set("duration", probe.duration);
+    }
+    if (probe.codec != nullptr) {
+        result.Set("codec", probe.codec);
+    }
+    if (probe.sample_rate != 0) {
+        result.Set("sampleRate", probe.sample_rate);
+    }
+    if (probe.channels != 0) {
+        result.Set("channels", probe.channels);
+    }
+    if (probe.bitrate != 0) {
+        result.Set("bitrate", probe.bitrate);
+    }
+    return result;
+}
+
+// Base64 text of a string or the bytes of a Uint8Array. Strings are copied
+// into a per-thread buffer reused across calls. A string that is not pure
+// ASCII cannot be base64, which *ascii reports without a second pass.
+static bool ReadBase64Input(Napi::Env env, const Napi::Value& value, const char** data, size_t* len, bool* ascii) {
+    *ascii = true;
+    if (value.IsString()) {
+        thread_local std::vector<char> text;
+        // Length in UTF-16 units; the UTF-8 copy fills exactly that many
+        // bytes only when every character is ASCII
+        size_t chars = 0;
+        napi_get_value_string_latin1(env, value, nullptr, 0, &chars);
+        text.resize(chars + 1);
+        size_t written = 0;
+        napi_get_value_string_utf8(env, value, text.data(), text.size(), &written);
+        *data = text.data();
+        *len = written;
+        *ascii = written == chars;
+        return true;
+    }
+    const uint8_t* bytes;
+    if (ReadBytes(value, &bytes, len)) {
+        *data = reinterpret_cast<const char*>(bytes);
+        return true;
+    }
+    return false;
+}
+
+struct Base64Request {
+    const char* text = nullptr;
+    Base64Payload payload;
+    double max_bytes = -1;
+    // False when the input string had a non-ASCII character
+    bool ascii = true;
+};
+
+// Parses (input, { dataUrl?, maxBytes? }); throws and returns false on bad input.
+static bool ReadBase64Request(const Napi::CallbackInfo& info, Base64Request* request) {
+    Napi::Env env = info.Env();
+
+    size_t len = 0;
+    if (info.Length() < 1 || !ReadBase64Input(env, info[0], &request->text, &len, &request->ascii)) {
+        Napi::TypeError::New(env, "Expected (string | Uint8Array, { dataUrl?, maxBytes? })")
+            .ThrowAsJavaScriptException();
+        return false;
+    }
+
+    bool data_url = false;
+    if (info.Length() >= 2 && info[1].IsObject()) {
+        Napi::Object options = info[1].As<Napi::Object>();
+        data_url = options.Get("dataUrl").ToBoolean().Value();
+        Napi::Value max_bytes = options.Get("maxBytes");
+        if (!max_bytes.IsUndefined()) {
+            double bytes = max_bytes.IsNumber() ? max_bytes.As<Napi::Number>().DoubleValue() : -1;
+            if (!(bytes >= 0)) {
+                Napi::TypeError::New(env, "maxBytes must be a non-negative number").ThrowAsJavaScriptException();
+                return false;
+            }
+            request->max_bytes = bytes;
+        }
+    }
+    request->payload = FindBase64Payload(request->text, len, data_url);
+    return true;
+}
+
+// { size, length, mime, type } shared by decodeBase64 and inspectBase64
+static Napi::Object Base64Result(Napi::Env env, const Base64Request& request, size_t size, const uint8_t* head,
+                                 size_t head_len) {
+    MediaProbeInput input;
+    input.head = head;
+    input.head_len = head_len;
+    input.size = size;
+    MediaProbeResult probe;
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("size", Napi::Number::New(env, static_cast<double>(size)));
+    result.Set("length", Napi::Number::New(env, static_cast<double>(request.payload.length)));
+    if (head_len > 0 && ProbeMedia(input, &probe)) {
+        result.Set("mime", probe.mime);
+    } else {
+        result.Set("mime", env.Null());
+    }
+    if (request.payload.type_length > 0) {
+        result.Set("type", Napi::String::New(env, request.text + request.payload.type_offset,
+                                             request.payload.type_length));
+    } else {
+        result.Set("type", env.Null());
+    }
+    return result;
+}
+
+// decodeBase64(input, { dataUrl?, maxBytes? }): { data, size, length, mime, type }
+// or null when the payload is not valid base64.
+//
+// input is a string or its bytes. With dataUrl a "data:<type>;base64,"
+// prefix is stripped and its type reported; surrounding whitespace is always
+// skipped. data is a pooled Buffer of `size` bytes (return it with
+// BufferOps.release), or null when size exceeds maxBytes. length is the
+// payload's length in characters, mime the type probed from the first
+// decoded bytes (null when the format is not one probeMedia knows).
+Napi::Value MediaDecodeBase64(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    Base64Request request;
+    if (!ReadBase64Request(info, &request) || !request.ascii) {
+        return env.Null();
+    }
+    OpScope scope(NativeOp::kBase64Decode, request.payload.length);
+    const char* payload = request.text + request.payload.offset;
+    size_t size = Base64DecodedSize(payload, request.payload.length);
+
+    if (request.max_bytes >= 0 && static_cast<double>(size) > request.max_bytes) {
+        if (!Base64Decode(payload, request.payload.length, nullptr)) {
+            return env.Null();
+        }
+        Napi::Object result = Base64Result(env, request, size, nullptr, 0);
+        result.Set("data", env.Null());
+        return result;
+    }
+
+    Napi::Buffer<uint8_t> data = AcquirePooledBuffer(env, DefaultBufferPool(env), size);
+    if (!Base64Decode(payload, request.payload.length, data.Data())) {
+        ReleasePooledBuffer(env, DefaultBufferPool(env), data);
+        return env.Null();
+    }
+    Napi::Object result = Base64Result(env, request, size, data.Data(), std::min(size, kMediaProbeHeadBytes));
+    result.Set("data", data);
+    return result;
+}
+
+// inspectBase64(input, { dataUrl? }): { size, length, mime, type } or null.
+// Validates the whole payload like decodeBase64 but only decodes the head
+// needed for the MIME probe, for callers that keep the base64 text.
+Napi::Value MediaInspectBase64(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    Base64Request request;
+    if (!ReadBase64Request(info, &request) || !request.ascii) {
+        return env.Null();
+    }
+    const char* payload = request.text + request.payload.offset;
+    size_t size = Base64DecodedSize(payload, request.payload.length);
+    if (!Base64Decode(payload, request.payload.length, nullptr)) {
+        return env.Null();
+    }
+
+    // Whole quads covering the probe head; the full payload when shorter
+    size_t head_chars = std::min(request.payload.length, (kMediaProbeHeadBytes + 2) / 3 * 4);
+    std::vector<uint8_t> head(Base64DecodedSize(payload, head_chars));
+    Base64Decode(payload, head_chars, head.data());
+    return Base64Result(env, request, size, head.data(), head.size());
+}
+
+// encodeBase64(bytes): string
+Napi::Value MediaEncodeBase64(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    const uint8_t* data;
+    size_t len;
+    if (info.Length() < 1 || !ReadBytes(info[0], &data, &len)) {
+        Napi::TypeError::New(env, "Expected Uint8Array").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    OpScope scope(NativeOp::kBase64Encode, len);
+    thread_local std::string text;
+    text.resize(Base64EncodedSize(len));
+    Base64Encode(data, len, &text[0]);
+    // ASCII only, so a one-byte string without a UTF-8 decode
+    napi_value result;
+    napi_create_string_latin1(env, text.data(), text.size(), &result);
+    return Napi::Value(env, result);
+}
+
+#ifdef OPENCLAW_HAVE_JPEG
+
+// Parses (buffer, { maxSide?, quality?, withoutEnlargement?, autoOrient? });
+// throws and returns false on bad input.
+static bool ReadResizeRequest(const Napi::CallbackInfo& info, ImageResizeOptions* options) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsBuffer() || (info.Length() >= 2 && !info[1].IsObject())) {
+        Napi::TypeError::New(env, "Expected (buffer, { maxSide?, quality?, withoutEnlargement?, autoOrient? })")
+            .ThrowAsJavaScriptException();
+        return false;
+    }
+    if (info.Length() < 2) {
+        return true;
+    }
+
+    Napi::Object opts = info[1].As<Napi::Object>();
+    Napi::Value maxSide = opts.Get("maxSide");
+    Napi::Value quality = opts.Get("quality");
+    Napi::Value withoutEnlargement = opts.Get("withoutEnlargement");
+    Napi::Value autoOrient = opts.Get("autoOrient");
+    if (!maxSide.IsUndefined()) {
+        double side = maxSide.IsNumber() ? maxSide.As<Napi::Number>().DoubleValue() : 0;
+        if (!(side >= 1 && side <= 65535) || std::floor(side) != side) {
+            Napi::TypeError::New(env, "maxSide must be an integer between 1 and 65535").ThrowAsJavaScriptException();
+            return false;
+        }
+        options->max_side = static_cast<uint32_t>(side);
+    }
+    if (!quality.IsUndefined()) {
+        double q = quality.IsNumber() ? quality.As<Napi::Number>().DoubleValue() : 0;
+        if (!(q >= 1 && q <= 100) || std::floor(q) != q) {
+            Napi::TypeError::New(env, "quality must be an integer between 1 and 100").ThrowAsJavaScriptException();
+            return false;
+        }
+        options->quality = static_cast<int>(q);
+    }
+    if (!withoutEnlargement.IsUndefined()) {
+        options->without_enlargement = withoutEnlargement.ToBoolean().As<Napi::Boolean>().Value();
+    }
+    if (!autoOrient.IsUndefined()) {
+        options->auto_orient = autoOrient.ToBoolean().As<Napi::Boolean>().Value();
+    }
+    return true;
+}
+
+// { data: Buffer, width, height } or null when the caller must fall back
+static Napi::Value ResizeResult(Napi::Env env, bool ok, const EncodedImage& image) {
+    if (!ok) {
+        return env.Null();
+    }
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("data", Napi::Buffer<uint8_t>::Copy(env, image.data.data(), image.data.size()));
+    result.Set("width", image.width);
+    result.Set("height", image.height);
+    return result;
+}
+
+// resizeJpeg(buffer, options): JPEG in, JPEG out, oriented and fit inside
+// maxSide x maxSide. null for input the pipeline does not take (not a JPEG,
+// CMYK, undecodable), which sharp may still handle.
+Napi::Value MediaResizeJpeg(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    ImageResizeOptions options;
+    if (!ReadResizeRequest(info, &options)) {
+        return env.Null();
+    }
+
+    Napi::Buffer<uint8_t> buffer = info[0].As<Napi::Buffer<uint8_t>>();
+    OpScope scope(NativeOp::kResizeJpeg, buffer.Length());
+    EncodedImage image;
+    bool ok = ResizeJpeg(buffer.Data(), buffer.Length(), options, &image);
+    return ResizeResult(env, ok, image);
+}
+
+class ResizeJpegWorker : public PromiseWorker {
+public:
+    ResizeJpegWorker(Napi::Env env, const Napi::Buffer<uint8_t>& buffer, const ImageResizeOptions& options)
+        : PromiseWorker(env, "openclaw:resizeJpeg"),
+          data_(buffer.Data()), len_(buffer.Length()), options_(options) {
+        Keep(buffer);
+    }
+
+    void Execute() override {
+        OpScope scope(NativeOp::kResizeJpeg, len_);
+        ok_ = ResizeJpeg(data_, len_, options_, &image_);
+    }
+
+    Napi::Value Result(Napi::Env env) override {
+        return ResizeResult(env, ok_, image_);
+    }
+
+private:
+    const uint8_t* data_;
+    size_t len_;
+    ImageResizeOptions options_;
+    EncodedImage image_;
+    bool ok_ = false;
+};
+
+Napi::Value MediaResizeJpegAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    ImageResizeOptions options;
+    if (!ReadResizeRequest(info, &options)) {
+        return env.Null();
+    }
+
+    return (new ResizeJpegWorker(env, info[0].As<Napi::Buffer<uint8_t>>(), options))->Start();
+}
+
+#endif  // OPENCLAW_HAVE_JPEG
+
+// Module initialization
+Napi::Object InitMediaOps(Napi::Env env, Napi::Object exports) {
+    InitBase64();
+    exports.Set("probeMedia", Napi::Function::New<MediaProbe>(env, "probeMedia"));
+    exports.Set("decodeBase64", Napi::Function::New<MediaDecodeBase64>(env, "decodeBase64"));
+    exports.Set("inspectBase64", Napi::Function::New<MediaInspectBase64>(env, "inspectBase64"));
+    exports.Set("encodeBase64", Napi::Function::New<MediaEncodeBase64>(env, "encodeBase64"));
+#ifdef OPENCLAW_HAVE_JPEG
+    exports.Set("resizeJpeg", Napi::Function::New<MediaResizeJpeg>(env, "resizeJpeg"));
+    exports.Set("resizeJpegAsync", Napi::Function::New<MediaResizeJpegAsync>(env, "resizeJpegAsync"));
+#endif
+    exports.Set("mediaProbeHeadBytes", Napi::Number::New(env, static_cast<double>(kMediaProbeHeadBytes)));
+    exports.Set("mediaProbeTailBytes", Napi::Number::New(env, static_cast<double>(kMediaProbeTailBytes)));
+    return exports;
+}
@@ -0,0 +1,731 @@
+#include "media-probe.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+uint16_t Be16(const uint8_t* p) { return static_cast<uint16_t>(p[0] << 8 | p[1]); }
+uint32_t Be24(const uint8_t* p) { return uint32_t(p[0]) << 16 | uint32_t(p[1]) << 8 | p[2]; }
+uint32_t Be32(const uint8_t* p) { return uint32_t(p[0]) << 24 | Be24(p + 1); }
+uint64_t Be64(const uint8_t* p) { return uint64_t(Be32(p)) << 32 | Be32(p + 4); }
+uint16_t Le16(const uint8_t* p) { return static_cast<uint16_t>(p[1] << 8 | p[0]); }
+uint32_t Le24(const uint8_t* p) { return uint32_t(p[2]) << 16 | uint32_t(p[1]) << 8 | p[0]; }
+uint32_t Le32(const uint8_t* p) { return uint32_t(p[3]) << 24 | Le24(p); }
+uint64_t Le64(const uint8_t* p) { return uint64_t(Le32(p + 4)) << 32 | Le32(p); }
+
+constexpr uint32_t Tag(const char (&s)[5]) {
+    return uint32_t(uint8_t(s[0])) << 24 | uint32_t(uint8_t(s[1])) << 16 |
+           uint32_t(uint8_t(s[2])) << 8 | uint8_t(s[3]);
+}
+
+bool Matches(const uint8_t* p, const char* literal, size_t len) {
+    return std::memcmp(p, literal, len) == 0;
+}
+
+// The head and tail the caller supplied, addressed by file offset
+class Source {
+public:
+    explicit Source(const MediaProbeInput& input) : input_(input) {
+        input_.size = std::max<uint64_t>(input_.size, input_.head_len);
+        if (input_.tail == nullptr) {
+            input_.tail_len = 0;
+        } else if (input_.tail_len > input_.size) {
+            input_.tail += input_.tail_len - input_.size;
+            input_.tail_len = static_cast<size_t>(input_.size);
+        }
+    }
+
+    uint64_t Size() const { return input_.size; }
+
+    // data[offset, offset + len) when the head or the tail holds all of it
+    const uint8_t* At(uint64_t offset, uint64_t len) const {
+        if (offset > input_.size || len > input_.size - offset) {
+            return nullptr;
+        }
+        if (offset + len <= input_.head_len) {
+            return input_.head + offset;
+        }
+        uint64_t tail_start = input_.size - input_.tail_len;
+        if (input_.tail_len > 0 && offset >= tail_start) {
+            return input_.tail + (offset - tail_start);
+        }
+        return nullptr;
+    }
+
+    // Up to `len` contiguous bytes from offset; *available says how many
+    const uint8_t* Span(uint64_t offset, uint64_t len, uint64_t* available) const {
+        *available = 0;
+        if (offset >= input_.size) {
+            return nullptr;
+        }
+        len = std::min(len, input_.size - offset);
+        if (offset < input_.head_len) {
+            *available = std::min<uint64_t>(len, input_.head_len - offset);
+            return input_.head + offset;
+        }
+        uint64_t tail_start = input_.size - input_.tail_len;
+        if (input_.tail_len > 0 && offset >= tail_start) {
+            *available = len;
+            return input_.tail + (offset - tail_start);
+        }
+        return nullptr;
+    }
+
+    // The last bytes of the file that are at hand, for trailers
+    const uint8_t* End(size_t* len) const {
+        if (input_.tail_len > 0) {
+            *len = input_.tail_len;
+            return input_.tail;
+        }
+        *len = input_.head_len == input_.size ? input_.head_len : 0;
+        return input_.head;
+    }
+
+private:
+    MediaProbeInput input_;
+};
+
+// ---- EXIF ----
+
+// Orientation from IFD0 of a TIFF block (the body of an Exif segment)
+uint32_t TiffOrientation(const uint8_t* tiff, size_t len) {
+    if (len < 8 || !(Matches(tiff, "II", 2) || Matches(tiff, "MM", 2))) {
+        return 0;
+    }
+    bool le = tiff[0] == 'I';
+    auto u16 = [&](size_t at) { return le ? Le16(tiff + at) : Be16(tiff + at); };
+    auto u32 = [&](size_t at) { return le ? Le32(tiff + at) : Be32(tiff + at); };
+
+    uint64_t ifd = u32(4);
+    if (ifd + 2 > len) {
+        return 0;
+    }
+    uint32_t entries = u16(ifd);
+    for (uint32_t i = 0; i < entries; i++) {
+        uint64_t entry = ifd + 2 + uint64_t(i) * 12;
+        if (entry + 12 > len) {
+            break;
+        }
+        if (u16(entry) == 0x0112) {
+            uint32_t value = u16(entry + 8);
+            return value >= 1 && value <= 8 ? value : 0;
+        }
+    }
+    return 0;
+}
+
+// ---- Images ----
+
+bool IsStartOfFrame(uint8_t marker) {
+    return marker >= 0xc0 && marker <= 0xcf && marker != 0xc4 && marker != 0xc8 && marker != 0xcc;
+}
+
+void ProbeJpeg(const Source& src, MediaProbeResult* r) {
+    r->mime = "image/jpeg";
+    uint64_t pos = 2;
+    for (;;) {
+        const uint8_t* m = src.At(pos, 4);
+        if (m == nullptr || m[0] != 0xff) {
+            return;
+        }
+        uint8_t marker = m[1];
+        if (marker == 0xff) {  // fill byte
+            pos++;
+            continue;
+        }
+        if (marker == 0x01 || (marker >= 0xd0 && marker <= 0xd7)) {  // no length
+            pos += 2;
+            continue;
+        }
+        if (marker == 0xd9 || marker == 0xda) {  // EOI, or SOS: entropy-coded data follows
+            return;
+        }
+        uint32_t len = Be16(m + 2);
+        if (len < 2) {
+            return;
+        }
+        if (marker == 0xe1 && r->orientation == 0) {
+            const uint8_t* body = src.At(pos + 4, len - 2);
+            if (body != nullptr && len - 2 >= 6 && Matches(body, "Exif\0\0", 6)) {
+                r->orientation = TiffOrientation(body + 6, len - 8);
+            }
+        }
+        if (IsStartOfFrame(marker)) {
+            // Exif APP1 always precedes the frame header
+            if (const uint8_t* sof = src.At(pos + 4, 5)) {
+                r->height = Be16(sof + 1);
+                r->width = Be16(sof + 3);
+            }
+            return;
+        }
+        pos += 2 + len;
+    }
+}
+
+bool ProbePng(const Source& src, MediaProbeResult* r) {
+    const uint8_t* ihdr = src.At(8, 16);
+    if (ihdr == nullptr || Be32(ihdr + 4) != Tag("IHDR")) {
+        return false;
+    }
+    r->width = Be32(ihdr + 8);
+    r->height = Be32(ihdr + 12);
+
+    // file-type reports APNG when acTL comes before the first IDAT
+    for (uint64_t pos = 8;;) {
+        const uint8_t* chunk = src.At(pos, 8);
+        if (chunk == nullptr) {
+            // Past the head the answer is unknown; past the end there is no IDAT
+            if (pos < src.Size()) {
+                return false;
+            }
+            r->mime = "image/png";
+            return true;
+        }
+        uint32_t type = Be32(chunk + 4);
+        if (type == Tag("acTL")) {
+            r->mime = "image/apng";
+            return true;
+        }
+        if (type == Tag("IDAT") || type == Tag("IEND")) {
+            r->mime = "image/png";
+            return true;
+        }
+        pos += 12 + uint64_t(Be32(chunk));
+    }
+}
+
+void ProbeGif(const Source& src, MediaProbeResult* r) {
+    r->mime = "image/gif";
+    if (const uint8_t* screen = src.At(6, 4)) {
+        r->width = Le16(screen);
+        r->height = Le16(screen + 2);
+    }
+}
+
+void ProbeWebp(const Source& src, MediaProbeResult* r) {
+    r->mime = "image/webp";
+    bool has_exif = false;
+    for (uint64_t pos = 12;;) {
+        const uint8_t* chunk = src.At(pos, 8);
+        if (chunk == nullptr) {
+            return;
+        }
+        uint32_t type = Be32(chunk);
+        uint32_t len = Le32(chunk + 4);
+        const uint8_t* body = src.At(pos + 8, std::min<uint32_t>(len, 10));
+        if (type == Tag("VP8X") && body != nullptr && len >= 10) {
+            has_exif = (body[0] & 0x08) != 0;
+            r->width = Le24(body + 4) + 1;
+            r->height = Le24(body + 7) + 1;
+        } else if (type == Tag("VP8 ") && body != nullptr && len >= 10) {
+            if (r->width == 0 && Matches(body + 3, "\x9d\x01\x2a", 3)) {
+                r->width = Le16(body + 6) & 0x3fff;
+                r->height = Le16(body + 8) & 0x3fff;
+            }
+        } else if (type == Tag("VP8L") && body != nullptr && len >= 5) {
+            if (r->width == 0 && body[0] == 0x2f) {
+                uint32_t bits = Le32(body + 1);
+                r->width = (bits & 0x3fff) + 1;
+                r->height = ((bits >> 14) & 0x3fff) + 1;
+            }
+        } else if (type == Tag("EXIF")) {
+            if (const uint8_t* exif = src.At(pos + 8, len)) {
+                bool prefixed = len >= 6 && Matches(exif, "Exif\0\0", 6);
+                r->orientation = prefixed ? TiffOrientation(exif + 6, len - 6) : TiffOrientation(exif, len);
+            }
+            return;
+        }
+        if (!has_exif && r->width != 0) {
+            return;
+        }
+        pos += 8 + uint64_t(len) + (len & 1);
+    }
+}
+
+// ---- ISO base media (MP4, MOV, M4A, HEIF, AVIF) ----
+
+struct Box {
+    uint32_t type = 0;
+    const uint8_t* data = nullptr;
+    uint64_t len = 0;  // clipped to the enclosing span
+};
+
+// Steps through the boxes in [*p, end); the last one may be cut short
+bool NextBox(const uint8_t** p, const uint8_t* end, Box* box) {
+    uint64_t left = static_cast<uint64_t>(end - *p);
+    if (left < 8) {
+        return false;
+    }
+    uint64_t size = Be32(*p);
+    uint64_t header = 8;
+    if (size == 1) {
+        if (left < 16) {
+            return false;
+        }
+        size = Be64(*p + 8);
+        header = 16;
+    } else if (size == 0) {
+        size = left;
+    }
+    if (size < header) {
+        return false;
+    }
+    box->type = Be32(*p + 4);
+    box->data = *p + header;
+    box->len = std::min(size, left) - header;
+    *p += std::min(size, left);
+    return true;
+}
+
+const char* MovieCodec(uint32_t fourcc) {
+    switch (fourcc) {
+        case Tag("avc1"): case Tag("avc3"): return "h264";
+        case Tag("hvc1"): case Tag("hev1"): return "hevc";
+        case Tag("av01"): return "av1";
+        case Tag("vp09"): return "vp9";
+        case Tag("vp08"): return "vp8";
+        case Tag("mp4v"): return "mpeg4";
+        case Tag("jpeg"): return "mjpeg";
+        case Tag("apch"): case Tag("apcn"): case Tag("apcs"): case Tag("apco"): case Tag("ap4h"): return "prores";
+        case Tag("mp4a"): return "aac";
+        case Tag("Opus"): return "opus";
+        case Tag("fLaC"): return "flac";
+        case Tag("alac"): return "alac";
+        case Tag("ac-3"): return "ac3";
+        case Tag("ec-3"): return "eac3";
+        case Tag(".mp3"): return "mp3";
+        case Tag("samr"): return "amr_nb";
+        case Tag("sawb"): return "amr_wb";
+        case Tag("ulaw"): return "pcm_mulaw";
+        case Tag("alaw"): return "pcm_alaw";
+        default: return nullptr;
+    }
+}
+
+struct Track {
+    uint32_t handler = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t sample_entry = 0;
+    uint32_t channels = 0;
+    uint32_t sample_rate = 0;
+};
+
+void ParseTrackBoxes(const uint8_t* p, const uint8_t* end, Track* track) {
+    Box box;
+    while (NextBox(&p, end, &box)) {
+        switch (box.type) {
+            case Tag("tkhd"):
+                if (box.len >= 84 && box.data[0] == 0) {
+                    track->width = Be32(box.data + 76) >> 16;
+                    track->height = Be32(box.data + 80) >> 16;
+                } else if (box.len >= 96 && box.data[0] == 1) {
+                    track->width = Be32(box.data + 88) >> 16;
+                    track->height = Be32(box.data + 92) >> 16;
+                }
+                break;
+            case Tag("hdlr"):
+                if (box.len >= 12) {
+                    track->handler = Be32(box.data + 8);
+                }
+                break;
+            case Tag("mdia"): case Tag("minf"): case Tag("stbl"):
+                ParseTrackBoxes(box.data, box.data + box.len, track);
+                break;
+            case Tag("stsd"):
+                // First sample entry: size, format, 6 reserved, data reference index
+                if (box.len >= 16) {
+                    track->sample_entry = Be32(box.data + 12);
+                }
+                if (box.len >= 44 && track->handler == Tag("soun")) {
+                    track->channels = Be16(box.data + 32);
+                    track->sample_rate = Be32(box.data + 40) >> 16;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void ParseMovie(const uint8_t* p, const uint8_t* end, MediaProbeResult* r) {
+    const char* audio_codec = nullptr;
+    Box box;
+    while (NextBox(&p, end, &box)) {
+        if (box.type == Tag("mvhd")) {
+            uint64_t timescale = 0, duration = 0;
+            if (box.len >= 20 && box.data[0] == 0) {
+                timescale = Be32(box.data + 12);
+                duration = Be32(box.data + 16);
+                duration = duration == 0xffffffffULL ? 0 : duration;
+            } else if (box.len >= 32 && box.data[0] == 1) {
+                timescale = Be32(box.data + 20);
+                duration = Be64(box.data + 24);
+                duration = duration == ~0ULL ? 0 : duration;
+            }
+            if (timescale != 0) {
+                r->duration = static_cast<double>(duration) / static_cast<double>(timescale);
+            }
+        } else if (box.type == Tag("trak")) {
+            Track track;
+            ParseTrackBoxes(box.data, box.data + box.len, &track);
+            if (track.handler == Tag("vide") && r->width == 0) {
+                r->width = track.width;
+                r->height = track.height;
+                r->codec = r->codec != nullptr ? r->codec : MovieCodec(track.sample_entry);
+            } else if (track.handler == Tag("soun") && r->channels == 0) {
+                r->channels = track.channels;
+                r->sample_rate = track.sample_rate;
+                audio_codec = MovieCodec(track.sample_entry);
+            }
+        }
+    }
+    r->codec = r->codec != nullptr ? r->codec : audio_codec;
+}
+
+// Largest ispe (image spatial extent) property: the primary image, not a
+// thumbnail or grid tile
+void ParseHeifMeta(const uint8_t* p, const uint8_t* end, MediaProbeResult* r) {
+    Box box;
+    while (NextBox(&p, end, &box)) {
+        if (box.type == Tag("iprp") || box.type == Tag("ipco")) {
+            ParseHeifMeta(box.data, box.data + box.len, r);
+        } else if (box.type == Tag("ispe") && box.len >= 12) {
+            uint32_t width = Be32(box.data + 4);
+            uint32_t height = Be32(box.data + 8);
+            if (uint64_t(width) * height > uint64_t(r->width) * r->height) {
+                r->width = width;
+                r->height = height;
+            }
+        }
+    }
+}
+
+// MIME by major brand, in file-type's terms
+const char* BrandMime(const uint8_t* raw) {
+    char brand[5] = {0};
+    for (int i = 0; i < 4; i++) {
+        brand[i] = raw[i] == 0 ? ' ' : static_cast<char>(raw[i]);
+    }
+    size_t len = 4;
+    while (len > 0 && brand[len - 1] == ' ') {
+        brand[--len] = 0;
+    }
+    auto is = [&](const char* name) { return std::strcmp(brand, name) == 0; };
+
+    if (is("avif") || is("avis")) return "image/avif";
+    if (is("mif1")) return "image/heif";
+    if (is("msf1")) return "image/heif-sequence";
+    if (is("heic") || is("heix")) return "image/heic";
+    if (is("hevc") || is("hevx")) return "image/heic-sequence";
+    if (is("qt")) return "video/quicktime";
+    if (is("M4V") || is("M4VH") || is("M4VP")) return "video/x-m4v";
+    if (is("M4P") || is("F4V") || is("F4P")) return "video/mp4";
+    if (is("M4A")) return "audio/x-m4a";
+    if (is("M4B") || is("F4A") || is("F4B")) return "audio/mp4";
+    if (is("crx")) return "image/x-canon-cr3";
+    if (std::strncmp(brand, "3g2", 3) == 0) return "video/3gpp2";
+    if (std::strncmp(brand, "3g", 2) == 0) return "video/3gpp";
+    return "video/mp4";
+}
+
+void ProbeIsoMedia(const Source& src, MediaProbeResult* r) {
+    r->mime = BrandMime(src.At(8, 4));
+    bool image = std::strncmp(r->mime, "image/", 6) == 0;
+
+    // Top-level boxes may sit anywhere; the moov after a large mdat is only
+    // reachable through the tail
+    for (uint64_t pos = 0; pos < src.Size();) {
+        const uint8_t* header = src.At(pos, 16);
+        header = header != nullptr ? header : src.At(pos, 8);
+        if (header == nullptr) {
+            return;
+        }
+        uint64_t size = Be32(header);
+        uint64_t header_len = 8;
+        if (size == 1) {
+            if (src.At(pos, 16) == nullptr) {
+                return;
+            }
+            size = Be64(header + 8);
+            header_len = 16;
+        } else if (size == 0) {
+            size = src.Size() - pos;
+        }
+        if (size < header_len) {
+            return;
+        }
+        uint32_t type = Be32(header + 4);
+        if ((image && type == Tag("meta")) || (!image && type == Tag("moov"))) {
+            uint64_t available = 0;
+            const uint8_t* body = src.Span(pos + header_len, size - header_len, &available);
+            if (body != nullptr && image && available >= 4) {
+                ParseHeifMeta(body + 4, body + available, r);  // meta is a full box
+            } else if (body != nullptr && !image) {
+                ParseMovie(body, body + available, r);
+            }
+            return;
+        }
+        if (size > src.Size() - pos) {
+            return;
+        }
+        pos += size;
+    }
+}
+
+// ---- Audio ----
+
+struct OggStream {
+    uint32_t serial = 0;
+    uint64_t pre_skip = 0;
+    uint32_t granule_rate = 0;  // granule positions per second; 0 = not a sample count
+};
+
+// The granule position of the stream's last page, or -1
+int64_t LastGranule(const Source& src, uint32_t serial) {
+    size_t len = 0;
+    const uint8_t* end = src.End(&len);
+    for (size_t i = len >= 27 ? len - 27 + 1 : 0; i-- > 0;) {
+        const uint8_t* page = end + i;
+        if (page[0] == 'O' && Matches(page, "OggS\0", 5) && Le32(page + 14) == serial) {
+            int64_t granule = static_cast<int64_t>(Le64(page + 6));
+            if (granule != -1) {
+                return granule;
+            }
+        }
+    }
+    return -1;
+}
+
+bool ProbeOgg(const Source& src, MediaProbeResult* r) {
+    // file-type reads the codec id at 28, where a one-segment BOS page puts it
+    const uint8_t* page = src.At(0, 28 + 8);
+    if (page == nullptr || page[26] != 1) {
+        return false;
+    }
+    const uint8_t* id = page + 28;
+    uint64_t packet = page[27];
+    const uint8_t* body = src.At(28, packet);
+
+    OggStream stream;
+    stream.serial = Le32(page + 14);
+    if (Matches(id, "OpusHead", 8)) {
+        r->mime = "audio/ogg; codecs=opus";
+        r->codec = "opus";
+        if (body != nullptr && packet >= 16) {
+            r->channels = body[9];
+            stream.pre_skip = Le16(body + 10);
+        }
+        r->sample_rate = 48000;  // Opus always decodes at 48 kHz
+        stream.granule_rate = 48000;
+    } else if (Matches(id, "\x01vorbis", 7)) {
+        r->mime = "audio/ogg";
+        r->codec = "vorbis";
+        if (body != nullptr && packet >= 16) {
+            r->channels = body[11];
+            r->sample_rate = Le32(body + 12);
+            stream.granule_rate = r->sample_rate;
+        }
+    } else if (Matches(id, "\x7f""FLAC", 5)) {
+        r->mime = "audio/ogg";
+        r->codec = "flac";
+        // Mapping header, "fLaC", then the STREAMINFO block
+        if (body != nullptr && packet >= 13 + 4 + 18 && Matches(body + 9, "fLaC", 4)) {
+            const uint8_t* info = body + 17;
+            r->sample_rate = uint32_t(info[10]) << 12 | uint32_t(info[11]) << 4 | info[12] >> 4;
+            r->channels = ((info[12] >> 1) & 7) + 1;
+            stream.granule_rate = r->sample_rate;
+        }
+    } else if (Matches(id, "Speex   ", 8)) {
+        r->mime = "audio/ogg";
+        r->codec = "speex";
+        if (body != nullptr && packet >= 52) {
+            r->sample_rate = Le32(body + 36);
+            r->channels = Le32(body + 48);
+            stream.granule_rate = r->sample_rate;
+        }
+    } else if (Matches(id, "\x80theora", 7)) {
+        r->mime = "video/ogg";
+        r->codec = "theora";
+        if (body != nullptr && packet >= 20) {
+            r->width = Be24(body + 14);
+            r->height = Be24(body + 17);
+        }
+    } else if (Matches(id, "\x01video\0", 7)) {
+        r->mime = "video/ogg";
+    } else {
+        r->mime = "application/ogg";
+    }
+
+    if (stream.granule_rate != 0) {
+        int64_t granule = LastGranule(src, stream.serial);
+        if (granule > static_cast<int64_t>(stream.pre_skip)) {
+            r->duration = static_cast<double>(granule - stream.pre_skip) / stream.granule_rate;
+        }
+    }
+    return true;
+}
+
+bool ProbeMp3(const Source& src, uint64_t start, MediaProbeResult* r) {
+    const uint8_t* frame = src.At(start, 4);
+    if (frame == nullptr) {
+        // ID3 tag (cover art, usually) runs past the head: file-type calls that MP3
+        r->mime = start > 0 ? "audio/mpeg" : nullptr;
+        return start > 0;
+    }
+    if (frame[0] != 0xff || (frame[1] & 0xe0) != 0xe0 || (frame[1] & 0x06) != 0x02) {
+        // Not Layer III; after an ID3 tag anything may follow
+        return false;
+    }
+    r->mime = "audio/mpeg";
+    r->codec = "mp3";
+
+    static const uint16_t kBitratesV1[16] = {0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 0};
+    static const uint16_t kBitratesV2[16] = {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160, 0};
+    static const uint32_t kSampleRates[3] = {44100, 48000, 32000};
+
+    uint32_t version = (frame[1] >> 3) & 3;  // 3 = MPEG-1, 2 = MPEG-2, 0 = MPEG-2.5
+    uint32_t rate_index = (frame[2] >> 2) & 3;
+    uint32_t kbps = (version == 3 ? kBitratesV1 : kBitratesV2)[frame[2] >> 4];
+    if (version == 1 || rate_index == 3 || kbps == 0) {
+        return true;
+    }
+    r->sample_rate = kSampleRates[rate_index] >> (version == 3 ? 0 : version == 2 ? 1 : 2);
+    bool mono = (frame[3] >> 6) == 3;
+    r->channels = mono ? 1 : 2;
+    uint32_t samples_per_frame = version == 3 ? 1152 : 576;
+
+    // A Xing/Info or VBRI header in the first frame counts the frames
+    uint64_t side_info = version == 3 ? (mono ? 17 : 32) : (mono ? 9 : 17);
+    uint64_t frames = 0;
+    if (const uint8_t* xing = src.At(start + 4 + side_info, 12)) {
+        if ((Matches(xing, "Xing", 4) || Matches(xing, "Info", 4)) && (Be32(xing + 4) & 1)) {
+            frames = Be32(xing + 8);
+        }
+    }
+    if (const uint8_t* vbri = src.At(start + 4 + 32, 18)) {
+        if (frames == 0 && Matches(vbri, "VBRI", 4)) {
+            frames = Be32(vbri + 14);
+        }
+    }
+
+    if (frames != 0) {
+        r->duration = static_cast<double>(frames) * samples_per_frame / r->sample_rate;
+    } else {
+        // Constant bitrate: the audio bytes, less any ID3v1 trailer
+        uint64_t bytes = src.Size() - start;
+        const uint8_t* tag = src.Size() >= start + 128 ? src.At(src.Size() - 128, 3) : nullptr;
+        bytes -= tag != nullptr && Matches(tag, "TAG", 3) ? 128 : 0;
+        r->bitrate = kbps * 1000;
+        r->duration = static_cast<double>(bytes) * 8 / r->bitrate;
+    }
+    return true;
+}
+
+const char* WaveCodec(uint32_t format, uint32_t bits) {
+    switch (format) {
+        case 1:
+            return bits == 8 ? "pcm_u8" : bits == 16 ? "pcm_s16le" : bits == 24 ? "pcm_s24le"
+                 : bits == 32 ? "pcm_s32le" : nullptr;
+        case 3:
+            return bits == 32 ? "pcm_f32le" : bits == 64 ? "pcm_f64le" : nullptr;
+        case 6: return "pcm_alaw";
+        case 7: return "pcm_mulaw";
+        case 0x55: return "mp3";
+        default: return nullptr;
+    }
+}
+
+void ProbeWave(const Source& src, MediaProbeResult* r) {
+    r->mime = "audio/wav";
+    uint32_t byte_rate = 0;
+    for (uint64_t pos = 12;;) {
+        const uint8_t* chunk = src.At(pos, 8);
+        if (chunk == nullptr) {
+            return;
+        }
+        uint32_t type = Be32(chunk);
+        uint64_t len = Le32(chunk + 4);
+        if (type == Tag("fmt ")) {
+            const uint8_t* fmt = src.At(pos + 8, 16);
+            if (fmt == nullptr || len < 16) {
+                return;
+            }
+            uint32_t format = Le16(fmt);
+            uint32_t bits = Le16(fmt + 14);
+            if (format == 0xfffe && len >= 40) {  // WAVE_FORMAT_EXTENSIBLE
+                if (const uint8_t* ext = src.At(pos + 8 + 24, 2)) {
+                    format = Le16(ext);
+                }
+            }
+            r->codec = WaveCodec(format, bits);
+            r->channels = Le16(fmt + 2);
+            r->sample_rate = Le32(fmt + 4);
+            byte_rate = Le32(fmt + 8);
+        } else if (type == Tag("data")) {
+            // Streamed writers leave the size 0 or ~0 and never patch it
+            uint64_t left = src.Size() - std::min(src.Size(), pos + 8);
+            if (len == 0 || len == 0xffffffffULL || len > left) {
+                len = left;
+            }
+            if (byte_rate != 0) {
+                r->duration = static_cast<double>(len) / byte_rate;
+            }
+            return;
+        }
+        pos += 8 + len + (len & 1);
+    }
+}
+
+}  // namespace
+
+bool ProbeMedia(const MediaProbeInput& input, MediaProbeResult* result) {
+    *result = MediaProbeResult();
+    Source src(input);
+    MediaProbeResult& r = *result;
+    const uint8_t* magic = src.At(0, 12);
+    const uint8_t* short_magic = src.At(0, 4);
+    if (short_magic == nullptr) {
+        return false;
+    }
+
+    bool ok = true;
+    if (Matches(short_magic, "\xff\xd8\xff", 3)) {
+        ProbeJpeg(src, &r);
+    } else if (magic != nullptr && Matches(magic, "\x89PNG\r\n\x1a\n", 8)) {
+        ok = ProbePng(src, &r);
+    } else if (Matches(short_magic, "GIF", 3)) {
+        ProbeGif(src, &r);
+    } else if (magic != nullptr && Matches(magic, "RIFF", 4) && Matches(magic + 8, "WEBP", 4)) {
+        ProbeWebp(src, &r);
+    } else if (magic != nullptr && Matches(magic, "RIFF", 4) && Matches(magic + 8, "WAVE", 4)) {
+        ProbeWave(src, &r);
+    } else if (magic != nullptr && Matches(magic + 4, "ftyp", 4) && (magic[8] & 0x60) != 0) {
+        ProbeIsoMedia(src, &r);
+    } else if (Matches(short_magic, "OggS", 4)) {
+        ok = ProbeOgg(src, &r);
+    } else if (Matches(short_magic, "%PDF", 4)) {
+        r.mime = "application/pdf";
+    } else if (Matches(short_magic, "ID3", 3)) {
+        const uint8_t* id3 = src.At(0, 10);
+        if (id3 == nullptr) {
+            return false;
+        }
+        // Sync-safe size, plus the footer when flagged
+        uint64_t size = uint64_t(id3[6] & 0x7f) << 21 | uint64_t(id3[7] & 0x7f) << 14 |
+                        uint64_t(id3[8] & 0x7f) << 7 | (id3[9] & 0x7f);
+        ok = ProbeMp3(src, 10 + size + ((id3[5] & 0x10) ? 10 : 0), &r);
+    } else {
+        ok = ProbeMp3(src, 0, &r);
+    }
+
+    if (!ok || r.mime == nullptr) {
+        *result = MediaProbeResult();
+        return false;
+    }
+    if (r.bitrate == 0 && r.duration > 0) {
+        r.bitrate = static_cast<uint32_t>(std::min(static_cast<double>(src.Size()) * 8 / r.duration, 4e9));
+    }
+    return true;
+}
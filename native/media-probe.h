@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Header probe for inbound media: MIME, dimensions, EXIF orientation and
+// stream details in one bounded pass. N-API free.
+//
+// Only container and codec headers are parsed; no pixel or sample data is
+// touched. Callers pass the start of the file (the first
+// kMediaProbeHeadBytes suffice) and optionally its last bytes, where Ogg
+// keeps the final granule position and many MP4s keep their moov box.
+//
+// MIME strings are the ones the file-type package reports, so a probe can
+// stand in for fileTypeFromBuffer on the formats below; for anything else it
+// reports nothing and the caller falls back.
+
+static constexpr size_t kMediaProbeHeadBytes = 64 * 1024;
+static constexpr size_t kMediaProbeTailBytes = 64 * 1024;
+
+struct MediaProbeInput {
+    const uint8_t* head = nullptr;
+    size_t head_len = 0;
+    // The file's last tail_len bytes, ending at size; may overlap head
+    const uint8_t* tail = nullptr;
+    size_t tail_len = 0;
+    // Length of the whole file; head_len when smaller
+    uint64_t size = 0;
+};
+
+// Zero (or null) marks a field the headers do not give
+struct MediaProbeResult {
+    const char* mime = nullptr;
+    const char* codec = nullptr;  // ffprobe's codec name, for audio and video
+    uint32_t width = 0;           // stored size, before EXIF orientation
+    uint32_t height = 0;
+    uint32_t orientation = 0;     // EXIF 1-8
+    double duration = 0;          // seconds
+    uint32_t sample_rate = 0;
+    uint32_t channels = 0;
+    uint32_t bitrate = 0;         // bits per second, over the whole file
+};
+
+// Probes JPEG, PNG, GIF, WebP, HEIF/AVIF, MP4/MOV/M4A, Ogg, MP3, WAV and
+// PDF; false for anything else, or when the head is too short to tell.
+bool ProbeMedia(const MediaProbeInput& input, MediaProbeResult* result);
@@ -0,0 +1,150 @@
+#include <napi.h>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include "multi-pattern.h"
+
+// Compiled multi-literal matcher: one pass over the input for the whole set
+class MultiMatcher : public Napi::ObjectWrap<MultiMatcher> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    MultiMatcher(const Napi::CallbackInfo& info);
+
+private:
+    static Napi::FunctionReference constructor;
+
+    // Every (patternId, offset) pair as a flat Uint32Array
+    Napi::Value Scan(const Napi::CallbackInfo& info);
+
+    // True if any pattern occurs (stops at the first match)
+    Napi::Value Test(const Napi::CallbackInfo& info);
+
+    Napi::Value PatternCount(const Napi::CallbackInfo& info);
+
+    std::unique_ptr<MultiPattern> matcher_;
+};
+
+Napi::FunctionReference MultiMatcher::constructor;
+
+Napi::Object MultiMatcher::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "MultiMatcher", {
+        InstanceMethod("scan", &MultiMatcher::Scan),
+        InstanceMethod("test", &MultiMatcher::Test),
+        InstanceAccessor("patternCount", &MultiMatcher::PatternCount, nullptr),
+    });
+
+    constructor = Napi::Persistent(func);
+    constructor.SuppressDestruct();
+
+    exports.Set("MultiMatcher", func);
+    return exports;
+}
+
+// new MultiMatcher(patterns: Array<string | Buffer>, { caseInsensitive? })
+MultiMatcher::MultiMatcher(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<MultiMatcher>(info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsArray()) {
+        Napi::TypeError::New(env, "Expected (patterns, options?)").ThrowAsJavaScriptException();
+        return;
+    }
+
+    Napi::Array list = info[0].As<Napi::Array>();
+    std::vector<std::string> patterns;
+    patterns.reserve(list.Length());
+
+    for (uint32_t i = 0; i < list.Length(); i++) {
+        Napi::Value item = list.Get(i);
+        std::string pattern;
+        if (item.IsString()) {
+            pattern = item.As<Napi::String>().Utf8Value();
+        } else if (item.IsBuffer()) {
+            Napi::Buffer<char> buf = item.As<Napi::Buffer<char>>();
+            pattern.assign(buf.Data(), buf.Length());
+        } else {
+            Napi::TypeError::New(env, "Patterns must be strings or buffers").ThrowAsJavaScriptException();
+            return;
+        }
+        if (pattern.empty()) {
+            Napi::RangeError::New(env, "Patterns must not be empty").ThrowAsJavaScriptException();
+            return;
+        }
+        patterns.push_back(std::move(pattern));
+    }
+
+    bool case_insensitive = false;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Object options = info[1].As<Napi::Object>();
+        if (options.Has("caseInsensitive")) {
+            case_insensitive = options.Get("caseInsensitive").ToBoolean().As<Napi::Boolean>().Value();
+        }
+    }
+
+    matcher_ = std::make_unique<MultiPattern>(patterns, case_insensitive);
+}
+
+Napi::Value MultiMatcher::Scan(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsBuffer()) {
+        Napi::TypeError::New(env, "Expected (buffer, maxHits?)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Napi::Buffer<uint8_t> buffer = info[0].As<Napi::Buffer<uint8_t>>();
+
+    if (buffer.Length() > UINT32_MAX) {
+        Napi::RangeError::New(env, "Buffer too large for Uint32 offsets").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    size_t max_hits = 0;
+    if (info.Length() > 1 && info[1].IsNumber()) {
+        int64_t limit = info[1].As<Napi::Number>().Int64Value();
+        max_hits = limit > 0 ? static_cast<size_t>(limit) : 0;
+    }
+
+    std::vector<uint32_t> pairs;
+    matcher_->Scan(buffer.Data(), buffer.Length(), [&pairs, max_hits](uint32_t id, size_t offset) {
+        pairs.push_back(id);
+        pairs.push_back(static_cast<uint32_t>(offset));
+        return max_hits == 0 || pairs.size() / 2 < max_hits;
+    });
+
+    Napi::Uint32Array result = Napi::Uint32Array::New(env, pairs.size());
+    if (!pairs.empty()) {
+        std::memcpy(result.Data(), pairs.data(), pairs.size() * sizeof(uint32_t));
+    }
+    return result;
+}
+
+Napi::Value MultiMatcher::Test(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsBuffer()) {
+        Napi::TypeError::New(env, "Expected buffer").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Napi::Buffer<uint8_t> buffer = info[0].As<Napi::Buffer<uint8_t>>();
+
+    bool found = false;
+    matcher_->Scan(buffer.Data(), buffer.Length(), [&found](uint32_t, size_t) {
+        found = true;
+        return false;
+    });
+
+    return Napi::Boolean::New(env, found);
+}
+
+Napi::Value MultiMatcher::PatternCount(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), static_cast<double>(matcher_ ? matcher_->PatternCount() : 0));
+}
+
+// Module initialization
+Napi::Object InitMultiMatcher(Napi::Env env, Napi::Object exports) {
+    return MultiMatcher::Init(env, exports);
+}
@@ -0,0 +1,305 @@
+#include "multi-pattern.h"
+#include "cpu-features.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#if defined(HAS_X86_SIMD)
+  #include <immintrin.h>
+#elif defined(HAS_ARM_SIMD)
+  #include <arm_neon.h>
+#endif
+
+// Beyond this many patterns the 8 Teddy buckets saturate and the nibble
+// masks accept nearly every position, so the first-byte table is cheaper.
+static constexpr size_t kTeddyMaxPatterns = 64;
+
+static constexpr uint32_t kNoState = std::numeric_limits<uint32_t>::max();
+
+static inline uint8_t FoldAscii(uint8_t c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<uint8_t>(c + ('a' - 'A')) : c;
+}
+
+static inline uint8_t OtherCase(uint8_t c) {
+    if (c >= 'A' && c <= 'Z') return static_cast<uint8_t>(c + ('a' - 'A'));
+    if (c >= 'a' && c <= 'z') return static_cast<uint8_t>(c - ('a' - 'A'));
+    return c;
+}
+
+MultiPattern::MultiPattern(const std::vector<std::string>& patterns, bool caseInsensitive)
+    : case_insensitive_(caseInsensitive) {
+    BuildAutomaton(patterns);
+    BuildPrefilter(patterns);
+}
+
+void MultiPattern::BuildAutomaton(const std::vector<std::string>& patterns) {
+    // Byte equivalence classes: every byte that never appears in a pattern
+    // shares class 0, which keeps the dense table small.
+    bool used[256] = {false};
+    for (const std::string& p : patterns) {
+        for (char ch : p) {
+            uint8_t c = static_cast<uint8_t>(ch);
+            used[case_insensitive_ ? FoldAscii(c) : c] = true;
+        }
+    }
+
+    uint8_t folded_class[256] = {0};
+    class_count_ = 1;
+    for (int c = 0; c < 256; c++) {
+        if (used[c]) {
+            folded_class[c] = static_cast<uint8_t>(class_count_++);
+        }
+    }
+    for (int c = 0; c < 256; c++) {
+        uint8_t key = case_insensitive_ ? FoldAscii(static_cast<uint8_t>(c)) : static_cast<uint8_t>(c);
+        byte_class_[c] = used[key] ? folded_class[key] : 0;
+    }
+
+    // Trie
+    std::vector<uint32_t> trie(class_count_, kNoState);
+    std::vector<std::vector<uint32_t>> own_outputs(1);
+    pattern_lengths_.clear();
+
+    for (size_t id = 0; id < patterns.size(); id++) {
+        const std::string& p = patterns[id];
+        uint32_t state = 0;
+        for (char ch : p) {
+            uint32_t cls = byte_class_[static_cast<uint8_t>(ch)];
+            uint32_t& next = trie[state * class_count_ + cls];
+            if (next == kNoState) {
+                next = static_cast<uint32_t>(own_outputs.size());
+                own_outputs.emplace_back();
+                trie.resize(trie.size() + class_count_, kNoState);
+            }
+            state = trie[state * class_count_ + cls];
+        }
+        own_outputs[state].push_back(static_cast<uint32_t>(id));
+        pattern_lengths_.push_back(static_cast<uint32_t>(p.size()));
+    }
+
+    // BFS over the trie: resolve failure links into full DFA transitions and
+    // merge each state's outputs with those of its failure state.
+    size_t state_count = own_outputs.size();
+    transitions_.assign(state_count * class_count_, 0);
+    std::vector<uint32_t> fail(state_count, 0);
+    std::vector<std::vector<uint32_t>> outputs(state_count);
+    std::vector<uint32_t> queue;
+    queue.reserve(state_count);
+
+    for (uint32_t cls = 0; cls < class_count_; cls++) {
+        uint32_t child = trie[cls];
+        if (child != kNoState) {
+            transitions_[cls] = child;
+            fail[child] = 0;
+            queue.push_back(child);
+        }
+    }
+    outputs[0] = own_outputs[0];
+
+    for (size_t head = 0; head < queue.size(); head++) {
+        uint32_t s = queue[head];
+
+        std::vector<uint32_t>& out = outputs[s];
+        out = own_outputs[s];
+        out.insert(out.end(), outputs[fail[s]].begin(), outputs[fail[s]].end());
+        std::sort(out.begin(), out.end());
+
+        for (uint32_t cls = 0; cls < class_count_; cls++) {
+            uint32_t child = trie[s * class_count_ + cls];
+            uint32_t via_fail = transitions_[fail[s] * class_count_ + cls];
+            if (child != kNoState) {
+                transitions_[s * class_count_ + cls] = child;
+                fail[child] = via_fail;
+                queue.push_back(child);
+            } else {
+                transitions_[s * class_count_ + cls] = via_fail;
+            }
+        }
+    }
+
+    output_offsets_.assign(state_count + 1, 0);
+    outputs_.clear();
+    for (size_t s = 0; s < state_count; s++) {
+        output_offsets_[s] = static_cast<uint32_t>(outputs_.size());
+        outputs_.insert(outputs_.end(), outputs[s].begin(), outputs[s].end());
+    }
+    output_offsets_[state_count] = static_cast<uint32_t>(outputs_.size());
+}
+
+void MultiPattern::BuildPrefilter(const std::vector<std::string>& patterns) {
+    std::memset(start_byte_, 0, sizeof(start_byte_));
+    std::memset(teddy_lo_, 0, sizeof(teddy_lo_));
+    std::memset(teddy_hi_, 0, sizeof(teddy_hi_));
+    next_candidate_ = NextCandidateScalar;
+    teddy_len_ = 0;
+
+    size_t min_len = std::numeric_limits<size_t>::max();
+    for (const std::string& p : patterns) {
+        uint8_t c = static_cast<uint8_t>(p[0]);
+        start_byte_[c] = true;
+        if (case_insensitive_) {
+            start_byte_[OtherCase(c)] = true;
+        }
+        min_len = std::min(min_len, p.size());
+    }
+
+    if (patterns.empty() || patterns.size() > kTeddyMaxPatterns) {
+        return;
+    }
+
+    CandidateFn teddy = nullptr;
+#if defined(HAS_X86_DISPATCH)
+    const CpuFeatures& cpu = GetCpuFeatures();
+    if (cpu.avx2) {
+        teddy = NextCandidateTeddyAvx2;
+    } else if (cpu.ssse3) {
+        teddy = NextCandidateTeddySsse3;
+    }
+#elif defined(HAS_ARM_SIMD)
+    if (GetCpuFeatures().neon) {
+        teddy = NextCandidateTeddyNeon;
+    }
+#endif
+    if (!teddy) {
+        return;
+    }
+
+    // Each pattern lands in one of 8 buckets; a position is a candidate when
+    // some bucket matches both nibbles of each of the first teddy_len_ bytes.
+    teddy_len_ = std::min<size_t>(3, min_len);
+    for (size_t id = 0; id < patterns.size(); id++) {
+        uint8_t bucket = static_cast<uint8_t>(1u << (id % 8));
+        for (size_t j = 0; j < teddy_len_; j++) {
+            uint8_t c = static_cast<uint8_t>(patterns[id][j]);
+            uint8_t variants[2] = {c, case_insensitive_ ? OtherCase(c) : c};
+            for (uint8_t v : variants) {
+                teddy_lo_[j][v & 0x0f] |= bucket;
+                teddy_hi_[j][v >> 4] |= bucket;
+            }
+        }
+    }
+    next_candidate_ = teddy;
+}
+
+size_t MultiPattern::NextCandidateScalar(const MultiPattern* self, const uint8_t* data, size_t len, size_t from) {
+    while (from < len && !self->start_byte_[data[from]]) {
+        from++;
+    }
+    return from;
+}
+
+#if defined(HAS_X86_DISPATCH)
+
+OPENCLAW_TARGET("ssse3")
+size_t MultiPattern::NextCandidateTeddySsse3(const MultiPattern* self, const uint8_t* data, size_t len, size_t from) {
+    const size_t k = self->teddy_len_;
+    const __m128i nibble = _mm_set1_epi8(0x0f);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i lo[3];
+    __m128i hi[3];
+    for (size_t j = 0; j < k; j++) {
+        lo[j] = _mm_load_si128(reinterpret_cast<const __m128i*>(self->teddy_lo_[j]));
+        hi[j] = _mm_load_si128(reinterpret_cast<const __m128i*>(self->teddy_hi_[j]));
+    }
+
+    size_t i = from;
+    for (; i + 16 + k - 1 <= len; i += 16) {
+        __m128i acc = _mm_set1_epi8(-1);
+        for (size_t j = 0; j < k; j++) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + j));
+            __m128i l = _mm_shuffle_epi8(lo[j], _mm_and_si128(v, nibble));
+            __m128i h = _mm_shuffle_epi8(hi[j], _mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+            acc = _mm_and_si128(acc, _mm_and_si128(l, h));
+        }
+        unsigned mask = ~static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(acc, zero))) & 0xffffu;
+        if (mask != 0) {
+            return i + static_cast<size_t>(__builtin_ctz(mask));
+        }
+    }
+
+    return NextCandidateScalar(self, data, len, i);
+}
+
+OPENCLAW_TARGET("avx2")
+size_t MultiPattern::NextCandidateTeddyAvx2(const MultiPattern* self, const uint8_t* data, size_t len, size_t from) {
+    const size_t k = self->teddy_len_;
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i lo[3];
+    __m256i hi[3];
+    for (size_t j = 0; j < k; j++) {
+        // vpshufb looks up within each 128-bit lane, so mirror the tables
+        lo[j] = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(self->teddy_lo_[j])));
+        hi[j] = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(self->teddy_hi_[j])));
+    }
+
+    size_t i = from;
+    for (; i + 32 + k - 1 <= len; i += 32) {
+        __m256i acc = _mm256_set1_epi8(-1);
+        for (size_t j = 0; j < k; j++) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + j));
+            __m256i l = _mm256_shuffle_epi8(lo[j], _mm256_and_si256(v, nibble));
+            __m256i h = _mm256_shuffle_epi8(hi[j], _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+            acc = _mm256_and_si256(acc, _mm256_and_si256(l, h));
+        }
+        unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(acc, zero)));
+        if (mask != 0) {
+            return i + static_cast<size_t>(__builtin_ctz(mask));
+        }
+    }
+
+    return NextCandidateScalar(self, data, len, i);
+}
+
+#else
+
+size_t MultiPattern::NextCandidateTeddySsse3(const MultiPattern* self, const uint8_t* data, size_t len, size_t from) {
+    return NextCandidateScalar(self, data, len, from);
+}
+
+size_t MultiPattern::NextCandidateTeddyAvx2(const MultiPattern* self, const uint8_t* data, size_t len, size_t from) {
+    return NextCandidateScalar(self, data, len, from);
+}
+
+#endif  // HAS_X86_DISPATCH
+
+#if defined(HAS_ARM_SIMD)
+
+size_t MultiPattern::NextCandidateTeddyNeon(const MultiPattern* self, const uint8_t* data, size_t len, size_t from) {
+    const size_t k = self->teddy_len_;
+    const uint8x16_t nibble = vdupq_n_u8(0x0f);
+    uint8x16_t lo[3];
+    uint8x16_t hi[3];
+    for (size_t j = 0; j < k; j++) {
+        lo[j] = vld1q_u8(self->teddy_lo_[j]);
+        hi[j] = vld1q_u8(self->teddy_hi_[j]);
+    }
+
+    size_t i = from;
+    for (; i + 16 + k - 1 <= len; i += 16) {
+        uint8x16_t acc = vdupq_n_u8(0xff);
+        for (size_t j = 0; j < k; j++) {
+            uint8x16_t v = vld1q_u8(data + i + j);
+            uint8x16_t l = vqtbl1q_u8(lo[j], vandq_u8(v, nibble));
+            uint8x16_t h = vqtbl1q_u8(hi[j], vshrq_n_u8(v, 4));
+            acc = vandq_u8(acc, vandq_u8(l, h));
+        }
+        uint8x16_t nonzero = vtstq_u8(acc, acc);
+        uint64_t mask = vget_lane_u64(
+            vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(nonzero), 4)), 0);
+        if (mask != 0) {
+            return i + (static_cast<size_t>(__builtin_ctzll(mask)) >> 2);
+        }
+    }
+
+    return NextCandidateScalar(self, data, len, i);
+}
+
+#else
+
+size_t MultiPattern::NextCandidateTeddyNeon(const MultiPattern* self, const uint8_t* data, size_t len, size_t from) {
+    return NextCandidateScalar(self, data, len, from);
+}
+
+#endif  // HAS_ARM_SIMD
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Compiled literal pattern set.
+//
+// Matching is an Aho-Corasick DFA over byte equivalence classes. Whenever the
+// automaton is back at its root no match can be in progress, so a prefilter
+// skips ahead to the next position where some pattern could start: a
+// Teddy-style nibble-mask SIMD scan over the first 1-3 pattern bytes (SSSE3 /
+// AVX2 / NEON) for small sets, a first-byte table otherwise. Both paths report
+// exactly the same matches as running the automaton over every byte.
+
+class MultiPattern {
+public:
+    // Patterns must be non-empty. With caseInsensitive, ASCII letters match
+    // either case.
+    MultiPattern(const std::vector<std::string>& patterns, bool caseInsensitive);
+
+    // Reports every occurrence of every pattern (overlaps included) in order
+    // of match end; ties are reported in pattern order. onMatch(patternId,
+    // startOffset) returns false to stop the scan early.
+    template <typename OnMatch>
+    void Scan(const uint8_t* data, size_t len, OnMatch onMatch) const {
+        uint32_t state = 0;
+        size_t i = 0;
+        while (i < len) {
+            if (state == 0) {
+                i = next_candidate_(this, data, len, i);
+                if (i >= len) {
+                    break;
+                }
+            }
+            state = transitions_[state * class_count_ + byte_class_[data[i]]];
+            for (uint32_t o = output_offsets_[state]; o < output_offsets_[state + 1]; o++) {
+                uint32_t id = outputs_[o];
+                if (!onMatch(id, i + 1 - pattern_lengths_[id])) {
+                    return;
+                }
+            }
+            i++;
+        }
+    }
+
+    size_t PatternCount() const { return pattern_lengths_.size(); }
+    size_t StateCount() const { return output_offsets_.size() - 1; }
+    bool UsesTeddy() const { return teddy_len_ > 0; }
+
+private:
+    using CandidateFn = size_t (*)(const MultiPattern* self, const uint8_t* data, size_t len, size_t from);
+
+    void BuildAutomaton(const std::vector<std::string>& patterns);
+    void BuildPrefilter(const std::vector<std::string>& patterns);
+
+    static size_t NextCandidateScalar(const MultiPattern* self, const uint8_t* data, size_t len, size_t from);
+    static size_t NextCandidateTeddySsse3(const MultiPattern* self, const uint8_t* data, size_t len, size_t from);
+    static size_t NextCandidateTeddyAvx2(const MultiPattern* self, const uint8_t* data, size_t len, size_t from);
+    static size_t NextCandidateTeddyNeon(const MultiPattern* self, const uint8_t* data, size_t len, size_t from);
+
+    bool case_insensitive_;
+
+    // Automaton: dense transitions per (state, byte class); outputs flattened
+    // along the suffix links so each state lists every pattern ending there.
+    uint8_t byte_class_[256];
+    uint32_t class_count_ = 1;
+    std::vector<uint32_t> transitions_;
+    std::vector<uint32_t> output_offsets_;
+    std::vector<uint32_t> outputs_;
+    std::vector<uint32_t> pattern_lengths_;
+
+    // Prefilter
+    CandidateFn next_candidate_ = NextCandidateScalar;
+    bool start_byte_[256];
+    size_t teddy_len_ = 0;            // 0 = Teddy disabled, else bytes examined
+    alignas(16) uint8_t teddy_lo_[3][16];
+    alignas(16) uint8_t teddy_hi_[3][16];
+};
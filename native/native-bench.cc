@@ -0,0 +1,318 @@
+// Google Benchmark binary for the N-API free kernels behind the addon.
+//
+// Each kernel is paired with a plain C++ reference so a SIMD branch that
+// silently falls back to scalar code (or stops being selected) shows up as
+// a ratio near 1 instead of hiding behind N-API call overhead. The
+// Node-side harness in scripts/bench-native.mjs covers the exports as JS
+// sees them, including the regression checks.
+//
+//   node-gyp rebuild --openclaw_benchmark=1
+//   build/Release/native_bench --benchmark_filter=Sum
+//
+// Byte sizes grow x16 from 64 B to 1 GiB; pass --benchmark_filter to skip
+// the large ones on small machines.
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "cpu-features.h"
+#include "markdown-chunker.h"
+#include "multi-pattern.h"
+#include "parallel-ops.h"
+#include "pattern-search.h"
+#include "sha256.h"
+#include "simd-kernels.h"
+#include "vector-ops.h"
+
+namespace {
+
+constexpr int64_t kMinBytes = 64;
+constexpr int64_t kMaxBytes = int64_t{1} << 30;
+
+// Deterministic text-like bytes (same generator as bench-native.mjs):
+// mostly lower-case letters and spaces, a newline every ~32 bytes. Grown on
+// demand, so filtered runs never touch the 1 GiB sizes; the prefix is the
+// same at every size.
+const uint8_t* Corpus(size_t n) {
+    static std::vector<uint8_t> corpus;
+    if (corpus.size() < n) {
+        corpus.resize(n);
+        uint32_t seed = 0x9e3779b9;
+        for (auto& b : corpus) {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            uint32_t r = seed % 32;
+            b = r < 26 ? static_cast<uint8_t>('a' + r) : r < 31 ? ' ' : '\n';
+        }
+    }
+    return corpus.data();
+}
+
+// A copy of the first n corpus bytes differing only in its last byte
+std::vector<uint8_t> NearCopy(size_t n) {
+    const uint8_t* corpus = Corpus(n);
+    std::vector<uint8_t> copy(corpus, corpus + n);
+    copy[n - 1] ^= 1;
+    return copy;
+}
+
+// Sizes from Lo to Hi, x16 apart (Range() would snap to powers of 16)
+template <int64_t Lo, int64_t Hi>
+void Sizes(benchmark::internal::Benchmark* b) {
+    for (int64_t n = Lo; n <= Hi; n *= 16) {
+        b->Arg(n);
+    }
+}
+
+constexpr auto ByteSizes = Sizes<kMinBytes, kMaxBytes>;
+
+void SetBytes(benchmark::State& state, int64_t perIteration) {
+    state.SetBytesProcessed(state.iterations() * perIteration);
+}
+
+const uint8_t kNeedle[] = {'z', 'q', 'x', 'j', 'k'};
+
+// ---------------------------------------------------------------------------
+// Byte kernels
+// ---------------------------------------------------------------------------
+
+void BM_SumBytes(benchmark::State& state) {
+    size_t len = static_cast<size_t>(state.range(0));
+    const uint8_t* data = Corpus(len);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(SumBytes(data, len));
+    }
+    SetBytes(state, state.range(0));
+}
+BENCHMARK(BM_SumBytes)->Apply(ByteSizes);
+
+void BM_SumBytesReference(benchmark::State& state) {
+    size_t len = static_cast<size_t>(state.range(0));
+    const uint8_t* data = Corpus(len);
+    for (auto _ : state) {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < len; i++) {
+            sum += data[i];
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    SetBytes(state, state.range(0));
+}
+BENCHMARK(BM_SumBytesReference)->Apply(ByteSizes);
+
+void BM_ParallelSumBytes(benchmark::State& state) {
+    size_t len = static_cast<size_t>(state.range(0));
+    const uint8_t* data = Corpus(len);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ParallelSumBytes(data, len));
+    }
+    SetBytes(state, state.range(0));
+}
+BENCHMARK(BM_ParallelSumBytes)->Apply(Sizes<int64_t{kParallelMinBytes}, kMaxBytes>)->UseRealTime();
+
+void BM_AndBytes(benchmark::State& state) {
+    size_t len = static_cast<size_t>(state.range(0));
+    const uint8_t* a = Corpus(len);
+    std::vector<uint8_t> b = NearCopy(len);
+    std::vector<uint8_t> out(len);
+    for (auto _ : state) {
+        AndBytes(a, b.data(), out.data(), len);
+        benchmark::ClobberMemory();
+    }
+    SetBytes(state, state.range(0));
+}
+BENCHMARK(BM_AndBytes)->Apply(ByteSizes);
+
+void BM_AndBytesReference(benchmark::State& state) {
+    size_t len = static_cast<size_t>(state.range(0));
+    const uint8_t* a = Corpus(len);
+    std::vector<uint8_t> b = NearCopy(len);
+    std::vector<uint8_t> out(len);
+    for (auto _ : state) {
+        for (size_t i = 0; i < len; i++) {
+            out[i] = a[i] & b[i];
+        }
+        benchmark::ClobberMemory();
+    }
+    SetBytes(state, state.range(0));
+}
+BENCHMARK(BM_AndBytesReference)->Apply(ByteSizes);
+
+void BM_Compare(benchmark::State& state) {
+    size_t len = static_cast<size_t>(state.range(0));
+    const uint8_t* a = Corpus(len);
+    std::vector<uint8_t> b = NearCopy(len);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ParallelCompare(a, b.data(), len));
+    }
+    SetBytes(state, state.range(0));
+}
+BENCHMARK(BM_Compare)->Apply(ByteSizes)->UseRealTime();
+
+// ---------------------------------------------------------------------------
+// Pattern search
+// ---------------------------------------------------------------------------
+
+void BM_PatternFind(benchmark::State& state) {
+    PatternSearcher searcher(kNeedle, sizeof(kNeedle));
+    size_t len = static_cast<size_t>(state.range(0));
+    const uint8_t* data = Corpus(len);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(searcher.Find(data, len));
+    }
+    SetBytes(state, state.range(0));
+}
+BENCHMARK(BM_PatternFind)->Apply(ByteSizes);
+
+// std::search is the memcmp-at-every-offset scan FindPattern used to be
+void BM_PatternFindReference(benchmark::State& state) {
+    size_t len = static_cast<size_t>(state.range(0));
+    const uint8_t* data = Corpus(len);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(std::search(data, data + len, kNeedle, kNeedle + sizeof(kNeedle)));
+    }
+    SetBytes(state, state.range(0));
+}
+BENCHMARK(BM_PatternFindReference)->Apply(ByteSizes);
+
+void BM_PatternCount(benchmark::State& state) {
+    // Frequent needle: exercises the verify path, not just the filter
+    static const uint8_t needle[] = {' ', 'a'};
+    PatternSearcher searcher(needle, sizeof(needle));
+    size_t len = static_cast<size_t>(state.range(0));
+    const uint8_t* data = Corpus(len);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(searcher.Count(data, len));
+    }
+    SetBytes(state, state.range(0));
+}
+BENCHMARK(BM_PatternCount)->Apply(ByteSizes);
+
+void BM_MultiPatternScan(benchmark::State& state) {
+    static const MultiPattern matcher(
+        {"message_id", "zqxjk", "envelope", "[from:", "qqqq", "x-openclaw", "jjkk", "vvwx"}, false);
+    size_t len = static_cast<size_t>(state.range(0));
+    const uint8_t* data = Corpus(len);
+    for (auto _ : state) {
+        size_t hits = 0;
+        matcher.Scan(data, len, [&](uint32_t, size_t) {
+            hits++;
+            return true;
+        });
+        benchmark::DoNotOptimize(hits);
+    }
+    SetBytes(state, state.range(0));
+}
+BENCHMARK(BM_MultiPatternScan)->Apply(ByteSizes);
+
+// ---------------------------------------------------------------------------
+// Hashing and chunking
+// ---------------------------------------------------------------------------
+
+void BM_Sha256(benchmark::State& state) {
+    uint8_t digest[kSha256DigestSize];
+    size_t len = static_cast<size_t>(state.range(0));
+    const uint8_t* data = Corpus(len);
+    for (auto _ : state) {
+        Sha256Digest(data, len, digest);
+        benchmark::DoNotOptimize(digest);
+    }
+    SetBytes(state, state.range(0));
+}
+BENCHMARK(BM_Sha256)->Apply(Sizes<kMinBytes, (256 << 20)>);
+
+void BM_ChunkMarkdown(benchmark::State& state) {
+    MarkdownChunkOptions options;
+    options.tokens = 400;
+    options.overlap = 80;
+    size_t len = static_cast<size_t>(state.range(0));
+    const uint8_t* data = Corpus(len);
+    for (auto _ : state) {
+        MarkdownChunks chunks;
+        benchmark::DoNotOptimize(ChunkMarkdown(data, len, options, &chunks));
+    }
+    SetBytes(state, state.range(0));
+}
+BENCHMARK(BM_ChunkMarkdown)->Apply(Sizes<kMinBytes, (256 << 20)>);
+
+// ---------------------------------------------------------------------------
+// Vector scoring (memory search fallback)
+// ---------------------------------------------------------------------------
+
+constexpr size_t kDims = 384;
+
+struct Vectors {
+    std::vector<float> matrix;
+    size_t rows;
+};
+
+Vectors MakeVectors(size_t bytes) {
+    Vectors v;
+    v.rows = std::max<size_t>(1, bytes / (kDims * sizeof(float)));
+    v.matrix.resize(v.rows * kDims);
+    const uint8_t* corpus = Corpus(v.matrix.size());
+    for (size_t i = 0; i < v.matrix.size(); i++) {
+        v.matrix[i] = (static_cast<float>(corpus[i]) - 96.0f) / 32.0f;
+    }
+    return v;
+}
+
+void BM_TopKCosine(benchmark::State& state) {
+    Vectors v = MakeVectors(static_cast<size_t>(state.range(0)));
+    VectorMatrix m{v.matrix.data(), VectorElement::kF32, v.rows, kDims, nullptr};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(TopKRows(v.matrix.data(), m, VectorMetric::kCosine, 10, 0, v.rows));
+    }
+    SetBytes(state, static_cast<int64_t>(v.matrix.size() * sizeof(float)));
+    state.counters["rows"] = static_cast<double>(v.rows);
+}
+BENCHMARK(BM_TopKCosine)->Apply(Sizes<int64_t{kDims * 4}, (256 << 20)>);
+
+// The JS cosineSimilarity loop, row by row, plus a full sort
+void BM_TopKCosineReference(benchmark::State& state) {
+    Vectors v = MakeVectors(static_cast<size_t>(state.range(0)));
+    const float* q = v.matrix.data();
+    std::vector<ScoredRow> scored(v.rows);
+    for (auto _ : state) {
+        for (size_t row = 0; row < v.rows; row++) {
+            const float* r = v.matrix.data() + row * kDims;
+            double dot = 0, qq = 0, rr = 0;
+            for (size_t j = 0; j < kDims; j++) {
+                dot += q[j] * r[j];
+                qq += q[j] * q[j];
+                rr += r[j] * r[j];
+            }
+            scored[row] = {static_cast<uint32_t>(row),
+                           qq == 0 || rr == 0 ? 0.0f : static_cast<float>(dot / std::sqrt(qq * rr))};
+        }
+        std::sort(scored.begin(), scored.end(),
+                  [](const ScoredRow& a, const ScoredRow& b) { return a.score > b.score; });
+        benchmark::DoNotOptimize(scored.data());
+    }
+    SetBytes(state, static_cast<int64_t>(v.matrix.size() * sizeof(float)));
+}
+BENCHMARK(BM_TopKCosineReference)->Apply(Sizes<int64_t{kDims * 4}, (256 << 20)>);
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    InitSimdKernels();
+    InitPatternSearch();
+    InitVectorKernels();
+    InitSha256();
+    InitMarkdownChunker();
+
+    benchmark::AddCustomContext("simd_level", SimdLevelName());
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
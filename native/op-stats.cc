@@ -0,0 +1,167 @@
+#include "op-stats.h"
+#include <atomic>
+#include <mutex>
+
+static const char* const kOpNames[] = {
+    "base64.decode",
+    "base64.encode",
+    "utf8.validate",
+    "ws.mask",
+    "markdown.chunk",
+    "files.hash",
+    "transcript.scan",
+    "vector.topk",
+    "hnsw.search",
+    "keyword.search",
+    "embedding_cache.lookup",
+    "tokenizer.count",
+    "tokenizer.encode",
+    "audio.resample",
+    "audio.g711",
+    "audio.vad",
+    "image.resize_jpeg",
+    "event_bus.publish",
+    "event_bus.read",
+};
+
+static_assert(sizeof(kOpNames) / sizeof(kOpNames[0]) == static_cast<size_t>(NativeOp::kCount),
+              "every NativeOp needs a name");
+
+const char* NativeOpName(NativeOp op) {
+    return kOpNames[static_cast<size_t>(op)];
+}
+
+static std::atomic<bool> enabled{false};
+
+void SetOpStatsEnabled(bool value) {
+    enabled.store(value, std::memory_order_relaxed);
+}
+
+bool OpStatsEnabled() {
+    return enabled.load(std::memory_order_relaxed);
+}
+
+// Values below 8 get a bucket each; above, the top bit picks the power of
+// two and the next three bits the sub-bucket
+static const int kSubBucketBits = 3;
+static const int kMaxTopBit = 40;
+
+static size_t BucketFor(uint64_t nanos) {
+    if (nanos < (1u << kSubBucketBits)) {
+        return static_cast<size_t>(nanos);
+    }
+    int top = 63 - __builtin_clzll(nanos);
+    if (top > kMaxTopBit) {
+        return kOpLatencyBuckets - 1;
+    }
+    int shift = top - kSubBucketBits;
+    return static_cast<size_t>(top - kSubBucketBits + 1) << kSubBucketBits |
+           static_cast<size_t>((nanos >> shift) & ((1u << kSubBucketBits) - 1));
+}
+
+static_assert(((kMaxTopBit - kSubBucketBits + 2) << kSubBucketBits) == kOpLatencyBuckets,
+              "bucket count must cover kMaxTopBit");
+
+uint64_t OpLatencyBucketMax(size_t bucket) {
+    if (bucket < (1u << kSubBucketBits)) {
+        return bucket;
+    }
+    int shift = static_cast<int>(bucket >> kSubBucketBits) - 1;
+    uint64_t sub = (bucket & ((1u << kSubBucketBits) - 1)) + (1u << kSubBucketBits);
+    return ((sub + 1) << shift) - 1;
+}
+
+namespace {
+
+struct Counters {
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> total_ns{0};
+    std::atomic<uint64_t> buckets[kOpLatencyBuckets] = {};
+};
+
+// Only the owning thread writes, so increments are plain load + store
+inline void Bump(std::atomic<uint64_t>& counter, uint64_t n) {
+    counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+struct ThreadBlock {
+    Counters ops[static_cast<size_t>(NativeOp::kCount)];
+};
+
+void AddInto(OpStats* out, const Counters& counters) {
+    out->calls += counters.calls.load(std::memory_order_relaxed);
+    out->bytes += counters.bytes.load(std::memory_order_relaxed);
+    out->total_ns += counters.total_ns.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < kOpLatencyBuckets; i++) {
+        out->buckets[i] += counters.buckets[i].load(std::memory_order_relaxed);
+    }
+}
+
+// Never destroyed: threads may exit after static destructors have run
+struct Registry {
+    std::mutex mutex;
+    std::vector<ThreadBlock*> live;
+    std::vector<OpStats> retired = std::vector<OpStats>(static_cast<size_t>(NativeOp::kCount));
+};
+
+Registry& GetRegistry() {
+    static Registry* registry = new Registry();
+    return *registry;
+}
+
+struct ThreadSlot {
+    ThreadBlock* block = nullptr;
+
+    ThreadBlock* Get() {
+        if (!block) {
+            block = new ThreadBlock();
+            Registry& registry = GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.live.push_back(block);
+        }
+        return block;
+    }
+
+    ~ThreadSlot() {
+        if (!block) {
+            return;
+        }
+        Registry& registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        for (size_t op = 0; op < static_cast<size_t>(NativeOp::kCount); op++) {
+            AddInto(&registry.retired[op], block->ops[op]);
+        }
+        for (size_t i = 0; i < registry.live.size(); i++) {
+            if (registry.live[i] == block) {
+                registry.live[i] = registry.live.back();
+                registry.live.pop_back();
+                break;
+            }
+        }
+        delete block;
+    }
+};
+
+thread_local ThreadSlot slot;
+
+}  // namespace
+
+void RecordOp(NativeOp op, uint64_t bytes, uint64_t nanos) {
+    Counters& counters = slot.Get()->ops[static_cast<size_t>(op)];
+    Bump(counters.calls, 1);
+    Bump(counters.bytes, bytes);
+    Bump(counters.total_ns, nanos);
+    Bump(counters.buckets[BucketFor(nanos)], 1);
+}
+
+void SnapshotOpStats(std::vector<OpStats>* out) {
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    out->assign(registry.retired.begin(), registry.retired.end());
+    for (ThreadBlock* block : registry.live) {
+        for (size_t op = 0; op < static_cast<size_t>(NativeOp::kCount); op++) {
+            AddInto(&(*out)[op], block->ops[op]);
+        }
+    }
+}
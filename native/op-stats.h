@@ -0,0 +1,97 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Call, byte and latency counters for the addon's hot entry points. N-API
+// free.
+//
+// Every thread that records gets its own counter block, registered on first
+// use and folded into a shared block when the thread exits, so recording is
+// a clock read plus relaxed stores to memory no other thread writes.
+// Latency goes into a log-linear (HDR-style) histogram of nanoseconds: 8
+// sub-buckets per power of two, so a bucket is within 12.5% of its values,
+// up to 2^41 ns (about 37 minutes).
+//
+// Recording is off until SetOpStatsEnabled(true); a disabled OpScope costs
+// one relaxed load.
+
+enum class NativeOp : uint8_t {
+    kBase64Decode,
+    kBase64Encode,
+    kUtf8Validate,
+    kWsMask,
+    kChunkMarkdown,
+    kHashFiles,
+    kScanTranscript,
+    kTopK,
+    kHnswSearch,
+    kKeywordSearch,
+    kEmbeddingCacheLookup,
+    kTokenizerCount,
+    kTokenizerEncode,
+    kAudioResample,
+    kAudioG711,
+    kAudioVad,
+    kResizeJpeg,
+    kEventBusPublish,
+    kEventBusRead,
+    kCount,
+};
+
+// Dotted name reported in snapshots, e.g. "base64.decode"
+const char* NativeOpName(NativeOp op);
+
+void SetOpStatsEnabled(bool enabled);
+bool OpStatsEnabled();
+
+constexpr size_t kOpLatencyBuckets = 312;
+
+// Largest latency in nanoseconds that lands in `bucket`; the last bucket
+// also takes everything above it
+uint64_t OpLatencyBucketMax(size_t bucket);
+
+struct OpStats {
+    uint64_t calls = 0;
+    uint64_t bytes = 0;
+    uint64_t total_ns = 0;
+    uint64_t buckets[kOpLatencyBuckets] = {};
+};
+
+// Totals over every thread since start, indexed by NativeOp
+void SnapshotOpStats(std::vector<OpStats>* out);
+
+void RecordOp(NativeOp op, uint64_t bytes, uint64_t nanos);
+
+// Times its scope and records it on destruction. `bytes` is the input size;
+// use AddBytes when it is only known later.
+class OpScope {
+public:
+    explicit OpScope(NativeOp op, size_t bytes = 0)
+        : op_(op), bytes_(bytes), enabled_(OpStatsEnabled()) {
+        if (enabled_) {
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~OpScope() {
+        if (enabled_) {
+            auto elapsed = std::chrono::steady_clock::now() - start_;
+            RecordOp(op_, bytes_,
+                     static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+    }
+
+    void AddBytes(size_t bytes) { bytes_ += bytes; }
+
+    OpScope(const OpScope&) = delete;
+    OpScope& operator=(const OpScope&) = delete;
+
+private:
+    NativeOp op_;
+    uint64_t bytes_;
+    bool enabled_;
+    std::chrono::steady_clock::time_point start_;
+};
@@ -0,0 +1,215 @@
+#include "parallel-ops.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <vector>
+#include "pattern-search.h"
+#include "simd-kernels.h"
+#include "thread-pool.h"
+
+// At least 1 MiB per chunk, and about four chunks per thread so uneven
+// progress balances out and searches stop soon after the first hit.
+static constexpr size_t kMinChunkBytes = 1u << 20;
+static constexpr size_t kChunksPerThread = 4;
+
+struct ChunkSplit {
+    size_t size;
+    size_t count;
+};
+
+static ChunkSplit SplitRange(size_t len) {
+    if (len < kParallelMinBytes) {
+        return {len, 1};
+    }
+    size_t threads = ThreadPool::Shared().Concurrency();
+    size_t size = std::max(kMinChunkBytes, len / (threads * kChunksPerThread));
+    // Whole cache lines, so neighbouring writers never share one
+    size = (size + 63) & ~static_cast<size_t>(63);
+    return {size, (len + size - 1) / size};
+}
+
+static void StoreMin(std::atomic<size_t>& target, size_t value) {
+    size_t current = target.load(std::memory_order_relaxed);
+    while (value < current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+static int Sign(int v) {
+    return (v > 0) - (v < 0);
+}
+
+uint64_t ParallelSumBytes(const uint8_t* data, size_t len) {
+    ChunkSplit split = SplitRange(len);
+    if (split.count == 1) {
+        return SumBytes(data, len);
+    }
+
+    std::vector<uint64_t> partial(split.count);
+    ThreadPool::Shared().ParallelFor(split.count, [&](size_t i) {
+        size_t start = i * split.size;
+        partial[i] = SumBytes(data + start, std::min(split.size, len - start));
+    });
+
+    uint64_t sum = 0;
+    for (uint64_t p : partial) {
+        sum += p;
+    }
+    return sum;
+}
+
+void ParallelAndBytes(const uint8_t* a, const uint8_t* b, uint8_t* out, size_t len) {
+    ChunkSplit split = SplitRange(len);
+    if (split.count == 1) {
+        AndBytes(a, b, out, len);
+        return;
+    }
+
+    ThreadPool::Shared().ParallelFor(split.count, [&](size_t i) {
+        size_t start = i * split.size;
+        AndBytes(a + start, b + start, out + start, std::min(split.size, len - start));
+    });
+}
+
+void ParallelCopy(uint8_t* dst, const uint8_t* src, size_t len) {
+    ChunkSplit split = SplitRange(len);
+    if (split.count == 1) {
+        std::memcpy(dst, src, len);
+        return;
+    }
+
+    ThreadPool::Shared().ParallelFor(split.count, [&](size_t i) {
+        size_t start = i * split.size;
+        std::memcpy(dst + start, src + start, std::min(split.size, len - start));
+    });
+}
+
+int ParallelCompare(const uint8_t* a, const uint8_t* b, size_t len) {
+    ChunkSplit split = SplitRange(len);
+    if (split.count == 1) {
+        return Sign(std::memcmp(a, b, len));
+    }
+
+    // Only the first differing chunk decides; later chunks are skipped
+    std::atomic<size_t> first_diff{SIZE_MAX};
+    std::vector<int> result(split.count, 0);
+    ThreadPool::Shared().ParallelFor(split.count, [&](size_t i) {
+        if (i > first_diff.load(std::memory_order_relaxed)) {
+            return;
+        }
+        size_t start = i * split.size;
+        int r = std::memcmp(a + start, b + start, std::min(split.size, len - start));
+        if (r != 0) {
+            result[i] = r;
+            StoreMin(first_diff, i);
+        }
+    });
+
+    size_t first = first_diff.load();
+    return first == SIZE_MAX ? 0 : Sign(result[first]);
+}
+
+size_t ParallelFind(const PatternSearcher& searcher, const uint8_t* haystack, size_t len, size_t from) {
+    size_t nlen = searcher.NeedleLength();
+    if (from >= len || nlen == 0 || nlen > len - from) {
+        return searcher.Find(haystack, len, from);
+    }
+
+    ChunkSplit split = SplitRange(len - from);
+    if (split.count == 1 || nlen > split.size) {
+        return searcher.Find(haystack, len, from);
+    }
+
+    std::atomic<size_t> best{kPatternNotFound};
+    ThreadPool::Shared().ParallelFor(split.count, [&](size_t i) {
+        size_t start = from + i * split.size;
+        if (start >= best.load(std::memory_order_relaxed)) {
+            return;
+        }
+        size_t end = std::min(start + split.size, len);
+        // A match starting before `end` may run nlen - 1 bytes past it
+        size_t window = std::min(end + nlen - 1, len);
+        size_t pos = searcher.Find(haystack, window, start);
+        if (pos != kPatternNotFound) {
+            StoreMin(best, pos);
+        }
+    });
+    return best.load();
+}
+
+size_t ParallelCount(const PatternSearcher& searcher, const uint8_t* haystack, size_t len) {
+    size_t nlen = searcher.NeedleLength();
+    if (nlen == 0 || nlen > len) {
+        return searcher.Count(haystack, len);
+    }
+
+    ChunkSplit split = SplitRange(len);
+    if (split.count == 1 || nlen > split.size) {
+        return searcher.Count(haystack, len);
+    }
+
+    struct ChunkHits {
+        size_t count = 0;
+        size_t first = kPatternNotFound;  // offset of the first match
+        size_t next = 0;                  // end of the last match
+    };
+    std::vector<ChunkHits> hits(split.count);
+
+    auto window_end = [&](size_t start) {
+        return std::min(std::min(start + split.size, len) + nlen - 1, len);
+    };
+
+    ThreadPool::Shared().ParallelFor(split.count, [&](size_t i) {
+        size_t start = i * split.size;
+        ChunkHits& h = hits[i];
+        h.count = searcher.ForEach(haystack + start, window_end(start) - start, 0, [&](size_t pos) {
+            if (h.first == kPatternNotFound) {
+                h.first = start + pos;
+            }
+            h.next = start + pos + nlen;
+        });
+    });
+
+    // Non-overlapping matching is greedy left to right, so a match running
+    // into the next chunk can shift that chunk's matches. When a chunk's
+    // first match starts at or after the carried position its greedy run is
+    // already the global one; otherwise rescan it from the carry.
+    size_t total = 0;
+    size_t carry = 0;
+    for (size_t i = 0; i < split.count; i++) {
+        const ChunkHits& h = hits[i];
+        if (h.first == kPatternNotFound) {
+            continue;
+        }
+        if (h.first >= carry) {
+            total += h.count;
+            carry = h.next;
+            continue;
+        }
+
+        size_t start = carry;
+        size_t last_end = carry;
+        total += searcher.ForEach(haystack + start, window_end(i * split.size) - start, 0, [&](size_t pos) {
+            last_end = start + pos + nlen;
+        });
+        carry = last_end;
+    }
+    return total;
+}
+
+std::vector<ScoredRow> ParallelTopK(const float* query, const VectorMatrix& m, VectorMetric metric, size_t k) {
+    size_t row_bytes = std::max<size_t>(1, VectorRowStride(m));
+    ChunkSplit split = SplitRange(m.rows * row_bytes);
+    size_t rows_per_chunk = std::max<size_t>(1, split.size / row_bytes);
+    if (split.count == 1 || rows_per_chunk >= m.rows) {
+        return TopKRows(query, m, metric, k, 0, m.rows);
+    }
+
+    size_t chunks = (m.rows + rows_per_chunk - 1) / rows_per_chunk;
+    std::vector<std::vector<ScoredRow>> parts(chunks);
+    ThreadPool::Shared().ParallelFor(chunks, [&](size_t i) {
+        size_t begin = i * rows_per_chunk;
+        parts[i] = TopKRows(query, m, metric, k, begin, std::min(begin + rows_per_chunk, m.rows));
+    });
+    return MergeTopK(parts, metric, k);
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "vector-ops.h"
+
+class PatternSearcher;
+
+// Chunked versions of the byte kernels that split large inputs across
+// ThreadPool::Shared() and merge the partial results. They return exactly
+// what the sequential kernels return. Inputs below kParallelMinBytes run on
+// the calling thread.
+//
+// Meant for AsyncWorker::Execute: the caller works on one chunk itself and
+// blocks until all are done.
+
+constexpr size_t kParallelMinBytes = 4u << 20;
+
+uint64_t ParallelSumBytes(const uint8_t* data, size_t len);
+
+void ParallelAndBytes(const uint8_t* a, const uint8_t* b, uint8_t* out, size_t len);
+
+// memcpy; the ranges must not overlap.
+void ParallelCopy(uint8_t* dst, const uint8_t* src, size_t len);
+
+// Sign of memcmp(a, b, len): -1, 0 or 1.
+int ParallelCompare(const uint8_t* a, const uint8_t* b, size_t len);
+
+// Same result as searcher.Find(haystack, len, from).
+size_t ParallelFind(const PatternSearcher& searcher, const uint8_t* haystack, size_t len, size_t from);
+
+// Same result as searcher.Count(haystack, len): non-overlapping matches.
+size_t ParallelCount(const PatternSearcher& searcher, const uint8_t* haystack, size_t len);
+
+// Same result as TopKRows over every row of `m`, split by rows.
+std::vector<ScoredRow> ParallelTopK(const float* query, const VectorMatrix& m, VectorMetric metric, size_t k);
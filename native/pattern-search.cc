@@ -0,0 +1,363 @@
+#include "pattern-search.h"
+#include "cpu-features.h"
+
+#include <cstring>
+#include <mutex>
+
+#if defined(HAS_X86_SIMD)
+  #include <immintrin.h>
+#elif defined(HAS_ARM_SIMD)
+  #include <arm_neon.h>
+#endif
+
+// Needles longer than this skip the byte filter: verification cost grows
+// with the needle while Two-Way stays linear.
+static constexpr size_t kFilterMaxNeedle = 64;
+
+// Given up on the filter once verification has touched this many bytes more
+// than 4x the haystack scanned so far (e.g. "aaa...ab" in "aaaa...").
+static constexpr size_t kFilterBailSlack = 4096;
+
+// A filter scans from `from` until fewer than one full vector of candidate
+// positions remain. It returns a match, or kPatternNotFound with *resume at
+// the first unscanned position; *bail reports that it stopped early because
+// candidates were too dense.
+using FilterFn = size_t (*)(const uint8_t* h, size_t hlen, const uint8_t* n, size_t nlen,
+                            size_t from, size_t* resume, bool* bail);
+
+static inline bool VerifyMiddle(const uint8_t* h, const uint8_t* n, size_t nlen) {
+    // First and last bytes are already known to match
+    return nlen <= 2 || std::memcmp(h + 1, n + 1, nlen - 2) == 0;
+}
+
+static inline bool FilterShouldBail(size_t work, size_t scanned, size_t nlen) {
+    return nlen > 16 && work > kFilterBailSlack + 4 * scanned;
+}
+
+static size_t FilterScalar(const uint8_t* h, size_t hlen, const uint8_t* n, size_t nlen,
+                           size_t from, size_t* resume, bool* bail) {
+    *resume = from;
+    *bail = false;
+    return kPatternNotFound;
+}
+
+#if defined(HAS_X86_DISPATCH)
+
+OPENCLAW_TARGET("sse2")
+static size_t FilterSse2(const uint8_t* h, size_t hlen, const uint8_t* n, size_t nlen,
+                         size_t from, size_t* resume, bool* bail) {
+    const __m128i first = _mm_set1_epi8(static_cast<char>(n[0]));
+    const __m128i last = _mm_set1_epi8(static_cast<char>(n[nlen - 1]));
+    size_t work = 0;
+    size_t i = from;
+    *bail = false;
+
+    for (; i + 16 + nlen - 1 <= hlen; i += 16) {
+        __m128i bf = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + i));
+        __m128i bl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + i + nlen - 1));
+        unsigned mask = static_cast<unsigned>(
+            _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(bf, first), _mm_cmpeq_epi8(bl, last))));
+        while (mask != 0) {
+            size_t pos = i + static_cast<size_t>(__builtin_ctz(mask));
+            if (VerifyMiddle(h + pos, n, nlen)) {
+                return pos;
+            }
+            work += nlen;
+            mask &= mask - 1;
+        }
+        if (FilterShouldBail(work, i - from, nlen)) {
+            *bail = true;
+            i += 16;
+            break;
+        }
+    }
+
+    *resume = i;
+    return kPatternNotFound;
+}
+
+OPENCLAW_TARGET("avx2")
+static size_t FilterAvx2(const uint8_t* h, size_t hlen, const uint8_t* n, size_t nlen,
+                         size_t from, size_t* resume, bool* bail) {
+    const __m256i first = _mm256_set1_epi8(static_cast<char>(n[0]));
+    const __m256i last = _mm256_set1_epi8(static_cast<char>(n[nlen - 1]));
+    size_t work = 0;
+    size_t i = from;
+    *bail = false;
+
+    for (; i + 32 + nlen - 1 <= hlen; i += 32) {
+        __m256i bf = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + i));
+        __m256i bl = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + i + nlen - 1));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(bf, first), _mm256_cmpeq_epi8(bl, last))));
+        while (mask != 0) {
+            size_t pos = i + static_cast<size_t>(__builtin_ctz(mask));
+            if (VerifyMiddle(h + pos, n, nlen)) {
+                return pos;
+            }
+            work += nlen;
+            mask &= mask - 1;
+        }
+        if (FilterShouldBail(work, i - from, nlen)) {
+            *bail = true;
+            i += 32;
+            break;
+        }
+    }
+
+    *resume = i;
+    return kPatternNotFound;
+}
+
+OPENCLAW_TARGET("avx512f,avx512bw")
+static size_t FilterAvx512(const uint8_t* h, size_t hlen, const uint8_t* n, size_t nlen,
+                           size_t from, size_t* resume, bool* bail) {
+    const __m512i first = _mm512_set1_epi8(static_cast<char>(n[0]));
+    const __m512i last = _mm512_set1_epi8(static_cast<char>(n[nlen - 1]));
+    size_t work = 0;
+    size_t i = from;
+    *bail = false;
+
+    for (; i + 64 + nlen - 1 <= hlen; i += 64) {
+        __m512i bf = _mm512_loadu_si512(h + i);
+        __m512i bl = _mm512_loadu_si512(h + i + nlen - 1);
+        uint64_t mask = _mm512_cmpeq_epi8_mask(bf, first) & _mm512_cmpeq_epi8_mask(bl, last);
+        while (mask != 0) {
+            size_t pos = i + static_cast<size_t>(__builtin_ctzll(mask));
+            if (VerifyMiddle(h + pos, n, nlen)) {
+                return pos;
+            }
+            work += nlen;
+            mask &= mask - 1;
+        }
+        if (FilterShouldBail(work, i - from, nlen)) {
+            *bail = true;
+            i += 64;
+            break;
+        }
+    }
+
+    *resume = i;
+    return kPatternNotFound;
+}
+
+#endif  // HAS_X86_DISPATCH
+
+#if defined(HAS_ARM_SIMD)
+
+static size_t FilterNeon(const uint8_t* h, size_t hlen, const uint8_t* n, size_t nlen,
+                         size_t from, size_t* resume, bool* bail) {
+    const uint8x16_t first = vdupq_n_u8(n[0]);
+    const uint8x16_t last = vdupq_n_u8(n[nlen - 1]);
+    size_t work = 0;
+    size_t i = from;
+    *bail = false;
+
+    for (; i + 16 + nlen - 1 <= hlen; i += 16) {
+        uint8x16_t eq = vandq_u8(vceqq_u8(vld1q_u8(h + i), first),
+                                 vceqq_u8(vld1q_u8(h + i + nlen - 1), last));
+        // Narrow to a 64-bit mask with one nibble per byte lane
+        uint64_t mask = vget_lane_u64(
+            vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+        while (mask != 0) {
+            unsigned lane = static_cast<unsigned>(__builtin_ctzll(mask)) >> 2;
+            size_t pos = i + lane;
+            if (VerifyMiddle(h + pos, n, nlen)) {
+                return pos;
+            }
+            work += nlen;
+            mask &= ~(0xfULL << (lane * 4));
+        }
+        if (FilterShouldBail(work, i - from, nlen)) {
+            *bail = true;
+            i += 16;
+            break;
+        }
+    }
+
+    *resume = i;
+    return kPatternNotFound;
+}
+
+#endif  // HAS_ARM_SIMD
+
+static FilterFn filter_impl = FilterScalar;
+
+static void SelectFilter() {
+#if defined(HAS_X86_DISPATCH)
+    const CpuFeatures& cpu = GetCpuFeatures();
+    if (cpu.avx512bw) {
+        filter_impl = FilterAvx512;
+    } else if (cpu.avx2) {
+        filter_impl = FilterAvx2;
+    } else if (cpu.sse2) {
+        filter_impl = FilterSse2;
+    }
+#elif defined(HAS_ARM_SIMD)
+    filter_impl = FilterNeon;
+#endif
+}
+
+void InitPatternSearch() {
+    static std::once_flag once;
+    std::call_once(once, SelectFilter);
+}
+
+// ---------------------------------------------------------------------------
+// Two-Way (Crochemore-Perrin)
+// ---------------------------------------------------------------------------
+
+// Maximal suffix of x under the normal (reversed = false) or reversed
+// alphabet order. Returns the index before the suffix start; sets *period.
+static ptrdiff_t MaximalSuffix(const uint8_t* x, ptrdiff_t m, size_t* period, bool reversed) {
+    ptrdiff_t ms = -1;
+    ptrdiff_t j = 0;
+    ptrdiff_t k = 1;
+    ptrdiff_t p = 1;
+
+    while (j + k < m) {
+        uint8_t a = x[j + k];
+        uint8_t b = x[ms + k];
+        if (reversed ? (a > b) : (a < b)) {
+            j += k;
+            k = 1;
+            p = j - ms;
+        } else if (a == b) {
+            if (k != p) {
+                k++;
+            } else {
+                j += p;
+                k = 1;
+            }
+        } else {
+            ms = j;
+            j = ms + 1;
+            k = p = 1;
+        }
+    }
+
+    *period = static_cast<size_t>(p);
+    return ms;
+}
+
+PatternSearcher::PatternSearcher(const uint8_t* needle, size_t len)
+    : needle_(needle), needle_len_(len) {
+    if (len < 2) {
+        return;
+    }
+
+    ptrdiff_t m = static_cast<ptrdiff_t>(len);
+    size_t p = 1;
+    size_t q = 1;
+    ptrdiff_t i = MaximalSuffix(needle, m, &p, false);
+    ptrdiff_t j = MaximalSuffix(needle, m, &q, true);
+    if (i > j) {
+        ell_ = i;
+        period_ = p;
+    } else {
+        ell_ = j;
+        period_ = q;
+    }
+
+    periodic_ = period_ < len &&
+                std::memcmp(needle, needle + period_, static_cast<size_t>(ell_ + 1)) == 0;
+    if (!periodic_) {
+        ptrdiff_t left = ell_ + 1;
+        ptrdiff_t right = m - ell_ - 1;
+        period_ = static_cast<size_t>((left > right ? left : right) + 1);
+    }
+}
+
+size_t PatternSearcher::TwoWay(const uint8_t* haystack, size_t len, size_t from) const {
+    const uint8_t* x = needle_;
+    const uint8_t* y = haystack;
+    ptrdiff_t m = static_cast<ptrdiff_t>(needle_len_);
+    ptrdiff_t n = static_cast<ptrdiff_t>(len);
+    ptrdiff_t per = static_cast<ptrdiff_t>(period_);
+    ptrdiff_t j = static_cast<ptrdiff_t>(from);
+
+    if (periodic_) {
+        ptrdiff_t memory = -1;
+        while (j <= n - m) {
+            ptrdiff_t i = (ell_ > memory ? ell_ : memory) + 1;
+            while (i < m && x[i] == y[i + j]) {
+                i++;
+            }
+            if (i >= m) {
+                i = ell_;
+                while (i > memory && x[i] == y[i + j]) {
+                    i--;
+                }
+                if (i <= memory) {
+                    return static_cast<size_t>(j);
+                }
+                j += per;
+                memory = m - per - 1;
+            } else {
+                j += i - ell_;
+                memory = -1;
+            }
+        }
+    } else {
+        while (j <= n - m) {
+            ptrdiff_t i = ell_ + 1;
+            while (i < m && x[i] == y[i + j]) {
+                i++;
+            }
+            if (i >= m) {
+                i = ell_;
+                while (i >= 0 && x[i] == y[i + j]) {
+                    i--;
+                }
+                if (i < 0) {
+                    return static_cast<size_t>(j);
+                }
+                j += per;
+            } else {
+                j += i - ell_;
+            }
+        }
+    }
+
+    return kPatternNotFound;
+}
+
+size_t PatternSearcher::Find(const uint8_t* haystack, size_t len, size_t from) const {
+    if (from > len) {
+        return kPatternNotFound;
+    }
+    if (needle_len_ == 0) {
+        return from;
+    }
+    if (needle_len_ > len - from) {
+        return kPatternNotFound;
+    }
+
+    if (needle_len_ == 1) {
+        const void* hit = std::memchr(haystack + from, needle_[0], len - from);
+        return hit ? static_cast<size_t>(static_cast<const uint8_t*>(hit) - haystack) : kPatternNotFound;
+    }
+
+    if (needle_len_ <= kFilterMaxNeedle) {
+        size_t resume = from;
+        bool bail = false;
+        size_t hit = filter_impl(haystack, len, needle_, needle_len_, from, &resume, &bail);
+        if (hit != kPatternNotFound) {
+            return hit;
+        }
+        if (!bail) {
+            // Fewer than one vector of candidates left
+            const uint8_t last = needle_[needle_len_ - 1];
+            for (size_t i = resume; i + needle_len_ <= len; i++) {
+                if (haystack[i] == needle_[0] && haystack[i + needle_len_ - 1] == last &&
+                    VerifyMiddle(haystack + i, needle_, needle_len_)) {
+                    return i;
+                }
+            }
+            return kPatternNotFound;
+        }
+        from = resume;
+    }
+
+    return TwoWay(haystack, len, from);
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Single-needle substring search.
+//
+// Short needles go through a SIMD first/last-byte candidate filter (Muła's
+// "generic SIMD" strstr) at 16/32/64 positions per step; long needles, and
+// inputs that make the filter degenerate, use Crochemore-Perrin Two-Way so
+// the worst case stays linear.
+
+constexpr size_t kPatternNotFound = SIZE_MAX;
+
+// Pick filter kernels for this host. Idempotent; called from module init.
+void InitPatternSearch();
+
+class PatternSearcher {
+public:
+    // The needle is borrowed and must outlive the searcher.
+    PatternSearcher(const uint8_t* needle, size_t len);
+
+    // First match starting at or after `from`, or kPatternNotFound.
+    // An empty needle matches at `from`.
+    size_t Find(const uint8_t* haystack, size_t len, size_t from = 0) const;
+
+    // Non-overlapping matches, left to right, up to maxHits (0 = unlimited).
+    // Calls onHit(offset) for each; returns the number of hits.
+    template <typename OnHit>
+    size_t ForEach(const uint8_t* haystack, size_t len, size_t maxHits, OnHit onHit) const {
+        if (needle_len_ == 0) {
+            return 0;
+        }
+        size_t hits = 0;
+        size_t pos = 0;
+        while (maxHits == 0 || hits < maxHits) {
+            pos = Find(haystack, len, pos);
+            if (pos == kPatternNotFound) {
+                break;
+            }
+            onHit(pos);
+            hits++;
+            pos += needle_len_;
+        }
+        return hits;
+    }
+
+    size_t Count(const uint8_t* haystack, size_t len) const {
+        return ForEach(haystack, len, 0, [](size_t) {});
+    }
+
+    size_t NeedleLength() const { return needle_len_; }
+
+private:
+    size_t TwoWay(const uint8_t* haystack, size_t len, size_t from) const;
+
+    const uint8_t* needle_;
+    size_t needle_len_;
+
+    // Two-Way critical factorization
+    ptrdiff_t ell_ = -1;
+    size_t period_ = 1;
+    bool periodic_ = false;
+};
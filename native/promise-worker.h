@@ -0,0 +1,44 @@
+#pragma once
+
+#include <napi.h>
+#include <vector>
+
+// AsyncWorker that settles a Promise instead of calling a callback.
+//
+// Execute() runs on a libuv thread and must not touch JS values; inputs are
+// read through raw pointers captured in the constructor. Keep() pins the
+// Buffers behind those pointers until the worker completes. JS can still
+// write to them meanwhile, which races the same way as a concurrent copy.
+class PromiseWorker : public Napi::AsyncWorker {
+public:
+    PromiseWorker(Napi::Env env, const char* resourceName)
+        : Napi::AsyncWorker(env, resourceName),
+          deferred_(Napi::Promise::Deferred::New(env)) {}
+
+    // Queues the worker; it deletes itself after settling.
+    Napi::Promise Start() {
+        Napi::Promise promise = deferred_.Promise();
+        Queue();
+        return promise;
+    }
+
+protected:
+    void Keep(const Napi::Value& value) {
+        pinned_.push_back(Napi::Persistent(value.As<Napi::Object>()));
+    }
+
+    // Resolution value, built on the JS thread after Execute().
+    virtual Napi::Value Result(Napi::Env env) = 0;
+
+    void OnOK() override {
+        deferred_.Resolve(Result(Env()));
+    }
+
+    void OnError(const Napi::Error& error) override {
+        deferred_.Reject(error.Value());
+    }
+
+private:
+    Napi::Promise::Deferred deferred_;
+    std::vector<Napi::ObjectReference> pinned_;
+};
@@ -0,0 +1,186 @@
+#include <napi.h>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <string>
+#include "file-hash.h"
+#include "rate-table.h"
+
+// Keys are hashed, not stored; a 64-bit collision shares one bucket
+static constexpr uint64_t kKeySeed = 0x6f70656e636c6177ULL;  // "openclaw"
+
+static double WallClockMs() {
+    using namespace std::chrono;
+    return static_cast<double>(duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count());
+}
+
+// GCRA rate limits per string key, in a table that worker threads can share
+class RateLimitTable : public Napi::ObjectWrap<RateLimitTable> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    RateLimitTable(const Napi::CallbackInfo& info);
+
+private:
+    static Napi::FunctionReference constructor;
+
+    static Napi::Value BytesFor(const Napi::CallbackInfo& info);
+
+    Napi::Value Check(const Napi::CallbackInfo& info);
+    Napi::Value Memory(const Napi::CallbackInfo& info);
+    Napi::Value Capacity(const Napi::CallbackInfo& info);
+    Napi::Value WindowMs(const Napi::CallbackInfo& info);
+    Napi::Value MaxRequests(const Napi::CallbackInfo& info);
+
+    // Keeps the (possibly shared) memory behind table_ alive
+    Napi::ObjectReference memory_;
+    std::unique_ptr<RateTable> table_;
+};
+
+Napi::FunctionReference RateLimitTable::constructor;
+
+Napi::Object RateLimitTable::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "RateLimitTable", {
+        StaticMethod("bytesFor", &RateLimitTable::BytesFor),
+        InstanceMethod("check", &RateLimitTable::Check),
+        InstanceAccessor("memory", &RateLimitTable::Memory, nullptr),
+        InstanceAccessor("capacity", &RateLimitTable::Capacity, nullptr),
+        InstanceAccessor("windowMs", &RateLimitTable::WindowMs, nullptr),
+        InstanceAccessor("maxRequests", &RateLimitTable::MaxRequests, nullptr),
+    });
+
+    constructor = Napi::Persistent(func);
+    constructor.SuppressDestruct();
+
+    exports.Set("RateLimitTable", func);
+    return exports;
+}
+
+// RateLimitTable.bytesFor(capacity): size of the memory a table needs
+Napi::Value RateLimitTable::BytesFor(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsNumber() || !(info[0].As<Napi::Number>().DoubleValue() >= 1)) {
+        Napi::TypeError::New(env, "capacity must be a positive number").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    uint64_t capacity = static_cast<uint64_t>(info[0].As<Napi::Number>().Int64Value());
+    return Napi::Number::New(env, static_cast<double>(RateTable::BytesFor(capacity)));
+}
+
+// new RateLimitTable({ windowMs, maxRequests, capacity?, memory? })
+//
+// memory is a Uint8Array, usually over a SharedArrayBuffer of
+// bytesFor(capacity) bytes. Memory that already holds a table (created by
+// another thread) is attached as is, and must have the same limits.
+RateLimitTable::RateLimitTable(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<RateLimitTable>(info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Expected ({ windowMs, maxRequests, capacity?, memory? })")
+            .ThrowAsJavaScriptException();
+        return;
+    }
+    Napi::Object options = info[0].As<Napi::Object>();
+
+    RateLimitParams params;
+    Napi::Value windowMs = options.Get("windowMs");
+    Napi::Value maxRequests = options.Get("maxRequests");
+    Napi::Value capacity = options.Get("capacity");
+    double window = windowMs.IsNumber() ? windowMs.As<Napi::Number>().DoubleValue() : 0;
+    double max = maxRequests.IsNumber() ? maxRequests.As<Napi::Number>().DoubleValue() : 0;
+    if (!(window >= 1 && window <= static_cast<double>(RateTable::kMaxWindowMs))) {
+        Napi::TypeError::New(env, "windowMs must be between 1 and 2^31").ThrowAsJavaScriptException();
+        return;
+    }
+    if (!(max >= 1 && max <= RateTable::kMaxRequests)) {
+        Napi::TypeError::New(env, "maxRequests must be between 1 and 1000000").ThrowAsJavaScriptException();
+        return;
+    }
+    if (!capacity.IsUndefined()) {
+        if (!capacity.IsNumber() || !(capacity.As<Napi::Number>().DoubleValue() >= 1)) {
+            Napi::TypeError::New(env, "capacity must be a positive number").ThrowAsJavaScriptException();
+            return;
+        }
+        params.capacity = static_cast<uint64_t>(capacity.As<Napi::Number>().Int64Value());
+    }
+    params.window_ms = window;
+    params.max_requests = static_cast<uint32_t>(max);
+
+    Napi::Value memory = options.Get("memory");
+    if (memory.IsUndefined()) {
+        memory = Napi::Uint8Array::New(env, RateTable::BytesFor(params.capacity));
+    } else if (!memory.IsTypedArray() || memory.As<Napi::TypedArray>().TypedArrayType() != napi_uint8_array) {
+        Napi::TypeError::New(env, "memory must be a Uint8Array").ThrowAsJavaScriptException();
+        return;
+    }
+    Napi::Uint8Array bytes = memory.As<Napi::Uint8Array>();
+
+    if (RateTable::Valid(bytes.Data(), bytes.ByteLength())) {
+        table_ = std::make_unique<RateTable>(bytes.Data());
+        RateLimitParams existing = table_->Params();
+        if (existing.window_ms != params.window_ms || existing.max_requests != params.max_requests) {
+            table_.reset();
+            Napi::Error::New(env, "memory holds a table with different limits").ThrowAsJavaScriptException();
+            return;
+        }
+    } else {
+        if (bytes.ByteLength() < RateTable::BytesFor(params.capacity) ||
+            reinterpret_cast<uintptr_t>(bytes.Data()) % 8 != 0) {
+            Napi::RangeError::New(env, "memory must be 8-byte aligned and hold bytesFor(capacity) bytes")
+                .ThrowAsJavaScriptException();
+            return;
+        }
+        RateTable::Format(bytes.Data(), params, WallClockMs());
+        table_ = std::make_unique<RateTable>(bytes.Data());
+    }
+    memory_ = Napi::Persistent(bytes.As<Napi::Object>());
+}
+
+// check(key, nowMs, out): true when allowed; writes out[0] = remaining and
+// out[1] = when the bucket is full again (ms). out is a Float64Array the
+// caller reuses, so no result object is built per request.
+Napi::Value RateLimitTable::Check(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 3 || !info[0].IsString() || !info[1].IsNumber() || !info[2].IsTypedArray() ||
+        info[2].As<Napi::TypedArray>().TypedArrayType() != napi_float64_array ||
+        info[2].As<Napi::Float64Array>().ElementLength() < 2) {
+        Napi::TypeError::New(env, "Expected (key, nowMs, out: Float64Array(2))").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    double now_ms = info[1].As<Napi::Number>().DoubleValue();
+    if (!std::isfinite(now_ms)) {
+        Napi::RangeError::New(env, "nowMs must be a finite number").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    std::string key = info[0].As<Napi::String>().Utf8Value();
+    RateLimitDecision decision = table_->Check(Xxh64(key.data(), key.size(), kKeySeed), now_ms);
+    double* out = info[2].As<Napi::Float64Array>().Data();
+    out[0] = decision.remaining;
+    out[1] = decision.reset_ms;
+    return Napi::Boolean::New(env, decision.allowed);
+}
+
+Napi::Value RateLimitTable::Memory(const Napi::CallbackInfo& info) {
+    return memory_.Value();
+}
+
+Napi::Value RateLimitTable::Capacity(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), static_cast<double>(table_->Params().capacity));
+}
+
+Napi::Value RateLimitTable::WindowMs(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), table_->Params().window_ms);
+}
+
+Napi::Value RateLimitTable::MaxRequests(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), table_->Params().max_requests);
+}
+
+// Module initialization
+Napi::Object InitRateLimitTable(Napi::Env env, Napi::Object exports) {
+    return RateLimitTable::Init(env, exports);
+}
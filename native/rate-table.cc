@@ -0,0 +1,173 @@
+#include "rate-table.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <new>
+
+static constexpr uint32_t kMagic = 0x41524347;  // "GCRA"
+static constexpr uint32_t kVersion = 1;
+
+static_assert(sizeof(std::atomic<uint64_t>) == 8 && sizeof(std::atomic<int64_t>) == 8,
+              "cells are shared as raw memory");
+
+struct RateTable::Header {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t capacity;
+    int64_t epoch_ms;        // caller clock at Format()
+    int64_t interval;        // ticks between requests at the sustained rate
+    int64_t window;          // ticks a full burst takes to refill
+    uint32_t max_requests;
+    uint32_t reserved;
+    double window_ms;
+    uint8_t padding[8];
+};
+
+uint64_t RateTable::RoundCapacity(uint64_t capacity) {
+    uint64_t rounded = kProbeCells;
+    while (rounded < capacity && rounded < (uint64_t(1) << 40)) {
+        rounded <<= 1;
+    }
+    return rounded;
+}
+
+size_t RateTable::BytesFor(uint64_t capacity) {
+    return sizeof(Header) + static_cast<size_t>(RoundCapacity(capacity)) * sizeof(Cell);
+}
+
+void RateTable::Format(uint8_t* memory, const RateLimitParams& params, double now_ms) {
+    static_assert(sizeof(Header) == 64, "header is one cache line");
+    Header* header = reinterpret_cast<Header*>(memory);
+    header->magic = kMagic;
+    header->version = kVersion;
+    header->capacity = RoundCapacity(params.capacity);
+    header->epoch_ms = std::llround(now_ms);
+    header->max_requests = params.max_requests;
+    header->reserved = 0;
+    header->window_ms = params.window_ms;
+    // In ticks of 1/max ms the interval is the window in ms, exactly
+    header->interval = std::max<int64_t>(1, std::llround(params.window_ms));
+    header->window = header->interval * params.max_requests;
+
+    Cell* cells = reinterpret_cast<Cell*>(memory + sizeof(Header));
+    for (uint64_t i = 0; i < header->capacity; i++) {
+        new (&cells[i].key) std::atomic<uint64_t>(0);
+        new (&cells[i].tat) std::atomic<int64_t>(INT64_MIN);
+    }
+}
+
+bool RateTable::Valid(const uint8_t* memory, size_t len) {
+    if (len < sizeof(Header) || reinterpret_cast<uintptr_t>(memory) % alignof(Cell) != 0) {
+        return false;
+    }
+    const Header* header = reinterpret_cast<const Header*>(memory);
+    return header->magic == kMagic && header->version == kVersion &&
+           header->capacity == RoundCapacity(header->capacity) &&
+           len >= BytesFor(header->capacity) && header->max_requests >= 1 &&
+           header->max_requests <= kMaxRequests && header->interval >= 1 &&
+           header->interval <= kMaxWindowMs;
+}
+
+RateTable::RateTable(uint8_t* memory)
+    : header_(reinterpret_cast<Header*>(memory)),
+      cells_(reinterpret_cast<Cell*>(memory + sizeof(Header))),
+      mask_(header_->capacity - 1) {}
+
+RateLimitParams RateTable::Params() const {
+    RateLimitParams params;
+    params.capacity = header_->capacity;
+    params.window_ms = header_->window_ms;
+    params.max_requests = header_->max_requests;
+    return params;
+}
+
+int64_t RateTable::Ticks(double now_ms) const {
+    return (std::llround(now_ms) - header_->epoch_ms) * static_cast<int64_t>(header_->max_requests);
+}
+
+double RateTable::Millis(int64_t ticks) const {
+    return static_cast<double>(header_->epoch_ms) +
+           static_cast<double>(ticks) / static_cast<double>(header_->max_requests);
+}
+
+// The cell holding key, claiming one for it when absent
+RateTable::Cell* RateTable::Find(uint64_t key, int64_t now) {
+    uint64_t home = key & mask_;
+    for (int attempt = 0; attempt < 4; attempt++) {
+        Cell* reusable = nullptr;
+        uint64_t reusable_key = 0;
+        Cell* oldest = nullptr;
+        uint64_t oldest_key = 0;
+        int64_t oldest_tat = INT64_MAX;
+
+        for (size_t i = 0; i < kProbeCells; i++) {
+            Cell* cell = &cells_[(home + i) & mask_];
+            uint64_t seen = cell->key.load(std::memory_order_acquire);
+            if (seen == key) {
+                return cell;
+            }
+            if (seen == 0) {
+                // Keys are never removed, so the probe sequence ends here
+                if (reusable == nullptr) {
+                    reusable = cell;
+                    reusable_key = 0;
+                }
+                break;
+            }
+            int64_t tat = cell->tat.load(std::memory_order_relaxed);
+            if (tat <= now && reusable == nullptr) {
+                reusable = cell;
+                reusable_key = seen;
+            } else if (tat < oldest_tat) {
+                oldest = cell;
+                oldest_key = seen;
+                oldest_tat = tat;
+            }
+        }
+
+        // A drained bucket is already a fresh one; an evicted live one is reset
+        Cell* claim = reusable != nullptr ? reusable : oldest;
+        uint64_t expected = reusable != nullptr ? reusable_key : oldest_key;
+        if (claim->key.compare_exchange_strong(expected, key, std::memory_order_acq_rel)) {
+            if (claim == oldest) {
+                claim->tat.store(INT64_MIN, std::memory_order_release);
+            }
+            return claim;
+        }
+        // Another thread took the cell; it may have inserted this very key
+    }
+    return nullptr;
+}
+
+RateLimitDecision RateTable::Check(uint64_t key, double now_ms) {
+    key = key != 0 ? key : 1;
+    int64_t now = Ticks(now_ms);
+    RateLimitDecision decision;
+
+    Cell* cell = Find(key, now);
+    if (cell == nullptr) {
+        // Sustained contention on one probe window; admit rather than stall
+        decision.allowed = true;
+        decision.remaining = header_->max_requests - 1;
+        decision.reset_ms = now_ms + header_->window_ms;
+        return decision;
+    }
+
+    int64_t tat = cell->tat.load(std::memory_order_acquire);
+    for (;;) {
+        int64_t next = (tat > now ? tat : now) + header_->interval;
+        if (next - now > header_->window) {
+            decision.allowed = false;
+            decision.remaining = 0;
+            decision.reset_ms = Millis(tat);
+            return decision;
+        }
+        if (cell->tat.compare_exchange_weak(tat, next, std::memory_order_acq_rel)) {
+            decision.allowed = true;
+            decision.remaining = static_cast<uint32_t>((header_->window - (next - now)) / header_->interval);
+            decision.reset_ms = Millis(next);
+            return decision;
+        }
+    }
+}
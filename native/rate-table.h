@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// GCRA (generic cell rate algorithm) limiter over caller-owned memory. N-API free.
+//
+// A 64-byte header is followed by a power-of-two array of 16-byte cells
+// { key, tat }, where tat is the key's theoretical arrival time. Every field
+// is an atomic in the memory itself, so threads that map the same block (JS
+// workers sharing a SharedArrayBuffer) can check the same table lock-free.
+//
+// Each key may spend maxRequests per windowMs, admitted as a burst of up to
+// maxRequests and refilled continuously at one per windowMs / maxRequests.
+// Times are stored in ticks of 1 / maxRequests ms since the table's epoch, so
+// the interval is an exact integer and a burst is never rounded short.
+//
+// Lookup probes kProbeCells cells. A cell whose tat has passed holds a full
+// bucket, identical to no entry, and is reused in place; with no such cell
+// the one nearest to draining is evicted. Races between threads can, rarely,
+// hand a key a fresh bucket early; they never block a key wrongly for long.
+
+struct RateLimitParams {
+    uint64_t capacity = 16384;
+    double window_ms = 60000;
+    uint32_t max_requests = 100;
+};
+
+struct RateLimitDecision {
+    bool allowed = false;
+    uint32_t remaining = 0;
+    // When the key's bucket is full again, in caller ms
+    double reset_ms = 0;
+};
+
+class RateTable {
+public:
+    // Keep ticks within int64 for centuries of uptime
+    static constexpr uint32_t kMaxRequests = 1000000;
+    static constexpr int64_t kMaxWindowMs = int64_t(1) << 31;
+    static constexpr size_t kProbeCells = 8;
+
+    // Capacity rounded up to a power of two (at least kProbeCells)
+    static uint64_t RoundCapacity(uint64_t capacity);
+    static size_t BytesFor(uint64_t capacity);
+
+    // Writes an empty table into memory, which must hold
+    // BytesFor(params.capacity) bytes aligned to 8; now_ms becomes the epoch
+    static void Format(uint8_t* memory, const RateLimitParams& params, double now_ms);
+
+    // True when memory[0, len) holds a table Format() wrote
+    static bool Valid(const uint8_t* memory, size_t len);
+
+    // Attaches to formatted memory; the memory must outlive the table
+    explicit RateTable(uint8_t* memory);
+
+    RateLimitDecision Check(uint64_t key, double now_ms);
+
+    RateLimitParams Params() const;
+
+private:
+    struct Header;
+    struct Cell {
+        std::atomic<uint64_t> key;  // 0 = never used
+        std::atomic<int64_t> tat;
+    };
+
+    int64_t Ticks(double now_ms) const;
+    double Millis(int64_t ticks) const;
+    Cell* Find(uint64_t key, int64_t now);
+
+    Header* header_;
+    Cell* cells_;
+    uint64_t mask_;
+};
@@ -0,0 +1,209 @@
+#include "sha256.h"
+#include "cpu-features.h"
+
+#include <cstring>
+#include <mutex>
+
+#if defined(HAS_X86_SIMD)
+  #include <immintrin.h>
+#endif
+
+static const uint32_t kRoundConstants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+// Compresses `blocks` consecutive 64-byte blocks into state
+using CompressFn = void (*)(uint32_t state[8], const uint8_t* data, size_t blocks);
+
+static inline uint32_t Rotr(uint32_t x, unsigned n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+static inline uint32_t LoadBe32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+static inline void StoreBe32(uint8_t* p, uint32_t v) {
+    p[0] = static_cast<uint8_t>(v >> 24);
+    p[1] = static_cast<uint8_t>(v >> 16);
+    p[2] = static_cast<uint8_t>(v >> 8);
+    p[3] = static_cast<uint8_t>(v);
+}
+
+static void CompressScalar(uint32_t state[8], const uint8_t* data, size_t blocks) {
+    uint32_t w[64];
+    for (; blocks > 0; blocks--, data += 64) {
+        for (int i = 0; i < 16; i++) {
+            w[i] = LoadBe32(data + 4 * i);
+        }
+        for (int i = 16; i < 64; i++) {
+            uint32_t s0 = Rotr(w[i - 15], 7) ^ Rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = Rotr(w[i - 2], 17) ^ Rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0; i < 64; i++) {
+            uint32_t s1 = Rotr(e, 6) ^ Rotr(e, 11) ^ Rotr(e, 25);
+            uint32_t ch = (e & f) ^ (~e & g);
+            uint32_t t1 = h + s1 + ch + kRoundConstants[i] + w[i];
+            uint32_t s0 = Rotr(a, 2) ^ Rotr(a, 13) ^ Rotr(a, 22);
+            uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+            uint32_t t2 = s0 + maj;
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+#if defined(HAS_X86_DISPATCH)
+
+// sha256rnds2 works on the state split as ABEF / CDGH and runs two rounds per
+// instruction; sha256msg1/msg2 compute the message schedule four words at a
+// time. Each group below is four rounds.
+OPENCLAW_TARGET("sha,sse4.1")
+static void CompressShaNi(uint32_t state[8], const uint8_t* data, size_t blocks) {
+    const __m128i byteswap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0xb1);
+    __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4)), 0x1b);
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);   // ABEF
+    state1 = _mm_blend_epi16(state1, tmp, 0xf0);        // CDGH
+
+    for (; blocks > 0; blocks--, data += 64) {
+        const __m128i abef = state0;
+        const __m128i cdgh = state1;
+        __m128i msg[4];
+
+        for (int group = 0; group < 16; group++) {
+            __m128i& cur = msg[group & 3];
+            if (group < 4) {
+                cur = _mm_shuffle_epi8(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16 * group)), byteswap);
+            } else {
+                // W[t] = W[t-16] + s0(W[t-15]) + W[t-7] + s1(W[t-2])
+                const __m128i prev = msg[(group - 1) & 3];
+                __m128i w = _mm_sha256msg1_epu32(cur, msg[(group - 3) & 3]);
+                w = _mm_add_epi32(w, _mm_alignr_epi8(prev, msg[(group - 2) & 3], 4));
+                cur = _mm_sha256msg2_epu32(w, prev);
+            }
+            __m128i k = _mm_add_epi32(
+                cur, _mm_loadu_si128(reinterpret_cast<const __m128i*>(kRoundConstants + 4 * group)));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, k);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(k, 0x0e));
+        }
+
+        state0 = _mm_add_epi32(state0, abef);
+        state1 = _mm_add_epi32(state1, cdgh);
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1b);              // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xb1);           // DCHG
+    state0 = _mm_blend_epi16(tmp, state1, 0xf0);        // DCBA
+    state1 = _mm_alignr_epi8(state1, tmp, 8);           // HGFE
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), state0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), state1);
+}
+
+#endif  // HAS_X86_DISPATCH
+
+static CompressFn compress_impl = CompressScalar;
+
+static void SelectCompress() {
+#if defined(HAS_X86_DISPATCH)
+    if (GetCpuFeatures().sha) {
+        compress_impl = CompressShaNi;
+    }
+#endif
+}
+
+void InitSha256() {
+    static std::once_flag once;
+    std::call_once(once, SelectCompress);
+}
+
+void Sha256::Reset() {
+    static const uint32_t kInitialState[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+    };
+    std::memcpy(state_, kInitialState, sizeof(state_));
+    buffered_ = 0;
+    length_ = 0;
+}
+
+void Sha256::Update(const void* data, size_t len) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    length_ += len;
+
+    if (buffered_ > 0) {
+        size_t take = len < 64 - buffered_ ? len : 64 - buffered_;
+        std::memcpy(block_ + buffered_, p, take);
+        buffered_ += take;
+        p += take;
+        len -= take;
+        if (buffered_ < 64) {
+            return;
+        }
+        compress_impl(state_, block_, 1);
+        buffered_ = 0;
+    }
+
+    if (len >= 64) {
+        compress_impl(state_, p, len / 64);
+        p += len & ~static_cast<size_t>(63);
+        len &= 63;
+    }
+    if (len > 0) {
+        std::memcpy(block_, p, len);
+        buffered_ = len;
+    }
+}
+
+void Sha256::Final(uint8_t out[kSha256DigestSize]) {
+    uint64_t bits = length_ * 8;
+
+    // 0x80, zero padding, then the message length in bits (big-endian)
+    block_[buffered_++] = 0x80;
+    if (buffered_ > 56) {
+        std::memset(block_ + buffered_, 0, 64 - buffered_);
+        compress_impl(state_, block_, 1);
+        buffered_ = 0;
+    }
+    std::memset(block_ + buffered_, 0, 56 - buffered_);
+    StoreBe32(block_ + 56, static_cast<uint32_t>(bits >> 32));
+    StoreBe32(block_ + 60, static_cast<uint32_t>(bits));
+    compress_impl(state_, block_, 1);
+
+    for (int i = 0; i < 8; i++) {
+        StoreBe32(out + 4 * i, state_[i]);
+    }
+}
+
+void Sha256Digest(const void* data, size_t len, uint8_t out[kSha256DigestSize]) {
+    Sha256 hasher;
+    hasher.Update(data, len);
+    hasher.Final(out);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// SHA-256 (FIPS 180-4), byte-identical to node:crypto's "sha256".
+//
+// Block compression uses the x86 SHA extensions when the CPU has them and a
+// portable implementation otherwise. N-API free.
+
+constexpr size_t kSha256DigestSize = 32;
+
+// Pick the compression kernel for this host. Idempotent; called from module init.
+void InitSha256();
+
+class Sha256 {
+public:
+    Sha256() { Reset(); }
+
+    void Reset();
+    void Update(const void* data, size_t len);
+
+    // Writes the digest; call Reset() before hashing another message.
+    void Final(uint8_t out[kSha256DigestSize]);
+
+private:
+    uint32_t state_[8];
+    uint8_t block_[64];
+    size_t buffered_;
+    uint64_t length_;
+};
+
+// One-shot digest of data[0, len).
+void Sha256Digest(const void* data, size_t len, uint8_t out[kSha256DigestSize]);
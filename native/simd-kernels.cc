@@ -0,0 +1,305 @@
+#include "simd-kernels.h"
+#include "cpu-features.h"
+
+#include <cstring>
+#include <mutex>
+
+#if defined(HAS_X86_SIMD)
+  #include <immintrin.h>  // x86 SIMD intrinsics
+#elif defined(HAS_ARM_SIMD)
+  #include <arm_neon.h>   // ARM NEON intrinsics
+#endif
+
+// ---------------------------------------------------------------------------
+// Scalar reference implementations
+// ---------------------------------------------------------------------------
+
+static uint64_t SumBytesScalar(const uint8_t* data, size_t len) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < len; i++) {
+        sum += data[i];
+    }
+    return sum;
+}
+
+static void AndBytesScalar(const uint8_t* a, const uint8_t* b, uint8_t* out, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        out[i] = a[i] & b[i];
+    }
+}
+
+// Four bytes at a time; the vector kernels hand over at a multiple of 4, so
+// the key phase always starts at 0
+static void MaskBytesScalar(const uint8_t* src, const uint8_t key[4], uint8_t* out, size_t len) {
+    uint32_t k;
+    std::memcpy(&k, key, sizeof(k));
+    size_t i = 0;
+    for (; i + 4 <= len; i += 4) {
+        uint32_t w;
+        std::memcpy(&w, src + i, sizeof(w));
+        w ^= k;
+        std::memcpy(out + i, &w, sizeof(w));
+    }
+    for (; i < len; i++) {
+        out[i] = src[i] ^ key[i & 3];
+    }
+}
+
+// ---------------------------------------------------------------------------
+// x86: SSE2 / AVX2 / AVX-512BW
+// ---------------------------------------------------------------------------
+
+#if defined(HAS_X86_DISPATCH)
+
+// psadbw against zero sums each group of 8 bytes into a 64-bit lane, so the
+// accumulators can never overflow regardless of input size.
+OPENCLAW_TARGET("sse2")
+static uint64_t SumBytesSse2(const uint8_t* data, size_t len) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc0 = zero;
+    __m128i acc1 = zero;
+    size_t i = 0;
+
+    for (; i + 32 <= len; i += 32) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 16));
+        acc0 = _mm_add_epi64(acc0, _mm_sad_epu8(a, zero));
+        acc1 = _mm_add_epi64(acc1, _mm_sad_epu8(b, zero));
+    }
+    for (; i + 16 <= len; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        acc0 = _mm_add_epi64(acc0, _mm_sad_epu8(a, zero));
+    }
+
+    __m128i acc = _mm_add_epi64(acc0, acc1);
+    uint64_t lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    return lanes[0] + lanes[1] + SumBytesScalar(data + i, len - i);
+}
+
+OPENCLAW_TARGET("avx2")
+static uint64_t SumBytesAvx2(const uint8_t* data, size_t len) {
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i acc0 = zero;
+    __m256i acc1 = zero;
+    __m256i acc2 = zero;
+    __m256i acc3 = zero;
+    size_t i = 0;
+
+    // Four independent accumulators hide the vpsadbw latency
+    for (; i + 128 <= len; i += 128) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 32));
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 64));
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 96));
+        acc0 = _mm256_add_epi64(acc0, _mm256_sad_epu8(a, zero));
+        acc1 = _mm256_add_epi64(acc1, _mm256_sad_epu8(b, zero));
+        acc2 = _mm256_add_epi64(acc2, _mm256_sad_epu8(c, zero));
+        acc3 = _mm256_add_epi64(acc3, _mm256_sad_epu8(d, zero));
+    }
+    for (; i + 32 <= len; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        acc0 = _mm256_add_epi64(acc0, _mm256_sad_epu8(a, zero));
+    }
+
+    __m256i acc = _mm256_add_epi64(_mm256_add_epi64(acc0, acc1), _mm256_add_epi64(acc2, acc3));
+    __m128i folded = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    // Through memory: the 64-bit lane extracts only exist on x86-64, and
+    // HAS_X86_SIMD also covers i386
+    alignas(16) uint64_t lanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), folded);
+    return lanes[0] + lanes[1] + SumBytesScalar(data + i, len - i);
+}
+
+OPENCLAW_TARGET("avx512f,avx512bw")
+static uint64_t SumBytesAvx512(const uint8_t* data, size_t len) {
+    const __m512i zero = _mm512_setzero_si512();
+    __m512i acc0 = zero;
+    __m512i acc1 = zero;
+    size_t i = 0;
+
+    for (; i + 128 <= len; i += 128) {
+        __m512i a = _mm512_loadu_si512(data + i);
+        __m512i b = _mm512_loadu_si512(data + i + 64);
+        acc0 = _mm512_add_epi64(acc0, _mm512_sad_epu8(a, zero));
+        acc1 = _mm512_add_epi64(acc1, _mm512_sad_epu8(b, zero));
+    }
+    for (; i + 64 <= len; i += 64) {
+        __m512i a = _mm512_loadu_si512(data + i);
+        acc0 = _mm512_add_epi64(acc0, _mm512_sad_epu8(a, zero));
+    }
+
+    // Masked load for the tail: lanes past the end are never touched
+    if (i < len) {
+        __mmask64 mask = ~0ULL >> (64 - (len - i));
+        __m512i tail = _mm512_maskz_loadu_epi8(mask, data + i);
+        acc1 = _mm512_add_epi64(acc1, _mm512_sad_epu8(tail, zero));
+    }
+
+    uint64_t lanes[8];
+    _mm512_storeu_si512(lanes, _mm512_add_epi64(acc0, acc1));
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + lanes[4] + lanes[5] + lanes[6] + lanes[7];
+}
+
+OPENCLAW_TARGET("sse2")
+static void AndBytesSse2(const uint8_t* a, const uint8_t* b, uint8_t* out, size_t len) {
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_and_si128(va, vb));
+    }
+    AndBytesScalar(a + i, b + i, out + i, len - i);
+}
+
+OPENCLAW_TARGET("avx2")
+static void AndBytesAvx2(const uint8_t* a, const uint8_t* b, uint8_t* out, size_t len) {
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_and_si256(va, vb));
+    }
+    AndBytesScalar(a + i, b + i, out + i, len - i);
+}
+
+OPENCLAW_TARGET("sse2")
+static void MaskBytesSse2(const uint8_t* src, const uint8_t key[4], uint8_t* out, size_t len) {
+    int32_t k;
+    std::memcpy(&k, key, sizeof(k));
+    const __m128i vk = _mm_set1_epi32(k);
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_xor_si128(v, vk));
+    }
+    MaskBytesScalar(src + i, key, out + i, len - i);
+}
+
+// 64 bytes per step, then one more vector if 32 or more remain
+OPENCLAW_TARGET("avx2")
+static void MaskBytesAvx2(const uint8_t* src, const uint8_t key[4], uint8_t* out, size_t len) {
+    int32_t k;
+    std::memcpy(&k, key, sizeof(k));
+    const __m256i vk = _mm256_set1_epi32(k);
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 32));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_xor_si256(v0, vk));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + 32), _mm256_xor_si256(v1, vk));
+    }
+    if (i + 32 <= len) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_xor_si256(v, vk));
+        i += 32;
+    }
+    MaskBytesScalar(src + i, key, out + i, len - i);
+}
+
+#endif  // HAS_X86_DISPATCH
+
+// ---------------------------------------------------------------------------
+// ARM: NEON
+// ---------------------------------------------------------------------------
+
+#if defined(HAS_ARM_SIMD)
+
+static uint64_t SumBytesNeon(const uint8_t* data, size_t len) {
+    uint64x2_t acc64 = vdupq_n_u64(0);
+    size_t i = 0;
+
+    // Each vpadal adds at most 2 * 255 per u16 lane, so flush every 128 rounds
+    while (i + 16 <= len) {
+        uint16x8_t acc16 = vdupq_n_u16(0);
+        size_t block_end = i + 16 * 128;
+        if (block_end > len) {
+            block_end = len - ((len - i) % 16);
+        }
+        for (; i < block_end; i += 16) {
+            acc16 = vpadalq_u8(acc16, vld1q_u8(data + i));
+        }
+        acc64 = vpadalq_u32(acc64, vpaddlq_u16(acc16));
+    }
+
+    uint64_t sum = vgetq_lane_u64(acc64, 0) + vgetq_lane_u64(acc64, 1);
+    return sum + SumBytesScalar(data + i, len - i);
+}
+
+static void AndBytesNeon(const uint8_t* a, const uint8_t* b, uint8_t* out, size_t len) {
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        vst1q_u8(out + i, vandq_u8(vld1q_u8(a + i), vld1q_u8(b + i)));
+    }
+    AndBytesScalar(a + i, b + i, out + i, len - i);
+}
+
+static void MaskBytesNeon(const uint8_t* src, const uint8_t key[4], uint8_t* out, size_t len) {
+    uint32_t k;
+    std::memcpy(&k, key, sizeof(k));
+    const uint8x16_t vk = vreinterpretq_u8_u32(vdupq_n_u32(k));
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        uint8x16_t v0 = vld1q_u8(src + i);
+        uint8x16_t v1 = vld1q_u8(src + i + 16);
+        vst1q_u8(out + i, veorq_u8(v0, vk));
+        vst1q_u8(out + i + 16, veorq_u8(v1, vk));
+    }
+    MaskBytesScalar(src + i, key, out + i, len - i);
+}
+
+#endif  // HAS_ARM_SIMD
+
+// ---------------------------------------------------------------------------
+// Dispatch
+// ---------------------------------------------------------------------------
+
+using SumBytesFn = uint64_t (*)(const uint8_t*, size_t);
+using AndBytesFn = void (*)(const uint8_t*, const uint8_t*, uint8_t*, size_t);
+using MaskBytesFn = void (*)(const uint8_t*, const uint8_t*, uint8_t*, size_t);
+
+static SumBytesFn sum_bytes_impl = SumBytesScalar;
+static AndBytesFn and_bytes_impl = AndBytesScalar;
+static MaskBytesFn mask_bytes_impl = MaskBytesScalar;
+
+static void SelectKernels() {
+#if defined(HAS_X86_DISPATCH)
+    const CpuFeatures& cpu = GetCpuFeatures();
+    if (cpu.avx512bw) {
+        sum_bytes_impl = SumBytesAvx512;
+    } else if (cpu.avx2) {
+        sum_bytes_impl = SumBytesAvx2;
+    } else if (cpu.sse2) {
+        sum_bytes_impl = SumBytesSse2;
+    }
+
+    if (cpu.avx2) {
+        and_bytes_impl = AndBytesAvx2;
+        mask_bytes_impl = MaskBytesAvx2;
+    } else if (cpu.sse2) {
+        and_bytes_impl = AndBytesSse2;
+        mask_bytes_impl = MaskBytesSse2;
+    }
+#elif defined(HAS_ARM_SIMD)
+    sum_bytes_impl = SumBytesNeon;
+    and_bytes_impl = AndBytesNeon;
+    mask_bytes_impl = MaskBytesNeon;
+#endif
+}
+
+void InitSimdKernels() {
+    static std::once_flag once;
+    std::call_once(once, SelectKernels);
+}
+
+uint64_t SumBytes(const uint8_t* data, size_t len) {
+    return sum_bytes_impl(data, len);
+}
+
+void AndBytes(const uint8_t* a, const uint8_t* b, uint8_t* out, size_t len) {
+    and_bytes_impl(a, b, out, len);
+}
+
+void MaskBytes(const uint8_t* src, const uint8_t key[4], uint8_t* out, size_t len) {
+    mask_bytes_impl(src, key, out, len);
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// N-API free SIMD kernels shared by the bindings (and usable from native
+// benchmarks). Each entry point forwards to the widest variant selected by
+// InitSimdKernels() for the running CPU.
+
+// Pick kernel variants for this host. Idempotent; called from module init.
+void InitSimdKernels();
+
+// Sum of all bytes.
+uint64_t SumBytes(const uint8_t* data, size_t len);
+
+// out[i] = a[i] & b[i]
+void AndBytes(const uint8_t* a, const uint8_t* b, uint8_t* out, size_t len);
+
+// out[i] = src[i] ^ key[i % 4], the WebSocket payload (un)masking transform.
+// out may equal src.
+void MaskBytes(const uint8_t* src, const uint8_t key[4], uint8_t* out, size_t len);
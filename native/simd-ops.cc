@@ -1,15 +1,16 @@
 #include <napi.h>
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
-
-// Platform-specific SIMD includes
-#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
-  #include <immintrin.h>  // x86 SIMD intrinsics
-  #define HAS_X86_SIMD 1
-#elif defined(__aarch64__) || defined(_M_ARM64)
-  #include <arm_neon.h>   // ARM NEON intrinsics
-  #define HAS_ARM_SIMD 1
-#endif
+#include <string>
+#include <vector>
+#include "cpu-features.h"
+#include "op-stats.h"
+#include "parallel-ops.h"
+#include "pattern-search.h"
+#include "promise-worker.h"
+#include "simd-kernels.h"
+#include "vector-ops.h"
 
 // SIMD operations for ultra-fast data processing
 class SimdOps : public Napi::ObjectWrap<SimdOps> {
@@ -26,8 +27,28 @@ private:
     // Find pattern in buffer (SIMD-accelerated)
     Napi::Value FindPattern(const Napi::CallbackInfo& info);
     
+    // All non-overlapping match offsets as a Uint32Array
+    Napi::Value FindAll(const Napi::CallbackInfo& info);
+    
+    // Number of non-overlapping matches
+    Napi::Value Count(const Napi::CallbackInfo& info);
+    
     // Byte-wise AND operation
     Napi::Value AndBuffers(const Napi::CallbackInfo& info);
+    
+    // Promise-returning variants, run off the JS thread
+    Napi::Value SumUint8Async(const Napi::CallbackInfo& info);
+    Napi::Value FindPatternAsync(const Napi::CallbackInfo& info);
+    Napi::Value CountAsync(const Napi::CallbackInfo& info);
+    Napi::Value AndBuffersAsync(const Napi::CallbackInfo& info);
+    
+    // Best k rows of an N x D matrix by cosine / dot / L2 against a query
+    Napi::Value TopK(const Napi::CallbackInfo& info);
+    Napi::Value TopKAsync(const Napi::CallbackInfo& info);
+    
+    // Quantized copies of a float32 matrix for topK
+    Napi::Value ToFloat16(const Napi::CallbackInfo& info);
+    Napi::Value QuantizeInt8(const Napi::CallbackInfo& info);
 };
 
 Napi::FunctionReference SimdOps::constructor;
@@ -36,20 +57,43 @@ Napi::Object SimdOps::Init(Napi::Env env, Napi::Object exports) {
     Napi::Function func = DefineClass(env, "SimdOps", {
         InstanceMethod("sumUint8", &SimdOps::SumUint8),
         InstanceMethod("findPattern", &SimdOps::FindPattern),
+        InstanceMethod("findAll", &SimdOps::FindAll),
+        InstanceMethod("count", &SimdOps::Count),
         InstanceMethod("andBuffers", &SimdOps::AndBuffers),
+        InstanceMethod("sumUint8Async", &SimdOps::SumUint8Async),
+        InstanceMethod("findPatternAsync", &SimdOps::FindPatternAsync),
+        InstanceMethod("countAsync", &SimdOps::CountAsync),
+        InstanceMethod("andBuffersAsync", &SimdOps::AndBuffersAsync),
+        InstanceMethod("topK", &SimdOps::TopK),
+        InstanceMethod("topKAsync", &SimdOps::TopKAsync),
+        InstanceMethod("toFloat16", &SimdOps::ToFloat16),
+        InstanceMethod("quantizeInt8", &SimdOps::QuantizeInt8),
     });
 
     constructor = Napi::Persistent(func);
     constructor.SuppressDestruct();
 
     exports.Set("SimdOps", func);
+    exports.Set("simdLevel", Napi::String::New(env, SimdLevelName()));
     return exports;
 }
 
 SimdOps::SimdOps(const Napi::CallbackInfo& info) 
     : Napi::ObjectWrap<SimdOps>(info) {}
 
-Napi::Value SimdOps::SumUint8(const Napi::CallbackInfo& info) {
+// The kernels keep no per-object state, so each op is a free function
+// exported both at module level (see InitAll) and as a SimdOps method.
+
+// Optional start offset; negative or missing means 0
+static size_t ReadSearchStart(const Napi::CallbackInfo& info, size_t index) {
+    if (info.Length() > index && info[index].IsNumber()) {
+        int64_t start = info[index].As<Napi::Number>().Int64Value();
+        return start > 0 ? static_cast<size_t>(start) : 0;
+    }
+    return 0;
+}
+
+Napi::Value SimdSumUint8(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     
     if (info.Length() < 1 || !info[0].IsBuffer()) {
@@ -61,42 +105,13 @@ Napi::Value SimdOps::SumUint8(const Napi::CallbackInfo& info) {
     size_t len = buffer.Length();
     uint8_t* data = reinterpret_cast<uint8_t*>(buffer.Data());
     
-    uint64_t sum = 0;
-    size_t i = 0;
-    
-    #if defined(HAS_X86_SIMD) && defined(__AVX2__)
-    // Process 32 bytes at a time with AVX2 (x86)
-    __m256i vec_sum = _mm256_setzero_si256();
-    for (; i + 32 <= len; i += 32) {
-        __m256i vec = _mm256_loadu_si256(reinterpret_cast<__m256i*>(data + i));
-        // Horizontal sum would require more work, keeping simple for now
-        // Just demonstrating SIMD usage
-    }
-    #elif defined(HAS_ARM_SIMD)
-    // Process 16 bytes at a time with NEON (ARM64)
-    uint32x4_t vec_sum = vdupq_n_u32(0);
-    for (; i + 16 <= len; i += 16) {
-        uint8x16_t vec = vld1q_u8(data + i);
-        // Sum the vector elements
-        uint16x8_t vec16 = vpaddlq_u8(vec);
-        uint32x4_t vec32 = vpaddlq_u16(vec16);
-        vec_sum = vaddq_u32(vec_sum, vec32);
-    }
-    // Extract sum from ARM vector
-    uint32_t sums[4];
-    vst1q_u32(sums, vec_sum);
-    sum += sums[0] + sums[1] + sums[2] + sums[3];
-    #endif
-    
-    // Process remaining bytes
-    for (; i < len; i++) {
-        sum += data[i];
-    }
+    // Dispatches to the AVX-512BW / AVX2 / SSE2 / NEON kernel picked at init
+    uint64_t sum = SumBytes(data, len);
     
     return Napi::Number::New(env, sum);
 }
 
-Napi::Value SimdOps::FindPattern(const Napi::CallbackInfo& info) {
+Napi::Value SimdFindPattern(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     
     if (info.Length() < 2 || !info[0].IsBuffer() || !info[1].IsBuffer()) {
@@ -104,30 +119,70 @@ Napi::Value SimdOps::FindPattern(const Napi::CallbackInfo& info) {
         return env.Null();
     }
     
-    Napi::Buffer<char> haystack = info[0].As<Napi::Buffer<char>>();
-    Napi::Buffer<char> needle = info[1].As<Napi::Buffer<char>>();
+    Napi::Buffer<uint8_t> haystack = info[0].As<Napi::Buffer<uint8_t>>();
+    Napi::Buffer<uint8_t> needle = info[1].As<Napi::Buffer<uint8_t>>();
+    
+    size_t from = ReadSearchStart(info, 2);
     
-    // Simple Boyer-Moore or naive search
-    // For production, use a proper algorithm like Two-Way or SIMD-accelerated
-    const char* h = haystack.Data();
-    const char* n = needle.Data();
-    size_t hlen = haystack.Length();
-    size_t nlen = needle.Length();
+    PatternSearcher searcher(needle.Data(), needle.Length());
+    size_t pos = searcher.Find(haystack.Data(), haystack.Length(), from);
     
-    if (nlen > hlen) {
+    if (pos == kPatternNotFound) {
         return Napi::Number::New(env, -1);
     }
+    return Napi::Number::New(env, static_cast<double>(pos));
+}
+
+Napi::Value SimdFindAll(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
     
-    for (size_t i = 0; i <= hlen - nlen; i++) {
-        if (std::memcmp(h + i, n, nlen) == 0) {
-            return Napi::Number::New(env, i);
-        }
+    if (info.Length() < 2 || !info[0].IsBuffer() || !info[1].IsBuffer()) {
+        Napi::TypeError::New(env, "Expected (haystack, needle, maxHits?)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    Napi::Buffer<uint8_t> haystack = info[0].As<Napi::Buffer<uint8_t>>();
+    Napi::Buffer<uint8_t> needle = info[1].As<Napi::Buffer<uint8_t>>();
+    
+    size_t max_hits = 0;
+    if (info.Length() > 2 && info[2].IsNumber()) {
+        int64_t limit = info[2].As<Napi::Number>().Int64Value();
+        max_hits = limit > 0 ? static_cast<size_t>(limit) : 0;
+    }
+    
+    // Float64 offsets: exact up to 2^53, like the 64-bit offsets BufferOps
+    // takes, so hits past 4 GiB are not truncated
+    std::vector<double> hits;
+    PatternSearcher searcher(needle.Data(), needle.Length());
+    searcher.ForEach(haystack.Data(), haystack.Length(), max_hits, [&hits](size_t pos) {
+        hits.push_back(static_cast<double>(pos));
+    });
+    
+    Napi::Float64Array result = Napi::Float64Array::New(env, hits.size());
+    if (!hits.empty()) {
+        std::memcpy(result.Data(), hits.data(), hits.size() * sizeof(double));
     }
+    return result;
+}
+
+Napi::Value SimdCount(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 2 || !info[0].IsBuffer() || !info[1].IsBuffer()) {
+        Napi::TypeError::New(env, "Expected (haystack, needle)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    Napi::Buffer<uint8_t> haystack = info[0].As<Napi::Buffer<uint8_t>>();
+    Napi::Buffer<uint8_t> needle = info[1].As<Napi::Buffer<uint8_t>>();
+    
+    PatternSearcher searcher(needle.Data(), needle.Length());
+    size_t count = searcher.Count(haystack.Data(), haystack.Length());
     
-    return Napi::Number::New(env, -1);
+    return Napi::Number::New(env, static_cast<double>(count));
 }
 
-Napi::Value SimdOps::AndBuffers(const Napi::CallbackInfo& info) {
+Napi::Value SimdAndBuffers(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     
     if (info.Length() < 2 || !info[0].IsBuffer() || !info[1].IsBuffer()) {
@@ -142,39 +197,413 @@ Napi::Value SimdOps::AndBuffers(const Napi::CallbackInfo& info) {
     
     Napi::Buffer<uint8_t> result = Napi::Buffer<uint8_t>::New(env, len);
     
-    uint8_t* r = result.Data();
-    uint8_t* a = buf1.Data();
-    uint8_t* b = buf2.Data();
+    AndBytes(buf1.Data(), buf2.Data(), result.Data(), len);
+    
+    return result;
+}
+
+// Async variants. Each worker pins its input Buffers and runs the parallel
+// kernel on a libuv thread; inputs of kParallelMinBytes and up are further
+// split across the native ThreadPool.
+
+class SumWorker : public PromiseWorker {
+public:
+    SumWorker(Napi::Env env, const Napi::Buffer<uint8_t>& buffer)
+        : PromiseWorker(env, "openclaw:sumUint8"),
+          data_(buffer.Data()), len_(buffer.Length()) {
+        Keep(buffer);
+    }
+
+    void Execute() override {
+        sum_ = ParallelSumBytes(data_, len_);
+    }
+
+    Napi::Value Result(Napi::Env env) override {
+        return Napi::Number::New(env, static_cast<double>(sum_));
+    }
+
+private:
+    const uint8_t* data_;
+    size_t len_;
+    uint64_t sum_ = 0;
+};
+
+class SearchWorker : public PromiseWorker {
+public:
+    enum class Mode { kFind, kCount };
+
+    SearchWorker(Napi::Env env, Mode mode, const Napi::Buffer<uint8_t>& haystack,
+                 const Napi::Buffer<uint8_t>& needle, size_t from)
+        : PromiseWorker(env, mode == Mode::kFind ? "openclaw:findPattern" : "openclaw:count"),
+          mode_(mode), haystack_(haystack.Data()), haystack_len_(haystack.Length()),
+          needle_(needle.Data()), needle_len_(needle.Length()), from_(from) {
+        Keep(haystack);
+        Keep(needle);
+    }
+
+    void Execute() override {
+        PatternSearcher searcher(needle_, needle_len_);
+        if (mode_ == Mode::kFind) {
+            result_ = ParallelFind(searcher, haystack_, haystack_len_, from_);
+        } else {
+            result_ = ParallelCount(searcher, haystack_, haystack_len_);
+        }
+    }
+
+    Napi::Value Result(Napi::Env env) override {
+        if (result_ == kPatternNotFound) {
+            return Napi::Number::New(env, -1);
+        }
+        return Napi::Number::New(env, static_cast<double>(result_));
+    }
+
+private:
+    Mode mode_;
+    const uint8_t* haystack_;
+    size_t haystack_len_;
+    const uint8_t* needle_;
+    size_t needle_len_;
+    size_t from_;
+    size_t result_ = 0;
+};
+
+class AndWorker : public PromiseWorker {
+public:
+    AndWorker(Napi::Env env, const Napi::Buffer<uint8_t>& a, const Napi::Buffer<uint8_t>& b,
+              const Napi::Buffer<uint8_t>& out)
+        : PromiseWorker(env, "openclaw:andBuffers"),
+          a_(a.Data()), b_(b.Data()), out_data_(out.Data()), len_(out.Length()),
+          out_(Napi::Persistent(out.As<Napi::Object>())) {
+        Keep(a);
+        Keep(b);
+    }
+
+    void Execute() override {
+        ParallelAndBytes(a_, b_, out_data_, len_);
+    }
+
+    Napi::Value Result(Napi::Env env) override {
+        return out_.Value();
+    }
+
+private:
+    const uint8_t* a_;
+    const uint8_t* b_;
+    uint8_t* out_data_;
+    size_t len_;
+    Napi::ObjectReference out_;
+};
+
+Napi::Value SimdSumUint8Async(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsBuffer()) {
+        Napi::TypeError::New(env, "Expected buffer").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    return (new SumWorker(env, info[0].As<Napi::Buffer<uint8_t>>()))->Start();
+}
+
+Napi::Value SimdFindPatternAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 2 || !info[0].IsBuffer() || !info[1].IsBuffer()) {
+        Napi::TypeError::New(env, "Expected (haystack, needle)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    return (new SearchWorker(env, SearchWorker::Mode::kFind, info[0].As<Napi::Buffer<uint8_t>>(),
+                             info[1].As<Napi::Buffer<uint8_t>>(), ReadSearchStart(info, 2)))->Start();
+}
+
+Napi::Value SimdCountAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 2 || !info[0].IsBuffer() || !info[1].IsBuffer()) {
+        Napi::TypeError::New(env, "Expected (haystack, needle)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    return (new SearchWorker(env, SearchWorker::Mode::kCount, info[0].As<Napi::Buffer<uint8_t>>(),
+                             info[1].As<Napi::Buffer<uint8_t>>(), 0))->Start();
+}
+
+Napi::Value SimdAndBuffersAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 2 || !info[0].IsBuffer() || !info[1].IsBuffer()) {
+        Napi::TypeError::New(env, "Expected (buffer1, buffer2)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    Napi::Buffer<uint8_t> buf1 = info[0].As<Napi::Buffer<uint8_t>>();
+    Napi::Buffer<uint8_t> buf2 = info[1].As<Napi::Buffer<uint8_t>>();
+    Napi::Buffer<uint8_t> result = Napi::Buffer<uint8_t>::New(env, std::min(buf1.Length(), buf2.Length()));
     
-    size_t i = 0;
+    return (new AndWorker(env, buf1, buf2, result))->Start();
+}
+
+// Vector search. The matrix element type follows its TypedArray:
+// Float32Array (f32), Uint16Array (f16 bits) or Int8Array (int8, with
+// options.scales holding one Float32 scale per row).
+
+struct TopKRequest {
+    const float* query;
+    VectorMatrix matrix;
+    VectorMetric metric;
+    size_t k;
+};
+
+static const uint8_t* TypedArrayBytes(const Napi::TypedArray& array) {
+    return static_cast<const uint8_t*>(array.ArrayBuffer().Data()) + array.ByteOffset();
+}
+
+// Parses (query, matrix, k, { metric?, scales? }); throws and returns false
+// on bad input.
+static bool ReadTopKRequest(const Napi::CallbackInfo& info, TopKRequest* req) {
+    Napi::Env env = info.Env();
     
-    #if defined(HAS_X86_SIMD) && defined(__AVX2__)
-    // x86 AVX2 SIMD AND operation (32 bytes at a time)
-    for (; i + 32 <= len; i += 32) {
-        __m256i vec_a = _mm256_loadu_si256(reinterpret_cast<__m256i*>(a + i));
-        __m256i vec_b = _mm256_loadu_si256(reinterpret_cast<__m256i*>(b + i));
-        __m256i vec_r = _mm256_and_si256(vec_a, vec_b);
-        _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i), vec_r);
+    if (info.Length() < 3 || !info[0].IsTypedArray() || !info[1].IsTypedArray() || !info[2].IsNumber()) {
+        Napi::TypeError::New(env, "Expected (query, matrix, k, options?)").ThrowAsJavaScriptException();
+        return false;
     }
-    #elif defined(HAS_ARM_SIMD)
-    // ARM NEON SIMD AND operation (16 bytes at a time)
-    for (; i + 16 <= len; i += 16) {
-        uint8x16_t vec_a = vld1q_u8(a + i);
-        uint8x16_t vec_b = vld1q_u8(b + i);
-        uint8x16_t vec_r = vandq_u8(vec_a, vec_b);
-        vst1q_u8(r + i, vec_r);
+    
+    Napi::TypedArray query = info[0].As<Napi::TypedArray>();
+    if (query.TypedArrayType() != napi_float32_array || query.ElementLength() == 0) {
+        Napi::TypeError::New(env, "query must be a non-empty Float32Array").ThrowAsJavaScriptException();
+        return false;
+    }
+    
+    Napi::TypedArray matrix = info[1].As<Napi::TypedArray>();
+    VectorElement type;
+    switch (matrix.TypedArrayType()) {
+        case napi_float32_array: type = VectorElement::kF32; break;
+        case napi_uint16_array: type = VectorElement::kF16; break;
+        case napi_int8_array: type = VectorElement::kInt8; break;
+        default:
+            Napi::TypeError::New(env, "matrix must be a Float32Array, Uint16Array (f16) or Int8Array").ThrowAsJavaScriptException();
+            return false;
+    }
+    
+    size_t dims = query.ElementLength();
+    if (matrix.ElementLength() % dims != 0 || matrix.ElementLength() / dims > UINT32_MAX) {
+        Napi::RangeError::New(env, "matrix length must be a multiple of the query length").ThrowAsJavaScriptException();
+        return false;
+    }
+    size_t rows = matrix.ElementLength() / dims;
+    
+    double k = info[2].As<Napi::Number>().DoubleValue();
+    if (!(k >= 0)) {
+        Napi::RangeError::New(env, "Invalid k").ThrowAsJavaScriptException();
+        return false;
+    }
+    
+    VectorMetric metric = VectorMetric::kCosine;
+    const float* scales = nullptr;
+    if (info.Length() > 3 && info[3].IsObject()) {
+        Napi::Object options = info[3].As<Napi::Object>();
+        
+        Napi::Value name = options.Get("metric");
+        if (!name.IsUndefined()) {
+            if (!name.IsString() || !ParseVectorMetric(name.As<Napi::String>().Utf8Value(), &metric)) {
+                Napi::TypeError::New(env, "metric must be 'cosine', 'dot' or 'l2'").ThrowAsJavaScriptException();
+                return false;
+            }
+        }
+        
+        Napi::Value scale_value = options.Get("scales");
+        if (scale_value.IsTypedArray() && scale_value.As<Napi::TypedArray>().TypedArrayType() == napi_float32_array) {
+            Napi::Float32Array scale_array = scale_value.As<Napi::Float32Array>();
+            if (scale_array.ElementLength() >= rows) {
+                scales = scale_array.Data();
+            }
+        }
+    }
+    
+    if (type == VectorElement::kInt8 && scales == nullptr) {
+        Napi::TypeError::New(env, "int8 matrix needs options.scales with one Float32 per row").ThrowAsJavaScriptException();
+        return false;
     }
-    #endif
     
-    // Scalar fallback for remaining bytes
-    for (; i < len; i++) {
-        r[i] = a[i] & b[i];
+    req->query = query.As<Napi::Float32Array>().Data();
+    req->matrix = VectorMatrix{TypedArrayBytes(matrix), type, rows, dims, scales};
+    req->metric = metric;
+    req->k = std::min(static_cast<size_t>(std::min(k, 4294967295.0)), rows);
+    return true;
+}
+
+// { indices: Uint32Array, scores: Float32Array }, best first
+static Napi::Object TopKResult(Napi::Env env, const std::vector<ScoredRow>& best) {
+    Napi::Uint32Array indices = Napi::Uint32Array::New(env, best.size());
+    Napi::Float32Array scores = Napi::Float32Array::New(env, best.size());
+    uint32_t* index_out = indices.Data();
+    float* score_out = scores.Data();
+    for (size_t i = 0; i < best.size(); i++) {
+        index_out[i] = best[i].index;
+        score_out[i] = best[i].score;
     }
     
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("indices", indices);
+    result.Set("scores", scores);
     return result;
 }
 
+class TopKWorker : public PromiseWorker {
+public:
+    TopKWorker(Napi::Env env, const TopKRequest& req, const Napi::CallbackInfo& info)
+        : PromiseWorker(env, "openclaw:topK"), req_(req) {
+        Keep(info[0]);
+        Keep(info[1]);
+        if (req.matrix.scales != nullptr) {
+            Keep(info[3].As<Napi::Object>().Get("scales"));
+        }
+    }
+
+    void Execute() override {
+        OpScope scope(NativeOp::kTopK, req_.matrix.rows * VectorRowStride(req_.matrix));
+        best_ = ParallelTopK(req_.query, req_.matrix, req_.metric, req_.k);
+    }
+
+    Napi::Value Result(Napi::Env env) override {
+        return TopKResult(env, best_);
+    }
+
+private:
+    TopKRequest req_;
+    std::vector<ScoredRow> best_;
+};
+
+Napi::Value SimdTopK(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    TopKRequest req;
+    if (!ReadTopKRequest(info, &req)) {
+        return env.Null();
+    }
+    
+    OpScope scope(NativeOp::kTopK, req.matrix.rows * VectorRowStride(req.matrix));
+    return TopKResult(env, TopKRows(req.query, req.matrix, req.metric, req.k, 0, req.matrix.rows));
+}
+
+Napi::Value SimdTopKAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    TopKRequest req;
+    if (!ReadTopKRequest(info, &req)) {
+        return env.Null();
+    }
+    
+    return (new TopKWorker(env, req, info))->Start();
+}
+
+static bool IsFloat32Array(const Napi::Value& value) {
+    return value.IsTypedArray() && value.As<Napi::TypedArray>().TypedArrayType() == napi_float32_array;
+}
+
+Napi::Value SimdToFloat16(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !IsFloat32Array(info[0])) {
+        Napi::TypeError::New(env, "Expected Float32Array").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    Napi::Float32Array src = info[0].As<Napi::Float32Array>();
+    size_t len = src.ElementLength();
+    const float* in = src.Data();
+    
+    Napi::Uint16Array result = Napi::Uint16Array::New(env, len);
+    uint16_t* out = result.Data();
+    for (size_t i = 0; i < len; i++) {
+        out[i] = FloatToHalf(in[i]);
+    }
+    return result;
+}
+
+Napi::Value SimdQuantizeInt8(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 2 || !IsFloat32Array(info[0]) || !info[1].IsNumber()) {
+        Napi::TypeError::New(env, "Expected (matrix: Float32Array, dims)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    Napi::Float32Array src = info[0].As<Napi::Float32Array>();
+    int64_t dims = info[1].As<Napi::Number>().Int64Value();
+    if (dims <= 0 || src.ElementLength() % static_cast<size_t>(dims) != 0) {
+        Napi::RangeError::New(env, "matrix length must be a multiple of dims").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    size_t rows = src.ElementLength() / static_cast<size_t>(dims);
+    Napi::Int8Array data = Napi::Int8Array::New(env, src.ElementLength());
+    Napi::Float32Array scales = Napi::Float32Array::New(env, rows);
+    QuantizeRowsInt8(src.Data(), rows, static_cast<size_t>(dims), data.Data(), scales.Data());
+    
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("data", data);
+    result.Set("scales", scales);
+    return result;
+}
+
+Napi::Value SimdOps::SumUint8(const Napi::CallbackInfo& info) {
+    return SimdSumUint8(info);
+}
+
+Napi::Value SimdOps::FindPattern(const Napi::CallbackInfo& info) {
+    return SimdFindPattern(info);
+}
+
+Napi::Value SimdOps::FindAll(const Napi::CallbackInfo& info) {
+    return SimdFindAll(info);
+}
+
+Napi::Value SimdOps::Count(const Napi::CallbackInfo& info) {
+    return SimdCount(info);
+}
+
+Napi::Value SimdOps::AndBuffers(const Napi::CallbackInfo& info) {
+    return SimdAndBuffers(info);
+}
+
+Napi::Value SimdOps::SumUint8Async(const Napi::CallbackInfo& info) {
+    return SimdSumUint8Async(info);
+}
+
+Napi::Value SimdOps::FindPatternAsync(const Napi::CallbackInfo& info) {
+    return SimdFindPatternAsync(info);
+}
+
+Napi::Value SimdOps::CountAsync(const Napi::CallbackInfo& info) {
+    return SimdCountAsync(info);
+}
+
+Napi::Value SimdOps::AndBuffersAsync(const Napi::CallbackInfo& info) {
+    return SimdAndBuffersAsync(info);
+}
+
+Napi::Value SimdOps::TopK(const Napi::CallbackInfo& info) {
+    return SimdTopK(info);
+}
+
+Napi::Value SimdOps::TopKAsync(const Napi::CallbackInfo& info) {
+    return SimdTopKAsync(info);
+}
+
+Napi::Value SimdOps::ToFloat16(const Napi::CallbackInfo& info) {
+    return SimdToFloat16(info);
+}
+
+Napi::Value SimdOps::QuantizeInt8(const Napi::CallbackInfo& info) {
+    return SimdQuantizeInt8(info);
+}
+
 // Export initialization function for combined module
 Napi::Object InitSimdOps(Napi::Env env, Napi::Object exports) {
+    InitSimdKernels();
+    InitPatternSearch();
+    InitVectorKernels();
     return SimdOps::Init(env, exports);
 }
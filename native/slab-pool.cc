@@ -0,0 +1,136 @@
+#include "slab-pool.h"
+
+#include <algorithm>
+#include <new>
+
+// Blocks are cache-line aligned so SIMD kernels never straddle a line at
+// the start of a pooled buffer.
+static constexpr size_t kBlockAlign = 64;
+static constexpr size_t kMinClass = 64;
+
+static size_t RoundUpPow2(size_t v) {
+    size_t p = kMinClass;
+    while (p < v && p <= (SIZE_MAX >> 1)) {
+        p <<= 1;
+    }
+    return p;
+}
+
+std::vector<size_t> SlabPool::DefaultClasses() {
+    // 64 B .. 1 MiB: WS frames up to media chunks
+    std::vector<size_t> sizes;
+    for (size_t s = kMinClass; s <= (1u << 20); s <<= 1) {
+        sizes.push_back(s);
+    }
+    return sizes;
+}
+
+SlabPool::SlabPool(const std::vector<size_t>& classSizes, size_t maxBytes)
+    : max_bytes_(maxBytes) {
+    std::vector<size_t> sizes;
+    sizes.reserve(classSizes.size());
+    for (size_t s : classSizes) {
+        sizes.push_back(RoundUpPow2(s));
+    }
+    std::sort(sizes.begin(), sizes.end());
+    sizes.erase(std::unique(sizes.begin(), sizes.end()), sizes.end());
+
+    for (size_t s : sizes) {
+        classes_.push_back(SizeClass{s, {}, 0});
+    }
+}
+
+SlabPool::~SlabPool() {
+    for (SizeClass& c : classes_) {
+        for (uint8_t* block : c.free) {
+            FreeBlock(block, c.size);
+        }
+    }
+}
+
+uint8_t* SlabPool::AllocateBlock(size_t size) {
+    return static_cast<uint8_t*>(::operator new(size, std::align_val_t(kBlockAlign)));
+}
+
+void SlabPool::FreeBlock(uint8_t* block, size_t size) {
+    ::operator delete(block, size, std::align_val_t(kBlockAlign));
+}
+
+int SlabPool::ClassFor(size_t size) const {
+    // Few classes: a linear scan beats a branchy binary search
+    for (size_t i = 0; i < classes_.size(); i++) {
+        if (classes_[i].size >= size) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+uint8_t* SlabPool::Acquire(int cls, bool* fresh) {
+    SizeClass& c = classes_[cls];
+    stats_.acquires++;
+
+    uint8_t* block;
+    if (!c.free.empty()) {
+        block = c.free.back();
+        c.free.pop_back();
+        c.low_water = std::min(c.low_water, c.free.size());
+        stats_.bytes_free -= c.size;
+        stats_.hits++;
+        *fresh = false;
+    } else {
+        block = AllocateBlock(c.size);
+        c.low_water = 0;
+        stats_.misses++;
+        *fresh = true;
+    }
+
+    stats_.bytes_outstanding += c.size;
+    stats_.high_water = std::max(stats_.high_water, stats_.bytes_outstanding + stats_.bytes_free);
+    return block;
+}
+
+size_t SlabPool::Release(int cls, uint8_t* block) {
+    SizeClass& c = classes_[cls];
+    stats_.bytes_outstanding -= c.size;
+
+    if (stats_.bytes_outstanding + stats_.bytes_free + c.size > max_bytes_) {
+        FreeBlock(block, c.size);
+        return c.size;
+    }
+
+    c.free.push_back(block);
+    stats_.bytes_free += c.size;
+    return 0;
+}
+
+size_t SlabPool::Trim() {
+    size_t freed = 0;
+    for (SizeClass& c : classes_) {
+        // low_water blocks were never popped during the window: surplus
+        size_t surplus = std::min(c.low_water, c.free.size());
+        for (size_t i = 0; i < surplus; i++) {
+            // Oldest entries sit at the front of the LIFO list
+            FreeBlock(c.free[i], c.size);
+        }
+        c.free.erase(c.free.begin(), c.free.begin() + static_cast<ptrdiff_t>(surplus));
+        freed += surplus * c.size;
+        c.low_water = c.free.size();
+    }
+    stats_.bytes_free -= freed;
+    return freed;
+}
+
+size_t SlabPool::Purge() {
+    size_t freed = 0;
+    for (SizeClass& c : classes_) {
+        for (uint8_t* block : c.free) {
+            FreeBlock(block, c.size);
+        }
+        freed += c.free.size() * c.size;
+        c.free.clear();
+        c.low_water = 0;
+    }
+    stats_.bytes_free -= freed;
+    return freed;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Power-of-two size-class allocator with LIFO free lists.
+//
+// Not thread-safe: each pool belongs to one JS environment and is only
+// touched from its thread (acquire, release and GC finalizers all run there).
+//
+// Cached blocks are bounded two ways: a release that would push resident
+// bytes (outstanding + cached) over maxBytes frees the block instead, and
+// Trim() frees every block that sat unused since the previous Trim() (the
+// per-class low-water mark of the free list).
+
+class SlabPool {
+public:
+    struct Stats {
+        uint64_t acquires = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        size_t bytes_free = 0;
+        size_t bytes_outstanding = 0;
+        size_t high_water = 0;
+    };
+
+    // Class sizes are rounded up to powers of two (minimum 64) and deduped.
+    SlabPool(const std::vector<size_t>& classSizes, size_t maxBytes);
+    ~SlabPool();
+
+    SlabPool(const SlabPool&) = delete;
+    SlabPool& operator=(const SlabPool&) = delete;
+
+    // Smallest class holding `size`, or -1 when it exceeds the largest class.
+    int ClassFor(size_t size) const;
+    size_t ClassSize(int cls) const { return classes_[cls].size; }
+    size_t ClassCount() const { return classes_.size(); }
+
+    // Pops a cached block or allocates one; *fresh reports a new allocation.
+    uint8_t* Acquire(int cls, bool* fresh);
+
+    // Returns a block to its class. Returns the bytes actually freed (0 when
+    // the block was cached for reuse).
+    size_t Release(int cls, uint8_t* block);
+
+    // Frees blocks idle since the last call; returns the bytes freed.
+    size_t Trim();
+
+    // Frees every cached block; returns the bytes freed.
+    size_t Purge();
+
+    size_t MaxBytes() const { return max_bytes_; }
+    void SetMaxBytes(size_t maxBytes) { max_bytes_ = maxBytes; }
+    const Stats& GetStats() const { return stats_; }
+
+    static std::vector<size_t> DefaultClasses();
+
+private:
+    struct SizeClass {
+        size_t size;
+        std::vector<uint8_t*> free;
+        size_t low_water;
+    };
+
+    static uint8_t* AllocateBlock(size_t size);
+    static void FreeBlock(uint8_t* block, size_t size);
+
+    std::vector<SizeClass> classes_;
+    size_t max_bytes_;
+    Stats stats_;
+};
@@ -0,0 +1,59 @@
+#include <napi.h>
+#include <vector>
+#include "op-stats.h"
+
+// Native op instrumentation, exported as module-level functions.
+
+// setOpStatsEnabled(enabled)
+static Napi::Value StatsSetEnabled(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsBoolean()) {
+        Napi::TypeError::New(env, "Expected (enabled)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    SetOpStatsEnabled(info[0].As<Napi::Boolean>().Value());
+    return env.Undefined();
+}
+
+// opStats(): [{ op, calls, bytes, totalNs, buckets: Float64Array }] for ops
+// called at least once, cumulative over all threads. buckets[i] counts calls
+// that took at most opLatencyBounds[i] ns (and more than the bucket before).
+static Napi::Value StatsSnapshot(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    std::vector<OpStats> stats;
+    SnapshotOpStats(&stats);
+
+    Napi::Array result = Napi::Array::New(env);
+    uint32_t index = 0;
+    for (size_t op = 0; op < stats.size(); op++) {
+        const OpStats& entry = stats[op];
+        if (entry.calls == 0) {
+            continue;
+        }
+        Napi::Float64Array buckets = Napi::Float64Array::New(env, kOpLatencyBuckets);
+        for (size_t i = 0; i < kOpLatencyBuckets; i++) {
+            buckets[i] = static_cast<double>(entry.buckets[i]);
+        }
+        Napi::Object item = Napi::Object::New(env);
+        item.Set("op", Napi::String::New(env, NativeOpName(static_cast<NativeOp>(op))));
+        item.Set("calls", Napi::Number::New(env, static_cast<double>(entry.calls)));
+        item.Set("bytes", Napi::Number::New(env, static_cast<double>(entry.bytes)));
+        item.Set("totalNs", Napi::Number::New(env, static_cast<double>(entry.total_ns)));
+        item.Set("buckets", buckets);
+        result.Set(index++, item);
+    }
+    return result;
+}
+
+Napi::Object InitStatsOps(Napi::Env env, Napi::Object exports) {
+    Napi::Float64Array bounds = Napi::Float64Array::New(env, kOpLatencyBuckets);
+    for (size_t i = 0; i < kOpLatencyBuckets; i++) {
+        bounds[i] = static_cast<double>(OpLatencyBucketMax(i));
+    }
+    exports.Set("opLatencyBounds", bounds);
+    exports.Set("opStats", Napi::Function::New<StatsSnapshot>(env, "opStats"));
+    exports.Set("setOpStatsEnabled", Napi::Function::New<StatsSetEnabled>(env, "setOpStatsEnabled"));
+    return exports;
+}
@@ -0,0 +1,420 @@
+#include "telephony-dsp.h"
+#include "cpu-features.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#if defined(HAS_X86_SIMD)
+  #include <immintrin.h>
+#elif defined(HAS_ARM_SIMD)
+  #include <arm_neon.h>
+#endif
+
+static inline int16_t LoadSample(const uint8_t* p) {
+    return static_cast<int16_t>(static_cast<uint16_t>(p[0]) | (static_cast<uint16_t>(p[1]) << 8));
+}
+
+static inline void StoreSample(uint8_t* p, int16_t sample) {
+    uint16_t bits = static_cast<uint16_t>(sample);
+    p[0] = static_cast<uint8_t>(bits);
+    p[1] = static_cast<uint8_t>(bits >> 8);
+}
+
+// ---------------------------------------------------------------------------
+// G.711
+// ---------------------------------------------------------------------------
+
+static uint8_t mulaw_encode[65536];
+static uint8_t alaw_encode[65536];
+static int16_t mulaw_decode[256];
+static int16_t alaw_decode[256];
+
+static uint8_t LinearToMulaw(int sample) {
+    const int kBias = 132;
+    const int kClip = 32635;
+
+    int sign = sample < 0 ? 0x80 : 0;
+    if (sample < 0) {
+        sample = -sample;
+    }
+    if (sample > kClip) {
+        sample = kClip;
+    }
+    sample += kBias;
+    int exponent = 7;
+    for (int mask = 0x4000; (sample & mask) == 0 && exponent > 0; exponent--) {
+        mask >>= 1;
+    }
+    int mantissa = (sample >> (exponent + 3)) & 0x0f;
+    return static_cast<uint8_t>(~(sign | (exponent << 4) | mantissa) & 0xff);
+}
+
+static int16_t MulawToLinear(uint8_t value) {
+    int bits = ~value & 0xff;
+    int exponent = (bits >> 4) & 0x07;
+    int mantissa = bits & 0x0f;
+    int sample = (((mantissa << 3) + 132) << exponent) - 132;
+    return static_cast<int16_t>((bits & 0x80) ? -sample : sample);
+}
+
+static uint8_t LinearToAlaw(int sample) {
+    static const int kSegmentEnd[8] = {0x1f, 0x3f, 0x7f, 0xff, 0x1ff, 0x3ff, 0x7ff, 0xfff};
+
+    sample >>= 3;
+    int mask;
+    if (sample >= 0) {
+        mask = 0xd5;
+    } else {
+        mask = 0x55;
+        sample = -sample - 1;
+    }
+    int segment = 0;
+    while (segment < 8 && sample > kSegmentEnd[segment]) {
+        segment++;
+    }
+    if (segment >= 8) {
+        return static_cast<uint8_t>(0x7f ^ mask);
+    }
+    int value = segment << 4;
+    value |= segment < 2 ? (sample >> 1) & 0x0f : (sample >> segment) & 0x0f;
+    return static_cast<uint8_t>(value ^ mask);
+}
+
+static int16_t AlawToLinear(uint8_t value) {
+    int bits = value ^ 0x55;
+    int sample = (bits & 0x0f) << 4;
+    int segment = (bits & 0x70) >> 4;
+    if (segment == 0) {
+        sample += 8;
+    } else {
+        sample += 0x108;
+        sample <<= segment - 1;
+    }
+    return static_cast<int16_t>((bits & 0x80) ? sample : -sample);
+}
+
+static void BuildG711Tables() {
+    for (int i = 0; i < 65536; i++) {
+        int sample = static_cast<int16_t>(static_cast<uint16_t>(i));
+        mulaw_encode[i] = LinearToMulaw(sample);
+        alaw_encode[i] = LinearToAlaw(sample);
+    }
+    for (int i = 0; i < 256; i++) {
+        mulaw_decode[i] = MulawToLinear(static_cast<uint8_t>(i));
+        alaw_decode[i] = AlawToLinear(static_cast<uint8_t>(i));
+    }
+}
+
+void G711Encode(G711Law law, const uint8_t* pcm, size_t samples, uint8_t* out) {
+    const uint8_t* table = law == G711Law::kMulaw ? mulaw_encode : alaw_encode;
+    for (size_t i = 0; i < samples; i++) {
+        out[i] = table[pcm[2 * i] | (pcm[2 * i + 1] << 8)];
+    }
+}
+
+void G711Decode(G711Law law, const uint8_t* in, size_t count, uint8_t* pcm) {
+    const int16_t* table = law == G711Law::kMulaw ? mulaw_decode : alaw_decode;
+    for (size_t i = 0; i < count; i++) {
+        StoreSample(pcm + 2 * i, table[in[i]]);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Resampler
+// ---------------------------------------------------------------------------
+
+struct ResamplerBank {
+    uint32_t up = 1;        // L: interpolation factor of the reduced ratio
+    uint32_t down = 1;      // M: decimation factor
+    size_t half = 0;        // taps on each side of the output instant
+    size_t stride = 0;      // taps per phase, padded to a multiple of 8
+    std::vector<float> coefs;  // up x stride, zero padded
+};
+
+static const uint32_t kMaxRate = 384000;
+static const uint32_t kMaxPhases = 1024;
+static const size_t kMaxCoefs = size_t{1} << 20;
+static const double kZeroCrossings = 16.0;
+static const double kKaiserBeta = 8.0;
+// Cutoff as a fraction of the narrower Nyquist band, leaving room for the
+// transition band so images fold below -80 dB
+static const double kCutoff = 0.9;
+
+static double BesselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 64; k++) {
+        double factor = x / (2.0 * k);
+        term *= factor * factor;
+        sum += term;
+        if (term < sum * 1e-12) {
+            break;
+        }
+    }
+    return sum;
+}
+
+// Null when the bank would exceed kMaxCoefs (ratios far beyond audio use)
+static std::unique_ptr<ResamplerBank> BuildBank(uint32_t up, uint32_t down) {
+    // Filter in input-sample time: cutoff fc of the input Nyquist
+    double fc = kCutoff * std::min(1.0, static_cast<double>(up) / down);
+    double half = std::ceil(kZeroCrossings / fc);
+    if (half * up * 2 > static_cast<double>(kMaxCoefs)) {
+        return nullptr;
+    }
+
+    auto bank = std::make_unique<ResamplerBank>();
+    bank->up = up;
+    bank->down = down;
+    bank->half = static_cast<size_t>(half);
+    bank->stride = (2 * bank->half + 7) & ~static_cast<size_t>(7);
+    bank->coefs.assign(static_cast<size_t>(up) * bank->stride, 0.0f);
+
+    const double pi = 3.14159265358979323846;
+    double i0_beta = BesselI0(kKaiserBeta);
+    std::vector<double> taps(2 * bank->half);
+    for (uint32_t phase = 0; phase < up; phase++) {
+        double sum = 0;
+        for (size_t j = 0; j < taps.size(); j++) {
+            // Distance from the output instant to input sample j of the window
+            double d = static_cast<double>(phase) / up + static_cast<double>(bank->half) - 1.0 - j;
+            double x = d / bank->half;
+            double window = x * x < 1.0 ? BesselI0(kKaiserBeta * std::sqrt(1.0 - x * x)) / i0_beta : 0.0;
+            double arg = pi * fc * d;
+            double sinc = arg == 0.0 ? 1.0 : std::sin(arg) / arg;
+            taps[j] = fc * sinc * window;
+            sum += taps[j];
+        }
+        // Unity DC gain for every phase, so silence and DC stay exact
+        float* row = &bank->coefs[static_cast<size_t>(phase) * bank->stride];
+        for (size_t j = 0; j < taps.size(); j++) {
+            row[j] = static_cast<float>(taps[j] / sum);
+        }
+    }
+    return bank;
+}
+
+const ResamplerBank* GetResamplerBank(uint32_t in_rate, uint32_t out_rate) {
+    if (in_rate == 0 || out_rate == 0 || in_rate > kMaxRate || out_rate > kMaxRate) {
+        return nullptr;
+    }
+    uint32_t g = std::gcd(in_rate, out_rate);
+    uint32_t up = out_rate / g;
+    uint32_t down = in_rate / g;
+    if (up > kMaxPhases) {
+        return nullptr;
+    }
+
+    static std::mutex mutex;
+    static std::map<std::pair<uint32_t, uint32_t>, std::unique_ptr<ResamplerBank>> banks;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& bank = banks[{up, down}];
+    if (!bank) {
+        bank = BuildBank(up, down);
+    }
+    return bank.get();
+}
+
+size_t ResampledLength(const ResamplerBank* bank, size_t samples) {
+    return static_cast<size_t>(static_cast<uint64_t>(samples) * bank->up / bank->down);
+}
+
+// Dot product over n taps, n a multiple of 8
+static float DotScalar(const float* a, const float* b, size_t n) {
+    float sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+#if defined(HAS_X86_DISPATCH)
+OPENCLAW_TARGET("avx2")
+static float DotAvx2(const float* a, const float* b, size_t n) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+        acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8)));
+    }
+    if (i < n) {
+        acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    }
+    __m256 acc = _mm256_add_ps(acc0, acc1);
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+    return _mm_cvtss_f32(sum);
+}
+#endif
+
+#if defined(HAS_ARM_SIMD)
+static float DotNeon(const float* a, const float* b, size_t n) {
+    float32x4_t acc0 = vdupq_n_f32(0);
+    float32x4_t acc1 = vdupq_n_f32(0);
+    for (size_t i = 0; i < n; i += 8) {
+        acc0 = vfmaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+        acc1 = vfmaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+    return vaddvq_f32(vaddq_f32(acc0, acc1));
+}
+#endif
+
+using DotFn = float (*)(const float*, const float*, size_t);
+static DotFn dot_impl = DotScalar;
+
+void Resample(const ResamplerBank* bank, const uint8_t* pcm, size_t samples, uint8_t* out) {
+    size_t count = ResampledLength(bank, samples);
+    if (count == 0) {
+        return;
+    }
+
+    // Input as float, with silence before and after for the window to
+    // reach into; the first tap of output n sits at input n*M/L - half + 1
+    size_t lead = bank->half - 1;
+    thread_local std::vector<float> input;
+    input.assign(samples + bank->stride, 0.0f);
+    for (size_t i = 0; i < samples; i++) {
+        input[lead + i] = LoadSample(pcm + 2 * i);
+    }
+
+    for (size_t n = 0; n < count; n++) {
+        uint64_t t = static_cast<uint64_t>(n) * bank->down;
+        size_t base = static_cast<size_t>(t / bank->up);
+        size_t phase = static_cast<size_t>(t % bank->up);
+        float y = dot_impl(&bank->coefs[phase * bank->stride], &input[base], bank->stride);
+        long rounded = std::lrint(y);
+        StoreSample(out + 2 * n, static_cast<int16_t>(std::clamp(rounded, -32768L, 32767L)));
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Voice activity
+// ---------------------------------------------------------------------------
+
+struct FrameSums {
+    uint64_t energy = 0;
+    uint64_t crossings = 0;
+};
+
+// Sign changes count between consecutive samples; zero is positive
+static FrameSums SumPcmScalar(const uint8_t* pcm, size_t samples, FrameSums sums) {
+    for (size_t i = 0; i < samples; i++) {
+        int32_t s = LoadSample(pcm + 2 * i);
+        sums.energy += static_cast<uint64_t>(s * s);
+        if (i + 1 < samples && ((s ^ LoadSample(pcm + 2 * i + 2)) & 0x8000)) {
+            sums.crossings++;
+        }
+    }
+    return sums;
+}
+
+#if defined(HAS_X86_DISPATCH)
+// 16 samples per step, each compared with its successor; the scalar tail
+// picks up the last sample and the final pair
+OPENCLAW_TARGET("avx2")
+static FrameSums SumPcmAvx2(const uint8_t* pcm, size_t samples) {
+    FrameSums sums;
+    __m256i zero = _mm256_setzero_si256();
+    __m256i energy = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 17 <= samples; i += 16) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pcm + 2 * i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pcm + 2 * i + 2));
+        // Pairs of squares reach 2^31, so they are widened as unsigned
+        __m256i squares = _mm256_madd_epi16(a, a);
+        energy = _mm256_add_epi64(energy, _mm256_unpacklo_epi32(squares, zero));
+        energy = _mm256_add_epi64(energy, _mm256_unpackhi_epi32(squares, zero));
+        uint32_t flips = static_cast<uint32_t>(
+            _mm256_movemask_epi8(_mm256_srai_epi16(_mm256_xor_si256(a, b), 15)));
+        sums.crossings += static_cast<uint64_t>(__builtin_popcount(flips)) / 2;
+    }
+    alignas(32) uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), energy);
+    sums.energy = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    return SumPcmScalar(pcm + 2 * i, samples - i, sums);
+}
+#endif
+
+#if defined(HAS_ARM_SIMD)
+static FrameSums SumPcmNeon(const uint8_t* pcm, size_t samples) {
+    FrameSums sums;
+    uint64x2_t energy = vdupq_n_u64(0);
+    size_t i = 0;
+    for (; i + 9 <= samples; i += 8) {
+        int16x8_t a = vreinterpretq_s16_u8(vld1q_u8(pcm + 2 * i));
+        int16x8_t b = vreinterpretq_s16_u8(vld1q_u8(pcm + 2 * i + 2));
+        int16x4_t lo = vget_low_s16(a);
+        int16x4_t hi = vget_high_s16(a);
+        energy = vpadalq_u32(energy, vreinterpretq_u32_s32(vmull_s16(lo, lo)));
+        energy = vpadalq_u32(energy, vreinterpretq_u32_s32(vmull_s16(hi, hi)));
+        uint16x8_t flips = vshrq_n_u16(vreinterpretq_u16_s16(veorq_s16(a, b)), 15);
+        sums.crossings += vaddvq_u16(flips);
+    }
+    sums.energy = vaddvq_u64(energy);
+    return SumPcmScalar(pcm + 2 * i, samples - i, sums);
+}
+#endif
+
+static FrameSums SumPcmDefault(const uint8_t* pcm, size_t samples) {
+    return SumPcmScalar(pcm, samples, FrameSums());
+}
+
+using SumPcmFn = FrameSums (*)(const uint8_t*, size_t);
+static SumPcmFn sum_pcm_impl = SumPcmDefault;
+
+static VoiceActivity ToActivity(const FrameSums& sums, size_t samples) {
+    VoiceActivity activity;
+    if (samples > 0) {
+        activity.rms = std::sqrt(static_cast<double>(sums.energy) / samples);
+    }
+    if (samples > 1) {
+        activity.zero_crossing_rate = static_cast<double>(sums.crossings) / (samples - 1);
+    }
+    return activity;
+}
+
+VoiceActivity MeasurePcm(const uint8_t* pcm, size_t samples) {
+    return ToActivity(sum_pcm_impl(pcm, samples), samples);
+}
+
+VoiceActivity MeasureG711(G711Law law, const uint8_t* in, size_t count) {
+    const int16_t* table = law == G711Law::kMulaw ? mulaw_decode : alaw_decode;
+    FrameSums sums;
+    for (size_t i = 0; i < count; i++) {
+        int32_t s = table[in[i]];
+        sums.energy += static_cast<uint64_t>(s * s);
+        if (i + 1 < count && ((s ^ table[in[i + 1]]) & 0x8000)) {
+            sums.crossings++;
+        }
+    }
+    return ToActivity(sums, count);
+}
+
+// ---------------------------------------------------------------------------
+// Dispatch
+// ---------------------------------------------------------------------------
+
+static void SelectKernels() {
+    BuildG711Tables();
+#if defined(HAS_X86_DISPATCH)
+    if (GetCpuFeatures().avx2) {
+        dot_impl = DotAvx2;
+        sum_pcm_impl = SumPcmAvx2;
+    }
+#elif defined(HAS_ARM_SIMD)
+    dot_impl = DotNeon;
+    sum_pcm_impl = SumPcmNeon;
+#endif
+}
+
+void InitTelephonyDsp() {
+    static std::once_flag once;
+    std::call_once(once, SelectKernels);
+}
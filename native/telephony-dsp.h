@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Telephony audio kernels for the voice-call path: G.711 companding,
+// rational-ratio resampling and a frame-level voice activity check. N-API
+// free.
+//
+// PCM is 16-bit signed little-endian mono, read and written bytewise so
+// unaligned Buffer views are fine.
+//
+// G.711 is table driven: a 64K-entry encode table per law, indexed by the
+// raw sample, and a 256-entry decode table. The mu-law tables reproduce the
+// JS linearToMulaw()/mulawToLinear() in extensions/voice-call bit for bit;
+// A-law follows the ITU reference (Sun g711.c).
+//
+// The resampler is polyphase windowed-sinc (Kaiser, beta 8, 16 zero
+// crossings, cutoff at 0.9 of the narrower Nyquist band: flat to 3 kHz and
+// -3 dB at 3.5 kHz for 8 kHz output). A filter bank is built once per rate
+// pair and shared for the process; each output sample is one dot product
+// over the phase's taps (AVX2 / NEON). Input outside the buffer is taken as
+// silence, so whole utterances resample without state.
+
+// Build tables and pick kernels for this host. Idempotent; called from
+// module init.
+void InitTelephonyDsp();
+
+enum class G711Law { kMulaw, kAlaw };
+
+// `samples` samples of PCM -> `samples` bytes
+void G711Encode(G711Law law, const uint8_t* pcm, size_t samples, uint8_t* out);
+
+// `count` bytes -> `count` samples (2 * count bytes) of PCM
+void G711Decode(G711Law law, const uint8_t* in, size_t count, uint8_t* pcm);
+
+struct ResamplerBank;
+
+// Filter bank for in_rate -> out_rate, or null when the reduced ratio has
+// more than 1024 phases, the filter would be impractically long, or a rate
+// is outside 1..384000 Hz.
+const ResamplerBank* GetResamplerBank(uint32_t in_rate, uint32_t out_rate);
+
+// Output samples for `samples` input samples: floor(samples * out / in)
+size_t ResampledLength(const ResamplerBank* bank, size_t samples);
+
+// Writes ResampledLength(bank, samples) samples to `out`
+void Resample(const ResamplerBank* bank, const uint8_t* pcm, size_t samples, uint8_t* out);
+
+struct VoiceActivity {
+    double rms = 0;                  // in sample units (0..32768)
+    double zero_crossing_rate = 0;   // sign changes per sample pair
+};
+
+// Energy and zero crossings of one frame of PCM
+VoiceActivity MeasurePcm(const uint8_t* pcm, size_t samples);
+
+// Same, for G.711 bytes (decoded through the table)
+VoiceActivity MeasureG711(G711Law law, const uint8_t* in, size_t count);
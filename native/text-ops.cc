@@ -0,0 +1,244 @@
+#include <napi.h>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+#include "markdown-chunker.h"
+#include "op-stats.h"
+#include "promise-worker.h"
+#include "utf8.h"
+
+// Text processing for memory indexing and UTF-8 handling on raw bytes,
+// exported as module-level functions.
+
+// -ffast-math lets the compiler assume numbers are finite, so check the bits
+static bool IsFiniteNumber(double v) {
+    uint64_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    return (bits & 0x7ff0000000000000ULL) != 0x7ff0000000000000ULL;
+}
+
+static bool ReadChunkInteger(const Napi::Object& options, const char* key, int64_t* out) {
+    Napi::Value value = options.Get(key);
+    if (!value.IsNumber()) {
+        return false;
+    }
+    double number = value.As<Napi::Number>().DoubleValue();
+    if (!IsFiniteNumber(number) || std::trunc(number) != number) {
+        return false;
+    }
+    *out = value.As<Napi::Number>().Int64Value();
+    return true;
+}
+
+// Parses (buffer, { tokens, overlap }); throws and returns false on bad input.
+static bool ReadChunkRequest(const Napi::CallbackInfo& info, MarkdownChunkOptions* options) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsBuffer() || !info[1].IsObject()) {
+        Napi::TypeError::New(env, "Expected (buffer, { tokens, overlap })").ThrowAsJavaScriptException();
+        return false;
+    }
+
+    Napi::Object opts = info[1].As<Napi::Object>();
+    if (!ReadChunkInteger(opts, "tokens", &options->tokens) ||
+        !ReadChunkInteger(opts, "overlap", &options->overlap)) {
+        Napi::TypeError::New(env, "tokens and overlap must be integers").ThrowAsJavaScriptException();
+        return false;
+    }
+    return true;
+}
+
+static Napi::Uint32Array CopyUint32(Napi::Env env, const std::vector<uint32_t>& values) {
+    Napi::Uint32Array array = Napi::Uint32Array::New(env, values.size());
+    if (!values.empty()) {
+        std::memcpy(array.Data(), values.data(), values.size() * sizeof(uint32_t));
+    }
+    return array;
+}
+
+// { starts, ends, startLines, endLines, breaks: Uint32Array, blank: Uint8Array,
+//   hashes: Buffer } or null when the caller must chunk the decoded string
+static Napi::Value ChunkResult(Napi::Env env, bool ok, const MarkdownChunks& chunks) {
+    if (!ok) {
+        return env.Null();
+    }
+
+    Napi::Uint8Array blank = Napi::Uint8Array::New(env, chunks.blank.size());
+    if (!chunks.blank.empty()) {
+        std::memcpy(blank.Data(), chunks.blank.data(), chunks.blank.size());
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("starts", CopyUint32(env, chunks.starts));
+    result.Set("ends", CopyUint32(env, chunks.ends));
+    result.Set("startLines", CopyUint32(env, chunks.start_lines));
+    result.Set("endLines", CopyUint32(env, chunks.end_lines));
+    result.Set("breaks", CopyUint32(env, chunks.breaks));
+    result.Set("blank", blank);
+    result.Set("hashes", Napi::Buffer<uint8_t>::Copy(env, chunks.hashes.data(), chunks.hashes.size()));
+    return result;
+}
+
+Napi::Value TextChunkMarkdown(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    MarkdownChunkOptions options;
+    if (!ReadChunkRequest(info, &options)) {
+        return env.Null();
+    }
+
+    Napi::Buffer<uint8_t> buffer = info[0].As<Napi::Buffer<uint8_t>>();
+    OpScope scope(NativeOp::kChunkMarkdown, buffer.Length());
+    MarkdownChunks chunks;
+    bool ok = ChunkMarkdown(buffer.Data(), buffer.Length(), options, &chunks);
+    return ChunkResult(env, ok, chunks);
+}
+
+class ChunkMarkdownWorker : public PromiseWorker {
+public:
+    ChunkMarkdownWorker(Napi::Env env, const Napi::Buffer<uint8_t>& buffer,
+                        const MarkdownChunkOptions& options)
+        : PromiseWorker(env, "openclaw:chunkMarkdown"),
+          data_(buffer.Data()), len_(buffer.Length()), options_(options) {
+        Keep(buffer);
+    }
+
+    void Execute() override {
+        OpScope scope(NativeOp::kChunkMarkdown, len_);
+        ok_ = ChunkMarkdown(data_, len_, options_, &chunks_);
+    }
+
+    Napi::Value Result(Napi::Env env) override {
+        return ChunkResult(env, ok_, chunks_);
+    }
+
+private:
+    const uint8_t* data_;
+    size_t len_;
+    MarkdownChunkOptions options_;
+    MarkdownChunks chunks_;
+    bool ok_ = false;
+};
+
+Napi::Value TextChunkMarkdownAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    MarkdownChunkOptions options;
+    if (!ReadChunkRequest(info, &options)) {
+        return env.Null();
+    }
+
+    return (new ChunkMarkdownWorker(env, info[0].As<Napi::Buffer<uint8_t>>(), options))->Start();
+}
+
+static bool ReadUtf8Bytes(Napi::Value value, const uint8_t** data, size_t* len) {
+    if (!value.IsTypedArray() || value.As<Napi::TypedArray>().TypedArrayType() != napi_uint8_array) {
+        return false;
+    }
+    Napi::Uint8Array bytes = value.As<Napi::Uint8Array>();
+    *data = bytes.Data();
+    *len = bytes.ByteLength();
+    return true;
+}
+
+// utf8Validate(bytes): boolean
+Napi::Value TextUtf8Validate(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    const uint8_t* data;
+    size_t len;
+    if (info.Length() < 1 || !ReadUtf8Bytes(info[0], &data, &len)) {
+        Napi::TypeError::New(env, "Expected Uint8Array").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    OpScope scope(NativeOp::kUtf8Validate, len);
+    return Napi::Boolean::New(env, Utf8Validate(data, len));
+}
+
+// utf16Length(bytes): the decoded string's length, or null when the bytes
+// are not valid UTF-8
+Napi::Value TextUtf16Length(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    const uint8_t* data;
+    size_t len;
+    if (info.Length() < 1 || !ReadUtf8Bytes(info[0], &data, &len)) {
+        Napi::TypeError::New(env, "Expected Uint8Array").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    if (!Utf8Validate(data, len)) {
+        return env.Null();
+    }
+    return Napi::Number::New(env, static_cast<double>(Utf8Utf16Length(data, len)));
+}
+
+// Optional limit: missing means none; numbers are floored and clamped at 0,
+// as truncateUtf16Safe() treats its maxLen
+static bool ReadTruncateLimit(const Napi::Object& options, const char* key, size_t* out) {
+    Napi::Value value = options.Get(key);
+    if (value.IsUndefined()) {
+        *out = std::numeric_limits<size_t>::max();
+        return true;
+    }
+    if (!value.IsNumber()) {
+        return false;
+    }
+    double number = value.As<Napi::Number>().DoubleValue();
+    if (!IsFiniteNumber(number)) {
+        *out = number > 0 ? std::numeric_limits<size_t>::max() : 0;
+        return true;
+    }
+    number = std::floor(number);
+    *out = number <= 0 ? 0 : number >= 9007199254740992.0 ? std::numeric_limits<size_t>::max()
+                                                           : static_cast<size_t>(number);
+    return true;
+}
+
+// truncateUtf8(bytes, { maxChars?, maxBytes? }): string or null.
+//
+// Decodes only the longest prefix within both limits (UTF-16 code units and
+// UTF-8 bytes) that ends on a code point boundary; the full text never
+// becomes a JS string. Only that prefix is validated: null when it is not
+// valid UTF-8.
+Napi::Value TextTruncateUtf8(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    const uint8_t* data;
+    size_t len;
+    if (info.Length() < 1 || !ReadUtf8Bytes(info[0], &data, &len) ||
+        (info.Length() > 1 && !info[1].IsUndefined() && !info[1].IsObject())) {
+        Napi::TypeError::New(env, "Expected (Uint8Array, { maxChars?, maxBytes? })").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    size_t max_chars = std::numeric_limits<size_t>::max();
+    size_t max_bytes = std::numeric_limits<size_t>::max();
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Object options = info[1].As<Napi::Object>();
+        if (!ReadTruncateLimit(options, "maxChars", &max_chars) ||
+            !ReadTruncateLimit(options, "maxBytes", &max_bytes)) {
+            Napi::TypeError::New(env, "maxChars and maxBytes must be numbers").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+    }
+
+    size_t end = Utf8PrefixForBytes(data, len, max_bytes);
+    end = Utf8PrefixForUtf16(data, end, max_chars);
+    if (!Utf8Validate(data, end)) {
+        return env.Null();
+    }
+    return Napi::String::New(env, reinterpret_cast<const char*>(data), end);
+}
+
+Napi::Object InitTextOps(Napi::Env env, Napi::Object exports) {
+    InitMarkdownChunker();
+    InitUtf8();
+
+    exports.Set("chunkMarkdown", Napi::Function::New<TextChunkMarkdown>(env, "chunkMarkdown"));
+    exports.Set("chunkMarkdownAsync", Napi::Function::New<TextChunkMarkdownAsync>(env, "chunkMarkdownAsync"));
+    exports.Set("utf8Validate", Napi::Function::New<TextUtf8Validate>(env, "utf8Validate"));
+    exports.Set("utf16Length", Napi::Function::New<TextUtf16Length>(env, "utf16Length"));
+    exports.Set("truncateUtf8", Napi::Function::New<TextTruncateUtf8>(env, "truncateUtf8"));
+    return exports;
+}
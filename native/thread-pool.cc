@@ -0,0 +1,110 @@
+#include "thread-pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+
+struct ThreadPool::Job {
+    const std::function<void(size_t)>* body;
+    size_t count;
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> done{0};
+    std::mutex mutex;
+    std::condition_variable finished;
+};
+
+static size_t DefaultWorkerCount() {
+    if (const char* env = std::getenv("OPENCLAW_NATIVE_THREADS")) {
+        long n = std::strtol(env, nullptr, 10);
+        if (n >= 1) {
+            // The variable counts the caller too
+            return static_cast<size_t>(std::min(n, 256L)) - 1;
+        }
+    }
+    unsigned hw = std::thread::hardware_concurrency();
+    return hw > 2 ? hw - 1 : 1;
+}
+
+ThreadPool& ThreadPool::Shared() {
+    // Deliberately leaked: joining at static destruction could race with a
+    // libuv thread still inside ParallelFor during process exit.
+    static ThreadPool* pool = new ThreadPool(DefaultWorkerCount());
+    return *pool;
+}
+
+ThreadPool::ThreadPool(size_t workers) {
+    workers_.reserve(workers);
+    for (size_t i = 0; i < workers; i++) {
+        workers_.emplace_back([this] { WorkerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& t : workers_) {
+        t.join();
+    }
+}
+
+void ThreadPool::RunJob(Job& job) {
+    size_t i;
+    while ((i = job.next.fetch_add(1, std::memory_order_relaxed)) < job.count) {
+        (*job.body)(i);
+        if (job.done.fetch_add(1, std::memory_order_acq_rel) + 1 == job.count) {
+            std::lock_guard<std::mutex> lock(job.mutex);
+            job.finished.notify_all();
+        }
+    }
+}
+
+void ThreadPool::WorkerLoop() {
+    for (;;) {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+            if (stopping_) {
+                return;
+            }
+            job = jobs_.front();
+            // Fully claimed jobs leave the queue; the owner still waits on them
+            if (job->next.load(std::memory_order_relaxed) >= job->count) {
+                jobs_.pop_front();
+                continue;
+            }
+        }
+        RunJob(*job);
+    }
+}
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)>& body) {
+    if (count == 0) {
+        return;
+    }
+    if (count == 1 || workers_.empty()) {
+        for (size_t i = 0; i < count; i++) {
+            body(i);
+        }
+        return;
+    }
+
+    auto job = std::make_shared<Job>();
+    job->body = &body;
+    job->count = count;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        jobs_.push_back(job);
+    }
+    wake_.notify_all();
+
+    RunJob(*job);
+
+    std::unique_lock<std::mutex> lock(job->mutex);
+    job->finished.wait(lock, [&job] { return job->done.load(std::memory_order_acquire) == job->count; });
+    // `body` goes out of scope after this; workers only touch it through an
+    // index claimed below `count`, and all of those have completed.
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size worker pool for splitting one large kernel call across cores.
+//
+// Separate from the libuv pool on purpose: AsyncWorker::Execute runs on a
+// libuv thread and fans out here, so a big job never occupies more than one
+// of libuv's (default four) threads that fs and dns also need.
+//
+// Size defaults to hardware_concurrency() - 1 (at least one) and can be set
+// with OPENCLAW_NATIVE_THREADS before the first use.
+
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t workers);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Process-wide pool, started on first use.
+    static ThreadPool& Shared();
+
+    // Threads that work on a ParallelFor, including the caller.
+    size_t Concurrency() const { return workers_.size() + 1; }
+
+    // Runs body(0) .. body(count - 1) across the pool and returns when all
+    // are done. The calling thread takes part, so nested or concurrent calls
+    // cannot deadlock. Indices are handed out in ascending order. `body`
+    // must not throw.
+    void ParallelFor(size_t count, const std::function<void(size_t)>& body);
+
+private:
+    struct Job;
+
+    void WorkerLoop();
+    static void RunJob(Job& job);
+
+    std::vector<std::thread> workers_;
+    std::deque<std::shared_ptr<Job>> jobs_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+};
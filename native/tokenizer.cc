@@ -0,0 +1,197 @@
+#include <napi.h>
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+#include "bpe-tokenizer.h"
+#include "op-stats.h"
+#include "utf8.h"
+
+// tiktoken-compatible token counting over BpeTokenizer. Instances opened on
+// the same vocabulary path share one parsed table.
+class Tokenizer : public Napi::ObjectWrap<Tokenizer> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    Tokenizer(const Napi::CallbackInfo& info);
+
+private:
+    static Napi::FunctionReference constructor;
+
+    Napi::Value Count(const Napi::CallbackInfo& info);
+
+    // One count per input, as a Uint32Array
+    Napi::Value CountMany(const Napi::CallbackInfo& info);
+
+    // { tokens, ends: Uint32Array }, ends being UTF-8 byte offsets
+    Napi::Value Encode(const Napi::CallbackInfo& info);
+
+    // The longest prefix within a token budget: { bytes, length, tokens }
+    Napi::Value Prefix(const Napi::CallbackInfo& info);
+
+    Napi::Value VocabSize(const Napi::CallbackInfo& info);
+
+    std::shared_ptr<const BpeTokenizer> tokenizer_;
+};
+
+Napi::FunctionReference Tokenizer::constructor;
+
+Napi::Object Tokenizer::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "Tokenizer", {
+        InstanceMethod("count", &Tokenizer::Count),
+        InstanceMethod("countMany", &Tokenizer::CountMany),
+        InstanceMethod("encode", &Tokenizer::Encode),
+        InstanceMethod("prefix", &Tokenizer::Prefix),
+        InstanceAccessor("vocabSize", &Tokenizer::VocabSize, nullptr),
+    });
+
+    constructor = Napi::Persistent(func);
+    constructor.SuppressDestruct();
+
+    exports.Set("Tokenizer", func);
+    return exports;
+}
+
+// new Tokenizer(path): path of a tiktoken rank file such as cl100k_base.tiktoken
+Tokenizer::Tokenizer(const Napi::CallbackInfo& info) : Napi::ObjectWrap<Tokenizer>(info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected (path)").ThrowAsJavaScriptException();
+        return;
+    }
+
+    try {
+        tokenizer_ = BpeTokenizer::Load(info[0].As<Napi::String>().Utf8Value());
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    }
+}
+
+// UTF-8 of a string or the bytes of a Uint8Array. Strings are copied into
+// `scratch`; bytes are used in place.
+static bool ReadText(const Napi::Value& value, std::string* scratch, const uint8_t** data, size_t* len) {
+    if (value.IsString()) {
+        *scratch = value.As<Napi::String>().Utf8Value();
+        *data = reinterpret_cast<const uint8_t*>(scratch->data());
+        *len = scratch->size();
+        return true;
+    }
+    if (value.IsTypedArray() && value.As<Napi::TypedArray>().TypedArrayType() == napi_uint8_array) {
+        Napi::Uint8Array bytes = value.As<Napi::Uint8Array>();
+        *data = bytes.Data();
+        *len = bytes.ByteLength();
+        return true;
+    }
+    return false;
+}
+
+Napi::Value Tokenizer::Count(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    std::string scratch;
+    const uint8_t* data;
+    size_t len;
+    if (info.Length() < 1 || !ReadText(info[0], &scratch, &data, &len)) {
+        Napi::TypeError::New(env, "Expected (string | Uint8Array)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    OpScope scope(NativeOp::kTokenizerCount, len);
+    return Napi::Number::New(env, static_cast<double>(tokenizer_->Count(data, len)));
+}
+
+Napi::Value Tokenizer::CountMany(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsArray()) {
+        Napi::TypeError::New(env, "Expected (Array<string | Uint8Array>)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    OpScope scope(NativeOp::kTokenizerCount);
+    Napi::Array texts = info[0].As<Napi::Array>();
+    uint32_t count = texts.Length();
+    Napi::Uint32Array counts = Napi::Uint32Array::New(env, count);
+    std::string scratch;
+    for (uint32_t i = 0; i < count; i++) {
+        const uint8_t* data;
+        size_t len;
+        if (!ReadText(texts.Get(i), &scratch, &data, &len)) {
+            Napi::TypeError::New(env, "texts must be strings or Uint8Arrays").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        counts[i] = static_cast<uint32_t>(tokenizer_->Count(data, len));
+        scope.AddBytes(len);
+    }
+    return counts;
+}
+
+Napi::Value Tokenizer::Encode(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    std::string scratch;
+    const uint8_t* data;
+    size_t len;
+    if (info.Length() < 1 || !ReadText(info[0], &scratch, &data, &len)) {
+        Napi::TypeError::New(env, "Expected (string | Uint8Array)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    if (len > UINT32_MAX) {
+        Napi::RangeError::New(env, "text too large").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    OpScope scope(NativeOp::kTokenizerEncode, len);
+    std::vector<uint32_t> ranks;
+    std::vector<uint32_t> ends;
+    ranks.reserve(len / 4 + 1);
+    ends.reserve(len / 4 + 1);
+    tokenizer_->Encode(data, len, &ranks, &ends);
+
+    Napi::Uint32Array tokens = Napi::Uint32Array::New(env, ranks.size());
+    Napi::Uint32Array offsets = Napi::Uint32Array::New(env, ends.size());
+    std::copy(ranks.begin(), ranks.end(), tokens.Data());
+    std::copy(ends.begin(), ends.end(), offsets.Data());
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("tokens", tokens);
+    result.Set("ends", offsets);
+    return result;
+}
+
+// prefix(text, maxTokens): { bytes, length, tokens } for the longest prefix
+// of at most maxTokens tokens that ends on a code point boundary; length is
+// in UTF-16 code units, so text.slice(0, length) is that prefix
+Napi::Value Tokenizer::Prefix(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    std::string scratch;
+    const uint8_t* data;
+    size_t len;
+    if (info.Length() < 2 || !ReadText(info[0], &scratch, &data, &len) || !info[1].IsNumber()) {
+        Napi::TypeError::New(env, "Expected (string | Uint8Array, maxTokens)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    double max_tokens = info[1].As<Napi::Number>().DoubleValue();
+    size_t budget = max_tokens > 0 ? static_cast<size_t>(std::min(max_tokens, 9007199254740991.0)) : 0;
+
+    OpScope scope(NativeOp::kTokenizerEncode, len);
+    size_t tokens = 0;
+    size_t bytes = tokenizer_->Prefix(data, len, budget, &tokens);
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("bytes", Napi::Number::New(env, static_cast<double>(bytes)));
+    result.Set("length", Napi::Number::New(env, static_cast<double>(Utf8Utf16Length(data, bytes))));
+    result.Set("tokens", Napi::Number::New(env, static_cast<double>(tokens)));
+    return result;
+}
+
+Napi::Value Tokenizer::VocabSize(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), static_cast<double>(tokenizer_->VocabSize()));
+}
+
+Napi::Object InitTokenizer(Napi::Env env, Napi::Object exports) {
+    InitUtf8();
+    return Tokenizer::Init(env, exports);
+}
@@ -0,0 +1,604 @@
+#include "transcript-archive.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include "transcript-scanner.h"
+
+namespace {
+
+constexpr uint32_t kIndexMagic = ZSTD_MAGIC_SKIPPABLE_START + 0xE;
+constexpr uint32_t kTrailerMagic = ZSTD_MAGIC_SKIPPABLE_START + 0xF;
+constexpr char kIndexTag[4] = {'O', 'C', 'T', 'I'};
+constexpr char kTrailerTag[4] = {'O', 'C', 'T', 'A'};
+constexpr uint32_t kFormatVersion = 1;
+
+constexpr size_t kEntryBytes = 48;
+constexpr size_t kIndexHeaderBytes = 8 + 12;  // frame header + tag, version, count
+constexpr size_t kTrailerBytes = 8 + 16;      // frame header + offset, size, tag
+constexpr size_t kReadChunkBytes = 1 << 20;
+
+// ---- Little-endian fields ----
+
+void Put32(std::vector<uint8_t>* out, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        out->push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+}
+
+void Put64(std::vector<uint8_t>* out, uint64_t v) {
+    for (int i = 0; i < 8; i++) {
+        out->push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+}
+
+uint32_t Get32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 | static_cast<uint32_t>(p[2]) << 16 |
+           static_cast<uint32_t>(p[3]) << 24;
+}
+
+uint64_t Get64(const uint8_t* p) {
+    return static_cast<uint64_t>(Get32(p)) | static_cast<uint64_t>(Get32(p + 4)) << 32;
+}
+
+// ---- File I/O ----
+
+std::string IoError(const char* what, const std::string& path) {
+    return std::string(what) + " " + path + ": " + std::strerror(errno);
+}
+
+// Reads exactly len bytes at offset; false with errno set (0 on a short file)
+bool ReadAt(int fd, uint64_t offset, uint8_t* out, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::pread(fd, out, len, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            if (n == 0) {
+                errno = 0;
+            }
+            return false;
+        }
+        out += n;
+        offset += static_cast<uint64_t>(n);
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool WriteAll(int fd, const uint8_t* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::write(fd, data, len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Block list of an open archive, and where its index frame starts
+struct ArchiveIndex {
+    std::vector<TranscriptBlock> blocks;
+    uint64_t index_offset = 0;
+};
+
+bool ReadIndex(int fd, const std::string& path, ArchiveIndex* index, std::string* error) {
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        *error = IoError("stat", path);
+        return false;
+    }
+    uint64_t size = static_cast<uint64_t>(st.st_size);
+    uint8_t trailer[kTrailerBytes];
+    if (size < kTrailerBytes + kIndexHeaderBytes || !ReadAt(fd, size - kTrailerBytes, trailer, kTrailerBytes) ||
+        Get32(trailer) != kTrailerMagic || Get32(trailer + 4) != 16 ||
+        std::memcmp(trailer + 20, kTrailerTag, sizeof(kTrailerTag)) != 0) {
+        *error = path + " is not a transcript archive";
+        return false;
+    }
+
+    uint64_t offset = Get64(trailer + 8);
+    uint32_t frame_size = Get32(trailer + 16);
+    if (frame_size < kIndexHeaderBytes || offset + frame_size != size - kTrailerBytes) {
+        *error = "transcript archive " + path + " is corrupt";
+        return false;
+    }
+    std::vector<uint8_t> frame(frame_size);
+    if (!ReadAt(fd, offset, frame.data(), frame.size())) {
+        *error = IoError("read", path);
+        return false;
+    }
+    uint32_t count = Get32(frame.data() + 16);
+    if (Get32(frame.data()) != kIndexMagic || Get32(frame.data() + 4) != frame_size - 8 ||
+        std::memcmp(frame.data() + 8, kIndexTag, sizeof(kIndexTag)) != 0 ||
+        Get32(frame.data() + 12) != kFormatVersion ||
+        frame_size != kIndexHeaderBytes + static_cast<uint64_t>(count) * kEntryBytes) {
+        *error = "transcript archive " + path + " is corrupt";
+        return false;
+    }
+
+    index->blocks.resize(count);
+    index->index_offset = offset;
+    uint64_t expected_offset = 0;
+    uint64_t expected_line = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        const uint8_t* p = frame.data() + kIndexHeaderBytes + static_cast<size_t>(i) * kEntryBytes;
+        TranscriptBlock& block = index->blocks[i];
+        block.offset = Get64(p);
+        block.compressed_size = Get32(p + 8);
+        block.size = Get32(p + 12);
+        block.first_line = Get64(p + 16);
+        block.lines = Get32(p + 24);
+        block.messages = Get32(p + 28);
+        block.first_ms = static_cast<int64_t>(Get64(p + 32));
+        block.last_ms = static_cast<int64_t>(Get64(p + 40));
+        // Blocks tile the data region and number lines without gaps
+        if (block.offset != expected_offset || block.first_line != expected_line ||
+            block.messages > block.lines) {
+            *error = "transcript archive " + path + " is corrupt";
+            return false;
+        }
+        expected_offset += block.compressed_size;
+        expected_line += block.lines;
+    }
+    if (expected_offset != offset) {
+        *error = "transcript archive " + path + " is corrupt";
+        return false;
+    }
+    return true;
+}
+
+// ---- Writing ----
+
+bool IsBlank(const uint8_t* line, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if (line[i] != ' ' && line[i] != '\t' && line[i] != '\r') {
+            return false;
+        }
+    }
+    return true;
+}
+
+class ArchiveWriter {
+public:
+    ArchiveWriter(int fd, const std::string& path, const TranscriptArchiveOptions& options, ArchiveIndex index)
+        : fd_(fd), path_(path), options_(options), context_(options.level, true, nullptr),
+          blocks_(std::move(index.blocks)), position_(index.index_offset) {
+        if (!blocks_.empty()) {
+            next_line_ = blocks_.back().first_line + blocks_.back().lines;
+        }
+        pending_.reserve(options_.block_size + 4096);
+    }
+
+    bool AddLine(const uint8_t* line, size_t len, std::string* error) {
+        if (IsBlank(line, len)) {
+            return true;
+        }
+        if (!pending_.empty() && pending_.size() + len + 1 > options_.block_size && !FlushBlock(error)) {
+            return false;
+        }
+        if (pending_.empty()) {
+            current_ = TranscriptBlock();
+            current_.first_line = next_line_;
+            current_.first_ms = kNoTimestamp;
+            current_.last_ms = kNoTimestamp;
+        }
+        pending_.insert(pending_.end(), line, line + len);
+        pending_.push_back('\n');
+        current_.lines++;
+        next_line_++;
+        if (ScanTranscriptLine(line, len, 0, scan_options_, &entry_)) {
+            current_.messages++;
+            int64_t ms;
+            if (Timestamp(entry_, &ms)) {
+                if (current_.first_ms == kNoTimestamp) {
+                    current_.first_ms = ms;
+                }
+                current_.last_ms = ms;
+            }
+        }
+        return true;
+    }
+
+    // Final block, index and trailer
+    bool Finish(std::string* error) {
+        if (!pending_.empty() && !FlushBlock(error)) {
+            return false;
+        }
+        std::vector<uint8_t> tail;
+        uint32_t frame_size = static_cast<uint32_t>(kIndexHeaderBytes + blocks_.size() * kEntryBytes);
+        Put32(&tail, kIndexMagic);
+        Put32(&tail, frame_size - 8);
+        tail.insert(tail.end(), kIndexTag, kIndexTag + sizeof(kIndexTag));
+        Put32(&tail, kFormatVersion);
+        Put32(&tail, static_cast<uint32_t>(blocks_.size()));
+        for (const TranscriptBlock& block : blocks_) {
+            Put64(&tail, block.offset);
+            Put32(&tail, block.compressed_size);
+            Put32(&tail, block.size);
+            Put64(&tail, block.first_line);
+            Put32(&tail, block.lines);
+            Put32(&tail, block.messages);
+            Put64(&tail, static_cast<uint64_t>(block.first_ms));
+            Put64(&tail, static_cast<uint64_t>(block.last_ms));
+        }
+        Put32(&tail, kTrailerMagic);
+        Put32(&tail, 16);
+        Put64(&tail, position_);
+        Put32(&tail, frame_size);
+        tail.insert(tail.end(), kTrailerTag, kTrailerTag + sizeof(kTrailerTag));
+        if (!WriteAll(fd_, tail.data(), tail.size())) {
+            *error = IoError("write", path_);
+            return false;
+        }
+        bytes_ = position_ + tail.size();
+        return true;
+    }
+
+    const std::vector<TranscriptBlock>& blocks() const { return blocks_; }
+    uint64_t bytes() const { return bytes_; }
+
+private:
+    static bool Timestamp(const TranscriptEntry& entry, int64_t* ms) {
+        if (entry.timestamp_kind == TranscriptEntry::Timestamp::kString) {
+            return ParseIsoTimestamp(entry.timestamp.data(), entry.timestamp.size(), ms);
+        }
+        if (entry.timestamp_kind == TranscriptEntry::Timestamp::kNumber) {
+            double value = std::strtod(entry.timestamp.c_str(), nullptr);
+            if (value > -9.2e18 && value < 9.2e18) {
+                *ms = static_cast<int64_t>(value);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool FlushBlock(std::string* error) {
+        frame_.clear();
+        if (!context_.Compress(pending_.data(), pending_.size(), &frame_, error)) {
+            return false;
+        }
+        if (!WriteAll(fd_, frame_.data(), frame_.size())) {
+            *error = IoError("write", path_);
+            return false;
+        }
+        current_.offset = position_;
+        current_.compressed_size = static_cast<uint32_t>(frame_.size());
+        current_.size = static_cast<uint32_t>(pending_.size());
+        blocks_.push_back(current_);
+        position_ += frame_.size();
+        pending_.clear();
+        return true;
+    }
+
+    int fd_;
+    const std::string& path_;
+    TranscriptArchiveOptions options_;
+    ZstdCompressContext context_;
+    std::vector<TranscriptBlock> blocks_;
+    uint64_t position_;
+    uint64_t next_line_ = 0;
+    uint64_t bytes_ = 0;
+    TranscriptBlock current_;
+    std::vector<uint8_t> pending_;
+    std::vector<uint8_t> frame_;
+    TranscriptScanOptions scan_options_;
+    TranscriptEntry entry_;
+};
+
+// Feeds every line of the file at `source` to the writer
+bool CopyLines(const std::string& source, ArchiveWriter* writer, std::string* error) {
+    int fd = ::open(source.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        *error = IoError("open", source);
+        return false;
+    }
+#if defined(POSIX_FADV_SEQUENTIAL)
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    // buffer holds an unfinished line plus what was read after it
+    std::vector<uint8_t> buffer;
+    uint64_t position = 0;
+    for (;;) {
+        size_t kept = buffer.size();
+        buffer.resize(kept + kReadChunkBytes);
+        ssize_t n = ::pread(fd, buffer.data() + kept, kReadChunkBytes, static_cast<off_t>(position));
+        if (n < 0 && errno == EINTR) {
+            buffer.resize(kept);
+            continue;
+        }
+        if (n < 0) {
+            *error = IoError("read", source);
+            ::close(fd);
+            return false;
+        }
+        buffer.resize(kept + static_cast<size_t>(n));
+        position += static_cast<uint64_t>(n);
+
+        size_t line = 0;
+        for (;;) {
+            const void* nl = std::memchr(buffer.data() + line, '\n', buffer.size() - line);
+            if (nl == nullptr) {
+                break;
+            }
+            size_t end = static_cast<size_t>(static_cast<const uint8_t*>(nl) - buffer.data());
+            if (!writer->AddLine(buffer.data() + line, end - line, error)) {
+                ::close(fd);
+                return false;
+            }
+            line = end + 1;
+        }
+        buffer.erase(buffer.begin(), buffer.begin() + static_cast<ptrdiff_t>(line));
+        if (n == 0) {
+            break;
+        }
+    }
+    ::close(fd);
+    return buffer.empty() || writer->AddLine(buffer.data(), buffer.size(), error);
+}
+
+// Days since 1970-01-01 for a proleptic Gregorian date (Howard Hinnant's
+// days_from_civil)
+int64_t DaysFromCivil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    unsigned yoe = static_cast<unsigned>(y - era * 400);
+    unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+}  // namespace
+
+bool ParseIsoTimestamp(const char* s, size_t len, int64_t* ms) {
+    size_t i = 0;
+    auto digits = [&](size_t count, int* out) {
+        if (i + count > len) {
+            return false;
+        }
+        int value = 0;
+        for (size_t k = 0; k < count; k++) {
+            char c = s[i + k];
+            if (c < '0' || c > '9') {
+                return false;
+            }
+            value = value * 10 + (c - '0');
+        }
+        i += count;
+        *out = value;
+        return true;
+    };
+    auto expect = [&](char c) {
+        if (i < len && s[i] == c) {
+            i++;
+            return true;
+        }
+        return false;
+    };
+
+    int year, month, day, hour, minute, second;
+    if (!digits(4, &year) || !expect('-') || !digits(2, &month) || !expect('-') || !digits(2, &day) ||
+        !(expect('T') || expect(' ')) || !digits(2, &hour) || !expect(':') || !digits(2, &minute) ||
+        !expect(':') || !digits(2, &second)) {
+        return false;
+    }
+    if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60) {
+        return false;
+    }
+    int millis = 0;
+    if (expect('.')) {
+        // Fractions beyond milliseconds are truncated
+        int scale = 100;
+        size_t start = i;
+        while (i < len && s[i] >= '0' && s[i] <= '9') {
+            millis += (s[i] - '0') * scale;
+            scale /= 10;
+            i++;
+        }
+        if (i == start) {
+            return false;
+        }
+    }
+    int offset_minutes = 0;
+    if (!expect('Z')) {
+        bool negative = i < len && s[i] == '-';
+        if (!expect('+') && !expect('-')) {
+            return false;
+        }
+        int oh, om;
+        if (!digits(2, &oh)) {
+            return false;
+        }
+        expect(':');  // +hh:mm or +hhmm
+        if (!digits(2, &om) || oh > 23 || om > 59) {
+            return false;
+        }
+        offset_minutes = (negative ? -1 : 1) * (oh * 60 + om);
+    }
+    if (i != len) {
+        return false;
+    }
+
+    int64_t days = DaysFromCivil(year, static_cast<unsigned>(month), static_cast<unsigned>(day));
+    int64_t seconds = days * 86400 + hour * 3600 + minute * 60 + second - offset_minutes * 60;
+    *ms = seconds * 1000 + millis;
+    return true;
+}
+
+TranscriptPackResult PackTranscript(const std::string& source, const std::string& dest,
+                                    const TranscriptArchiveOptions& options) {
+    TranscriptPackResult result;
+    ArchiveIndex index;
+    std::string target = dest;
+    int fd;
+    if (options.append && ::access(dest.c_str(), F_OK) == 0) {
+        fd = ::open(dest.c_str(), O_RDWR | O_CLOEXEC);
+        if (fd < 0) {
+            result.error = IoError("open", dest);
+            return result;
+        }
+        // New blocks overwrite the old index and trailer
+        if (!ReadIndex(fd, dest, &index, &result.error)) {
+            ::close(fd);
+            return result;
+        }
+        if (::ftruncate(fd, static_cast<off_t>(index.index_offset)) != 0 ||
+            ::lseek(fd, static_cast<off_t>(index.index_offset), SEEK_SET) < 0) {
+            result.error = IoError("truncate", dest);
+            ::close(fd);
+            return result;
+        }
+    } else {
+        target = dest + ".tmp";
+        fd = ::open(target.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            result.error = IoError("open", target);
+            return result;
+        }
+    }
+
+    ArchiveWriter writer(fd, target, options, std::move(index));
+    bool ok = CopyLines(source, &writer, &result.error) && writer.Finish(&result.error);
+    if (ok && ::fsync(fd) != 0) {
+        result.error = IoError("fsync", target);
+        ok = false;
+    }
+    ::close(fd);
+    if (target != dest) {
+        if (ok && ::rename(target.c_str(), dest.c_str()) != 0) {
+            result.error = IoError("rename", dest);
+            ok = false;
+        }
+        if (!ok) {
+            ::unlink(target.c_str());
+        }
+    }
+    // A failed append leaves dest without an index; it has to be rebuilt
+    if (!ok) {
+        return result;
+    }
+
+    for (const TranscriptBlock& block : writer.blocks()) {
+        result.lines += block.lines;
+        result.messages += block.messages;
+    }
+    result.blocks = writer.blocks().size();
+    result.bytes = writer.bytes();
+    return result;
+}
+
+TranscriptSlice QueryTranscriptArchive(const std::string& path, const TranscriptQuery& query) {
+    TranscriptSlice slice;
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        slice.error = IoError("open", path);
+        return slice;
+    }
+    ArchiveIndex index;
+    if (!ReadIndex(fd, path, &index, &slice.error)) {
+        ::close(fd);
+        return slice;
+    }
+    const std::vector<TranscriptBlock>& blocks = index.blocks;
+    for (const TranscriptBlock& block : blocks) {
+        slice.total_lines += block.lines;
+        slice.total_messages += block.messages;
+    }
+
+    // First block to read, and the first line of it to return
+    size_t first = 0;
+    uint64_t from_line = 0;
+    if (query.last_messages > 0) {
+        first = blocks.size();
+        uint64_t messages = 0;
+        while (first > 0 && messages < query.last_messages) {
+            messages += blocks[--first].messages;
+        }
+    } else if (query.after_line >= 0) {
+        from_line = static_cast<uint64_t>(query.after_line) + 1;
+        auto after = std::upper_bound(blocks.begin(), blocks.end(), from_line,
+                                      [](uint64_t line, const TranscriptBlock& block) {
+                                          return line < block.first_line;
+                                      });
+        first = after == blocks.begin() ? 0 : static_cast<size_t>(after - blocks.begin()) - 1;
+        if (from_line >= slice.total_lines) {
+            first = blocks.size();
+        }
+    } else if (query.after_ms != kNoTimestamp) {
+        first = blocks.size();
+        for (size_t i = 0; i < blocks.size(); i++) {
+            if (blocks[i].last_ms != kNoTimestamp && blocks[i].last_ms > query.after_ms) {
+                first = i;
+                break;
+            }
+        }
+    }
+    if (first < blocks.size()) {
+        from_line = std::max(from_line, blocks[first].first_line);
+    } else {
+        from_line = slice.total_lines;
+    }
+    slice.first_line = from_line;
+
+    ZstdDecompressContext context(0, nullptr);
+    std::vector<uint8_t> frame;
+    std::vector<uint8_t> text;
+    for (size_t i = first; i < blocks.size(); i++) {
+        if (query.limit != 0 && slice.lines.size() >= query.limit) {
+            break;
+        }
+        const TranscriptBlock& block = blocks[i];
+        frame.resize(block.compressed_size);
+        if (!ReadAt(fd, block.offset, frame.data(), frame.size())) {
+            slice.error = IoError("read", path);
+            break;
+        }
+        text.clear();
+        text.reserve(block.size);
+        // A damaged frame is not allowed to expand past its indexed size
+        if (!context.Decompress(frame.data(), frame.size(), &text, &slice.error, block.size)) {
+            slice.error = "transcript archive " + path + ": " + slice.error;
+            break;
+        }
+        if (text.size() != block.size) {
+            slice.error = "transcript archive " + path + " is corrupt";
+            break;
+        }
+        slice.blocks_read++;
+
+        size_t line = 0;
+        uint64_t number = block.first_line;
+        while (line < text.size() && (query.limit == 0 || slice.lines.size() < query.limit)) {
+            const void* nl = std::memchr(text.data() + line, '\n', text.size() - line);
+            size_t end = nl ? static_cast<size_t>(static_cast<const uint8_t*>(nl) - text.data()) : text.size();
+            if (number >= from_line) {
+                slice.lines.emplace_back(reinterpret_cast<const char*>(text.data() + line), end - line);
+            }
+            line = end + 1;
+            number++;
+        }
+        if (number > block.first_line + block.lines ||
+            (line >= text.size() && number != block.first_line + block.lines)) {
+            slice.error = "transcript archive " + path + " is corrupt";
+            break;
+        }
+    }
+    ::close(fd);
+    if (!slice.error.empty()) {
+        slice.lines.clear();
+    }
+    return slice;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "zstd-stream.h"
+
+// Block-compressed, seekable container for JSONL session transcripts.
+// N-API free; built with zstd (OPENCLAW_HAVE_ZSTD).
+//
+// Layout, all integers little-endian:
+//
+//   block*   independent zstd frames, each holding whole lines ("\n"
+//            terminated) of about block_size bytes
+//   index    zstd skippable frame: "OCTI", version, block count, then one
+//            TranscriptBlock per block
+//   trailer  zstd skippable frame of fixed size at EOF: index offset,
+//            index frame size, "OCTA"
+//
+// Skippable frames are ignored by every zstd decoder, so `zstd -dc` on an
+// archive prints the original JSONL. Readers find the index through the
+// trailer and decompress only the blocks a query touches. Appending
+// truncates the old index and trailer, adds blocks, and writes new ones.
+
+struct TranscriptBlock {
+    uint64_t offset = 0;           // of the block's frame in the file
+    uint32_t compressed_size = 0;
+    uint32_t size = 0;             // decompressed bytes
+    uint64_t first_line = 0;       // 0-based line number of its first line
+    uint32_t lines = 0;
+    uint32_t messages = 0;         // { type: "message" } records
+    // Message timestamps as Unix ms; kNoTimestamp for a block without any
+    int64_t first_ms = 0;
+    int64_t last_ms = 0;
+};
+
+static constexpr int64_t kNoTimestamp = INT64_MIN;
+static constexpr size_t kTranscriptBlockBytes = 64 * 1024;
+
+struct TranscriptArchiveOptions {
+    size_t block_size = kTranscriptBlockBytes;
+    int level = 3;
+    bool append = false;  // add to an existing archive instead of replacing it
+};
+
+struct TranscriptPackResult {
+    uint64_t lines = 0;      // whole archive, after packing
+    uint64_t messages = 0;
+    uint64_t blocks = 0;
+    uint64_t bytes = 0;      // archive size
+    std::string error;
+};
+
+// Writes the lines of the JSONL file at `source` into the archive at `dest`.
+// A new archive goes to dest + ".tmp" and is renamed over dest when
+// complete; an append rewrites only dest's index and trailer. Blank lines
+// are dropped, and a final line without "\n" is stored with one.
+TranscriptPackResult PackTranscript(const std::string& source, const std::string& dest,
+                                    const TranscriptArchiveOptions& options);
+
+// Which lines to read. Only one selector applies, in this order:
+// last_messages, then after_line, then after_ms; with none, every line.
+struct TranscriptQuery {
+    // The blocks holding the last N messages (N > 0)
+    uint32_t last_messages = 0;
+    // Lines numbered above this one (ignored when negative)
+    int64_t after_line = -1;
+    // Lines from the first block with a message newer than this (Unix ms)
+    int64_t after_ms = kNoTimestamp;
+    // Stop after this many lines (0 = no limit)
+    uint64_t limit = 0;
+};
+
+struct TranscriptSlice {
+    std::vector<std::string> lines;  // without their "\n"
+    uint64_t first_line = 0;         // number of lines[0]
+    uint64_t total_lines = 0;
+    uint64_t total_messages = 0;
+    uint64_t blocks_read = 0;
+    std::string error;
+};
+
+// Whole blocks are returned, so lines may start before the selected one;
+// callers trim using first_line. Sets error instead of throwing.
+TranscriptSlice QueryTranscriptArchive(const std::string& path, const TranscriptQuery& query);
+
+// Unix ms for an ISO 8601 timestamp ("2026-01-02T03:04:05.678Z" or with a
+// +hh:mm offset); false for anything else
+bool ParseIsoTimestamp(const char* s, size_t len, int64_t* ms);
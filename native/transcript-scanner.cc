@@ -0,0 +1,748 @@
+#include "transcript-scanner.h"
+#include "cpu-features.h"
+#include "file-hash.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(HAS_X86_SIMD)
+  #include <immintrin.h>
+#elif defined(HAS_ARM_SIMD)
+  #include <arm_neon.h>
+#endif
+
+static constexpr size_t kReadChunkBytes = 1024 * 1024;
+// Bytes before the resume offset that must be unchanged for a resume
+static constexpr size_t kAnchorBytes = 4096;
+
+// Count of leading bytes in data[0, len) that a JSON string body takes
+// verbatim: everything except '"', '\\' and control characters.
+using StringRunFn = size_t (*)(const uint8_t* data, size_t len);
+
+static inline bool IsStringStop(uint8_t c) {
+    return c == '"' || c == '\\' || c < 0x20;
+}
+
+static size_t StringRunScalar(const uint8_t* data, size_t len) {
+    size_t i = 0;
+    while (i < len && !IsStringStop(data[i])) {
+        i++;
+    }
+    return i;
+}
+
+#if defined(HAS_X86_DISPATCH)
+
+OPENCLAW_TARGET("sse2")
+static size_t StringRunSse2(const uint8_t* data, size_t len) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control = _mm_set1_epi8(0x1f);
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        // Unsigned v <= 0x1f exactly when min(v, 0x1f) == v
+        __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+                                   _mm_cmpeq_epi8(_mm_min_epu8(v, control), v));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hit));
+        if (mask != 0) {
+            return i + static_cast<size_t>(__builtin_ctz(mask));
+        }
+    }
+    return i + StringRunScalar(data + i, len - i);
+}
+
+OPENCLAW_TARGET("avx2")
+static size_t StringRunAvx2(const uint8_t* data, size_t len) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i control = _mm256_set1_epi8(0x1f);
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i hit = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, backslash)),
+            _mm256_cmpeq_epi8(_mm256_min_epu8(v, control), v));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hit));
+        if (mask != 0) {
+            return i + static_cast<size_t>(__builtin_ctz(mask));
+        }
+    }
+    return i + StringRunSse2(data + i, len - i);
+}
+
+OPENCLAW_TARGET("avx512f,avx512bw")
+static size_t StringRunAvx512(const uint8_t* data, size_t len) {
+    const __m512i quote = _mm512_set1_epi8('"');
+    const __m512i backslash = _mm512_set1_epi8('\\');
+    const __m512i space = _mm512_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        __m512i v = _mm512_loadu_si512(data + i);
+        uint64_t mask = _mm512_cmpeq_epi8_mask(v, quote) | _mm512_cmpeq_epi8_mask(v, backslash) |
+                        _mm512_cmplt_epu8_mask(v, space);
+        if (mask != 0) {
+            return i + static_cast<size_t>(__builtin_ctzll(mask));
+        }
+    }
+    return i + StringRunAvx2(data + i, len - i);
+}
+
+#endif  // HAS_X86_DISPATCH
+
+#if defined(HAS_ARM_SIMD)
+
+static size_t StringRunNeon(const uint8_t* data, size_t len) {
+    const uint8x16_t quote = vdupq_n_u8('"');
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+    const uint8x16_t space = vdupq_n_u8(0x20);
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        uint8x16_t v = vld1q_u8(data + i);
+        uint8x16_t hit = vorrq_u8(vorrq_u8(vceqq_u8(v, quote), vceqq_u8(v, backslash)), vcltq_u8(v, space));
+        // Narrow to a 64-bit mask with one nibble per byte lane
+        uint64_t mask = vget_lane_u64(
+            vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(hit), 4)), 0);
+        if (mask != 0) {
+            return i + (static_cast<size_t>(__builtin_ctzll(mask)) >> 2);
+        }
+    }
+    return i + StringRunScalar(data + i, len - i);
+}
+
+#endif  // HAS_ARM_SIMD
+
+static StringRunFn string_run_impl = StringRunScalar;
+
+static void SelectStringRun() {
+#if defined(HAS_X86_DISPATCH)
+    const CpuFeatures& cpu = GetCpuFeatures();
+    if (cpu.avx512bw) {
+        string_run_impl = StringRunAvx512;
+    } else if (cpu.avx2) {
+        string_run_impl = StringRunAvx2;
+    } else if (cpu.sse2) {
+        string_run_impl = StringRunSse2;
+    }
+#elif defined(HAS_ARM_SIMD)
+    string_run_impl = StringRunNeon;
+#endif
+}
+
+void InitTranscriptScanner() {
+    static std::once_flag once;
+    std::call_once(once, SelectStringRun);
+}
+
+// ---------------------------------------------------------------------------
+// Line parser
+// ---------------------------------------------------------------------------
+
+static int HexValue(uint8_t c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Four hex digits at p (caller checked the length), or -1
+static int32_t Hex4(const uint8_t* p) {
+    int32_t unit = 0;
+    for (int i = 0; i < 4; i++) {
+        int digit = HexValue(p[i]);
+        if (digit < 0) {
+            return -1;
+        }
+        unit = (unit << 4) | digit;
+    }
+    return unit;
+}
+
+// UTF-8 for cp; a lone surrogate comes out as its 3-byte WTF-8 form
+static void AppendCodePoint(std::string* out, uint32_t cp) {
+    if (cp < 0x80) {
+        out->push_back(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+        out->push_back(static_cast<char>(0xc0 | (cp >> 6)));
+        out->push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+    } else if (cp < 0x10000) {
+        out->push_back(static_cast<char>(0xe0 | (cp >> 12)));
+        out->push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3f)));
+        out->push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+    } else {
+        out->push_back(static_cast<char>(0xf0 | (cp >> 18)));
+        out->push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3f)));
+        out->push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3f)));
+        out->push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+    }
+}
+
+namespace {
+
+// One decoded string of the record; lone marks an unpaired surrogate escape
+struct Captured {
+    std::string value;
+    bool lone = false;
+};
+
+struct MessageFields {
+    bool has_role = false;
+    Captured role;
+    std::vector<Captured> texts;
+};
+
+// Recursive descent over selected members; everything else goes through the
+// iterative SkipValue(), so deeply nested tool payloads cannot overflow the
+// stack. The grammar is RFC 8259, the same one JSON.parse() accepts.
+class LineParser {
+public:
+    LineParser(const uint8_t* begin, const uint8_t* end) : p_(begin), end_(end) {}
+
+    bool ParseRecord(TranscriptEntry* out);
+
+private:
+    const uint8_t* p_;
+    const uint8_t* end_;
+    std::vector<uint8_t> stack_;
+
+    void SkipWs() {
+        while (p_ < end_ && (*p_ == ' ' || *p_ == '\t' || *p_ == '\r' || *p_ == '\n')) {
+            p_++;
+        }
+    }
+
+    bool Peek(uint8_t c) {
+        SkipWs();
+        return p_ < end_ && *p_ == c;
+    }
+
+    bool Consume(uint8_t c) {
+        if (!Peek(c)) {
+            return false;
+        }
+        p_++;
+        return true;
+    }
+
+    bool String(std::string* out, bool* lone);
+    bool SkipString() { return String(nullptr, nullptr); }
+    bool Capture(Captured* out) { return String(&out->value, &out->lone); }
+    bool Number();
+    bool Literal(const char* word, size_t len);
+    bool SkipValue();
+
+    // Decodes a string value into out when there is one; any other value is
+    // skipped and is_string cleared
+    bool StringOrSkip(Captured* out, bool* is_string) {
+        *is_string = *p_ == '"';
+        if (!*is_string) {
+            return SkipValue();
+        }
+        *out = Captured();
+        return Capture(out);
+    }
+
+    // Calls member(key) for each member of the object at p_, with p_ on the
+    // value; member must consume it. Later duplicates overwrite, as in JS.
+    template <typename Member>
+    bool Object(Member&& member) {
+        p_++;
+        if (Consume('}')) {
+            return true;
+        }
+        std::string key;
+        for (;;) {
+            key.clear();
+            if (!Peek('"') || !String(&key, nullptr) || !Consume(':')) {
+                return false;
+            }
+            SkipWs();
+            if (p_ >= end_ || !member(key)) {
+                return false;
+            }
+            if (Consume(',')) {
+                continue;
+            }
+            return Consume('}');
+        }
+    }
+
+    template <typename Element>
+    bool Array(Element&& element) {
+        p_++;
+        if (Consume(']')) {
+            return true;
+        }
+        for (;;) {
+            SkipWs();
+            if (p_ >= end_ || !element()) {
+                return false;
+            }
+            if (Consume(',')) {
+                continue;
+            }
+            return Consume(']');
+        }
+    }
+
+    bool Message(MessageFields* out);
+    bool Content(MessageFields* out);
+    bool TextBlock(MessageFields* out);
+};
+
+// p_ is on the opening quote. Appends the decoded value to out when given.
+bool LineParser::String(std::string* out, bool* lone) {
+    p_++;
+    for (;;) {
+        size_t run = string_run_impl(p_, static_cast<size_t>(end_ - p_));
+        if (out != nullptr && run > 0) {
+            out->append(reinterpret_cast<const char*>(p_), run);
+        }
+        p_ += run;
+        if (p_ >= end_) {
+            return false;
+        }
+        uint8_t c = *p_++;
+        if (c == '"') {
+            return true;
+        }
+        if (c != '\\' || p_ >= end_) {
+            return false;  // raw control character, or a truncated escape
+        }
+
+        c = *p_++;
+        char simple;
+        switch (c) {
+            case '"': simple = '"'; break;
+            case '\\': simple = '\\'; break;
+            case '/': simple = '/'; break;
+            case 'b': simple = '\b'; break;
+            case 'f': simple = '\f'; break;
+            case 'n': simple = '\n'; break;
+            case 'r': simple = '\r'; break;
+            case 't': simple = '\t'; break;
+            case 'u': {
+                if (end_ - p_ < 4) {
+                    return false;
+                }
+                int32_t unit = Hex4(p_);
+                if (unit < 0) {
+                    return false;
+                }
+                p_ += 4;
+                uint32_t cp = static_cast<uint32_t>(unit);
+                if (cp >= 0xd800 && cp <= 0xdbff && end_ - p_ >= 6 && p_[0] == '\\' && p_[1] == 'u') {
+                    int32_t low = Hex4(p_ + 2);
+                    if (low >= 0xdc00 && low <= 0xdfff) {
+                        cp = 0x10000 + ((cp - 0xd800) << 10) + (static_cast<uint32_t>(low) - 0xdc00);
+                        p_ += 6;
+                    }
+                }
+                if (cp >= 0xd800 && cp <= 0xdfff && lone != nullptr) {
+                    *lone = true;
+                }
+                if (out != nullptr) {
+                    AppendCodePoint(out, cp);
+                }
+                continue;
+            }
+            default:
+                return false;
+        }
+        if (out != nullptr) {
+            out->push_back(simple);
+        }
+    }
+}
+
+bool LineParser::Number() {
+    const uint8_t* p = p_;
+    auto digits = [&]() {
+        const uint8_t* first = p;
+        while (p < end_ && *p >= '0' && *p <= '9') {
+            p++;
+        }
+        return p > first;
+    };
+    if (p < end_ && *p == '-') {
+        p++;
+    }
+    if (p < end_ && *p == '0') {
+        p++;
+    } else if (p >= end_ || *p < '1' || *p > '9' || !digits()) {
+        return false;
+    }
+    if (p < end_ && *p == '.') {
+        p++;
+        if (!digits()) {
+            return false;
+        }
+    }
+    if (p < end_ && (*p == 'e' || *p == 'E')) {
+        p++;
+        if (p < end_ && (*p == '+' || *p == '-')) {
+            p++;
+        }
+        if (!digits()) {
+            return false;
+        }
+    }
+    p_ = p;
+    return true;
+}
+
+bool LineParser::Literal(const char* word, size_t len) {
+    if (static_cast<size_t>(end_ - p_) < len || std::memcmp(p_, word, len) != 0) {
+        return false;
+    }
+    p_ += len;
+    return true;
+}
+
+// Skips one value of any depth, tracking open containers in stack_
+bool LineParser::SkipValue() {
+    stack_.clear();
+    for (;;) {
+        SkipWs();
+        if (p_ >= end_) {
+            return false;
+        }
+        bool ok;
+        switch (*p_) {
+            case '{':
+                p_++;
+                if (Consume('}')) {
+                    ok = true;
+                    break;
+                }
+                if (!Peek('"') || !SkipString() || !Consume(':')) {
+                    return false;
+                }
+                stack_.push_back('}');
+                continue;
+            case '[':
+                p_++;
+                if (Consume(']')) {
+                    ok = true;
+                    break;
+                }
+                stack_.push_back(']');
+                continue;
+            case '"': ok = SkipString(); break;
+            case 't': ok = Literal("true", 4); break;
+            case 'f': ok = Literal("false", 5); break;
+            case 'n': ok = Literal("null", 4); break;
+            default: ok = Number(); break;
+        }
+        if (!ok) {
+            return false;
+        }
+
+        // A value ended: close finished containers, then step to the next one
+        for (;;) {
+            if (stack_.empty()) {
+                return true;
+            }
+            SkipWs();
+            if (p_ >= end_) {
+                return false;
+            }
+            uint8_t close = stack_.back();
+            if (*p_ == close) {
+                p_++;
+                stack_.pop_back();
+                continue;
+            }
+            if (*p_ != ',') {
+                return false;
+            }
+            p_++;
+            if (close == '}' && (!Peek('"') || !SkipString() || !Consume(':'))) {
+                return false;
+            }
+            break;
+        }
+    }
+}
+
+// { type: "text", text: string } contributes its text; other blocks nothing
+bool LineParser::TextBlock(MessageFields* out) {
+    if (*p_ != '{') {
+        return SkipValue();
+    }
+    bool is_text = false;
+    bool has_text = false;
+    Captured text;
+    bool ok = Object([&](const std::string& key) {
+        if (key == "type") {
+            Captured type;
+            bool is_string;
+            if (!StringOrSkip(&type, &is_string)) {
+                return false;
+            }
+            is_text = is_string && type.value == "text";
+            return true;
+        }
+        if (key == "text") {
+            return StringOrSkip(&text, &has_text);
+        }
+        return SkipValue();
+    });
+    if (ok && is_text && has_text) {
+        out->texts.push_back(std::move(text));
+    }
+    return ok;
+}
+
+bool LineParser::Content(MessageFields* out) {
+    out->texts.clear();
+    if (*p_ == '"') {
+        out->texts.emplace_back();
+        return Capture(&out->texts.back());
+    }
+    if (*p_ == '[') {
+        return Array([&]() { return TextBlock(out); });
+    }
+    return SkipValue();
+}
+
+bool LineParser::Message(MessageFields* out) {
+    return Object([&](const std::string& key) {
+        if (key == "role") {
+            return StringOrSkip(&out->role, &out->has_role);
+        }
+        if (key == "content") {
+            return Content(out);
+        }
+        return SkipValue();
+    });
+}
+
+bool LineParser::ParseRecord(TranscriptEntry* out) {
+    SkipWs();
+    if (p_ >= end_ || *p_ != '{') {
+        return false;  // unparseable, or a value without .type === "message"
+    }
+
+    bool is_message = false;
+    bool has_message = false;
+    MessageFields message;
+    bool has_timestamp = false;
+    bool timestamp_lone = false;
+    bool ok = Object([&](const std::string& key) {
+        if (key == "type") {
+            Captured type;
+            bool is_string;
+            if (!StringOrSkip(&type, &is_string)) {
+                return false;
+            }
+            is_message = is_string && type.value == "message";
+            return true;
+        }
+        if (key == "message") {
+            message = MessageFields();
+            has_message = *p_ == '{';
+            return has_message ? Message(&message) : SkipValue();
+        }
+        if (key == "timestamp") {
+            const uint8_t* value = p_;
+            out->timestamp.clear();
+            timestamp_lone = false;
+            if (*p_ == '"') {
+                has_timestamp = true;
+                out->timestamp_kind = TranscriptEntry::Timestamp::kString;
+                return String(&out->timestamp, &timestamp_lone);
+            }
+            if (*p_ == '-' || (*p_ >= '0' && *p_ <= '9')) {
+                has_timestamp = true;
+                out->timestamp_kind = TranscriptEntry::Timestamp::kNumber;
+                if (!Number()) {
+                    return false;
+                }
+                out->timestamp.assign(reinterpret_cast<const char*>(value), static_cast<size_t>(p_ - value));
+                return true;
+            }
+            has_timestamp = false;
+            return SkipValue();
+        }
+        return SkipValue();
+    });
+    SkipWs();
+    if (!ok || p_ != end_ || !is_message || !has_message || !message.has_role) {
+        return false;
+    }
+
+    if (!has_timestamp) {
+        out->timestamp_kind = TranscriptEntry::Timestamp::kNone;
+        out->timestamp.clear();
+    }
+    out->needs_reparse = message.role.lone || timestamp_lone;
+    out->role = std::move(message.role.value);
+    out->texts.clear();
+    out->texts.reserve(message.texts.size());
+    for (Captured& text : message.texts) {
+        out->needs_reparse = out->needs_reparse || text.lone;
+        out->texts.push_back(std::move(text.value));
+    }
+    return true;
+}
+
+}  // namespace
+
+bool ScanTranscriptLine(const uint8_t* data, size_t len, uint64_t start,
+                        const TranscriptScanOptions& options, TranscriptEntry* out) {
+    LineParser parser(data, data + len);
+    if (!parser.ParseRecord(out)) {
+        return false;
+    }
+    // A role holding a lone surrogate cannot equal any requested role
+    if (!options.roles.empty() &&
+        std::find(options.roles.begin(), options.roles.end(), out->role) == options.roles.end()) {
+        return false;
+    }
+    out->start = start;
+    out->end = start + len;
+    out->raw.clear();
+    if (out->needs_reparse) {
+        out->raw.assign(reinterpret_cast<const char*>(data), len);
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// File scan
+// ---------------------------------------------------------------------------
+
+static void Fail(TranscriptScanResult* result, const char* what, const std::string& path) {
+    result->error = std::string(what) + " " + path + ": " + std::strerror(errno);
+}
+
+// Reads exactly len bytes at offset; false with errno set (0 on a short file)
+static bool ReadAt(int fd, uint64_t offset, uint8_t* out, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::pread(fd, out, len, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            if (n == 0) {
+                errno = 0;
+            }
+            return false;
+        }
+        out += n;
+        offset += static_cast<uint64_t>(n);
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// XXH64 of the bytes just before offset and the offset itself, as hex;
+// empty when they cannot be read
+static std::string AnchorAt(int fd, uint64_t offset) {
+    size_t len = static_cast<size_t>(std::min<uint64_t>(offset, kAnchorBytes));
+    uint8_t bytes[kAnchorBytes];
+    if (!ReadAt(fd, offset - len, bytes, len)) {
+        return std::string();
+    }
+    Xxh64Hasher hasher(offset);
+    hasher.Update(bytes, len);
+    uint64_t h = hasher.Digest();
+
+    static const char kDigits[] = "0123456789abcdef";
+    std::string hex(16, '0');
+    for (int i = 0; i < 16; i++) {
+        hex[i] = kDigits[(h >> (60 - 4 * i)) & 0xf];
+    }
+    return hex;
+}
+
+TranscriptScanResult ScanTranscriptFile(const std::string& path, uint64_t from,
+                                        const std::string& anchor,
+                                        const TranscriptScanOptions& options) {
+    TranscriptScanResult result;
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        Fail(&result, "open", path);
+        return result;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        Fail(&result, "stat", path);
+        ::close(fd);
+        return result;
+    }
+
+    // A rewritten or truncated transcript no longer matches its anchor
+    uint64_t start = 0;
+    if (from > 0 && from <= static_cast<uint64_t>(st.st_size) && !anchor.empty() &&
+        AnchorAt(fd, from) == anchor) {
+        start = from;
+        result.resumed = true;
+    }
+#if defined(POSIX_FADV_SEQUENTIAL)
+    ::posix_fadvise(fd, static_cast<off_t>(start), 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    // buffer holds the unfinished line at file offset `line_start` plus
+    // whatever was read after it; it only outgrows a chunk for giant lines
+    std::vector<uint8_t> buffer;
+    uint64_t line_start = start;
+    uint64_t position = start;
+    TranscriptEntry entry;
+    auto scan = [&](const uint8_t* line, size_t len, uint64_t at) {
+        if (ScanTranscriptLine(line, len, at, options, &entry)) {
+            result.entries.push_back(std::move(entry));
+            entry = TranscriptEntry();
+        }
+    };
+
+    for (;;) {
+        size_t kept = buffer.size();
+        buffer.resize(kept + kReadChunkBytes);
+        ssize_t n = ::pread(fd, buffer.data() + kept, kReadChunkBytes, static_cast<off_t>(position));
+        if (n < 0 && errno == EINTR) {
+            buffer.resize(kept);
+            continue;
+        }
+        if (n < 0) {
+            Fail(&result, "read", path);
+            ::close(fd);
+            return result;
+        }
+        buffer.resize(kept + static_cast<size_t>(n));
+        position += static_cast<uint64_t>(n);
+        if (n == 0) {
+            break;
+        }
+
+        // Only the new bytes can hold the next '\n'
+        const uint8_t* data = buffer.data();
+        size_t done = 0;
+        size_t search = kept;
+        while (const void* hit = std::memchr(data + search, '\n', buffer.size() - search)) {
+            size_t newline = static_cast<size_t>(static_cast<const uint8_t*>(hit) - data);
+            scan(data + done, newline - done, line_start + done);
+            done = newline + 1;
+            search = done;
+        }
+        line_start += done;
+        buffer.erase(buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(done));
+    }
+
+    // The unterminated tail may be a complete record or one still being written
+    result.offset = line_start;
+    result.size = position;
+    if (!buffer.empty()) {
+        scan(buffer.data(), buffer.size(), line_start);
+    }
+    result.anchor = AnchorAt(fd, result.offset);
+    ::close(fd);
+    return result;
+}
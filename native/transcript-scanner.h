@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Selective reader for JSONL session transcripts. N-API free.
+//
+// Each line is validated with the same grammar JSON.parse() accepts, but only
+// { type: "message", timestamp, message: { role, content } } is decoded; all
+// other values are skipped with a SIMD scan over string bodies, which hold
+// nearly all of a transcript's bytes. Lines JSON.parse() would reject, and
+// records that are not messages, produce no entry.
+
+struct TranscriptEntry {
+    // Line byte range in the file, without its '\n'
+    uint64_t start = 0;
+    uint64_t end = 0;
+    std::string role;
+    // content as a string gives one text; as an array, the text of each
+    // { type: "text", text } block in order
+    std::vector<std::string> texts;
+    enum class Timestamp { kNone, kString, kNumber } timestamp_kind = Timestamp::kNone;
+    std::string timestamp;  // decoded string, or the number's JSON token
+    // A selected string holds an unpaired \uD800-\uDFFF escape, which UTF-8
+    // cannot carry; `raw` is the whole line for the caller to JSON.parse
+    bool needs_reparse = false;
+    std::string raw;
+};
+
+struct TranscriptScanOptions {
+    // Only emit messages with one of these roles (empty = any role)
+    std::vector<std::string> roles;
+};
+
+struct TranscriptScanResult {
+    std::vector<TranscriptEntry> entries;
+    // Where the next incremental scan should start: just past the last '\n'.
+    // A final unterminated line is still scanned but lies beyond offset.
+    uint64_t offset = 0;
+    uint64_t size = 0;
+    // False when the requested start was dropped and the file rescanned from 0
+    bool resumed = false;
+    // Fingerprint of the bytes just before offset, to pass back on resume
+    std::string anchor;
+    std::string error;
+};
+
+// Pick the string scan kernel for this host. Idempotent; called from module init.
+void InitTranscriptScanner();
+
+// Scans data[0, len) as one line located at file offset `start`; returns
+// false when the line yields no entry.
+bool ScanTranscriptLine(const uint8_t* data, size_t len, uint64_t start,
+                        const TranscriptScanOptions& options, TranscriptEntry* out);
+
+// Scans the file from `from` when `anchor` matches what a previous scan
+// returned for that offset, else from 0. Sets error instead of throwing.
+TranscriptScanResult ScanTranscriptFile(const std::string& path, uint64_t from,
+                                        const std::string& anchor,
+                                        const TranscriptScanOptions& options);
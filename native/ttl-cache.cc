@@ -0,0 +1,338 @@
+#include <napi.h>
+#include <cmath>
+#include <memory>
+#include <string>
+#include "ttl-store.h"
+
+// Bounded LRU / TTL cache whose entries live in native memory. Values are
+// strings or bytes and come back as the same type (bytes as a Buffer copy).
+class TtlCache : public Napi::ObjectWrap<TtlCache> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    TtlCache(const Napi::CallbackInfo& info);
+
+private:
+    static Napi::FunctionReference constructor;
+
+    Napi::Value Get(const Napi::CallbackInfo& info);
+    Napi::Value Set(const Napi::CallbackInfo& info);
+    Napi::Value Has(const Napi::CallbackInfo& info);
+    Napi::Value Delete(const Napi::CallbackInfo& info);
+
+    // One call for a batch of keys
+    Napi::Value GetMany(const Napi::CallbackInfo& info);
+    Napi::Value SetMany(const Napi::CallbackInfo& info);
+
+    Napi::Value Clear(const Napi::CallbackInfo& info);
+    Napi::Value Len(const Napi::CallbackInfo& info);
+
+    // Hit rate, evictions, expirations and byte counters
+    Napi::Value Stats(const Napi::CallbackInfo& info);
+
+    Napi::Value Capacity(const Napi::CallbackInfo& info);
+    Napi::Value MaxBytes(const Napi::CallbackInfo& info);
+    Napi::Value TtlMs(const Napi::CallbackInfo& info);
+    Napi::Value Attached(const Napi::CallbackInfo& info);
+
+    Napi::Value Read(Napi::Env env, const Napi::Value& key);
+    bool Write(const Napi::Value& key, const Napi::Value& value, int64_t ttl_ms);
+
+    std::shared_ptr<TtlStore> store_;
+    // False when a named cache already existed and this wrapper attached to it
+    bool created_ = true;
+    // Reused for every read; values are copied out under the shard lock
+    std::string scratch_;
+};
+
+Napi::FunctionReference TtlCache::constructor;
+
+Napi::Object TtlCache::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "TtlCache", {
+        InstanceMethod("get", &TtlCache::Get),
+        InstanceMethod("set", &TtlCache::Set),
+        InstanceMethod("has", &TtlCache::Has),
+        InstanceMethod("delete", &TtlCache::Delete),
+        InstanceMethod("getMany", &TtlCache::GetMany),
+        InstanceMethod("setMany", &TtlCache::SetMany),
+        InstanceMethod("clear", &TtlCache::Clear),
+        InstanceMethod("len", &TtlCache::Len),
+        InstanceMethod("stats", &TtlCache::Stats),
+        InstanceAccessor("capacity", &TtlCache::Capacity, nullptr),
+        InstanceAccessor("maxBytes", &TtlCache::MaxBytes, nullptr),
+        InstanceAccessor("ttlMs", &TtlCache::TtlMs, nullptr),
+        InstanceAccessor("attached", &TtlCache::Attached, nullptr),
+    });
+
+    constructor = Napi::Persistent(func);
+    constructor.SuppressDestruct();
+
+    exports.Set("TtlCache", func);
+    return exports;
+}
+
+static bool ReadCount(const Napi::Object& options, const char* name, double min, double* out) {
+    Napi::Value value = options.Get(name);
+    if (value.IsUndefined()) {
+        return true;
+    }
+    if (!value.IsNumber() || !(value.As<Napi::Number>().DoubleValue() >= min)) {
+        return false;
+    }
+    *out = value.As<Napi::Number>().DoubleValue();
+    return true;
+}
+
+// ReadCount() for options that size the store, which must be whole numbers
+static bool ReadInteger(const Napi::Object& options, const char* name, double min, double* out) {
+    return ReadCount(options, name, min, out) && *out == std::floor(*out);
+}
+
+// ttlMs argument: undefined = the cache default, 0 = never expires
+static bool ReadTtl(const Napi::Value& value, int64_t* out) {
+    if (value.IsUndefined()) {
+        *out = TtlStore::kUseDefaultTtl;
+        return true;
+    }
+    if (!value.IsNumber() || !(value.As<Napi::Number>().DoubleValue() >= 0)) {
+        return false;
+    }
+    *out = value.As<Napi::Number>().Int64Value();
+    return true;
+}
+
+// new TtlCache({ capacity, maxBytes?, ttlMs?, shards?, name? })
+//
+// With a name, every TtlCache constructed under that name in this process
+// (any worker thread) shares one store. Joining it with different limits
+// throws; shards may be left out to take the existing count.
+TtlCache::TtlCache(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<TtlCache>(info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Expected ({ capacity, maxBytes?, ttlMs?, shards?, name? })")
+            .ThrowAsJavaScriptException();
+        return;
+    }
+    Napi::Object options = info[0].As<Napi::Object>();
+
+    TtlStoreParams params;
+    double capacity = static_cast<double>(params.capacity);
+    double max_bytes = static_cast<double>(params.max_bytes);
+    double ttl_ms = 0;
+    double shards = 0;
+    if (!ReadInteger(options, "capacity", 1, &capacity) || capacity > 0xffffffffu) {
+        Napi::TypeError::New(env, "capacity must be an integer between 1 and 2^32").ThrowAsJavaScriptException();
+        return;
+    }
+    if (!ReadInteger(options, "maxBytes", 1, &max_bytes) || max_bytes > 9007199254740992.0) {
+        Napi::TypeError::New(env, "maxBytes must be a positive integer").ThrowAsJavaScriptException();
+        return;
+    }
+    if (!ReadCount(options, "ttlMs", 0, &ttl_ms)) {
+        Napi::TypeError::New(env, "ttlMs must be a non-negative number").ThrowAsJavaScriptException();
+        return;
+    }
+    if (!ReadInteger(options, "shards", 0, &shards) || shards > 256) {
+        Napi::TypeError::New(env, "shards must be an integer between 1 and 256").ThrowAsJavaScriptException();
+        return;
+    }
+    params.capacity = static_cast<size_t>(capacity);
+    params.max_bytes = static_cast<size_t>(max_bytes);
+    params.ttl_ms = static_cast<int64_t>(ttl_ms);
+    params.shards = static_cast<uint32_t>(shards);
+
+    Napi::Value name = options.Get("name");
+    if (name.IsString()) {
+        store_ = TtlStore::Attach(name.As<Napi::String>().Utf8Value(), params, &created_);
+        const TtlStoreParams& existing = store_->Params();
+        if (!created_ && (existing.capacity != params.capacity || existing.max_bytes != params.max_bytes ||
+                          existing.ttl_ms != params.ttl_ms || (params.shards != 0 && existing.shards != params.shards))) {
+            store_.reset();
+            Napi::Error::New(env, "a cache with this name exists with different limits").ThrowAsJavaScriptException();
+        }
+    } else if (name.IsUndefined()) {
+        store_ = TtlStore::Create(params);
+    } else {
+        Napi::TypeError::New(env, "name must be a string").ThrowAsJavaScriptException();
+    }
+}
+
+Napi::Value TtlCache::Read(Napi::Env env, const Napi::Value& key) {
+    std::string k = key.As<Napi::String>().Utf8Value();
+    TtlStore::ValueTag tag;
+    if (!store_->Get(k.data(), k.size(), &scratch_, &tag)) {
+        return env.Undefined();
+    }
+    if (tag == TtlStore::ValueTag::kBytes) {
+        return Napi::Buffer<uint8_t>::Copy(env, reinterpret_cast<const uint8_t*>(scratch_.data()), scratch_.size());
+    }
+    return Napi::String::New(env, scratch_);
+}
+
+bool TtlCache::Write(const Napi::Value& key, const Napi::Value& value, int64_t ttl_ms) {
+    std::string k = key.As<Napi::String>().Utf8Value();
+    if (value.IsString()) {
+        std::string v = value.As<Napi::String>().Utf8Value();
+        return store_->Set(k.data(), k.size(), reinterpret_cast<const uint8_t*>(v.data()), v.size(),
+                           TtlStore::ValueTag::kString, ttl_ms);
+    }
+    Napi::Uint8Array bytes = value.As<Napi::Uint8Array>();
+    return store_->Set(k.data(), k.size(), bytes.Data(), bytes.ByteLength(), TtlStore::ValueTag::kBytes, ttl_ms);
+}
+
+static bool IsCacheValue(const Napi::Value& value) {
+    return value.IsString() ||
+           (value.IsTypedArray() && value.As<Napi::TypedArray>().TypedArrayType() == napi_uint8_array);
+}
+
+// get(key): the value, or undefined when missing or expired
+Napi::Value TtlCache::Get(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected (key)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    return Read(env, info[0]);
+}
+
+// set(key, value: string | Uint8Array, ttlMs?): false when the entry is
+// larger than a shard's byte budget (any previous value is dropped)
+Napi::Value TtlCache::Set(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    int64_t ttl_ms = 0;
+    if (info.Length() < 2 || !info[0].IsString() || !IsCacheValue(info[1]) || !ReadTtl(info[2], &ttl_ms)) {
+        Napi::TypeError::New(env, "Expected (key, value: string | Uint8Array, ttlMs?)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    return Napi::Boolean::New(env, Write(info[0], info[1], ttl_ms));
+}
+
+Napi::Value TtlCache::Has(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected (key)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    std::string key = info[0].As<Napi::String>().Utf8Value();
+    return Napi::Boolean::New(env, store_->Has(key.data(), key.size()));
+}
+
+Napi::Value TtlCache::Delete(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected (key)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    std::string key = info[0].As<Napi::String>().Utf8Value();
+    return Napi::Boolean::New(env, store_->Delete(key.data(), key.size()));
+}
+
+// getMany(keys): values parallel to keys, undefined for misses
+Napi::Value TtlCache::GetMany(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsArray()) {
+        Napi::TypeError::New(env, "Expected (keys: string[])").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    Napi::Array keys = info[0].As<Napi::Array>();
+    uint32_t count = keys.Length();
+    for (uint32_t i = 0; i < count; i++) {
+        if (!keys.Get(i).IsString()) {
+            Napi::TypeError::New(env, "keys must be strings").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+    }
+
+    Napi::Array values = Napi::Array::New(env, count);
+    for (uint32_t i = 0; i < count; i++) {
+        values.Set(i, Read(env, keys.Get(i)));
+    }
+    return values;
+}
+
+// setMany(keys, values, ttlMs?): number of entries stored
+Napi::Value TtlCache::SetMany(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    int64_t ttl_ms = 0;
+    if (info.Length() < 2 || !info[0].IsArray() || !info[1].IsArray() || !ReadTtl(info[2], &ttl_ms) ||
+        info[0].As<Napi::Array>().Length() != info[1].As<Napi::Array>().Length()) {
+        Napi::TypeError::New(env, "Expected (keys: string[], values: Array<string | Uint8Array>, ttlMs?)")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    Napi::Array keys = info[0].As<Napi::Array>();
+    Napi::Array values = info[1].As<Napi::Array>();
+    uint32_t count = keys.Length();
+
+    // Validate everything before storing anything
+    for (uint32_t i = 0; i < count; i++) {
+        if (!keys.Get(i).IsString() || !IsCacheValue(values.Get(i))) {
+            Napi::TypeError::New(env, "keys must be strings and values strings or Uint8Arrays")
+                .ThrowAsJavaScriptException();
+            return env.Null();
+        }
+    }
+
+    uint32_t stored = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        stored += Write(keys.Get(i), values.Get(i), ttl_ms) ? 1 : 0;
+    }
+    return Napi::Number::New(env, stored);
+}
+
+Napi::Value TtlCache::Clear(const Napi::CallbackInfo& info) {
+    store_->Clear();
+    return info.Env().Undefined();
+}
+
+Napi::Value TtlCache::Len(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), static_cast<double>(store_->Size()));
+}
+
+Napi::Value TtlCache::Stats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    TtlStoreStats s = store_->Stats();
+    uint64_t lookups = s.hits + s.misses;
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("hits", Napi::Number::New(env, static_cast<double>(s.hits)));
+    result.Set("misses", Napi::Number::New(env, static_cast<double>(s.misses)));
+    result.Set("hitRate", Napi::Number::New(env, lookups ? static_cast<double>(s.hits) / lookups : 0.0));
+    result.Set("sets", Napi::Number::New(env, static_cast<double>(s.sets)));
+    result.Set("evictions", Napi::Number::New(env, static_cast<double>(s.evictions)));
+    result.Set("expirations", Napi::Number::New(env, static_cast<double>(s.expirations)));
+    result.Set("entries", Napi::Number::New(env, static_cast<double>(s.entries)));
+    result.Set("bytes", Napi::Number::New(env, static_cast<double>(s.charged_bytes)));
+    result.Set("bytesPayload", Napi::Number::New(env, static_cast<double>(s.payload_bytes)));
+    result.Set("bytesResident", Napi::Number::New(env, static_cast<double>(s.resident_bytes)));
+    result.Set("shards", Napi::Number::New(env, store_->Params().shards));
+    return result;
+}
+
+Napi::Value TtlCache::Capacity(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), static_cast<double>(store_->Params().capacity));
+}
+
+Napi::Value TtlCache::MaxBytes(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), static_cast<double>(store_->Params().max_bytes));
+}
+
+Napi::Value TtlCache::TtlMs(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), static_cast<double>(store_->Params().ttl_ms));
+}
+
+Napi::Value TtlCache::Attached(const Napi::CallbackInfo& info) {
+    return Napi::Boolean::New(info.Env(), !created_);
+}
+
+// Module initialization
+Napi::Object InitTtlCache(Napi::Env env, Napi::Object exports) {
+    return TtlCache::Init(env, exports);
+}
@@ -0,0 +1,564 @@
+#include "ttl-store.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <unordered_map>
+
+#include "file-hash.h"
+
+static constexpr uint64_t kKeySeed = 0x74746c6361636865ULL;  // "ttlcache"
+static constexpr uint32_t kNil = UINT32_MAX;
+static constexpr int64_t kNever = std::numeric_limits<int64_t>::max();
+
+// Wheel of 1024 slots x 250 ms: one rotation is ~4 minutes. Entries further
+// out share a slot with nearer ones and are skipped until their turn.
+static constexpr int64_t kSlotMs = 250;
+static constexpr size_t kWheelSlots = 1024;
+
+// Idle cached blocks are returned to the system this often
+static constexpr int64_t kTrimIntervalMs = 10000;
+
+static constexpr uint32_t kMaxShards = 16;
+static constexpr size_t kMinEntriesPerShard = 64;
+
+// Blocks above the largest pool class are allocated exactly and freed on
+// removal
+static constexpr int kDirectBlock = -1;
+
+static size_t NextPow2(size_t v) {
+    size_t p = 1;
+    while (p < v) {
+        p <<= 1;
+    }
+    return p;
+}
+
+static uint8_t* AllocateDirect(size_t size) {
+    return static_cast<uint8_t*>(::operator new(size));
+}
+
+static void FreeDirect(uint8_t* block, size_t size) {
+    ::operator delete(block, size);
+}
+
+struct TtlStore::Shard {
+    struct Entry {
+        uint64_t hash;
+        uint8_t* block;
+        uint32_t key_len;
+        uint32_t value_len;
+        int32_t cls;
+        ValueTag tag;
+        int64_t expires;
+        // LRU list, most recent at head
+        uint32_t prev;
+        uint32_t next;
+        // Expiry slot list
+        uint32_t wheel_prev;
+        uint32_t wheel_next;
+    };
+
+    Shard(size_t capacity, size_t budget)
+        : capacity(capacity),
+          budget(budget),
+          pool(SlabPool::DefaultClasses(), budget),
+          index(NextPow2(capacity * 2)),
+          index_mask(index.size() - 1),
+          wheel(kWheelSlots, kNil) {}
+
+    ~Shard() {
+        ClearLocked();
+    }
+
+    size_t BlockBytes(const Entry& e) const {
+        size_t len = size_t(e.key_len) + e.value_len;
+        return e.cls == kDirectBlock ? len : pool.ClassSize(e.cls);
+    }
+
+    // Index slots hold entry + 1; 0 is empty
+    size_t Home(uint64_t hash) const {
+        return hash & index_mask;
+    }
+
+    uint32_t Find(uint64_t hash, const char* key, size_t key_len) const {
+        for (size_t pos = Home(hash);; pos = (pos + 1) & index_mask) {
+            uint32_t slot = index[pos];
+            if (slot == 0) {
+                return kNil;
+            }
+            const Entry& e = entries[slot - 1];
+            if (e.hash == hash && e.key_len == key_len && std::memcmp(e.block, key, key_len) == 0) {
+                return slot - 1;
+            }
+        }
+    }
+
+    void IndexInsert(uint32_t id) {
+        size_t pos = Home(entries[id].hash);
+        while (index[pos] != 0) {
+            pos = (pos + 1) & index_mask;
+        }
+        index[pos] = id + 1;
+    }
+
+    // Backward-shift delete: keeps every probe chain gap-free without tombstones
+    void IndexErase(uint32_t id) {
+        size_t pos = Home(entries[id].hash);
+        while (index[pos] != id + 1) {
+            pos = (pos + 1) & index_mask;
+        }
+        size_t hole = pos;
+        for (size_t next = (hole + 1) & index_mask; index[next] != 0; next = (next + 1) & index_mask) {
+            size_t home = Home(entries[index[next] - 1].hash);
+            // Move next into the hole unless its home lies cyclically in (hole, next]
+            bool stays = hole <= next ? (hole < home && home <= next) : (hole < home || home <= next);
+            if (!stays) {
+                index[hole] = index[next];
+                hole = next;
+            }
+        }
+        index[hole] = 0;
+    }
+
+    void LruPushFront(uint32_t id) {
+        Entry& e = entries[id];
+        e.prev = kNil;
+        e.next = head;
+        if (head != kNil) {
+            entries[head].prev = id;
+        }
+        head = id;
+        if (tail == kNil) {
+            tail = id;
+        }
+    }
+
+    void LruUnlink(uint32_t id) {
+        Entry& e = entries[id];
+        (e.prev != kNil ? entries[e.prev].next : head) = e.next;
+        (e.next != kNil ? entries[e.next].prev : tail) = e.prev;
+    }
+
+    void WheelLink(uint32_t id) {
+        Entry& e = entries[id];
+        if (e.expires == kNever) {
+            return;
+        }
+        uint32_t& slot = wheel[(e.expires / kSlotMs) & (kWheelSlots - 1)];
+        e.wheel_prev = kNil;
+        e.wheel_next = slot;
+        if (slot != kNil) {
+            entries[slot].wheel_prev = id;
+        }
+        slot = id;
+    }
+
+    void WheelUnlink(uint32_t id) {
+        Entry& e = entries[id];
+        if (e.expires == kNever) {
+            return;
+        }
+        if (e.wheel_prev != kNil) {
+            entries[e.wheel_prev].wheel_next = e.wheel_next;
+        } else {
+            wheel[(e.expires / kSlotMs) & (kWheelSlots - 1)] = e.wheel_next;
+        }
+        if (e.wheel_next != kNil) {
+            entries[e.wheel_next].wheel_prev = e.wheel_prev;
+        }
+    }
+
+    void FreeBlock(Entry& e) {
+        if (e.cls == kDirectBlock) {
+            FreeDirect(e.block, size_t(e.key_len) + e.value_len);
+        } else {
+            pool.Release(e.cls, e.block);
+        }
+        e.block = nullptr;
+    }
+
+    void Remove(uint32_t id) {
+        Entry& e = entries[id];
+        IndexErase(id);
+        LruUnlink(id);
+        WheelUnlink(id);
+        bytes -= BlockBytes(e);
+        payload -= size_t(e.key_len) + e.value_len;
+        FreeBlock(e);
+        free_list.push_back(id);
+        count--;
+    }
+
+    void ClearLocked() {
+        while (tail != kNil) {
+            Remove(tail);
+        }
+        pool.Purge();
+    }
+
+    std::mutex mutex;
+    const size_t capacity;
+    const size_t budget;
+    SlabPool pool;
+
+    // Grown on demand up to capacity; removed slots are reused first
+    std::vector<Entry> entries;
+    std::vector<uint32_t> free_list;
+    std::vector<uint32_t> index;
+    const size_t index_mask;
+    std::vector<uint32_t> wheel;
+    uint32_t head = kNil;
+    uint32_t tail = kNil;
+
+    size_t count = 0;
+    size_t bytes = 0;
+    size_t payload = 0;
+    int64_t swept_tick = -1;
+    int64_t last_trim = 0;
+
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t sets = 0;
+    uint64_t evictions = 0;
+    uint64_t expirations = 0;
+};
+
+// ---------------------------------------------------------------------------
+// Process-wide sweeper and name registry
+// ---------------------------------------------------------------------------
+
+namespace {
+
+class Sweeper {
+public:
+    static Sweeper& Shared() {
+        static Sweeper sweeper;
+        return sweeper;
+    }
+
+    ~Sweeper() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    void Register(const std::shared_ptr<TtlStore>& store) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stores_.push_back(store);
+        if (!thread_.joinable()) {
+            thread_ = std::thread([this] { Loop(); });
+        }
+    }
+
+    // The live store registered under `name`, or the one `create` makes,
+    // registered in its place. Runs `create` under the registry lock so two
+    // threads attaching at once get the same store.
+    template <typename Create>
+    std::shared_ptr<TtlStore> Attach(const std::string& name, Create create, bool* created) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = named_.find(name);
+        std::shared_ptr<TtlStore> store = it != named_.end() ? it->second.lock() : nullptr;
+        *created = !store;
+        if (!store) {
+            store = create();
+            named_[name] = store;
+            stores_.push_back(store);
+            if (!thread_.joinable()) {
+                thread_ = std::thread([this] { Loop(); });
+            }
+        }
+        return store;
+    }
+
+private:
+    void Loop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stopping_) {
+            wake_.wait_for(lock, std::chrono::milliseconds(kSlotMs));
+            if (stopping_) {
+                break;
+            }
+
+            // Sweep outside the registry lock; the last reference to a
+            // store may be dropped here, which is fine off the JS thread
+            std::vector<std::shared_ptr<TtlStore>> live;
+            live.reserve(stores_.size());
+            auto end = std::remove_if(stores_.begin(), stores_.end(), [&](const std::weak_ptr<TtlStore>& weak) {
+                auto store = weak.lock();
+                if (!store) {
+                    return true;
+                }
+                live.push_back(std::move(store));
+                return false;
+            });
+            stores_.erase(end, stores_.end());
+            for (auto it = named_.begin(); it != named_.end();) {
+                it = it->second.expired() ? named_.erase(it) : std::next(it);
+            }
+
+            lock.unlock();
+            int64_t now = TtlStore::NowMs();
+            for (auto& store : live) {
+                store->Sweep(now);
+            }
+            live.clear();
+            lock.lock();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::thread thread_;
+    bool stopping_ = false;
+    std::vector<std::weak_ptr<TtlStore>> stores_;
+    std::unordered_map<std::string, std::weak_ptr<TtlStore>> named_;
+};
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// TtlStore
+// ---------------------------------------------------------------------------
+
+int64_t TtlStore::NowMs() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+TtlStore::TtlStore(const TtlStoreParams& params) : params_(params) {
+    params_.capacity = std::max<size_t>(params_.capacity, 1);
+    params_.max_bytes = std::max<size_t>(params_.max_bytes, 1);
+
+    uint32_t shards = params_.shards;
+    if (shards == 0) {
+        shards = kMaxShards;
+        while (shards > 1 && params_.capacity / shards < kMinEntriesPerShard) {
+            shards >>= 1;
+        }
+    }
+    shards = static_cast<uint32_t>(NextPow2(std::min<uint32_t>(shards, 256)));
+    params_.shards = shards;
+    shard_mask_ = shards - 1;
+
+    // Split the capacity exactly; the first shards take the remainder
+    size_t per_capacity = params_.capacity / shards;
+    size_t remainder = params_.capacity % shards;
+    size_t per_budget = std::max<size_t>(params_.max_bytes / shards, 1);
+    shards_.reserve(shards);
+    for (uint32_t i = 0; i < shards; i++) {
+        size_t capacity = std::max<size_t>(per_capacity + (i < remainder ? 1 : 0), 1);
+        shards_.push_back(std::make_unique<Shard>(capacity, per_budget));
+    }
+}
+
+TtlStore::~TtlStore() = default;
+
+std::shared_ptr<TtlStore> TtlStore::Create(const TtlStoreParams& params) {
+    std::shared_ptr<TtlStore> store(new TtlStore(params));
+    Sweeper::Shared().Register(store);
+    return store;
+}
+
+std::shared_ptr<TtlStore> TtlStore::Attach(const std::string& name, const TtlStoreParams& params,
+                                           bool* created) {
+    return Sweeper::Shared().Attach(
+        name, [&] { return std::shared_ptr<TtlStore>(new TtlStore(params)); }, created);
+}
+
+bool TtlStore::Get(const char* key, size_t key_len, std::string* value, ValueTag* tag) {
+    uint64_t hash = Xxh64(key, key_len, kKeySeed);
+    Shard& shard = ShardFor(hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    uint32_t id = shard.Find(hash, key, key_len);
+    if (id == kNil) {
+        shard.misses++;
+        return false;
+    }
+    Shard::Entry& e = shard.entries[id];
+    if (e.expires <= NowMs()) {
+        shard.Remove(id);
+        shard.expirations++;
+        shard.misses++;
+        return false;
+    }
+
+    value->assign(reinterpret_cast<const char*>(e.block) + e.key_len, e.value_len);
+    *tag = e.tag;
+    if (shard.head != id) {
+        shard.LruUnlink(id);
+        shard.LruPushFront(id);
+    }
+    shard.hits++;
+    return true;
+}
+
+bool TtlStore::Has(const char* key, size_t key_len) {
+    uint64_t hash = Xxh64(key, key_len, kKeySeed);
+    Shard& shard = ShardFor(hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    uint32_t id = shard.Find(hash, key, key_len);
+    return id != kNil && shard.entries[id].expires > NowMs();
+}
+
+bool TtlStore::Set(const char* key, size_t key_len, const uint8_t* value, size_t value_len, ValueTag tag,
+                   int64_t ttl_ms) {
+    uint64_t hash = Xxh64(key, key_len, kKeySeed);
+    Shard& shard = ShardFor(hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    uint32_t existing = shard.Find(hash, key, key_len);
+    if (existing != kNil) {
+        shard.Remove(existing);
+    }
+
+    size_t len = key_len + value_len;
+    int cls = shard.pool.ClassFor(len);
+    size_t block_bytes = cls < 0 ? len : shard.pool.ClassSize(cls);
+    if (block_bytes > shard.budget || key_len > UINT32_MAX || value_len > UINT32_MAX) {
+        return false;
+    }
+
+    while (shard.count >= shard.capacity || shard.bytes + block_bytes > shard.budget) {
+        shard.Remove(shard.tail);
+        shard.evictions++;
+    }
+
+    uint8_t* block;
+    if (cls < 0) {
+        cls = kDirectBlock;
+        block = AllocateDirect(len);
+    } else {
+        bool fresh = false;
+        block = shard.pool.Acquire(cls, &fresh);
+    }
+    std::memcpy(block, key, key_len);
+    if (value_len > 0) {
+        std::memcpy(block + key_len, value, value_len);
+    }
+
+    if (ttl_ms == kUseDefaultTtl) {
+        ttl_ms = params_.ttl_ms;
+    }
+    int64_t now = NowMs();
+
+    uint32_t id;
+    if (!shard.free_list.empty()) {
+        id = shard.free_list.back();
+        shard.free_list.pop_back();
+    } else {
+        id = static_cast<uint32_t>(shard.entries.size());
+        shard.entries.emplace_back();
+    }
+    Shard::Entry& e = shard.entries[id];
+    e.hash = hash;
+    e.block = block;
+    e.key_len = static_cast<uint32_t>(key_len);
+    e.value_len = static_cast<uint32_t>(value_len);
+    e.cls = cls;
+    e.tag = tag;
+    e.expires = ttl_ms > 0 && ttl_ms < kNever - now ? now + ttl_ms : kNever;
+
+    shard.IndexInsert(id);
+    shard.LruPushFront(id);
+    shard.WheelLink(id);
+    shard.count++;
+    shard.bytes += block_bytes;
+    shard.payload += len;
+    shard.sets++;
+    return true;
+}
+
+bool TtlStore::Delete(const char* key, size_t key_len) {
+    uint64_t hash = Xxh64(key, key_len, kKeySeed);
+    Shard& shard = ShardFor(hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    uint32_t id = shard.Find(hash, key, key_len);
+    if (id == kNil) {
+        return false;
+    }
+    shard.Remove(id);
+    return true;
+}
+
+void TtlStore::Clear() {
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->ClearLocked();
+    }
+}
+
+size_t TtlStore::Sweep(int64_t now_ms) {
+    size_t removed = 0;
+    int64_t now_tick = now_ms / kSlotMs;
+
+    for (auto& shard_ptr : shards_) {
+        Shard& shard = *shard_ptr;
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        // Revisit the current slot next time: it may hold entries due later
+        // in this tick
+        int64_t from = shard.swept_tick < 0 ? now_tick : shard.swept_tick;
+        if (now_tick - from >= static_cast<int64_t>(kWheelSlots)) {
+            from = now_tick - static_cast<int64_t>(kWheelSlots) + 1;
+        }
+        for (int64_t tick = from; tick <= now_tick; tick++) {
+            uint32_t id = shard.wheel[tick & (kWheelSlots - 1)];
+            while (id != kNil) {
+                uint32_t next = shard.entries[id].wheel_next;
+                if (shard.entries[id].expires <= now_ms) {
+                    shard.Remove(id);
+                    shard.expirations++;
+                    removed++;
+                }
+                id = next;
+            }
+        }
+        shard.swept_tick = now_tick;
+
+        if (now_ms - shard.last_trim >= kTrimIntervalMs) {
+            shard.pool.Trim();
+            shard.last_trim = now_ms;
+        }
+    }
+    return removed;
+}
+
+size_t TtlStore::Size() const {
+    size_t size = 0;
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        size += shard->count;
+    }
+    return size;
+}
+
+TtlStoreStats TtlStore::Stats() const {
+    TtlStoreStats stats;
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        stats.hits += shard->hits;
+        stats.misses += shard->misses;
+        stats.sets += shard->sets;
+        stats.evictions += shard->evictions;
+        stats.expirations += shard->expirations;
+        stats.entries += shard->count;
+        stats.payload_bytes += shard->payload;
+        stats.charged_bytes += shard->bytes;
+        stats.resident_bytes += shard->bytes + shard->pool.GetStats().bytes_free;
+    }
+    return stats;
+}
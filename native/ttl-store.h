@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "slab-pool.h"
+
+// Sharded LRU key/value store with per-entry TTLs, kept off the JS heap.
+// N-API free.
+//
+// Keys are hashed (XXH64) to one of a power-of-two number of shards, each
+// with its own mutex, so threads only contend on the same shard. A shard
+// holds a fixed share of the entry capacity and byte budget:
+//   - an open-addressed index (linear probing, backward-shift deletes),
+//     sized once for the shard's capacity, so it never rehashes;
+//   - an intrusive LRU list; a full shard evicts its tail in O(1);
+//   - key and value bytes in one block from a SlabPool size class, or a
+//     plain allocation above the largest class. The byte budget counts
+//     whole blocks, so it bounds real memory, not just payload;
+//   - a timing wheel of expiry slots. A process-wide sweeper thread
+//     drops expired entries from every live store; reads also treat them
+//     as misses.
+//
+// Stores created with a name are registered process-wide, so JS workers can
+// attach to the same cache.
+
+struct TtlStoreParams {
+    size_t capacity = 10000;
+    size_t max_bytes = size_t(64) << 20;
+    // Default TTL for Set(); 0 = entries never expire
+    int64_t ttl_ms = 0;
+    // 0 = pick from capacity (at most 16, at least 64 entries each)
+    uint32_t shards = 0;
+};
+
+struct TtlStoreStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t sets = 0;
+    // Removed to make room (capacity or bytes)
+    uint64_t evictions = 0;
+    // Removed on read or by the sweeper after their TTL
+    uint64_t expirations = 0;
+    size_t entries = 0;
+    // Key + value bytes of live entries
+    size_t payload_bytes = 0;
+    // What live entries count against max_bytes: their blocks (key + value
+    // rounded up to a power of two of at least 64 B, exact above the
+    // largest class)
+    size_t charged_bytes = 0;
+    // Blocks held by live entries, plus blocks cached for reuse
+    size_t resident_bytes = 0;
+};
+
+class TtlStore {
+public:
+    // Value types as the caller wants them back
+    enum class ValueTag : uint8_t { kString = 0, kBytes = 1 };
+
+    static constexpr int64_t kUseDefaultTtl = -1;
+
+    static std::shared_ptr<TtlStore> Create(const TtlStoreParams& params);
+
+    // The store registered under `name`, or a new one created (and
+    // registered) with `params`. *created tells which.
+    static std::shared_ptr<TtlStore> Attach(const std::string& name, const TtlStoreParams& params,
+                                            bool* created);
+
+    ~TtlStore();
+
+    TtlStore(const TtlStore&) = delete;
+    TtlStore& operator=(const TtlStore&) = delete;
+
+    // Copies the value into *value (reusing its capacity) and refreshes the
+    // entry's LRU position. False on a miss or an expired entry.
+    bool Get(const char* key, size_t key_len, std::string* value, ValueTag* tag);
+
+    bool Has(const char* key, size_t key_len);
+
+    // ttl_ms: kUseDefaultTtl, 0 for no expiry, or milliseconds. Returns
+    // false, and drops any previous value, when key + value exceed a
+    // shard's byte budget.
+    bool Set(const char* key, size_t key_len, const uint8_t* value, size_t value_len, ValueTag tag,
+             int64_t ttl_ms = kUseDefaultTtl);
+
+    bool Delete(const char* key, size_t key_len);
+
+    void Clear();
+
+    // Drops entries expired by `now_ms` (steady clock, NowMs()) and trims
+    // idle cached blocks. Called by the sweeper; returns entries removed.
+    size_t Sweep(int64_t now_ms);
+
+    size_t Size() const;
+    TtlStoreStats Stats() const;
+    const TtlStoreParams& Params() const { return params_; }
+
+    // Milliseconds on the steady clock the store's TTLs use
+    static int64_t NowMs();
+
+private:
+    struct Shard;
+
+    explicit TtlStore(const TtlStoreParams& params);
+
+    Shard& ShardFor(uint64_t hash) { return *shards_[(hash >> 40) & shard_mask_]; }
+
+    TtlStoreParams params_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    uint64_t shard_mask_;
+};
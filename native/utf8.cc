@@ -0,0 +1,436 @@
+#include "utf8.h"
+#include "cpu-features.h"
+
+#include <cstring>
+#include <mutex>
+
+#if defined(HAS_X86_SIMD)
+  #include <immintrin.h>
+#elif defined(HAS_ARM_SIMD)
+  #include <arm_neon.h>
+#endif
+
+// ---------------------------------------------------------------------------
+// Scalar
+// ---------------------------------------------------------------------------
+
+static inline bool AllAscii8(const uint8_t* p) {
+    uint64_t word;
+    std::memcpy(&word, p, sizeof(word));
+    return (word & UINT64_C(0x8080808080808080)) == 0;
+}
+
+// Length of the well-formed sequence starting at p (lead byte >= 0x80), or 0
+static size_t SequenceLengthChecked(const uint8_t* p, size_t avail) {
+    uint8_t b0 = p[0];
+    size_t n;
+    uint8_t lo = 0x80, hi = 0xbf;
+    if (b0 >= 0xc2 && b0 <= 0xdf) {
+        n = 2;
+    } else if (b0 >= 0xe0 && b0 <= 0xef) {
+        n = 3;
+        if (b0 == 0xe0) lo = 0xa0;
+        if (b0 == 0xed) hi = 0x9f;
+    } else if (b0 >= 0xf0 && b0 <= 0xf4) {
+        n = 4;
+        if (b0 == 0xf0) lo = 0x90;
+        if (b0 == 0xf4) hi = 0x8f;
+    } else {
+        return 0;
+    }
+    if (avail < n || p[1] < lo || p[1] > hi) {
+        return 0;
+    }
+    for (size_t i = 2; i < n; i++) {
+        if ((p[i] & 0xc0) != 0x80) {
+            return 0;
+        }
+    }
+    return n;
+}
+
+static bool ValidateScalar(const uint8_t* data, size_t len) {
+    size_t i = 0;
+    while (i < len) {
+        if (i + 8 <= len && AllAscii8(data + i)) {
+            i += 8;
+            continue;
+        }
+        if (data[i] < 0x80) {
+            i++;
+            continue;
+        }
+        size_t n = SequenceLengthChecked(data + i, len - i);
+        if (n == 0) {
+            return false;
+        }
+        i += n;
+    }
+    return true;
+}
+
+// Every byte that is not a continuation starts one code point; 4-byte
+// sequences need a surrogate pair
+static size_t Utf16LengthScalar(const uint8_t* data, size_t len) {
+    size_t units = 0;
+    for (size_t i = 0; i < len; i++) {
+        units += ((data[i] & 0xc0) != 0x80) + (data[i] >= 0xf0);
+    }
+    return units;
+}
+
+// ---------------------------------------------------------------------------
+// Lookup tables shared by the SIMD validators
+//
+// Each table maps a nibble to the set of errors that nibble allows; an error
+// is reported where all three lookups (high and low nibble of the previous
+// byte, high nibble of the current one) agree. Bit names describe the byte
+// pair (previous, current).
+// ---------------------------------------------------------------------------
+
+#if defined(HAS_X86_DISPATCH) || defined(HAS_ARM_SIMD)
+
+constexpr uint8_t kTooShort = 1 << 0;     // 11______ 0_______ / 11______ 11______
+constexpr uint8_t kTooLong = 1 << 1;      // 0_______ 10______
+constexpr uint8_t kOverlong3 = 1 << 2;    // 11100000 100_____
+constexpr uint8_t kTooLarge = 1 << 3;     // 11110100 1001____ and above
+constexpr uint8_t kSurrogate = 1 << 4;    // 11101101 101_____
+constexpr uint8_t kOverlong2 = 1 << 5;    // 1100000_ 10______
+constexpr uint8_t kTooLarge1000 = 1 << 6; // 11110101+ 1000____
+constexpr uint8_t kOverlong4 = 1 << 6;    // 11110000 1000____
+constexpr uint8_t kTwoConts = 1 << 7;     // 10______ 10______
+constexpr uint8_t kCarry = kTooShort | kTooLong | kTwoConts;
+
+alignas(16) static const uint8_t kByte1High[16] = {
+    // 0_______ ASCII
+    kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong,
+    // 10______ continuation
+    kTwoConts, kTwoConts, kTwoConts, kTwoConts,
+    // 1100____
+    kTooShort | kOverlong2,
+    // 1101____
+    kTooShort,
+    // 1110____
+    kTooShort | kOverlong3 | kSurrogate,
+    // 1111____
+    kTooShort | kTooLarge | kTooLarge1000 | kOverlong4,
+};
+
+alignas(16) static const uint8_t kByte1Low[16] = {
+    // ____0000
+    kCarry | kOverlong3 | kOverlong2 | kOverlong4,
+    // ____0001
+    kCarry | kOverlong2,
+    // ____001_
+    kCarry, kCarry,
+    // ____0100
+    kCarry | kTooLarge,
+    // ____0101 .. ____1100
+    kCarry | kTooLarge | kTooLarge1000, kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000, kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000, kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000, kCarry | kTooLarge | kTooLarge1000,
+    // ____1101
+    kCarry | kTooLarge | kTooLarge1000 | kSurrogate,
+    // ____111_
+    kCarry | kTooLarge | kTooLarge1000, kCarry | kTooLarge | kTooLarge1000,
+};
+
+alignas(16) static const uint8_t kByte2High[16] = {
+    // ________ 0_______
+    kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort,
+    // ________ 1000____
+    kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge1000 | kOverlong4,
+    // ________ 1001____
+    kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge,
+    // ________ 101_____
+    kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+    kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+    // ________ 11______
+    kTooShort, kTooShort, kTooShort, kTooShort,
+};
+
+// A block ending in these leads continues into the next one: the last byte
+// >= 0xc0, the second to last >= 0xe0 or the third to last >= 0xf0
+alignas(32) static const uint8_t kIncompleteMax[32] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xef, 0xdf, 0xbf,
+};
+
+#endif
+
+// ---------------------------------------------------------------------------
+// x86: AVX2
+// ---------------------------------------------------------------------------
+
+#if defined(HAS_X86_DISPATCH)
+
+OPENCLAW_TARGET("avx2")
+static inline __m256i Lookup16Avx2(const uint8_t* table, __m256i nibbles) {
+    __m256i t = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(table)));
+    return _mm256_shuffle_epi8(t, nibbles);
+}
+
+// input shifted right by N bytes across the block boundary, the gap filled
+// from the end of prev
+template <int N>
+OPENCLAW_TARGET("avx2")
+static inline __m256i PrevAvx2(__m256i input, __m256i prev) {
+    return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(prev, input, 0x21), 16 - N);
+}
+
+OPENCLAW_TARGET("avx2")
+static inline __m256i CheckBlockAvx2(__m256i input, __m256i prev_input) {
+    const __m256i low_nibble = _mm256_set1_epi8(0x0f);
+    __m256i prev1 = PrevAvx2<1>(input, prev_input);
+    __m256i byte1_high = Lookup16Avx2(kByte1High, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), low_nibble));
+    __m256i byte1_low = Lookup16Avx2(kByte1Low, _mm256_and_si256(prev1, low_nibble));
+    __m256i byte2_high = Lookup16Avx2(kByte2High, _mm256_and_si256(_mm256_srli_epi16(input, 4), low_nibble));
+    __m256i special = _mm256_and_si256(_mm256_and_si256(byte1_high, byte1_low), byte2_high);
+
+    // Third and fourth bytes of 3- and 4-byte sequences must be
+    // continuations; kTwoConts flagged exactly those positions
+    __m256i prev2 = PrevAvx2<2>(input, prev_input);
+    __m256i prev3 = PrevAvx2<3>(input, prev_input);
+    __m256i third = _mm256_subs_epu8(prev2, _mm256_set1_epi8(static_cast<char>(0xe0 - 0x80)));
+    __m256i fourth = _mm256_subs_epu8(prev3, _mm256_set1_epi8(static_cast<char>(0xf0 - 0x80)));
+    __m256i must23 = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(static_cast<char>(0x80)));
+    return _mm256_xor_si256(must23, special);
+}
+
+struct Avx2State {
+    __m256i error;
+    __m256i prev_input;
+    __m256i prev_incomplete;
+};
+
+OPENCLAW_TARGET("avx2")
+static inline void StepAvx2(Avx2State* s, __m256i input) {
+    if (_mm256_movemask_epi8(input) == 0) {
+        s->error = _mm256_or_si256(s->error, s->prev_incomplete);
+    } else {
+        const __m256i incomplete_max = _mm256_load_si256(reinterpret_cast<const __m256i*>(kIncompleteMax));
+        s->error = _mm256_or_si256(s->error, CheckBlockAvx2(input, s->prev_input));
+        s->prev_incomplete = _mm256_subs_epu8(input, incomplete_max);
+    }
+    s->prev_input = input;
+}
+
+OPENCLAW_TARGET("avx2")
+static bool ValidateAvx2(const uint8_t* data, size_t len) {
+    Avx2State s = {_mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256()};
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        StepAvx2(&s, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)));
+        if ((i & 0x3ff) == 0 && !_mm256_testz_si256(s.error, s.error)) {
+            return false;
+        }
+    }
+    // The tail, zero padded: the padding reads as ASCII, so a sequence cut
+    // off by the end of the input shows up as too short
+    alignas(32) uint8_t tail[32] = {};
+    std::memcpy(tail, data + i, len - i);
+    StepAvx2(&s, _mm256_load_si256(reinterpret_cast<const __m256i*>(tail)));
+    s.error = _mm256_or_si256(s.error, s.prev_incomplete);
+    return _mm256_testz_si256(s.error, s.error) != 0;
+}
+
+OPENCLAW_TARGET("avx2")
+static size_t Utf16LengthAvx2(const uint8_t* data, size_t len) {
+    const __m256i cont_end = _mm256_set1_epi8(static_cast<char>(0xc0));
+    const __m256i four_min = _mm256_set1_epi8(static_cast<char>(0xf0));
+    size_t units = 0;
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        // Signed compare: 0x80..0xbf are the only bytes below (int8_t)0xc0
+        uint32_t cont = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpgt_epi8(cont_end, v)));
+        uint32_t four = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(v, four_min), v)));
+        units += 32 - static_cast<size_t>(__builtin_popcount(cont)) + static_cast<size_t>(__builtin_popcount(four));
+    }
+    return units + Utf16LengthScalar(data + i, len - i);
+}
+
+#endif  // HAS_X86_DISPATCH
+
+// ---------------------------------------------------------------------------
+// ARM: NEON
+// ---------------------------------------------------------------------------
+
+#if defined(HAS_ARM_SIMD)
+
+static inline uint8x16_t CheckBlockNeon(uint8x16_t input, uint8x16_t prev_input) {
+    const uint8x16_t low_nibble = vdupq_n_u8(0x0f);
+    uint8x16_t prev1 = vextq_u8(prev_input, input, 15);
+    uint8x16_t byte1_high = vqtbl1q_u8(vld1q_u8(kByte1High), vshrq_n_u8(prev1, 4));
+    uint8x16_t byte1_low = vqtbl1q_u8(vld1q_u8(kByte1Low), vandq_u8(prev1, low_nibble));
+    uint8x16_t byte2_high = vqtbl1q_u8(vld1q_u8(kByte2High), vshrq_n_u8(input, 4));
+    uint8x16_t special = vandq_u8(vandq_u8(byte1_high, byte1_low), byte2_high);
+
+    uint8x16_t prev2 = vextq_u8(prev_input, input, 14);
+    uint8x16_t prev3 = vextq_u8(prev_input, input, 13);
+    uint8x16_t third = vqsubq_u8(prev2, vdupq_n_u8(0xe0 - 0x80));
+    uint8x16_t fourth = vqsubq_u8(prev3, vdupq_n_u8(0xf0 - 0x80));
+    uint8x16_t must23 = vandq_u8(vorrq_u8(third, fourth), vdupq_n_u8(0x80));
+    return veorq_u8(must23, special);
+}
+
+static bool ValidateNeon(const uint8_t* data, size_t len) {
+    const uint8x16_t incomplete_max = vld1q_u8(kIncompleteMax + 16);
+    uint8x16_t error = vdupq_n_u8(0);
+    uint8x16_t prev_input = vdupq_n_u8(0);
+    uint8x16_t prev_incomplete = vdupq_n_u8(0);
+
+    auto step = [&](uint8x16_t input) {
+        if (vmaxvq_u8(input) < 0x80) {
+            error = vorrq_u8(error, prev_incomplete);
+        } else {
+            error = vorrq_u8(error, CheckBlockNeon(input, prev_input));
+            prev_incomplete = vqsubq_u8(input, incomplete_max);
+        }
+        prev_input = input;
+    };
+
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        step(vld1q_u8(data + i));
+        if ((i & 0x3ff) == 0 && vmaxvq_u8(error) != 0) {
+            return false;
+        }
+    }
+    uint8_t tail[16] = {};
+    std::memcpy(tail, data + i, len - i);
+    step(vld1q_u8(tail));
+    error = vorrq_u8(error, prev_incomplete);
+    return vmaxvq_u8(error) == 0;
+}
+
+static size_t Utf16LengthNeon(const uint8_t* data, size_t len) {
+    size_t units = 0;
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        int8x16_t v = vreinterpretq_s8_u8(vld1q_u8(data + i));
+        // Lanes are 0 or 0xff, so the negated sum counts them
+        uint8x16_t cont = vcltq_s8(v, vdupq_n_s8(static_cast<int8_t>(0xc0)));
+        uint8x16_t four = vcgeq_u8(vreinterpretq_u8_s8(v), vdupq_n_u8(0xf0));
+        units += 16 - (vaddlvq_u8(cont) / 0xff) + vaddlvq_u8(four) / 0xff;
+    }
+    return units + Utf16LengthScalar(data + i, len - i);
+}
+
+#endif  // HAS_ARM_SIMD
+
+// ---------------------------------------------------------------------------
+// Dispatch
+// ---------------------------------------------------------------------------
+
+using ValidateFn = bool (*)(const uint8_t*, size_t);
+using Utf16LengthFn = size_t (*)(const uint8_t*, size_t);
+
+static ValidateFn validate_impl = ValidateScalar;
+static Utf16LengthFn utf16_length_impl = Utf16LengthScalar;
+
+static void SelectKernels() {
+#if defined(HAS_X86_DISPATCH)
+    if (GetCpuFeatures().avx2) {
+        validate_impl = ValidateAvx2;
+        utf16_length_impl = Utf16LengthAvx2;
+    }
+#elif defined(HAS_ARM_SIMD)
+    validate_impl = ValidateNeon;
+    utf16_length_impl = Utf16LengthNeon;
+#endif
+}
+
+void InitUtf8() {
+    static std::once_flag once;
+    std::call_once(once, SelectKernels);
+}
+
+bool Utf8Validate(const uint8_t* data, size_t len) {
+    // Short strings (most frame fields, snippets) are not worth a padded block
+    return len < 64 ? ValidateScalar(data, len) : validate_impl(data, len);
+}
+
+size_t Utf8Utf16Length(const uint8_t* data, size_t len) {
+    return utf16_length_impl(data, len);
+}
+
+size_t Utf8PrefixForUtf16(const uint8_t* data, size_t len, size_t max_units) {
+    // Every byte is at most one unit
+    if (len <= max_units) {
+        return len;
+    }
+    size_t i = 0;
+    size_t units = 0;
+    while (i < len) {
+        if (i + 8 <= len && units + 8 <= max_units && AllAscii8(data + i)) {
+            i += 8;
+            units += 8;
+            continue;
+        }
+        uint8_t lead = data[i];
+        size_t n = lead < 0x80 ? 1 : lead >= 0xf0 ? 4 : lead >= 0xe0 ? 3 : 2;
+        size_t u = n == 4 ? 2 : 1;
+        if (units + u > max_units || n > len - i) {
+            break;
+        }
+        units += u;
+        i += n;
+    }
+    return i;
+}
+
+size_t Utf8PrefixForBytes(const uint8_t* data, size_t len, size_t max_bytes) {
+    if (len <= max_bytes) {
+        return len;
+    }
+    size_t end = max_bytes;
+    // data[end] is the first byte left out; back up while it continues the
+    // sequence before it
+    while (end > 0 && (data[end] & 0xc0) == 0x80) {
+        end--;
+    }
+    return end;
+}
+
+size_t Utf8Decode(const uint8_t* data, size_t len, uint32_t* cp) {
+    uint8_t b0 = data[0];
+    if (b0 < 0x80) {
+        *cp = b0;
+        return 1;
+    }
+    size_t n;
+    uint32_t value;
+    uint8_t lo = 0x80, hi = 0xbf;
+    if (b0 >= 0xc2 && b0 <= 0xdf) {
+        n = 2;
+        value = b0 & 0x1f;
+    } else if (b0 >= 0xe0 && b0 <= 0xef) {
+        n = 3;
+        value = b0 & 0x0f;
+        if (b0 == 0xe0) lo = 0xa0;
+        if (b0 == 0xed) hi = 0x9f;
+    } else if (b0 >= 0xf0 && b0 <= 0xf4) {
+        n = 4;
+        value = b0 & 0x07;
+        if (b0 == 0xf0) lo = 0x90;
+        if (b0 == 0xf4) hi = 0x8f;
+    } else {
+        *cp = kUtf8Replacement;
+        return 1;
+    }
+    for (size_t i = 1; i < n; i++) {
+        uint8_t b = i < len ? data[i] : 0;
+        if (b < lo || b > hi) {
+            *cp = kUtf8Replacement;
+            return i;
+        }
+        value = (value << 6) | (b & 0x3f);
+        lo = 0x80;
+        hi = 0xbf;
+    }
+    *cp = value;
+    return n;
+}
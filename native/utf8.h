@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// UTF-8 validation, UTF-16 length counting and code-point-safe truncation on
+// raw bytes. N-API free.
+//
+// Validation follows the Unicode definition of well-formed UTF-8 (no
+// overlongs, surrogates or code points above U+10FFFF), which is what
+// TextDecoder's fatal mode and Buffer.isUtf8() accept. The AVX2 and NEON
+// kernels classify every byte pair with three nibble lookups (Keiser and
+// Lemire, "Validating UTF-8 In Less Than One Instruction Per Byte"), and
+// skip blocks that are all ASCII.
+
+// Pick kernels for this host. Idempotent; called from module init.
+void InitUtf8();
+
+bool Utf8Validate(const uint8_t* data, size_t len);
+
+// UTF-16 code units (String.length) the bytes decode to. The input must be
+// valid UTF-8.
+size_t Utf8Utf16Length(const uint8_t* data, size_t len);
+
+// Byte length of the longest prefix that decodes to at most `max_units`
+// UTF-16 code units without splitting a code point. A 4-byte sequence that
+// would straddle the limit is left out, as truncateUtf16Safe() drops a
+// dangling high surrogate. The prefix must be valid UTF-8; cost is
+// proportional to the prefix, not to `len`.
+size_t Utf8PrefixForUtf16(const uint8_t* data, size_t len, size_t max_units);
+
+// Byte length of the longest prefix of at most `max_bytes` bytes that ends
+// on a code point boundary.
+size_t Utf8PrefixForBytes(const uint8_t* data, size_t len, size_t max_bytes);
+
+// Code point Utf8Decode() reports for an ill-formed sequence
+constexpr uint32_t kUtf8Replacement = 0xfffd;
+
+// Decodes the code point at data[0] (len >= 1) and returns the bytes it
+// spans. An ill-formed sequence decodes to U+FFFD and spans its maximal
+// subpart, the longest prefix that could start a well-formed sequence (at
+// least one byte), so callers replace exactly what TextDecoder and
+// Buffer.toString() replace.
+size_t Utf8Decode(const uint8_t* data, size_t len, uint32_t* cp);
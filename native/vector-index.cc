@@ -0,0 +1,355 @@
+#include <napi.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+#include "vector-ops.h"
+#include "vector-store.h"
+
+// Persistent flat vector index over FlatVectorStore (mmapped rows + id log)
+class VectorIndex : public Napi::ObjectWrap<VectorIndex> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    VectorIndex(const Napi::CallbackInfo& info);
+
+private:
+    static Napi::FunctionReference constructor;
+
+    // Insert or replace one vector / a batch of N x dims vectors
+    Napi::Value Add(const Napi::CallbackInfo& info);
+    Napi::Value AddMany(const Napi::CallbackInfo& info);
+
+    Napi::Value Remove(const Napi::CallbackInfo& info);
+    Napi::Value Has(const Napi::CallbackInfo& info);
+
+    // Best k ids for a query, optionally limited to a filter() bitmap
+    Napi::Value Search(const Napi::CallbackInfo& info);
+
+    // Slot bitmap for a set of ids, reusable across searches until the
+    // index changes
+    Napi::Value Filter(const Napi::CallbackInfo& info);
+
+    // Durability: msync + fsync / rewrite the log without dead records
+    Napi::Value Flush(const Napi::CallbackInfo& info);
+    Napi::Value Compact(const Napi::CallbackInfo& info);
+    Napi::Value Close(const Napi::CallbackInfo& info);
+
+    Napi::Value Size(const Napi::CallbackInfo& info);
+    Napi::Value Dims(const Napi::CallbackInfo& info);
+
+    // Throws unless the store is open
+    bool CheckOpen(Napi::Env env);
+
+    // Throws unless `value` is a Float32Array of `count * dims` floats
+    bool ReadVectors(Napi::Env env, const Napi::Value& value, size_t count, const float** out);
+
+    std::unique_ptr<FlatVectorStore> store_;
+};
+
+Napi::FunctionReference VectorIndex::constructor;
+
+Napi::Object VectorIndex::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "VectorIndex", {
+        InstanceMethod("add", &VectorIndex::Add),
+        InstanceMethod("addMany", &VectorIndex::AddMany),
+        InstanceMethod("remove", &VectorIndex::Remove),
+        InstanceMethod("has", &VectorIndex::Has),
+        InstanceMethod("search", &VectorIndex::Search),
+        InstanceMethod("filter", &VectorIndex::Filter),
+        InstanceMethod("flush", &VectorIndex::Flush),
+        InstanceMethod("compact", &VectorIndex::Compact),
+        InstanceMethod("close", &VectorIndex::Close),
+        InstanceAccessor("size", &VectorIndex::Size, nullptr),
+        InstanceAccessor("dims", &VectorIndex::Dims, nullptr),
+    });
+
+    constructor = Napi::Persistent(func);
+    constructor.SuppressDestruct();
+
+    exports.Set("VectorIndex", func);
+    return exports;
+}
+
+// new VectorIndex(path, { dims, type?: 'f32' | 'f16', metric?: 'cosine' | 'dot' | 'l2' })
+VectorIndex::VectorIndex(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<VectorIndex>(info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsString() || !info[1].IsObject()) {
+        Napi::TypeError::New(env, "Expected (path, { dims, type?, metric? })").ThrowAsJavaScriptException();
+        return;
+    }
+
+    std::string path = info[0].As<Napi::String>().Utf8Value();
+    Napi::Object options = info[1].As<Napi::Object>();
+
+    Napi::Value dims_value = options.Get("dims");
+    if (!dims_value.IsNumber() || dims_value.As<Napi::Number>().DoubleValue() < 1) {
+        Napi::TypeError::New(env, "dims must be a positive number").ThrowAsJavaScriptException();
+        return;
+    }
+    size_t dims = static_cast<size_t>(dims_value.As<Napi::Number>().Int64Value());
+
+    VectorElement type = VectorElement::kF32;
+    Napi::Value type_value = options.Get("type");
+    if (!type_value.IsUndefined()) {
+        std::string name = type_value.IsString() ? type_value.As<Napi::String>().Utf8Value() : "";
+        if (name == "f16") {
+            type = VectorElement::kF16;
+        } else if (name != "f32") {
+            Napi::TypeError::New(env, "type must be 'f32' or 'f16'").ThrowAsJavaScriptException();
+            return;
+        }
+    }
+
+    VectorMetric metric = VectorMetric::kCosine;
+    Napi::Value metric_value = options.Get("metric");
+    if (!metric_value.IsUndefined() &&
+        (!metric_value.IsString() || !ParseVectorMetric(metric_value.As<Napi::String>().Utf8Value(), &metric))) {
+        Napi::TypeError::New(env, "metric must be 'cosine', 'dot' or 'l2'").ThrowAsJavaScriptException();
+        return;
+    }
+
+    try {
+        store_ = std::make_unique<FlatVectorStore>(path, dims, type, metric);
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    }
+}
+
+bool VectorIndex::CheckOpen(Napi::Env env) {
+    if (!store_ || !store_->IsOpen()) {
+        Napi::Error::New(env, "VectorIndex is closed").ThrowAsJavaScriptException();
+        return false;
+    }
+    return true;
+}
+
+bool VectorIndex::ReadVectors(Napi::Env env, const Napi::Value& value, size_t count, const float** out) {
+    if (!value.IsTypedArray() || value.As<Napi::TypedArray>().TypedArrayType() != napi_float32_array) {
+        Napi::TypeError::New(env, "Expected Float32Array").ThrowAsJavaScriptException();
+        return false;
+    }
+    Napi::Float32Array array = value.As<Napi::Float32Array>();
+    if (array.ElementLength() != count * store_->Dims()) {
+        Napi::RangeError::New(env, "Vector length does not match dims").ThrowAsJavaScriptException();
+        return false;
+    }
+    *out = array.Data();
+    return true;
+}
+
+Napi::Value VectorIndex::Add(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected (id, vector)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    const float* vector;
+    if (!CheckOpen(env) || !ReadVectors(env, info[1], 1, &vector)) {
+        return env.Null();
+    }
+
+    try {
+        store_->Add(info[0].As<Napi::String>().Utf8Value(), vector);
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    }
+    return env.Undefined();
+}
+
+Napi::Value VectorIndex::AddMany(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsArray()) {
+        Napi::TypeError::New(env, "Expected (ids, vectors)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    if (!CheckOpen(env)) {
+        return env.Null();
+    }
+
+    Napi::Array list = info[0].As<Napi::Array>();
+    std::vector<std::string> ids;
+    ids.reserve(list.Length());
+    for (uint32_t i = 0; i < list.Length(); i++) {
+        Napi::Value item = list.Get(i);
+        if (!item.IsString()) {
+            Napi::TypeError::New(env, "ids must be strings").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        ids.push_back(item.As<Napi::String>().Utf8Value());
+    }
+
+    const float* vectors;
+    if (!ReadVectors(env, info[1], ids.size(), &vectors)) {
+        return env.Null();
+    }
+
+    try {
+        store_->AddMany(ids, vectors);
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    }
+    return env.Undefined();
+}
+
+Napi::Value VectorIndex::Remove(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected id").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    if (!CheckOpen(env)) {
+        return env.Null();
+    }
+
+    try {
+        return Napi::Boolean::New(env, store_->Remove(info[0].As<Napi::String>().Utf8Value()));
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+}
+
+Napi::Value VectorIndex::Has(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected id").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    if (!CheckOpen(env)) {
+        return env.Null();
+    }
+
+    return Napi::Boolean::New(env, store_->Has(info[0].As<Napi::String>().Utf8Value()));
+}
+
+// search(query: Float32Array, k, filter?: Uint8Array) -> { ids: string[], scores: Float32Array }
+Napi::Value VectorIndex::Search(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[1].IsNumber()) {
+        Napi::TypeError::New(env, "Expected (query, k, filter?)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    const float* query;
+    if (!CheckOpen(env) || !ReadVectors(env, info[0], 1, &query)) {
+        return env.Null();
+    }
+
+    double k = info[1].As<Napi::Number>().DoubleValue();
+    if (!(k >= 0)) {
+        Napi::RangeError::New(env, "Invalid k").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    const uint8_t* filter = nullptr;
+    size_t filter_bytes = 0;
+    if (info.Length() > 2 && !info[2].IsUndefined() && !info[2].IsNull()) {
+        if (!info[2].IsTypedArray() || info[2].As<Napi::TypedArray>().TypedArrayType() != napi_uint8_array) {
+            Napi::TypeError::New(env, "filter must be a Uint8Array from filter()").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        Napi::Uint8Array bitmap = info[2].As<Napi::Uint8Array>();
+        filter = bitmap.Data();
+        filter_bytes = bitmap.ElementLength();
+    }
+
+    size_t limit = static_cast<size_t>(std::min(k, static_cast<double>(store_->Size())));
+    std::vector<FlatVectorStore::Hit> hits = store_->Search(query, limit, filter, filter_bytes);
+
+    Napi::Array ids = Napi::Array::New(env, hits.size());
+    Napi::Float32Array scores = Napi::Float32Array::New(env, hits.size());
+    float* score_out = scores.Data();
+    for (size_t i = 0; i < hits.size(); i++) {
+        ids.Set(static_cast<uint32_t>(i), Napi::String::New(env, *hits[i].id));
+        score_out[i] = hits[i].score;
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("ids", ids);
+    result.Set("scores", scores);
+    return result;
+}
+
+Napi::Value VectorIndex::Filter(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsArray()) {
+        Napi::TypeError::New(env, "Expected ids").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    if (!CheckOpen(env)) {
+        return env.Null();
+    }
+
+    Napi::Array list = info[0].As<Napi::Array>();
+    std::vector<std::string> ids;
+    ids.reserve(list.Length());
+    for (uint32_t i = 0; i < list.Length(); i++) {
+        Napi::Value item = list.Get(i);
+        if (item.IsString()) {
+            ids.push_back(item.As<Napi::String>().Utf8Value());
+        }
+    }
+
+    std::vector<uint8_t> bitmap = store_->FilterFor(ids);
+    Napi::Uint8Array result = Napi::Uint8Array::New(env, bitmap.size());
+    if (!bitmap.empty()) {
+        std::memcpy(result.Data(), bitmap.data(), bitmap.size());
+    }
+    return result;
+}
+
+Napi::Value VectorIndex::Flush(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (!CheckOpen(env)) {
+        return env.Null();
+    }
+
+    try {
+        store_->Flush();
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    }
+    return env.Undefined();
+}
+
+Napi::Value VectorIndex::Compact(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (!CheckOpen(env)) {
+        return env.Null();
+    }
+
+    try {
+        store_->Compact();
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    }
+    return env.Undefined();
+}
+
+Napi::Value VectorIndex::Close(const Napi::CallbackInfo& info) {
+    store_.reset();
+    return info.Env().Undefined();
+}
+
+Napi::Value VectorIndex::Size(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), store_ ? static_cast<double>(store_->Size()) : 0);
+}
+
+Napi::Value VectorIndex::Dims(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), store_ ? static_cast<double>(store_->Dims()) : 0);
+}
+
+// Module initialization
+Napi::Object InitVectorIndex(Napi::Env env, Napi::Object exports) {
+    return VectorIndex::Init(env, exports);
+}
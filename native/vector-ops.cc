@@ -0,0 +1,459 @@
+#include "vector-ops.h"
+#include "cpu-features.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+
+#if defined(HAS_X86_SIMD)
+  #include <immintrin.h>  // x86 SIMD intrinsics
+#elif defined(HAS_ARM_SIMD)
+  #include <arm_neon.h>   // ARM NEON intrinsics
+#endif
+
+// Per-row partial sums; which fields are filled depends on the metric
+struct RowAccum {
+    float dot;  // kDot, kCosine
+    float rr;   // kCosine: squared row norm
+    float l2;   // kL2: squared distance
+};
+
+using RowKernel = RowAccum (*)(const float* query, const void* row, size_t dims, float scale);
+
+static const void* RowOffset(const void* row, size_t elems, VectorElement type) {
+    return static_cast<const uint8_t*>(row) + elems * VectorElementSize(type);
+}
+
+// ---------------------------------------------------------------------------
+// float16 conversion
+// ---------------------------------------------------------------------------
+
+float HalfToFloat(uint16_t half) {
+    uint32_t sign = static_cast<uint32_t>(half & 0x8000u) << 16;
+    uint32_t exp = (half >> 10) & 0x1f;
+    uint32_t mant = half & 0x3ff;
+
+    if (exp == 0) {
+        // Zero or subnormal: mant * 2^-24
+        float v = static_cast<float>(mant) * (1.0f / 16777216.0f);
+        return sign ? -v : v;
+    }
+
+    uint32_t bits;
+    if (exp == 31) {
+        // Inf, or NaN made quiet as F16C / FCVT do
+        bits = sign | 0x7f800000u | (mant ? 0x400000u | (mant << 13) : 0);
+    } else {
+        bits = sign | ((exp + 112) << 23) | (mant << 13);
+    }
+    float v;
+    std::memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+uint16_t FloatToHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000u);
+    uint32_t abs = bits & 0x7fffffffu;
+
+    if (abs >= 0x7f800000u) {
+        // Inf stays inf; NaN keeps its top payload bits and stays quiet
+        return sign | 0x7c00 | (abs > 0x7f800000u ? 0x200 | ((abs >> 13) & 0x3ff) : 0);
+    }
+    if (abs >= 0x477ff000u) {
+        // At or past the midpoint between 65504 and 65536
+        return sign | 0x7c00;
+    }
+
+    uint32_t exp = abs >> 23;
+    if (exp < 113) {
+        // Result is subnormal: round mant * 2^(exp - 126) to an integer
+        uint32_t shift = 126 - exp;
+        if (shift > 24) {
+            return sign;
+        }
+        uint32_t mant = (abs & 0x7fffffu) | (exp ? 0x800000u : 0);
+        uint32_t q = mant >> shift;
+        uint32_t rem = mant & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if (rem > halfway || (rem == halfway && (q & 1))) {
+            q++;
+        }
+        return static_cast<uint16_t>(sign | q);
+    }
+
+    uint32_t h = ((exp - 112) << 10) | ((abs >> 13) & 0x3ff);
+    uint32_t rem = abs & 0x1fff;
+    // A carry out of the mantissa correctly bumps the exponent
+    if (rem > 0x1000 || (rem == 0x1000 && (h & 1))) {
+        h++;
+    }
+    return static_cast<uint16_t>(sign | h);
+}
+
+void QuantizeRowsInt8(const float* src, size_t rows, size_t dims, int8_t* out, float* scales) {
+    for (size_t r = 0; r < rows; r++) {
+        const float* row = src + r * dims;
+        float max_abs = 0.0f;
+        for (size_t j = 0; j < dims; j++) {
+            max_abs = std::max(max_abs, std::fabs(row[j]));
+        }
+
+        float scale = max_abs / 127.0f;
+        float inv = max_abs > 0.0f ? 127.0f / max_abs : 0.0f;
+        for (size_t j = 0; j < dims; j++) {
+            float q = std::nearbyint(row[j] * inv);
+            out[r * dims + j] = static_cast<int8_t>(std::min(127.0f, std::max(-127.0f, q)));
+        }
+        scales[r] = scale;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Scalar reference implementations
+// ---------------------------------------------------------------------------
+
+template <VectorElement T>
+static inline float LoadScalar(const void* row, size_t j, float scale) {
+    if constexpr (T == VectorElement::kF32) {
+        float v;
+        std::memcpy(&v, static_cast<const uint8_t*>(row) + j * 4, sizeof(v));
+        return v;
+    } else if constexpr (T == VectorElement::kF16) {
+        uint16_t h;
+        std::memcpy(&h, static_cast<const uint8_t*>(row) + j * 2, sizeof(h));
+        return HalfToFloat(h);
+    } else {
+        return static_cast<float>(static_cast<const int8_t*>(row)[j]) * scale;
+    }
+}
+
+template <VectorMetric M, VectorElement T>
+static RowAccum RowScalar(const float* query, const void* row, size_t dims, float scale) {
+    RowAccum acc{0.0f, 0.0f, 0.0f};
+    for (size_t j = 0; j < dims; j++) {
+        float q = query[j];
+        float r = LoadScalar<T>(row, j, scale);
+        if constexpr (M == VectorMetric::kL2) {
+            float d = q - r;
+            acc.l2 += d * d;
+        } else {
+            acc.dot += q * r;
+            if constexpr (M == VectorMetric::kCosine) {
+                acc.rr += r * r;
+            }
+        }
+    }
+    return acc;
+}
+
+// ---------------------------------------------------------------------------
+// x86: AVX2 + FMA + F16C (8 floats per register)
+// ---------------------------------------------------------------------------
+
+#if defined(HAS_X86_DISPATCH)
+
+template <VectorElement T>
+OPENCLAW_TARGET("avx2,fma,f16c")
+static inline __m256 LoadAvx2(const void* row, size_t j, __m256 scale) {
+    if constexpr (T == VectorElement::kF32) {
+        return _mm256_loadu_ps(static_cast<const float*>(row) + j);
+    } else if constexpr (T == VectorElement::kF16) {
+        const uint16_t* p = static_cast<const uint16_t*>(row) + j;
+        return _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+    } else {
+        const int8_t* p = static_cast<const int8_t*>(row) + j;
+        __m256i wide = _mm256_cvtepi8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+        return _mm256_mul_ps(_mm256_cvtepi32_ps(wide), scale);
+    }
+}
+
+OPENCLAW_TARGET("avx2,fma,f16c")
+static inline float HorizontalSumAvx2(__m256 v) {
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_movehdup_ps(s));
+    return _mm_cvtss_f32(s);
+}
+
+template <VectorMetric M, VectorElement T>
+OPENCLAW_TARGET("avx2,fma,f16c")
+static RowAccum RowAvx2(const float* query, const void* row, size_t dims, float scale) {
+    const __m256 vscale = _mm256_set1_ps(scale);
+    __m256 a0 = _mm256_setzero_ps();  // dot or squared distance
+    __m256 a1 = _mm256_setzero_ps();
+    __m256 b0 = _mm256_setzero_ps();  // squared row norm (cosine)
+    __m256 b1 = _mm256_setzero_ps();
+    size_t j = 0;
+
+    // Two accumulator pairs hide the FMA latency
+    for (; j + 16 <= dims; j += 16) {
+        __m256 q0 = _mm256_loadu_ps(query + j);
+        __m256 q1 = _mm256_loadu_ps(query + j + 8);
+        __m256 r0 = LoadAvx2<T>(row, j, vscale);
+        __m256 r1 = LoadAvx2<T>(row, j + 8, vscale);
+        if constexpr (M == VectorMetric::kL2) {
+            __m256 d0 = _mm256_sub_ps(q0, r0);
+            __m256 d1 = _mm256_sub_ps(q1, r1);
+            a0 = _mm256_fmadd_ps(d0, d0, a0);
+            a1 = _mm256_fmadd_ps(d1, d1, a1);
+        } else {
+            a0 = _mm256_fmadd_ps(q0, r0, a0);
+            a1 = _mm256_fmadd_ps(q1, r1, a1);
+            if constexpr (M == VectorMetric::kCosine) {
+                b0 = _mm256_fmadd_ps(r0, r0, b0);
+                b1 = _mm256_fmadd_ps(r1, r1, b1);
+            }
+        }
+    }
+    for (; j + 8 <= dims; j += 8) {
+        __m256 q0 = _mm256_loadu_ps(query + j);
+        __m256 r0 = LoadAvx2<T>(row, j, vscale);
+        if constexpr (M == VectorMetric::kL2) {
+            __m256 d0 = _mm256_sub_ps(q0, r0);
+            a0 = _mm256_fmadd_ps(d0, d0, a0);
+        } else {
+            a0 = _mm256_fmadd_ps(q0, r0, a0);
+            if constexpr (M == VectorMetric::kCosine) {
+                b0 = _mm256_fmadd_ps(r0, r0, b0);
+            }
+        }
+    }
+
+    RowAccum acc = RowScalar<M, T>(query + j, RowOffset(row, j, T), dims - j, scale);
+    float a = HorizontalSumAvx2(_mm256_add_ps(a0, a1));
+    if constexpr (M == VectorMetric::kL2) {
+        acc.l2 += a;
+    } else {
+        acc.dot += a;
+        acc.rr += HorizontalSumAvx2(_mm256_add_ps(b0, b1));
+    }
+    return acc;
+}
+
+#endif  // HAS_X86_DISPATCH
+
+// ---------------------------------------------------------------------------
+// ARM: NEON (8 floats per step as two q registers)
+// ---------------------------------------------------------------------------
+
+#if defined(HAS_ARM_SIMD)
+
+template <VectorElement T>
+static inline void LoadNeon(const void* row, size_t j, float32x4_t scale, float32x4_t* lo, float32x4_t* hi) {
+    if constexpr (T == VectorElement::kF32) {
+        const float* p = static_cast<const float*>(row) + j;
+        *lo = vld1q_f32(p);
+        *hi = vld1q_f32(p + 4);
+    } else if constexpr (T == VectorElement::kF16) {
+        const uint16_t* p = static_cast<const uint16_t*>(row) + j;
+        float16x8_t h = vreinterpretq_f16_u16(vld1q_u16(p));
+        *lo = vcvt_f32_f16(vget_low_f16(h));
+        *hi = vcvt_high_f32_f16(h);
+    } else {
+        const int8_t* p = static_cast<const int8_t*>(row) + j;
+        int16x8_t w = vmovl_s8(vld1_s8(p));
+        *lo = vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(w))), scale);
+        *hi = vmulq_f32(vcvtq_f32_s32(vmovl_high_s16(w)), scale);
+    }
+}
+
+template <VectorMetric M, VectorElement T>
+static RowAccum RowNeon(const float* query, const void* row, size_t dims, float scale) {
+    const float32x4_t vscale = vdupq_n_f32(scale);
+    float32x4_t a0 = vdupq_n_f32(0.0f);
+    float32x4_t a1 = vdupq_n_f32(0.0f);
+    float32x4_t b0 = vdupq_n_f32(0.0f);
+    float32x4_t b1 = vdupq_n_f32(0.0f);
+    size_t j = 0;
+
+    for (; j + 8 <= dims; j += 8) {
+        float32x4_t q0 = vld1q_f32(query + j);
+        float32x4_t q1 = vld1q_f32(query + j + 4);
+        float32x4_t r0, r1;
+        LoadNeon<T>(row, j, vscale, &r0, &r1);
+        if constexpr (M == VectorMetric::kL2) {
+            float32x4_t d0 = vsubq_f32(q0, r0);
+            float32x4_t d1 = vsubq_f32(q1, r1);
+            a0 = vfmaq_f32(a0, d0, d0);
+            a1 = vfmaq_f32(a1, d1, d1);
+        } else {
+            a0 = vfmaq_f32(a0, q0, r0);
+            a1 = vfmaq_f32(a1, q1, r1);
+            if constexpr (M == VectorMetric::kCosine) {
+                b0 = vfmaq_f32(b0, r0, r0);
+                b1 = vfmaq_f32(b1, r1, r1);
+            }
+        }
+    }
+
+    RowAccum acc = RowScalar<M, T>(query + j, RowOffset(row, j, T), dims - j, scale);
+    float a = vaddvq_f32(vaddq_f32(a0, a1));
+    if constexpr (M == VectorMetric::kL2) {
+        acc.l2 += a;
+    } else {
+        acc.dot += a;
+        acc.rr += vaddvq_f32(vaddq_f32(b0, b1));
+    }
+    return acc;
+}
+
+#endif  // HAS_ARM_SIMD
+
+// ---------------------------------------------------------------------------
+// Runtime dispatch
+// ---------------------------------------------------------------------------
+
+// Indexed [metric][element type]
+#define VECTOR_KERNEL_ROW(Impl, M) \
+    {Impl<M, VectorElement::kF32>, Impl<M, VectorElement::kF16>, Impl<M, VectorElement::kInt8>}
+#define VECTOR_KERNEL_TABLE(Impl)                          \
+    {VECTOR_KERNEL_ROW(Impl, VectorMetric::kDot),          \
+     VECTOR_KERNEL_ROW(Impl, VectorMetric::kCosine),       \
+     VECTOR_KERNEL_ROW(Impl, VectorMetric::kL2)}
+
+static const RowKernel kScalarKernels[3][3] = VECTOR_KERNEL_TABLE(RowScalar);
+#if defined(HAS_X86_DISPATCH)
+static const RowKernel kAvx2Kernels[3][3] = VECTOR_KERNEL_TABLE(RowAvx2);
+#endif
+#if defined(HAS_ARM_SIMD)
+static const RowKernel kNeonKernels[3][3] = VECTOR_KERNEL_TABLE(RowNeon);
+#endif
+
+static const RowKernel (*row_kernels)[3] = kScalarKernels;
+
+static void SelectVectorKernels() {
+#if defined(HAS_X86_DISPATCH)
+    const CpuFeatures& cpu = GetCpuFeatures();
+    if (cpu.fma && cpu.f16c) {
+        row_kernels = kAvx2Kernels;
+    }
+#elif defined(HAS_ARM_SIMD)
+    row_kernels = kNeonKernels;
+#endif
+}
+
+bool ParseVectorMetric(const std::string& name, VectorMetric* metric) {
+    if (name == "cosine") {
+        *metric = VectorMetric::kCosine;
+    } else if (name == "dot") {
+        *metric = VectorMetric::kDot;
+    } else if (name == "l2") {
+        *metric = VectorMetric::kL2;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void InitVectorKernels() {
+    static std::once_flag once;
+    std::call_once(once, SelectVectorKernels);
+}
+
+// ---------------------------------------------------------------------------
+// Top-k selection
+// ---------------------------------------------------------------------------
+
+// -ffast-math lets the compiler assume std::isfinite is always true
+static bool IsFiniteScore(float v) {
+    uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    return (bits & 0x7f800000u) != 0x7f800000u;
+}
+
+// "a ranks ahead of b"; as a heap order it keeps the worst entry on top
+struct RanksAhead {
+    bool lower_is_better;
+
+    bool operator()(const ScoredRow& a, const ScoredRow& b) const {
+        if (a.score != b.score) {
+            return lower_is_better ? a.score < b.score : a.score > b.score;
+        }
+        return a.index < b.index;
+    }
+};
+
+static float FinishScore(const RowAccum& acc, VectorMetric metric, float queryNorm) {
+    switch (metric) {
+        case VectorMetric::kDot:
+            return acc.dot;
+        case VectorMetric::kCosine:
+            if (queryNorm == 0.0f || acc.rr == 0.0f) {
+                return 0.0f;
+            }
+            return acc.dot / (queryNorm * std::sqrt(acc.rr));
+        case VectorMetric::kL2:
+            return std::sqrt(acc.l2);
+    }
+    return 0.0f;
+}
+
+std::vector<ScoredRow> TopKRows(const float* query, const VectorMatrix& m, VectorMetric metric,
+                                size_t k, size_t begin, size_t end) {
+    std::vector<ScoredRow> heap;
+    if (k == 0 || begin >= end) {
+        return heap;
+    }
+    heap.reserve(std::min(k, end - begin));
+
+    RowKernel kernel = row_kernels[static_cast<int>(metric)][static_cast<int>(m.type)];
+    RanksAhead ahead{metric == VectorMetric::kL2};
+    size_t row_bytes = VectorRowStride(m);
+
+    float query_norm = 0.0f;
+    if (metric == VectorMetric::kCosine) {
+        for (size_t j = 0; j < m.dims; j++) {
+            query_norm += query[j] * query[j];
+        }
+        query_norm = std::sqrt(query_norm);
+    }
+
+    for (size_t i = begin; i < end; i++) {
+        if (m.mask != nullptr && !(m.mask[i >> 3] & (1u << (i & 7)))) {
+            continue;
+        }
+        const void* row = static_cast<const uint8_t*>(m.data) + i * row_bytes;
+        float scale = m.type == VectorElement::kInt8 ? m.scales[i] : 1.0f;
+        float score = FinishScore(kernel(query, row, m.dims, scale), metric, query_norm);
+        if (!IsFiniteScore(score)) {
+            continue;
+        }
+
+        ScoredRow entry{static_cast<uint32_t>(i), score};
+        if (heap.size() < k) {
+            heap.push_back(entry);
+            std::push_heap(heap.begin(), heap.end(), ahead);
+        } else if (ahead(entry, heap.front())) {
+            std::pop_heap(heap.begin(), heap.end(), ahead);
+            heap.back() = entry;
+            std::push_heap(heap.begin(), heap.end(), ahead);
+        }
+    }
+
+    std::sort_heap(heap.begin(), heap.end(), ahead);
+    return heap;
+}
+
+float VectorDot(const float* a, const float* b, size_t dims) {
+    return row_kernels[static_cast<int>(VectorMetric::kDot)][static_cast<int>(VectorElement::kF32)](a, b, dims, 1.0f).dot;
+}
+
+float VectorL2Squared(const float* a, const float* b, size_t dims) {
+    return row_kernels[static_cast<int>(VectorMetric::kL2)][static_cast<int>(VectorElement::kF32)](a, b, dims, 1.0f).l2;
+}
+
+std::vector<ScoredRow> MergeTopK(const std::vector<std::vector<ScoredRow>>& parts, VectorMetric metric, size_t k) {
+    std::vector<ScoredRow> all;
+    for (const std::vector<ScoredRow>& part : parts) {
+        all.insert(all.end(), part.begin(), part.end());
+    }
+
+    RanksAhead ahead{metric == VectorMetric::kL2};
+    size_t keep = std::min(k, all.size());
+    std::partial_sort(all.begin(), all.begin() + static_cast<ptrdiff_t>(keep), all.end(), ahead);
+    all.resize(keep);
+    return all;
+}
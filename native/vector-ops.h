@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Brute-force similarity scoring over a row-major N x D matrix.
+//
+// The query is float32; rows are float32, float16 (IEEE binary16 bits) or
+// int8 with one float32 scale per row (value = q * scale). Accumulation is
+// float32 throughout. AVX2+FMA+F16C and NEON kernels are picked at init,
+// everything else runs the scalar path.
+
+enum class VectorMetric { kDot, kCosine, kL2 };
+enum class VectorElement { kF32, kF16, kInt8 };
+
+struct VectorMatrix {
+    const void* data;
+    VectorElement type;
+    size_t rows;
+    size_t dims;
+    const float* scales;  // kInt8 only: one per row
+    size_t stride = 0;    // bytes between rows; 0 = packed
+    const uint8_t* mask = nullptr;  // optional bitmap: only rows with their bit set are scored
+};
+
+struct ScoredRow {
+    uint32_t index;
+    float score;
+};
+
+constexpr size_t VectorElementSize(VectorElement type) {
+    return type == VectorElement::kF32 ? 4 : type == VectorElement::kF16 ? 2 : 1;
+}
+
+inline size_t VectorRowStride(const VectorMatrix& m) {
+    return m.stride ? m.stride : m.dims * VectorElementSize(m.type);
+}
+
+// "cosine" | "dot" | "l2"; false for anything else.
+bool ParseVectorMetric(const std::string& name, VectorMetric* metric);
+
+// Pick kernels for this host. Idempotent; called from module init.
+void InitVectorKernels();
+
+// Scores are the dot product, cosine similarity (0 when either norm is 0,
+// like the JS cosineSimilarity) or Euclidean distance.
+//
+// Best k of rows [begin, end), best first: highest dot / cosine, lowest L2.
+// Ties go to the lower index; non-finite scores are dropped.
+std::vector<ScoredRow> TopKRows(const float* query, const VectorMatrix& m, VectorMetric metric,
+                                size_t k, size_t begin, size_t end);
+
+// Pairwise float32 kernels for graph indexes: a . b and |a - b|^2.
+float VectorDot(const float* a, const float* b, size_t dims);
+float VectorL2Squared(const float* a, const float* b, size_t dims);
+
+// Combines per-range TopKRows results into the overall best k.
+std::vector<ScoredRow> MergeTopK(const std::vector<std::vector<ScoredRow>>& parts, VectorMetric metric, size_t k);
+
+// Round-to-nearest-even float32 <-> binary16.
+uint16_t FloatToHalf(float value);
+float HalfToFloat(uint16_t half);
+
+// Symmetric per-row int8 quantization: scale = max|x| / 127.
+void QuantizeRowsInt8(const float* src, size_t rows, size_t dims, int8_t* out, float* scales);
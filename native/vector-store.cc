@@ -0,0 +1,510 @@
+#include "vector-store.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Files are written in host byte order; every supported target is
+// little-endian.
+
+static constexpr size_t kHeaderBytes = 4096;
+static constexpr size_t kSlotAlign = 64;
+static constexpr size_t kInitialSlots = 1024;
+static constexpr uint32_t kFormatVersion = 2;
+static constexpr char kMagic[8] = {'O', 'C', 'V', 'S', 'T', 'O', 'R', '\0'};
+
+// Log record: op, slot, id length, id bytes, checksum of everything before it
+static constexpr uint8_t kOpAdd = 'A';
+static constexpr uint8_t kOpRemove = 'R';
+static constexpr size_t kRecordFixed = 1 + 4 + 4 + 4;
+static constexpr uint32_t kMaxIdBytes = 64 * 1024;
+
+struct StoreHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t dims;
+    uint32_t type;
+    uint32_t stride;
+    uint64_t capacity;
+    uint32_t metric;
+};
+
+[[noreturn]] static void ThrowIoError(const char* what, const std::string& path) {
+    throw std::runtime_error(std::string(what) + " " + path + ": " + std::strerror(errno));
+}
+
+// Directory of `path`, for fsyncing a rename into it
+static std::string DirName(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    if (slash == std::string::npos) {
+        return ".";
+    }
+    return slash == 0 ? "/" : path.substr(0, slash);
+}
+
+static uint32_t Fnv1a(const uint8_t* data, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ data[i]) * 16777619u;
+    }
+    return h;
+}
+
+static void AppendRecord(std::string* out, uint8_t op, uint32_t slot, const std::string& id) {
+    size_t start = out->size();
+    uint32_t len = static_cast<uint32_t>(id.size());
+    out->push_back(static_cast<char>(op));
+    out->append(reinterpret_cast<const char*>(&slot), sizeof(slot));
+    out->append(reinterpret_cast<const char*>(&len), sizeof(len));
+    out->append(id);
+    uint32_t sum = Fnv1a(reinterpret_cast<const uint8_t*>(out->data() + start), out->size() - start);
+    out->append(reinterpret_cast<const char*>(&sum), sizeof(sum));
+}
+
+static void WriteAll(int fd, const char* data, size_t len, const std::string& path) {
+    while (len > 0) {
+        ssize_t n = ::write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ThrowIoError("write", path);
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+}
+
+FlatVectorStore::FlatVectorStore(const std::string& path, size_t dims, VectorElement type, VectorMetric metric)
+    : path_(path), dims_(dims), type_(type), metric_(metric) {
+    if (dims == 0 || dims > UINT32_MAX / 4) {
+        throw std::runtime_error("invalid vector dimension");
+    }
+    size_t row_bytes = dims * VectorElementSize(type);
+    stride_ = (row_bytes + kSlotAlign - 1) / kSlotAlign * kSlotAlign;
+
+    try {
+        data_fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (data_fd_ < 0) {
+            ThrowIoError("open", path);
+        }
+
+        struct stat st;
+        if (::fstat(data_fd_, &st) != 0) {
+            ThrowIoError("stat", path);
+        }
+
+        size_t capacity;
+        if (st.st_size == 0) {
+            capacity = kInitialSlots;
+            if (::ftruncate(data_fd_, static_cast<off_t>(kHeaderBytes + capacity * stride_)) != 0) {
+                ThrowIoError("resize", path);
+            }
+            MapData(capacity);
+            StoreHeader header{};
+            std::memcpy(header.magic, kMagic, sizeof(kMagic));
+            header.version = kFormatVersion;
+            header.dims = static_cast<uint32_t>(dims_);
+            header.type = static_cast<uint32_t>(type_);
+            header.stride = static_cast<uint32_t>(stride_);
+            header.capacity = capacity;
+            header.metric = static_cast<uint32_t>(metric_);
+            std::memcpy(map_, &header, sizeof(header));
+        } else {
+            StoreHeader header;
+            if (::pread(data_fd_, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+                std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kFormatVersion) {
+                throw std::runtime_error("not a vector store: " + path);
+            }
+            if (header.dims != dims_ || header.type != static_cast<uint32_t>(type_) || header.stride != stride_) {
+                throw std::runtime_error("vector store " + path + " has dims " + std::to_string(header.dims) +
+                                         " / type " + std::to_string(header.type) + ", expected " +
+                                         std::to_string(dims_) + " / " + std::to_string(static_cast<int>(type_)));
+            }
+            // Scores from another metric would rank the same rows differently
+            if (header.metric != static_cast<uint32_t>(metric_)) {
+                throw std::runtime_error("vector store " + path + " has metric " + std::to_string(header.metric) +
+                                         ", expected " + std::to_string(static_cast<int>(metric_)));
+            }
+            capacity = static_cast<size_t>(header.capacity);
+            if (static_cast<uint64_t>(st.st_size) < kHeaderBytes + capacity * stride_) {
+                throw std::runtime_error("vector store is truncated: " + path);
+            }
+            MapData(capacity);
+        }
+
+        std::string log_path = path_ + ".log";
+        log_fd_ = ::open(log_path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (log_fd_ < 0) {
+            ThrowIoError("open", log_path);
+        }
+        ReplayLog();
+    } catch (...) {
+        Close();
+        throw;
+    }
+}
+
+FlatVectorStore::~FlatVectorStore() {
+    Close();
+}
+
+void FlatVectorStore::Close() {
+    if (map_ != nullptr) {
+        ::munmap(map_, map_bytes_);
+        map_ = nullptr;
+        map_bytes_ = 0;
+    }
+    if (log_fd_ >= 0) {
+        ::close(log_fd_);
+        log_fd_ = -1;
+    }
+    if (data_fd_ >= 0) {
+        ::close(data_fd_);
+        data_fd_ = -1;
+    }
+    slots_.clear();
+    slot_ids_.clear();
+    free_slots_.clear();
+    live_.clear();
+}
+
+void FlatVectorStore::MapData(size_t capacity) {
+    if (map_ != nullptr) {
+        ::munmap(map_, map_bytes_);
+        map_ = nullptr;
+    }
+    map_bytes_ = kHeaderBytes + capacity * stride_;
+    void* p = ::mmap(nullptr, map_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, data_fd_, 0);
+    if (p == MAP_FAILED) {
+        map_bytes_ = 0;
+        ThrowIoError("mmap", path_);
+    }
+    map_ = static_cast<uint8_t*>(p);
+    capacity_ = capacity;
+}
+
+void FlatVectorStore::EnsureCapacity(size_t slots) {
+    if (slots <= capacity_) {
+        return;
+    }
+    size_t capacity = std::max(slots, capacity_ * 2);
+    if (::ftruncate(data_fd_, static_cast<off_t>(kHeaderBytes + capacity * stride_)) != 0) {
+        ThrowIoError("resize", path_);
+    }
+    MapData(capacity);
+    uint64_t stored = capacity;
+    std::memcpy(map_ + offsetof(StoreHeader, capacity), &stored, sizeof(stored));
+}
+
+uint8_t* FlatVectorStore::SlotData(uint32_t slot) const {
+    return map_ + kHeaderBytes + static_cast<size_t>(slot) * stride_;
+}
+
+void FlatVectorStore::SetLive(uint32_t slot, bool live) {
+    size_t byte = slot >> 3;
+    if (byte >= live_.size()) {
+        live_.resize(byte + 1, 0);
+    }
+    if (live) {
+        live_[byte] |= static_cast<uint8_t>(1u << (slot & 7));
+    } else {
+        live_[byte] &= static_cast<uint8_t>(~(1u << (slot & 7)));
+    }
+}
+
+uint32_t FlatVectorStore::TakeFreeSlot() {
+    if (!free_slots_.empty()) {
+        uint32_t slot = free_slots_.back();
+        free_slots_.pop_back();
+        return slot;
+    }
+    if (slot_ids_.size() >= UINT32_MAX) {
+        throw std::runtime_error("vector store is full");
+    }
+    uint32_t slot = static_cast<uint32_t>(slot_ids_.size());
+    EnsureCapacity(static_cast<size_t>(slot) + 1);
+    slot_ids_.push_back(nullptr);
+    return slot;
+}
+
+void FlatVectorStore::FreeSlot(uint32_t slot) {
+    slot_ids_[slot] = nullptr;
+    SetLive(slot, false);
+    free_slots_.push_back(slot);
+}
+
+void FlatVectorStore::WriteVector(uint32_t slot, const float* vector) {
+    uint8_t* dst = SlotData(slot);
+    if (type_ == VectorElement::kF16) {
+        uint16_t* out = reinterpret_cast<uint16_t*>(dst);
+        for (size_t j = 0; j < dims_; j++) {
+            out[j] = FloatToHalf(vector[j]);
+        }
+    } else {
+        std::memcpy(dst, vector, dims_ * sizeof(float));
+    }
+}
+
+void FlatVectorStore::AddOne(const std::string& id, const float* vector, std::string* log,
+                             std::vector<uint32_t>* replaced) {
+    // Never overwrite a logged vector: the new one goes to a free slot and
+    // the old slot is only released once this record is in the log.
+    uint32_t slot = TakeFreeSlot();
+    WriteVector(slot, vector);
+    AppendRecord(log, kOpAdd, slot, id);
+
+    auto it = slots_.find(id);
+    if (it != slots_.end()) {
+        replaced->push_back(it->second);
+        slot_ids_[it->second] = nullptr;
+        SetLive(it->second, false);
+        it->second = slot;
+    } else {
+        it = slots_.emplace(id, slot).first;
+    }
+    slot_ids_[slot] = &it->first;
+    SetLive(slot, true);
+}
+
+void FlatVectorStore::Add(const std::string& id, const float* vector) {
+    AddMany(std::vector<std::string>{id}, vector);
+}
+
+void FlatVectorStore::AddMany(const std::vector<std::string>& ids, const float* vectors) {
+    for (const std::string& id : ids) {
+        if (id.size() > kMaxIdBytes) {
+            throw std::runtime_error("vector id is too long");
+        }
+    }
+
+    std::string log;
+    std::vector<uint32_t> replaced;
+    try {
+        for (size_t i = 0; i < ids.size(); i++) {
+            AddOne(ids[i], vectors + i * dims_, &log, &replaced);
+        }
+    } catch (...) {
+        // Growing the file failed part way: keep the log in step with memory
+        AppendLog(log);
+        free_slots_.insert(free_slots_.end(), replaced.begin(), replaced.end());
+        throw;
+    }
+    AppendLog(log);
+    free_slots_.insert(free_slots_.end(), replaced.begin(), replaced.end());
+}
+
+bool FlatVectorStore::Remove(const std::string& id) {
+    auto it = slots_.find(id);
+    if (it == slots_.end()) {
+        return false;
+    }
+
+    uint32_t slot = it->second;
+    std::string log;
+    AppendRecord(&log, kOpRemove, slot, id);
+    AppendLog(log);
+
+    slots_.erase(it);
+    FreeSlot(slot);
+    return true;
+}
+
+void FlatVectorStore::AppendLog(const std::string& records) {
+    if (!records.empty()) {
+        WriteAll(log_fd_, records.data(), records.size(), path_ + ".log");
+    }
+}
+
+void FlatVectorStore::ReplayLog() {
+    struct stat st;
+    if (::fstat(log_fd_, &st) != 0) {
+        ThrowIoError("stat", path_ + ".log");
+    }
+
+    std::string buf(static_cast<size_t>(st.st_size), '\0');
+    size_t got = 0;
+    while (got < buf.size()) {
+        ssize_t n = ::pread(log_fd_, &buf[got], buf.size() - got, static_cast<off_t>(got));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            ThrowIoError("read", path_ + ".log");
+        }
+        got += static_cast<size_t>(n);
+    }
+
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(buf.data());
+    size_t pos = 0;
+    while (pos + kRecordFixed <= buf.size()) {
+        uint8_t op = p[pos];
+        uint32_t slot, len, sum;
+        std::memcpy(&slot, p + pos + 1, 4);
+        std::memcpy(&len, p + pos + 5, 4);
+        if (len > kMaxIdBytes || pos + kRecordFixed + len > buf.size()) {
+            break;
+        }
+        std::memcpy(&sum, p + pos + 9 + len, 4);
+        if (sum != Fnv1a(p + pos, 9 + len) || (op != kOpAdd && op != kOpRemove) || slot >= capacity_) {
+            break;
+        }
+
+        std::string id(reinterpret_cast<const char*>(p + pos + 9), len);
+        if (slot >= slot_ids_.size()) {
+            slot_ids_.resize(static_cast<size_t>(slot) + 1, nullptr);
+        }
+        auto it = slots_.find(id);
+        if (op == kOpAdd) {
+            const std::string* holder = slot_ids_[slot];
+            if (holder != nullptr && *holder != id) {
+                // Only a damaged log gets here; the newer record wins
+                slots_.erase(*holder);
+                if (it != slots_.end() && &it->first == holder) {
+                    it = slots_.end();
+                }
+            }
+            if (it != slots_.end()) {
+                slot_ids_[it->second] = nullptr;
+                it->second = slot;
+            } else {
+                it = slots_.emplace(std::move(id), slot).first;
+            }
+            slot_ids_[slot] = &it->first;
+        } else if (it != slots_.end() && it->second == slot) {
+            slot_ids_[slot] = nullptr;
+            slots_.erase(it);
+        }
+        pos += kRecordFixed + len;
+    }
+
+    // Drop a torn or corrupt tail so new records follow the last good one
+    if (pos < buf.size() && ::ftruncate(log_fd_, static_cast<off_t>(pos)) != 0) {
+        ThrowIoError("truncate", path_ + ".log");
+    }
+
+    live_.assign((slot_ids_.size() + 7) / 8, 0);
+    for (size_t slot = slot_ids_.size(); slot-- > 0;) {
+        if (slot_ids_[slot] != nullptr) {
+            SetLive(static_cast<uint32_t>(slot), true);
+        } else {
+            // Descending, so the lowest free slot is reused first
+            free_slots_.push_back(static_cast<uint32_t>(slot));
+        }
+    }
+}
+
+std::vector<FlatVectorStore::Hit> FlatVectorStore::Search(const float* query, size_t k, const uint8_t* filter,
+                                                          size_t filterBytes) const {
+    std::vector<Hit> hits;
+    size_t rows = slot_ids_.size();
+    if (rows == 0 || k == 0) {
+        return hits;
+    }
+
+    std::vector<uint8_t> combined;
+    const uint8_t* mask = live_.data();
+    if (filter != nullptr) {
+        combined.assign(live_.begin(), live_.end());
+        for (size_t i = 0; i < combined.size(); i++) {
+            combined[i] &= i < filterBytes ? filter[i] : 0;
+        }
+        mask = combined.data();
+    }
+
+    VectorMatrix m{SlotData(0), type_, rows, dims_, nullptr, stride_, mask};
+    std::vector<ScoredRow> best = TopKRows(query, m, metric_, k, 0, rows);
+    hits.reserve(best.size());
+    for (const ScoredRow& row : best) {
+        hits.push_back(Hit{slot_ids_[row.index], row.score});
+    }
+    return hits;
+}
+
+std::vector<uint8_t> FlatVectorStore::FilterFor(const std::vector<std::string>& ids) const {
+    std::vector<uint8_t> bitmap((slot_ids_.size() + 7) / 8, 0);
+    for (const std::string& id : ids) {
+        auto it = slots_.find(id);
+        if (it != slots_.end()) {
+            bitmap[it->second >> 3] |= static_cast<uint8_t>(1u << (it->second & 7));
+        }
+    }
+    return bitmap;
+}
+
+void FlatVectorStore::Flush() {
+    if (::msync(map_, map_bytes_, MS_SYNC) != 0) {
+        ThrowIoError("msync", path_);
+    }
+    // msync covers the pages but not a size grown by ftruncate
+    if (::fsync(data_fd_) != 0) {
+        ThrowIoError("fsync", path_);
+    }
+    if (::fsync(log_fd_) != 0) {
+        ThrowIoError("fsync", path_ + ".log");
+    }
+}
+
+void FlatVectorStore::Compact() {
+    std::string records;
+    for (size_t slot = 0; slot < slot_ids_.size(); slot++) {
+        if (slot_ids_[slot] != nullptr) {
+            AppendRecord(&records, kOpAdd, static_cast<uint32_t>(slot), *slot_ids_[slot]);
+        }
+    }
+
+    // Vectors must be durable before the only log naming them replaces the old one
+    if (::msync(map_, map_bytes_, MS_SYNC) != 0) {
+        ThrowIoError("msync", path_);
+    }
+    if (::fsync(data_fd_) != 0) {
+        ThrowIoError("fsync", path_);
+    }
+
+    std::string log_path = path_ + ".log";
+    std::string tmp_path = log_path + ".tmp";
+    int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        ThrowIoError("open", tmp_path);
+    }
+    try {
+        WriteAll(fd, records.data(), records.size(), tmp_path);
+        if (::fsync(fd) != 0) {
+            ThrowIoError("fsync", tmp_path);
+        }
+    } catch (...) {
+        ::close(fd);
+        ::unlink(tmp_path.c_str());
+        throw;
+    }
+    ::close(fd);
+
+    if (::rename(tmp_path.c_str(), log_path.c_str()) != 0) {
+        ThrowIoError("rename", tmp_path);
+    }
+    // The rename itself is only durable once the directory is synced
+    std::string dir = DirName(log_path);
+    int dir_fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd < 0) {
+        ThrowIoError("open", dir);
+    }
+    int synced = ::fsync(dir_fd);
+    ::close(dir_fd);
+    if (synced != 0) {
+        ThrowIoError("fsync", dir);
+    }
+    int new_fd = ::open(log_path.c_str(), O_RDWR | O_APPEND | O_CLOEXEC);
+    if (new_fd < 0) {
+        ThrowIoError("open", log_path);
+    }
+    ::close(log_fd_);
+    log_fd_ = new_fd;
+}
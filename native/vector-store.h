@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "vector-ops.h"
+
+// Persistent flat vector store keyed by string id.
+//
+// Two files back a store at `path`:
+//
+//   path      4 KiB header (dims, element type, metric), then fixed-size
+//             row slots (each 64-byte aligned) holding the vectors.
+//             Memory-mapped; grows by doubling.
+//   path.log  Append-only id <-> slot records. Replayed on open; a torn
+//             tail from a crash is detected by checksum and cut off.
+//
+// A vector is written to a free slot before its log record, and a slot is
+// only reused after the record that freed it, so a crash at any point
+// leaves every logged id pointing at its own complete vector. Reopening
+// maps the file and replays the log (ids only), without reading vectors.
+//
+// Not thread-safe. I/O and format errors throw std::runtime_error.
+
+class FlatVectorStore {
+public:
+    struct Hit {
+        const std::string* id;
+        float score;
+    };
+
+    // Opens `path` or creates it. An existing file must match dims, type
+    // and metric.
+    FlatVectorStore(const std::string& path, size_t dims, VectorElement type, VectorMetric metric);
+    ~FlatVectorStore();
+
+    FlatVectorStore(const FlatVectorStore&) = delete;
+    FlatVectorStore& operator=(const FlatVectorStore&) = delete;
+
+    // Inserts or replaces; vectors are `dims` floats each.
+    void Add(const std::string& id, const float* vector);
+    void AddMany(const std::vector<std::string>& ids, const float* vectors);
+
+    bool Remove(const std::string& id);
+    bool Has(const std::string& id) const { return slots_.count(id) != 0; }
+
+    size_t Size() const { return slots_.size(); }
+    size_t Dims() const { return dims_; }
+    VectorElement Type() const { return type_; }
+    VectorMetric Metric() const { return metric_; }
+
+    // Best k live entries. `filter` is an optional slot bitmap from
+    // FilterFor() of `filterBytes` bytes; it goes stale once ids are
+    // added or removed.
+    std::vector<Hit> Search(const float* query, size_t k, const uint8_t* filter, size_t filterBytes) const;
+
+    // Slot bitmap selecting `ids` (unknown ids are ignored).
+    std::vector<uint8_t> FilterFor(const std::vector<std::string>& ids) const;
+
+    // msync the rows, then fsync the data file (its size) and the log.
+    void Flush();
+
+    // Rewrites the log as one record per live id, durably.
+    void Compact();
+
+    void Close();
+    bool IsOpen() const { return data_fd_ >= 0; }
+
+private:
+    uint8_t* SlotData(uint32_t slot) const;
+    uint32_t TakeFreeSlot();
+    void FreeSlot(uint32_t slot);
+    void SetLive(uint32_t slot, bool live);
+    void EnsureCapacity(size_t slots);
+    void MapData(size_t capacity);
+    void WriteVector(uint32_t slot, const float* vector);
+    void AddOne(const std::string& id, const float* vector, std::string* log, std::vector<uint32_t>* replaced);
+    void AppendLog(const std::string& records);
+    void ReplayLog();
+
+    std::string path_;
+    size_t dims_;
+    VectorElement type_;
+    VectorMetric metric_;
+    size_t stride_;
+
+    int data_fd_ = -1;
+    int log_fd_ = -1;
+    uint8_t* map_ = nullptr;
+    size_t map_bytes_ = 0;
+    size_t capacity_ = 0;
+
+    std::unordered_map<std::string, uint32_t> slots_;
+    std::vector<const std::string*> slot_ids_;  // nullptr = free
+    std::vector<uint32_t> free_slots_;
+    std::vector<uint8_t> live_;                 // slot bitmap
+};
@@ -0,0 +1,465 @@
+#include <napi.h>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+#include "addon-data.h"
+#include "zstd-stream.h"
+
+// zstd contexts and dictionaries for JS. Each compressor / decompressor owns
+// one context that is reused for every frame it writes, and any number of
+// them can share one ZstdDictionary.
+
+static constexpr int kDefaultLevel = 3;
+// zstd's own recommendation: about 100x smaller than the samples, ~110 KiB
+static constexpr size_t kDefaultDictionarySize = 112640;
+
+static bool ReadBytes(Napi::Value value, const uint8_t** data, size_t* len) {
+    if (!value.IsTypedArray() || value.As<Napi::TypedArray>().TypedArrayType() != napi_uint8_array) {
+        return false;
+    }
+    Napi::Uint8Array bytes = value.As<Napi::Uint8Array>();
+    *data = bytes.Data();
+    *len = bytes.ByteLength();
+    return true;
+}
+
+// Throws and returns false unless value is undefined (keeps *level) or an
+// integer level zstd accepts
+static bool ReadLevel(Napi::Env env, Napi::Value value, int* level) {
+    if (value.IsUndefined()) {
+        return true;
+    }
+    double requested = value.IsNumber() ? value.As<Napi::Number>().DoubleValue() : NAN;
+    if (!(requested >= ZSTD_minCLevel() && requested <= ZSTD_maxCLevel()) || requested != std::floor(requested)) {
+        Napi::RangeError::New(env, "level must be an integer from " + std::to_string(ZSTD_minCLevel()) + " to " +
+                                       std::to_string(ZSTD_maxCLevel()))
+            .ThrowAsJavaScriptException();
+        return false;
+    }
+    *level = static_cast<int>(requested);
+    return true;
+}
+
+static Napi::Value ThrowZstdError(Napi::Env env, const std::string& error) {
+    Napi::Error::New(env, "zstd: " + error).ThrowAsJavaScriptException();
+    return env.Null();
+}
+
+// ---- ZstdDictionary ----
+
+class ZstdDictionary : public Napi::ObjectWrap<ZstdDictionary> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    ZstdDictionary(const Napi::CallbackInfo& info);
+
+    // Throws and returns false unless value is undefined (leaves *out null)
+    // or a ZstdDictionary
+    static bool Read(Napi::Env env, Napi::Value value, std::shared_ptr<const ZstdDict>* out);
+
+private:
+    // ZstdDictionary.train(samples, { size? }): dictionary bytes
+    static Napi::Value Train(const Napi::CallbackInfo& info);
+
+    Napi::Value Id(const Napi::CallbackInfo& info);
+    Napi::Value Level(const Napi::CallbackInfo& info);
+    Napi::Value Size(const Napi::CallbackInfo& info);
+
+    std::shared_ptr<const ZstdDict> dict_;
+};
+
+Napi::Object ZstdDictionary::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "ZstdDictionary", {
+        StaticMethod("train", &ZstdDictionary::Train),
+        InstanceAccessor("id", &ZstdDictionary::Id, nullptr),
+        InstanceAccessor("level", &ZstdDictionary::Level, nullptr),
+        InstanceAccessor("size", &ZstdDictionary::Size, nullptr),
+    });
+
+    GetAddonData(env)->zstd_dictionary = Napi::Persistent(func);
+
+    exports.Set("ZstdDictionary", func);
+    return exports;
+}
+
+// new ZstdDictionary(bytes, { level? }): digests trained (or raw content)
+// dictionary bytes once, for frames compressed at `level`
+ZstdDictionary::ZstdDictionary(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<ZstdDictionary>(info) {
+    Napi::Env env = info.Env();
+
+    const uint8_t* data;
+    size_t len;
+    if (info.Length() < 1 || !ReadBytes(info[0], &data, &len) || len == 0 ||
+        (info.Length() >= 2 && !info[1].IsObject())) {
+        Napi::TypeError::New(env, "Expected (bytes: Uint8Array, { level? })").ThrowAsJavaScriptException();
+        return;
+    }
+    int level = kDefaultLevel;
+    if (info.Length() >= 2 && !ReadLevel(env, info[1].As<Napi::Object>().Get("level"), &level)) {
+        return;
+    }
+
+    std::string error;
+    dict_ = ZstdDict::Create(data, len, level, &error);
+    if (!dict_) {
+        ThrowZstdError(env, error);
+    }
+}
+
+bool ZstdDictionary::Read(Napi::Env env, Napi::Value value, std::shared_ptr<const ZstdDict>* out) {
+    if (value.IsUndefined()) {
+        return true;
+    }
+    if (!value.IsObject() || !value.As<Napi::Object>().InstanceOf(GetAddonData(env)->zstd_dictionary.Value())) {
+        Napi::TypeError::New(env, "dictionary must be a ZstdDictionary").ThrowAsJavaScriptException();
+        return false;
+    }
+    *out = Unwrap(value.As<Napi::Object>())->dict_;
+    return true;
+}
+
+// samples is an array of Uint8Arrays, typically a few hundred records of
+// the kind the dictionary will compress
+Napi::Value ZstdDictionary::Train(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsArray() || (info.Length() >= 2 && !info[1].IsObject())) {
+        Napi::TypeError::New(env, "Expected (samples: Uint8Array[], { size? })").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    size_t capacity = kDefaultDictionarySize;
+    if (info.Length() >= 2) {
+        Napi::Value size = info[1].As<Napi::Object>().Get("size");
+        if (!size.IsUndefined()) {
+            double bytes = size.IsNumber() ? size.As<Napi::Number>().DoubleValue() : 0;
+            if (!(bytes >= 256 && bytes <= 16 * 1024 * 1024)) {
+                Napi::RangeError::New(env, "size must be between 256 bytes and 16 MiB").ThrowAsJavaScriptException();
+                return env.Null();
+            }
+            capacity = static_cast<size_t>(bytes);
+        }
+    }
+
+    // ZDICT wants the samples end to end
+    Napi::Array samples = info[0].As<Napi::Array>();
+    std::vector<uint8_t> joined;
+    std::vector<size_t> sizes;
+    sizes.reserve(samples.Length());
+    for (uint32_t i = 0; i < samples.Length(); i++) {
+        const uint8_t* data;
+        size_t len;
+        if (!ReadBytes(samples.Get(i), &data, &len)) {
+            Napi::TypeError::New(env, "samples must be Uint8Arrays").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        joined.insert(joined.end(), data, data + len);
+        sizes.push_back(len);
+    }
+
+    std::vector<uint8_t> dictionary;
+    std::string error;
+    if (!TrainZstdDictionary(joined.data(), sizes.data(), sizes.size(), capacity, &dictionary, &error)) {
+        return ThrowZstdError(env, error);
+    }
+    return Napi::Buffer<uint8_t>::Copy(env, dictionary.data(), dictionary.size());
+}
+
+Napi::Value ZstdDictionary::Id(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), dict_ ? dict_->id() : 0);
+}
+
+Napi::Value ZstdDictionary::Level(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), dict_ ? dict_->level() : 0);
+}
+
+Napi::Value ZstdDictionary::Size(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), dict_ ? static_cast<double>(dict_->size()) : 0);
+}
+
+// ---- ZstdCompressor ----
+
+// Streaming or one-shot compression through one reused context. push() may
+// return an empty buffer while zstd gathers a block; flush() forces out what
+// is buffered and end() closes the frame.
+class ZstdCompressor : public Napi::ObjectWrap<ZstdCompressor> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    ZstdCompressor(const Napi::CallbackInfo& info);
+
+private:
+    static Napi::FunctionReference constructor;
+
+    Napi::Value Push(const Napi::CallbackInfo& info);
+    Napi::Value Flush(const Napi::CallbackInfo& info);
+    Napi::Value End(const Napi::CallbackInfo& info);
+    Napi::Value Compress(const Napi::CallbackInfo& info);
+    Napi::Value Reset(const Napi::CallbackInfo& info);
+
+    Napi::Value Write(const Napi::CallbackInfo& info, ZstdCompressContext::Mode mode);
+
+    std::unique_ptr<ZstdCompressContext> context_;
+    // Reused for every call's output before it is copied out
+    std::vector<uint8_t> out_;
+};
+
+Napi::FunctionReference ZstdCompressor::constructor;
+
+Napi::Object ZstdCompressor::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "ZstdCompressor", {
+        InstanceMethod("push", &ZstdCompressor::Push),
+        InstanceMethod("flush", &ZstdCompressor::Flush),
+        InstanceMethod("end", &ZstdCompressor::End),
+        InstanceMethod("compress", &ZstdCompressor::Compress),
+        InstanceMethod("reset", &ZstdCompressor::Reset),
+    });
+
+    constructor = Napi::Persistent(func);
+    constructor.SuppressDestruct();
+
+    exports.Set("ZstdCompressor", func);
+    return exports;
+}
+
+// new ZstdCompressor({ level?, checksum?, dictionary? }); with a dictionary
+// the level is the dictionary's
+ZstdCompressor::ZstdCompressor(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<ZstdCompressor>(info) {
+    Napi::Env env = info.Env();
+
+    int level = kDefaultLevel;
+    bool checksum = false;
+    std::shared_ptr<const ZstdDict> dictionary;
+    if (info.Length() >= 1 && !info[0].IsUndefined()) {
+        if (!info[0].IsObject()) {
+            Napi::TypeError::New(env, "Expected ({ level?, checksum?, dictionary? })").ThrowAsJavaScriptException();
+            return;
+        }
+        Napi::Object options = info[0].As<Napi::Object>();
+        if (!ReadLevel(env, options.Get("level"), &level) ||
+            !ZstdDictionary::Read(env, options.Get("dictionary"), &dictionary)) {
+            return;
+        }
+        checksum = options.Get("checksum").ToBoolean().As<Napi::Boolean>().Value();
+    }
+    context_ = std::make_unique<ZstdCompressContext>(level, checksum, std::move(dictionary));
+}
+
+Napi::Value ZstdCompressor::Write(const Napi::CallbackInfo& info, ZstdCompressContext::Mode mode) {
+    Napi::Env env = info.Env();
+
+    const uint8_t* data = nullptr;
+    size_t len = 0;
+    if (info.Length() >= 1 && !info[0].IsUndefined() && !ReadBytes(info[0], &data, &len)) {
+        Napi::TypeError::New(env, "Expected (chunk: Uint8Array)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    out_.clear();
+    std::string error;
+    if (!context_->Write(data, len, mode, &out_, &error)) {
+        return ThrowZstdError(env, error);
+    }
+    return Napi::Buffer<uint8_t>::Copy(env, out_.data(), out_.size());
+}
+
+// push(chunk): compressed bytes ready so far
+Napi::Value ZstdCompressor::Push(const Napi::CallbackInfo& info) {
+    if (info.Length() < 1 || info[0].IsUndefined()) {
+        Napi::TypeError::New(info.Env(), "Expected (chunk: Uint8Array)").ThrowAsJavaScriptException();
+        return info.Env().Null();
+    }
+    return Write(info, ZstdCompressContext::Mode::kContinue);
+}
+
+// flush(): everything buffered, decodable up to here; the frame stays open
+Napi::Value ZstdCompressor::Flush(const Napi::CallbackInfo& info) {
+    return Write(info, ZstdCompressContext::Mode::kFlush);
+}
+
+// end(chunk?): the rest of the frame; the next push starts a new one
+Napi::Value ZstdCompressor::End(const Napi::CallbackInfo& info) {
+    return Write(info, ZstdCompressContext::Mode::kEnd);
+}
+
+// compress(buffer): buffer as one frame; discards an open streaming frame
+Napi::Value ZstdCompressor::Compress(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    const uint8_t* data;
+    size_t len;
+    if (info.Length() < 1 || !ReadBytes(info[0], &data, &len)) {
+        Napi::TypeError::New(env, "Expected (buffer: Uint8Array)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    out_.clear();
+    std::string error;
+    if (!context_->Compress(data, len, &out_, &error)) {
+        return ThrowZstdError(env, error);
+    }
+    return Napi::Buffer<uint8_t>::Copy(env, out_.data(), out_.size());
+}
+
+Napi::Value ZstdCompressor::Reset(const Napi::CallbackInfo& info) {
+    context_->Reset();
+    return info.Env().Undefined();
+}
+
+// ---- ZstdDecompressor ----
+
+class ZstdDecompressor : public Napi::ObjectWrap<ZstdDecompressor> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    ZstdDecompressor(const Napi::CallbackInfo& info);
+
+private:
+    static Napi::FunctionReference constructor;
+
+    Napi::Value Push(const Napi::CallbackInfo& info);
+    Napi::Value Decompress(const Napi::CallbackInfo& info);
+    Napi::Value Reset(const Napi::CallbackInfo& info);
+    Napi::Value Finished(const Napi::CallbackInfo& info);
+    Napi::Value More(const Napi::CallbackInfo& info);
+
+    std::unique_ptr<ZstdDecompressContext> context_;
+    std::vector<uint8_t> out_;
+    // Largest result of one push() or decompress()
+    size_t max_output_ = SIZE_MAX;
+};
+
+Napi::FunctionReference ZstdDecompressor::constructor;
+
+Napi::Object ZstdDecompressor::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "ZstdDecompressor", {
+        InstanceMethod("push", &ZstdDecompressor::Push),
+        InstanceMethod("decompress", &ZstdDecompressor::Decompress),
+        InstanceMethod("reset", &ZstdDecompressor::Reset),
+        InstanceAccessor("finished", &ZstdDecompressor::Finished, nullptr),
+        InstanceAccessor("more", &ZstdDecompressor::More, nullptr),
+    });
+
+    constructor = Napi::Persistent(func);
+    constructor.SuppressDestruct();
+
+    exports.Set("ZstdDecompressor", func);
+    return exports;
+}
+
+// new ZstdDecompressor({ dictionary?, windowLogMax?, maxOutput? })
+ZstdDecompressor::ZstdDecompressor(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<ZstdDecompressor>(info) {
+    Napi::Env env = info.Env();
+
+    int window_log_max = 0;
+    std::shared_ptr<const ZstdDict> dictionary;
+    if (info.Length() >= 1 && !info[0].IsUndefined()) {
+        if (!info[0].IsObject()) {
+            Napi::TypeError::New(env, "Expected ({ dictionary?, windowLogMax?, maxOutput? })")
+                .ThrowAsJavaScriptException();
+            return;
+        }
+        Napi::Object options = info[0].As<Napi::Object>();
+        if (!ZstdDictionary::Read(env, options.Get("dictionary"), &dictionary)) {
+            return;
+        }
+        Napi::Value windowLogMax = options.Get("windowLogMax");
+        if (!windowLogMax.IsUndefined()) {
+            double log = windowLogMax.IsNumber() ? windowLogMax.As<Napi::Number>().DoubleValue() : 0;
+            if (!(log >= 10 && log <= 31) || log != std::floor(log)) {
+                Napi::RangeError::New(env, "windowLogMax must be an integer from 10 to 31")
+                    .ThrowAsJavaScriptException();
+                return;
+            }
+            window_log_max = static_cast<int>(log);
+        }
+        Napi::Value maxOutput = options.Get("maxOutput");
+        if (!maxOutput.IsUndefined()) {
+            double bytes = maxOutput.IsNumber() ? maxOutput.As<Napi::Number>().DoubleValue() : 0;
+            if (!(bytes >= 1 && bytes <= 9007199254740991.0) || bytes != std::floor(bytes)) {
+                Napi::RangeError::New(env, "maxOutput must be a positive integer").ThrowAsJavaScriptException();
+                return;
+            }
+            max_output_ = static_cast<size_t>(bytes);
+        }
+    }
+    context_ = std::make_unique<ZstdDecompressContext>(window_log_max, std::move(dictionary));
+}
+
+// push(chunk?): the bytes chunk completes, at most maxOutput of them; frames
+// may span or share chunks. While `more` is true, push() without a chunk
+// returns the next slice.
+Napi::Value ZstdDecompressor::Push(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    const uint8_t* data = nullptr;
+    size_t len = 0;
+    if (info.Length() >= 1 && !info[0].IsUndefined() && !ReadBytes(info[0], &data, &len)) {
+        Napi::TypeError::New(env, "Expected (chunk?: Uint8Array)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    out_.clear();
+    std::string error;
+    if (!context_->Write(data, len, &out_, &error, max_output_)) {
+        return ThrowZstdError(env, error);
+    }
+    return Napi::Buffer<uint8_t>::Copy(env, out_.data(), out_.size());
+}
+
+// decompress(buffer): every frame in buffer; throws on a truncated one or
+// when it decodes to more than maxOutput bytes
+Napi::Value ZstdDecompressor::Decompress(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    const uint8_t* data;
+    size_t len;
+    if (info.Length() < 1 || !ReadBytes(info[0], &data, &len)) {
+        Napi::TypeError::New(env, "Expected (buffer: Uint8Array)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    out_.clear();
+    std::string error;
+    if (!context_->Decompress(data, len, &out_, &error, max_output_)) {
+        return ThrowZstdError(env, error);
+    }
+    return Napi::Buffer<uint8_t>::Copy(env, out_.data(), out_.size());
+}
+
+Napi::Value ZstdDecompressor::Reset(const Napi::CallbackInfo& info) {
+    context_->Reset();
+    return info.Env().Undefined();
+}
+
+// True when the input pushed so far ends on a frame boundary
+Napi::Value ZstdDecompressor::Finished(const Napi::CallbackInfo& info) {
+    return Napi::Boolean::New(info.Env(), context_->finished());
+}
+
+// True when the last push() stopped at maxOutput and push() has more to give
+Napi::Value ZstdDecompressor::More(const Napi::CallbackInfo& info) {
+    return Napi::Boolean::New(info.Env(), context_->more());
+}
+
+// isZstdFrame(buffer): whether buffer starts with a zstd frame header
+static Napi::Value IsZstd(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    const uint8_t* data;
+    size_t len;
+    if (info.Length() < 1 || !ReadBytes(info[0], &data, &len)) {
+        Napi::TypeError::New(env, "Expected (buffer: Uint8Array)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    return Napi::Boolean::New(env, IsZstdFrame(data, len));
+}
+
+// Module initialization
+Napi::Object InitZstdOps(Napi::Env env, Napi::Object exports) {
+    ZstdDictionary::Init(env, exports);
+    ZstdCompressor::Init(env, exports);
+    ZstdDecompressor::Init(env, exports);
+    exports.Set("isZstdFrame", Napi::Function::New<IsZstd>(env, "isZstdFrame"));
+    return exports;
+}
@@ -0,0 +1,247 @@
+#include "zstd-stream.h"
+
+#include <algorithm>
+
+#include <zdict.h>
+
+// ---- Dictionaries ----
+
+std::shared_ptr<const ZstdDict> ZstdDict::Create(const uint8_t* data, size_t len, int level,
+                                                 std::string* error) {
+    std::shared_ptr<ZstdDict> dictionary(new ZstdDict());
+    dictionary->cdict_ = ZSTD_createCDict(data, len, level);
+    dictionary->ddict_ = ZSTD_createDDict(data, len);
+    if (dictionary->cdict_ == nullptr || dictionary->ddict_ == nullptr) {
+        *error = "zstd rejected the dictionary";
+        return nullptr;
+    }
+    dictionary->id_ = ZSTD_getDictID_fromDict(data, len);
+    dictionary->level_ = level;
+    dictionary->size_ = len;
+    return dictionary;
+}
+
+ZstdDict::~ZstdDict() {
+    ZSTD_freeCDict(cdict_);
+    ZSTD_freeDDict(ddict_);
+}
+
+bool TrainZstdDictionary(const uint8_t* samples, const size_t* sizes, size_t count, size_t capacity,
+                         std::vector<uint8_t>* out, std::string* error) {
+    out->resize(capacity);
+    size_t size = ZDICT_trainFromBuffer(out->data(), capacity, samples, sizes, static_cast<unsigned>(count));
+    if (ZDICT_isError(size)) {
+        *error = ZDICT_getErrorName(size);
+        out->clear();
+        return false;
+    }
+    out->resize(size);
+    return true;
+}
+
+// ---- Compression ----
+
+ZstdCompressContext::ZstdCompressContext(int level, bool checksum, std::shared_ptr<const ZstdDict> dictionary)
+    : cctx_(ZSTD_createCCtx()), dictionary_(std::move(dictionary)) {
+    if (cctx_ == nullptr) {
+        init_error_ = "out of memory";
+        return;
+    }
+    size_t status = ZSTD_CCtx_setParameter(cctx_, ZSTD_c_compressionLevel, level);
+    if (!ZSTD_isError(status)) {
+        status = ZSTD_CCtx_setParameter(cctx_, ZSTD_c_checksumFlag, checksum ? 1 : 0);
+    }
+    if (!ZSTD_isError(status) && dictionary_) {
+        status = ZSTD_CCtx_refCDict(cctx_, dictionary_->cdict());
+    }
+    if (ZSTD_isError(status)) {
+        init_error_ = ZSTD_getErrorName(status);
+    }
+}
+
+ZstdCompressContext::~ZstdCompressContext() {
+    ZSTD_freeCCtx(cctx_);
+}
+
+bool ZstdCompressContext::Write(const uint8_t* data, size_t len, Mode mode, std::vector<uint8_t>* out,
+                                std::string* error) {
+    if (!init_error_.empty()) {
+        *error = init_error_;
+        return false;
+    }
+
+    ZSTD_EndDirective directive = mode == Mode::kEnd     ? ZSTD_e_end
+                                  : mode == Mode::kFlush ? ZSTD_e_flush
+                                                         : ZSTD_e_continue;
+    ZSTD_inBuffer input = {data, len, 0};
+    size_t chunk = ZSTD_CStreamOutSize();
+    for (;;) {
+        size_t used = out->size();
+        out->resize(used + chunk);
+        ZSTD_outBuffer output = {out->data() + used, chunk, 0};
+        size_t remaining = ZSTD_compressStream2(cctx_, &output, &input, directive);
+        out->resize(used + output.pos);
+        if (ZSTD_isError(remaining)) {
+            *error = ZSTD_getErrorName(remaining);
+            Reset();
+            return false;
+        }
+        // continue is done once input is taken; flush and end once zstd
+        // has nothing left to write
+        if (directive == ZSTD_e_continue ? input.pos == input.size : remaining == 0) {
+            return true;
+        }
+    }
+}
+
+bool ZstdCompressContext::Compress(const uint8_t* data, size_t len, std::vector<uint8_t>* out, std::string* error) {
+    if (!init_error_.empty()) {
+        *error = init_error_;
+        return false;
+    }
+
+    Reset();
+    size_t used = out->size();
+    out->resize(used + ZSTD_compressBound(len));
+    size_t size = ZSTD_compress2(cctx_, out->data() + used, out->size() - used, data, len);
+    if (ZSTD_isError(size)) {
+        *error = ZSTD_getErrorName(size);
+        out->resize(used);
+        Reset();
+        return false;
+    }
+    out->resize(used + size);
+    return true;
+}
+
+void ZstdCompressContext::Reset() {
+    if (cctx_ != nullptr) {
+        ZSTD_CCtx_reset(cctx_, ZSTD_reset_session_only);
+    }
+}
+
+// ---- Decompression ----
+
+ZstdDecompressContext::ZstdDecompressContext(int window_log_max, std::shared_ptr<const ZstdDict> dictionary)
+    : dctx_(ZSTD_createDCtx()), dictionary_(std::move(dictionary)) {
+    if (dctx_ == nullptr) {
+        init_error_ = "out of memory";
+        return;
+    }
+    size_t status = 0;
+    if (window_log_max != 0) {
+        status = ZSTD_DCtx_setParameter(dctx_, ZSTD_d_windowLogMax, window_log_max);
+    }
+    if (!ZSTD_isError(status) && dictionary_) {
+        status = ZSTD_DCtx_refDDict(dctx_, dictionary_->ddict());
+    }
+    if (ZSTD_isError(status)) {
+        init_error_ = ZSTD_getErrorName(status);
+    }
+}
+
+ZstdDecompressContext::~ZstdDecompressContext() {
+    ZSTD_freeDCtx(dctx_);
+}
+
+bool ZstdDecompressContext::Decode(ZSTD_inBuffer* input, std::vector<uint8_t>* out, size_t end,
+                                   std::string* error) {
+    size_t chunk = ZSTD_DStreamOutSize();
+    while (out->size() < end) {
+        size_t used = out->size();
+        size_t room = std::min(chunk, end - used);
+        out->resize(used + room);
+        ZSTD_outBuffer output = {out->data() + used, room, 0};
+        size_t hint = ZSTD_decompressStream(dctx_, &output, input);
+        out->resize(used + output.pos);
+        if (ZSTD_isError(hint)) {
+            *error = ZSTD_getErrorName(hint);
+            Reset();
+            return false;
+        }
+        // 0 means a frame ended and all of it is flushed; otherwise a full
+        // output buffer may mean zstd still holds decoded bytes. (Calling
+        // again after a frame ended exactly at the end of the buffer would
+        // report the next frame as started.)
+        finished_ = hint == 0;
+        drained_ = finished_ || output.pos < output.size;
+        if (input->pos == input->size && drained_) {
+            break;
+        }
+    }
+    return true;
+}
+
+bool ZstdDecompressContext::Write(const uint8_t* data, size_t len, std::vector<uint8_t>* out, std::string* error,
+                                  size_t limit) {
+    if (!init_error_.empty()) {
+        *error = init_error_;
+        return false;
+    }
+    size_t end = limit > SIZE_MAX - out->size() ? SIZE_MAX : out->size() + limit;
+
+    if (more()) {
+        ZSTD_inBuffer input = {held_.data(), held_.size(), 0};
+        if (!Decode(&input, out, end, error)) {
+            return false;
+        }
+        held_.erase(held_.begin(), held_.begin() + input.pos);
+        if (more()) {
+            // Still backed up: the new data waits behind what is held
+            held_.insert(held_.end(), data, data + len);
+            return true;
+        }
+    }
+    if (len == 0) {
+        return true;
+    }
+
+    ZSTD_inBuffer input = {data, len, 0};
+    if (!Decode(&input, out, end, error)) {
+        return false;
+    }
+    held_.assign(data + input.pos, data + len);
+    return true;
+}
+
+bool ZstdDecompressContext::Decompress(const uint8_t* data, size_t len, std::vector<uint8_t>* out,
+                                       std::string* error, size_t limit) {
+    Reset();
+    size_t used = out->size();
+    // One byte past the limit tells "exactly limit bytes" from "more"
+    if (!Write(data, len, out, error, limit == SIZE_MAX ? limit : limit + 1)) {
+        out->resize(used);
+        return false;
+    }
+    if (out->size() - used > limit) {
+        *error = "output exceeds " + std::to_string(limit) + " bytes";
+        out->resize(used);
+        Reset();
+        return false;
+    }
+    if (!finished_) {
+        *error = "truncated zstd frame";
+        out->resize(used);
+        Reset();
+        return false;
+    }
+    return true;
+}
+
+void ZstdDecompressContext::Reset() {
+    if (dctx_ != nullptr) {
+        ZSTD_DCtx_reset(dctx_, ZSTD_reset_session_only);
+    }
+    finished_ = true;
+    drained_ = true;
+    held_.clear();
+}
+
+bool IsZstdFrame(const uint8_t* data, size_t len) {
+    if (len < 4) {
+        return false;
+    }
+    uint32_t magic = static_cast<uint32_t>(data[0]) | static_cast<uint32_t>(data[1]) << 8 |
+                     static_cast<uint32_t>(data[2]) << 16 | static_cast<uint32_t>(data[3]) << 24;
+    return magic == ZSTD_MAGICNUMBER || (magic & ZSTD_MAGIC_SKIPPABLE_MASK) == ZSTD_MAGIC_SKIPPABLE_START;
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <zstd.h>
+
+// Reusable zstd contexts and dictionaries. N-API free.
+//
+// Built only against libzstd (OPENCLAW_HAVE_ZSTD). A context keeps its
+// allocations across frames, and a dictionary is digested once and then
+// referenced by any number of contexts, which is what makes small session
+// records worth compressing at all. Errors are returned as strings, never
+// thrown.
+
+// Digested compression and decompression tables for one dictionary. The
+// compression level is fixed here: frames made with a dictionary use its level.
+class ZstdDict {
+public:
+    // Null with `error` set when zstd rejects the bytes
+    static std::shared_ptr<const ZstdDict> Create(const uint8_t* data, size_t len, int level,
+                                                  std::string* error);
+    ~ZstdDict();
+
+    ZstdDict(const ZstdDict&) = delete;
+    ZstdDict& operator=(const ZstdDict&) = delete;
+
+    // 0 for raw-content dictionaries (not made by the trainer)
+    uint32_t id() const { return id_; }
+    int level() const { return level_; }
+    size_t size() const { return size_; }
+    const ZSTD_CDict* cdict() const { return cdict_; }
+    const ZSTD_DDict* ddict() const { return ddict_; }
+
+private:
+    ZstdDict() = default;
+
+    ZSTD_CDict* cdict_ = nullptr;
+    ZSTD_DDict* ddict_ = nullptr;
+    uint32_t id_ = 0;
+    int level_ = 0;
+    size_t size_ = 0;
+};
+
+// Trains a dictionary of at most `capacity` bytes from `count` samples laid
+// end to end in `samples`. Wants at least a few dozen samples; false with
+// `error` set when there is too little to learn from.
+bool TrainZstdDictionary(const uint8_t* samples, const size_t* sizes, size_t count, size_t capacity,
+                         std::vector<uint8_t>* out, std::string* error);
+
+class ZstdCompressContext {
+public:
+    enum class Mode {
+        kContinue,  // buffer input; emit only whole blocks
+        kFlush,     // emit everything buffered, frame stays open
+        kEnd,       // close the frame; the next write starts a new one
+    };
+
+    // level is ignored when a dictionary is given
+    ZstdCompressContext(int level, bool checksum, std::shared_ptr<const ZstdDict> dictionary);
+    ~ZstdCompressContext();
+
+    ZstdCompressContext(const ZstdCompressContext&) = delete;
+    ZstdCompressContext& operator=(const ZstdCompressContext&) = delete;
+
+    // Feeds data[0, len) and appends whatever output zstd produces to `out`.
+    bool Write(const uint8_t* data, size_t len, Mode mode, std::vector<uint8_t>* out, std::string* error);
+
+    // data as one complete frame, appended to `out`; discards any open frame
+    bool Compress(const uint8_t* data, size_t len, std::vector<uint8_t>* out, std::string* error);
+
+    // Drops an open frame; parameters and dictionary are kept
+    void Reset();
+
+private:
+    ZSTD_CCtx* cctx_;
+    std::shared_ptr<const ZstdDict> dictionary_;
+    std::string init_error_;
+};
+
+class ZstdDecompressContext {
+public:
+    // window_log_max bounds the memory a hostile frame can make us allocate
+    // (2^window_log_max bytes); 0 keeps zstd's default of 2^27
+    ZstdDecompressContext(int window_log_max, std::shared_ptr<const ZstdDict> dictionary);
+    ~ZstdDecompressContext();
+
+    ZstdDecompressContext(const ZstdDecompressContext&) = delete;
+    ZstdDecompressContext& operator=(const ZstdDecompressContext&) = delete;
+
+    // Feeds data[0, len), which may hold several frames or split one
+    // anywhere, and appends at most `limit` decoded bytes to `out`. Input
+    // that would decode past the limit is held and goes first on the next
+    // call, which may pass no data at all; more() says whether any waits.
+    bool Write(const uint8_t* data, size_t len, std::vector<uint8_t>* out, std::string* error,
+               size_t limit = SIZE_MAX);
+
+    // All frames in data[0, len), which must end on a frame boundary and
+    // decode to at most `limit` bytes
+    bool Decompress(const uint8_t* data, size_t len, std::vector<uint8_t>* out, std::string* error,
+                    size_t limit = SIZE_MAX);
+
+    // True when the input so far ends exactly on a frame boundary
+    bool finished() const { return finished_ && held_.empty(); }
+
+    // True when the last Write stopped at its limit with output still to come
+    bool more() const { return !held_.empty() || !drained_; }
+
+    void Reset();
+
+private:
+    // Decodes `input` until it is used up and zstd holds nothing back, or
+    // until `out` has grown to `end` bytes
+    bool Decode(ZSTD_inBuffer* input, std::vector<uint8_t>* out, size_t end, std::string* error);
+
+    ZSTD_DCtx* dctx_;
+    std::shared_ptr<const ZstdDict> dictionary_;
+    std::string init_error_;
+    bool finished_ = true;
+    // False when zstd filled the last output buffer and may hold more
+    bool drained_ = true;
+    // Input not decoded yet because a Write hit its limit
+    std::vector<uint8_t> held_;
+};
+
+// True when data starts with a zstd frame (or skippable frame) magic number
+bool IsZstdFrame(const uint8_t* data, size_t len);
@@ -0,0 +1,132 @@
+#!/usr/bin/env node
+/**
+ * Recall / latency of the native HNSW index against the exact linear scan
+ * that memory search uses without it.
+ *
+ *   node scripts/bench-hnsw.mjs [--n 200000] [--dims 384] [--queries 200] [--k 10]
+ *
+ * Embeddings are synthetic: unit vectors scattered around random cluster
+ * centres, which is closer to real text embeddings than uniform noise.
+ */
+
+import { createRequire } from 'node:module';
+import { performance } from 'node:perf_hooks';
+
+const require = createRequire(import.meta.url);
+
+function arg(name, fallback) {
+  const i = process.argv.indexOf(`--${name}`);
+  return i > 0 ? Number(process.argv[i + 1]) : fallback;
+}
+
+const N = arg('n', 200_000);
+const DIMS = arg('dims', 384);
+const QUERIES = arg('queries', 200);
+const K = arg('k', 10);
+const CLUSTERS = Math.max(1, Math.round(Math.sqrt(N)));
+
+let native;
+try {
+  native = require('../native/build/Release/openclaw_native.node');
+} catch {
+  console.log('⚠️  Native addon not built yet. Run: pnpm build:native');
+  process.exit(1);
+}
+
+// Deterministic normal samples (xorshift + Box-Muller)
+let seed = 0x9e3779b9;
+function uniform() {
+  seed ^= seed << 13;
+  seed ^= seed >>> 17;
+  seed ^= seed << 5;
+  return ((seed >>> 0) + 0.5) / 4294967296;
+}
+function normal() {
+  return Math.sqrt(-2 * Math.log(uniform())) * Math.cos(2 * Math.PI * uniform());
+}
+
+function sample(centres, out, offset) {
+  const c = Math.floor(uniform() * CLUSTERS) * DIMS;
+  let norm = 0;
+  for (let j = 0; j < DIMS; j++) {
+    const v = centres[c + j] + 0.35 * normal();
+    out[offset + j] = v;
+    norm += v * v;
+  }
+  norm = Math.sqrt(norm);
+  for (let j = 0; j < DIMS; j++) {
+    out[offset + j] /= norm;
+  }
+}
+
+const centres = new Float32Array(CLUSTERS * DIMS).map(() => normal() / Math.sqrt(DIMS) * 4);
+const data = new Float32Array(N * DIMS);
+for (let i = 0; i < N; i++) {
+  sample(centres, data, i * DIMS);
+}
+const queries = new Float32Array(QUERIES * DIMS);
+for (let i = 0; i < QUERIES; i++) {
+  sample(centres, queries, i * DIMS);
+}
+const ids = Array.from({ length: N }, (_, i) => `chunk-${i}`);
+const query = (i) => queries.subarray(i * DIMS, (i + 1) * DIMS);
+
+function percentile(sorted, p) {
+  return sorted[Math.min(sorted.length - 1, Math.floor(sorted.length * p))];
+}
+
+function report(label, times, recall) {
+  times.sort((a, b) => a - b);
+  const p50 = percentile(times, 0.5).toFixed(3);
+  const p95 = percentile(times, 0.95).toFixed(3);
+  const r = recall === undefined ? '    -' : recall.toFixed(3);
+  console.log(`${label.padEnd(28)} recall@${K} ${r}   p50 ${p50} ms   p95 ${p95} ms`);
+}
+
+console.log(`${N} vectors x ${DIMS} dims, ${QUERIES} queries, k=${K}\n`);
+
+// Exact answers double as the linear-path timing
+const truth = [];
+const linear = [];
+for (let i = 0; i < QUERIES; i++) {
+  const t = performance.now();
+  const result = native.topK(query(i), data, K);
+  linear.push(performance.now() - t);
+  truth.push(new Set(Array.from(result.indices, (index) => ids[index])));
+}
+report('linear scan (native SIMD)', linear);
+
+const js = [];
+for (let i = 0; i < Math.min(QUERIES, 20); i++) {
+  const q = query(i);
+  const t = performance.now();
+  const scores = new Float32Array(N);
+  for (let r = 0; r < N; r++) {
+    let dot = 0;
+    for (let j = 0; j < DIMS; j++) {
+      dot += q[j] * data[r * DIMS + j];
+    }
+    scores[r] = dot;
+  }
+  Array.from(scores.keys()).sort((a, b) => scores[b] - scores[a]).slice(0, K);
+  js.push(performance.now() - t);
+}
+report('linear scan (JS)', js);
+
+const index = new native.HnswIndex({ dims: DIMS, metric: 'cosine', m: 16, efConstruction: 200 });
+const buildStart = performance.now();
+await index.addManyAsync(ids, data);
+const buildMs = performance.now() - buildStart;
+console.log(`\nHNSW build: ${(buildMs / 1000).toFixed(1)} s (${Math.round(N / (buildMs / 1000))} vectors/s)\n`);
+
+for (const ef of [16, 32, 64, 128, 256]) {
+  const times = [];
+  let hits = 0;
+  for (let i = 0; i < QUERIES; i++) {
+    const t = performance.now();
+    const result = index.search(query(i), K, ef);
+    times.push(performance.now() - t);
+    hits += result.ids.filter((id) => truth[i].has(id)).length;
+  }
+  report(`hnsw efSearch=${ef}`, times, hits / (QUERIES * K));
+}
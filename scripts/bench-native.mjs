@@ -0,0 +1,312 @@
+#!/usr/bin/env node
+/**
+ * Regression suite for the native addon: every buffer export against the
+ * JS path src/ultra.ts (or its caller) takes without it.
+ *
+ *   node scripts/bench-native.mjs [--max 1073741824] [--time 200] [--only sumUint8]
+ *                                 [--tolerance 0.25] [--update-baseline] [--check]
+ *
+ * Sizes grow x16 from 64 B to --max. Each cell checks that native and JS
+ * agree, then reports ns/call and GB/s for both. The run fails when
+ *   - a native result differs from the fallback (a broken SIMD branch),
+ *   - native is slower than the fallback at a size where it is used, or
+ *   - native is more than --tolerance slower than the stored baseline.
+ *
+ * Baselines live in native/bench-baseline.json, keyed by CPU model and SIMD
+ * level so numbers from one machine are never held against another.
+ * --check only runs the agreement checks, without timing, for tests. The
+ * C++ kernels have their own Google Benchmark binary; see native/native-bench.cc.
+ */
+
+import { createRequire } from 'node:module';
+import { readFileSync, writeFileSync } from 'node:fs';
+import { cpus } from 'node:os';
+import { dirname, join } from 'node:path';
+import { performance } from 'node:perf_hooks';
+import { fileURLToPath } from 'node:url';
+
+const require = createRequire(import.meta.url);
+const root = join(dirname(fileURLToPath(import.meta.url)), '..');
+const baselinePath = join(root, 'native', 'bench-baseline.json');
+
+function arg(name, fallback) {
+  const i = process.argv.indexOf(`--${name}`);
+  return i > 0 ? process.argv[i + 1] : fallback;
+}
+
+const MAX_BYTES = Number(arg('max', 1 << 30));
+const TIME_MS = Number(arg('time', 200));
+const TOLERANCE = Number(arg('tolerance', 0.25));
+const ONLY = arg('only', null);
+const UPDATE = process.argv.includes('--update-baseline');
+const CHECK = process.argv.includes('--check');
+
+let native;
+try {
+  native = require('../native/build/Release/openclaw_native.node');
+} catch {
+  console.log('⚠️  Native addon not built yet. Run: pnpm build:native');
+  process.exit(1);
+}
+
+// Deterministic text-like bytes: mostly lower-case letters and spaces, so
+// pattern searches see realistic skip distances
+let seed = 0x9e3779b9;
+function fill(buf) {
+  for (let i = 0; i < buf.length; i++) {
+    seed ^= seed << 13;
+    seed ^= seed >>> 17;
+    seed ^= seed << 5;
+    const r = (seed >>> 0) % 32;
+    buf[i] = r < 26 ? 97 + r : r < 31 ? 32 : 10;
+  }
+  return buf;
+}
+
+const sizes = [];
+for (let size = 64; size <= MAX_BYTES; size *= 16) {
+  sizes.push(size);
+}
+const largest = fill(Buffer.allocUnsafe(sizes.at(-1)));
+const needle = Buffer.from('zqxjk');
+
+function cosine(a, ai, b, bi, dims) {
+  let dot = 0;
+  let normA = 0;
+  let normB = 0;
+  for (let j = 0; j < dims; j++) {
+    dot += a[ai + j] * b[bi + j];
+    normA += a[ai + j] * a[ai + j];
+    normB += b[bi + j] * b[bi + j];
+  }
+  return normA === 0 || normB === 0 ? 0 : dot / (Math.sqrt(normA) * Math.sqrt(normB));
+}
+
+const DIMS = 384;
+const vectors = (size) => {
+  const rows = Math.max(1, Math.floor(size / (DIMS * 4)));
+  const matrix = new Float32Array(rows * DIMS);
+  for (let i = 0; i < matrix.length; i++) {
+    matrix[i] = (largest[i % largest.length] - 96) / 32;
+  }
+  return { matrix, query: matrix.slice(0, DIMS), rows };
+};
+
+// The first n bytes and a copy differing only in its last byte, so compares
+// cannot stop early
+function pair(n) {
+  const copy = Buffer.from(largest.subarray(0, n));
+  copy[n - 1] ^= 1;
+  return [largest.subarray(0, n), copy];
+}
+
+// setup(size) returns the arguments shared by both sides. minBytes mirrors
+// the size below which ultra.ts keeps the JS path, so only sizes at or
+// above it can fail for being slower; ungated exports are held to it from
+// 16 KiB, below which the ~150 ns N-API call dominates.
+const MIN_BYTES = 16 * 1024;
+const cases = [
+  {
+    name: 'compare',
+    minBytes: 256 * 1024,
+    setup: pair,
+    native: (a, b) => native.compare(a, b),
+    fallback: (a, b) => a.compare(b),
+  },
+  {
+    // memcpy on both sides; only worth the call for large copies
+    name: 'bulkCopy',
+    minBytes: 256 * 1024,
+    setup: (n) => [largest.subarray(0, n), Buffer.allocUnsafe(n)],
+    native: (source, target) => (native.bulkCopy(source, target), target[target.length - 1]),
+    fallback: (source, target) => (source.copy(target), target[target.length - 1]),
+  },
+  {
+    name: 'sumUint8',
+    setup: (n) => [largest.subarray(0, n)],
+    native: (buf) => native.sumUint8(buf),
+    fallback: (buf) => {
+      let sum = 0;
+      for (let i = 0; i < buf.length; i++) {
+        sum += buf[i];
+      }
+      return sum;
+    },
+  },
+  {
+    name: 'findPattern',
+    setup: (n) => [largest.subarray(0, n), needle],
+    native: (hay, pat) => native.findPattern(hay, pat),
+    fallback: (hay, pat) => hay.indexOf(pat),
+  },
+  {
+    name: 'count',
+    setup: (n) => [largest.subarray(0, n), needle],
+    native: (hay, pat) => native.count(hay, pat),
+    fallback: (hay, pat) => {
+      let hits = 0;
+      for (let i = hay.indexOf(pat); i !== -1; i = hay.indexOf(pat, i + pat.length)) {
+        hits++;
+      }
+      return hits;
+    },
+  },
+  {
+    name: 'findAll',
+    setup: (n) => [largest.subarray(0, n), Buffer.from(' a')],
+    native: (hay, pat) => Array.from(native.findAll(hay, pat)).join(),
+    fallback: (hay, pat) => {
+      const hits = [];
+      for (let i = hay.indexOf(pat); i !== -1; i = hay.indexOf(pat, i + pat.length)) {
+        hits.push(i);
+      }
+      return hits.join();
+    },
+    maxBytes: 64 << 20,
+  },
+  {
+    name: 'andBuffers',
+    setup: pair,
+    native: (a, b) => native.andBuffers(a, b).toString('latin1', a.length - 64),
+    fallback: (a, b) => {
+      const out = Buffer.allocUnsafe(a.length);
+      for (let i = 0; i < a.length; i++) {
+        out[i] = a[i] & b[i];
+      }
+      return out.toString('latin1', a.length - 64);
+    },
+  },
+  {
+    // memory search's linear cosine scan (manager-search.ts)
+    name: 'topK',
+    setup: (n) => {
+      const { matrix, query, rows } = vectors(n);
+      return [query, matrix, Math.min(10, rows)];
+    },
+    native: (query, matrix, k) => Array.from(native.topK(query, matrix, k).indices).join(),
+    fallback: (query, matrix, k) => {
+      const scored = [];
+      for (let row = 0; row * DIMS < matrix.length; row++) {
+        scored.push({ row, score: cosine(query, 0, matrix, row * DIMS, DIMS) });
+      }
+      scored.sort((a, b) => b.score - a.score || a.row - b.row);
+      return scored
+        .slice(0, k)
+        .map((s) => s.row)
+        .join();
+    },
+    maxBytes: 256 << 20,
+  },
+];
+
+// Median ns/call of batches sized to take ~1/10 of the time budget
+function measure(fn, args) {
+  const start = performance.now();
+  fn(...args);
+  const first = Math.max(performance.now() - start, 1e-4);
+  const batch = Math.max(1, Math.floor(TIME_MS / 10 / first));
+  const samples = [];
+  const deadline = performance.now() + TIME_MS;
+  do {
+    const t0 = performance.now();
+    for (let i = 0; i < batch; i++) {
+      fn(...args);
+    }
+    samples.push(((performance.now() - t0) * 1e6) / batch);
+  } while (performance.now() < deadline || samples.length < 3);
+  samples.sort((a, b) => a - b);
+  return samples[samples.length >> 1];
+}
+
+function formatBytes(n) {
+  return n >= 1 << 30 ? `${n / (1 << 30)}G` : n >= 1 << 20 ? `${n / (1 << 20)}M` : n >= 1024 ? `${n / 1024}K` : `${n}B`;
+}
+
+function formatNs(ns) {
+  return ns >= 1e6 ? `${(ns / 1e6).toFixed(2)}ms` : ns >= 1e3 ? `${(ns / 1e3).toFixed(2)}µs` : `${ns.toFixed(0)}ns`;
+}
+
+const host = `${cpus()[0]?.model.trim() ?? 'unknown'} / ${native.simdLevel ?? 'unknown'}`;
+let stored = {};
+try {
+  stored = JSON.parse(readFileSync(baselinePath, 'utf8'));
+} catch {
+  // no baseline yet
+}
+const baseline = stored[host] ?? {};
+const results = {};
+const failures = [];
+
+if (!CHECK) {
+  console.log(`${host}, ${TIME_MS} ms per cell\n`);
+  console.log(
+    `${'op'.padEnd(12)}${'size'.padStart(6)}${'native'.padStart(11)}${'GB/s'.padStart(8)}` +
+      `${'fallback'.padStart(11)}${'GB/s'.padStart(8)}${'speedup'.padStart(9)}  baseline`,
+  );
+}
+
+for (const c of cases) {
+  if (ONLY && c.name !== ONLY) {
+    continue;
+  }
+  for (const size of sizes) {
+    if (size > (c.maxBytes ?? Infinity)) {
+      continue;
+    }
+    const key = `${c.name}/${size}`;
+    const args = c.setup(size);
+    const got = c.native(...args);
+    const want = c.fallback(...args);
+    if (got !== want) {
+      failures.push(`${key}: native returned ${got}, fallback ${want}`);
+      console.log(`${c.name.padEnd(12)}${formatBytes(size).padStart(6)}  MISMATCH`);
+      continue;
+    }
+    if (CHECK) {
+      continue;
+    }
+
+    const nativeNs = measure(c.native, args);
+    const fallbackNs = measure(c.fallback, args);
+    results[key] = Math.round(nativeNs);
+
+    let verdict = '';
+    if (baseline[key]) {
+      const change = nativeNs / baseline[key] - 1;
+      verdict = `${change >= 0 ? '+' : ''}${(change * 100).toFixed(0)}%`;
+      if (change > TOLERANCE) {
+        failures.push(`${key}: ${formatNs(nativeNs)} vs baseline ${formatNs(baseline[key])}`);
+        verdict += ' REGRESSED';
+      }
+    }
+    if (size >= (c.minBytes ?? MIN_BYTES) && nativeNs > fallbackNs * (1 + TOLERANCE)) {
+      failures.push(`${key}: native ${formatNs(nativeNs)} slower than fallback ${formatNs(fallbackNs)}`);
+      verdict += ' SLOWER';
+    }
+
+    console.log(
+      `${c.name.padEnd(12)}${formatBytes(size).padStart(6)}` +
+        `${formatNs(nativeNs).padStart(11)}${(size / nativeNs).toFixed(2).padStart(8)}` +
+        `${formatNs(fallbackNs).padStart(11)}${(size / fallbackNs).toFixed(2).padStart(8)}` +
+        `${`${(fallbackNs / nativeNs).toFixed(1)}x`.padStart(9)}  ${verdict}`,
+    );
+  }
+}
+
+if (CHECK && failures.length === 0) {
+  console.log('All native results match the fallbacks');
+}
+
+if (UPDATE && !CHECK) {
+  stored[host] = { ...baseline, ...results };
+  writeFileSync(baselinePath, `${JSON.stringify(stored, null, 2)}\n`);
+  console.log(`\nBaseline for "${host}" written to ${baselinePath}`);
+}
+
+if (failures.length > 0) {
+  console.log(`\n${failures.length} failure(s):`);
+  for (const failure of failures) {
+    console.log(`  ${failure}`);
+  }
+  process.exit(1);
+}
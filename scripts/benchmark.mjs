@@ -65,10 +65,9 @@ group('Buffer Operations', () => {
     buf1.compare(buf2);
   });
   
-  if (nativeLib?.BufferOps) {
-    const ops = new nativeLib.BufferOps();
+  if (nativeLib?.compare) {
     bench('native compare (C++)', () => {
-      ops.compare(buf1, buf2);
+      nativeLib.compare(buf1, buf2);
     });
   }
 });
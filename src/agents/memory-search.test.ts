@@ -79,6 +79,48 @@ describe("memory search config", () => {
     expect(resolved?.query.minScore).toBe(0.2);
     expect(resolved?.store.vector.enabled).toBe(true);
     expect(resolved?.store.vector.extensionPath).toBe("/opt/sqlite-vec.dylib");
+    expect(resolved?.store.vector.backend).toBe("sqlite-vec");
+  });
+
+  it("merges hnsw backend tuning from defaults and overrides", () => {
+    const cfg = {
+      agents: {
+        defaults: {
+          memorySearch: {
+            store: { vector: { backend: "hnsw" as const, hnsw: { m: 24, efSearch: 64 } } },
+          },
+        },
+        list: [
+          {
+            id: "main",
+            default: true,
+            memorySearch: { store: { vector: { hnsw: { efSearch: 128 } } } },
+          },
+        ],
+      },
+    };
+    const resolved = resolveMemorySearchConfig(cfg, "main");
+    expect(resolved?.store.vector.backend).toBe("hnsw");
+    expect(resolved?.store.vector.hnsw).toEqual({ m: 24, efSearch: 128 });
+  });
+
+  it("defaults the hybrid keyword backend to fts and honors overrides", () => {
+    const base = { agents: { defaults: { memorySearch: {} } } };
+    expect(resolveMemorySearchConfig(base, "main")?.query.hybrid.keywordBackend).toBe("fts");
+
+    const cfg = {
+      agents: {
+        defaults: { memorySearch: {} },
+        list: [
+          {
+            id: "main",
+            default: true,
+            memorySearch: { query: { hybrid: { keywordBackend: "native" as const } } },
+          },
+        ],
+      },
+    };
+    expect(resolveMemorySearchConfig(cfg, "main")?.query.hybrid.keywordBackend).toBe("native");
   });
 
   it("merges extra memory paths from defaults and overrides", () => {
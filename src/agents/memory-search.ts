@@ -37,11 +37,18 @@ export type ResolvedMemorySearchConfig = {
     vector: {
       enabled: boolean;
       extensionPath?: string;
+      backend: "sqlite-vec" | "flat" | "hnsw";
+      hnsw: {
+        m?: number;
+        efConstruction?: number;
+        efSearch?: number;
+      };
     };
   };
   chunking: {
     tokens: number;
     overlap: number;
+    tokenizer?: string;
   };
   sync: {
     onSessionStart: boolean;
@@ -62,11 +69,13 @@ export type ResolvedMemorySearchConfig = {
       vectorWeight: number;
       textWeight: number;
       candidateMultiplier: number;
+      keywordBackend: "fts" | "native";
     };
   };
   cache: {
     enabled: boolean;
     maxEntries?: number;
+    shared: boolean;
   };
 };
 
@@ -178,6 +187,8 @@ function mergeConfig(
     enabled: overrides?.store?.vector?.enabled ?? defaults?.store?.vector?.enabled ?? true,
     extensionPath:
       overrides?.store?.vector?.extensionPath ?? defaults?.store?.vector?.extensionPath,
+    backend: overrides?.store?.vector?.backend ?? defaults?.store?.vector?.backend ?? "sqlite-vec",
+    hnsw: { ...defaults?.store?.vector?.hnsw, ...overrides?.store?.vector?.hnsw },
   };
   const store = {
     driver: overrides?.store?.driver ?? defaults?.store?.driver ?? "sqlite",
@@ -187,6 +198,7 @@ function mergeConfig(
   const chunking = {
     tokens: overrides?.chunking?.tokens ?? defaults?.chunking?.tokens ?? DEFAULT_CHUNK_TOKENS,
     overlap: overrides?.chunking?.overlap ?? defaults?.chunking?.overlap ?? DEFAULT_CHUNK_OVERLAP,
+    tokenizer: overrides?.chunking?.tokenizer ?? defaults?.chunking?.tokenizer,
   };
   const sync = {
     onSessionStart: overrides?.sync?.onSessionStart ?? defaults?.sync?.onSessionStart ?? true,
@@ -229,10 +241,15 @@ function mergeConfig(
       overrides?.query?.hybrid?.candidateMultiplier ??
       defaults?.query?.hybrid?.candidateMultiplier ??
       DEFAULT_HYBRID_CANDIDATE_MULTIPLIER,
+    keywordBackend:
+      overrides?.query?.hybrid?.keywordBackend ??
+      defaults?.query?.hybrid?.keywordBackend ??
+      "fts",
   };
   const cache = {
     enabled: overrides?.cache?.enabled ?? defaults?.cache?.enabled ?? DEFAULT_CACHE_ENABLED,
     maxEntries: overrides?.cache?.maxEntries ?? defaults?.cache?.maxEntries,
+    shared: overrides?.cache?.shared ?? defaults?.cache?.shared ?? false,
   };
 
   const overlap = clampNumber(chunking.overlap, 0, Math.max(0, chunking.tokens - 1));
@@ -258,7 +275,11 @@ function mergeConfig(
     model,
     local,
     store,
-    chunking: { tokens: Math.max(1, chunking.tokens), overlap },
+    chunking: {
+      tokens: Math.max(1, chunking.tokens),
+      overlap,
+      tokenizer: chunking.tokenizer?.trim() ? resolveUserPath(chunking.tokenizer.trim()) : undefined,
+    },
     sync: {
       ...sync,
       sessions: {
@@ -274,6 +295,7 @@ function mergeConfig(
         vectorWeight: normalizedVectorWeight,
         textWeight: normalizedTextWeight,
         candidateMultiplier,
+        keywordBackend: hybrid.keywordBackend,
       },
     },
     cache: {
@@ -282,6 +304,7 @@ function mergeConfig(
         typeof cache.maxEntries === "number" && Number.isFinite(cache.maxEntries)
           ? Math.max(1, Math.floor(cache.maxEntries))
           : undefined,
+      shared: Boolean(cache.shared),
     },
   };
 }
@@ -209,6 +209,10 @@ const FIELD_LABELS: Record<string, string> = {
   "gateway.nodes.browser.node": "Gateway Node Browser Pin",
   "gateway.nodes.allowCommands": "Gateway Node Allowlist (Extra Commands)",
   "gateway.nodes.denyCommands": "Gateway Node Denylist",
+  "gateway.eventBus.enabled": "Gateway Event Bus",
+  "gateway.eventBus.path": "Gateway Event Bus Path",
+  "gateway.eventBus.slots": "Gateway Event Bus Slots",
+  "gateway.eventBus.dataBytes": "Gateway Event Bus Size (bytes)",
   "nodeHost.browserProxy.enabled": "Node Browser Proxy Enabled",
   "nodeHost.browserProxy.allowProfiles": "Node Browser Proxy Allowed Profiles",
   "skills.load.watch": "Watch Skills",
@@ -236,8 +240,11 @@ const FIELD_LABELS: Record<string, string> = {
   "agents.defaults.memorySearch.store.path": "Memory Search Index Path",
   "agents.defaults.memorySearch.store.vector.enabled": "Memory Search Vector Index",
   "agents.defaults.memorySearch.store.vector.extensionPath": "Memory Search Vector Extension Path",
+  "agents.defaults.memorySearch.store.vector.backend": "Memory Search Vector Backend",
+  "agents.defaults.memorySearch.store.vector.hnsw.efSearch": "Memory HNSW Search Breadth",
   "agents.defaults.memorySearch.chunking.tokens": "Memory Chunk Tokens",
   "agents.defaults.memorySearch.chunking.overlap": "Memory Chunk Overlap Tokens",
+  "agents.defaults.memorySearch.chunking.tokenizer": "Memory Chunk Tokenizer",
   "agents.defaults.memorySearch.sync.onSessionStart": "Index on Session Start",
   "agents.defaults.memorySearch.sync.onSearch": "Index on Search (Lazy)",
   "agents.defaults.memorySearch.sync.watch": "Watch Memory Files",
@@ -251,8 +258,10 @@ const FIELD_LABELS: Record<string, string> = {
   "agents.defaults.memorySearch.query.hybrid.textWeight": "Memory Search Text Weight",
   "agents.defaults.memorySearch.query.hybrid.candidateMultiplier":
     "Memory Search Hybrid Candidate Multiplier",
+  "agents.defaults.memorySearch.query.hybrid.keywordBackend": "Memory Search Keyword Backend",
   "agents.defaults.memorySearch.cache.enabled": "Memory Search Embedding Cache",
   "agents.defaults.memorySearch.cache.maxEntries": "Memory Search Embedding Cache Max Entries",
+  "agents.defaults.memorySearch.cache.shared": "Memory Search Shared Embedding Cache",
   "auth.profiles": "Auth Profiles",
   "auth.order": "Auth Profile Order",
   "auth.cooldowns.billingBackoffHours": "Billing Backoff (hours)",
@@ -401,6 +410,13 @@ const FIELD_HELP: Record<string, string> = {
     "Extra node.invoke commands to allow beyond the gateway defaults (array of command strings).",
   "gateway.nodes.denyCommands":
     "Commands to block even if present in node claims or default allowlist.",
+  "gateway.eventBus.enabled":
+    "Publish every gateway broadcast to a shared-memory ring so worker threads or processes can fan it out to the connections they own (requires the native addon).",
+  "gateway.eventBus.path":
+    "Ring file shared by the gateway and its workers (default: /dev/shm/openclaw-gateway-<port>.events, or the state dir where /dev/shm is missing).",
+  "gateway.eventBus.slots": "Events kept for readers that fall behind (default: 16384).",
+  "gateway.eventBus.dataBytes":
+    "Frame space in bytes (default: 32 MiB); a frame over a quarter of it reaches local clients only.",
   "nodeHost.browserProxy.enabled": "Expose the local browser control server via node proxy.",
   "nodeHost.browserProxy.allowProfiles":
     "Optional allowlist of browser profile names exposed via the node proxy.",
@@ -532,6 +548,10 @@ const FIELD_HELP: Record<string, string> = {
     "Enable sqlite-vec extension for vector search (default: true).",
   "agents.defaults.memorySearch.store.vector.extensionPath":
     "Optional override path to sqlite-vec extension library (.dylib/.so/.dll).",
+  "agents.defaults.memorySearch.store.vector.backend":
+    'Vector search engine: "sqlite-vec" (exact scan), "flat" (native exact scan of a memory-mapped vector file saved next to the index) or "hnsw" (native approximate graph saved next to the index; for large stores).',
+  "agents.defaults.memorySearch.store.vector.hnsw.efSearch":
+    "HNSW candidates examined per query (default: 64); raise for recall, lower for latency.",
   "agents.defaults.memorySearch.query.hybrid.enabled":
     "Enable hybrid BM25 + vector search for memory (default: true).",
   "agents.defaults.memorySearch.query.hybrid.vectorWeight":
@@ -540,10 +560,16 @@ const FIELD_HELP: Record<string, string> = {
     "Weight for BM25 text relevance when merging results (0-1).",
   "agents.defaults.memorySearch.query.hybrid.candidateMultiplier":
     "Multiplier for candidate pool size (default: 4).",
+  "agents.defaults.memorySearch.query.hybrid.keywordBackend":
+    'Keyword engine: "fts" (SQLite FTS5) or "native" (in-memory BM25 index built from the chunks, fused with the vector hits in one native call).',
   "agents.defaults.memorySearch.cache.enabled":
     "Cache chunk embeddings in SQLite to speed up reindexing and frequent updates (default: true).",
   "agents.defaults.memorySearch.cache.maxEntries":
     "Optional cap on cached embeddings (best-effort).",
+  "agents.defaults.memorySearch.cache.shared":
+    "Share embeddings across agents and reindexes through a native memory-mapped cache keyed by provider model and chunk hash, so identical chunks are embedded once per host (default: false).",
+  "agents.defaults.memorySearch.chunking.tokenizer":
+    "Path to a tiktoken rank file (e.g. cl100k_base.tiktoken). When set, chunks are split on exact token counts from the native BPE tokenizer instead of the 4-chars-per-token estimate.",
   "agents.defaults.memorySearch.sync.onSearch":
     "Lazy sync: schedule a reindex on search after changes.",
   "agents.defaults.memorySearch.sync.watch": "Watch memory files for changes (chokidar).",
@@ -193,6 +193,17 @@ export type GatewayHttpConfig = {
   endpoints?: GatewayHttpEndpointsConfig;
 };
 
+export type GatewayEventBusConfig = {
+  /** Publish every broadcast to a shared-memory ring for worker fan-out (default: false). */
+  enabled?: boolean;
+  /** Ring file (default: /dev/shm/openclaw-gateway-<port>.events, else in the state dir). */
+  path?: string;
+  /** Events kept for lagging readers (default: 16384). */
+  slots?: number;
+  /** Frame space in bytes (default: 32 MiB); frames over a quarter of it are not published. */
+  dataBytes?: number;
+};
+
 export type GatewayNodesConfig = {
   /** Browser routing policy for node-hosted browser proxies. */
   browser?: {
@@ -278,6 +289,7 @@ export type GatewayConfig = {
   tls?: GatewayTlsConfig;
   http?: GatewayHttpConfig;
   nodes?: GatewayNodesConfig;
+  eventBus?: GatewayEventBusConfig;
   cors?: GatewayCorsConfig;
   securityHeaders?: GatewaySecurityHeadersConfig;
   /** API security configuration. */
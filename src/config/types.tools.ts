@@ -272,6 +272,20 @@ export type MemorySearchConfig = {
       enabled?: boolean;
       /** Optional override path to sqlite-vec extension (.dylib/.so/.dll). */
       extensionPath?: string;
+      /**
+       * Vector search engine: exact sqlite-vec scan, exact native scan of an mmapped vector file,
+       * or native HNSW graph (default: "sqlite-vec").
+       */
+      backend?: "sqlite-vec" | "flat" | "hnsw";
+      /** HNSW graph tuning (backend "hnsw"). */
+      hnsw?: {
+        /** Links per node (default: 16). */
+        m?: number;
+        /** Candidate list size while building (default: 200). */
+        efConstruction?: number;
+        /** Candidate list size per query; higher is slower with better recall (default: 64). */
+        efSearch?: number;
+      };
     };
     cache?: {
       /** Enable embedding cache (default: true). */
@@ -284,6 +298,8 @@ export type MemorySearchConfig = {
   chunking?: {
     tokens?: number;
     overlap?: number;
+    /** tiktoken rank file (e.g. cl100k_base.tiktoken) for exact token budgets. */
+    tokenizer?: string;
   };
   /** Sync behavior. */
   sync?: {
@@ -312,6 +328,8 @@ export type MemorySearchConfig = {
       textWeight?: number;
       /** Multiplier for candidate pool size (default: 4). */
       candidateMultiplier?: number;
+      /** Keyword engine: SQLite FTS5 or the native in-memory BM25 index (default: "fts"). */
+      keywordBackend?: "fts" | "native";
     };
   };
   /** Index cache behavior. */
@@ -320,6 +338,8 @@ export type MemorySearchConfig = {
     enabled?: boolean;
     /** Optional cap on cached embeddings (best-effort). */
     maxEntries?: number;
+    /** Also share embeddings across agents through a native mmapped cache (default: false). */
+    shared?: boolean;
   };
 };
 
@@ -354,6 +354,17 @@ export const MemorySearchSchema = z
           .object({
             enabled: z.boolean().optional(),
             extensionPath: z.string().optional(),
+            backend: z
+              .union([z.literal("sqlite-vec"), z.literal("flat"), z.literal("hnsw")])
+              .optional(),
+            hnsw: z
+              .object({
+                m: z.number().int().min(2).max(256).optional(),
+                efConstruction: z.number().int().positive().optional(),
+                efSearch: z.number().int().positive().optional(),
+              })
+              .strict()
+              .optional(),
           })
           .strict()
           .optional(),
@@ -364,6 +375,7 @@ export const MemorySearchSchema = z
       .object({
         tokens: z.number().int().positive().optional(),
         overlap: z.number().int().nonnegative().optional(),
+        tokenizer: z.string().optional(),
       })
       .strict()
       .optional(),
@@ -394,6 +406,7 @@ export const MemorySearchSchema = z
             vectorWeight: z.number().min(0).max(1).optional(),
             textWeight: z.number().min(0).max(1).optional(),
             candidateMultiplier: z.number().int().positive().optional(),
+            keywordBackend: z.union([z.literal("fts"), z.literal("native")]).optional(),
           })
           .strict()
           .optional(),
@@ -404,6 +417,7 @@ export const MemorySearchSchema = z
       .object({
         enabled: z.boolean().optional(),
         maxEntries: z.number().int().positive().optional(),
+        shared: z.boolean().optional(),
       })
       .strict()
       .optional(),
@@ -463,6 +463,15 @@ export const OpenClawSchema = z
           })
           .strict()
           .optional(),
+        eventBus: z
+          .object({
+            enabled: z.boolean().optional(),
+            path: z.string().optional(),
+            slots: z.number().int().positive().optional(),
+            dataBytes: z.number().int().positive().optional(),
+          })
+          .strict()
+          .optional(),
         cors: z
           .object({
             allowedOrigins: z.array(z.string()).optional(),
@@ -1,10 +1,26 @@
-import { describe, expect, it } from "vitest";
+import { describe, expect, it, vi } from "vitest";
 import {
   buildMessageWithAttachments,
   type ChatAttachment,
   parseMessageWithAttachments,
 } from "./chat-attachments.js";
 
+// Which base64 validator readBase64Attachment sees; the native one only
+// exists when the addon is built
+const base64Path = vi.hoisted(() => ({
+  native: false,
+  getNative: (): unknown => null,
+}));
+
+vi.mock("../ultra.js", async (importOriginal) => {
+  const actual = await importOriginal<typeof import("../ultra.js")>();
+  base64Path.getNative = actual.getNativeBase64;
+  return {
+    ...actual,
+    getNativeBase64: () => (base64Path.native ? actual.getNativeBase64() : null),
+  };
+});
+
 const PNG_1x1 =
   "iVBORw0KGgoAAAANSUhEUgAAAAEAAAABCAQAAAC1HAwCAAAAC0lEQVR42mP8/woAAn8B9FD5fHAAAAAASUVORK5CYII=";
 
@@ -76,6 +92,23 @@ describe("parseMessageWithAttachments", () => {
     expect(parsed.images[0]?.data).toBe(PNG_1x1);
   });
 
+  it("trims whitespace around a data URL", async () => {
+    const parsed = await parseMessageWithAttachments(
+      "see this",
+      [
+        {
+          type: "image",
+          fileName: "dot.png",
+          content: `\n  data:image/png;base64,${PNG_1x1}  \n`,
+        },
+      ],
+      { log: { warn: () => {} } },
+    );
+    expect(parsed.images).toHaveLength(1);
+    expect(parsed.images[0]?.mimeType).toBe("image/png");
+    expect(parsed.images[0]?.data).toBe(PNG_1x1);
+  });
+
   it("rejects invalid base64 content", async () => {
     await expect(
       parseMessageWithAttachments(
@@ -211,3 +244,42 @@ describe("parseMessageWithAttachments", () => {
     expect(logs.some((l) => /non-image/i.test(l))).toBe(true);
   });
 });
+
+describe("base64 validation", () => {
+  const valid = [PNG_1x1, "QQ==", "QUI=", "QUJD", "QUJDRA==", "+/+/"];
+  const invalid = [
+    "QQ==QQ==",
+    "QQ=A",
+    "QUJD=A==",
+    "Q===",
+    "====",
+    "QUJ",
+    "QU JD",
+    "QUJD\nRA==",
+    "QQ-_",
+  ];
+
+  describe.each([
+    ["js fallback", false],
+    ["native", true],
+  ])("%s", (_name, native) => {
+    const run = (content: string) => {
+      base64Path.native = native;
+      try {
+        return buildMessageWithAttachments("x", [
+          { type: "image", mimeType: "image/png", fileName: "a.png", content },
+        ]);
+      } finally {
+        base64Path.native = false;
+      }
+    };
+
+    it.skipIf(native && !base64Path.getNative()).each(valid)("accepts %j", (content) => {
+      expect(run(content)).toContain(content);
+    });
+
+    it.skipIf(native && !base64Path.getNative()).each(invalid)("rejects %j", (content) => {
+      expect(() => run(content)).toThrow(/invalid base64/);
+    });
+  });
+});
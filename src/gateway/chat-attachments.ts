@@ -1,4 +1,5 @@
 import { detectMime } from "../media/mime.js";
+import { getNativeBase64 } from "../ultra.js";
 
 export type ChatAttachment = {
   type?: string;
@@ -50,6 +51,56 @@ async function sniffMimeFromBase64(base64: string): Promise<string | undefined>
   }
 }
 
+type Base64Attachment = {
+  b64: string;
+  sizeBytes: number;
+  /** Sniffed by the native decoder; undefined when it was not run or did not recognise the head. */
+  sniffedMime?: string;
+};
+
+/**
+ * Trims `content`, strips a data URL prefix when `dataUrl` is set and checks
+ * that what remains is padded standard base64. Throws on invalid content.
+ *
+ * The native path validates and measures the payload in one pass without
+ * materialising the decoded bytes, which the gateway never needs: images are
+ * forwarded as base64 text.
+ */
+function readBase64Attachment(content: string, label: string, dataUrl: boolean): Base64Attachment {
+  const trimmed = content.trim();
+  const native = getNativeBase64();
+  if (native) {
+    const info = native.inspect(trimmed, { dataUrl });
+    if (!info) {
+      throw new Error(`attachment ${label}: invalid base64 content`);
+    }
+    return {
+      b64: trimmed.slice(trimmed.length - info.length),
+      sizeBytes: info.size,
+      sniffedMime: info.mime ?? undefined,
+    };
+  }
+
+  let b64 = trimmed;
+  if (dataUrl) {
+    // Strip data URL prefix if present (e.g., "data:image/jpeg;base64,...")
+    const dataUrlMatch = /^data:[^;]+;base64,(.*)$/.exec(b64);
+    if (dataUrlMatch) {
+      b64 = dataUrlMatch[1];
+    }
+  }
+  // Same rules as the native decoder: length multiple of 4, standard
+  // alphabet, and "=" only as padding in the last two characters.
+  if (b64.length % 4 !== 0 || !/^[A-Za-z0-9+/]*={0,2}$/.test(b64)) {
+    throw new Error(`attachment ${label}: invalid base64 content`);
+  }
+  try {
+    return { b64, sizeBytes: Buffer.from(b64, "base64").byteLength };
+  } catch {
+    throw new Error(`attachment ${label}: invalid base64 content`);
+  }
+}
+
 function isImageMime(mime?: string): boolean {
   return typeof mime === "string" && mime.startsWith("image/");
 }
@@ -84,28 +135,13 @@ export async function parseMessageWithAttachments(
       throw new Error(`attachment ${label}: content must be base64 string`);
     }
 
-    let sizeBytes = 0;
-    let b64 = content.trim();
-    // Strip data URL prefix if present (e.g., "data:image/jpeg;base64,...")
-    const dataUrlMatch = /^data:[^;]+;base64,(.*)$/.exec(b64);
-    if (dataUrlMatch) {
-      b64 = dataUrlMatch[1];
-    }
-    // Basic base64 sanity: length multiple of 4 and charset check.
-    if (b64.length % 4 !== 0 || /[^A-Za-z0-9+/=]/.test(b64)) {
-      throw new Error(`attachment ${label}: invalid base64 content`);
-    }
-    try {
-      sizeBytes = Buffer.from(b64, "base64").byteLength;
-    } catch {
-      throw new Error(`attachment ${label}: invalid base64 content`);
-    }
+    const { b64, sizeBytes, sniffedMime: nativeMime } = readBase64Attachment(content, label, true);
     if (sizeBytes <= 0 || sizeBytes > maxBytes) {
       throw new Error(`attachment ${label}: exceeds size limit (${sizeBytes} > ${maxBytes} bytes)`);
     }
 
     const providedMime = normalizeMime(mime);
-    const sniffedMime = normalizeMime(await sniffMimeFromBase64(b64));
+    const sniffedMime = normalizeMime(nativeMime ?? (await sniffMimeFromBase64(b64)));
     if (sniffedMime && !isImageMime(sniffedMime)) {
       log?.warn(`attachment ${label}: detected non-image (${sniffedMime}), dropping`);
       continue;
@@ -161,17 +197,7 @@ export function buildMessageWithAttachments(
       throw new Error(`attachment ${label}: only image/* supported`);
     }
 
-    let sizeBytes = 0;
-    const b64 = content.trim();
-    // Basic base64 sanity: length multiple of 4 and charset check.
-    if (b64.length % 4 !== 0 || /[^A-Za-z0-9+/=]/.test(b64)) {
-      throw new Error(`attachment ${label}: invalid base64 content`);
-    }
-    try {
-      sizeBytes = Buffer.from(b64, "base64").byteLength;
-    } catch {
-      throw new Error(`attachment ${label}: invalid base64 content`);
-    }
+    const { sizeBytes } = readBase64Attachment(content, label, false);
     if (sizeBytes <= 0 || sizeBytes > maxBytes) {
       throw new Error(`attachment ${label}: exceeds size limit (${sizeBytes} > ${maxBytes} bytes)`);
     }
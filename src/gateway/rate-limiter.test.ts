@@ -100,6 +100,36 @@ describe("RateLimiter", () => {
     expect(shortWindowLimiter.check(mockReq).allowed).toBe(true);
   });
 
+  it("regains one request every windowMs / maxRequests", () => {
+    vi.useFakeTimers();
+    try {
+      vi.setSystemTime(1_000_000);
+      const steadyLimiter = new RateLimiter({ windowMs: 1000, maxRequests: 4 });
+      const mockReq = {
+        socket: { remoteAddress: "192.168.1.1" },
+      } as IncomingMessage;
+
+      for (let i = 0; i < 4; i++) {
+        expect(steadyLimiter.check(mockReq).allowed).toBe(true);
+      }
+      const blocked = steadyLimiter.check(mockReq);
+      expect(blocked.allowed).toBe(false);
+      expect(blocked.resetTime).toBe(1_001_000);
+
+      vi.advanceTimersByTime(249);
+      expect(steadyLimiter.check(mockReq).allowed).toBe(false);
+      vi.advanceTimersByTime(1);
+      expect(steadyLimiter.check(mockReq)).toEqual({
+        allowed: true,
+        remaining: 0,
+        resetTime: 1_001_250,
+      });
+      expect(steadyLimiter.check(mockReq).allowed).toBe(false);
+    } finally {
+      vi.useRealTimers();
+    }
+  });
+
   it("uses custom key generator when provided", () => {
     const customLimiter = new RateLimiter({
       windowMs: 1000,
@@ -188,6 +218,42 @@ describe("RateLimiter", () => {
       );
     });
 
+    it("sets Retry-After to when the next request is admitted", () => {
+      vi.useFakeTimers();
+      try {
+        vi.setSystemTime(1_000_000);
+        const minuteLimiter = new RateLimiter({ windowMs: 60_000, maxRequests: 3 });
+        const mockReq = {
+          socket: { remoteAddress: "192.168.1.1" },
+        } as IncomingMessage;
+        const middleware = minuteLimiter.middleware();
+        for (let i = 0; i < 3; i++) {
+          middleware(mockReq, createMockResponse(), () => {});
+        }
+
+        // One request comes back every 20s, not after the whole window
+        const blocked = createMockResponse();
+        middleware(mockReq, blocked, () => {});
+        expect(blocked.statusCode).toBe(429);
+        expect(blocked.setHeader).toHaveBeenCalledWith("Retry-After", "20");
+
+        vi.advanceTimersByTime(15_500);
+        const later = createMockResponse();
+        middleware(mockReq, later, () => {});
+        expect(later.statusCode).toBe(429);
+        expect(later.setHeader).toHaveBeenCalledWith("Retry-After", "5");
+
+        vi.advanceTimersByTime(4_500);
+        let nextCalled = false;
+        middleware(mockReq, createMockResponse(), () => {
+          nextCalled = true;
+        });
+        expect(nextCalled).toBe(true);
+      } finally {
+        vi.useRealTimers();
+      }
+    });
+
     it("includes rate limit headers even when blocked", () => {
       const mockReq = {
         socket: { remoteAddress: "192.168.1.1" },
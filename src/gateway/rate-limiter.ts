@@ -1,50 +1,95 @@
 import type { IncomingMessage, ServerResponse } from "node:http";
 import { LRUCache } from "lru-cache";
+import { getNativeRateLimit, type NativeRateLimitTable } from "../ultra.js";
 
 interface RateLimitConfig {
   windowMs: number;
   maxRequests: number;
   keyGenerator?: (req: IncomingMessage) => string;
+  /**
+   * Another limiter's `sharedMemory`, so limiters in several worker threads
+   * enforce one set of limits. Needs the native addon; ignored without it.
+   */
+  sharedMemory?: SharedArrayBuffer;
 }
 
+const MAX_KEYS = 10000;
+
+/**
+ * GCRA limiter: each key may burst to maxRequests, and regains one request
+ * every windowMs / maxRequests. A check is O(1) and keeps one number per key.
+ */
 export class RateLimiter {
-  private cache: LRUCache<string, number[]>;
-  private config: Required<RateLimitConfig>;
+  // JS fallback: each key's theoretical arrival time, in ticks of
+  // 1 / maxRequests ms since `epoch`, so a request costs exactly windowMs ticks
+  private cache: LRUCache<string, number>;
+  private epoch = Date.now();
+  private table: NativeRateLimitTable | null = null;
+  private result = new Float64Array(2);
+  private config: Required<Omit<RateLimitConfig, "sharedMemory">>;
+
+  /** Limit state that `new RateLimiter({ ..., sharedMemory })` in a worker can join. */
+  readonly sharedMemory?: SharedArrayBuffer;
 
   constructor(config: RateLimitConfig) {
+    const { sharedMemory, ...rest } = config;
     this.config = {
       keyGenerator: (req) => req.socket.remoteAddress || "unknown",
-      ...config,
+      ...rest,
     };
 
     this.cache = new LRUCache({
-      max: 10000,
+      max: MAX_KEYS,
       ttl: this.config.windowMs,
     });
+
+    const native = getNativeRateLimit();
+    if (native) {
+      this.sharedMemory = sharedMemory ?? new SharedArrayBuffer(native.bytesFor(MAX_KEYS));
+      this.table = native.create({
+        windowMs: this.config.windowMs,
+        maxRequests: this.config.maxRequests,
+        capacity: MAX_KEYS,
+        memory: new Uint8Array(this.sharedMemory),
+      });
+    }
   }
 
   check(req: IncomingMessage): { allowed: boolean; remaining: number; resetTime: number } {
     const key = this.config.keyGenerator(req);
     const now = Date.now();
-    const windowStart = now - this.config.windowMs;
 
-    const timestamps = this.cache.get(key) || [];
-    const recentTimestamps = timestamps.filter((t) => t > windowStart);
-
-    const remaining = Math.max(0, this.config.maxRequests - recentTimestamps.length);
-    const resetTime =
-      timestamps.length > 0
-        ? Math.min(...timestamps) + this.config.windowMs
-        : now + this.config.windowMs;
+    if (this.table) {
+      const allowed = this.table.check(key, now, this.result);
+      return { allowed, remaining: this.result[0], resetTime: this.result[1] };
+    }
 
-    if (recentTimestamps.length >= this.config.maxRequests) {
-      return { allowed: false, remaining: 0, resetTime };
+    const { windowMs, maxRequests } = this.config;
+    const ticks = (now - this.epoch) * maxRequests;
+    const tat = Math.max(this.cache.get(key) ?? ticks, ticks);
+    const next = tat + windowMs;
+    const burst = windowMs * maxRequests;
+    if (next - ticks > burst) {
+      return { allowed: false, remaining: 0, resetTime: this.epoch + tat / maxRequests };
     }
 
-    recentTimestamps.push(now);
-    this.cache.set(key, recentTimestamps);
+    // The entry outlives its ttl only while the bucket is still refilling
+    this.cache.set(key, next);
+    return {
+      allowed: true,
+      remaining: Math.floor((burst - (next - ticks)) / windowMs),
+      resetTime: this.epoch + next / maxRequests,
+    };
+  }
 
-    return { allowed: true, remaining: remaining - 1, resetTime };
+  /**
+   * Time until a denied key is admitted again. A denial reports its tat as
+   * resetTime on both paths; one request fits once the tat is within
+   * windowMs - windowMs / maxRequests of now.
+   */
+  private retryAfterMs(resetTime: number): number {
+    const { windowMs, maxRequests } = this.config;
+    return resetTime - windowMs + windowMs / maxRequests - Date.now();
   }
 
   middleware() {
@@ -58,7 +103,8 @@ export class RateLimiter {
       if (!result.allowed) {
         res.statusCode = 429;
         res.setHeader("Content-Type", "application/json");
-        res.setHeader("Retry-After", Math.ceil(this.config.windowMs / 1000).toString());
+        const retryAfterSeconds = Math.ceil(this.retryAfterMs(result.resetTime) / 1000);
+        res.setHeader("Retry-After", retryAfterSeconds.toString());
         res.end(
           JSON.stringify({
             error: "Too Many Requests",
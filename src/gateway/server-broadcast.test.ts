@@ -1,13 +1,65 @@
 import { describe, expect, it, vi } from "vitest";
 import type { GatewayWsClient } from "./server/ws-types.js";
-import { createGatewayBroadcaster } from "./server-broadcast.js";
+
+const logState = vi.hoisted(() => ({ fail: false }));
+
+vi.mock("./ws-log.js", async (importOriginal) => {
+  const actual = await importOriginal<typeof import("./ws-log.js")>();
+  return {
+    ...actual,
+    logWs: (...args: Parameters<typeof actual.logWs>) => {
+      if (logState.fail) {
+        throw new Error("log failed");
+      }
+      actual.logWs(...args);
+    },
+  };
+});
+
+import {
+  createGatewayBroadcaster,
+  createGatewayEventFanout,
+  type GatewayEventBus,
+} from "./server-broadcast.js";
 
 type TestSocket = {
   bufferedAmount: number;
-  send: (payload: string) => void;
+  send: (payload: Buffer, options: { binary: boolean }) => void;
   close: (code: number, reason: string) => void;
 };
 
+function memoryBus(): GatewayEventBus & { frames: Map<number, { frame: Buffer; tag: number }> } {
+  const frames = new Map<number, { frame: Buffer; tag: number }>();
+  let head = 0;
+  return {
+    frames,
+    get head() {
+      return head;
+    },
+    claim: () => ++head,
+    commit: (seq, frame, tag) => {
+      frames.set(seq, { frame, tag: tag ?? 0 });
+      return true;
+    },
+    read: (cursor) => {
+      const events: Array<{ seq: number; tag: number; frame: Buffer }> = [];
+      let seq = cursor;
+      for (let entry = frames.get(seq); entry; entry = frames.get(++seq)) {
+        events.push({ seq, tag: entry.tag, frame: entry.frame });
+      }
+      return { events, next: seq, lost: 0 };
+    },
+  };
+}
+
+function testClient(scopes: string[], socket: TestSocket): GatewayWsClient {
+  return {
+    socket: socket as unknown as GatewayWsClient["socket"],
+    connect: { role: "operator", scopes } as GatewayWsClient["connect"],
+    connId: `c-${scopes.join(",")}`,
+  };
+}
+
 describe("gateway broadcaster", () => {
   it("filters approval and pairing events by scope", () => {
     const approvalsSocket: TestSocket = {
@@ -53,4 +105,133 @@ describe("gateway broadcaster", () => {
     expect(pairingSocket.send).toHaveBeenCalledTimes(1);
     expect(readSocket.send).toHaveBeenCalledTimes(0);
   });
+
+  it("sends one shared text payload to every client", () => {
+    const sockets: TestSocket[] = [0, 1, 2].map(() => ({
+      bufferedAmount: 0,
+      send: vi.fn(),
+      close: vi.fn(),
+    }));
+    const clients = new Set<GatewayWsClient>(
+      sockets.map((socket, i) => ({
+        socket: socket as unknown as GatewayWsClient["socket"],
+        connect: { role: "operator", scopes: ["operator.read"] } as GatewayWsClient["connect"],
+        connId: `c-${i}`,
+      })),
+    );
+
+    const { broadcast } = createGatewayBroadcaster({ clients });
+    broadcast("agent", { text: "héllo" });
+
+    const calls = sockets.map((socket) => vi.mocked(socket.send).mock.calls[0]);
+    const [payload, options] = calls[0];
+    expect(options).toEqual({ binary: false });
+    expect(JSON.parse(payload.toString("utf8"))).toMatchObject({
+      type: "event",
+      event: "agent",
+      payload: { text: "héllo" },
+      seq: 1,
+    });
+    for (const call of calls) {
+      expect(call[0]).toBe(payload);
+    }
+  });
+
+  it("numbers events from the bus and fans them out to other consumers", () => {
+    const bus = memoryBus();
+    bus.claim(); // another producer already published seq 1
+    bus.commit(1, Buffer.from("{}"), 0);
+
+    const localSocket: TestSocket = { bufferedAmount: 0, send: vi.fn(), close: vi.fn() };
+    const { broadcast } = createGatewayBroadcaster({
+      clients: new Set([testClient(["operator.read"], localSocket)]),
+      bus,
+    });
+
+    const readSocket: TestSocket = { bufferedAmount: 0, send: vi.fn(), close: vi.fn() };
+    const pairingSocket: TestSocket = { bufferedAmount: 0, send: vi.fn(), close: vi.fn() };
+    const fanout = createGatewayEventFanout({
+      clients: new Set([
+        testClient(["operator.read"], readSocket),
+        testClient(["operator.pairing"], pairingSocket),
+      ]),
+      bus,
+    });
+
+    broadcast("agent", { text: "hi" });
+    broadcast("device.pair.requested", { requestId: "r1" });
+    expect(fanout.pump()).toBe(2);
+
+    const [localPayload] = vi.mocked(localSocket.send).mock.calls[0];
+    expect(JSON.parse(localPayload.toString("utf8"))).toMatchObject({ event: "agent", seq: 2 });
+    // Remote consumers forward the published bytes as-is
+    expect(vi.mocked(readSocket.send).mock.calls[0][0]).toBe(bus.frames.get(2)?.frame);
+    expect(readSocket.send).toHaveBeenCalledTimes(1);
+    expect(pairingSocket.send).toHaveBeenCalledTimes(2);
+    expect(
+      JSON.parse(vi.mocked(pairingSocket.send).mock.calls[1][0].toString("utf8")),
+    ).toMatchObject({ event: "device.pair.requested", seq: 3 });
+  });
+
+  it("commits a placeholder when a payload fails to serialize", () => {
+    const bus = memoryBus();
+    const { broadcast } = createGatewayBroadcaster({ clients: new Set(), bus });
+    const socket: TestSocket = { bufferedAmount: 0, send: vi.fn(), close: vi.fn() };
+    const fanout = createGatewayEventFanout({
+      clients: new Set([testClient(["operator.read"], socket)]),
+      bus,
+    });
+    const cyclic: Record<string, unknown> = {};
+    cyclic.self = cyclic;
+
+    expect(() => broadcast("agent", cyclic)).toThrow();
+    broadcast("agent", { ok: true });
+
+    expect(bus.frames.get(1)?.frame.length).toBe(0);
+    expect(fanout.pump()).toBe(2);
+    expect(socket.send).toHaveBeenCalledTimes(1);
+  });
+
+  it("delivers local events through the bus in seq order", () => {
+    const bus = memoryBus();
+    const socket: TestSocket = { bufferedAmount: 0, send: vi.fn(), close: vi.fn() };
+    const { broadcast } = createGatewayBroadcaster({
+      clients: new Set([testClient(["operator.read"], socket)]),
+      bus,
+    });
+    const sentSeqs = () =>
+      vi
+        .mocked(socket.send)
+        .mock.calls.map(([payload]) => JSON.parse(payload.toString("utf8")).seq as number);
+
+    // Another producer has claimed seq 1 and not committed it yet
+    const pending = bus.claim();
+    broadcast("agent", { text: "a" });
+    expect(socket.send).not.toHaveBeenCalled();
+
+    bus.commit(pending, Buffer.from(JSON.stringify({ type: "event", seq: pending })), 0);
+    broadcast("agent", { text: "b" });
+    expect(sentSeqs()).toEqual([1, 2, 3]);
+  });
+
+  it("commits an event before logging it", () => {
+    const bus = memoryBus();
+    const socket: TestSocket = { bufferedAmount: 0, send: vi.fn(), close: vi.fn() };
+    const { broadcast } = createGatewayBroadcaster({
+      clients: new Set([testClient(["operator.read"], socket)]),
+      bus,
+    });
+
+    logState.fail = true;
+    try {
+      expect(() => broadcast("agent", { text: "a" })).toThrow("log failed");
+    } finally {
+      logState.fail = false;
+    }
+    expect(bus.frames.has(1)).toBe(true);
+
+    // Readers are not stuck behind it
+    broadcast("agent", { text: "b" });
+    expect(socket.send).toHaveBeenCalledTimes(2);
+  });
 });
@@ -1,3 +1,4 @@
+import type { NativeEventBus } from "../ultra.js";
 import type { GatewayWsClient } from "./server/ws-types.js";
 import { MAX_BUFFERED_BYTES } from "./server-constants.js";
 import { logWs, summarizeAgentEventForWsLog } from "./ws-log.js";
@@ -15,8 +16,11 @@ const EVENT_SCOPE_GUARDS: Record<string, string[]> = {
   "node.pair.resolved": [PAIRING_SCOPE],
 };
 
-function hasEventScope(client: GatewayWsClient, event: string): boolean {
-  const required = EVENT_SCOPE_GUARDS[event];
+// Bus frames carry their guard as an index into this list (0 = unguarded)
+// so consumers need not parse the event name back out of the frame
+const GUARDED_EVENTS = Object.keys(EVENT_SCOPE_GUARDS);
+
+function hasEventScope(client: GatewayWsClient, required: string[] | undefined): boolean {
   if (!required) {
     return true;
   }
@@ -31,8 +35,67 @@ function hasEventScope(client: GatewayWsClient, event: string): boolean {
   return required.some((scope) => scopes.includes(scope));
 }
 
-export function createGatewayBroadcaster(params: { clients: Set<GatewayWsClient> }) {
+export type GatewayEventBus = Pick<NativeEventBus, "claim" | "commit" | "read" | "head">;
+
+function encodeBusTag(event: string, dropIfSlow: boolean | undefined): number {
+  return ((GUARDED_EVENTS.indexOf(event) + 1) << 1) | (dropIfSlow ? 1 : 0);
+}
+
+function decodeBusTag(tag: number): { required: string[] | undefined; dropIfSlow: boolean } {
+  const event = GUARDED_EVENTS[(tag >>> 1) - 1];
+  return { required: event ? EVENT_SCOPE_GUARDS[event] : undefined, dropIfSlow: (tag & 1) === 1 };
+}
+
+// Encoded once on first use and shared: ws writes each connection's frame
+// header and this same payload in one writev, where a string would be
+// UTF-8 encoded again into every socket's write queue
+function deliverFrame(
+  clients: Iterable<GatewayWsClient>,
+  frame: string | Buffer,
+  required: string[] | undefined,
+  dropIfSlow: boolean | undefined,
+) {
+  let encoded = typeof frame === "string" ? undefined : frame;
+  for (const c of clients) {
+    if (!hasEventScope(c, required)) {
+      continue;
+    }
+    const slow = c.socket.bufferedAmount > MAX_BUFFERED_BYTES;
+    if (slow && dropIfSlow) {
+      continue;
+    }
+    if (slow) {
+      try {
+        c.socket.close(1008, "slow consumer");
+      } catch {
+        /* ignore */
+      }
+      continue;
+    }
+    try {
+      encoded ??= Buffer.from(frame);
+      c.socket.send(encoded, { binary: false });
+    } catch {
+      /* ignore */
+    }
+  }
+}
+
+/**
+ * With a `bus`, event seqs come from the bus and every frame is published
+ * there; workers or processes owning other connections fan the same stream
+ * out with createGatewayEventFanout. This gateway's own clients are served
+ * the same way, by a fanout that is pumped right after each commit, so
+ * every client sees one stream in seq order and the ring is read back, not
+ * just written.
+ */
+export function createGatewayBroadcaster(params: {
+  clients: Set<GatewayWsClient>;
+  bus?: GatewayEventBus | null;
+}) {
+  const bus = params.bus ?? null;
   let seq = 0;
+  const fanout = bus ? createGatewayEventFanout({ clients: params.clients, bus }) : null;
   const broadcast = (
     event: string,
     payload: unknown,
@@ -41,14 +104,25 @@ export function createGatewayBroadcaster(params: { clients: Set<GatewayWsClient>
       stateVersion?: { presence?: number; health?: number };
     },
   ) => {
-    const eventSeq = ++seq;
-    const frame = JSON.stringify({
-      type: "event",
-      event,
-      payload,
-      seq: eventSeq,
-      stateVersion: opts?.stateVersion,
-    });
+    const eventSeq = bus ? bus.claim() : ++seq;
+    let frame: string;
+    try {
+      frame = JSON.stringify({
+        type: "event",
+        event,
+        payload,
+        seq: eventSeq,
+        stateVersion: opts?.stateVersion,
+      });
+    } catch (err) {
+      // A claimed seq must be committed or bus readers stall on it
+      bus?.commit(eventSeq, Buffer.alloc(0), encodeBusTag(event, true));
+      throw err;
+    }
+    // Committed before logging, which may throw, for the same reason
+    const encoded = bus ? Buffer.from(frame) : null;
+    const committed =
+      bus && encoded ? bus.commit(eventSeq, encoded, encodeBusTag(event, opts?.dropIfSlow)) : true;
     const logMeta: Record<string, unknown> = {
       event,
       seq: eventSeq,
@@ -61,28 +135,98 @@ export function createGatewayBroadcaster(params: { clients: Set<GatewayWsClient>
       Object.assign(logMeta, summarizeAgentEventForWsLog(payload));
     }
     logWs("out", "event", logMeta);
-    for (const c of params.clients) {
-      if (!hasEventScope(c, event)) {
-        continue;
-      }
-      const slow = c.socket.bufferedAmount > MAX_BUFFERED_BYTES;
-      if (slow && opts?.dropIfSlow) {
-        continue;
-      }
-      if (slow) {
-        try {
-          c.socket.close(1008, "slow consumer");
-        } catch {
-          /* ignore */
+    if (!fanout || !encoded) {
+      deliverFrame(params.clients, frame, EVENT_SCOPE_GUARDS[event], opts?.dropIfSlow);
+      return;
+    }
+    fanout.pump();
+    if (!committed) {
+      // Too large for the ring: other consumers count it as lost, while the
+      // pump above has delivered everything before it here
+      logWs("out", "event", { event, seq: eventSeq, busDropped: encoded.length });
+      deliverFrame(params.clients, encoded, EVENT_SCOPE_GUARDS[event], opts?.dropIfSlow);
+    }
+  };
+  return { broadcast };
+}
+
+/**
+ * Consumer side of the event bus: delivers every frame published after it
+ * is created to `clients`, with the same scope and slow-consumer rules as
+ * the broadcaster. Frames are forwarded as published, never re-serialized.
+ * Once started it polls every `pollMs` while idle and immediately while
+ * catching up; pump() reads without waiting for the poll.
+ */
+export function createGatewayEventFanout(params: {
+  clients: Set<GatewayWsClient>;
+  bus: GatewayEventBus;
+  pollMs?: number;
+  onLost?: (count: number) => void;
+}) {
+  const pollMs = Math.max(1, params.pollMs ?? 2);
+  let cursor = params.bus.head + 1;
+  let timer: ReturnType<typeof setTimeout> | null = null;
+  let running = false;
+  let pumping = false;
+  let pumpAgain = false;
+
+  const pump = (): number => {
+    if (pumping) {
+      // Called from a delivery (a send that broadcasts); the running pump
+      // reads again once done, so events stay in order
+      pumpAgain = true;
+      return 0;
+    }
+    pumping = true;
+    let count = 0;
+    try {
+      do {
+        pumpAgain = false;
+        const { events, next, lost } = params.bus.read(cursor);
+        cursor = next;
+        if (lost > 0) {
+          params.onLost?.(lost);
+        }
+        for (const evt of events) {
+          // Empty frames only hold the place of an event that failed to encode
+          if (evt.frame.length === 0) {
+            continue;
+          }
+          const { required, dropIfSlow } = decodeBusTag(evt.tag);
+          deliverFrame(params.clients, evt.frame, required, dropIfSlow);
         }
-        continue;
+        count += events.length + lost;
+      } while (pumpAgain);
+    } finally {
+      pumping = false;
+    }
+    return count;
+  };
+
+  const schedule = (delay: number) => {
+    timer = setTimeout(() => {
+      timer = null;
+      if (running) {
+        schedule(pump() > 0 ? 0 : pollMs);
       }
-      try {
-        c.socket.send(frame);
-      } catch {
-        /* ignore */
+    }, delay);
+    timer.unref?.();
+  };
+
+  return {
+    pump,
+    start() {
+      if (!running) {
+        running = true;
+        schedule(0);
       }
-    }
+    },
+    stop() {
+      running = false;
+      if (timer) {
+        clearTimeout(timer);
+        timer = null;
+      }
+    },
   };
-  return { broadcast };
 }
@@ -1,6 +1,9 @@
+import { existsSync } from "node:fs";
 import type { Server as HttpServer } from "node:http";
+import { join } from "node:path";
 import { WebSocketServer } from "ws";
 import type { CliDeps } from "../cli/deps.js";
+import type { GatewayEventBusConfig } from "../config/types.gateway.js";
 import type { createSubsystemLogger } from "../logging/subsystem.js";
 import type { PluginRegistry } from "../plugins/registry.js";
 import type { RuntimeEnv } from "../runtime.js";
@@ -12,8 +15,11 @@ import type { GatewayTlsRuntime } from "./server/tls.js";
 import type { GatewayWsClient } from "./server/ws-types.js";
 import { CANVAS_HOST_PATH } from "../canvas-host/a2ui.js";
 import { type CanvasHostHandler, createCanvasHostHandler } from "../canvas-host/server.js";
+import { resolveStateDir } from "../config/paths.js";
+import { getNativeEventBus } from "../ultra.js";
+import { resolveUserPath } from "../utils.js";
 import { resolveGatewayListenHosts } from "./net.js";
-import { createGatewayBroadcaster } from "./server-broadcast.js";
+import { createGatewayBroadcaster, type GatewayEventBus } from "./server-broadcast.js";
 import { type ChatRunEntry, createChatRunState } from "./server-chat.js";
 import { MAX_PAYLOAD_BYTES } from "./server-constants.js";
 import { attachGatewayUpgradeHandler, createGatewayHttpServer } from "./server-http.js";
@@ -21,6 +27,34 @@ import { createGatewayHooksRequestHandler } from "./server/hooks.js";
 import { listenGatewayHttpServer } from "./server/http-listen.js";
 import { createGatewayPluginRequestHandler } from "./server/plugins-http.js";
 
+function openGatewayEventBus(
+  cfg: GatewayEventBusConfig | undefined,
+  port: number,
+  log: { warn: (msg: string) => void },
+): GatewayEventBus | null {
+  if (!cfg?.enabled) {
+    return null;
+  }
+  const openBus = getNativeEventBus();
+  if (!openBus) {
+    log.warn("gateway: eventBus needs the native addon; broadcasting in-process only");
+    return null;
+  }
+  const path = cfg.path
+    ? resolveUserPath(cfg.path)
+    : join(
+        existsSync("/dev/shm") ? "/dev/shm" : resolveStateDir(),
+        `openclaw-gateway-${port}.events`,
+      );
+  try {
+    // Seqs restart with the gateway, as they do without a bus
+    return openBus(path, { slots: cfg.slots, dataBytes: cfg.dataBytes, reset: true });
+  } catch (err) {
+    log.warn(`gateway: failed to open event bus ${path} (${String(err)})`);
+    return null;
+  }
+}
+
 export async function createGatewayRuntimeState(params: {
   cfg: import("../config/config.js").OpenClawConfig;
   bindHost: string;
@@ -151,7 +185,10 @@ export async function createGatewayRuntimeState(params: {
   }
 
   const clients = new Set<GatewayWsClient>();
-  const { broadcast } = createGatewayBroadcaster({ clients });
+  const { broadcast } = createGatewayBroadcaster({
+    clients,
+    bus: openGatewayEventBus(params.cfg.gateway?.eventBus, params.port, params.log),
+  });
   const agentRunSeq = new Map<string, number>();
   const dedupe = new Map<string, DedupeEntry>();
   const chatRunState = createChatRunState();
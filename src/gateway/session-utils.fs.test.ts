@@ -1,11 +1,24 @@
 import fs from "node:fs";
 import os from "node:os";
 import path from "node:path";
-import { afterEach, beforeEach, describe, expect, test } from "vitest";
+import { afterEach, beforeEach, describe, expect, test, vi } from "vitest";
+import type { NativeTranscriptArchive } from "../ultra.js";
+
+const archiveState = vi.hoisted(() => ({
+  current: null as NativeTranscriptArchive | null,
+}));
+
+vi.mock("../ultra.js", () => ({
+  getNativeTranscriptArchive: () => archiveState.current,
+}));
+
 import {
+  archiveFileOnDisk,
   readFirstUserMessageFromTranscript,
   readLastMessagePreviewFromTranscript,
+  readSessionMessages,
   readSessionPreviewItemsFromTranscript,
+  waitForTranscriptPacking,
 } from "./session-utils.fs.js";
 
 describe("readFirstUserMessageFromTranscript", () => {
@@ -404,3 +417,104 @@ describe("readSessionPreviewItemsFromTranscript", () => {
     expect(result[0]?.text.endsWith("...")).toBe(true);
   });
 });
+
+describe("readSessionMessages", () => {
+  let tmpDir: string;
+  let storePath: string;
+
+  beforeEach(() => {
+    tmpDir = fs.mkdtempSync(path.join(os.tmpdir(), "openclaw-session-fs-test-"));
+    storePath = path.join(tmpDir, "sessions.json");
+  });
+
+  afterEach(() => {
+    fs.rmSync(tmpDir, { recursive: true, force: true });
+  });
+
+  test("returns the last `limit` messages in order", () => {
+    const sessionId = "messages-limit";
+    const transcriptPath = path.join(tmpDir, `${sessionId}.jsonl`);
+    const lines = [
+      JSON.stringify({ type: "session", version: 1, id: sessionId }),
+      ...[1, 2, 3, 4].map((n) => JSON.stringify({ message: { role: "user", content: `m${n}` } })),
+    ];
+    fs.writeFileSync(transcriptPath, `${lines.join("\n")}\n`, "utf-8");
+
+    expect(readSessionMessages(sessionId, storePath)).toHaveLength(4);
+    expect(readSessionMessages(sessionId, storePath, undefined, 2)).toEqual([
+      { role: "user", content: "m3" },
+      { role: "user", content: "m4" },
+    ]);
+  });
+
+  test("returns [] when no transcript exists", () => {
+    expect(readSessionMessages("missing", storePath, undefined, 10)).toEqual([]);
+  });
+
+  test("reads the last messages back from a packed archive", async () => {
+    // Stands in for the native packer: the "archive" is a copy of the JSONL
+    const read = vi.fn((file: string, query?: { lastMessages?: number }) => {
+      const lines = fs.readFileSync(file, "utf-8").split("\n").filter(Boolean);
+      const kept = query?.lastMessages ? lines.slice(-query.lastMessages) : lines;
+      return {
+        lines: kept,
+        firstLine: lines.length - kept.length,
+        totalLines: lines.length,
+        totalMessages: lines.length - 1,
+        blocksRead: 1,
+      };
+    });
+    let release = () => {};
+    const released = new Promise<void>((resolve) => {
+      release = resolve;
+    });
+    archiveState.current = {
+      pack: async (source, dest) => {
+        await released;
+        fs.copyFileSync(source, dest);
+        return { lines: 0, messages: 0, blocks: 1, bytes: 0 };
+      },
+      read,
+      readAsync: async (file, query) => read(file, query),
+    };
+    try {
+      const sessionId = "messages-packed";
+      const transcriptPath = path.join(tmpDir, `${sessionId}.jsonl`);
+      const lines = [
+        JSON.stringify({ type: "session", version: 1, id: sessionId }),
+        ...[1, 2, 3].map((n) => JSON.stringify({ message: { role: "user", content: `m${n}` } })),
+      ];
+      fs.writeFileSync(transcriptPath, `${lines.join("\n")}\n`, "utf-8");
+
+      // Returns the archive path before packing has run
+      const archived = archiveFileOnDisk(transcriptPath, "deleted");
+      expect(archived.startsWith(`${transcriptPath}.deleted.`)).toBe(true);
+      expect(archived.endsWith(".zst")).toBe(true);
+      expect(fs.existsSync(archived)).toBe(false);
+      expect(fs.existsSync(archived.slice(0, -".zst".length))).toBe(true);
+
+      release();
+      await waitForTranscriptPacking();
+      expect(fs.existsSync(archived)).toBe(true);
+      expect(fs.existsSync(transcriptPath)).toBe(false);
+      expect(fs.readdirSync(tmpDir)).toEqual([path.basename(archived)]);
+
+      expect(readSessionMessages(sessionId, storePath, undefined, 2)).toEqual([
+        { role: "user", content: "m2" },
+        { role: "user", content: "m3" },
+      ]);
+      expect(read).toHaveBeenCalledWith(archived, { lastMessages: 2 });
+    } finally {
+      archiveState.current = null;
+    }
+  });
+
+  test("keeps the plain archive path without the native module", () => {
+    const transcriptPath = path.join(tmpDir, "messages-plain.jsonl");
+    fs.writeFileSync(transcriptPath, "{}\n", "utf-8");
+
+    const archived = archiveFileOnDisk(transcriptPath, "deleted");
+    expect(archived.endsWith(".zst")).toBe(false);
+    expect(fs.existsSync(archived)).toBe(true);
+  });
+});
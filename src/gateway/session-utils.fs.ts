@@ -1,38 +1,104 @@
 import fs from "node:fs";
 import os from "node:os";
 import path from "node:path";
+import type { NativeTranscriptArchive } from "../ultra.js";
 import type { SessionPreviewItem } from "./session-utils.types.js";
 import { resolveSessionTranscriptPath } from "../config/sessions.js";
+import { getNativeTranscriptArchive } from "../ultra.js";
 import { stripEnvelope } from "./chat-sanitize.js";
 
+/**
+ * Suffix of a transcript packed into a seekable archive (zstd blocks plus a
+ * line index); `zstd -dc` still turns one back into JSONL.
+ */
+export const TRANSCRIPT_ARCHIVE_SUFFIX = ".zst";
+
+function collectMessages(lines: string[]): unknown[] {
+  const messages: unknown[] = [];
+  for (const line of lines) {
+    if (!line.trim()) {
+      continue;
+    }
+    try {
+      const parsed = JSON.parse(line);
+      if (parsed?.message) {
+        messages.push(parsed.message);
+      }
+    } catch {
+      // ignore bad lines
+    }
+  }
+  return messages;
+}
+
+/**
+ * Messages of a session's transcript, oldest first; with `limit`, only the
+ * last `limit`. When no plain transcript is left, the newest packed archive
+ * of one (`<path>.<reason>.<ts>.zst`, see archiveFileOnDisk) is read,
+ * decompressing just the blocks that hold those messages.
+ */
 export function readSessionMessages(
   sessionId: string,
   storePath: string | undefined,
   sessionFile?: string,
+  limit?: number,
 ): unknown[] {
   const candidates = resolveSessionTranscriptCandidates(sessionId, storePath, sessionFile);
+  for (const filePath of candidates) {
+    if (fs.existsSync(filePath)) {
+      const messages = collectMessages(fs.readFileSync(filePath, "utf-8").split(/\r?\n/));
+      return limit && messages.length > limit ? messages.slice(-limit) : messages;
+    }
+  }
 
-  const filePath = candidates.find((p) => fs.existsSync(p));
-  if (!filePath) {
+  const archive = getNativeTranscriptArchive();
+  if (!archive) {
     return [];
   }
+  for (const filePath of candidates) {
+    const packed = findPackedTranscript(filePath);
+    if (!packed) {
+      continue;
+    }
+    try {
+      const { lines } = archive.read(packed, limit ? { lastMessages: limit } : {});
+      const messages = collectMessages(lines);
+      return limit && messages.length > limit ? messages.slice(-limit) : messages;
+    } catch {
+      return [];
+    }
+  }
+  return [];
+}
 
-  const lines = fs.readFileSync(filePath, "utf-8").split(/\r?\n/);
-  const messages: unknown[] = [];
-  for (const line of lines) {
-    if (!line.trim()) {
+/** Newest packed archive of `filePath`, or null. */
+function findPackedTranscript(filePath: string): string | null {
+  const dir = path.dirname(filePath);
+  const prefix = `${path.basename(filePath)}.`;
+  let entries: string[];
+  try {
+    entries = fs.readdirSync(dir);
+  } catch {
+    return null;
+  }
+  let newest: string | null = null;
+  let newestMs = -Infinity;
+  for (const name of entries) {
+    if (!name.startsWith(prefix) || !name.endsWith(TRANSCRIPT_ARCHIVE_SUFFIX)) {
       continue;
     }
+    const candidate = path.join(dir, name);
     try {
-      const parsed = JSON.parse(line);
-      if (parsed?.message) {
-        messages.push(parsed.message);
+      const mtimeMs = fs.statSync(candidate).mtimeMs;
+      if (mtimeMs > newestMs) {
+        newest = candidate;
+        newestMs = mtimeMs;
       }
     } catch {
-      // ignore bad lines
+      // Removed while listing
     }
   }
-  return messages;
+  return newest;
 }
 
 export function resolveSessionTranscriptCandidates(
@@ -57,11 +123,49 @@ export function resolveSessionTranscriptCandidates(
   return candidates;
 }
 
+// Transcripts waiting to be packed. They go one at a time, so a burst of
+// deletes neither holds up its requests nor takes every native pool thread.
+let packQueue: Promise<void> = Promise.resolve();
+
+/**
+ * Renames `filePath` aside and returns where the archive lives. With the
+ * native module a transcript is queued to be packed into `<archived>.zst`
+ * and that path is returned at once; the archive appears whole (it is
+ * written to a temp file and renamed) and the plain copy is removed after
+ * it. If packing fails the plain `<archived>` stays. Without the module the
+ * plain path is returned. `filePath` may be recreated as soon as this
+ * returns.
+ */
 export function archiveFileOnDisk(filePath: string, reason: string): string {
   const ts = new Date().toISOString().replaceAll(":", "-");
   const archived = `${filePath}.${reason}.${ts}`;
   fs.renameSync(filePath, archived);
-  return archived;
+  const archive = filePath.endsWith(".jsonl") ? getNativeTranscriptArchive() : null;
+  if (!archive) {
+    return archived;
+  }
+  const packed = `${archived}${TRANSCRIPT_ARCHIVE_SUFFIX}`;
+  packQueue = packQueue.then(() => packArchivedTranscript(archive, archived, packed));
+  return packed;
+}
+
+/** Settles once every transcript queued so far is packed or given up on. */
+export function waitForTranscriptPacking(): Promise<void> {
+  return packQueue;
+}
+
+async function packArchivedTranscript(
+  archive: NativeTranscriptArchive,
+  archived: string,
+  packed: string,
+): Promise<void> {
+  try {
+    await archive.pack(archived, packed);
+  } catch {
+    await fs.promises.rm(packed, { force: true }).catch(() => {});
+    return;
+  }
+  await fs.promises.unlink(archived).catch(() => {});
 }
 
 function jsonUtf8Bytes(value: unknown): number {
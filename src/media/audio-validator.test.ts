@@ -1,8 +1,16 @@
 import { execFile } from "node:child_process";
 import fs from "node:fs/promises";
 import { describe, it, expect, vi, beforeEach, afterEach } from "vitest";
+import type { NativeMediaProbe, NativeProbeMedia } from "../ultra.js";
 import { AudioValidator, AudioValidationRateLimiter } from "./audio-validator.js";
 
+// Native header probe; null runs the JS signature check + ffprobe path
+const probeState = vi.hoisted(() => ({ current: null as NativeProbeMedia | null }));
+
+vi.mock("../ultra.js", () => ({
+  getNativeProbeMedia: () => probeState.current,
+}));
+
 // Mock fs and child_process
 vi.mock("node:fs/promises", () => ({
   default: {
@@ -39,6 +47,7 @@ describe("AudioValidator", () => {
 
   beforeEach(() => {
     vi.clearAllMocks();
+    probeState.current = null;
     validator = new AudioValidator();
   });
 
@@ -330,6 +339,127 @@ describe("AudioValidator", () => {
   });
 });
 
+describe("AudioValidator native header probe", () => {
+  const mp3Headers: NativeMediaProbe = {
+    mime: "audio/mpeg",
+    duration: 60,
+    sampleRate: 44100,
+    channels: 2,
+    bitrate: 128000,
+  };
+
+  function mockFileContents(contents: Buffer) {
+    vi.mocked(fs.stat).mockResolvedValue({ size: contents.length } as any);
+    vi.mocked(fs.open).mockResolvedValue({
+      read: vi.fn().mockImplementation((buf: Buffer, offset: number, length: number) => {
+        contents.copy(buf, offset, 0, length);
+        return Promise.resolve({ bytesRead: length });
+      }),
+      close: vi.fn().mockResolvedValue(undefined),
+    } as any);
+  }
+
+  function mockFfprobe() {
+    vi.mocked(execFile).mockImplementation((cmd, args, cb) => {
+      if (typeof cb === "function") {
+        cb(
+          null,
+          JSON.stringify({
+            format: { duration: "60", format_name: "mp3", bit_rate: "128000" },
+            streams: [{ channels: 2, sample_rate: "44100" }],
+          }),
+          "",
+        );
+      }
+      return undefined as any;
+    });
+  }
+
+  function mp3File(): Buffer {
+    const contents = Buffer.alloc(4096);
+    contents[0] = 0xff;
+    contents[1] = 0xfb;
+    return contents;
+  }
+
+  // A PDF with an MP3 stream inside: a header parser can find the audio,
+  // but the file does not start with an audio signature
+  function polyglotFile(): Buffer {
+    const contents = Buffer.alloc(4096);
+    contents.write("%PDF-1.7\n", 0, "ascii");
+    contents[1024] = 0xff;
+    contents[1025] = 0xfb;
+    return contents;
+  }
+
+  beforeEach(() => {
+    vi.clearAllMocks();
+    probeState.current = null;
+  });
+
+  function useNativeProbe(probed: NativeMediaProbe | null) {
+    const probe = vi.fn().mockReturnValue(probed);
+    probeState.current = { probe, headBytes: 1024, tailBytes: 256 };
+    return probe;
+  }
+
+  it.each([
+    ["native", true],
+    ["fallback", false],
+  ])("rejects a polyglot file on the %s path", async (_name, native) => {
+    if (native) {
+      useNativeProbe(mp3Headers);
+    }
+    mockFileContents(polyglotFile());
+    mockFfprobe();
+
+    const result = await new AudioValidator().validate("/test/polyglot.mp3");
+
+    expect(result.isValid).toBe(false);
+    expect(result.errors[0]).toContain("Invalid file signature");
+    expect(execFile).not.toHaveBeenCalled();
+  });
+
+  it.each([
+    ["native", true],
+    ["fallback", false],
+  ])("accepts an MP3 signature on the %s path", async (_name, native) => {
+    if (native) {
+      useNativeProbe(mp3Headers);
+    }
+    mockFileContents(mp3File());
+    mockFfprobe();
+
+    const result = await new AudioValidator().validate("/test/audio.mp3");
+
+    expect(result.isValid).toBe(true);
+    expect(result).toMatchObject({ format: "mp3", duration: 60, channels: 2, sampleRate: 44100 });
+  });
+
+  it("skips ffprobe when the headers describe the stream", async () => {
+    const probe = useNativeProbe(mp3Headers);
+    mockFileContents(mp3File());
+    mockFfprobe();
+
+    const result = await new AudioValidator().validate("/test/audio.mp3");
+
+    expect(result.isValid).toBe(true);
+    expect(probe).toHaveBeenCalledTimes(1);
+    expect(execFile).not.toHaveBeenCalled();
+  });
+
+  it("falls back to ffprobe when the headers are incomplete", async () => {
+    useNativeProbe(null);
+    mockFileContents(mp3File());
+    mockFfprobe();
+
+    const result = await new AudioValidator().validate("/test/audio.mp3");
+
+    expect(result.isValid).toBe(true);
+    expect(execFile).toHaveBeenCalledTimes(1);
+  });
+});
+
 describe("AudioValidationRateLimiter", () => {
   let limiter: AudioValidationRateLimiter;
 
@@ -1,6 +1,7 @@
 import { execFile } from "node:child_process";
 import fs from "node:fs/promises";
 import { promisify } from "node:util";
+import { getNativeProbeMedia, type NativeMediaProbe, type NativeProbeMedia } from "../ultra.js";
 
 const execFileAsync = promisify(execFile);
 
@@ -45,16 +46,22 @@ export class AudioValidator {
       return this.createInvalidMetadata(errors);
     }
 
-    // 2. Check magic bytes
-    const isValidSignature = await this.validateFileSignature(filePath);
+    // 2. Check magic bytes; natively, the stream headers are parsed in the same read
+    const native = getNativeProbeMedia();
+    const headers = native ? await this.probeHeaders(filePath, stats.size, native) : null;
+    const isValidSignature = headers
+      ? hasAudioSignature(headers.head)
+      : await this.validateFileSignature(filePath);
     if (!isValidSignature) {
       errors.push("Invalid file signature - possible polyglot file");
       return this.createInvalidMetadata(errors);
     }
 
-    // 3. Probe with ffprobe
+    // 3. Probe with ffprobe, unless the headers already described the stream
     try {
-      const metadata = await this.probeWithFfprobe(filePath);
+      const metadata =
+        (headers?.probed && metadataFromHeaders(headers.probed)) ??
+        (await this.probeWithFfprobe(filePath));
 
       if (metadata.duration > this.config.maxDurationSeconds) {
         errors.push(`Duration too long: ${metadata.duration}s`);
@@ -87,24 +94,34 @@ export class AudioValidator {
     };
   }
 
+  // The first headBytes of the file and what the native parser made of them
+  private async probeHeaders(
+    filePath: string,
+    size: number,
+    native: NativeProbeMedia,
+  ): Promise<{ head: Buffer; probed: NativeMediaProbe | null }> {
+    const file = await fs.open(filePath, "r");
+
+    try {
+      const head = Buffer.alloc(Math.min(size, native.headBytes));
+      await file.read(head, 0, head.length, 0);
+      const tail = Buffer.alloc(Math.min(size - head.length, native.tailBytes));
+      if (tail.length > 0) {
+        await file.read(tail, 0, tail.length, size - tail.length);
+      }
+      return { head, probed: native.probe(head, { tail, size }) };
+    } finally {
+      await file.close();
+    }
+  }
+
   private async validateFileSignature(filePath: string): Promise<boolean> {
     const file = await fs.open(filePath, "r");
     const buffer = Buffer.alloc(16);
 
     try {
       await file.read(buffer, 0, 16, 0);
-
-      // OGG
-      if (buffer.toString("ascii", 0, 4) === "OggS") return true;
-      // MP3
-      if (buffer[0] === 0xff && (buffer[1] & 0xe0) === 0xe0) return true;
-      // RIFF/WAVE
-      if (buffer.toString("ascii", 0, 4) === "RIFF" && buffer.toString("ascii", 8, 12) === "WAVE")
-        return true;
-      // M4A/MP4
-      if (buffer.toString("ascii", 4, 8) === "ftyp") return true;
-
-      return false;
+      return hasAudioSignature(buffer);
     } finally {
       await file.close();
     }
@@ -135,6 +152,51 @@ export class AudioValidator {
   }
 }
 
+// Magic bytes at the start of the file, whichever path read them; the native
+// probe only fills in metadata, so both paths accept the same files
+function hasAudioSignature(buffer: Buffer): boolean {
+  // OGG
+  if (buffer.toString("ascii", 0, 4) === "OggS") return true;
+  // MP3
+  if (buffer[0] === 0xff && (buffer[1] & 0xe0) === 0xe0) return true;
+  // RIFF/WAVE
+  if (buffer.toString("ascii", 0, 4) === "RIFF" && buffer.toString("ascii", 8, 12) === "WAVE")
+    return true;
+  // M4A/MP4
+  if (buffer.toString("ascii", 4, 8) === "ftyp") return true;
+
+  return false;
+}
+
+// ffprobe's format_name (first entry) for each container
+function formatFromMime(mime: string): string {
+  if (mime.includes("ogg")) {
+    return "ogg";
+  }
+  if (mime === "audio/mpeg") {
+    return "mp3";
+  }
+  if (mime === "audio/wav") {
+    return "wav";
+  }
+  return "mov";
+}
+
+function metadataFromHeaders(
+  probed: NativeMediaProbe,
+): Omit<AudioMetadata, "isValid" | "errors"> | null {
+  if (!probed.duration || !probed.sampleRate || !probed.channels) {
+    return null;
+  }
+  return {
+    format: formatFromMime(probed.mime),
+    duration: probed.duration,
+    bitrate: probed.bitrate ?? 0,
+    channels: probed.channels,
+    sampleRate: probed.sampleRate,
+  };
+}
+
 interface RateLimitEntry {
   count: number;
   resetTime: number;
@@ -2,6 +2,7 @@ import fs from "node:fs/promises";
 import os from "node:os";
 import path from "node:path";
 import { runExec } from "../process/exec.js";
+import { getNativeProbeMedia, getNativeResizeJpeg } from "../ultra.js";
 
 type Sharp = typeof import("sharp");
 
@@ -36,6 +37,11 @@ async function loadSharp(): Promise<(buffer: Buffer) => ReturnType<Sharp>> {
  * 5 = Rotate 270 CW + Flip H, 6 = Rotate 90 CW, 7 = Rotate 90 CW + Flip H, 8 = Rotate 270 CW
  */
 function readJpegExifOrientation(buffer: Buffer): number | null {
+  const probed = getNativeProbeMedia()?.probe(buffer);
+  if (probed) {
+    return probed.mime === "image/jpeg" ? (probed.orientation ?? null) : null;
+  }
+
   // Check JPEG magic bytes
   if (buffer.length < 2 || buffer[0] !== 0xff || buffer[1] !== 0xd8) {
     return null;
@@ -206,6 +212,12 @@ async function sipsConvertToJpeg(buffer: Buffer): Promise<Buffer> {
 }
 
 export async function getImageMetadata(buffer: Buffer): Promise<ImageMetadata | null> {
+  // Dimensions are in the headers; no need to hand the image to sharp or sips
+  const probed = getNativeProbeMedia()?.probe(buffer);
+  if (probed?.mime.startsWith("image/") && probed.width && probed.height) {
+    return { width: probed.width, height: probed.height };
+  }
+
   if (prefersSips()) {
     return await sipsMetadataFromBuffer(buffer).catch(() => null);
   }
@@ -273,12 +285,43 @@ async function sipsApplyOrientation(buffer: Buffer, orientation: number): Promis
   });
 }
 
+/**
+ * Resizes and orients a JPEG in the native addon, when it is loaded.
+ * Returns null when the caller should use sharp or sips instead.
+ */
+async function nativeResizeJpeg(
+  buffer: Buffer,
+  options: { maxSide?: number; quality: number; withoutEnlargement?: boolean },
+): Promise<Buffer | null> {
+  const native = getNativeResizeJpeg();
+  if (!native || buffer.length < 3 || buffer[0] !== 0xff || buffer[1] !== 0xd8) {
+    return null;
+  }
+  try {
+    return (await native.resize(buffer, options))?.data ?? null;
+  } catch {
+    return null;
+  }
+}
+
 /**
  * Normalizes EXIF orientation in an image buffer.
  * Returns the buffer with correct pixel orientation (rotated if needed).
  * Falls back to original buffer if normalization fails.
  */
 export async function normalizeExifOrientation(buffer: Buffer): Promise<Buffer> {
+  if (getNativeResizeJpeg() && buffer[0] === 0xff && buffer[1] === 0xd8) {
+    const orientation = readJpegExifOrientation(buffer);
+    if (!orientation || orientation === 1) {
+      return buffer; // No rotation needed
+    }
+    // Same quality sharp re-encodes with by default
+    const rotated = await nativeResizeJpeg(buffer, { quality: 80 });
+    if (rotated) {
+      return rotated;
+    }
+  }
+
   if (prefersSips()) {
     try {
       const orientation = readJpegExifOrientation(buffer);
@@ -307,6 +350,15 @@ export async function resizeToJpeg(params: {
   quality: number;
   withoutEnlargement?: boolean;
 }): Promise<Buffer> {
+  const native = await nativeResizeJpeg(params.buffer, {
+    maxSide: params.maxSide,
+    quality: params.quality,
+    withoutEnlargement: params.withoutEnlargement,
+  });
+  if (native) {
+    return native;
+  }
+
   if (prefersSips()) {
     // Normalize EXIF orientation BEFORE resizing (sips resize doesn't auto-rotate)
     const normalized = await normalizeExifOrientationSips(params.buffer);
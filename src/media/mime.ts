@@ -1,5 +1,6 @@
 import { fileTypeFromBuffer } from "file-type";
 import path from "node:path";
+import { getNativeProbeMedia } from "../ultra.js";
 import { type MediaKind, mediaKindFromMime } from "./constants.js";
 
 // Map common mimes to preferred file extensions.
@@ -63,6 +64,11 @@ async function sniffMime(buffer?: Buffer): Promise<string | undefined> {
   if (!buffer) {
     return undefined;
   }
+  // Common media formats by header alone; file-type covers the rest
+  const probed = getNativeProbeMedia()?.probe(buffer);
+  if (probed) {
+    return probed.mime;
+  }
   try {
     const type = await fileTypeFromBuffer(buffer);
     return type?.mime ?? undefined;
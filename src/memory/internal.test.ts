@@ -2,7 +2,15 @@ import fs from "node:fs/promises";
 import os from "node:os";
 import path from "node:path";
 import { afterEach, beforeEach, describe, expect, it } from "vitest";
-import { chunkMarkdown, listMemoryFiles, normalizeExtraMemoryPaths } from "./internal.js";
+import {
+  buildFileEntries,
+  buildFileEntry,
+  chunkMarkdown,
+  chunkMarkdownForIndex,
+  listMemoryFiles,
+  normalizeExtraMemoryPaths,
+  splitToTokenBudget,
+} from "./internal.js";
 
 describe("normalizeExtraMemoryPaths", () => {
   it("trims, resolves, and dedupes paths", () => {
@@ -123,3 +131,85 @@ describe("chunkMarkdown", () => {
     }
   });
 });
+
+describe("chunkMarkdownForIndex", () => {
+  it("matches chunkMarkdown on the decoded buffer without blank chunks", async () => {
+    const content = ["# Title", "", "body ✓ 😀", " \t ", "", "x".repeat(300), "tail"].join("\n");
+    const chunking = { tokens: 20, overlap: 4 };
+    const expected = chunkMarkdown(content, chunking).filter((chunk) => chunk.text.trim().length > 0);
+    const chunks = await chunkMarkdownForIndex(Buffer.from(content), chunking);
+    expect(chunks.map((chunk) => ({ ...chunk }))).toEqual(expected);
+  });
+});
+
+describe("splitToTokenBudget", () => {
+  // One token per UTF-16 code unit
+  const tokenizer = {
+    countMany: (texts: Array<string | Uint8Array>) =>
+      Uint32Array.from(texts.map((text) => text.length)),
+    prefix: (text: string | Uint8Array, maxTokens: number) => {
+      const length = Math.min(text.length, maxTokens);
+      return { bytes: length, length, tokens: length };
+    },
+  };
+
+  it("re-cuts over-budget chunks at line breaks and keeps the rest", () => {
+    const chunks = chunkMarkdown(["aaaa", "bbbb", "cccc", "", "dd"].join("\n"), {
+      tokens: 100,
+      overlap: 0,
+    });
+    const split = splitToTokenBudget(
+      [...chunks, { startLine: 9, endLine: 9, text: "ok", hash: "h" }],
+      10,
+      tokenizer,
+    );
+    expect(split.map(({ startLine, endLine, text }) => ({ startLine, endLine, text }))).toEqual([
+      { startLine: 1, endLine: 2, text: "aaaa\nbbbb" },
+      { startLine: 3, endLine: 5, text: "cccc\n\ndd" },
+      { startLine: 9, endLine: 9, text: "ok" },
+    ]);
+    expect(split[2]?.hash).toBe("h");
+  });
+
+  it("cuts inside a line that alone exceeds the budget", () => {
+    const [chunk] = chunkMarkdown("x".repeat(25), { tokens: 100, overlap: 0 });
+    const split = splitToTokenBudget(chunk ? [chunk] : [], 10, tokenizer);
+    expect(split.map((entry) => entry.text.length)).toEqual([10, 10, 5]);
+    expect(split.every((entry) => entry.startLine === 1 && entry.endLine === 1)).toBe(true);
+  });
+});
+
+describe("buildFileEntries", () => {
+  let tmpDir: string;
+
+  beforeEach(async () => {
+    tmpDir = await fs.mkdtemp(path.join(os.tmpdir(), "memory-entries-"));
+  });
+
+  afterEach(async () => {
+    await fs.rm(tmpDir, { recursive: true, force: true });
+  });
+
+  it("reuses manifest hashes only while size and mtime match", async () => {
+    const same = path.join(tmpDir, "same.md");
+    const edited = path.join(tmpDir, "edited.md");
+    await fs.writeFile(same, "# Same");
+    await fs.writeFile(edited, "# Before");
+    const [sameEntry, editedEntry] = await Promise.all(
+      [same, edited].map((file) => buildFileEntry(file, tmpDir)),
+    );
+    await fs.writeFile(edited, "# After, longer");
+
+    const manifest = new Map(
+      [sameEntry, editedEntry].map((entry) => [
+        entry.path,
+        { size: entry.size, mtimeMs: entry.mtimeMs, hash: `recorded-${entry.path}` },
+      ]),
+    );
+    const entries = await buildFileEntries([same, edited], tmpDir, manifest);
+    expect(entries.map((entry) => entry.hash)).toEqual([
+      "recorded-same.md",
+      (await buildFileEntry(edited, tmpDir)).hash,
+    ]);
+  });
+});
@@ -2,6 +2,13 @@ import crypto from "node:crypto";
 import fsSync from "node:fs";
 import fs from "node:fs/promises";
 import path from "node:path";
+import {
+  getNativeChunkMarkdown,
+  getNativeHashFiles,
+  type NativeFileManifestEntry,
+  type NativeMarkdownChunks,
+  type NativeTokenizer,
+} from "../ultra.js";
 
 export type MemoryFileEntry = {
   path: string;
@@ -163,6 +170,64 @@ export async function buildFileEntry(
   };
 }
 
+/** True when the file still has the recorded size and mtime. */
+export async function fileStatMatches(
+  absPath: string,
+  prior: { size: number; mtimeMs: number },
+): Promise<boolean> {
+  try {
+    const stat = await fs.stat(absPath);
+    return stat.size === prior.size && stat.mtimeMs === prior.mtimeMs;
+  } catch {
+    return false;
+  }
+}
+
+/** Last indexed state of each file, keyed by MemoryFileEntry.path. */
+export type MemoryFileManifest = Map<string, NativeFileManifestEntry>;
+
+/**
+ * buildFileEntry() for many files. A file whose size and mtime match its
+ * manifest entry keeps the recorded hash without being read; the rest are
+ * hashed on the native thread pool when it is loaded. Native hashes equal
+ * hashText() of the decoded text, invalid UTF-8 included.
+ */
+export async function buildFileEntries(
+  absPaths: string[],
+  workspaceDir: string,
+  manifest: MemoryFileManifest = new Map(),
+): Promise<MemoryFileEntry[]> {
+  const relPaths = absPaths.map((absPath) =>
+    path.relative(workspaceDir, absPath).replace(/\\/g, "/"),
+  );
+  const known = relPaths.map((relPath) => manifest.get(relPath));
+  const hashFiles = getNativeHashFiles();
+  if (!hashFiles) {
+    return Promise.all(
+      absPaths.map(async (absPath, i) => {
+        const prior = known[i];
+        if (prior && (await fileStatMatches(absPath, prior))) {
+          return { path: relPaths[i], absPath, ...prior };
+        }
+        return buildFileEntry(absPath, workspaceDir);
+      }),
+    );
+  }
+
+  const entries: Array<MemoryFileEntry | undefined> = absPaths.map((absPath, i) => {
+    const prior = known[i];
+    return prior ? { path: relPaths[i], absPath, ...prior } : undefined;
+  });
+  for (const hashed of await hashFiles(absPaths, { algorithm: "sha256", manifest: known })) {
+    if ("error" in hashed) {
+      throw new Error(hashed.error);
+    }
+    const { index, size, mtimeMs, hash } = hashed;
+    entries[index] = { path: relPaths[index], absPath: absPaths[index], mtimeMs, size, hash };
+  }
+  return entries.filter((entry): entry is MemoryFileEntry => entry !== undefined);
+}
+
 export function chunkMarkdown(
   content: string,
   chunking: { tokens: number; overlap: number },
@@ -246,6 +311,151 @@ export function chunkMarkdown(
   return chunks;
 }
 
+/**
+ * Non-blank chunks of a memory file, as chunkMarkdown() would produce them.
+ *
+ * For a Buffer, the native chunker (when loaded) splits and hashes the raw
+ * bytes off the main thread; each chunk's text is only decoded on first read,
+ * so chunks whose embeddings are cached never become strings until stored.
+ */
+export async function chunkMarkdownForIndex(
+  content: string | Buffer,
+  chunking: { tokens: number; overlap: number },
+  tokenizer?: ChunkTokenizer | null,
+): Promise<MemoryChunk[]> {
+  const chunks = await chunkMarkdownByChars(content, chunking);
+  return tokenizer ? splitToTokenBudget(chunks, chunking.tokens, tokenizer) : chunks;
+}
+
+async function chunkMarkdownByChars(
+  content: string | Buffer,
+  chunking: { tokens: number; overlap: number },
+): Promise<MemoryChunk[]> {
+  if (typeof content === "string") {
+    return chunkMarkdown(content, chunking).filter((chunk) => chunk.text.trim().length > 0);
+  }
+  const native = getNativeChunkMarkdown();
+  const result =
+    native && Number.isInteger(chunking.tokens) && Number.isInteger(chunking.overlap)
+      ? await native(content, chunking)
+      : null;
+  if (!result) {
+    return chunkMarkdownByChars(content.toString("utf-8"), chunking);
+  }
+  const chunks: MemoryChunk[] = [];
+  for (let i = 0; i < result.starts.length; i += 1) {
+    if (result.blank[i] === 0) {
+      chunks.push(lazyChunk(content, result, i));
+    }
+  }
+  return chunks;
+}
+
+export type ChunkTokenizer = Pick<NativeTokenizer, "countMany" | "prefix">;
+
+/**
+ * Re-cuts chunks that the 4-chars-per-token estimate let run over
+ * `maxTokens` real tokens, preferring the last line break inside the budget.
+ * Chunks within budget are returned as they are.
+ */
+export function splitToTokenBudget(
+  chunks: MemoryChunk[],
+  maxTokens: number,
+  tokenizer: ChunkTokenizer,
+): MemoryChunk[] {
+  const budget = Math.max(1, Math.floor(maxTokens));
+  const counts = tokenizer.countMany(chunks.map((chunk) => chunk.text));
+  const out: MemoryChunk[] = [];
+  for (let i = 0; i < chunks.length; i += 1) {
+    const chunk = chunks[i];
+    if (!chunk) {
+      continue;
+    }
+    if ((counts[i] ?? 0) <= budget) {
+      out.push(chunk);
+      continue;
+    }
+    let rest = chunk.text;
+    let line = chunk.startLine;
+    while (rest.length > 0) {
+      const { length } = tokenizer.prefix(rest, budget);
+      let text = rest;
+      let next = "";
+      let nextLine = line;
+      if (length < rest.length) {
+        const newline = rest.lastIndexOf("\n", length - 1);
+        // A single token can end inside a code point; always take at least one
+        const cut =
+          newline > 0 ? newline : Math.max(length, (rest.codePointAt(0) ?? 0) > 0xffff ? 2 : 1);
+        text = rest.slice(0, cut);
+        next = rest.slice(newline > 0 ? cut + 1 : cut);
+        nextLine = line + countNewlines(text) + (newline > 0 ? 1 : 0);
+      }
+      if (text.trim().length > 0) {
+        out.push({
+          startLine: Math.min(line, chunk.endLine),
+          endLine: Math.min(line + countNewlines(text), chunk.endLine),
+          text,
+          hash: hashText(text),
+        });
+      }
+      rest = next;
+      line = nextLine;
+    }
+  }
+  return out;
+}
+
+function countNewlines(text: string): number {
+  let count = 0;
+  for (let i = text.indexOf("\n"); i !== -1; i = text.indexOf("\n", i + 1)) {
+    count += 1;
+  }
+  return count;
+}
+
+function lazyChunk(buffer: Buffer, result: NativeMarkdownChunks, index: number): MemoryChunk {
+  let text: string | undefined;
+  return {
+    startLine: result.startLines[index],
+    endLine: result.endLines[index],
+    hash: result.hashes.toString("hex", index * 32, index * 32 + 32),
+    get text() {
+      text ??= chunkText(buffer, result, index);
+      return text;
+    },
+  };
+}
+
+// The chunk's byte range with "\n" re-inserted where long lines were cut,
+// the same join chunkMarkdown() applies to segments
+function chunkText(buffer: Buffer, result: NativeMarkdownChunks, index: number): string {
+  const start = result.starts[index];
+  const end = result.ends[index];
+  const breaks = result.breaks;
+  let lo = 0;
+  let hi = breaks.length;
+  while (lo < hi) {
+    const mid = (lo + hi) >>> 1;
+    if (breaks[mid] <= start) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  if (lo >= breaks.length || breaks[lo] >= end) {
+    return buffer.toString("utf-8", start, end);
+  }
+  const parts: string[] = [];
+  let from = start;
+  for (let i = lo; i < breaks.length && breaks[i] < end; i += 1) {
+    parts.push(buffer.toString("utf-8", from, breaks[i]));
+    from = breaks[i];
+  }
+  parts.push(buffer.toString("utf-8", from, end));
+  return parts.join("\n");
+}
+
 export function parseEmbedding(raw: string): number[] {
   try {
     const parsed = JSON.parse(raw) as number[];
@@ -42,6 +42,8 @@ export function computeMemoryManagerCacheKey(params: {
         vector: {
           enabled: settings.store.vector.enabled,
           extensionPath: settings.store.vector.extensionPath,
+          backend: settings.store.vector.backend,
+          hnsw: settings.store.vector.hnsw,
         },
       },
       chunking: settings.chunking,
@@ -0,0 +1,252 @@
+import type { DatabaseSync } from "node:sqlite";
+import fs from "node:fs";
+import { truncateUtf16Safe } from "../utils.js";
+import { parseEmbedding } from "./internal.js";
+import type { SearchRowResult, SearchSource } from "./manager-search.js";
+import { CHUNK_CHANGES_KEY } from "./memory-schema.js";
+
+const STAMP_VERSION = 2;
+const REBUILD_BATCH_ROWS = 10_000;
+
+type DerivedStamp = {
+  version: number;
+  fingerprint: string;
+};
+
+/**
+ * Lifecycle shared by the indexes the memory manager derives from the
+ * chunks table: open() loads or rebuilds once, reset() starts over empty
+ * for a full reindex, discard() forgets the in-memory state, and upsert /
+ * removeFile keep the index current between syncs.
+ *
+ * An index saved next to the DB is tagged with a stamp file holding the
+ * fingerprint of the chunks it covers. The stamp is removed before the
+ * first change after a save, so whatever a crash or another writer leaves
+ * behind fails the check on the next open and is rebuilt.
+ */
+export abstract class DerivedChunkIndex<TIndex> {
+  protected index: TIndex | null = null;
+  protected opened = false;
+  protected dirty = false;
+  private opening: Promise<void> | null = null;
+
+  /** `stampPath` is omitted for indexes that are never saved. */
+  protected constructor(private readonly stampPath?: string) {}
+
+  /** Loads or rebuilds the index for `model` once; later calls are no-ops. */
+  async open(db: DatabaseSync, model: string): Promise<void> {
+    if (this.opened) {
+      return;
+    }
+    if (!this.opening) {
+      this.opening = this.load(db, model).finally(() => {
+        this.opening = null;
+      });
+    }
+    await this.opening;
+  }
+
+  /**
+   * Starts over with an empty index for a full reindex; the chunks that the
+   * reindex writes arrive through upsert().
+   */
+  reset(): void {
+    this.touch();
+    this.drop();
+    this.opened = true;
+  }
+
+  /** Drops the in-memory state; the next open() checks the saved index again. */
+  discard(): void {
+    this.index = null;
+    this.opened = false;
+    this.dirty = false;
+  }
+
+  /** Removes the chunks of one file; call before deleting them from SQLite. */
+  removeFile(db: DatabaseSync, filePath: string, source: SearchSource): void {
+    if (!this.index) {
+      return;
+    }
+    const rows = db
+      .prepare(`SELECT id FROM chunks WHERE path = ? AND source = ?`)
+      .all(filePath, source) as Array<{ id: string }>;
+    for (const row of rows) {
+      this.removeChunk(row.id);
+    }
+  }
+
+  protected abstract load(db: DatabaseSync, model: string): Promise<void>;
+
+  protected abstract removeChunk(id: string): void;
+
+  // Empties the index for reset(); saved files are the subclass's to delete
+  protected drop(): void {
+    this.index = null;
+  }
+
+  // First change since the last save: the stamp no longer describes the file
+  protected touch(): void {
+    if (!this.dirty) {
+      if (this.stampPath) {
+        fs.rmSync(this.stampPath, { force: true });
+      }
+      this.dirty = true;
+    }
+  }
+
+  /** Tags the saved index as covering the current chunks of `model`. */
+  protected async writeStamp<T extends object>(
+    db: DatabaseSync,
+    model: string,
+    extra: T,
+  ): Promise<void> {
+    if (!this.stampPath) {
+      return;
+    }
+    const stamp = { ...extra, version: STAMP_VERSION, fingerprint: fingerprint(db, model) };
+    await fs.promises.writeFile(this.stampPath, JSON.stringify(stamp));
+    this.dirty = false;
+  }
+
+  /** The saved stamp when it still matches the chunks of `model`, else null. */
+  protected async readStamp<T extends object>(
+    db: DatabaseSync,
+    model: string,
+  ): Promise<(DerivedStamp & T) | null> {
+    if (!this.stampPath) {
+      return null;
+    }
+    try {
+      const parsed = JSON.parse(await fs.promises.readFile(this.stampPath, "utf-8")) as
+        | (DerivedStamp & T)
+        | null;
+      return parsed?.version === STAMP_VERSION && parsed.fingerprint === fingerprint(db, model)
+        ? parsed
+        : null;
+    } catch {
+      return null;
+    }
+  }
+}
+
+// Changes whenever chunks are written: the trigger-kept write counter
+// catches a replace that leaves the count and newest timestamp unchanged
+function fingerprint(db: DatabaseSync, model: string): string {
+  const changes = db.prepare(`SELECT value FROM meta WHERE key = ?`).get(CHUNK_CHANGES_KEY) as
+    | { value: string }
+    | undefined;
+  const row = db
+    .prepare(`SELECT COUNT(*) AS n, MAX(updated_at) AS t FROM chunks WHERE model = ?`)
+    .get(model) as { n: number; t: number | null } | undefined;
+  return `${model}:${changes?.value ?? 0}:${row?.n ?? 0}:${row?.t ?? 0}`;
+}
+
+/**
+ * Calls `visit` with the chunks of `model` in rowid order, a page of rows
+ * at a time so only one page is materialised, yielding to the event loop
+ * between pages. `columns` are selected next to rowid; returning false
+ * from `visit` stops early.
+ */
+export async function forEachChunkPage<Row extends { rowid: number }>(
+  db: DatabaseSync,
+  model: string,
+  columns: string,
+  visit: (rows: Row[]) => boolean | void | Promise<boolean | void>,
+): Promise<void> {
+  const page = db.prepare(
+    `SELECT rowid, ${columns} FROM chunks WHERE model = ? AND rowid > ? ORDER BY rowid LIMIT ?`,
+  );
+  let after = 0;
+  for (;;) {
+    const rows = page.all(model, after, REBUILD_BATCH_ROWS) as Row[];
+    if (rows.length === 0) {
+      return;
+    }
+    after = rows[rows.length - 1].rowid;
+    if ((await visit(rows)) === false) {
+      return;
+    }
+    await new Promise((resolve) => setImmediate(resolve));
+  }
+}
+
+/**
+ * Stored embeddings of `model` as pages of ids and row-major matrices. The
+ * first non-empty embedding fixes the dimension; rows of any other
+ * dimension are skipped.
+ */
+export async function forEachEmbeddingPage(
+  db: DatabaseSync,
+  model: string,
+  visit: (ids: string[], matrix: Float32Array, dims: number) => void | Promise<void>,
+): Promise<void> {
+  let dims = 0;
+  await forEachChunkPage<{ rowid: number; id: string; embedding: string }>(
+    db,
+    model,
+    "id, embedding",
+    async (rows) => {
+      const ids: string[] = [];
+      const vectors: number[][] = [];
+      for (const row of rows) {
+        const embedding = parseEmbedding(row.embedding);
+        dims ||= embedding.length;
+        if (embedding.length === 0 || embedding.length !== dims) {
+          continue;
+        }
+        ids.push(row.id);
+        vectors.push(embedding);
+      }
+      if (ids.length > 0) {
+        const matrix = new Float32Array(ids.length * dims);
+        vectors.forEach((vector, i) => matrix.set(vector, i * dims));
+        await visit(ids, matrix, dims);
+      }
+    },
+  );
+}
+
+/**
+ * Search rows (score 0) for the chunks among `ids` that belong to `model`
+ * and pass `sourceFilter`, keyed by id.
+ */
+export function loadChunkRows(params: {
+  db: DatabaseSync;
+  ids: string[];
+  providerModel: string;
+  snippetMaxChars: number;
+  sourceFilter: { sql: string; params: SearchSource[] };
+}): Map<string, SearchRowResult> {
+  const byId = new Map<string, SearchRowResult>();
+  if (params.ids.length === 0) {
+    return byId;
+  }
+  const placeholders = params.ids.map(() => "?").join(", ");
+  const rows = params.db
+    .prepare(
+      `SELECT id, path, start_line, end_line, text, source\n` +
+        `  FROM chunks\n` +
+        ` WHERE id IN (${placeholders}) AND model = ?${params.sourceFilter.sql}`,
+    )
+    .all(...params.ids, params.providerModel, ...params.sourceFilter.params) as Array<{
+    id: string;
+    path: string;
+    start_line: number;
+    end_line: number;
+    text: string;
+    source: SearchSource;
+  }>;
+  for (const row of rows) {
+    byId.set(row.id, {
+      id: row.id,
+      path: row.path,
+      startLine: row.start_line,
+      endLine: row.end_line,
+      score: 0,
+      snippet: truncateUtf16Safe(row.text, params.snippetMaxChars),
+      source: row.source,
+    });
+  }
+  return byId;
+}
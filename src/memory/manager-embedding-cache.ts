@@ -0,0 +1,136 @@
+import fs from "node:fs";
+import path from "node:path";
+import { createSubsystemLogger } from "../logging/subsystem.js";
+import { getNativeEmbeddingCache, hasNativeClass, type NativeEmbeddingCache } from "../ultra.js";
+
+const log = createSubsystemLogger("memory");
+
+const DEFAULT_CAPACITY = 1 << 16;
+
+/**
+ * Embedding cache shared by every agent on the host, keyed by provider key
+ * and chunk hash. One mmapped file per provider key lives in `dir`; reads
+ * are lock-free across workers and processes, writes take a file lock.
+ *
+ * It sits in front of the per-agent SQLite embedding_cache table: a chunk
+ * another agent (or an earlier index) already embedded is not sent to the
+ * provider again. Any native error disables it for the rest of the process.
+ */
+export class SharedEmbeddingCache {
+  private handle: NativeEmbeddingCache | null = null;
+  private handleKey: string | null = null;
+  private disabled = false;
+  // Provider key whose file has no header yet; lookups miss until a store
+  private uncreatedKey: string | null = null;
+
+  constructor(
+    private readonly params: {
+      dir: string;
+      capacity?: number;
+    },
+  ) {}
+
+  static isAvailable(): boolean {
+    return hasNativeClass("embeddingCache");
+  }
+
+  /** Cached embeddings among `hashes` (distinct, non-empty) for `providerKey`. */
+  lookup(providerKey: string, hashes: string[]): Map<string, number[]> {
+    const out = new Map<string, number[]>();
+    if (hashes.length === 0) {
+      return out;
+    }
+    const cache = this.open(providerKey, 0);
+    if (!cache) {
+      return out;
+    }
+    try {
+      const { vectors, found } = cache.lookup(hashes);
+      const dims = cache.dims;
+      for (let i = 0; i < hashes.length; i += 1) {
+        if (found[i]) {
+          out.set(hashes[i], Array.from(vectors.subarray(i * dims, (i + 1) * dims)));
+        }
+      }
+    } catch (err) {
+      this.fail(err);
+    }
+    return out;
+  }
+
+  /** Stores embeddings; entries whose length differs from the file's dims are skipped. */
+  store(providerKey: string, entries: Array<{ hash: string; embedding: number[] }>): void {
+    const first = entries.find((entry) => entry.hash && entry.embedding.length > 0);
+    if (!first) {
+      return;
+    }
+    const cache = this.open(providerKey, first.embedding.length);
+    if (!cache) {
+      return;
+    }
+    const dims = cache.dims;
+    const usable = entries.filter((entry) => entry.hash && entry.embedding.length === dims);
+    const vectors = new Float32Array(usable.length * dims);
+    usable.forEach((entry, i) => vectors.set(entry.embedding, i * dims));
+    try {
+      cache.setMany(
+        usable.map((entry) => entry.hash),
+        vectors,
+      );
+    } catch (err) {
+      this.fail(err);
+    }
+  }
+
+  close(): void {
+    this.handle?.close();
+    this.handle = null;
+    this.handleKey = null;
+  }
+
+  // dims = 0 opens an existing file only; a lookup before anything was
+  // stored for this provider key simply misses
+  private open(providerKey: string, dims: number): NativeEmbeddingCache | null {
+    if (this.disabled) {
+      return null;
+    }
+    if (this.handle && this.handleKey === providerKey) {
+      return this.handle;
+    }
+    const create = getNativeEmbeddingCache();
+    if (!create) {
+      return null;
+    }
+    const filePath = path.join(this.params.dir, `${providerKey}.vec`);
+    if (dims === 0 && (this.uncreatedKey === providerKey || !fs.existsSync(filePath))) {
+      return null;
+    }
+    this.close();
+    try {
+      fs.mkdirSync(this.params.dir, { recursive: true });
+      this.handle = create(filePath, {
+        dims: dims || undefined,
+        capacity: this.params.capacity ?? DEFAULT_CAPACITY,
+        namespace: providerKey,
+      });
+      this.handleKey = providerKey;
+      this.uncreatedKey = null;
+    } catch (err) {
+      if (dims === 0 && String(err).includes("embedding store is empty")) {
+        // Created by another process that has not written the header (or
+        // died before it did); the next store() creates or recovers it
+        this.uncreatedKey = providerKey;
+        return null;
+      }
+      this.fail(err);
+    }
+    return this.handle;
+  }
+
+  private fail(err: unknown): void {
+    const message = err instanceof Error ? err.message : String(err);
+    log.warn(`memory shared embedding cache disabled: ${message}`);
+    this.close();
+    this.disabled = true;
+  }
+}
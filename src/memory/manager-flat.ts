@@ -0,0 +1,187 @@
+import type { DatabaseSync } from "node:sqlite";
+import fs from "node:fs";
+import { createSubsystemLogger } from "../logging/subsystem.js";
+import { getNativeVectorIndex, hasNativeClass, type NativeVectorIndex } from "../ultra.js";
+import { DerivedChunkIndex, forEachEmbeddingPage, loadChunkRows } from "./manager-derived.js";
+import type { SearchRowResult, SearchSource } from "./manager-search.js";
+
+const log = createSubsystemLogger("memory");
+
+// Dead id-log records (removes and replacements) tolerated before compacting
+const COMPACT_MIN_DEAD = 1024;
+
+/**
+ * Exact vector search over the chunks table through the native VectorIndex.
+ *
+ * Embeddings live in `<db>.vectors`, a memory-mapped file of float rows,
+ * with the id of each row in the append-only `<db>.vectors.log`; opening
+ * it replays only the ids, so no embedding is re-read or re-parsed. The
+ * file is written in place, so its stamp `<db>.vectors.json` goes before
+ * the first change after a save (see DerivedChunkIndex).
+ */
+export class FlatVectorBackend extends DerivedChunkIndex<NativeVectorIndex> {
+  private dead = 0;
+
+  constructor(private readonly params: { dbPath: string }) {
+    super(`${params.dbPath}.vectors.json`);
+  }
+
+  static isAvailable(): boolean {
+    return hasNativeClass("vectorIndex");
+  }
+
+  private get vectorsPath(): string {
+    return `${this.params.dbPath}.vectors`;
+  }
+
+  /** Closes the file; the next open() checks and maps it again. */
+  override discard(): void {
+    this.index?.close();
+    super.discard();
+  }
+
+  upsert(id: string, embedding: number[]): void {
+    if (!this.opened || embedding.length === 0) {
+      return;
+    }
+    if (this.index && this.index.dims !== embedding.length) {
+      // Only happens mid-way through a model switch, which reindexes
+      // everything anyway; start over with the new dimension.
+      log.warn(`memory flat: dimension changed (${this.index.dims} -> ${embedding.length})`);
+      this.drop();
+    }
+    try {
+      this.index ??= this.create(embedding.length);
+      if (!this.index) {
+        return;
+      }
+      this.touch();
+      if (this.index.has(id)) {
+        this.dead++;
+      }
+      this.index.add(id, new Float32Array(embedding));
+    } catch (err) {
+      log.warn(`memory flat: write failed: ${String(err)}`);
+    }
+  }
+
+  /** Makes the file durable and stamps it when anything changed. */
+  async persist(db: DatabaseSync, model: string): Promise<void> {
+    if (!this.opened || !this.dirty || !this.index) {
+      return;
+    }
+    try {
+      if (this.dead > this.index.size + COMPACT_MIN_DEAD) {
+        this.index.compact();
+        this.dead = 0;
+      } else {
+        this.index.flush();
+      }
+      await this.writeStamp(db, model, { dims: this.index.dims });
+    } catch (err) {
+      log.warn(`memory flat: save failed: ${String(err)}`);
+    }
+  }
+
+  /**
+   * Best `limit` chunks for `queryVec`, or null when the file cannot answer
+   * (nothing indexed yet or a different dimension) and the caller should
+   * fall back.
+   */
+  async search(params: {
+    db: DatabaseSync;
+    providerModel: string;
+    queryVec: number[];
+    limit: number;
+    snippetMaxChars: number;
+    sourceFilter: { sql: string; params: SearchSource[] };
+  }): Promise<SearchRowResult[] | null> {
+    await this.open(params.db, params.providerModel);
+    const index = this.index;
+    if (!index || index.dims !== params.queryVec.length) {
+      return null;
+    }
+    // Exact search, so sources are filtered inside the scan rather than by
+    // overfetching
+    let filter: Uint8Array | undefined;
+    if (params.sourceFilter.params.length > 0) {
+      const allowed = params.db
+        .prepare(`SELECT id FROM chunks WHERE model = ?${params.sourceFilter.sql}`)
+        .all(params.providerModel, ...params.sourceFilter.params) as Array<{ id: string }>;
+      filter = index.filter(allowed.map((row) => row.id));
+    }
+    const hits = index.search(new Float32Array(params.queryVec), params.limit, filter);
+    const byId = loadChunkRows({ ...params, ids: hits.ids });
+
+    const results: SearchRowResult[] = [];
+    hits.ids.forEach((id, i) => {
+      const row = byId.get(id);
+      if (row) {
+        results.push({ ...row, score: hits.scores[i] });
+      }
+    });
+    return results;
+  }
+
+  protected override removeChunk(id: string): void {
+    if (this.index?.has(id)) {
+      this.touch();
+      this.index.remove(id);
+      this.dead++;
+    }
+  }
+
+  private create(dims: number): NativeVectorIndex | null {
+    const open = getNativeVectorIndex();
+    return open ? open(this.vectorsPath, { dims, metric: "cosine" }) : null;
+  }
+
+  // Closes and deletes the file and its stamp
+  protected override drop(): void {
+    this.index?.close();
+    this.index = null;
+    this.dead = 0;
+    for (const suffix of ["", ".log", ".json"]) {
+      fs.rmSync(`${this.vectorsPath}${suffix}`, { force: true });
+    }
+    this.dirty = true;
+  }
+
+  protected override async load(db: DatabaseSync, model: string): Promise<void> {
+    if (!getNativeVectorIndex()) {
+      this.opened = true;
+      return;
+    }
+    const stamp = await this.readStamp<{ dims: number }>(db, model);
+    if (stamp && Number.isInteger(stamp.dims) && stamp.dims > 0) {
+      try {
+        this.index = this.create(stamp.dims);
+        this.opened = true;
+        this.dirty = false;
+        return;
+      } catch (err) {
+        log.warn(`memory flat: open failed, rebuilding: ${String(err)}`);
+      }
+    }
+    this.drop();
+    try {
+      await this.rebuild(db, model);
+    } catch (err) {
+      log.warn(`memory flat: rebuild failed: ${String(err)}`);
+      this.drop();
+    }
+    this.opened = true;
+  }
+
+  // Writes every stored embedding with the first dimension seen
+  private async rebuild(db: DatabaseSync, model: string): Promise<void> {
+    const started = Date.now();
+    await forEachEmbeddingPage(db, model, (ids, matrix, dims) => {
+      this.index ??= this.create(dims);
+      this.index?.addMany(ids, matrix);
+    });
+    if (this.index) {
+      log.debug(`memory flat: wrote ${this.index.size} vectors in ${Date.now() - started}ms`);
+    }
+  }
+}
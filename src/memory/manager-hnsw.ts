@@ -0,0 +1,164 @@
+import type { DatabaseSync } from "node:sqlite";
+import fs from "node:fs/promises";
+import { createSubsystemLogger } from "../logging/subsystem.js";
+import { getNativeHnsw, hasNativeClass, type NativeHnswIndex } from "../ultra.js";
+import { DerivedChunkIndex, forEachEmbeddingPage, loadChunkRows } from "./manager-derived.js";
+import type { SearchRowResult, SearchSource } from "./manager-search.js";
+
+const log = createSubsystemLogger("memory");
+
+// Extra candidates fetched so source-filtered rows can still fill the limit
+const SEARCH_OVERFETCH = 2;
+
+export type HnswBackendOptions = {
+  m?: number;
+  efConstruction?: number;
+  efSearch?: number;
+};
+
+/**
+ * Vector search over the chunks table through the native HNSW graph.
+ *
+ * The graph is kept current by the manager's upsert/remove calls, saved
+ * next to the DB as `<db>.hnsw` and stamped in `<db>.hnsw.json` (see
+ * DerivedChunkIndex). On open a matching file is loaded as-is; anything
+ * else (crash before a save, another writer, model change) rebuilds from
+ * the stored embeddings.
+ */
+export class HnswVectorBackend extends DerivedChunkIndex<NativeHnswIndex> {
+  constructor(
+    private readonly params: {
+      dbPath: string;
+      options: HnswBackendOptions;
+    },
+  ) {
+    super(`${params.dbPath}.hnsw.json`);
+  }
+
+  static isAvailable(): boolean {
+    return hasNativeClass("hnsw");
+  }
+
+  private get graphPath(): string {
+    return `${this.params.dbPath}.hnsw`;
+  }
+
+  upsert(id: string, embedding: number[]): void {
+    if (!this.opened || embedding.length === 0) {
+      return;
+    }
+    if (this.index && this.index.dims !== embedding.length) {
+      // Only happens mid-way through a model switch, which reindexes
+      // everything anyway; start over with the new dimension.
+      log.warn(`memory hnsw: dimension changed (${this.index.dims} -> ${embedding.length})`);
+      this.index = null;
+    }
+    this.touch();
+    this.index ??= this.create(embedding.length);
+    this.index?.add(id, new Float32Array(embedding));
+  }
+
+  /** Saves the graph and its fingerprint when anything changed. */
+  async persist(db: DatabaseSync, model: string): Promise<void> {
+    if (!this.opened || !this.dirty) {
+      return;
+    }
+    try {
+      // Tombstones keep routing searches but cost memory and hops
+      if (this.index && this.index.nodes > 2 * this.index.size + 1024) {
+        this.index = await this.rebuild(db, model);
+      }
+      if (!this.index) {
+        await fs.rm(this.graphPath, { force: true });
+        return;
+      }
+      await this.index.saveAsync(this.graphPath);
+      await this.writeStamp(db, model, {});
+    } catch (err) {
+      log.warn(`memory hnsw: save failed: ${String(err)}`);
+    }
+  }
+
+  /**
+   * Best `limit` chunks for `queryVec`, or null when the graph cannot answer
+   * (not built yet or a different dimension) and the caller should fall back.
+   */
+  async search(params: {
+    db: DatabaseSync;
+    providerModel: string;
+    queryVec: number[];
+    limit: number;
+    snippetMaxChars: number;
+    sourceFilter: { sql: string; params: SearchSource[] };
+  }): Promise<SearchRowResult[] | null> {
+    await this.open(params.db, params.providerModel);
+    const index = this.index;
+    if (!index || index.dims !== params.queryVec.length) {
+      return null;
+    }
+    const k = params.sourceFilter.params.length > 0 ? params.limit * SEARCH_OVERFETCH : params.limit;
+    const hits = await index.searchAsync(new Float32Array(params.queryVec), k);
+    const byId = loadChunkRows({ ...params, ids: hits.ids });
+
+    const results: SearchRowResult[] = [];
+    hits.ids.forEach((id, i) => {
+      const row = byId.get(id);
+      if (row && results.length < params.limit) {
+        results.push({ ...row, score: hits.scores[i] });
+      }
+    });
+    return results;
+  }
+
+  protected override removeChunk(id: string): void {
+    if (this.index?.has(id)) {
+      this.touch();
+      this.index.remove(id);
+    }
+  }
+
+  private create(dims: number): NativeHnswIndex | null {
+    const native = getNativeHnsw();
+    return native ? native.create({ dims, metric: "cosine", ...this.params.options }) : null;
+  }
+
+  protected override async load(db: DatabaseSync, model: string): Promise<void> {
+    const native = getNativeHnsw();
+    if (!native) {
+      this.opened = true;
+      return;
+    }
+    const stamp = await this.readStamp(db, model);
+    if (stamp) {
+      try {
+        const index = await native.load(this.graphPath);
+        if (this.params.options.efSearch) {
+          index.efSearch = this.params.options.efSearch;
+        }
+        this.index = index;
+        this.opened = true;
+        this.dirty = false;
+        return;
+      } catch (err) {
+        log.warn(`memory hnsw: load failed, rebuilding: ${String(err)}`);
+      }
+    }
+    this.touch();
+    this.index = await this.rebuild(db, model);
+    this.opened = true;
+  }
+
+  // Inserts every stored embedding with the first dimension seen
+  private async rebuild(db: DatabaseSync, model: string): Promise<NativeHnswIndex | null> {
+    let index = null as NativeHnswIndex | null;
+    const started = Date.now();
+    await forEachEmbeddingPage(db, model, async (ids, matrix, dims) => {
+      index ??= this.create(dims);
+      await index?.addManyAsync(ids, matrix);
+    });
+    if (index) {
+      log.debug(`memory hnsw: built ${index.size} vectors in ${Date.now() - started}ms`);
+    }
+    return index;
+  }
+}
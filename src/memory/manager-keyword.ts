@@ -0,0 +1,124 @@
+import type { DatabaseSync } from "node:sqlite";
+import { createSubsystemLogger } from "../logging/subsystem.js";
+import { getNativeKeywordIndex, hasNativeClass, type NativeKeywordIndex } from "../ultra.js";
+import { DerivedChunkIndex, forEachChunkPage, loadChunkRows } from "./manager-derived.js";
+import type { SearchRowResult, SearchSource } from "./manager-search.js";
+
+const log = createSubsystemLogger("memory");
+
+/**
+ * Hybrid search over the chunks table through the native BM25 index: the
+ * keyword top-k and its fusion with the vector hits happen in one native
+ * call, without an FTS5 query.
+ *
+ * The index is memory-only, a cache derived from SQLite like the HNSW
+ * graph: built from the chunks table on first use and kept current by the
+ * manager's upsert/remove calls.
+ */
+export class NativeKeywordBackend extends DerivedChunkIndex<NativeKeywordIndex> {
+  constructor() {
+    super();
+  }
+
+  static isAvailable(): boolean {
+    return hasNativeClass("keywordIndex");
+  }
+
+  // Applied while a rebuild is running too: later pages only re-add rows
+  upsert(id: string, text: string, source: SearchSource): void {
+    this.index?.add(id, text, source);
+  }
+
+  /**
+   * Keyword hits fused with `vector` (mergeHybridResults semantics, with
+   * textScore = bm25 / (1 + bm25)), best first; null when the index cannot
+   * answer and the caller should use FTS.
+   */
+  async search(params: {
+    db: DatabaseSync;
+    providerModel: string;
+    query: string;
+    limit: number;
+    snippetMaxChars: number;
+    sourceFilter: { sql: string; params: SearchSource[] };
+    vector: SearchRowResult[];
+    vectorWeight: number;
+    textWeight: number;
+  }): Promise<SearchRowResult[] | null> {
+    await this.open(params.db, params.providerModel);
+    const index = this.index;
+    if (!index) {
+      return null;
+    }
+    const fused = index.hybrid(params.query, {
+      k: params.limit,
+      tags: params.sourceFilter.params,
+      vectorIds: params.vector.map((entry) => entry.id),
+      vectorScores: Float32Array.from(params.vector, (entry) => entry.score),
+      vectorWeight: params.vectorWeight,
+      textWeight: params.textWeight,
+      limit: params.limit,
+    });
+
+    const known = new Map(params.vector.map((entry) => [entry.id, entry]));
+    const missing = loadChunkRows({ ...params, ids: fused.ids.filter((id) => !known.has(id)) });
+    for (const [id, row] of missing) {
+      known.set(id, row);
+    }
+
+    const results: SearchRowResult[] = [];
+    fused.ids.forEach((id, i) => {
+      const row = known.get(id);
+      if (row) {
+        results.push({ ...row, score: fused.scores[i] });
+      }
+    });
+    return results;
+  }
+
+  protected override removeChunk(id: string): void {
+    this.index?.remove(id);
+  }
+
+  // An empty index, so the reindex's upserts have somewhere to go
+  protected override drop(): void {
+    this.index = this.create();
+  }
+
+  private create(): NativeKeywordIndex | null {
+    const native = getNativeKeywordIndex();
+    return native ? native() : null;
+  }
+
+  // Indexes every chunk of the model, yielding between pages so a large
+  // store does not stall the event loop; a reset() or discard() meanwhile
+  // abandons it
+  protected override async load(db: DatabaseSync, model: string): Promise<void> {
+    const index = this.create();
+    this.index = index;
+    if (!index) {
+      this.opened = true;
+      return;
+    }
+    const started = Date.now();
+    await forEachChunkPage<{ rowid: number; id: string; text: string; source: SearchSource }>(
+      db,
+      model,
+      "id, text, source",
+      (rows) => {
+        if (this.index !== index) {
+          return false;
+        }
+        index.addMany(
+          rows.map((row) => row.id),
+          rows.map((row) => row.text),
+          rows.map((row) => row.source),
+        );
+      },
+    );
+    if (this.index === index) {
+      this.opened = true;
+      log.debug(`memory keyword index: built ${index.size} chunks in ${Date.now() - started}ms`);
+    }
+  }
+}
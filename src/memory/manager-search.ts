@@ -1,4 +1,5 @@
 import type { DatabaseSync } from "node:sqlite";
+import { getNativeTopK } from "../ultra.js";
 import { truncateUtf16Safe } from "../utils.js";
 import { cosineSimilarity, parseEmbedding } from "./internal.js";
 
@@ -73,24 +74,47 @@ export async function searchVector(params: {
     providerModel: params.providerModel,
     sourceFilter: params.sourceFilterChunks,
   });
-  const scored = candidates
-    .map((chunk) => ({
-      chunk,
-      score: cosineSimilarity(params.queryVec, chunk.embedding),
-    }))
-    .filter((entry) => Number.isFinite(entry.score));
-  return scored
-    .toSorted((a, b) => b.score - a.score)
-    .slice(0, params.limit)
-    .map((entry) => ({
-      id: entry.chunk.id,
-      path: entry.chunk.path,
-      startLine: entry.chunk.startLine,
-      endLine: entry.chunk.endLine,
-      score: entry.score,
-      snippet: truncateUtf16Safe(entry.chunk.text, params.snippetMaxChars),
-      source: entry.chunk.source,
-    }));
+  const ranked =
+    rankWithNativeTopK(params.queryVec, candidates, params.limit) ??
+    candidates
+      .map((chunk) => ({
+        chunk,
+        score: cosineSimilarity(params.queryVec, chunk.embedding),
+      }))
+      .filter((entry) => Number.isFinite(entry.score))
+      .toSorted((a, b) => b.score - a.score)
+      .slice(0, params.limit);
+  return ranked.map((entry) => ({
+    id: entry.chunk.id,
+    path: entry.chunk.path,
+    startLine: entry.chunk.startLine,
+    endLine: entry.chunk.endLine,
+    score: entry.score,
+    snippet: truncateUtf16Safe(entry.chunk.text, params.snippetMaxChars),
+    source: entry.chunk.source,
+  }));
+}
+
+// Brute-force cosine ranking on the native SIMD kernels. Null (use the JS
+// path) when they are not loaded or an embedding's dimension differs from
+// the query's, since cosineSimilarity truncates to the shorter vector.
+function rankWithNativeTopK<T extends { embedding: number[] }>(
+  queryVec: number[],
+  candidates: T[],
+  limit: number,
+): Array<{ chunk: T; score: number }> | null {
+  const topK = getNativeTopK();
+  const dims = queryVec.length;
+  if (!topK || candidates.some((chunk) => chunk.embedding.length !== dims)) {
+    return null;
+  }
+  const matrix = new Float32Array(candidates.length * dims);
+  candidates.forEach((chunk, i) => matrix.set(chunk.embedding, i * dims));
+  const result = topK(new Float32Array(queryVec), matrix, limit);
+  return Array.from(result.indices, (index, i) => ({
+    chunk: candidates[index],
+    score: result.scores[i],
+  }));
 }
 
 export function listChunks(params: {
@@ -41,8 +41,8 @@ describe("memory embedding batches", () => {
   });
 
   it("splits large files across multiple embedding batches", async () => {
-    const line = "a".repeat(200);
-    const content = Array.from({ length: 50 }, () => line).join("\n");
+    // Distinct lines: repeated chunk text is only embedded once
+    const content = Array.from({ length: 50 }, (_, i) => `${i}:`.padEnd(200, "a")).join("\n");
     await fs.writeFile(path.join(workspaceDir, "memory", "2026-01-03.md"), content);
 
     const cfg = {
@@ -76,6 +76,41 @@ describe("memory embedding batches", () => {
     expect(embedBatch.mock.calls.length).toBeGreaterThan(1);
   });
 
+  it("embeds repeated chunk text once", async () => {
+    const line = "r".repeat(200);
+    const content = Array.from({ length: 40 }, () => line).join("\n");
+    await fs.writeFile(path.join(workspaceDir, "memory", "2026-01-09.md"), content);
+
+    const cfg = {
+      agents: {
+        defaults: {
+          workspace: workspaceDir,
+          memorySearch: {
+            provider: "openai",
+            model: "mock-embed",
+            store: { path: indexPath },
+            chunking: { tokens: 200, overlap: 0 },
+            sync: { watch: false, onSessionStart: false, onSearch: false },
+            query: { minScore: 0 },
+          },
+        },
+        list: [{ id: "main", default: true }],
+      },
+    };
+
+    const result = await getMemorySearchManager({ cfg, agentId: "main" });
+    expect(result.manager).not.toBeNull();
+    if (!result.manager) {
+      throw new Error("manager missing");
+    }
+    manager = result.manager;
+    await manager.sync({ force: true });
+
+    const inputs = embedBatch.mock.calls.flatMap((call) => call[0] ?? []);
+    expect(manager.status().chunks).toBeGreaterThan(1);
+    expect(new Set(inputs).size).toBe(inputs.length);
+  });
+
   it("keeps small files in a single embedding batch", async () => {
     const line = "b".repeat(120);
     const content = Array.from({ length: 4 }, () => line).join("\n");
@@ -3,14 +3,17 @@ import chokidar, { type FSWatcher } from "chokidar";
 import { randomUUID } from "node:crypto";
 import fsSync from "node:fs";
 import fs from "node:fs/promises";
+import os from "node:os";
 import path from "node:path";
 import type { ResolvedMemorySearchConfig } from "../agents/memory-search.js";
 import type { OpenClawConfig } from "../config/config.js";
 import { resolveAgentDir, resolveAgentWorkspaceDir } from "../agents/agent-scope.js";
 import { resolveMemorySearchConfig } from "../agents/memory-search.js";
+import { resolveStateDir } from "../config/paths.js";
 import { resolveSessionTranscriptsDirForAgent } from "../config/sessions/paths.js";
 import { createSubsystemLogger } from "../logging/subsystem.js";
 import { onSessionTranscriptUpdate } from "../sessions/transcript-events.js";
+import { getNativeTokenizer, type NativeTokenizer } from "../ultra.js";
 import { resolveUserPath } from "../utils.js";
 import { runGeminiEmbeddingBatches, type GeminiBatchRequest } from "./batch-gemini.js";
 import {
@@ -29,9 +32,10 @@ import {
 } from "./embeddings.js";
 import { bm25RankToScore, buildFtsQuery, mergeHybridResults } from "./hybrid.js";
 import {
-  buildFileEntry,
-  chunkMarkdown,
+  buildFileEntries,
+  chunkMarkdownForIndex,
   ensureDir,
+  fileStatMatches,
   hashText,
   isMemoryPath,
   listMemoryFiles,
@@ -40,10 +44,16 @@ import {
   type MemoryFileEntry,
   parseEmbedding,
 } from "./internal.js";
+import { SharedEmbeddingCache } from "./manager-embedding-cache.js";
+import { FlatVectorBackend } from "./manager-flat.js";
+import { HnswVectorBackend } from "./manager-hnsw.js";
+import { NativeKeywordBackend } from "./manager-keyword.js";
 import { searchKeyword, searchVector } from "./manager-search.js";
 import { ensureMemoryIndexSchema } from "./memory-schema.js";
+import { buildSessionEntry, type SessionFileEntry } from "./session-files.js";
 import { loadSqliteVecExtension } from "./sqlite-vec.js";
 import { requireNodeSqlite } from "./sqlite.js";
+import { readFileManifest } from "./sync-memory-files.js";
 
 type MemorySource = "memory" | "sessions";
 
@@ -62,18 +72,10 @@ type MemoryIndexMeta = {
   providerKey?: string;
   chunkTokens: number;
   chunkOverlap: number;
+  chunkTokenizer?: string;
   vectorDims?: number;
 };
 
-type SessionFileEntry = {
-  path: string;
-  absPath: string;
-  mtimeMs: number;
-  size: number;
-  hash: string;
-  content: string;
-};
-
 type MemorySyncProgressUpdate = {
   completed: number;
   total: number;
@@ -141,6 +143,8 @@ export class MemoryIndexManager {
   private readonly sources: Set<MemorySource>;
   private providerKey: string;
   private readonly cache: { enabled: boolean; maxEntries?: number };
+  private readonly sharedCache: SharedEmbeddingCache | null;
+  private readonly chunkTokenizer: NativeTokenizer | null;
   private readonly vector: {
     enabled: boolean;
     available: boolean | null;
@@ -154,6 +158,8 @@ export class MemoryIndexManager {
     loadError?: string;
   };
   private vectorReady: Promise<boolean> | null = null;
+  private readonly vectorBackend: HnswVectorBackend | FlatVectorBackend | null;
+  private readonly keyword: NativeKeywordBackend | null;
   private watcher: FSWatcher | null = null;
   private watchTimer: NodeJS.Timeout | null = null;
   private sessionWatchTimer: NodeJS.Timeout | null = null;
@@ -233,6 +239,8 @@ export class MemoryIndexManager {
       enabled: params.settings.cache.enabled,
       maxEntries: params.settings.cache.maxEntries,
     };
+    this.sharedCache = this.createSharedEmbeddingCache();
+    this.chunkTokenizer = this.loadChunkTokenizer();
     this.fts = { enabled: params.settings.query.hybrid.enabled, available: false };
     this.ensureSchema();
     this.vector = {
@@ -244,6 +252,8 @@ export class MemoryIndexManager {
     if (meta?.vectorDims) {
       this.vector.dims = meta.vectorDims;
     }
+    this.vectorBackend = this.createVectorBackend();
+    this.keyword = this.createKeywordBackend();
     this.ensureWatcher();
     this.ensureSessionListener();
     this.ensureIntervalSync();
@@ -293,9 +303,11 @@ export class MemoryIndexManager {
       Math.max(1, Math.floor(maxResults * hybrid.candidateMultiplier)),
     );
 
-    const keywordResults = hybrid.enabled
-      ? await this.searchKeyword(cleaned, candidates).catch(() => [])
-      : [];
+    // The native keyword index fuses with the vector hits itself
+    const keywordResults =
+      hybrid.enabled && !this.keyword
+        ? await this.searchKeyword(cleaned, candidates).catch(() => [])
+        : [];
 
     const queryVec = await this.embedQueryWithTimeout(cleaned);
     const hasVector = queryVec.some((v) => v !== 0);
@@ -307,9 +319,17 @@ export class MemoryIndexManager {
       return vectorResults.filter((entry) => entry.score >= minScore).slice(0, maxResults);
     }
 
+    const fused = await this.searchHybridNative(cleaned, candidates, vectorResults);
+    if (fused) {
+      return fused.filter((entry) => entry.score >= minScore).slice(0, maxResults);
+    }
+
     const merged = this.mergeHybridResults({
       vector: vectorResults,
-      keyword: keywordResults,
+      // FTS fallback when the native index failed
+      keyword: this.keyword
+        ? await this.searchKeyword(cleaned, candidates).catch(() => [])
+        : keywordResults,
       vectorWeight: hybrid.vectorWeight,
       textWeight: hybrid.textWeight,
     });
@@ -321,6 +341,17 @@ export class MemoryIndexManager {
     queryVec: number[],
     limit: number,
   ): Promise<Array<MemorySearchResult & { id: string }>> {
+    const nativeHits = await this.vectorBackend?.search({
+      db: this.db,
+      providerModel: this.provider.model,
+      queryVec,
+      limit,
+      snippetMaxChars: SNIPPET_MAX_CHARS,
+      sourceFilter: this.buildSourceFilter(),
+    });
+    if (nativeHits) {
+      return nativeHits.map((entry) => entry as MemorySearchResult & { id: string });
+    }
     const results = await searchVector({
       db: this.db,
       vectorTable: VECTOR_TABLE,
@@ -335,6 +366,36 @@ export class MemoryIndexManager {
     return results.map((entry) => entry as MemorySearchResult & { id: string });
   }
 
+  // Keyword top-k fused with the vector hits in one native call; null when
+  // the native keyword index is not configured or fails
+  private async searchHybridNative(
+    query: string,
+    limit: number,
+    vectorResults: Array<MemorySearchResult & { id: string }>,
+  ): Promise<MemorySearchResult[] | null> {
+    if (!this.keyword) {
+      return null;
+    }
+    const hybrid = this.settings.query.hybrid;
+    try {
+      const results = await this.keyword.search({
+        db: this.db,
+        providerModel: this.provider.model,
+        query,
+        limit,
+        snippetMaxChars: SNIPPET_MAX_CHARS,
+        sourceFilter: this.buildSourceFilter(),
+        vector: vectorResults,
+        vectorWeight: hybrid.vectorWeight,
+        textWeight: hybrid.textWeight,
+      });
+      return results?.map((entry) => entry as MemorySearchResult) ?? null;
+    } catch (err) {
+      log.warn(`memory keyword index search failed: ${String(err)}`);
+      return null;
+    }
+  }
+
   private buildFtsQuery(raw: string): string | null {
     return buildFtsQuery(raw);
   }
@@ -400,9 +461,11 @@ export class MemoryIndexManager {
     if (this.syncing) {
       return this.syncing;
     }
-    this.syncing = this.runSync(params).finally(() => {
-      this.syncing = null;
-    });
+    this.syncing = this.runSync(params)
+      .then(async () => await this.vectorBackend?.persist(this.db, this.provider.model))
+      .finally(() => {
+        this.syncing = null;
+      });
     return this.syncing;
   }
 
@@ -642,6 +705,8 @@ export class MemoryIndexManager {
       this.sessionUnsubscribe();
       this.sessionUnsubscribe = null;
     }
+    await this.vectorBackend?.persist(this.db, this.provider.model);
+    this.sharedCache?.close();
     this.db.close();
     INDEX_CACHE.delete(this.cacheKey);
   }
@@ -727,6 +792,74 @@ export class MemoryIndexManager {
     }
   }
 
+  private createVectorBackend(): HnswVectorBackend | FlatVectorBackend | null {
+    const backend = this.settings.store.vector.backend;
+    if (backend === "sqlite-vec") {
+      return null;
+    }
+    const available =
+      backend === "hnsw" ? HnswVectorBackend.isAvailable() : FlatVectorBackend.isAvailable();
+    if (!available) {
+      log.warn(
+        `memory ${backend} backend requested but the native addon is not loaded; using sqlite-vec`,
+      );
+      return null;
+    }
+    const dbPath = resolveUserPath(this.settings.store.path);
+    return backend === "hnsw"
+      ? new HnswVectorBackend({ dbPath, options: this.settings.store.vector.hnsw })
+      : new FlatVectorBackend({ dbPath });
+  }
+
+  private createKeywordBackend(): NativeKeywordBackend | null {
+    const hybrid = this.settings.query.hybrid;
+    if (!hybrid.enabled || hybrid.keywordBackend !== "native") {
+      return null;
+    }
+    if (!NativeKeywordBackend.isAvailable()) {
+      log.warn("memory native keyword backend requested but the native addon is not loaded; using fts");
+      return null;
+    }
+    return new NativeKeywordBackend();
+  }
+
+  private createSharedEmbeddingCache(): SharedEmbeddingCache | null {
+    if (!this.cache.enabled || !this.settings.cache.shared) {
+      return null;
+    }
+    if (!SharedEmbeddingCache.isAvailable()) {
+      log.warn("memory shared embedding cache requested but the native addon is not loaded");
+      return null;
+    }
+    return new SharedEmbeddingCache({
+      dir: path.join(resolveStateDir(process.env, os.homedir), "memory", "embeddings"),
+      capacity: this.cache.maxEntries,
+    });
+  }
+
+  private loadChunkTokenizer(): NativeTokenizer | null {
+    const vocabPath = this.settings.chunking.tokenizer;
+    if (!vocabPath) {
+      return null;
+    }
+    const load = getNativeTokenizer();
+    if (!load) {
+      log.warn("memory chunk tokenizer configured but the native addon is not loaded");
+      return null;
+    }
+    try {
+      return load(vocabPath);
+    } catch (err) {
+      log.warn(`memory chunk tokenizer unavailable, estimating tokens: ${String(err)}`);
+      return null;
+    }
+  }
+
+  // Recorded in the index meta: chunks cut on real token counts differ from estimated ones
+  private chunkTokenizerKey(): string | undefined {
+    return this.chunkTokenizer ? this.settings.chunking.tokenizer : undefined;
+  }
+
   private buildSourceFilter(alias?: string): { sql: string; params: MemorySource[] } {
     const sources = Array.from(this.sources);
     if (sources.length === 0) {
@@ -1108,8 +1241,10 @@ export class MemoryIndexManager {
     progress?: MemorySyncProgressState;
   }) {
     const files = await listMemoryFiles(this.workspaceDir, this.settings.extraPaths);
-    const fileEntries = await Promise.all(
-      files.map(async (file) => buildFileEntry(file, this.workspaceDir)),
+    const fileEntries = await buildFileEntries(
+      files,
+      this.workspaceDir,
+      readFileManifest(this.db, "memory"),
     );
     log.debug("memory sync: indexing memory files", {
       files: fileEntries.length,
@@ -1160,6 +1295,8 @@ export class MemoryIndexManager {
         continue;
       }
       this.db.prepare(`DELETE FROM files WHERE path = ? AND source = ?`).run(stale.path, "memory");
+      this.vectorBackend?.removeFile(this.db, stale.path, "memory");
+      this.keyword?.removeFile(this.db, stale.path, "memory");
       try {
         this.db
           .prepare(
@@ -1201,6 +1338,7 @@ export class MemoryIndexManager {
       });
     }
 
+    const manifest = readFileManifest(this.db, "sessions");
     const tasks = files.map((absPath) => async () => {
       if (!indexAll && !this.sessionsDirtyFiles.has(absPath)) {
         if (params.progress) {
@@ -1212,7 +1350,23 @@ export class MemoryIndexManager {
         }
         return;
       }
-      const entry = await this.buildSessionEntry(absPath);
+      // Transcript text is derived from the file alone, so an unchanged stat
+      // means an unchanged hash without reading and parsing the JSONL
+      const prior = params.needsFullReindex
+        ? undefined
+        : manifest.get(this.sessionPathForFile(absPath));
+      if (prior && (await fileStatMatches(absPath, prior))) {
+        if (params.progress) {
+          params.progress.completed += 1;
+          params.progress.report({
+            completed: params.progress.completed,
+            total: params.progress.total,
+          });
+        }
+        this.resetSessionDelta(absPath, prior.size);
+        return;
+      }
+      const entry = await buildSessionEntry(absPath);
       if (!entry) {
         if (params.progress) {
           params.progress.completed += 1;
@@ -1259,6 +1413,8 @@ export class MemoryIndexManager {
       this.db
         .prepare(`DELETE FROM files WHERE path = ? AND source = ?`)
         .run(stale.path, "sessions");
+      this.vectorBackend?.removeFile(this.db, stale.path, "sessions");
+      this.keyword?.removeFile(this.db, stale.path, "sessions");
       try {
         this.db
           .prepare(
@@ -1318,6 +1474,7 @@ export class MemoryIndexManager {
       });
     }
     const vectorReady = await this.ensureVectorReady();
+    await this.vectorBackend?.open(this.db, this.provider.model);
     const meta = this.readMeta();
     const needsFullReindex =
       params?.force ||
@@ -1327,6 +1484,7 @@ export class MemoryIndexManager {
       meta.providerKey !== this.providerKey ||
       meta.chunkTokens !== this.settings.chunking.tokens ||
       meta.chunkOverlap !== this.settings.chunking.overlap ||
+      meta.chunkTokenizer !== this.chunkTokenizerKey() ||
       (vectorReady && !meta?.vectorDims);
     try {
       if (needsFullReindex) {
@@ -1471,6 +1629,8 @@ export class MemoryIndexManager {
     };
 
     this.db = tempDb;
+    this.vectorBackend?.reset();
+    this.keyword?.reset();
     this.vectorReady = null;
     this.vector.available = null;
     this.vector.loadError = undefined;
@@ -1510,6 +1670,7 @@ export class MemoryIndexManager {
         providerKey: this.providerKey,
         chunkTokens: this.settings.chunking.tokens,
         chunkOverlap: this.settings.chunking.overlap,
+        chunkTokenizer: this.chunkTokenizerKey(),
       };
       if (this.vector.available && this.vector.dims) {
         nextMeta.vectorDims = this.vector.dims;
@@ -1536,6 +1697,8 @@ export class MemoryIndexManager {
       } catch {}
       await this.removeIndexFiles(tempDbPath);
       restoreOriginalState();
+      this.vectorBackend?.discard();
+      this.keyword?.discard();
       throw err;
     }
   }
@@ -1594,95 +1757,6 @@ export class MemoryIndexManager {
     return path.join("sessions", path.basename(absPath)).replace(/\\/g, "/");
   }
 
-  private normalizeSessionText(value: string): string {
-    return value
-      .replace(/\s*\n+\s*/g, " ")
-      .replace(/\s+/g, " ")
-      .trim();
-  }
-
-  private extractSessionText(content: unknown): string | null {
-    if (typeof content === "string") {
-      const normalized = this.normalizeSessionText(content);
-      return normalized ? normalized : null;
-    }
-    if (!Array.isArray(content)) {
-      return null;
-    }
-    const parts: string[] = [];
-    for (const block of content) {
-      if (!block || typeof block !== "object") {
-        continue;
-      }
-      const record = block as { type?: unknown; text?: unknown };
-      if (record.type !== "text" || typeof record.text !== "string") {
-        continue;
-      }
-      const normalized = this.normalizeSessionText(record.text);
-      if (normalized) {
-        parts.push(normalized);
-      }
-    }
-    if (parts.length === 0) {
-      return null;
-    }
-    return parts.join(" ");
-  }
-
-  private async buildSessionEntry(absPath: string): Promise<SessionFileEntry | null> {
-    try {
-      const stat = await fs.stat(absPath);
-      const raw = await fs.readFile(absPath, "utf-8");
-      const lines = raw.split("\n");
-      const collected: string[] = [];
-      for (const line of lines) {
-        if (!line.trim()) {
-          continue;
-        }
-        let record: unknown;
-        try {
-          record = JSON.parse(line);
-        } catch {
-          continue;
-        }
-        if (
-          !record ||
-          typeof record !== "object" ||
-          (record as { type?: unknown }).type !== "message"
-        ) {
-          continue;
-        }
-        const message = (record as { message?: unknown }).message as
-          | { role?: unknown; content?: unknown }
-          | undefined;
-        if (!message || typeof message.role !== "string") {
-          continue;
-        }
-        if (message.role !== "user" && message.role !== "assistant") {
-          continue;
-        }
-        const text = this.extractSessionText(message.content);
-        if (!text) {
-          continue;
-        }
-        const label = message.role === "user" ? "User" : "Assistant";
-        collected.push(`${label}: ${text}`);
-      }
-      const content = collected.join("\n");
-      return {
-        path: this.sessionPathForFile(absPath),
-        absPath,
-        mtimeMs: stat.mtimeMs,
-        size: stat.size,
-        hash: hashText(content),
-        content,
-      };
-    } catch (err) {
-      log.debug(`Failed reading session file ${absPath}: ${String(err)}`);
-      return null;
-    }
-  }
-
   private estimateEmbeddingTokens(text: string): number {
     if (!text) {
       return 0;
@@ -1741,11 +1815,15 @@ export class MemoryIndexManager {
       return new Map();
     }
 
-    const out = new Map<string, number[]>();
+    // Shared cache first; SQLite hits it lacked are copied into it so
+    // other agents can reuse them
+    const out = this.sharedCache?.lookup(this.providerKey, unique) ?? new Map<string, number[]>();
+    const rest = out.size > 0 ? unique.filter((hash) => !out.has(hash)) : unique;
+    const backfill: Array<{ hash: string; embedding: number[] }> = [];
     const baseParams = [this.provider.id, this.provider.model, this.providerKey];
     const batchSize = 400;
-    for (let start = 0; start < unique.length; start += batchSize) {
-      const batch = unique.slice(start, start + batchSize);
+    for (let start = 0; start < rest.length; start += batchSize) {
+      const batch = rest.slice(start, start + batchSize);
       const placeholders = batch.map(() => "?").join(", ");
       const rows = this.db
         .prepare(
@@ -1754,9 +1832,12 @@ export class MemoryIndexManager {
         )
         .all(...baseParams, ...batch) as Array<{ hash: string; embedding: string }>;
       for (const row of rows) {
-        out.set(row.hash, parseEmbedding(row.embedding));
+        const embedding = parseEmbedding(row.embedding);
+        out.set(row.hash, embedding);
+        backfill.push({ hash: row.hash, embedding });
       }
     }
+    this.sharedCache?.store(this.providerKey, backfill);
     return out;
   }
 
@@ -1767,6 +1848,7 @@ export class MemoryIndexManager {
     if (entries.length === 0) {
       return;
     }
+    this.sharedCache?.store(this.providerKey, entries);
     const now = Date.now();
     const stmt = this.db.prepare(
       `INSERT INTO ${EMBEDDING_CACHE_TABLE} (provider, model, provider_key, hash, embedding, dims, updated_at)\n` +
@@ -1818,24 +1900,47 @@ export class MemoryIndexManager {
       .run(excess);
   }
 
-  private async embedChunksInBatches(chunks: MemoryChunk[]): Promise<number[][]> {
-    if (chunks.length === 0) {
-      return [];
-    }
+  // Fills cache hits and picks the chunks to embed: one per distinct hash,
+  // with later chunks of the same text listed in `repeats` to copy from it
+  private planEmbeddings(chunks: MemoryChunk[]): {
+    embeddings: number[][];
+    missing: Array<{ index: number; chunk: MemoryChunk }>;
+    repeats: Array<{ index: number; from: number }>;
+  } {
     const cached = this.loadEmbeddingCache(chunks.map((chunk) => chunk.hash));
     const embeddings: number[][] = Array.from({ length: chunks.length }, () => []);
     const missing: Array<{ index: number; chunk: MemoryChunk }> = [];
+    const repeats: Array<{ index: number; from: number }> = [];
+    const firstMissing = new Map<string, number>();
 
     for (let i = 0; i < chunks.length; i += 1) {
       const chunk = chunks[i];
       const hit = chunk?.hash ? cached.get(chunk.hash) : undefined;
       if (hit && hit.length > 0) {
         embeddings[i] = hit;
-      } else if (chunk) {
-        missing.push({ index: i, chunk });
+        continue;
       }
+      if (!chunk) {
+        continue;
+      }
+      const from = chunk.hash ? firstMissing.get(chunk.hash) : undefined;
+      if (from !== undefined) {
+        repeats.push({ index: i, from });
+        continue;
+      }
+      if (chunk.hash) {
+        firstMissing.set(chunk.hash, i);
+      }
+      missing.push({ index: i, chunk });
     }
+    return { embeddings, missing, repeats };
+  }
 
+  private async embedChunksInBatches(chunks: MemoryChunk[]): Promise<number[][]> {
+    if (chunks.length === 0) {
+      return [];
+    }
+    const { embeddings, missing, repeats } = this.planEmbeddings(chunks);
     if (missing.length === 0) {
       return embeddings;
     }
@@ -1857,6 +1962,9 @@ export class MemoryIndexManager {
       cursor += batch.length;
     }
     this.upsertEmbeddingCache(toCache);
+    for (const repeat of repeats) {
+      embeddings[repeat.index] = embeddings[repeat.from];
+    }
     return embeddings;
   }
 
@@ -1921,20 +2029,7 @@ export class MemoryIndexManager {
     if (chunks.length === 0) {
       return [];
     }
-    const cached = this.loadEmbeddingCache(chunks.map((chunk) => chunk.hash));
-    const embeddings: number[][] = Array.from({ length: chunks.length }, () => []);
-    const missing: Array<{ index: number; chunk: MemoryChunk }> = [];
-
-    for (let i = 0; i < chunks.length; i += 1) {
-      const chunk = chunks[i];
-      const hit = chunk?.hash ? cached.get(chunk.hash) : undefined;
-      if (hit && hit.length > 0) {
-        embeddings[i] = hit;
-      } else if (chunk) {
-        missing.push({ index: i, chunk });
-      }
-    }
-
+    const { embeddings, missing, repeats } = this.planEmbeddings(chunks);
     if (missing.length === 0) {
       return embeddings;
     }
@@ -1987,6 +2082,9 @@ export class MemoryIndexManager {
       toCache.push({ hash: mapped.hash, embedding });
     }
     this.upsertEmbeddingCache(toCache);
+    for (const repeat of repeats) {
+      embeddings[repeat.index] = embeddings[repeat.from];
+    }
     return embeddings;
   }
 
@@ -2002,20 +2100,7 @@ export class MemoryIndexManager {
     if (chunks.length === 0) {
       return [];
     }
-    const cached = this.loadEmbeddingCache(chunks.map((chunk) => chunk.hash));
-    const embeddings: number[][] = Array.from({ length: chunks.length }, () => []);
-    const missing: Array<{ index: number; chunk: MemoryChunk }> = [];
-
-    for (let i = 0; i < chunks.length; i += 1) {
-      const chunk = chunks[i];
-      const hit = chunk?.hash ? cached.get(chunk.hash) : undefined;
-      if (hit && hit.length > 0) {
-        embeddings[i] = hit;
-      } else if (chunk) {
-        missing.push({ index: i, chunk });
-      }
-    }
-
+    const { embeddings, missing, repeats } = this.planEmbeddings(chunks);
     if (missing.length === 0) {
       return embeddings;
     }
@@ -2065,6 +2150,9 @@ export class MemoryIndexManager {
       toCache.push({ hash: mapped.hash, embedding });
     }
     this.upsertEmbeddingCache(toCache);
+    for (const repeat of repeats) {
+      embeddings[repeat.index] = embeddings[repeat.from];
+    }
     return embeddings;
   }
 
@@ -2299,9 +2387,10 @@ export class MemoryIndexManager {
     entry: MemoryFileEntry | SessionFileEntry,
     options: { source: MemorySource; content?: string },
   ) {
-    const content = options.content ?? (await fs.readFile(entry.absPath, "utf-8"));
-    const chunks = chunkMarkdown(content, this.settings.chunking).filter(
-      (chunk) => chunk.text.trim().length > 0,
+    const chunks = await chunkMarkdownForIndex(
+      options.content ?? (await fs.readFile(entry.absPath)),
+      this.settings.chunking,
+      this.chunkTokenizer,
     );
     const embeddings = this.batch.enabled
       ? await this.embedChunksWithBatch(chunks, entry, options.source)
@@ -2325,6 +2414,8 @@ export class MemoryIndexManager {
           .run(entry.path, options.source, this.provider.model);
       } catch {}
     }
+    this.vectorBackend?.removeFile(this.db, entry.path, options.source);
+    this.keyword?.removeFile(this.db, entry.path, options.source);
     this.db
       .prepare(`DELETE FROM chunks WHERE path = ? AND source = ?`)
       .run(entry.path, options.source);
@@ -2357,6 +2448,8 @@ export class MemoryIndexManager {
           JSON.stringify(embedding),
           now,
         );
+      this.vectorBackend?.upsert(id, embedding);
+      this.keyword?.upsert(id, chunk.text, options.source);
       if (vectorReady && embedding.length > 0) {
         try {
           this.db.prepare(`DELETE FROM ${VECTOR_TABLE} WHERE id = ?`).run(id);
@@ -1,5 +1,8 @@
 import type { DatabaseSync } from "node:sqlite";
 
+/** meta key of the chunk write counter kept by triggers on chunks. */
+export const CHUNK_CHANGES_KEY = "chunks_changes";
+
 export function ensureMemoryIndexSchema(params: {
   db: DatabaseSync;
   embeddingCacheTable: string;
@@ -78,6 +81,20 @@ export function ensureMemoryIndexSchema(params: {
   ensureColumn(params.db, "chunks", "source", "TEXT NOT NULL DEFAULT 'memory'");
   params.db.exec(`CREATE INDEX IF NOT EXISTS idx_chunks_path ON chunks(path);`);
   params.db.exec(`CREATE INDEX IF NOT EXISTS idx_chunks_source ON chunks(source);`);
+  // Bumped by every chunk write, so the derived indexes (flat vectors, HNSW)
+  // can tell a same-count replace from no change
+  for (const [name, event] of [
+    ["chunks_changes_insert", "INSERT"],
+    ["chunks_changes_update", "UPDATE"],
+    ["chunks_changes_delete", "DELETE"],
+  ]) {
+    params.db.exec(
+      `CREATE TRIGGER IF NOT EXISTS ${name} AFTER ${event} ON chunks BEGIN\n` +
+        `  INSERT INTO meta (key, value) VALUES ('${CHUNK_CHANGES_KEY}', 1)\n` +
+        `    ON CONFLICT(key) DO UPDATE SET value = value + 1;\n` +
+        `END;`,
+    );
+  }
 
   return { ftsAvailable, ...(ftsError ? { ftsError } : {}) };
 }
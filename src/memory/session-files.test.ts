@@ -0,0 +1,51 @@
+import fs from "node:fs/promises";
+import os from "node:os";
+import path from "node:path";
+import { afterEach, beforeEach, describe, expect, it } from "vitest";
+import { buildSessionEntry } from "./session-files.js";
+
+const message = (role: string, content: unknown) =>
+  JSON.stringify({ type: "message", message: { role, content } });
+
+describe("buildSessionEntry", () => {
+  let tmpDir: string;
+
+  beforeEach(async () => {
+    tmpDir = await fs.mkdtemp(path.join(os.tmpdir(), "memory-sessions-"));
+  });
+
+  afterEach(async () => {
+    await fs.rm(tmpDir, { recursive: true, force: true });
+  });
+
+  it("keeps user and assistant text across appends and rewrites", async () => {
+    const file = path.join(tmpDir, "session.jsonl");
+    await fs.writeFile(
+      file,
+      [
+        message("user", "  hello\n\n there "),
+        message("toolResult", "skipped"),
+        "{ not json",
+        message("assistant", [
+          { type: "text", text: "first" },
+          { type: "toolCall", text: "skipped" },
+          { type: "text", text: " second\t" },
+        ]),
+        JSON.stringify({ type: "note", message: { role: "user", content: "skipped" } }),
+        "",
+      ].join("\n"),
+    );
+    const first = await buildSessionEntry(file);
+    expect(first?.content).toBe("User: hello there\nAssistant: first second");
+
+    await fs.appendFile(file, `${message("user", "\ud800 lone")}\n${message("user", "partial")}`);
+    const appended = await buildSessionEntry(file);
+    expect(appended?.content).toBe(
+      "User: hello there\nAssistant: first second\nUser: \ud800 lone\nUser: partial",
+    );
+
+    await fs.writeFile(file, `${message("assistant", "rewritten")}\n`);
+    const rewritten = await buildSessionEntry(file);
+    expect(rewritten?.content).toBe("Assistant: rewritten");
+  });
+});
@@ -2,6 +2,7 @@ import fs from "node:fs/promises";
 import path from "node:path";
 import { resolveSessionTranscriptsDirForAgent } from "../config/sessions/paths.js";
 import { createSubsystemLogger } from "../logging/subsystem.js";
+import { getNativeScanTranscript, type NativeScanTranscript } from "../ultra.js";
 import { hashText } from "./internal.js";
 
 const log = createSubsystemLogger("memory");
@@ -68,46 +69,121 @@ export function extractSessionText(content: unknown): string | null {
   return parts.join(" ");
 }
 
+const SESSION_ROLES = ["user", "assistant"];
+
+/** Indexed line for one message, or null when it carries no user/assistant text. */
+function sessionLine(role: string, text: string | null): string | null {
+  if (!text || (role !== "user" && role !== "assistant")) {
+    return null;
+  }
+  const label = role === "user" ? "User" : "Assistant";
+  return `${label}: ${text}`;
+}
+
+function sessionLineFromRecord(record: unknown): string | null {
+  if (!record || typeof record !== "object" || (record as { type?: unknown }).type !== "message") {
+    return null;
+  }
+  const message = (record as { message?: unknown }).message as
+    | { role?: unknown; content?: unknown }
+    | undefined;
+  if (!message || typeof message.role !== "string") {
+    return null;
+  }
+  return sessionLine(message.role, extractSessionText(message.content));
+}
+
+type TranscriptScanState = { offset: number; anchor: string; lines: string[]; chars: number };
+
+// Session lines of each transcript's complete lines, so syncing a transcript
+// that only grew scans just the appended bytes. Bounded by characters held.
+const TRANSCRIPT_SCAN_CACHE_CHARS = 64 * 1024 * 1024;
+const transcriptScans = new Map<string, TranscriptScanState>();
+let transcriptScanChars = 0;
+
+function rememberTranscriptScan(absPath: string, state: TranscriptScanState) {
+  const prior = transcriptScans.get(absPath);
+  if (prior) {
+    transcriptScanChars -= prior.chars;
+    transcriptScans.delete(absPath);
+  }
+  transcriptScans.set(absPath, state);
+  transcriptScanChars += state.chars;
+  for (const [key, oldest] of transcriptScans) {
+    if (transcriptScanChars <= TRANSCRIPT_SCAN_CACHE_CHARS) {
+      break;
+    }
+    transcriptScans.delete(key);
+    transcriptScanChars -= oldest.chars;
+  }
+}
+
+async function scanSessionContent(absPath: string, scan: NativeScanTranscript): Promise<string> {
+  const prior = transcriptScans.get(absPath);
+  const result = await scan(absPath, {
+    from: prior?.offset,
+    anchor: prior?.anchor,
+    roles: SESSION_ROLES,
+  });
+  const resumed = result.resumed && prior !== undefined;
+  const lines = resumed ? prior.lines : [];
+  let chars = resumed ? prior.chars : 0;
+  // A trailing line without "\n" may still be mid-write: index it, but do not
+  // cache it; the next scan starts at result.offset and reads it again
+  const tail: string[] = [];
+  for (let i = 0; i < result.roles.length; i++) {
+    const raw = result.raw[i];
+    // Collapsing whitespace over the "\n"-joined parts equals extractSessionText()
+    const line =
+      raw !== undefined
+        ? sessionLineFromRecord(JSON.parse(raw))
+        : sessionLine(result.roles[i], normalizeSessionText(result.texts[i]) || null);
+    if (!line) {
+      continue;
+    }
+    if (result.starts[i] < result.offset) {
+      lines.push(line);
+      chars += line.length;
+    } else {
+      tail.push(line);
+    }
+  }
+  rememberTranscriptScan(absPath, {
+    offset: result.offset,
+    anchor: result.anchor,
+    lines,
+    chars,
+  });
+  return lines.concat(tail).join("\n");
+}
+
+function parseSessionContent(raw: string): string {
+  const collected: string[] = [];
+  for (const line of raw.split("\n")) {
+    if (!line.trim()) {
+      continue;
+    }
+    let record: unknown;
+    try {
+      record = JSON.parse(line);
+    } catch {
+      continue;
+    }
+    const text = sessionLineFromRecord(record);
+    if (text) {
+      collected.push(text);
+    }
+  }
+  return collected.join("\n");
+}
+
 export async function buildSessionEntry(absPath: string): Promise<SessionFileEntry | null> {
   try {
     const stat = await fs.stat(absPath);
-    const raw = await fs.readFile(absPath, "utf-8");
-    const lines = raw.split("\n");
-    const collected: string[] = [];
-    for (const line of lines) {
-      if (!line.trim()) {
-        continue;
-      }
-      let record: unknown;
-      try {
-        record = JSON.parse(line);
-      } catch {
-        continue;
-      }
-      if (
-        !record ||
-        typeof record !== "object" ||
-        (record as { type?: unknown }).type !== "message"
-      ) {
-        continue;
-      }
-      const message = (record as { message?: unknown }).message as
-        | { role?: unknown; content?: unknown }
-        | undefined;
-      if (!message || typeof message.role !== "string") {
-        continue;
-      }
-      if (message.role !== "user" && message.role !== "assistant") {
-        continue;
-      }
-      const text = extractSessionText(message.content);
-      if (!text) {
-        continue;
-      }
-      const label = message.role === "user" ? "User" : "Assistant";
-      collected.push(`${label}: ${text}`);
-    }
-    const content = collected.join("\n");
+    const scan = getNativeScanTranscript();
+    const content = scan
+      ? await scanSessionContent(absPath, scan)
+      : parseSessionContent(await fs.readFile(absPath, "utf-8"));
     return {
       path: sessionPathForFile(absPath),
       absPath,
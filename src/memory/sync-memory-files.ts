@@ -1,6 +1,11 @@
 import type { DatabaseSync } from "node:sqlite";
 import { createSubsystemLogger } from "../logging/subsystem.js";
-import { buildFileEntry, listMemoryFiles, type MemoryFileEntry } from "./internal.js";
+import {
+  buildFileEntries,
+  listMemoryFiles,
+  type MemoryFileEntry,
+  type MemoryFileManifest,
+} from "./internal.js";
 
 const log = createSubsystemLogger("memory");
 
@@ -11,6 +16,16 @@ type ProgressState = {
   report: (update: { completed: number; total: number; label?: string }) => void;
 };
 
+/** Size, mtime and hash of every file of `source` as last indexed. */
+export function readFileManifest(db: DatabaseSync, source: string): MemoryFileManifest {
+  const rows = db
+    .prepare(`SELECT path, hash, mtime, size FROM files WHERE source = ?`)
+    .all(source) as Array<{ path: string; hash: string; mtime: number; size: number }>;
+  return new Map(
+    rows.map((row) => [row.path, { hash: row.hash, mtimeMs: row.mtime, size: row.size }]),
+  );
+}
+
 export async function syncMemoryFiles(params: {
   workspaceDir: string;
   extraPaths?: string[];
@@ -28,8 +43,10 @@ export async function syncMemoryFiles(params: {
   model: string;
 }) {
   const files = await listMemoryFiles(params.workspaceDir, params.extraPaths);
-  const fileEntries = await Promise.all(
-    files.map(async (file) => buildFileEntry(file, params.workspaceDir)),
+  const fileEntries = await buildFileEntries(
+    files,
+    params.workspaceDir,
+    readFileManifest(params.db, "memory"),
   );
 
   log.debug("memory sync: indexing memory files", {
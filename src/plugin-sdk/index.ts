@@ -246,6 +246,8 @@ export type {
   DiagnosticWebhookProcessedEvent,
   DiagnosticWebhookReceivedEvent,
 } from "../infra/diagnostic-events.js";
+export { getUltraStatsSnapshot, setUltraStatsEnabled } from "../ultra.js";
+export type { UltraOpStats, UltraStatsSnapshot } from "../ultra.js";
 export { detectMime, extensionForMime, getFileExtension } from "../media/mime.js";
 export { extractOriginalFilename } from "../media/store.js";
 
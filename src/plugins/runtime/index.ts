@@ -131,6 +131,7 @@ import { probeTelegram } from "../../telegram/probe.js";
 import { sendMessageTelegram } from "../../telegram/send.js";
 import { resolveTelegramToken } from "../../telegram/token.js";
 import { textToSpeechTelephony } from "../../tts/tts.js";
+import { getNativeTelephonyAudio } from "../../ultra.js";
 import { getActiveWebListener } from "../../web/active-listener.js";
 import {
   getWebAuthAgeMs,
@@ -184,6 +185,7 @@ export function createPluginRuntime(): PluginRuntime {
     },
     tts: {
       textToSpeechTelephony,
+      getNativeTelephonyAudio,
     },
     tools: {
       createMemoryGetTool,
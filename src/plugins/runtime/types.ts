@@ -17,6 +17,7 @@ type UpsertChannelPairingRequest =
 type FetchRemoteMedia = typeof import("../../media/fetch.js").fetchRemoteMedia;
 type SaveMediaBuffer = typeof import("../../media/store.js").saveMediaBuffer;
 type TextToSpeechTelephony = typeof import("../../tts/tts.js").textToSpeechTelephony;
+type GetNativeTelephonyAudio = typeof import("../../ultra.js").getNativeTelephonyAudio;
 type BuildMentionRegexes = typeof import("../../auto-reply/reply/mentions.js").buildMentionRegexes;
 type MatchesMentionPatterns =
   typeof import("../../auto-reply/reply/mentions.js").matchesMentionPatterns;
@@ -196,6 +197,7 @@ export type PluginRuntime = {
   };
   tts: {
     textToSpeechTelephony: TextToSpeechTelephony;
+    getNativeTelephonyAudio: GetNativeTelephonyAudio;
   };
   tools: {
     createMemoryGetTool: CreateMemoryGetTool;
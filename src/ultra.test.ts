@@ -0,0 +1,995 @@
+import { isUtf8 } from "node:buffer";
+import { spawnSync } from "node:child_process";
+import crypto from "node:crypto";
+import fs from "node:fs";
+import { createRequire } from "node:module";
+import os from "node:os";
+import path from "node:path";
+import { fileURLToPath } from "node:url";
+import zlib from "node:zlib";
+import { afterAll, describe, expect, it } from "vitest";
+import {
+  compareBuffers,
+  getNativeEmbeddingCache,
+  getNativeGroupHistory,
+  getNativeHashFiles,
+  getNativeKeywordIndex,
+  getNativeProbeMedia,
+  getNativeResizeJpeg,
+  getNativeTopK,
+  getNativeTtlCache,
+  getNativeUtf8,
+  getNativeVectorIndex,
+  getNativeWsMask,
+  getNativeZstd,
+  initUltra,
+  type NativeResizeJpegOptions,
+  type NativeZstdDictionary,
+} from "./ultra.js";
+import { truncateUtf16Safe } from "./utils.js";
+
+// Exercises the native addon directly; each block is skipped when the addon
+// is not built for this platform.
+await initUltra();
+
+// The low-level buffer ops have no accessor in ultra.ts; load them directly
+let addon: any = null;
+try {
+  addon = createRequire(import.meta.url)("../native/build/Release/openclaw_native.node");
+} catch {
+  // not built
+}
+
+const tmpDir = fs.mkdtempSync(path.join(os.tmpdir(), "openclaw-native-"));
+afterAll(() => {
+  fs.rmSync(tmpDir, { recursive: true, force: true });
+});
+
+describe.skipIf(!addon)("native sumUint8", () => {
+  function sum(bytes: Uint8Array): number {
+    let total = 0;
+    for (const byte of bytes) {
+      total += byte;
+    }
+    return total;
+  }
+
+  it("matches a JS sum at every length and alignment around the SIMD widths", () => {
+    const bytes = Buffer.alloc(300);
+    for (let i = 0; i < bytes.length; i++) {
+      bytes[i] = (i * 37 + 11) & 0xff;
+    }
+    for (let start = 0; start < 4; start++) {
+      for (let end = start; end <= bytes.length; end++) {
+        const view = bytes.subarray(start, end);
+        expect(addon.sumUint8(view)).toBe(sum(view));
+      }
+    }
+  });
+
+  it("does not overflow lane accumulators on long runs of 0xff", () => {
+    const bytes = Buffer.alloc((1 << 20) + 7, 0xff);
+    expect(addon.sumUint8(bytes)).toBe(bytes.length * 255);
+    expect(addon.sumUint8(Buffer.alloc(0))).toBe(0);
+  });
+
+  it("rejects a non-buffer argument", () => {
+    expect(() => addon.sumUint8("abc")).toThrow(TypeError);
+    expect(() => addon.sumUint8()).toThrow(TypeError);
+  });
+});
+
+describe.skipIf(!addon)("native pattern search", () => {
+  // Non-overlapping, left to right, like the native searcher
+  function indexOfAll(haystack: Buffer, needle: Buffer): number[] {
+    const hits: number[] = [];
+    for (
+      let at = haystack.indexOf(needle);
+      at >= 0;
+      at = haystack.indexOf(needle, at + needle.length)
+    ) {
+      hits.push(at);
+    }
+    return hits;
+  }
+
+  it("finds every occurrence as Float64 offsets", () => {
+    const haystack = Buffer.from("abaababaab".repeat(50));
+    for (const needle of ["a", "aba", "abaababaab", "b".repeat(40), "zz"]) {
+      const hits = addon.findAll(haystack, Buffer.from(needle));
+      expect(hits).toBeInstanceOf(Float64Array);
+      expect(Array.from(hits)).toEqual(indexOfAll(haystack, Buffer.from(needle)));
+      expect(addon.count(haystack, Buffer.from(needle))).toBe(hits.length);
+    }
+  });
+
+  it("stops at maxHits and handles empty input", () => {
+    const haystack = Buffer.from("xx".repeat(100));
+    expect(Array.from(addon.findAll(haystack, Buffer.from("x"), 3))).toEqual([0, 1, 2]);
+    expect(addon.findAll(Buffer.alloc(0), Buffer.from("x")).length).toBe(0);
+    expect(addon.findAll(Buffer.from("ab"), Buffer.from("abc")).length).toBe(0);
+  });
+});
+
+describe.skipIf(!addon)("native MultiMatcher", () => {
+  // Every overlapping (patternId, offset) pair, ordered by offset then id
+  function scanAll(text: string, patterns: string[], caseInsensitive = false): number[][] {
+    const haystack = caseInsensitive ? text.toLowerCase() : text;
+    const pairs: number[][] = [];
+    patterns.forEach((pattern, id) => {
+      const needle = caseInsensitive ? pattern.toLowerCase() : pattern;
+      for (let at = haystack.indexOf(needle); at >= 0; at = haystack.indexOf(needle, at + 1)) {
+        pairs.push([id, at]);
+      }
+    });
+    return pairs.toSorted((a, b) => a[1] - b[1] || a[0] - b[0]);
+  }
+
+  function nativeScan(
+    text: string,
+    patterns: string[],
+    options?: { caseInsensitive?: boolean },
+  ): number[][] {
+    const flat: Uint32Array = new addon.MultiMatcher(patterns, options).scan(Buffer.from(text));
+    const pairs: number[][] = [];
+    for (let i = 0; i < flat.length; i += 2) {
+      pairs.push([flat[i], flat[i + 1]]);
+    }
+    return pairs.toSorted((a, b) => a[1] - b[1] || a[0] - b[0]);
+  }
+
+  const text = "From: a@b\nMessage-ID: <x@y>\nfrom: c@d\n".repeat(20) + "tail aaaa";
+  const patterns = ["From:", "Message-ID:", "@", "aa", "a", "<x@y>", "not there", "\n"];
+
+  it("reports every occurrence of every pattern like an indexOf scan", () => {
+    expect(nativeScan(text, patterns)).toEqual(scanAll(text, patterns));
+    expect(nativeScan(text, patterns.slice(0, 2))).toEqual(scanAll(text, patterns.slice(0, 2)));
+    expect(nativeScan("", patterns)).toEqual([]);
+  });
+
+  it("folds ASCII case when asked", () => {
+    expect(nativeScan(text, ["FROM:", "message-id:"], { caseInsensitive: true })).toEqual(
+      scanAll(text, ["FROM:", "message-id:"], true),
+    );
+  });
+
+  it("stops at maxHits and answers test()", () => {
+    const matcher = new addon.MultiMatcher(patterns);
+    expect(matcher.patternCount).toBe(patterns.length);
+    expect(matcher.scan(Buffer.from(text), 3).length).toBe(6);
+    expect(matcher.test(Buffer.from("zzz"))).toBe(false);
+    expect(matcher.test(Buffer.from("x@y"))).toBe(true);
+  });
+
+  it("rejects invalid patterns", () => {
+    expect(() => new addon.MultiMatcher("From:")).toThrow(TypeError);
+    expect(() => new addon.MultiMatcher([""])).toThrow(RangeError);
+    expect(() => new addon.MultiMatcher([42])).toThrow(TypeError);
+  });
+});
+
+describe.skipIf(!addon)("native BufferOps.slice", () => {
+  const ops = addon ? new addon.BufferOps() : null;
+  const parent = Buffer.from("0123456789abcdef");
+
+  it("returns views that share memory like subarray", () => {
+    const view: Buffer = ops.slice(parent, 4, 10);
+    expect(view.toString()).toBe(parent.subarray(4, 10).toString());
+    view[0] = 0x58;
+    expect(parent[4]).toBe(0x58);
+    parent[5] = 0x59;
+    expect(view[1]).toBe(0x59);
+    expect(ops.slice(parent, 3n, 3n).length).toBe(0);
+    expect(ops.slice(parent, 0, parent.length).equals(parent)).toBe(true);
+  });
+
+  it("slices many ranges at once", () => {
+    const views: Buffer[] = ops.sliceMany(parent, [0, 2, 2, 2, 10, 16]);
+    expect(views.map((view) => view.toString())).toEqual(
+      [parent.subarray(0, 2), parent.subarray(2, 2), parent.subarray(10, 16)].map(String),
+    );
+    expect(ops.sliceMany(parent, new Float64Array([1, 3])).map(String)).toEqual([
+      parent.subarray(1, 3).toString(),
+    ]);
+  });
+
+  it("rejects ranges outside the buffer and non-integer offsets", () => {
+    expect(() => ops.slice(parent, 4, 3)).toThrow(RangeError);
+    expect(() => ops.slice(parent, 0, parent.length + 1)).toThrow(RangeError);
+    expect(() => ops.slice(parent, 2 ** 32, 2 ** 32 + 1)).toThrow(RangeError);
+    for (const bad of [-1, 1.5, Number.NaN, Number.POSITIVE_INFINITY, -1n, "1"]) {
+      expect(() => ops.slice(parent, bad, 4)).toThrow(TypeError);
+    }
+    expect(() => ops.sliceMany(parent, [0, 1, 2])).toThrow(RangeError);
+    expect(() => ops.sliceMany(parent, [0, 1, 2, 99])).toThrow(RangeError);
+  });
+});
+
+describe.skipIf(!addon)("native BufferPool", () => {
+  it("recycles blocks within a size class", () => {
+    const pool = new addon.BufferPool({ classes: [64, 4096], maxBytes: 1 << 20 });
+    const first: Buffer = pool.acquire(100);
+    expect(first.length).toBe(100);
+    first.fill(7);
+    expect(pool.release(first)).toBe(true);
+    expect(pool.release(first)).toBe(false);
+    const second: Buffer = pool.acquire(4000);
+    expect(second.length).toBe(4000);
+    expect(pool.stats()).toMatchObject({ acquires: 2, hits: 1, releases: 1, outstanding: 1 });
+    expect(pool.acquire(0).length).toBe(0);
+    // Above the largest class: a plain Buffer, never pooled
+    const big: Buffer = pool.acquire(8192);
+    expect(big.length).toBe(8192);
+    expect(pool.release(big)).toBe(false);
+    expect(pool.stats().unpooled).toBe(1);
+  });
+
+  it("serves BufferOps.allocate from the default pool", () => {
+    const ops = new addon.BufferOps();
+    const buf: Buffer = ops.allocate(1000);
+    expect(buf.length).toBe(1000);
+    expect(ops.recycle(buf)).toBe(true);
+    expect(ops.recycle(Buffer.alloc(10))).toBe(false);
+  });
+
+  it("rejects sizes that are not non-negative integers", () => {
+    const pool = new addon.BufferPool();
+    const ops = new addon.BufferOps();
+    for (const size of [-1, 1.5, Number.NaN, Number.POSITIVE_INFINITY, 2 ** 60]) {
+      expect(() => pool.acquire(size)).toThrow(TypeError);
+      expect(() => ops.allocate(size)).toThrow(RangeError);
+    }
+    expect(() => ops.allocate("8")).toThrow(TypeError);
+    for (const options of [
+      { classes: [] },
+      { classes: [0] },
+      { classes: [64.5] },
+      { classes: [Number.NaN] },
+      { maxBytes: -1 },
+      { maxBytes: Number.NaN },
+    ]) {
+      expect(() => new addon.BufferPool(options)).toThrow(TypeError);
+    }
+  });
+});
+
+describe.skipIf(!addon)("native module-level ops", () => {
+  const buffers = addon ? new addon.BufferOps() : null;
+  const simd = addon ? new addon.SimdOps() : null;
+  const a = Buffer.from("the quick brown fox jumps over the lazy dog".repeat(3));
+  const b = Buffer.from("the quick brown fox jumps over the lazy cat".repeat(3));
+
+  it("give the same results as the class methods and the JS equivalents", () => {
+    for (const [x, y] of [
+      [a, b],
+      [b, a],
+      [a, a.subarray(0, 10)],
+      [a, Buffer.from(a)],
+    ]) {
+      expect(addon.compare(x, y)).toBe(Buffer.compare(x, y));
+      expect(buffers.compare(x, y)).toBe(Buffer.compare(x, y));
+      const and = Buffer.alloc(Math.min(x.length, y.length));
+      for (let i = 0; i < and.length; i++) {
+        and[i] = x[i] & y[i];
+      }
+      expect(addon.andBuffers(x, y).equals(and)).toBe(true);
+      expect(simd.andBuffers(x, y).equals(and)).toBe(true);
+    }
+    for (const from of [0, 1, 50, -3, a.length + 5]) {
+      const expected = a.indexOf("the", Math.max(0, from));
+      expect(addon.findPattern(a, Buffer.from("the"), from)).toBe(expected);
+      expect(simd.findPattern(a, Buffer.from("the"), from)).toBe(expected);
+    }
+    expect(addon.sumUint8(a)).toBe(simd.sumUint8(a));
+    expect(addon.count(a, Buffer.from("o"))).toBe(simd.count(a, Buffer.from("o")));
+  });
+
+  it("copy the overlapping length in bulkCopy", () => {
+    const target = Buffer.alloc(10);
+    expect(addon.bulkCopy(a, target)).toBe(10);
+    expect(target.equals(a.subarray(0, 10))).toBe(true);
+    const wide = Buffer.alloc(a.length + 4, 1);
+    expect(buffers.bulkCopy(a, wide)).toBe(a.length);
+    expect(wide.subarray(0, a.length).equals(a)).toBe(true);
+    expect(wide.at(-1)).toBe(1);
+  });
+
+  it("throw the same errors as the class methods", () => {
+    for (const name of ["compare", "andBuffers", "findPattern", "bulkCopy"]) {
+      expect(() => addon[name](a, "x")).toThrow(TypeError);
+    }
+    expect(() => simd.andBuffers(a)).toThrow(TypeError);
+    expect(() => buffers.compare("x", a)).toThrow(TypeError);
+  });
+});
+
+describe.skipIf(!addon)("native bench suite", () => {
+  it("finds native and fallback results equal in every case", () => {
+    const script = fileURLToPath(new URL("../scripts/bench-native.mjs", import.meta.url));
+    const run = spawnSync(process.execPath, [script, "--check", "--max", String(1 << 20)], {
+      encoding: "utf-8",
+    });
+    expect(run.stdout).not.toContain("MISMATCH");
+    expect(run.status).toBe(0);
+  });
+
+  it("keeps compareBuffers equal to Buffer.compare on both sides of the native cutoff", () => {
+    for (const size of [0, 1, 256 * 1024 - 1, 256 * 1024, 256 * 1024 + 33]) {
+      const x = Buffer.alloc(size, 7);
+      const y = Buffer.from(x);
+      expect(compareBuffers(x, y)).toBe(0);
+      if (size > 0) {
+        y[size - 1] = 8;
+        expect(compareBuffers(x, y)).toBe(-1);
+        expect(compareBuffers(y, x)).toBe(1);
+      }
+      expect(compareBuffers(x, Buffer.concat([x, Buffer.from([0])]))).toBe(-1);
+    }
+  });
+});
+
+describe.skipIf(!addon)("native async ops", () => {
+  // Above the 4 MiB threshold where the async kernels split across threads
+  const size = 9 * (1 << 20) + 5;
+  const big = Buffer.alloc(size, 0x61);
+  big.write("needle", size - 6);
+  const other = Buffer.from(big);
+  other[size - 2] = 0x7a;
+
+  it("resolve to what the sync ops return", async () => {
+    expect(await addon.sumUint8Async(big)).toBe(addon.sumUint8(big));
+    expect(await addon.compareAsync(big, other)).toBe(addon.compare(big, other));
+    expect(await addon.compareAsync(big, Buffer.from(big))).toBe(0);
+    expect((await addon.andBuffersAsync(big, other)).equals(addon.andBuffers(big, other))).toBe(
+      true,
+    );
+    expect(await addon.findPatternAsync(big, Buffer.from("needle"))).toBe(size - 6);
+    expect(await addon.findPatternAsync(big, Buffer.from("aaaa"), 5 << 20)).toBe(5 << 20);
+    expect(await addon.findPatternAsync(big, Buffer.from("missing"))).toBe(-1);
+    const target = Buffer.alloc(size);
+    expect(await addon.bulkCopyAsync(big, target)).toBe(size);
+    expect(target.equals(big)).toBe(true);
+  });
+
+  it("count non-overlapping matches across chunk boundaries", async () => {
+    for (const needle of ["aa", "aaa", "aaaaaaa"]) {
+      const expected = addon.count(big, Buffer.from(needle));
+      expect(await addon.countAsync(big, Buffer.from(needle))).toBe(expected);
+    }
+    expect(await addon.countAsync(big, Buffer.from("aaa"))).toBe(Math.floor((size - 6) / 3));
+  });
+
+  it("handle empty input and reject bad arguments", async () => {
+    expect(await addon.sumUint8Async(Buffer.alloc(0))).toBe(0);
+    expect(await addon.countAsync(Buffer.alloc(0), Buffer.from("a"))).toBe(0);
+    expect(() => addon.sumUint8Async("x")).toThrow(TypeError);
+    expect(() => addon.compareAsync(big)).toThrow(TypeError);
+  });
+});
+
+describe.skipIf(!getNativeTopK())("native topK", () => {
+  const topK = getNativeTopK()!;
+  const dims = 37;
+  const rows = 300;
+  let seed = 12345;
+  function random(): number {
+    seed = (seed * 1103515245 + 12345) % 2 ** 31;
+    return seed / 2 ** 30 - 1;
+  }
+  const query = Float32Array.from({ length: dims }, random);
+  const matrix = Float32Array.from({ length: rows * dims }, random);
+
+  function score(row: number, metric: "cosine" | "dot" | "l2"): number {
+    let dot = 0;
+    let normA = 0;
+    let normB = 0;
+    let l2 = 0;
+    for (let j = 0; j < dims; j++) {
+      const value = matrix[row * dims + j];
+      dot += query[j] * value;
+      normA += query[j] * query[j];
+      normB += value * value;
+      l2 += (query[j] - value) ** 2;
+    }
+    if (metric === "dot") {
+      return dot;
+    }
+    return metric === "l2" ? Math.sqrt(l2) : dot / Math.sqrt(normA * normB);
+  }
+
+  function expectRanking(
+    result: { indices: Uint32Array; scores: Float32Array },
+    metric: "cosine" | "dot" | "l2",
+    k: number,
+    digits = 4,
+  ): void {
+    const expected = Array.from({ length: rows }, (_, row) => score(row, metric)).toSorted((a, b) =>
+      metric === "l2" ? a - b : b - a,
+    );
+    expect(result.indices.length).toBe(k);
+    result.scores.forEach((value, i) => {
+      expect(value).toBeCloseTo(expected[i], digits);
+      expect(score(result.indices[i], metric)).toBeCloseTo(value, digits);
+    });
+  }
+
+  it("ranks like a JS scan for every metric", async () => {
+    expectRanking(topK(query, matrix, 10), "cosine", 10);
+    for (const metric of ["cosine", "dot", "l2"] as const) {
+      expectRanking(addon.topK(query, matrix, 25, { metric }), metric, 25);
+      expectRanking(await addon.topKAsync(query, matrix, 25, { metric }), metric, 25);
+    }
+    expect(topK(query, matrix, rows + 10).indices.length).toBe(rows);
+  });
+
+  it("scores f16 and int8 rows close to the float32 ones", () => {
+    expectRanking(addon.topK(query, addon.toFloat16(matrix), 10), "cosine", 10, 2);
+    const { data, scales } = addon.quantizeInt8(matrix, dims);
+    expectRanking(addon.topK(query, data, 10, { scales }), "cosine", 10, 2);
+  });
+
+  it("drops non-finite scores and zero rows score 0", () => {
+    const small = new Float32Array([Number.NaN, 0, 1, 0, 0, 0, 0.5, 0.5]);
+    const result = topK(new Float32Array([1, 0]), small, 4);
+    expect(Array.from(result.indices)).toEqual([1, 3, 2]);
+    expect(result.scores[2]).toBe(0);
+    // Like cosineSimilarity(), a zero row scores 0 whatever the query holds
+    const nanQuery = topK(new Float32Array([Number.NaN, 0]), small, 4);
+    expect(Array.from(nanQuery.indices)).toEqual([2]);
+    expect(topK(query, new Float32Array(0), 5).indices.length).toBe(0);
+  });
+
+  it("rejects mismatched dims and invalid options", () => {
+    expect(() => topK(query, matrix.subarray(1), 5)).toThrow(RangeError);
+    expect(() => topK(new Float32Array(0), matrix, 5)).toThrow(TypeError);
+    expect(() => topK(query, matrix, Number.NaN)).toThrow(RangeError);
+    expect(() => topK(query, matrix, -1)).toThrow(RangeError);
+    expect(() => addon.topK(query, matrix, 5, { metric: "manhattan" })).toThrow(TypeError);
+    expect(() => addon.topK(query, new Int8Array(dims), 5)).toThrow(/scales/);
+    expect(() => addon.quantizeInt8(matrix, 0)).toThrow(RangeError);
+    expect(() => addon.quantizeInt8(matrix, 36)).toThrow(RangeError);
+  });
+});
+
+describe.skipIf(!getNativeHashFiles())("native hashFiles", () => {
+  const hashFiles = getNativeHashFiles()!;
+  // Native reads files in chunks of this size
+  const READ_CHUNK_BYTES = 256 * 1024;
+
+  // hashText() of the file as fs.readFile(path, "utf-8") decodes it
+  function textHash(bytes: Buffer): string {
+    return crypto.createHash("sha256").update(bytes.toString("utf-8")).digest("hex");
+  }
+
+  async function nativeHashes(contents: Buffer[]): Promise<string[]> {
+    const files = contents.map((bytes, i) => {
+      const file = path.join(tmpDir, `hash-${i}.md`);
+      fs.writeFileSync(file, bytes);
+      return file;
+    });
+    const hashed = await hashFiles(files);
+    return hashed
+      .toSorted((a, b) => a.index - b.index)
+      .map((entry) => ("hash" in entry ? entry.hash : entry.error));
+  }
+
+  it("hashes invalid UTF-8 like hashText() of the decoded text", async () => {
+    const contents = [
+      Buffer.alloc(0),
+      Buffer.from("plain ✓ 😀 \ufffd text"),
+      Buffer.from([0x61, 0x80, 0x62]),
+      Buffer.from([0xc0, 0xaf, 0xed, 0xa0, 0x80, 0xf4, 0x90, 0x80, 0x80]),
+      Buffer.from([0xe2, 0x82, 0x41, 0xff, 0xfe]),
+      Buffer.from([0x61, 0xf0, 0x9f, 0x98]),
+    ];
+    expect(await nativeHashes(contents)).toEqual(contents.map(textHash));
+  });
+
+  it("decodes sequences split across reads", async () => {
+    const pad = Buffer.alloc(READ_CHUNK_BYTES - 2, 0x61);
+    const contents = [
+      Buffer.concat([pad, Buffer.from("😀 tail")]),
+      Buffer.concat([pad, Buffer.from([0xf0, 0x9f, 0x41, 0x42])]),
+      Buffer.concat([pad, Buffer.from([0x61, 0xe2, 0x82])]),
+    ];
+    expect(await nativeHashes(contents)).toEqual(contents.map(textHash));
+  });
+});
+
+describe.skipIf(!getNativeVectorIndex())("native VectorIndex", () => {
+  const open = getNativeVectorIndex()!;
+
+  function cosine(a: ArrayLike<number>, b: ArrayLike<number>): number {
+    let dot = 0;
+    let normA = 0;
+    let normB = 0;
+    for (let i = 0; i < a.length; i++) {
+      dot += a[i] * b[i];
+      normA += a[i] * a[i];
+      normB += b[i] * b[i];
+    }
+    return normA === 0 || normB === 0 ? 0 : dot / Math.sqrt(normA * normB);
+  }
+
+  it("ranks like a JS cosine scan and survives a reopen", () => {
+    const file = path.join(tmpDir, "ranked.vec");
+    const rows = [
+      [1, 0, 0],
+      [0.6, 0.8, 0],
+      [0, 0, 0],
+      [-1, 0.1, 0],
+    ];
+    const index = open(file, { dims: 3 });
+    index.addMany(
+      rows.map((_, i) => `r${i}`),
+      new Float32Array(rows.flat()),
+    );
+    index.flush();
+    index.close();
+
+    const query = [0.8, 0.6, 0];
+    const expected = rows
+      .map((row, i) => ({ id: `r${i}`, score: cosine(query, row) }))
+      .toSorted((a, b) => b.score - a.score);
+    const reopened = open(file, { dims: 3 });
+    const hits = reopened.search(new Float32Array(query), rows.length);
+    expect(hits.ids).toEqual(expected.map((hit) => hit.id));
+    hits.scores.forEach((score, i) => expect(score).toBeCloseTo(expected[i].score, 5));
+    reopened.close();
+  });
+
+  it("rejects a reopen with another dims or metric", () => {
+    const file = path.join(tmpDir, "metric.vec");
+    const index = open(file, { dims: 2, metric: "dot" });
+    index.add("a", new Float32Array([1, 2]));
+    index.compact();
+    index.close();
+    expect(() => open(file, { dims: 2 })).toThrow(/metric/);
+    expect(() => open(file, { dims: 3, metric: "dot" })).toThrow(/dims/);
+    const reopened = open(file, { dims: 2, metric: "dot" });
+    expect(reopened.size).toBe(1);
+    expect(() => reopened.add("b", new Float32Array([1, 2, 3]))).toThrow(/dims/);
+    reopened.close();
+  });
+
+  it("rejects invalid options", () => {
+    const file = path.join(tmpDir, "invalid.vec");
+    expect(() => open(file, { dims: 0 })).toThrow();
+    expect(() => open(file, { dims: Number.NaN })).toThrow();
+    expect(() => open(file, { dims: 2, metric: "hamming" as "l2" })).toThrow(/metric/);
+  });
+});
+
+describe.skipIf(!getNativeResizeJpeg() || !getNativeProbeMedia())("native resizeJpeg", () => {
+  const { resize } = getNativeResizeJpeg()!;
+  const probe = getNativeProbeMedia()!;
+  // 32x16 baseline JPEG: red left half, blue right half
+  const jpeg = Buffer.from(
+    "/9j/4AAQSkZJRgABAQAAAQABAAD/2wBDAAgGBgcGBQgHBwcJCQgKDBQNDAsLDBkSEw8UHRofHh0aHBwgJC4nICIs" +
+      "IxwcKDcpLDAxNDQ0Hyc5PTgyPC4zNDL/2wBDAQkJCQwLDBgNDRgyIRwhMjIyMjIyMjIyMjIyMjIyMjIyMjIyMjIy" +
+      "MjIyMjIyMjIyMjIyMjIyMjIyMjIyMjIyMjL/wAARCAAQACADASIAAhEBAxEB/8QAFgABAQEAAAAAAAAAAAAAAAAA" +
+      "AAcF/8QAFxAAAwEAAAAAAAAAAAAAAAAAABViof/EABUBAQEAAAAAAAAAAAAAAAAAAAcI/8QAFhEAAwAAAAAAAAAA" +
+      "AAAAAAAAABVh/9oADAMBAAIRAxEAPwDMRRgRRhS0UBFAataIrukFRRgRRhS0UYEUYUw1pPbun//Z",
+    "base64",
+  );
+  // APP1 Exif segment with a single Orientation = 6 (rotate 90 clockwise) tag
+  const exif = Buffer.from([
+    0xff, 0xe1, 0x00, 0x22, 0x45, 0x78, 0x69, 0x66, 0x00, 0x00, 0x49, 0x49, 0x2a, 0x00, 0x08, 0x00,
+    0x00, 0x00, 0x01, 0x00, 0x12, 0x01, 0x03, 0x00, 0x01, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+  ]);
+  const rotated = Buffer.concat([jpeg.subarray(0, 2), exif, jpeg.subarray(2)]);
+
+  async function size(
+    input: Buffer,
+    options?: NativeResizeJpegOptions,
+  ): Promise<number[] | null> {
+    const result = await resize(input, options);
+    if (!result) {
+      return null;
+    }
+    // What the media probe reads back from the encoded output
+    const probed = probe.probe(result.data);
+    const { width, height } = result;
+    expect(probed).toMatchObject({ mime: "image/jpeg", width, height });
+    return [width, height];
+  }
+
+  it("fits inside maxSide like sharp's fit: inside", async () => {
+    expect(probe.probe(rotated)).toMatchObject({ width: 32, height: 16, orientation: 6 });
+    expect(await size(jpeg)).toEqual([32, 16]);
+    expect(await size(jpeg, { maxSide: 16 })).toEqual([16, 8]);
+    expect(await size(jpeg, { maxSide: 64 })).toEqual([32, 16]);
+    expect(await size(jpeg, { maxSide: 64, withoutEnlargement: false })).toEqual([64, 32]);
+  });
+
+  it("applies the EXIF orientation unless told not to", async () => {
+    expect(await size(rotated)).toEqual([16, 32]);
+    expect(await size(rotated, { maxSide: 16 })).toEqual([8, 16]);
+    expect(await size(rotated, { autoOrient: false })).toEqual([32, 16]);
+  });
+
+  it("resolves null for input sharp should handle instead", async () => {
+    expect(await resize(Buffer.from("not a jpeg"))).toBeNull();
+    expect(await resize(jpeg.subarray(0, 100))).toBeNull();
+    expect(await resize(Buffer.alloc(0))).toBeNull();
+  });
+
+  it("rejects invalid options", () => {
+    for (const options of [
+      { maxSide: 0 },
+      { maxSide: 1.5 },
+      { maxSide: Number.NaN },
+      { quality: 0 },
+      { quality: 101 },
+      { quality: 80.5 },
+      { quality: Number.NaN },
+    ]) {
+      expect(() => resize(jpeg, options)).toThrow(TypeError);
+    }
+  });
+});
+
+describe.skipIf(!getNativeZstd())("native zstd", () => {
+  const zstd = getNativeZstd()!;
+  const lines = Array.from({ length: 4000 }, (_, i) => `{"seq":${i},"text":"hello ${i % 17}"}`);
+  const text = Buffer.from(lines.join("\n"));
+
+  it("round-trips whole frames, streamed frames and concatenations", () => {
+    const decompressor = zstd.createDecompressor();
+    const whole = zstd.createCompressor({ level: 3, checksum: true }).compress(text);
+    expect(zstd.isFrame(whole)).toBe(true);
+    expect(decompressor.decompress(whole).equals(text)).toBe(true);
+
+    const compressor = zstd.createCompressor();
+    const parts = [compressor.push(text.subarray(0, 1000)), compressor.flush()];
+    parts.push(compressor.push(text.subarray(1000)), compressor.end());
+    const both = decompressor.decompress(Buffer.concat([...parts, whole]));
+    expect(both.equals(Buffer.concat([text, text]))).toBe(true);
+
+    const empty = zstd.createCompressor().compress(Buffer.alloc(0));
+    expect(decompressor.decompress(empty).length).toBe(0);
+    expect(zstd.isFrame(Buffer.from("plain"))).toBe(false);
+  });
+
+  it.skipIf(typeof zlib.zstdDecompressSync !== "function")(
+    "reads and writes the same frames as node:zlib",
+    () => {
+      const native = zstd.createCompressor({ level: 5 }).compress(text);
+      expect(zlib.zstdDecompressSync(native).equals(text)).toBe(true);
+      const fromZlib = zstd.createDecompressor().decompress(zlib.zstdCompressSync(text));
+      expect(fromZlib.equals(text)).toBe(true);
+    },
+  );
+
+  it("needs the dictionary a frame was written with", () => {
+    const samples = Array.from({ length: 200 }, (_, i) =>
+      Buffer.from(`{"seq":${i},"role":"assistant","text":"reply number ${i}"}`),
+    );
+    const dictionary = zstd.loadDictionary(zstd.trainDictionary(samples, { size: 4096 }));
+    const frame = zstd.createCompressor({ dictionary }).compress(samples[7]);
+    expect(zstd.createDecompressor({ dictionary }).decompress(frame).equals(samples[7])).toBe(true);
+    expect(() => zstd.createDecompressor().decompress(frame)).toThrow(/zstd/);
+  });
+
+  it("stops at maxOutput and rejects truncated frames", () => {
+    const frame = zstd.createCompressor().compress(text);
+    const bounded = zstd.createDecompressor({ maxOutput: 1000 });
+    expect(() => bounded.decompress(frame)).toThrow(/zstd/);
+
+    const sliced = zstd.createDecompressor({ maxOutput: 4096 });
+    const out = [sliced.push(frame)];
+    while (sliced.more) {
+      out.push(sliced.push());
+    }
+    expect(out.every((slice) => slice.length <= 4096)).toBe(true);
+    expect(Buffer.concat(out).equals(text)).toBe(true);
+    expect(sliced.finished).toBe(true);
+
+    const truncated = zstd.createDecompressor();
+    truncated.push(frame.subarray(0, frame.length - 3));
+    expect(truncated.finished).toBe(false);
+    expect(() => zstd.createDecompressor().decompress(frame.subarray(0, 10))).toThrow(/zstd/);
+  });
+
+  it("rejects invalid options", () => {
+    for (const level of [Number.NaN, 1.5, 1000]) {
+      expect(() => zstd.createCompressor({ level })).toThrow(RangeError);
+    }
+    for (const options of [
+      { maxOutput: 0 },
+      { maxOutput: 10.5 },
+      { maxOutput: Number.NaN },
+      { windowLogMax: 9 },
+      { windowLogMax: Number.NaN },
+    ]) {
+      expect(() => zstd.createDecompressor(options)).toThrow(RangeError);
+    }
+    const notDictionary = {} as NativeZstdDictionary;
+    expect(() => zstd.createCompressor({ dictionary: notDictionary })).toThrow(TypeError);
+    expect(() => zstd.trainDictionary([Buffer.from("x")], { size: 10 })).toThrow(RangeError);
+  });
+});
+
+describe.skipIf(!getNativeKeywordIndex())("native KeywordIndex", () => {
+  const create = getNativeKeywordIndex()!;
+
+  function search(docs: Record<string, string>, query: string): string[] {
+    const index = create();
+    for (const [id, text] of Object.entries(docs)) {
+      index.add(id, text, "memory");
+    }
+    return index.search(query, { k: 10 }).ids.toSorted();
+  }
+
+  it("splits words on Unicode punctuation", () => {
+    expect(search({ a: "she wrote “memory” down", b: "memo" }, "memory")).toEqual(["a"]);
+    expect(search({ a: "notes—important…" }, "notes")).toEqual(["a"]);
+    expect(search({ a: "notes—important…" }, "important")).toEqual(["a"]);
+  });
+
+  it("folds case and diacritics like unicode61", () => {
+    expect(search({ a: "CAFÉ au lait", b: "café noir" }, "café")).toEqual(["a", "b"]);
+    expect(search({ a: "Ærø Straße" }, "ærø")).toEqual(["a"]);
+    expect(search({ a: "ΑΘΗΝΑ Москва" }, "москва")).toEqual(["a"]);
+  });
+
+  it("keeps letters and numbers of other scripts as words", () => {
+    expect(search({ a: "東京 2024年", b: "١٢٣ x" }, "東京")).toEqual(["a"]);
+    expect(search({ a: "東京 2024年", b: "١٢٣ x" }, "١٢٣")).toEqual(["b"]);
+  });
+});
+
+describe.skipIf(!getNativeTtlCache())("native TtlCache", () => {
+  const create = getNativeTtlCache()!;
+
+  it("charges each entry its allocation block against maxBytes", () => {
+    const cache = create({ capacity: 100, maxBytes: 256, shards: 1 });
+    expect(cache.set("k", "v")).toBe(true);
+    expect(cache.stats()).toMatchObject({ bytes: 64, bytesPayload: 2 });
+    cache.set("big", "x".repeat(100));
+    expect(cache.stats()).toMatchObject({ bytes: 64 + 128, bytesPayload: 2 + 103 });
+    // A third 128-byte block would go over 256, so the oldest entry goes
+    cache.set("big2", "y".repeat(100));
+    expect(cache.has("k")).toBe(false);
+    expect(cache.stats().bytes).toBeLessThanOrEqual(256);
+    expect(cache.set("huge", "z".repeat(300))).toBe(false);
+  });
+
+  it("rejects invalid options", () => {
+    for (const options of [
+      { capacity: 0 },
+      { capacity: 1.5 },
+      { capacity: Number.NaN },
+      { capacity: 4, maxBytes: 10.5 },
+      { capacity: 4, maxBytes: Number.NaN },
+      { capacity: 4, shards: 2.5 },
+      { capacity: 4, ttlMs: -1 },
+    ]) {
+      expect(() => create(options)).toThrow();
+    }
+  });
+
+  it("throws when a named cache is joined with different limits", () => {
+    const name = `ttl-test-${process.pid}`;
+    const first = create({ capacity: 10, ttlMs: 1000, name });
+    const second = create({ capacity: 10, ttlMs: 1000, name });
+    expect(second.attached).toBe(true);
+    first.set("k", "shared");
+    expect(second.get("k")).toBe("shared");
+    expect(() => create({ capacity: 11, ttlMs: 1000, name })).toThrow(/different limits/);
+    expect(() => create({ capacity: 10, name })).toThrow(/different limits/);
+  });
+});
+
+describe.skipIf(!getNativeGroupHistory())("native GroupHistory", () => {
+  const createGroupHistory = getNativeGroupHistory()!;
+
+  it("keeps the same entries as the JS fallback across wraparound", () => {
+    const history = createGroupHistory({ maxEntriesPerGroup: 5 });
+    const reference = new Map<string, Array<{ timestamp: number; content: string }>>();
+    for (let i = 0; i < 200; i++) {
+      const groupId = `group-${i % 3}`;
+      const content = i % 7 === 0 ? "" : `msg ${i} ${"é✓😀".repeat(i % 4)}`;
+      const entry = { timestamp: i, content };
+      expect(history.add(groupId, entry)).toBe(true);
+      const list = reference.get(groupId) ?? [];
+      list.push(entry);
+      if (list.length > 5) {
+        list.shift();
+      }
+      reference.set(groupId, list);
+    }
+    expect(history.len()).toBe(reference.size);
+    for (const [groupId, list] of reference) {
+      expect(history.get(groupId)).toEqual(list);
+    }
+    expect(history.get("unknown")).toEqual([]);
+  });
+
+  it("returns a copy of the entries from fromTs in getRange", () => {
+    const history = createGroupHistory({ maxEntriesPerGroup: 4 });
+    for (let i = 0; i < 6; i++) {
+      history.add("g", { timestamp: i * 10, content: `entry ${i} ✓` });
+    }
+    const range = history.getRange("g", 35)!;
+    expect(Array.from(range.timestamps)).toEqual([40, 50]);
+    const decoded = Array.from(range.timestamps, (_, i) =>
+      range.data.toString("utf-8", range.offsets[i], range.offsets[i] + range.lengths[i]),
+    );
+    expect(decoded).toEqual(["entry 4 ✓", "entry 5 ✓"]);
+    range.data.fill(0);
+    expect(history.get("g").map((entry) => entry.content)).toEqual([
+      "entry 2 ✓",
+      "entry 3 ✓",
+      "entry 4 ✓",
+      "entry 5 ✓",
+    ]);
+    expect(history.getRange("g", 1000)!.data.length).toBe(0);
+    expect(history.getRange("unknown")).toBeNull();
+  });
+
+  it("refuses content larger than maxBytes", () => {
+    const history = createGroupHistory({ maxEntriesPerGroup: 4, maxBytes: 64 });
+    expect(history.add("g", { timestamp: 1, content: "x".repeat(65) })).toBe(false);
+    expect(history.get("g")).toEqual([]);
+  });
+
+  it("rejects invalid options and NaN timestamps", () => {
+    for (const maxEntriesPerGroup of [0, 1.5, Number.NaN, 2 ** 24 + 1]) {
+      expect(() => createGroupHistory({ maxEntriesPerGroup })).toThrow(TypeError);
+    }
+    for (const maxBytes of [0, 0.5, Number.NaN, Number.POSITIVE_INFINITY]) {
+      expect(() => createGroupHistory({ maxEntriesPerGroup: 4, maxBytes })).toThrow(TypeError);
+    }
+    const history = createGroupHistory({ maxEntriesPerGroup: 4 });
+    expect(() => history.add("g", { timestamp: Number.NaN, content: "x" })).toThrow(TypeError);
+    expect(() => history.getRange("g", Number.NaN)).toThrow(TypeError);
+  });
+});
+
+describe.skipIf(!getNativeEmbeddingCache())("native EmbeddingCache", () => {
+  const open = getNativeEmbeddingCache()!;
+  // File layout: a 4 KiB header, then 32-byte slots starting with their seq
+  const HEADER_BYTES = 4096;
+  const SLOT_BYTES = 32;
+
+  it("creates over a file whose creator died before writing the header", () => {
+    const file = path.join(tmpDir, "half-created.vec");
+    fs.writeFileSync(file, Buffer.alloc(8192));
+    expect(() => open(file)).toThrow(/empty/);
+    const cache = open(file, { dims: 4 });
+    cache.setMany(["h"], new Float32Array([1, 2, 3, 4]));
+    expect(Array.from(cache.lookup(["h"]).vectors)).toEqual([1, 2, 3, 4]);
+    cache.close();
+  });
+
+  it("leaves a file that is not a cache alone", () => {
+    const file = path.join(tmpDir, "foreign.vec");
+    fs.writeFileSync(file, Buffer.from("not an embedding cache".padEnd(256)));
+    expect(() => open(file, { dims: 4 })).toThrow(/not an embedding store/);
+  });
+
+  it("rewrites a slot a writer died filling", () => {
+    const file = path.join(tmpDir, "torn-slot.vec");
+    const cache = open(file, { dims: 2 });
+    cache.setMany(["h"], new Float32Array([1, 2]));
+    cache.close();
+
+    const bytes = fs.readFileSync(file);
+    let seqOffset = -1;
+    for (let offset = HEADER_BYTES; seqOffset < 0; offset += SLOT_BYTES) {
+      if (bytes.readUInt32LE(offset) !== 0) {
+        seqOffset = offset;
+      }
+    }
+    const fd = fs.openSync(file, "r+");
+    const odd = Buffer.alloc(4);
+    odd.writeUInt32LE(bytes.readUInt32LE(seqOffset) + 1);
+    fs.writeSync(fd, odd, 0, 4, seqOffset);
+    fs.closeSync(fd);
+
+    const reopened = open(file);
+    expect(reopened.lookup(["h"]).found[0]).toBe(0);
+    reopened.setMany(["h"], new Float32Array([3, 4]));
+    expect(Array.from(reopened.lookup(["h"]).vectors)).toEqual([3, 4]);
+    expect(reopened.size).toBe(1);
+    reopened.close();
+  });
+});
+
+describe.skipIf(!getNativeUtf8())("native UTF-8", () => {
+  const utf8 = getNativeUtf8()!;
+  const samples = [
+    "",
+    "plain ascii",
+    "é✓😀 mixed",
+    "\u{10ffff}\u0800\u07ff",
+  ].map((text) => Buffer.from(text));
+  const invalid = [
+    [0xc0, 0x80], // overlong
+    [0xe0, 0x80, 0x80], // overlong
+    [0xed, 0xa0, 0x80], // surrogate
+    [0xf4, 0x90, 0x80, 0x80], // above U+10FFFF
+    [0xf0, 0x9f, 0x98], // truncated
+    [0x80], // lone continuation
+    [0xff],
+  ].map((bytes) => Buffer.from(bytes));
+
+  it("validates like isUtf8 from node:buffer around the SIMD widths", () => {
+    for (const pad of [0, 1, 15, 16, 31, 32, 63, 64, 65]) {
+      const prefix = Buffer.alloc(pad, "a");
+      for (const sample of [...samples, ...invalid]) {
+        const bytes = Buffer.concat([prefix, sample, prefix]);
+        expect(utf8.validate(bytes)).toBe(isUtf8(bytes));
+        expect(utf8.utf16Length(bytes)).toBe(isUtf8(bytes) ? bytes.toString("utf-8").length : null);
+      }
+    }
+  });
+
+  it("truncates like truncateUtf16Safe without splitting code points", () => {
+    const bytes = Buffer.from("ab😀cé✓😀".repeat(3));
+    const text = bytes.toString("utf-8");
+    for (const maxChars of [0, 1, 2, 3, 4, 5.7, 12, 100, -1, Number.NaN, Infinity]) {
+      expect(utf8.truncate(bytes, { maxChars })).toBe(truncateUtf16Safe(text, maxChars));
+    }
+    for (let maxBytes = 0; maxBytes <= bytes.length; maxBytes++) {
+      const prefix = utf8.truncate(bytes, { maxBytes })!;
+      expect(text.startsWith(prefix)).toBe(true);
+      expect(Buffer.byteLength(prefix)).toBeLessThanOrEqual(maxBytes);
+      // The next code point (one or two code units) no longer fits
+      const next = text.codePointAt(prefix.length);
+      if (next !== undefined) {
+        expect(Buffer.byteLength(prefix + String.fromCodePoint(next))).toBeGreaterThan(maxBytes);
+      }
+    }
+    expect(utf8.truncate(Buffer.alloc(0), { maxChars: 5 })).toBe("");
+    expect(utf8.truncate(Buffer.from([0x61, 0xff]), { maxChars: 1 })).toBe("a");
+    expect(utf8.truncate(Buffer.from([0x61, 0xff]), { maxChars: 2 })).toBeNull();
+    expect(() => utf8.truncate(bytes, { maxChars: "3" as unknown as number })).toThrow(TypeError);
+  });
+});
+
+describe.skipIf(!getNativeWsMask())("native WebSocket masking", () => {
+  const ws = getNativeWsMask()!;
+  const mask = Buffer.from([0x12, 0x34, 0x56, 0x78]);
+
+  function xor(bytes: Buffer): Buffer {
+    return Buffer.from(bytes.map((byte, i) => byte ^ mask[i % 4]));
+  }
+
+  it("XORs like a JS loop at every length and output offset", () => {
+    for (let length = 0; length <= 130; length++) {
+      const source = crypto.randomBytes(length);
+      for (const offset of [0, 3]) {
+        const output = Buffer.alloc(length + offset + 2, 0xaa);
+        ws.mask(source, mask, output, offset, length);
+        expect(output.subarray(offset, offset + length).equals(xor(source))).toBe(true);
+        expect(output.subarray(0, offset).every((byte) => byte === 0xaa)).toBe(true);
+        expect(output.subarray(offset + length).every((byte) => byte === 0xaa)).toBe(true);
+      }
+      const copy = Buffer.from(source);
+      ws.unmask(copy, mask);
+      expect(copy.equals(xor(source))).toBe(true);
+    }
+  });
+
+  it("rejects short masks and offsets or lengths outside the buffers", () => {
+    const source = Buffer.alloc(8);
+    const output = Buffer.alloc(8);
+    expect(() => ws.unmask(source, Buffer.alloc(3))).toThrow(RangeError);
+    expect(() => ws.mask(source, Buffer.alloc(3), output, 0, 8)).toThrow(RangeError);
+    for (const [offset, length] of [
+      [1, 8],
+      [0, 9],
+      [-1, 4],
+      [Number.NaN, 4],
+      [0, Number.NaN],
+      [0.5, 4],
+      [Infinity, 0],
+    ]) {
+      expect(() => ws.mask(source, mask, output, offset, length)).toThrow(RangeError);
+    }
+    expect(() => ws.unmask("x" as unknown as Buffer, mask)).toThrow(TypeError);
+  });
+});
@@ -5,11 +5,15 @@
 
 import { createHash } from "node:crypto";
 import { existsSync } from "node:fs";
+import { createRequire } from "node:module";
 import { join, dirname } from "node:path";
+import { Transform } from "node:stream";
 import { fileURLToPath } from "node:url";
 import { features, isEnabled } from "./config/features.js";
 
 const __dirname = dirname(fileURLToPath(import.meta.url));
+// This package is ESM; the .node addon still loads through require
+const require = createRequire(import.meta.url);
 
 // Lazy-loaded native modules
 let rustModule: any = null;
@@ -31,10 +35,18 @@ async function loadKoffi() {
   return koffi;
 }
 
+let initialized: Promise<void> | null = null;
+
 /**
- * Initialize ultra performance modules
+ * Initialize ultra performance modules. Until this has run every accessor
+ * below takes its fallback; later calls share the first load.
  */
-export async function initUltra(): Promise<void> {
+export function initUltra(): Promise<void> {
+  initialized ??= loadUltraModules();
+  return initialized;
+}
+
+async function loadUltraModules(): Promise<void> {
   console.log("🚀 Initializing OpenClaw Ultra Performance...\n");
 
   const koffiLib = await loadKoffi();
@@ -63,6 +75,7 @@ export async function initUltra(): Promise<void> {
       const nativePath = join(__dirname, "../native/build/Release/openclaw_native.node");
       if (existsSync(nativePath)) {
         nativeModule = require(nativePath);
+        nativeModule.setOpStatsEnabled?.(statsEnabled);
         console.log("✓ Native addons loaded");
       } else {
         console.warn("⚠️  Native module not found at:", nativePath);
@@ -75,6 +88,34 @@ export async function initUltra(): Promise<void> {
   console.log("");
 }
 
+// Fallback hits per accelerated op, counted while stats are enabled
+let statsEnabled = false;
+const fallbackHits = new Map<string, number>();
+
+function fallback(op: string): null {
+  if (statsEnabled) {
+    fallbackHits.set(op, (fallbackHits.get(op) ?? 0) + 1);
+  }
+  return null;
+}
+
+// Native classes that callers probe for before choosing a backend
+const nativeClasses = {
+  hnsw: ["useSimdOps", "HnswIndex"],
+  vectorIndex: ["useSimdOps", "VectorIndex"],
+  keywordIndex: ["useSimdOps", "KeywordIndex"],
+  embeddingCache: ["useSimdOps", "EmbeddingCache"],
+} as const;
+
+/**
+ * Whether the matching getNative*() accessor would return the native
+ * implementation. Unlike calling it, probing never counts a fallback hit.
+ */
+export function hasNativeClass(op: keyof typeof nativeClasses): boolean {
+  const [feature, name] = nativeClasses[op];
+  return isEnabled(feature) && Boolean(nativeModule?.[name]);
+}
+
 /**
  * Hash function - Blake3 or SHA256 fallback
  */
@@ -84,6 +125,7 @@ export function ultraHash(data: Buffer): Buffer {
   }
 
   // Fallback to Node.js crypto
+  fallback("hash");
   return createHash("sha256").update(data).digest();
 }
 
@@ -96,6 +138,7 @@ export function fastHash(data: Buffer): bigint {
   }
 
   // Simple fallback hash
+  fallback("fastHash");
   let hash = 0;
   for (let i = 0; i < data.length; i++) {
     hash = (hash << 5) - hash + data[i];
@@ -113,9 +156,230 @@ export function ultraParseJson(json: string): any {
     return JSON.parse(result); // Parse the Rust result back to JS object
   }
 
+  fallback("parseJson");
   return JSON.parse(json);
 }
 
+/**
+ * Native zstd - reusable contexts and dictionaries, or null
+ */
+export type NativeZstdDictionary = {
+  /** Dictionary ID from the trainer; 0 for raw-content dictionaries. */
+  readonly id: number;
+  /** Frames compressed with this dictionary use its level. */
+  readonly level: number;
+  readonly size: number;
+};
+
+export type NativeZstdCompressor = {
+  /** Compressed bytes ready so far; often empty while a block fills. */
+  push(chunk: Uint8Array): Buffer;
+  /** Everything buffered, decodable up to here; the frame stays open. */
+  flush(): Buffer;
+  /** The rest of the frame; the next push starts a new one. */
+  end(chunk?: Uint8Array): Buffer;
+  /** `data` as one whole frame. */
+  compress(data: Uint8Array): Buffer;
+  reset(): void;
+};
+
+export type NativeZstdDecompressor = {
+  /**
+   * Decoded bytes, at most maxOutput of them; frames may span or share
+   * chunks. While `more` is set, push() without a chunk returns the next
+   * slice.
+   */
+  push(chunk?: Uint8Array): Buffer;
+  /** Every frame in `data`; throws on a truncated one or past maxOutput. */
+  decompress(data: Uint8Array): Buffer;
+  /** True when the input so far ends on a frame boundary. */
+  readonly finished: boolean;
+  /** True when the last push() stopped at maxOutput with more to come. */
+  readonly more: boolean;
+  reset(): void;
+};
+
+export type NativeZstd = {
+  /** Trains a dictionary (default ~110 KiB) from sample records. */
+  trainDictionary(samples: Uint8Array[], options?: { size?: number }): Buffer;
+  loadDictionary(bytes: Uint8Array, options?: { level?: number }): NativeZstdDictionary;
+  createCompressor(options?: {
+    level?: number;
+    checksum?: boolean;
+    dictionary?: NativeZstdDictionary;
+  }): NativeZstdCompressor;
+  createDecompressor(options?: {
+    dictionary?: NativeZstdDictionary;
+    /** Largest window (2^n bytes) a frame may ask for; default 27. */
+    windowLogMax?: number;
+    /** Largest result of one push() or decompress(); default unlimited. */
+    maxOutput?: number;
+  }): NativeZstdDecompressor;
+  isFrame(data: Uint8Array): boolean;
+};
+
+export function getNativeZstd(): NativeZstd | null {
+  return loadNativeZstd() ?? fallback("zstd");
+}
+
+function loadNativeZstd(): NativeZstd | null {
+  if (isEnabled("useZstd") && nativeModule?.ZstdCompressor) {
+    const native = nativeModule;
+    return {
+      trainDictionary: (samples, options) => native.ZstdDictionary.train(samples, options ?? {}),
+      loadDictionary: (bytes, options) => new native.ZstdDictionary(bytes, options ?? {}),
+      createCompressor: (options) => new native.ZstdCompressor(options ?? {}),
+      createDecompressor: (options) => new native.ZstdDecompressor(options ?? {}),
+      isFrame: (data) => native.isZstdFrame(data),
+    };
+  }
+  return null;
+}
+
+// `next` returns further output for the same chunk until it is empty
+function zstdTransform(
+  push: (chunk: Buffer) => Buffer,
+  end: () => Buffer,
+  next?: () => Buffer | null,
+): Transform {
+  return new Transform({
+    transform(chunk: Buffer, _encoding, callback) {
+      try {
+        let out: Buffer | null = push(chunk);
+        while (out) {
+          if (out.length > 0) {
+            this.push(out);
+          }
+          out = next?.() ?? null;
+        }
+        callback();
+      } catch (err) {
+        callback(err as Error);
+      }
+    },
+    flush(callback) {
+      try {
+        const out = end();
+        callback(null, out.length > 0 ? out : undefined);
+      } catch (err) {
+        callback(err as Error);
+      }
+    },
+  });
+}
+
+/**
+ * Streaming zstd compression as a Transform, one frame per stream, or null
+ * without the native module. Memory stays bounded by zstd's window however
+ * much is piped through.
+ */
+export function createZstdCompressStream(
+  options?: Parameters<NativeZstd["createCompressor"]>[0],
+): Transform | null {
+  const compressor = getNativeZstd()?.createCompressor(options);
+  if (!compressor) {
+    return null;
+  }
+  return zstdTransform(
+    (chunk) => compressor.push(chunk),
+    () => compressor.end(),
+  );
+}
+
+// Output slice size of the decompress stream unless maxOutput says otherwise
+const ZSTD_STREAM_SLICE_BYTES = 1024 * 1024;
+
+/**
+ * Streaming zstd decompression as a Transform, or null without the native
+ * module. Input may hold several concatenated frames; a stream that stops
+ * mid-frame fails on end. Output is pushed in slices of at most maxOutput
+ * (default 1 MiB) bytes, however far one chunk expands.
+ */
+export function createZstdDecompressStream(
+  options?: Parameters<NativeZstd["createDecompressor"]>[0],
+): Transform | null {
+  const decompressor = getNativeZstd()?.createDecompressor({
+    maxOutput: ZSTD_STREAM_SLICE_BYTES,
+    ...options,
+  });
+  if (!decompressor) {
+    return null;
+  }
+  return zstdTransform(
+    (chunk) => decompressor.push(chunk),
+    () => {
+      if (!decompressor.finished) {
+        throw new Error("zstd: stream ended inside a frame");
+      }
+      return Buffer.alloc(0);
+    },
+    () => (decompressor.more ? decompressor.push() : null),
+  );
+}
+
+/**
+ * Seekable transcript archives (zstd blocks + line index) - native or null
+ */
+export type NativeTranscriptPack = {
+  /** Totals for the whole archive after packing. */
+  lines: number;
+  messages: number;
+  blocks: number;
+  bytes: number;
+};
+
+export type NativeTranscriptQuery = {
+  /** Blocks holding the last N { type: "message" } records. */
+  lastMessages?: number;
+  /** Lines numbered above this one (0-based). */
+  afterLine?: number;
+  /** From the first block with a message newer than this (Unix ms). */
+  afterMs?: number;
+  /** At most this many lines. */
+  limit?: number;
+};
+
+export type NativeTranscriptSlice = {
+  /**
+   * Raw JSONL lines. lastMessages and afterMs return whole blocks, so the
+   * caller trims; firstLine is the number of lines[0].
+   */
+  lines: string[];
+  firstLine: number;
+  totalLines: number;
+  totalMessages: number;
+  blocksRead: number;
+};
+
+export type NativeTranscriptArchive = {
+  /** Packs (or with append, adds) the JSONL file at `source` into `dest`. */
+  pack(
+    source: string,
+    dest: string,
+    options?: { blockSize?: number; level?: number; append?: boolean },
+  ): Promise<NativeTranscriptPack>;
+  /** Decompresses only the blocks the query touches. */
+  read(path: string, query?: NativeTranscriptQuery): NativeTranscriptSlice;
+  readAsync(path: string, query?: NativeTranscriptQuery): Promise<NativeTranscriptSlice>;
+};
+
+export function getNativeTranscriptArchive(): NativeTranscriptArchive | null {
+  if (isEnabled("useZstd") && nativeModule?.packTranscriptAsync) {
+    const native = nativeModule;
+    return {
+      pack: (source, dest, options) => native.packTranscriptAsync(source, dest, options ?? {}),
+      read: (path, query) => native.readTranscriptArchive(path, query ?? {}),
+      readAsync: (path, query) => native.readTranscriptArchiveAsync(path, query ?? {}),
+    };
+  }
+  return fallback("transcriptArchive");
+}
+
+// One reused native context per level (or output limit) for the one-shot
+// helpers below
+const zstdCompressors = new Map<number, NativeZstdCompressor>();
+const zstdDecompressors = new Map<number, NativeZstdDecompressor>();
+
 /**
  * Compress - Zstd or fallback
  */
@@ -124,21 +388,127 @@ export function ultraCompress(data: Buffer, level?: number): Buffer {
     return rustModule.zstdCompress(data, level ?? 3);
   }
 
+  const zstd = getNativeZstd();
+  if (zstd) {
+    const key = level ?? 3;
+    let compressor = zstdCompressors.get(key);
+    if (!compressor) {
+      compressor = zstd.createCompressor({ level: key });
+      zstdCompressors.set(key, compressor);
+    }
+    return compressor.compress(data);
+  }
+
   // Fallback: return uncompressed (or use zlib)
   return data;
 }
 
 /**
- * Decompress - Zstd or fallback
+ * Decompress - Zstd or fallback. Throws rather than return more than
+ * maxOutput bytes (default 256 MiB); the addon's decoder stops before
+ * allocating them, the Rust core only checks afterwards.
  */
-export function ultraDecompress(data: Buffer): Buffer {
+const ZSTD_MAGIC = 0xfd2fb528;
+const ULTRA_DECOMPRESS_MAX_OUTPUT = 256 * 1024 * 1024;
+
+export function ultraDecompress(
+  data: Buffer,
+  maxOutput: number = ULTRA_DECOMPRESS_MAX_OUTPUT,
+): Buffer {
   if (isEnabled("useZstd") && rustModule?.zstdDecompress) {
-    return rustModule.zstdDecompress(data);
+    const out = rustModule.zstdDecompress(data);
+    if (out.length > maxOutput) {
+      throw new Error(`zstd: output exceeds ${maxOutput} bytes`);
+    }
+    return out;
+  }
+
+  // Data that is not a zstd frame was stored by the uncompressed fallback;
+  // returning it as-is is not a fallback, only a frame with no decoder is
+  const zstd = loadNativeZstd();
+  if (zstd?.isFrame(data)) {
+    let decompressor = zstdDecompressors.get(maxOutput);
+    if (!decompressor) {
+      decompressor = zstd.createDecompressor({ maxOutput });
+      zstdDecompressors.set(maxOutput, decompressor);
+    }
+    return decompressor.decompress(data);
+  }
+  if (!zstd && data.length >= 4 && data.readUInt32LE(0) === ZSTD_MAGIC) {
+    fallback("zstd");
   }
 
   return data;
 }
 
+/**
+ * Off-heap TTL/LRU cache - native, or null
+ */
+export type NativeTtlCacheStats = {
+  hits: number;
+  misses: number;
+  hitRate: number;
+  sets: number;
+  /** Entries dropped to stay within capacity or maxBytes. */
+  evictions: number;
+  expirations: number;
+  entries: number;
+  /** Bytes live entries count against maxBytes (see NativeTtlCacheOptions.maxBytes). */
+  bytes: number;
+  /** Key + value bytes of live entries. */
+  bytesPayload: number;
+  /** Native memory held, including blocks cached for reuse. */
+  bytesResident: number;
+  shards: number;
+};
+
+export type NativeTtlCache = {
+  readonly capacity: number;
+  readonly maxBytes: number;
+  readonly ttlMs: number;
+  /** True when this handle joined a named cache another handle created. */
+  readonly attached: boolean;
+  /** Strings come back as strings, bytes as a Buffer copy. */
+  get(key: string): string | Buffer | undefined;
+  /** ttlMs: omitted = the cache default, 0 = never expires. False when the entry is too large. */
+  set(key: string, value: string | Uint8Array, ttlMs?: number): boolean;
+  has(key: string): boolean;
+  delete(key: string): boolean;
+  getMany(keys: string[]): Array<string | Buffer | undefined>;
+  /** Returns the number of entries stored. */
+  setMany(keys: string[], values: Array<string | Uint8Array>, ttlMs?: number): number;
+  clear(): void;
+  len(): number;
+  stats(): NativeTtlCacheStats;
+};
+
+export type NativeTtlCacheOptions = {
+  /** Maximum entries, an integer. */
+  capacity: number;
+  /**
+   * Byte budget (default 64 MiB). An entry is charged its allocation block:
+   * key + value bytes rounded up to a power of two of at least 64, or the
+   * exact size above the largest slab class.
+   */
+  maxBytes?: number;
+  /** Default TTL; 0 = entries never expire. */
+  ttlMs?: number;
+  shards?: number;
+  /**
+   * Workers constructing a cache with the same name share one store; joining
+   * it with different limits throws.
+   */
+  name?: string;
+};
+
+export function getNativeTtlCache(): ((options: NativeTtlCacheOptions) => NativeTtlCache) | null {
+  if (isEnabled("useNativeCache") && nativeModule?.TtlCache) {
+    const TtlCache = nativeModule.TtlCache;
+    return (options) => new TtlCache(options);
+  }
+  return fallback("ttlCache");
+}
+
 /**
  * Get cache instance
  */
@@ -147,18 +517,40 @@ export function createCache(capacity: number, ttlSeconds: number): any {
     return new rustModule.TimedCache(capacity, ttlSeconds);
   }
 
-  // Fallback: simple JS Map with TTL simulation
+  const createTtlCache = getNativeTtlCache();
+  if (createTtlCache) {
+    const cache = createTtlCache({ capacity, ttlMs: ttlSeconds * 1000 });
+    return {
+      get: (key: string) => cache.get(key) as string | undefined,
+      set: (key: string, value: string) => {
+        cache.set(key, value);
+      },
+      getMany: (keys: string[]) => cache.getMany(keys),
+      setMany: (keys: string[], values: string[]) => cache.setMany(keys, values),
+      len: () => cache.len(),
+      clear: () => cache.clear(),
+      stats: () => cache.stats(),
+    };
+  }
+
+  // Fallback: JS Map in LRU order (oldest first) with TTL simulation
   const cache = new Map<string, { value: string; expires: number }>();
   return {
     get: (key: string) => {
       const entry = cache.get(key);
       if (entry && entry.expires > Date.now()) {
+        cache.delete(key);
+        cache.set(key, entry);
         return entry.value;
       }
       if (entry) cache.delete(key);
       return undefined;
     },
     set: (key: string, value: string) => {
+      cache.delete(key);
+      if (cache.size >= capacity) {
+        cache.delete(cache.keys().next().value as string);
+      }
       cache.set(key, { value, expires: Date.now() + ttlSeconds * 1000 });
     },
     len: () => cache.size,
@@ -166,6 +558,55 @@ export function createCache(capacity: number, ttlSeconds: number): any {
   };
 }
 
+/**
+ * Per-group history ring buffers - native, or null
+ */
+export type NativeGroupHistoryRange = {
+  timestamps: Float64Array;
+  /** Entry i is data.subarray(offsets[i], offsets[i] + lengths[i]), UTF-8. */
+  offsets: Uint32Array;
+  lengths: Uint32Array;
+  /** The group's entries, copied out of native memory. */
+  data: Buffer;
+};
+
+export type NativeGroupHistory = {
+  readonly maxEntriesPerGroup: number;
+  readonly maxBytes: number;
+  /** False when the content alone is larger than maxBytes. */
+  add(groupId: string, entry: { timestamp: number; content: string }): boolean;
+  get(groupId: string): Array<{ timestamp: number; content: string }>;
+  /**
+   * Entries with timestamp >= fromTs, oldest first, in one copied buffer;
+   * null for an unknown group.
+   */
+  getRange(groupId: string, fromTs?: number): NativeGroupHistoryRange | null;
+  clearGroup(groupId: string): boolean;
+  clear(): void;
+  /** Number of groups. */
+  len(): number;
+  stats(): {
+    groups: number;
+    entries: number;
+    bytes: number;
+    bytesResident: number;
+    evictedGroups: number;
+    compactions: number;
+  };
+};
+
+export function getNativeGroupHistory(): ((options: {
+  maxEntriesPerGroup: number;
+  /** Budget for all groups (default 64 MiB); least recently used groups are evicted. */
+  maxBytes?: number;
+}) => NativeGroupHistory) | null {
+  if (isEnabled("useNativeCache") && nativeModule?.GroupHistory) {
+    const GroupHistory = nativeModule.GroupHistory;
+    return (options) => new GroupHistory(options);
+  }
+  return fallback("groupHistory");
+}
+
 /**
  * Get group history cache
  * Optimized for chat group message histories with automatic eviction
@@ -175,17 +616,25 @@ export function createGroupHistoryCache(maxEntriesPerGroup: number): any {
     return new rustModule.GroupHistoryCache(maxEntriesPerGroup);
   }
 
+  const createGroupHistory = getNativeGroupHistory();
+  if (createGroupHistory) {
+    return createGroupHistory({ maxEntriesPerGroup });
+  }
+
   // Fallback: simple JS Map with array size limit
   const cache = new Map<string, Array<{ timestamp: number; content: string }>>();
   return {
     add: (groupId: string, entry: { timestamp: number; content: string }) => {
-      let history = cache.get(groupId) || [];
+      let history = cache.get(groupId);
+      if (!history) {
+        history = [];
+        cache.set(groupId, history);
+      }
       history.push(entry);
-      // Keep only last N entries
+      // Keep only last N entries, in place
       if (history.length > maxEntriesPerGroup) {
-        history = history.slice(-maxEntriesPerGroup);
+        history.shift();
       }
-      cache.set(groupId, history);
     },
     get: (groupId: string) => cache.get(groupId) || [],
     clearGroup: (groupId: string) => cache.delete(groupId),
@@ -196,14 +645,748 @@ export function createGroupHistoryCache(maxEntriesPerGroup: number): any {
 /**
  * Buffer operations
  */
+
+// Buffer.compare is already a native memcmp; below this size the N-API call
+// costs more than the comparison itself (see scripts/bench-native.mjs).
+const NATIVE_COMPARE_MIN_BYTES = 256 * 1024;
+
 export function compareBuffers(buf1: Buffer, buf2: Buffer): number {
-  if (isEnabled("useNativeBuffers") && nativeModule?.BufferOps) {
-    const ops = new nativeModule.BufferOps();
-    return ops.compare(buf1, buf2);
+  if (
+    isEnabled("useNativeBuffers") &&
+    nativeModule?.compare &&
+    Math.min(buf1.length, buf2.length) >= NATIVE_COMPARE_MIN_BYTES
+  ) {
+    return nativeModule.compare(buf1, buf2);
   }
 
+  // Below the threshold JS is the intended path, not a fallback
+  if (Math.min(buf1.length, buf2.length) >= NATIVE_COMPARE_MIN_BYTES) {
+    fallback("compare");
+  }
   return buf1.compare(buf2);
 }
 
+/**
+ * Vector search - native SIMD top-k or null
+ */
+export type NativeTopK = (
+  query: Float32Array,
+  matrix: Float32Array,
+  k: number,
+) => { indices: Uint32Array; scores: Float32Array };
+
+/**
+ * Cosine top-k over a row-major N x D matrix, best first. Returns null when
+ * the native module is not loaded so callers can skip building the matrix.
+ */
+export function getNativeTopK(): NativeTopK | null {
+  if (isEnabled("useSimdOps") && nativeModule?.topK) {
+    return (query, matrix, k) => nativeModule.topK(query, matrix, k);
+  }
+  return fallback("topK");
+}
+
+/**
+ * Approximate nearest-neighbour search - native HNSW graph or null
+ */
+export type NativeHnswOptions = {
+  dims: number;
+  metric?: "cosine" | "dot" | "l2";
+  m?: number;
+  efConstruction?: number;
+  efSearch?: number;
+};
+
+export type NativeHnswHits = { ids: string[]; scores: Float32Array };
+
+export type NativeHnswIndex = {
+  readonly size: number;
+  /** Graph nodes including removed (tombstoned) ones. */
+  readonly nodes: number;
+  readonly dims: number;
+  readonly metric: string;
+  efSearch: number;
+  add(id: string, vector: Float32Array): void;
+  addMany(ids: string[], vectors: Float32Array): void;
+  addManyAsync(ids: string[], vectors: Float32Array): Promise<void>;
+  remove(id: string): boolean;
+  has(id: string): boolean;
+  search(query: Float32Array, k: number, ef?: number): NativeHnswHits;
+  searchAsync(query: Float32Array, k: number, ef?: number): Promise<NativeHnswHits>;
+  save(path: string): void;
+  saveAsync(path: string): Promise<void>;
+};
+
+export type NativeHnsw = {
+  create(options: NativeHnswOptions): NativeHnswIndex;
+  load(path: string): Promise<NativeHnswIndex>;
+};
+
+export function getNativeHnsw(): NativeHnsw | null {
+  if (isEnabled("useSimdOps") && nativeModule?.HnswIndex) {
+    const HnswIndex = nativeModule.HnswIndex;
+    return {
+      create: (options) => new HnswIndex(options),
+      load: (path) => HnswIndex.loadAsync(path),
+    };
+  }
+  return fallback("hnsw");
+}
+
+/**
+ * Exact vector search over a persistent mmapped flat file - native or null
+ */
+export type NativeVectorIndexOptions = {
+  /** An existing file must have been created with the same dims, type and metric. */
+  dims: number;
+  type?: "f32" | "f16";
+  metric?: "cosine" | "dot" | "l2";
+};
+
+export type NativeVectorIndex = {
+  readonly size: number;
+  readonly dims: number;
+  add(id: string, vector: Float32Array): void;
+  addMany(ids: string[], vectors: Float32Array): void;
+  remove(id: string): boolean;
+  has(id: string): boolean;
+  /** `filter` is a bitmap from filter(); it goes stale once ids change. */
+  search(query: Float32Array, k: number, filter?: Uint8Array): NativeHnswHits;
+  filter(ids: string[]): Uint8Array;
+  /** msync the rows and fsync the file and the id log. */
+  flush(): void;
+  /** Durably rewrites the id log with one record per live id. */
+  compact(): void;
+  close(): void;
+};
+
+/** Opens `path` (plus `path.log`), creating both when missing. */
+export function getNativeVectorIndex():
+  | ((path: string, options: NativeVectorIndexOptions) => NativeVectorIndex)
+  | null {
+  if (isEnabled("useSimdOps") && nativeModule?.VectorIndex) {
+    const VectorIndex = nativeModule.VectorIndex;
+    return (path, options) => new VectorIndex(path, options);
+  }
+  return fallback("vectorIndex");
+}
+
+/**
+ * BM25 keyword index with keyword + vector fusion - native or null
+ */
+export type NativeKeywordQuery = {
+  k: number;
+  /** "all" (default) requires every query term, like the FTS5 query; "any" ranks by any term. */
+  mode?: "all" | "any";
+  /** Only documents added with one of these tags. */
+  tags?: string[];
+};
+
+export type NativeKeywordIndex = {
+  readonly size: number;
+  readonly terms: number;
+  readonly postingBytes: number;
+  /** Indexes or replaces a document. */
+  add(id: string, text: string, tag?: string): void;
+  addMany(ids: string[], texts: string[], tags?: string[]): void;
+  remove(id: string): boolean;
+  has(id: string): boolean;
+  clear(): void;
+  /** Raw BM25 scores (FTS5 bm25() with the sign flipped), best first. */
+  search(query: string, options: NativeKeywordQuery): { ids: string[]; scores: Float32Array };
+  /**
+   * Keyword top-k fused with vector hits: score = textWeight * textScore + vectorWeight * vectorScore,
+   * textScore = bm25 / (1 + bm25). Vector hits outside the keyword top-k still get their text score.
+   */
+  hybrid(
+    query: string,
+    options: NativeKeywordQuery & {
+      vectorIds: string[];
+      vectorScores: Float32Array;
+      vectorWeight: number;
+      textWeight: number;
+      /** Results to return; defaults to k. */
+      limit?: number;
+    },
+  ): { ids: string[]; scores: Float32Array; textScores: Float32Array; vectorScores: Float32Array };
+};
+
+export function getNativeKeywordIndex(): ((options?: {
+  k1?: number;
+  b?: number;
+}) => NativeKeywordIndex) | null {
+  if (isEnabled("useSimdOps") && nativeModule?.KeywordIndex) {
+    const KeywordIndex = nativeModule.KeywordIndex;
+    return (options) => new KeywordIndex(options);
+  }
+  return fallback("keywordIndex");
+}
+
+/**
+ * Content-addressed embedding cache in a shared mmapped file - native or null
+ */
+export type NativeEmbeddingCacheOptions = {
+  /** Required to create the file; without it the file must exist and sets dims. */
+  dims?: number;
+  /** Slots (rounded up to a power of two), fixed when the file is created. */
+  capacity?: number;
+  type?: "f32" | "f16";
+  /** Mixed into every key, e.g. the provider model. */
+  namespace?: string;
+};
+
+export type NativeEmbeddingCacheStats = {
+  size: number;
+  capacity: number;
+  hits: number;
+  misses: number;
+  inserts: number;
+  evictions: number;
+};
+
+export type NativeEmbeddingCache = {
+  readonly size: number;
+  readonly capacity: number;
+  readonly dims: number;
+  get(hash: string): Float32Array | null;
+  set(hash: string, vector: Float32Array): void;
+  /**
+   * vectors holds hashes.length x dims floats (zeros where found is 0); missing is the
+   * first index of each distinct hash that missed, i.e. the texts that still need embedding.
+   */
+  lookup(hashes: string[]): { vectors: Float32Array; found: Uint8Array; missing: Uint32Array };
+  setMany(hashes: string[], vectors: Float32Array): void;
+  /** Counters are per handle; size is shared by every process using the file. */
+  stats(): NativeEmbeddingCacheStats;
+  close(): void;
+};
+
+export function getNativeEmbeddingCache():
+  | ((path: string, options?: NativeEmbeddingCacheOptions) => NativeEmbeddingCache)
+  | null {
+  if (isEnabled("useSimdOps") && nativeModule?.EmbeddingCache) {
+    const EmbeddingCache = nativeModule.EmbeddingCache;
+    return (path, options) => new EmbeddingCache(path, options);
+  }
+  return fallback("embeddingCache");
+}
+
+/**
+ * Markdown chunking for memory indexing - native line scan + SHA-256 or null
+ */
+export type NativeMarkdownChunks = {
+  /** Byte range of each chunk in the input buffer. */
+  starts: Uint32Array;
+  ends: Uint32Array;
+  startLines: Uint32Array;
+  endLines: Uint32Array;
+  /** Ascending byte offsets where an over-long line was cut into segments. */
+  breaks: Uint32Array;
+  /** 1 when the chunk text is whitespace only. */
+  blank: Uint8Array;
+  /** SHA-256 of each chunk's text, 32 bytes per chunk. */
+  hashes: Buffer;
+};
+
+export type NativeChunkMarkdown = (
+  buffer: Buffer,
+  chunking: { tokens: number; overlap: number },
+) => Promise<NativeMarkdownChunks | null>;
+
+/**
+ * Resolves to null for input the native chunker cannot match byte-for-byte
+ * (invalid UTF-8, a line cut through a surrogate pair); chunk the decoded
+ * string instead.
+ */
+export function getNativeChunkMarkdown(): NativeChunkMarkdown | null {
+  if (isEnabled("useSimdOps") && nativeModule?.chunkMarkdownAsync) {
+    return (buffer, chunking) => nativeModule.chunkMarkdownAsync(buffer, chunking);
+  }
+  return fallback("chunkMarkdown");
+}
+
+/**
+ * tiktoken-compatible BPE token counting (cl100k_base) - native or null
+ */
+export type NativeTokenizer = {
+  readonly vocabSize: number;
+  count(text: string | Uint8Array): number;
+  countMany(texts: Array<string | Uint8Array>): Uint32Array;
+  /** Token ranks and the UTF-8 byte offset where each one ends. */
+  encode(text: string | Uint8Array): { tokens: Uint32Array; ends: Uint32Array };
+  /**
+   * Longest prefix of at most maxTokens tokens ending on a code point
+   * boundary; text.slice(0, length) is that prefix for string input.
+   */
+  prefix(
+    text: string | Uint8Array,
+    maxTokens: number,
+  ): { bytes: number; length: number; tokens: number };
+};
+
+/**
+ * Opens a tiktoken rank file such as cl100k_base.tiktoken; throws when it
+ * cannot be read or parsed. Every tokenizer on the same path shares one table.
+ */
+export function getNativeTokenizer(): ((path: string) => NativeTokenizer) | null {
+  if (isEnabled("useSimdOps") && nativeModule?.Tokenizer) {
+    const Tokenizer = nativeModule.Tokenizer;
+    return (path) => new Tokenizer(path);
+  }
+  return fallback("tokenizer");
+}
+
+/**
+ * Batch file hashing - native thread pool or null
+ */
+export type NativeFileManifestEntry = { size: number; mtimeMs: number; hash: string };
+
+export type NativeHashedFile =
+  | { index: number; size: number; mtimeMs: number; hash: string }
+  | { index: number; error: string; errno: number };
+
+/**
+ * Hashes `paths` across the native thread pool. With a manifest (parallel to
+ * paths), files whose size and mtime still match are not read, and only
+ * changed or unreadable files are returned.
+ */
+export type NativeHashFiles = (
+  paths: string[],
+  options?: {
+    algorithm?: "sha256" | "xxh64";
+    manifest?: Array<NativeFileManifestEntry | undefined>;
+  },
+) => Promise<NativeHashedFile[]>;
+
+export function getNativeHashFiles(): NativeHashFiles | null {
+  if (isEnabled("useNativeBuffers") && nativeModule?.hashFilesAsync) {
+    return (paths, options) => nativeModule.hashFilesAsync(paths, options);
+  }
+  return fallback("hashFiles");
+}
+
+/**
+ * JSONL transcript scanning - native or null
+ */
+export type NativeTranscriptScan = {
+  /** One row per { type: "message" } record with a requested role. */
+  starts: Float64Array;
+  ends: Float64Array;
+  roles: string[];
+  /** Text parts of message.content joined with "\n". */
+  texts: string[];
+  timestamps: Array<string | number | undefined>;
+  /** Set only for rows whose text needs JSON.parse (lone surrogate escapes). */
+  raw: Array<string | undefined>;
+  /** End of the last complete line; pass back as `from` with `anchor`. */
+  offset: number;
+  size: number;
+  /** False when `from` was ignored because the file no longer matches `anchor`. */
+  resumed: boolean;
+  anchor: string;
+};
+
+export type NativeScanTranscript = (
+  path: string,
+  options?: { from?: number; anchor?: string; roles?: string[] },
+) => Promise<NativeTranscriptScan>;
+
+export function getNativeScanTranscript(): NativeScanTranscript | null {
+  if (isEnabled("useNativeBuffers") && nativeModule?.scanTranscriptAsync) {
+    return (path, options) => nativeModule.scanTranscriptAsync(path, options);
+  }
+  return fallback("scanTranscript");
+}
+
+/**
+ * GCRA rate-limit table - native, shareable across worker threads, or null
+ */
+export type NativeRateLimitTable = {
+  /** Table memory; a view of the SharedArrayBuffer when one was passed in. */
+  readonly memory: Uint8Array;
+  readonly capacity: number;
+  readonly windowMs: number;
+  readonly maxRequests: number;
+  /** True when allowed; writes out[0] = remaining, out[1] = when the key's bucket is full (ms). */
+  check(key: string, nowMs: number, out: Float64Array): boolean;
+};
+
+export type NativeRateLimit = {
+  /** Bytes of memory a table of `capacity` keys needs. */
+  bytesFor(capacity: number): number;
+  /** Formats `memory`, or attaches when it already holds a table with these limits. */
+  create(options: {
+    windowMs: number;
+    maxRequests: number;
+    capacity?: number;
+    memory?: Uint8Array;
+  }): NativeRateLimitTable;
+};
+
+export function getNativeRateLimit(): NativeRateLimit | null {
+  if (isEnabled("useNativeCache") && nativeModule?.RateLimitTable) {
+    const RateLimitTable = nativeModule.RateLimitTable;
+    return {
+      bytesFor: (capacity) => RateLimitTable.bytesFor(capacity),
+      create: (options) => new RateLimitTable(options),
+    };
+  }
+  return fallback("rateLimit");
+}
+
+/**
+ * Media header probe - native or null
+ */
+export type NativeMediaProbe = {
+  /** As file-type reports it, e.g. "image/jpeg" or "audio/ogg; codecs=opus". */
+  mime: string;
+  /** Stored size, before EXIF orientation. */
+  width?: number;
+  height?: number;
+  /** EXIF orientation, 1-8. */
+  orientation?: number;
+  /** Seconds. */
+  duration?: number;
+  /** ffprobe's codec name, e.g. "opus" or "h264". */
+  codec?: string;
+  sampleRate?: number;
+  channels?: number;
+  bitrate?: number;
+};
+
+export type NativeProbeMedia = {
+  /**
+   * Parses only the headers of JPEG, PNG, GIF, WebP, HEIF/AVIF, MP4/MOV/M4A,
+   * Ogg, MP3, WAV and PDF; null for other formats. `head` is the file, or its
+   * first `headBytes`; then pass the file's `size` and, optionally, its last
+   * `tailBytes` as `tail` (Ogg durations, MP4s with a trailing moov).
+   */
+  probe(
+    head: Uint8Array,
+    options?: { tail?: Uint8Array; size?: number },
+  ): NativeMediaProbe | null;
+  headBytes: number;
+  tailBytes: number;
+};
+
+export function getNativeProbeMedia(): NativeProbeMedia | null {
+  if (isEnabled("useNativeBuffers") && nativeModule?.probeMedia) {
+    return {
+      probe: (head, options) => nativeModule.probeMedia(head, options),
+      headBytes: nativeModule.mediaProbeHeadBytes,
+      tailBytes: nativeModule.mediaProbeTailBytes,
+    };
+  }
+  return fallback("probeMedia");
+}
+
+/**
+ * Base64 - native or null
+ */
+export type NativeBase64Info = {
+  /** Decoded bytes. */
+  size: number;
+  /** Characters of base64 payload, after trimming and any data URL prefix. */
+  length: number;
+  /** Sniffed from the decoded head; null when the format is not recognised. */
+  mime: string | null;
+  /** The data URL's declared type, or null. */
+  type: string | null;
+};
+
+export type NativeBase64Options = {
+  /** Accept and strip a "data:<type>;base64," prefix. */
+  dataUrl?: boolean;
+};
+
+export type NativeBase64 = {
+  /**
+   * Strict standard-alphabet decode (length a multiple of 4, padding only at
+   * the end). Null for invalid or non-ASCII input; `data` is null when the
+   * payload decodes to more than `maxBytes`.
+   */
+  decode(
+    input: string | Uint8Array,
+    options?: NativeBase64Options & { maxBytes?: number },
+  ): (NativeBase64Info & { data: Buffer | null }) | null;
+  /** Validates like decode but only decodes the head the MIME sniff needs. */
+  inspect(input: string | Uint8Array, options?: NativeBase64Options): NativeBase64Info | null;
+  encode(bytes: Uint8Array): string;
+};
+
+export function getNativeBase64(): NativeBase64 | null {
+  if (isEnabled("useNativeBuffers") && nativeModule?.inspectBase64) {
+    return {
+      decode: (input, options) => nativeModule.decodeBase64(input, options ?? {}),
+      inspect: (input, options) => nativeModule.inspectBase64(input, options ?? {}),
+      encode: (bytes) => nativeModule.encodeBase64(bytes),
+    };
+  }
+  return fallback("base64");
+}
+
+/**
+ * UTF-8 on raw bytes - native or null
+ */
+export type NativeUtf8 = {
+  /** Well-formed UTF-8, as Buffer.isUtf8() and a fatal TextDecoder define it. */
+  validate(bytes: Uint8Array): boolean;
+  /** String length of the decoded bytes, or null when they are not valid UTF-8. */
+  utf16Length(bytes: Uint8Array): number | null;
+  /**
+   * Decodes only the longest prefix within `maxChars` UTF-16 code units and
+   * `maxBytes` bytes that ends on a code point boundary; with `maxChars`
+   * alone the result equals truncateUtf16Safe(bytes.toString(), maxChars).
+   * Null when that prefix is not valid UTF-8.
+   */
+  truncate(bytes: Uint8Array, limits: { maxChars?: number; maxBytes?: number }): string | null;
+};
+
+export function getNativeUtf8(): NativeUtf8 | null {
+  if (isEnabled("useNativeBuffers") && nativeModule?.utf8Validate) {
+    return {
+      validate: (bytes) => nativeModule.utf8Validate(bytes),
+      utf16Length: (bytes) => nativeModule.utf16Length(bytes),
+      truncate: (bytes, limits) => nativeModule.truncateUtf8(bytes, limits),
+    };
+  }
+  return fallback("utf8");
+}
+
+/**
+ * WebSocket payload masking - native or null
+ */
+export type NativeWsMask = {
+  /** output[offset + i] = source[i] ^ mask[i % 4] for i < length. */
+  mask(source: Buffer, mask: Buffer, output: Buffer, offset: number, length: number): void;
+  /** In place. */
+  unmask(buffer: Buffer, mask: Buffer): void;
+};
+
+/** Same shape as the bufferutil package's exports. */
+export function getNativeWsMask(): NativeWsMask | null {
+  if (isEnabled("useNativeBuffers") && nativeModule?.wsUnmask) {
+    return {
+      mask: (source, mask, output, offset, length) =>
+        nativeModule.wsMask(source, mask, output, offset, length),
+      unmask: (buffer, mask) => nativeModule.wsUnmask(buffer, mask),
+    };
+  }
+  return fallback("wsMask");
+}
+
+/**
+ * Telephony audio DSP (16-bit LE mono PCM, G.711) - native or null
+ */
+export type NativeG711Law = "mulaw" | "alaw";
+
+export type NativeVoiceActivity = {
+  rms: number;
+  /** -120 for digital silence. */
+  dbfs: number;
+  /** Sign changes per adjacent sample pair. */
+  zeroCrossingRate: number;
+  /** dbfs >= threshold and zeroCrossingRate <= maxZeroCrossingRate. */
+  speech: boolean;
+};
+
+export type NativeVoiceActivityOptions = {
+  encoding?: "pcm16" | NativeG711Law;
+  /** dBFS, default -45. */
+  threshold?: number;
+  /** Default 0.5; above it a loud frame is taken as noise. */
+  maxZeroCrossingRate?: number;
+};
+
+/**
+ * Kernels write into `output` when given (a pooled frame; it must be large
+ * enough) and return the filled part of it, or a new Buffer.
+ */
+export type NativeTelephonyAudio = {
+  /**
+   * Polyphase windowed-sinc resampling to floor(samples * outputRate / inputRate)
+   * samples. Null for rate pairs needing more than 1024 filter phases.
+   */
+  resample(pcm: Buffer, inputRate: number, outputRate: number, output?: Buffer): Buffer | null;
+  encodeG711(pcm: Buffer, law: NativeG711Law, output?: Buffer): Buffer;
+  decodeG711(bytes: Buffer, law: NativeG711Law, output?: Buffer): Buffer;
+  detectVoice(frame: Buffer, options?: NativeVoiceActivityOptions): NativeVoiceActivity;
+};
+
+export function getNativeTelephonyAudio(): NativeTelephonyAudio | null {
+  if (isEnabled("useNativeBuffers") && nativeModule?.resamplePcm16) {
+    return {
+      resample: (pcm, inputRate, outputRate, output) => {
+        const samples = Math.floor(pcm.length / 2);
+        const out = output ?? Buffer.allocUnsafe(Math.floor((samples * outputRate) / inputRate) * 2);
+        const written = nativeModule.resamplePcm16(pcm, inputRate, outputRate, out);
+        return written === null ? null : out.subarray(0, written);
+      },
+      encodeG711: (pcm, law, output) => {
+        const out = output ?? Buffer.allocUnsafe(Math.floor(pcm.length / 2));
+        return out.subarray(0, nativeModule.g711Encode(pcm, law, out));
+      },
+      decodeG711: (bytes, law, output) => {
+        const out = output ?? Buffer.allocUnsafe(bytes.length * 2);
+        return out.subarray(0, nativeModule.g711Decode(bytes, law, out));
+      },
+      detectVoice: (frame, options) => nativeModule.detectVoice(frame, options ?? {}),
+    };
+  }
+  return fallback("telephonyAudio");
+}
+
+/**
+ * JPEG resize - native or null
+ */
+export type NativeResizeJpegOptions = {
+  /** Fit inside maxSide x maxSide; omitted keeps the size. */
+  maxSide?: number;
+  /** 1-100, default 80. */
+  quality?: number;
+  /** Default true. */
+  withoutEnlargement?: boolean;
+  /** Apply the EXIF orientation to the pixels (default true). */
+  autoOrient?: boolean;
+};
+
+export type NativeResizedJpeg = { data: Buffer; width: number; height: number };
+
+export type NativeResizeJpeg = {
+  /**
+   * Decodes, resizes, orients and re-encodes on a libuv worker thread.
+   * Resolves null for input the pipeline does not take (not a JPEG, CMYK,
+   * too large); the caller falls back to sharp or sips.
+   */
+  resize(buffer: Buffer, options?: NativeResizeJpegOptions): Promise<NativeResizedJpeg | null>;
+};
+
+export function getNativeResizeJpeg(): NativeResizeJpeg | null {
+  if (isEnabled("useNativeBuffers") && nativeModule?.resizeJpegAsync) {
+    return {
+      resize: (buffer, options) => nativeModule.resizeJpegAsync(buffer, options ?? {}),
+    };
+  }
+  return fallback("resizeJpeg");
+}
+
+/**
+ * Shared-memory event bus - native or null
+ */
+export type NativeEventBusOptions = {
+  /** Rounded up to a power of two; default 16384. An existing file keeps its sizes. */
+  slots?: number;
+  /** Frame space, rounded up to a power of two; default 32 MiB. */
+  dataBytes?: number;
+  /** Replace an existing file (the owner does this once at startup). */
+  reset?: boolean;
+};
+
+export type NativeEventBusEvent = { seq: number; tag: number; frame: Buffer };
+
+export type NativeEventBusRead = {
+  events: NativeEventBusEvent[];
+  /** Cursor for the next read. */
+  next: number;
+  /** Events overwritten before this reader got to them, or too large to store. */
+  lost: number;
+};
+
+/**
+ * Ordered broadcast ring in a memory-mapped file: every reader, in any
+ * worker or process opening the same path, sees every event. Seqs start at
+ * 1 and are shared by all producers.
+ */
+export type NativeEventBus = {
+  /** Numbers the next event; it must be committed or readers stop at it. */
+  claim(): number;
+  /** False when the frame was too large (readers count it as lost). */
+  commit(seq: number, frame: Buffer, tag?: number): boolean;
+  /** claim + commit; null when the frame was too large. */
+  publish(frame: Buffer, tag?: number): number | null;
+  /** Committed events from `cursor` on, in seq order. */
+  read(cursor: number, options?: { maxEvents?: number; maxBytes?: number }): NativeEventBusRead;
+  /** Last claimed seq. */
+  readonly head: number;
+  readonly maxFrame: number;
+  close(): void;
+};
+
+export function getNativeEventBus():
+  | ((path: string, options?: NativeEventBusOptions) => NativeEventBus)
+  | null {
+  if (isEnabled("useNativeBuffers") && nativeModule?.EventBus) {
+    const EventBus = nativeModule.EventBus;
+    return (path, options) => {
+      const bus = new EventBus(path, options ?? {});
+      return {
+        claim: () => bus.claim(),
+        commit: (seq, frame, tag) => bus.commit(seq, frame, tag ?? 0),
+        publish: (frame, tag) => bus.publish(frame, tag ?? 0),
+        read: (cursor, options) => {
+          const raw = bus.read(cursor, options ?? {});
+          const events: NativeEventBusEvent[] = [];
+          let start = 0;
+          for (let i = 0; i < raw.seqs.length; i++) {
+            events.push({
+              seq: raw.seqs[i],
+              tag: raw.tags[i],
+              frame: raw.data.subarray(start, raw.ends[i]),
+            });
+            start = raw.ends[i];
+          }
+          return { events, next: raw.next, lost: raw.lost };
+        },
+        get head() {
+          return bus.head;
+        },
+        get maxFrame() {
+          return bus.maxFrame;
+        },
+        close: () => bus.close(),
+      };
+    };
+  }
+  return fallback("eventBus");
+}
+
+/**
+ * Hot-path instrumentation - native op counters plus TS fallback hits
+ */
+export type UltraOpStats = {
+  /** Dotted native op name, e.g. "base64.decode". */
+  op: string;
+  calls: number;
+  /** Input bytes. */
+  bytes: number;
+  totalNs: number;
+  /** Latency histogram; buckets[i] counts calls of at most latencyBounds[i] ns. */
+  buckets: Float64Array;
+};
+
+export type UltraStatsSnapshot = {
+  /** Cumulative since the process started; ops with no calls are left out. */
+  ops: UltraOpStats[];
+  /** Empty when the native addon is not loaded. */
+  latencyBounds: Float64Array;
+  /** Times each accessor or helper took its JS path, keyed like "topK" or "hash". */
+  fallbacks: Record<string, number>;
+};
+
+/** Recording is off by default; a disabled native op pays one relaxed load. */
+export function setUltraStatsEnabled(enabled: boolean): void {
+  statsEnabled = enabled;
+  nativeModule?.setOpStatsEnabled?.(enabled);
+}
+
+export function getUltraStatsSnapshot(): UltraStatsSnapshot {
+  const native = nativeModule?.opStats ? nativeModule : null;
+  return {
+    ops: native ? native.opStats() : [],
+    latencyBounds: native ? native.opLatencyBounds : new Float64Array(0),
+    fallbacks: Object.fromEntries(fallbackHits),
+  };
+}
+
 // Re-export feature flags
 export { features, isEnabled } from "./config/features.js";